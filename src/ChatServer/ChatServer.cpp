@@ -103,7 +103,12 @@ ChatServer::ChatServer(int argc, char* argv[])
 		configuration_variables_map_["UnreliablePacketSizeServerToClient"].as<uint16_t>(), 
 		configuration_variables_map_["ServerPacketWindowSize"].as<uint32_t>(), 
 		configuration_variables_map_["ClientPacketWindowSize"].as<uint32_t>(),
-		configuration_variables_map_["UdpBufferSize"].as<uint32_t>()));
+		configuration_variables_map_["UdpBufferSize"].as<uint32_t>(),
+		swganh::network::ParseSocketBackend(configuration_variables_map_["SocketBackend"].as<std::string>()),
+		configuration_variables_map_["SocketBatchSize"].as<uint32_t>(),
+		configuration_variables_map_["SocketWriteWorkers"].as<uint32_t>(),
+		configuration_variables_map_["CompressionMinSize"].as<uint32_t>(),
+		configuration_variables_map_["CompressionStatsInterval"].as<uint32_t>()));
 
     // Connect to the DB and start listening for the RouterServer.
     mDatabase = mDatabaseManager->connect(DBTYPE_MYSQL,
@@ -117,6 +117,12 @@ TradeManagerChatHandler::TradeManagerChatHandler(Database* database, MessageDisp
     mPlayerAccountMap = mChatManager->getPlayerAccountMap();
     TradeManagerAsyncContainer* asyncContainer;
 
+    // bids arrive in bursts at the end of popular auctions
+    std::string galaxy = mDatabase->galaxy();
+    mDatabase->registerStatement("TradeManagerChat::updateProxyBid", "UPDATE " + galaxy + ".commerce_bidhistory SET proxy_bid=? WHERE auction_id=? AND bidder_name=?");
+    mDatabase->registerStatement("TradeManagerChat::bidUpdate", "SELECT " + galaxy + ".sf_BidUpdate(?,?,?,?)");
+    mDatabase->registerStatement("TradeManagerChat::bidAuction", "SELECT " + galaxy + ".sf_BidAuction(?,?,?,?)");
+
     mMessageDispatch->RegisterMessageCallback(opIsVendorMessage,std::bind(&TradeManagerChatHandler::processHandleIsVendorMessage, this, std::placeholders::_1, std::placeholders::_2));
     mMessageDispatch->RegisterMessageCallback(opAuctionQueryHeadersMessage,std::bind(&TradeManagerChatHandler::processHandleopAuctionQueryHeadersMessage, this, std::placeholders::_1, std::placeholders::_2));
     mMessageDispatch->RegisterMessageCallback(opGetAuctionDetails,std::bind(&TradeManagerChatHandler::processGetAuctionDetails, this, std::placeholders::_1, std::placeholders::_2));
@@ -1209,11 +1215,8 @@ void TradeManagerChatHandler::processAuctionEMails(AuctionItem* auctionTemp)
 void TradeManagerChatHandler::processAuctionBid(TradeManagerAsyncContainer* asynContainer, Player* player)
 {
 //auction ...
-    int8 sql[250], PlayerName[40],*sqlPointer;
-
-    sqlPointer = PlayerName;
-    sqlPointer += mDatabase->escapeString(sqlPointer,player->getName().getAnsi(),player->getName().getLength());
-    *sqlPointer++ = '\0';
+    // bound as a parameter, no escaping needed
+    std::string PlayerName = player->getName().getAnsi();
 
     //Check the current add depending on the price
 
@@ -1243,13 +1246,14 @@ void TradeManagerChatHandler::processAuctionBid(TradeManagerAsyncContainer* asyn
         {
 
             //just update the high proxy
-            sprintf(sql,"UPDATE %s.commerce_bidhistory SET proxy_bid = '%"PRIu32"'WHERE auction_id = '%"PRIu64"' AND bidder_name = '%s'",mDatabase->galaxy(), asynContainer->MyProxy, asynContainer->AuctionTemp->ItemID, PlayerName);
+            StatementParameters parameters;
+            parameters.addUint(asynContainer->MyProxy).addUint(asynContainer->AuctionTemp->ItemID).addString(PlayerName);
 
             TradeManagerAsyncContainer* asyncContainer;
             asyncContainer = new TradeManagerAsyncContainer(TRMQuery_ACKRetrieval,asynContainer->mClient);
 
             asyncContainer->AuctionID = asynContainer->AuctionTemp->ItemID;
-            mDatabase->executeSqlAsync(this,asyncContainer,sql);
+            mDatabase->executePreparedAsync(this,asyncContainer,"TradeManagerChat::updateProxyBid",parameters);
             
 
             return;
@@ -1305,20 +1309,22 @@ void TradeManagerChatHandler::processAuctionBid(TradeManagerAsyncContainer* asyn
         // what do we do if this is our first bid and we are NOT the high bidder?
         // sf_BidAuction only updates the bid of the high bidder
 
-        sprintf(sql, "SELECT %s.sf_BidUpdate ('%"PRIu64"','%"PRIu32"','%"PRIu32"','%s')", mDatabase->galaxy(),  asynContainer->AuctionTemp->ItemID, asynContainer->MyBid, asynContainer->MyProxy, PlayerName);
+        StatementParameters parameters;
+        parameters.addUint(asynContainer->AuctionTemp->ItemID).addUint(asynContainer->MyBid).addUint(asynContainer->MyProxy).addString(PlayerName);
         TradeManagerAsyncContainer* asyncContainer;
         asyncContainer = new TradeManagerAsyncContainer(TRMQuery_ACKRetrieval, asynContainer->mClient);
-        mDatabase->executeSqlAsync(this, asyncContainer, sql);
+        mDatabase->executePreparedAsync(this, asyncContainer, "TradeManagerChat::bidUpdate", parameters);
         
 
     }
 
-    sprintf(sql, "SELECT %s.sf_BidAuction ('%"PRIu64"','%"PRIu32"','%"PRIu32"','%s')", mDatabase->galaxy(),  asynContainer->AuctionTemp->ItemID, TheBid, TheProxy, PlayerName);
+    StatementParameters parameters;
+    parameters.addUint(asynContainer->AuctionTemp->ItemID).addUint(TheBid).addUint(TheProxy).addString(PlayerName);
     TradeManagerAsyncContainer* asyncContainer;
     asyncContainer = new TradeManagerAsyncContainer(TRMQuery_ACKRetrieval,asynContainer->mClient);
 
     asyncContainer->AuctionID = asynContainer->AuctionTemp->ItemID;
-    mDatabase->executeSqlAsync(this,asyncContainer,sql);
+    mDatabase->executePreparedAsync(this,asyncContainer,"TradeManagerChat::bidAuction",parameters);
     
 }
 
@@ -58,6 +58,11 @@ BaseServer::BaseServer()
     ("ServerPacketWindowSize", boost::program_options::value<uint32_t>()->default_value(800), "")
     ("ClientPacketWindowSize", boost::program_options::value<uint32_t>()->default_value(80), "")
     ("UdpBufferSize", boost::program_options::value<uint32_t>()->default_value(4096), "Kernel UDP Buffer")
+    ("SocketBackend", boost::program_options::value<std::string>()->default_value("select"), "socket io backend, select or epoll (linux only)")
+    ("SocketBatchSize", boost::program_options::value<uint32_t>()->default_value(32), "datagrams read and written per system call by the epoll backend")
+    ("SocketWriteWorkers", boost::program_options::value<uint32_t>()->default_value(2), "threads building the outgoing packets of the sessions")
+    ("CompressionMinSize", boost::program_options::value<uint32_t>()->default_value(48), "payloads below this many bytes are sent uncompressed")
+    ("CompressionStatsInterval", boost::program_options::value<uint32_t>()->default_value(300), "seconds between the compression stats in the log, 0 for none")
     ("DBGlobalSchema", boost::program_options::value<std::string>()->default_value("swganh_static"), "")
     ("DBGalaxySchema", boost::program_options::value<std::string>()->default_value("swganh"), "")
     ("DBConfigSchema", boost::program_options::value<std::string>()->default_value("swganh_config"), "")
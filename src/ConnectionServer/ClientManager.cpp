@@ -63,6 +63,7 @@ ClientManager::ClientManager(Service* service, swganh::database::Database* datab
     mConnectionDispatch->RegisterMessageCallback(opClientIdMsg, this);
     mConnectionDispatch->RegisterMessageCallback(opSelectCharacter, this);
     mConnectionDispatch->RegisterMessageCallback(opClusterZoneTransferCharacter, this);
+    mConnectionDispatch->RegisterMessageCallback(opClusterMulticast, this);
 }
 
 //======================================================================================================================
@@ -73,6 +74,7 @@ ClientManager::~ClientManager(void)
     mConnectionDispatch->UnregisterMessageCallback(opClientIdMsg);
     mConnectionDispatch->UnregisterMessageCallback(opSelectCharacter);
     mConnectionDispatch->UnregisterMessageCallback(opClusterZoneTransferCharacter);
+    mConnectionDispatch->UnregisterMessageCallback(opClusterMulticast);
 }
 
 //======================================================================================================================
@@ -230,6 +232,11 @@ void ClientManager::handleDispatchMessage(uint32 opcode, Message* message, Conne
         _processClusterZoneTransferCharacter(client, message);
         break;
     }
+    case opClusterMulticast:
+    {
+        _processClusterMulticast(client, message);
+        break;
+    }
     }
 }
 
@@ -411,6 +418,88 @@ void ClientManager::_processClusterZoneTransferCharacter(ConnectionClient* clien
     }
 }
 
+//======================================================================================================================
+//
+// fans a zone broadcast out to the clients of the recipients, see MessageOpcodes.h for the layout
+//
+void ClientManager::_processClusterMulticast(ConnectionClient* client, Message* message)
+{
+    // fastpath, patch offset and recipient count
+    if(message->getIndex() + sizeof(uint8) + sizeof(uint16) + sizeof(uint16) > message->getSize())
+    {
+        LOG(warning) << "ClientManager::_processClusterMulticast : short multicast from server " << client->getServerId();
+        return;
+    }
+
+    bool fastpath = message->getUint8() != 0;
+    uint16 patchOffset = message->getUint16();
+    uint16 count = message->getUint16();
+
+    uint32 entrySize = (patchOffset == MULTICAST_NO_PATCH) ? sizeof(uint32) : sizeof(uint32) + sizeof(uint64);
+    uint32 payloadIndex = message->getIndex() + count * entrySize;
+
+    if(payloadIndex > message->getSize())
+    {
+        LOG(warning) << "ClientManager::_processClusterMulticast : malformed multicast from server " << client->getServerId();
+        return;
+    }
+
+    uint16 payloadSize = static_cast<uint16>(message->getSize() - payloadIndex);
+
+    if((patchOffset != MULTICAST_NO_PATCH) && (patchOffset + sizeof(uint64) > payloadSize))
+    {
+        LOG(warning) << "ClientManager::_processClusterMulticast : patch outside of the payload from server " << client->getServerId();
+        return;
+    }
+
+    // Find the clients of all recipients in one go
+    std::vector<std::pair<ConnectionClient*, uint64> > recipients;
+    recipients.reserve(count);
+
+    boost::recursive_mutex::scoped_lock lk(mServiceMutex);
+
+    for(uint16 i = 0; i < count; i++)
+    {
+        uint32 accountId = message->getUint32();
+        uint64 patch = (patchOffset != MULTICAST_NO_PATCH) ? message->getUint64() : 0;
+
+        PlayerClientMap::iterator iter = mPlayerClientMap.find(accountId);
+
+        // happens when the client logs out
+        if(iter != mPlayerClientMap.end())
+        {
+            recipients.push_back(std::make_pair((*iter).second, patch));
+        }
+    }
+
+    //unlock here sendchannel is getting the mSessionMutex we dont want to spend time waiting to synchronize mutexes
+    lk.unlock();
+
+    if(recipients.empty())
+    {
+        return;
+    }
+
+    // The incoming message belongs to the server session, copy the payload once and let all clients share it.
+    gMessageFactory->StartMessage();
+    gMessageFactory->addData(message->getData() + payloadIndex, payloadSize);
+    Message* payload = gMessageFactory->EndMessage();
+
+    for(auto& recipient : recipients)
+    {
+        Message* clientMessage = gMessageFactory->CreateSharedMessage(payload);
+
+        if(patchOffset != MULTICAST_NO_PATCH)
+        {
+            clientMessage->setPatch(patchOffset, recipient.second);
+        }
+
+        recipient.first->SendChannelA(clientMessage, message->getPriority(), fastpath);
+    }
+
+    gMessageFactory->DestroyMessage(payload);
+}
+
 
 //======================================================================================================================
 void ClientManager::_handleQueryAuth(ConnectionClient* client, DatabaseResult* result)
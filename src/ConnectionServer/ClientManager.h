@@ -34,6 +34,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 
 #include <boost/thread/recursive_mutex.hpp>
 #include <map>
+#include <vector>
 
 
 //======================================================================================================================
@@ -84,6 +85,7 @@ private:
     void						_processClientIdMsg(ConnectionClient* client, Message* message);
     void                        _processSelectCharacter(ConnectionClient* client, Message* message);
     void                        _processClusterZoneTransferCharacter(ConnectionClient* client, Message* message);
+    void                        _processClusterMulticast(ConnectionClient* client, Message* message);
 
     void                        _handleQueryAuth(ConnectionClient* client, swganh::database::DatabaseResult* result);
     void                        _processAllowedChars(swganh::database::DatabaseCallback* callback,ConnectionClient* client);
@@ -107,7 +107,12 @@ ConnectionServer::ConnectionServer(int argc, char* argv[]) :
 		configuration_variables_map_["UnreliablePacketSizeServerToClient"].as<uint16_t>(), 
 		configuration_variables_map_["ServerPacketWindowSize"].as<uint32_t>(), 
 		configuration_variables_map_["ClientPacketWindowSize"].as<uint32_t>(),
-		configuration_variables_map_["UdpBufferSize"].as<uint32_t>()));
+		configuration_variables_map_["UdpBufferSize"].as<uint32_t>(),
+		swganh::network::ParseSocketBackend(configuration_variables_map_["SocketBackend"].as<std::string>()),
+		configuration_variables_map_["SocketBatchSize"].as<uint32_t>(),
+		configuration_variables_map_["SocketWriteWorkers"].as<uint32_t>(),
+		configuration_variables_map_["CompressionMinSize"].as<uint32_t>(),
+		configuration_variables_map_["CompressionStatsInterval"].as<uint32_t>()));
 
     // Create our status service
     //clientservice
@@ -125,6 +125,16 @@ void Database::executeAsyncSql(const std::string& sql, AsyncDatabaseCallback cal
     job_pending_queue_.push(job);
 }
 
+void Database::executeCheckedAsyncSql(const std::string& sql, AsyncDatabaseCallback callback) {
+    DatabaseJob* job = new(job_pool_.ordered_malloc()) DatabaseJob();
+    job->callback = callback;
+    job->query = sql;
+    job->multi_job = false;
+    job->report_failure = true;
+
+    job_pending_queue_.push(job);
+}
+
 void Database::executeAsyncProcedure(const std::stringstream& sql) {    
     executeAsyncProcedure(sql.str());
 }
@@ -155,6 +165,53 @@ void Database::executeAsyncProcedure(const std::string& sql, AsyncDatabaseCallba
 }
 
 
+void Database::registerStatement(const std::string& name, const std::string& sql) {
+    boost::mutex::scoped_lock lock(statement_mutex_);
+
+    std::unique_ptr<PreparedStatementInfo>& info = statements_[name];
+
+    if (!info) {
+        info.reset(new PreparedStatementInfo());
+        info->id = static_cast<uint32_t>(statements_.size() - 1);
+        info->name = name;
+        info->sql = sql;
+    }
+}
+
+
+DatabaseResult* Database::executePrepared(const std::string& name, const StatementParameters& parameters) {
+    const PreparedStatementInfo* info = findStatement_(name);
+
+    if (!info) {
+        return nullptr;
+    }
+
+    return database_impl_->executePrepared(*info, parameters);
+}
+
+
+void Database::executePreparedAsync(const std::string& name, const StatementParameters& parameters) {
+    pushPreparedJob_(name, parameters, new(job_pool_.ordered_malloc()) DatabaseJob());
+}
+
+
+void Database::executePreparedAsync(const std::string& name, const StatementParameters& parameters, AsyncDatabaseCallback callback) {
+    DatabaseJob* job = new(job_pool_.ordered_malloc()) DatabaseJob();
+    job->callback = callback;
+
+    pushPreparedJob_(name, parameters, job);
+}
+
+
+void Database::executePreparedAsync(DatabaseCallback* callback, void* ref, const std::string& name, const StatementParameters& parameters) {
+    DatabaseJob* job = new(job_pool_.ordered_malloc()) DatabaseJob();
+    job->old_callback = callback;
+    job->client_reference = ref;
+
+    pushPreparedJob_(name, parameters, job);
+}
+
+
 void Database::process() {
     DatabaseWorkerThread* worker = nullptr;
     DatabaseJob* job = nullptr;
@@ -199,8 +256,13 @@ void Database::process() {
 			//in case a query fails (error) there will not be a result!
 			//in this case bail out as most db code wont check for a result before checking the row count
 			if(!job->result)	{
-				LOG (error) << "Database::process()  db returned no result :( " << job->query;
-				job_pool_.ordered_free(job);
+				LOG (error) << "Database::process()  db returned no result :( " << (job->statement ? job->statement->name : job->query);
+
+				if (job->report_failure && job->callback) {
+					(*job->callback)(nullptr);
+				}
+
+				destroyJob_(job);
 				continue;
 			}
 
@@ -214,7 +276,7 @@ void Database::process() {
 
             // Free the result and the job
             destroyResult(job->result);
-            job_pool_.ordered_free(job);
+            destroyJob_(job);
         }
     }
 }
@@ -404,3 +466,40 @@ bool Database::releaseBindingPoolMemory() {
 void Database::pushDatabaseJobComplete(DatabaseJob* job) {
     job_complete_queue_.push(job);
 }
+
+
+const PreparedStatementInfo* Database::findStatement_(const std::string& name) {
+    boost::mutex::scoped_lock lock(statement_mutex_);
+
+    auto it = statements_.find(name);
+
+    if (it == statements_.end()) {
+        LOG(error) << "Database::findStatement_ statement " << name << " was never registered";
+        return nullptr;
+    }
+
+    return it->second.get();
+}
+
+
+void Database::pushPreparedJob_(const std::string& name, const StatementParameters& parameters, DatabaseJob* job) {
+    job->statement = findStatement_(name);
+
+    if (!job->statement) {
+        destroyJob_(job);
+        return;
+    }
+
+    job->parameters = parameters;
+    job->multi_job = false;
+
+    // Add the job to our processList;
+    job_pending_queue_.push(job);
+}
+
+
+void Database::destroyJob_(DatabaseJob* job) {
+    // the query and parameters hold memory of their own
+    job->~DatabaseJob();
+    job_pool_.ordered_free(job);
+}
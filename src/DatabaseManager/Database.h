@@ -31,11 +31,13 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include <cstdint>
 
 #include <functional>
+#include <map>
 #include <memory>
 #include <queue>
 #include <string>
 
 #include <boost/noncopyable.hpp>
+#include <boost/thread/mutex.hpp>
 #include <boost/pool/pool.hpp>
 
 #include <tbb/concurrent_queue.h>
@@ -44,6 +46,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "DatabaseManager/DatabaseType.h"
 #include "DatabaseManager/DataBindingFactory.h"
 #include "DatabaseManager/DatabaseConfig.h"
+#include "DatabaseManager/StatementParameters.h"
 
 namespace swganh {
 namespace database {
@@ -112,6 +115,14 @@ public:
     */
     void executeAsyncSql(const std::string& sql, AsyncDatabaseCallback callback);
 
+    /*! Executes an asynchronus sql query and invokes the specified callback on
+    * completion, or with a null result if the query failed.
+    *
+    * \param sql The sql query to run.
+    * \param callback The callback to invoke once the sql query has been executed or has failed.
+    */
+    void executeCheckedAsyncSql(const std::string& sql, AsyncDatabaseCallback callback);
+
     /*! Executes an asynchronus stored procedure.
     *
     * \param sql The sql query to run.
@@ -140,9 +151,55 @@ public:
     */
     void executeAsyncProcedure(const std::string& sql, AsyncDatabaseCallback callback);
     
+    /*! Registers a statement to be prepared under a name, its parameters are given
+    * as '?' placeholders in the sql. Every connection prepares it on first use and
+    * reuses it from then on, registering a name again keeps the first statement.
+    *
+    * \param name The name the statement is executed by.
+    * \param sql The sql of the statement.
+    */
+    void registerStatement(const std::string& name, const std::string& sql);
+
+    /*! Executes a registered statement synchronusly.
+    *
+    * \param name The name the statement was registered with.
+    * \param parameters The values for the placeholders of the statement.
+    */
+    DatabaseResult* executePrepared(const std::string& name, const StatementParameters& parameters);
+
+    /*! Executes a registered statement asynchronusly.
+    *
+    * \param name The name the statement was registered with.
+    * \param parameters The values for the placeholders of the statement.
+    */
+    void executePreparedAsync(const std::string& name, const StatementParameters& parameters);
+
+    /*! Executes a registered statement asynchronusly and invokes the specified
+    * callback on completion.
+    *
+    * \param name The name the statement was registered with.
+    * \param parameters The values for the placeholders of the statement.
+    * \param callback The callback to invoke once the statement has been executed.
+    */
+    void executePreparedAsync(const std::string& name, const StatementParameters& parameters, AsyncDatabaseCallback callback);
+
+    /*! Executes a registered statement asynchronusly and invokes the specified
+    * database callback on completion.
+    *
+    * \param callback The database callback to invoke at the end of the query.
+    * \param ref State data needed for the callback to process the results.
+    * \param name The name the statement was registered with.
+    * \param parameters The values for the placeholders of the statement.
+    */
+    void executePreparedAsync(DatabaseCallback* callback, void* ref, const std::string& name, const StatementParameters& parameters);
+
     /*! Processes async queries.
     */
     void process();
+
+    /*! The async jobs waiting for a worker thread, a snapshot.
+    */
+    uint32_t getPendingJobCount() { return static_cast<uint32_t>(job_pending_queue_.unsafe_size()); }
     
     /*! Executes an sql query with an unspecified number of parameters.
     *
@@ -268,6 +325,10 @@ private:
     
     void pushDatabaseJobComplete(DatabaseJob* job);
 
+    const PreparedStatementInfo* findStatement_(const std::string& name);
+    void pushPreparedJob_(const std::string& name, const StatementParameters& parameters, DatabaseJob* job);
+    void destroyJob_(DatabaseJob* job);
+
     DataBindingFactory binding_factory_;
 
     DatabaseJobQueue job_pending_queue_;
@@ -279,6 +340,10 @@ private:
     boost::pool<boost::default_user_allocator_malloc_free> job_pool_;
     boost::pool<boost::default_user_allocator_malloc_free> transaction_pool_;
 
+    // the registered statements by name, entries are never removed
+    boost::mutex statement_mutex_;
+    std::map<std::string, std::unique_ptr<PreparedStatementInfo>> statements_;
+
     std::string global_;
     std::string galaxy_;
     std::string config_;
@@ -33,6 +33,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include <boost/pool/singleton_pool.hpp>
 
 #include "DatabaseManager/DatabaseResult.h"
+#include "DatabaseManager/StatementParameters.h"
 namespace swganh {
 namespace database {
 
@@ -58,6 +59,14 @@ public:
     */
     virtual DatabaseResult* executeSql(const std::string& sql, bool procedure = false) = 0;
 
+    /*! Executes a prepared statement and returns a result set. The statement is
+    * prepared on first use and cached by the implementation/connection.
+    *
+    * \param statement The registered statement to execute.
+    * \param parameters The values for the placeholders of the statement.
+    */
+    virtual DatabaseResult* executePrepared(const PreparedStatementInfo& statement, const StatementParameters& parameters) = 0;
+
     /*! Destroys the requested database result.
     *
     * \param result The database result to destroy.
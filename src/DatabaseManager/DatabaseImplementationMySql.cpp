@@ -41,7 +41,9 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include <mysql_connection.h>
 #include <mysql_driver.h>
 
+#include <cppconn/datatype.h>
 #include <cppconn/exception.h>
+#include <cppconn/prepared_statement.h>
 #include <cppconn/statement.h>
 #include <cppconn/resultset.h>
 
@@ -100,6 +102,51 @@ DatabaseResult* DatabaseImplementationMySql::executeSql(const std::string& sql,
 }
 
 
+DatabaseResult* DatabaseImplementationMySql::executePrepared(const PreparedStatementInfo& info, const StatementParameters& parameters) {
+    DatabaseResult* result = nullptr;
+
+    boost::atomic<bool>* lease = nullptr;
+    sql::PreparedStatement* statement = nullptr;
+
+    try {
+        // a cached statement whose last result is still being read is not shared, a new one is prepared
+        statement = prepared_statements_.acquire(info.id, [this, &info] () {
+            return connection_->prepareStatement(info.sql);
+        }, lease);
+
+        bindParameters_(statement, parameters);
+        statement->execute();
+
+        sql::ResultSet* result_set = statement->getResultSet();
+
+        // nothing is left to read, the statement is released here so the next execution,
+        // which may already be waiting on this thread, does not have to prepare one of its own
+        if (!result_set) {
+            if (lease) {
+                lease->store(false);
+            } else {
+                delete statement;
+            }
+
+            statement = nullptr;
+            lease = nullptr;
+        }
+
+        result = new(ResultPool::ordered_malloc()) DatabaseResult(*this, statement, result_set, false, lease);
+    } catch(const sql::SQLException& e) {
+        LOG(fatal) << info.name << ": " << e.what();
+
+        if (lease) {
+            prepared_statements_.drop(info.id);
+        } else {
+            delete statement;
+        }
+    }
+
+    return result;
+}
+
+
 void DatabaseImplementationMySql::destroyResult(DatabaseResult* result) {
     if (!result)
     {
@@ -117,14 +164,20 @@ void DatabaseImplementationMySql::destroyResult(DatabaseResult* result) {
             while(res->next()) {}
         }
     }
-	sql::Statement* statement = result->getStatement().get();
-	result->getStatement().release();
-	delete(statement);
-
 	sql::ResultSet* res = result->getResultSet().get();
 	result->getResultSet().release();
 	delete(res);
 
+	sql::Statement* statement = result->getStatement().get();
+	result->getStatement().release();
+
+	// a cached prepared statement is free for the next execution once its result set is gone
+	if (result->getStatementLease()) {
+		result->getStatementLease()->store(false);
+	} else {
+		delete(statement);
+	}
+
     ResultPool::ordered_free(result);
 }
 
@@ -315,6 +368,41 @@ void DatabaseImplementationMySql::processFieldBinding_(
     }    
 }
 
+void DatabaseImplementationMySql::bindParameters_(sql::PreparedStatement* statement, const StatementParameters& parameters) const {
+    for (uint32_t i = 0, count = parameters.getCount(); i < count; ++i) {
+        const StatementParameter& parameter = parameters.getParameter(i);
+
+        // Mysql Connector/c++ starts it's parameter index with 1 as well.
+        switch (parameter.type) {
+            case SPT_int: {
+                statement->setInt64(i + 1, parameter.int_value);
+                break;
+            }
+
+            case SPT_uint: {
+                statement->setUInt64(i + 1, parameter.uint_value);
+                break;
+            }
+
+            case SPT_double: {
+                statement->setDouble(i + 1, parameter.double_value);
+                break;
+            }
+
+            case SPT_string: {
+                statement->setString(i + 1, parameter.string_value);
+                break;
+            }
+
+            case SPT_null:
+            default: {
+                statement->setNull(i + 1, sql::DataType::SQLNULL);
+                break;
+            }
+        }
+    }
+}
+
 #ifdef _WIN32
 #pragma warning(pop)
 #endif
@@ -35,9 +35,11 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include <boost/noncopyable.hpp>
 
 #include "DatabaseManager/DatabaseImplementation.h"
+#include "DatabaseManager/StatementCache.h"
 
 namespace sql {
     class Connection;
+    class PreparedStatement;
     class ResultSet;
     class Statement;
 }
@@ -53,6 +55,7 @@ public:
     ~DatabaseImplementationMySql();
 
     DatabaseResult* executeSql(const std::string& sql, bool procedure = false);
+    DatabaseResult* executePrepared(const PreparedStatementInfo& statement, const StatementParameters& parameters);
     void destroyResult(DatabaseResult* result);
 
     void getNextRow(DatabaseResult* result, DataBinding* binding, void* object) const;
@@ -64,9 +67,12 @@ public:
 
 private:
     void processFieldBinding_(std::unique_ptr<sql::ResultSet>& result, DataBinding* binding, uint32_t field_id, void* object) const;
+    void bindParameters_(sql::PreparedStatement* statement, const StatementParameters& parameters) const;
 
     std::unique_ptr<sql::Connection> connection_;
     std::unique_ptr<sql::Statement> statement_;
+
+    StatementCache<sql::PreparedStatement> prepared_statements_;
 };
 }}
 #endif // ANH_DATABASEMANAGER_DATABASEIMPLEMENTATIONMYSQL_H
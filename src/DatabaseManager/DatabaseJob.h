@@ -34,6 +34,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include <boost/optional.hpp>
 
 #include "DatabaseManager/DatabaseCallback.h"
+#include "DatabaseManager/StatementParameters.h"
 
 namespace swganh {
 namespace database {
@@ -48,6 +49,8 @@ public:
         , result(NULL)
         , client_reference(NULL)
         , multi_job(false) 
+        , statement(NULL)
+        , report_failure(false)
     {}
 
     boost::optional<AsyncDatabaseCallback> callback;
@@ -56,6 +59,13 @@ public:
     void* client_reference;
     std::string query;
     bool multi_job;
+
+    // set for prepared statements instead of the query
+    const PreparedStatementInfo* statement;
+    StatementParameters parameters;
+
+    // the callback is invoked with a null result if the query fails
+    bool report_failure;
 };
 }}
 #endif // ANH_DATABASEMANAGER_DATABASEJOB_H
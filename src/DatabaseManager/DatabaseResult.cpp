@@ -44,11 +44,12 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 using namespace swganh;
 using namespace database;
 
-DatabaseResult::DatabaseResult(const DatabaseImplementation& impl, sql::Statement* statement, sql::ResultSet* result_set, bool multi_result)
+DatabaseResult::DatabaseResult(const DatabaseImplementation& impl, sql::Statement* statement, sql::ResultSet* result_set, bool multi_result, boost::atomic<bool>* statement_lease)
     : result_set_(result_set)
 	, statement_(statement)
     , impl_(impl)
     , worker_(nullptr)
+    , statement_lease_(statement_lease)
     , multi_result_(multi_result) {}
 
 
@@ -60,6 +61,11 @@ std::unique_ptr<sql::Statement>& DatabaseResult::getStatement() {
 }
 
 
+boost::atomic<bool>* DatabaseResult::getStatementLease() {
+    return statement_lease_;
+}
+
+
 std::unique_ptr<sql::ResultSet>& DatabaseResult::getResultSet() {
     return result_set_;
 }
@@ -31,6 +31,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include <cstdint>
 #include <memory>
 
+#include <boost/atomic.hpp>
 #include <boost/noncopyable.hpp>
 
 namespace sql {
@@ -54,17 +55,25 @@ public:
     * \param statement The sql query/statement that was just executed.
     * \param result_set The result set provided by the underlying database abstraction library
     * \param multi_result Indicates whether the query was a multi-result query.
+    * \param statement_lease Set for a cached prepared statement, which is handed
+    *   back instead of destroyed along with the result.
     */
     DatabaseResult(const DatabaseImplementation& impl, 
                    sql::Statement* statement, 
                    sql::ResultSet* result_set, 
-                   bool multi_result);
+                   bool multi_result,
+                   boost::atomic<bool>* statement_lease = nullptr);
     ~DatabaseResult();
     
     /*! Returns the statement was executed.
     */
     std::unique_ptr<sql::Statement>& getStatement();
 
+    /*! Returns the lease of a cached prepared statement, nullptr if the result owns
+    * its statement.
+    */
+    boost::atomic<bool>* getStatementLease();
+
     /*! Returns the result set from the underlying database abstraction library.
     */
     std::unique_ptr<sql::ResultSet>& getResultSet();
@@ -105,6 +114,7 @@ private:
     const DatabaseImplementation& impl_;
 
     DatabaseWorkerThread* worker_;
+    boost::atomic<bool>* statement_lease_;
     bool multi_result_;
 };
 
@@ -45,7 +45,11 @@ DatabaseWorkerThread::DatabaseWorkerThread(DBType type, const std::string& host,
 
 void DatabaseWorkerThread::executeJob(DatabaseJob* job, Callback callback) { 
     active_.Send([=] {
-        job->result = database_impl_->executeSql(job->query.c_str(), job->multi_job);
+        if (job->statement) {
+            job->result = database_impl_->executePrepared(*job->statement, job->parameters);
+        } else {
+            job->result = database_impl_->executeSql(job->query.c_str(), job->multi_job);
+        }
         callback(this, job);
     }); 
 }
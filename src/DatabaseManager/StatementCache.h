@@ -0,0 +1,110 @@
+/*
+---------------------------------------------------------------------------------------
+This source file is part of SWG:ANH (Star Wars Galaxies - A New Hope - Server Emulator)
+
+For more information, visit http://www.swganh.com
+
+Copyright (c) 2006 - 2014 The SWG:ANH Team
+---------------------------------------------------------------------------------------
+Use of this source code is governed by the GPL v3 license that can be found
+in the COPYING file or at http://www.gnu.org/licenses/gpl-3.0.html
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+---------------------------------------------------------------------------------------
+*/
+
+#ifndef ANH_DATABASEMANAGER_STATEMENTCACHE_H
+#define ANH_DATABASEMANAGER_STATEMENTCACHE_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <boost/atomic.hpp>
+#include <boost/noncopyable.hpp>
+
+namespace swganh {
+namespace database {
+
+// The statements prepared on one connection, indexed by the id of the registered statement.
+// A cached statement is leased to one execution at a time; an execution that finds it leased
+// gets a statement of its own, which the caller deletes once done with it.
+//======================================================================================================================
+template<typename Statement>
+class StatementCache : private boost::noncopyable {
+public:
+    /*! Returns the statement to execute for id, preparing it on first use.
+    *
+    * \param prepare Called to prepare a statement, returns a new Statement.
+    * \param lease Set to the lease of the cached statement, store false in it to release the
+    *        statement. Set to nullptr if the cached statement was busy and a new one was prepared.
+    */
+    template<typename Prepare>
+    Statement* acquire(uint32_t id, Prepare prepare, boost::atomic<bool>*& lease) {
+        if (entries_.size() <= id) {
+            entries_.resize(id + 1);
+        }
+
+        std::unique_ptr<Entry>& entry = entries_[id];
+
+        if (!entry) {
+            entry.reset(new Entry());
+        }
+
+        if (entry->leased.exchange(true)) {
+            lease = nullptr;
+            return prepare();
+        }
+
+        lease = &entry->leased;
+
+        if (!entry->statement) {
+            try {
+                entry->statement.reset(prepare());
+            } catch(...) {
+                lease = nullptr;
+                entry->leased.store(false);
+                throw;
+            }
+        }
+
+        return entry->statement.get();
+    }
+
+    /*! Drops the cached statement of id after a failed execution and releases it, it is
+    * prepared anew next time as the connection might have been lost along with it.
+    */
+    void drop(uint32_t id) {
+        if (entries_.size() <= id || !entries_[id]) {
+            return;
+        }
+
+        entries_[id]->statement.reset();
+        entries_[id]->leased.store(false);
+    }
+
+private:
+    struct Entry {
+        Entry() : leased(false) {}
+
+        std::unique_ptr<Statement> statement;
+        boost::atomic<bool> leased;
+    };
+
+    std::vector<std::unique_ptr<Entry>> entries_;
+};
+
+}}
+#endif // ANH_DATABASEMANAGER_STATEMENTCACHE_H
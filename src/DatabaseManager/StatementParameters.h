@@ -0,0 +1,135 @@
+/*
+---------------------------------------------------------------------------------------
+This source file is part of SWG:ANH (Star Wars Galaxies - A New Hope - Server Emulator)
+
+For more information, visit http://www.swganh.com
+
+Copyright (c) 2006 - 2014 The SWG:ANH Team
+---------------------------------------------------------------------------------------
+Use of this source code is governed by the GPL v3 license that can be found
+in the COPYING file or at http://www.gnu.org/licenses/gpl-3.0.html
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+---------------------------------------------------------------------------------------
+*/
+
+#ifndef ANH_DATABASEMANAGER_STATEMENTPARAMETERS_H
+#define ANH_DATABASEMANAGER_STATEMENTPARAMETERS_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// The parameters of a prepared statement, in the order of the '?' placeholders in its sql.
+// They are sent in the binary protocol, strings need no escaping.
+//======================================================================================================================
+/*
+  mDatabase->registerStatement("character_position", "UPDATE characters SET x=?, y=?, z=? WHERE id=?");
+
+  StatementParameters parameters;
+  parameters.addDouble(x).addDouble(y).addDouble(z).addUint(id);
+  mDatabase->executePreparedAsync("character_position", parameters);
+*/
+
+namespace swganh {
+namespace database {
+
+enum StatementParameterType
+{
+    SPT_null,
+    SPT_int,
+    SPT_uint,
+    SPT_double,
+    SPT_string
+};
+
+
+struct StatementParameter {
+    StatementParameter()
+        : type(SPT_null)
+        , int_value(0)
+        , uint_value(0)
+        , double_value(0) {}
+
+    StatementParameterType type;
+    int64_t                int_value;
+    uint64_t               uint_value;
+    double                 double_value;
+    std::string            string_value;
+};
+
+
+/*! A named statement registered with the Database, every connection prepares it
+* once and reuses it from then on.
+*/
+struct PreparedStatementInfo {
+    uint32_t    id;
+    std::string name;
+    std::string sql;
+};
+
+
+class StatementParameters {
+public:
+    StatementParameters& addInt(int64_t value) {
+        StatementParameter& parameter = add_(SPT_int);
+        parameter.int_value = value;
+        return *this;
+    }
+
+    StatementParameters& addUint(uint64_t value) {
+        StatementParameter& parameter = add_(SPT_uint);
+        parameter.uint_value = value;
+        return *this;
+    }
+
+    StatementParameters& addDouble(double value) {
+        StatementParameter& parameter = add_(SPT_double);
+        parameter.double_value = value;
+        return *this;
+    }
+
+    StatementParameters& addString(const std::string& value) {
+        StatementParameter& parameter = add_(SPT_string);
+        parameter.string_value = value;
+        return *this;
+    }
+
+    StatementParameters& addNull() {
+        add_(SPT_null);
+        return *this;
+    }
+
+    uint32_t getCount() const {
+        return static_cast<uint32_t>(parameters_.size());
+    }
+
+    const StatementParameter& getParameter(uint32_t index) const {
+        return parameters_[index];
+    }
+
+private:
+    StatementParameter& add_(StatementParameterType type) {
+        parameters_.push_back(StatementParameter());
+        parameters_.back().type = type;
+        return parameters_.back();
+    }
+
+    std::vector<StatementParameter> parameters_;
+};
+
+}}
+
+#endif //ANH_DATABASEMANAGER_STATEMENTPARAMETERS_H
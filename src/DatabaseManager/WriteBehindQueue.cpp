@@ -0,0 +1,389 @@
+/*
+---------------------------------------------------------------------------------------
+This source file is part of SWG:ANH (Star Wars Galaxies - A New Hope - Server Emulator)
+
+For more information, visit http://www.swganh.com
+
+Copyright (c) 2006 - 2014 The SWG:ANH Team
+---------------------------------------------------------------------------------------
+Use of this source code is governed by the GPL v3 license that can be found
+in the COPYING file or at http://www.gnu.org/licenses/gpl-3.0.html
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+---------------------------------------------------------------------------------------
+*/
+
+#include "DatabaseManager/WriteBehindQueue.h"
+
+#include <algorithm>
+
+#include "anh/logger.h"
+#include "anh/Utils/clock.h"
+
+#include "DatabaseManager/Database.h"
+#include "DatabaseManager/DatabaseResult.h"
+
+using namespace swganh;
+using namespace database;
+
+namespace {
+    // a flush statement the database hasn't answered in this time is given up on
+    const uint64_t kStatementTimeout = 60000;
+
+    // failed statements are sent again right away this often before their rows wait for the next flush
+    const uint32_t kMaxRetries = 2;
+}
+
+WriteBehindQueue::WriteBehindQueue(Database* database, uint32_t max_rows)
+    : database_(database)
+    , max_rows_(std::max<uint32_t>(max_rows, 1))
+    , oldest_dirty_(0)
+    , failures_in_row_(0)
+    , next_statement_id_(0)
+{}
+
+
+WriteBehindQueue::~WriteBehindQueue() {
+    flushSync();
+}
+
+
+void WriteBehindQueue::registerTable(const std::string& table, const std::string& key_column, const std::string& second_key_column) {
+    boost::mutex::scoped_lock lock(mutex_);
+
+    DirtyTable& dirty_table = tables_[table];
+    dirty_table.key_columns[0] = key_column;
+    dirty_table.key_columns[1] = second_key_column;
+    dirty_table.key_count = second_key_column.empty() ? 1 : 2;
+}
+
+
+void WriteBehindQueue::markString(const std::string& table, const RowKey& key, const std::string& column, const std::string& value) {
+    StatementParameter parameter;
+    parameter.type = SPT_string;
+    parameter.string_value = value;
+    mark_(table, key, column, parameter);
+}
+
+
+void WriteBehindQueue::markUint(const std::string& table, const RowKey& key, const std::string& column, uint64_t value) {
+    StatementParameter parameter;
+    parameter.type = SPT_uint;
+    parameter.uint_value = value;
+    mark_(table, key, column, parameter);
+}
+
+
+void WriteBehindQueue::markInt(const std::string& table, const RowKey& key, const std::string& column, int64_t value) {
+    StatementParameter parameter;
+    parameter.type = SPT_int;
+    parameter.int_value = value;
+    mark_(table, key, column, parameter);
+}
+
+
+void WriteBehindQueue::markDouble(const std::string& table, const RowKey& key, const std::string& column, double value) {
+    StatementParameter parameter;
+    parameter.type = SPT_double;
+    parameter.double_value = value;
+    mark_(table, key, column, parameter);
+}
+
+
+void WriteBehindQueue::mark_(const std::string& table, const RowKey& key, const std::string& column, StatementParameter& value) {
+    boost::mutex::scoped_lock lock(mutex_);
+
+    auto table_it = tables_.find(table);
+
+    if (table_it == tables_.end()) {
+        LOG(error) << "WriteBehindQueue::mark_ table " << table << " was never registered, " << column << " is not written";
+        return;
+    }
+
+    DirtyTable& dirty_table = table_it->second;
+    RowKey row_key(key.first, dirty_table.key_count == 2 ? key.second : 0);
+
+    DirtyRow& row = dirty_table.rows[row_key];
+
+    if (!row.dirty_since) {
+        row.dirty_since = gClock->getLocalTime();
+
+        if (!oldest_dirty_) {
+            oldest_dirty_ = row.dirty_since;
+        }
+    }
+
+    StatementParameter& current = row.columns[column];
+
+    if (current.type != SPT_null) {
+        ++stats_.coalesced;
+    }
+
+    std::swap(current, value);
+    ++stats_.marked;
+}
+
+
+uint32_t WriteBehindQueue::getDirtyRowCount() {
+    boost::mutex::scoped_lock lock(mutex_);
+
+    uint32_t count = 0;
+
+    std::for_each(tables_.begin(), tables_.end(), [&count] (const std::pair<const std::string, DirtyTable>& table) {
+        count += static_cast<uint32_t>(table.second.rows.size());
+    });
+
+    return count;
+}
+
+
+void WriteBehindQueue::flush() {
+    std::vector<WriteBehindStatement> statements;
+    collect_(statements);
+
+    std::for_each(statements.begin(), statements.end(), [this] (WriteBehindStatement& statement) {
+        sendStatement_(statement);
+    });
+
+    expireStatements_(gClock->getLocalTime());
+}
+
+
+void WriteBehindQueue::flush(FlushCallback callback) {
+    {
+        boost::mutex::scoped_lock lock(mutex_);
+
+        Waiter waiter = { callback, true };
+        waiters_.push_back(waiter);
+    }
+
+    flush();
+
+    // nothing was dirty or in flight
+    notifyWaiters_();
+}
+
+
+bool WriteBehindQueue::flushSync() {
+    std::vector<WriteBehindStatement> statements;
+    collect_(statements);
+
+    bool written = true;
+
+    std::for_each(statements.begin(), statements.end(), [this, &written] (WriteBehindStatement& statement) {
+        uint64_t sent = gClock->getLocalTime();
+        DatabaseResult* result = database_->executeSql(statement.sql);
+
+        boost::mutex::scoped_lock lock(mutex_);
+
+        ++stats_.statements;
+
+        if (!result) {
+            ++stats_.failed_statements;
+            LOG(error) << "WriteBehindQueue::flushSync failed to write: " << statement.sql;
+            restore_(statement);
+            written = false;
+            return;
+        }
+
+        uint64_t latency = gClock->getLocalTime() - sent;
+        stats_.last_flush_latency = latency;
+        stats_.max_flush_latency = std::max(stats_.max_flush_latency, latency);
+        stats_.total_flush_latency += latency;
+        stats_.rows_written += statement.rows.size();
+
+        lock.unlock();
+        database_->destroyResult(result);
+    });
+
+    if (!statements.empty()) {
+        logStats();
+    }
+
+    return written;
+}
+
+
+void WriteBehindQueue::logStats() {
+    boost::mutex::scoped_lock lock(mutex_);
+
+    uint64_t answered = stats_.statements - stats_.failed_statements;
+
+    LOG(info) << "WriteBehindQueue STATS: marked: " << stats_.marked << ", coalesced: " << stats_.coalesced
+        << ", rows written: " << stats_.rows_written << " in " << stats_.statements << " statements (" << stats_.failed_statements << " failed)"
+        << ", flush latency last/avg/max: " << stats_.last_flush_latency << "/" << (answered ? stats_.total_flush_latency / answered : 0)
+        << "/" << stats_.max_flush_latency << "ms, max write delay: " << stats_.max_write_delay << "ms";
+}
+
+
+void WriteBehindQueue::collect_(std::vector<WriteBehindStatement>& statements) {
+    boost::mutex::scoped_lock lock(mutex_);
+
+    if (!oldest_dirty_) {
+        return;
+    }
+
+    uint64_t now = gClock->getLocalTime();
+    stats_.max_write_delay = std::max(stats_.max_write_delay, now - oldest_dirty_);
+    oldest_dirty_ = 0;
+
+    ++stats_.flushes;
+
+    EscapeFunction escape = [this] (const std::string& value) {
+        return database_->escapeString(value);
+    };
+
+    for (auto it = tables_.begin(); it != tables_.end(); ++it) {
+        if (!it->second.rows.empty()) {
+            buildWriteBehindStatements(database_->galaxy(), it->first, it->second, max_rows_, escape, statements);
+        }
+    }
+}
+
+
+void WriteBehindQueue::restore_(WriteBehindStatement& statement) {
+    auto table_it = tables_.find(statement.table);
+
+    if (table_it == tables_.end()) {
+        return;
+    }
+
+    restoreDirtyRows(statement.rows, table_it->second);
+
+    std::for_each(statement.rows.begin(), statement.rows.end(), [this] (const std::pair<const RowKey, DirtyRow>& row) {
+        if (!oldest_dirty_ || row.second.dirty_since < oldest_dirty_) {
+            oldest_dirty_ = row.second.dirty_since;
+        }
+    });
+
+    statement.rows.clear();
+}
+
+
+void WriteBehindQueue::sendStatement_(WriteBehindStatement& statement) {
+    uint32_t statement_id;
+    std::string sql;
+
+    {
+        boost::mutex::scoped_lock lock(mutex_);
+
+        statement_id = next_statement_id_++;
+        InFlight& in_flight = in_flight_[statement_id];
+        in_flight.sent = gClock->getLocalTime();
+        in_flight.statement.table.swap(statement.table);
+        in_flight.statement.rows.swap(statement.rows);
+        sql.swap(statement.sql);
+        ++stats_.statements;
+    }
+
+    database_->executeCheckedAsyncSql(sql, [this, statement_id] (DatabaseResult* result) {
+        statementDone_(statement_id, result != nullptr);
+    });
+}
+
+
+void WriteBehindQueue::statementDone_(uint32_t statement_id, bool written) {
+    bool retry = false;
+
+    {
+        boost::mutex::scoped_lock lock(mutex_);
+
+        auto it = in_flight_.find(statement_id);
+
+        // expired already, its rows were marked dirty again
+        if (it == in_flight_.end()) {
+            return;
+        }
+
+        if (written) {
+            uint64_t latency = gClock->getLocalTime() - it->second.sent;
+            stats_.last_flush_latency = latency;
+            stats_.max_flush_latency = std::max(stats_.max_flush_latency, latency);
+            stats_.total_flush_latency += latency;
+            stats_.rows_written += it->second.statement.rows.size();
+
+            failures_in_row_ = 0;
+        } else {
+            ++stats_.failed_statements;
+            retry = ++failures_in_row_ <= kMaxRetries;
+
+            LOG(error) << "WriteBehindQueue::statementDone_ failed to write " << it->second.statement.rows.size() << " rows of "
+                << it->second.statement.table << (retry ? ", retrying" : ", they are written with the next flush");
+
+            restore_(it->second.statement);
+
+            if (!retry) {
+                failWaiters_();
+            }
+        }
+
+        in_flight_.erase(it);
+    }
+
+    // sends the restored rows along with anything marked since, with their newest values
+    if (retry) {
+        flush();
+    }
+
+    notifyWaiters_();
+}
+
+
+void WriteBehindQueue::expireStatements_(uint64_t now) {
+    {
+        boost::mutex::scoped_lock lock(mutex_);
+
+        for (auto it = in_flight_.begin(); it != in_flight_.end();) {
+            if (now - it->second.sent > kStatementTimeout) {
+                LOG(error) << "WriteBehindQueue::expireStatements_ no answer for a flush statement in " << (now - it->second.sent)
+                    << "ms, its rows are written with the next flush";
+                ++stats_.failed_statements;
+                restore_(it->second.statement);
+                failWaiters_();
+                in_flight_.erase(it++);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    notifyWaiters_();
+}
+
+
+void WriteBehindQueue::failWaiters_() {
+    std::for_each(waiters_.begin(), waiters_.end(), [] (Waiter& waiter) {
+        waiter.written = false;
+    });
+}
+
+
+void WriteBehindQueue::notifyWaiters_() {
+    std::vector<Waiter> waiters;
+
+    {
+        boost::mutex::scoped_lock lock(mutex_);
+
+        if (!in_flight_.empty() || waiters_.empty()) {
+            return;
+        }
+
+        waiters.swap(waiters_);
+    }
+
+    std::for_each(waiters.begin(), waiters.end(), [] (const Waiter& waiter) {
+        waiter.callback(waiter.written);
+    });
+}
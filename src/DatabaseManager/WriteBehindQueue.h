@@ -0,0 +1,194 @@
+/*
+---------------------------------------------------------------------------------------
+This source file is part of SWG:ANH (Star Wars Galaxies - A New Hope - Server Emulator)
+
+For more information, visit http://www.swganh.com
+
+Copyright (c) 2006 - 2014 The SWG:ANH Team
+---------------------------------------------------------------------------------------
+Use of this source code is governed by the GPL v3 license that can be found
+in the COPYING file or at http://www.gnu.org/licenses/gpl-3.0.html
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+---------------------------------------------------------------------------------------
+*/
+
+#ifndef ANH_DATABASEMANAGER_WRITEBEHINDQUEUE_H
+#define ANH_DATABASEMANAGER_WRITEBEHINDQUEUE_H
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include "DatabaseManager/WriteBehindStatement.h"
+
+// Holds back single row UPDATEs and writes them in batches. Writing the same column of
+// a row again before the flush only replaces the value, every flush sends one UPDATE per
+// table and up to max_rows rows. The rows of a failed UPDATE are marked dirty again.
+//======================================================================================================================
+/*
+  queue->registerTable("item_attributes", "item_id", "attribute_id");
+
+  queue->markString("item_attributes", RowKey(tool->getId(), AttrType_CraftToolTime), "value", "15");
+
+  UPDATE galaxy.item_attributes SET value = CASE WHEN item_id=1 AND attribute_id=22 THEN '15' ... ELSE value END
+  WHERE (item_id,attribute_id) IN ((1,22),...)
+*/
+
+namespace swganh {
+namespace database {
+
+class Database;
+class DatabaseResult;
+
+struct WriteBehindStats {
+    WriteBehindStats()
+        : marked(0)
+        , coalesced(0)
+        , rows_written(0)
+        , statements(0)
+        , failed_statements(0)
+        , flushes(0)
+        , last_flush_latency(0)
+        , max_flush_latency(0)
+        , total_flush_latency(0)
+        , max_write_delay(0) {}
+
+    // columns marked dirty, and those of them replacing a value not yet written
+    uint64_t marked;
+    uint64_t coalesced;
+
+    uint64_t rows_written;
+    uint64_t statements;
+    uint64_t failed_statements;
+    uint64_t flushes;
+
+    // milliseconds from sending a statement until the database is done with it
+    uint64_t last_flush_latency;
+    uint64_t max_flush_latency;
+    uint64_t total_flush_latency;
+
+    // milliseconds the oldest row of a flush waited to be written
+    uint64_t max_write_delay;
+};
+
+
+class WriteBehindQueue : private boost::noncopyable {
+public:
+    typedef std::function<void (bool written)> FlushCallback;
+
+    /*! \param database The database the rows are written to, its galaxy schema holds the tables.
+    * \param max_rows The most rows a single UPDATE carries.
+    */
+    WriteBehindQueue(Database* database, uint32_t max_rows = 100);
+    ~WriteBehindQueue();
+
+    /*! Registers a table by the columns of its primary key.
+    *
+    * \param table The table name without schema.
+    * \param key_column The first key column.
+    * \param second_key_column The second key column, empty for a single column key.
+    */
+    void registerTable(const std::string& table, const std::string& key_column, const std::string& second_key_column = "");
+
+    /*! Marks a column of a row dirty, it is written with the next flush.
+    *
+    * \param table A registered table.
+    * \param key The key of the row, the second part is ignored for a single column key.
+    * \param column The column to write.
+    * \param value The value to write, replacing any value still waiting for the column.
+    */
+    void markString(const std::string& table, const RowKey& key, const std::string& column, const std::string& value);
+    void markUint(const std::string& table, const RowKey& key, const std::string& column, uint64_t value);
+    void markInt(const std::string& table, const RowKey& key, const std::string& column, int64_t value);
+    void markDouble(const std::string& table, const RowKey& key, const std::string& column, double value);
+
+    /*! Sends everything dirty to the database, asynchronusly.
+    */
+    void flush();
+
+    /*! Sends everything dirty to the database and invokes the callback once it and all
+    * earlier flushes are written. Used before a character leaves the zone.
+    *
+    * \param callback Invoked from Database::process() once the rows are written, or once
+    *        a failed write was retried and failed again, leaving its rows dirty. It gets
+    *        false if any write given up on since the call left rows dirty.
+    */
+    void flush(FlushCallback callback);
+
+    /*! Writes everything dirty synchronusly, for shutdown.
+    *
+    * \returns false if a write failed, its rows are dirty again.
+    */
+    bool flushSync();
+
+    uint32_t getDirtyRowCount();
+
+    const WriteBehindStats& getStats() const { return stats_; }
+
+    void logStats();
+
+private:
+    void mark_(const std::string& table, const RowKey& key, const std::string& column, StatementParameter& value);
+
+    // builds the statements for everything dirty and clears it, holding mutex_
+    void collect_(std::vector<WriteBehindStatement>& statements);
+
+    void sendStatement_(WriteBehindStatement& statement);
+    void statementDone_(uint32_t statement_id, bool written);
+
+    // marks the rows of a failed statement dirty again, holding mutex_
+    void restore_(WriteBehindStatement& statement);
+
+    // gives up on statements the database never answered
+    void expireStatements_(uint64_t now);
+
+    // tells the waiters of the flushes that rows were left dirty, holding mutex_
+    void failWaiters_();
+    void notifyWaiters_();
+
+    Database* database_;
+    uint32_t max_rows_;
+
+    boost::mutex mutex_;
+    std::map<std::string, DirtyTable> tables_;
+    uint64_t oldest_dirty_;
+
+    struct InFlight {
+        uint64_t sent;
+        WriteBehindStatement statement;
+    };
+
+    std::map<uint32_t, InFlight> in_flight_;
+    uint32_t failures_in_row_;
+    uint32_t next_statement_id_;
+    struct Waiter {
+        FlushCallback callback;
+        bool written;
+    };
+
+    std::vector<Waiter> waiters_;
+
+    WriteBehindStats stats_;
+};
+
+}}
+
+#endif //ANH_DATABASEMANAGER_WRITEBEHINDQUEUE_H
@@ -0,0 +1,146 @@
+/*
+---------------------------------------------------------------------------------------
+This source file is part of SWG:ANH (Star Wars Galaxies - A New Hope - Server Emulator)
+
+For more information, visit http://www.swganh.com
+
+Copyright (c) 2006 - 2014 The SWG:ANH Team
+---------------------------------------------------------------------------------------
+Use of this source code is governed by the GPL v3 license that can be found
+in the COPYING file or at http://www.gnu.org/licenses/gpl-3.0.html
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+---------------------------------------------------------------------------------------
+*/
+
+#include "DatabaseManager/WriteBehindStatement.h"
+
+#include <iterator>
+#include <limits>
+#include <sstream>
+
+using namespace swganh;
+using namespace database;
+
+namespace {
+
+void appendKeyMatch(std::ostringstream& sql, const DirtyTable& table, const RowKey& key) {
+    sql << table.key_columns[0] << "=" << key.first;
+
+    if (table.key_count == 2) {
+        sql << " AND " << table.key_columns[1] << "=" << key.second;
+    }
+}
+
+
+void appendValue(std::ostringstream& sql, const StatementParameter& value, const EscapeFunction& escape) {
+    switch (value.type) {
+        case SPT_int:    sql << value.int_value; break;
+        case SPT_uint:   sql << value.uint_value; break;
+        case SPT_double: sql << value.double_value; break;
+        case SPT_string: sql << "'" << escape(value.string_value) << "'"; break;
+        default:         sql << "NULL"; break;
+    }
+}
+
+}
+
+
+void swganh::database::buildWriteBehindStatements(const std::string& schema, const std::string& table, DirtyTable& dirty_table,
+                                                  uint32_t max_rows, const EscapeFunction& escape, std::vector<WriteBehindStatement>& statements) {
+    DirtyRows::iterator chunk_begin = dirty_table.rows.begin();
+
+    while (chunk_begin != dirty_table.rows.end()) {
+        DirtyRows::iterator chunk_end = chunk_begin;
+        std::map<std::string, uint32_t> columns;
+
+        for (uint32_t count = 0; count < max_rows && chunk_end != dirty_table.rows.end(); ++count, ++chunk_end) {
+            for (auto column = chunk_end->second.columns.begin(); column != chunk_end->second.columns.end(); ++column) {
+                ++columns[column->first];
+            }
+        }
+
+        std::ostringstream sql;
+        sql.precision(std::numeric_limits<double>::digits10 + 2);
+        sql << "UPDATE " << schema << "." << table << " SET ";
+
+        // a column takes its new value in the rows it is dirty in and keeps it in all others
+        for (auto column = columns.begin(); column != columns.end(); ++column) {
+            if (column != columns.begin()) {
+                sql << ", ";
+            }
+
+            sql << column->first << " = CASE";
+
+            for (auto row = chunk_begin; row != chunk_end; ++row) {
+                auto value = row->second.columns.find(column->first);
+
+                if (value != row->second.columns.end()) {
+                    sql << " WHEN ";
+                    appendKeyMatch(sql, dirty_table, row->first);
+                    sql << " THEN ";
+                    appendValue(sql, value->second, escape);
+                }
+            }
+
+            sql << " ELSE " << column->first << " END";
+        }
+
+        if (dirty_table.key_count == 1) {
+            sql << " WHERE " << dirty_table.key_columns[0] << " IN (";
+        } else {
+            sql << " WHERE (" << dirty_table.key_columns[0] << "," << dirty_table.key_columns[1] << ") IN (";
+        }
+
+        for (auto row = chunk_begin; row != chunk_end; ++row) {
+            if (row != chunk_begin) {
+                sql << ",";
+            }
+
+            if (dirty_table.key_count == 1) {
+                sql << row->first.first;
+            } else {
+                sql << "(" << row->first.first << "," << row->first.second << ")";
+            }
+        }
+
+        sql << ")";
+
+        statements.push_back(WriteBehindStatement());
+
+        WriteBehindStatement& statement = statements.back();
+        statement.table = table;
+        statement.sql = sql.str();
+        statement.rows.insert(std::make_move_iterator(chunk_begin), std::make_move_iterator(chunk_end));
+
+        chunk_begin = chunk_end;
+    }
+
+    dirty_table.rows.clear();
+}
+
+
+void swganh::database::restoreDirtyRows(DirtyRows& rows, DirtyTable& dirty_table) {
+    for (auto it = rows.begin(); it != rows.end(); ++it) {
+        DirtyRow& row = dirty_table.rows[it->first];
+
+        // insert does not replace the columns marked again since the statement was built
+        row.columns.insert(it->second.columns.begin(), it->second.columns.end());
+
+        if (!row.dirty_since || it->second.dirty_since < row.dirty_since) {
+            row.dirty_since = it->second.dirty_since;
+        }
+    }
+}
@@ -0,0 +1,107 @@
+/*
+---------------------------------------------------------------------------------------
+This source file is part of SWG:ANH (Star Wars Galaxies - A New Hope - Server Emulator)
+
+For more information, visit http://www.swganh.com
+
+Copyright (c) 2006 - 2014 The SWG:ANH Team
+---------------------------------------------------------------------------------------
+Use of this source code is governed by the GPL v3 license that can be found
+in the COPYING file or at http://www.gnu.org/licenses/gpl-3.0.html
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+---------------------------------------------------------------------------------------
+*/
+
+#ifndef ANH_DATABASEMANAGER_WRITEBEHINDSTATEMENT_H
+#define ANH_DATABASEMANAGER_WRITEBEHINDSTATEMENT_H
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "DatabaseManager/StatementParameters.h"
+
+// The batched UPDATEs of the WriteBehindQueue. A statement keeps the rows it writes, so
+// they can be marked dirty again if it fails.
+//======================================================================================================================
+
+namespace swganh {
+namespace database {
+
+/*! The primary key of a row, one or two columns.
+*/
+struct RowKey {
+    RowKey(uint64_t first_ = 0, uint64_t second_ = 0)
+        : first(first_)
+        , second(second_) {}
+
+    bool operator<(const RowKey& other) const {
+        return first < other.first || (first == other.first && second < other.second);
+    }
+
+    uint64_t first;
+    uint64_t second;
+};
+
+
+struct DirtyRow {
+    DirtyRow() : dirty_since(0) {}
+
+    std::map<std::string, StatementParameter> columns;
+    uint64_t dirty_since;
+};
+
+typedef std::map<RowKey, DirtyRow> DirtyRows;
+
+
+struct DirtyTable {
+    DirtyTable() : key_count(1) {}
+
+    std::string key_columns[2];
+    uint32_t key_count;
+    DirtyRows rows;
+};
+
+
+struct WriteBehindStatement {
+    std::string table;
+    std::string sql;
+    DirtyRows rows;
+};
+
+typedef std::function<std::string (const std::string&)> EscapeFunction;
+
+/*! Builds the UPDATEs writing the dirty rows of a table and moves the rows into them.
+*
+* \param schema The schema holding the table.
+* \param table The table name without schema.
+* \param dirty_table The rows to write, empty afterwards.
+* \param max_rows The most rows a single UPDATE carries.
+* \param escape Escapes string values.
+* \param statements The statements are appended to it.
+*/
+void buildWriteBehindStatements(const std::string& schema, const std::string& table, DirtyTable& dirty_table,
+                                uint32_t max_rows, const EscapeFunction& escape, std::vector<WriteBehindStatement>& statements);
+
+/*! Marks the rows of a failed statement dirty again, columns marked since keep their newer value.
+*/
+void restoreDirtyRows(DirtyRows& rows, DirtyTable& dirty_table);
+
+}}
+
+#endif //ANH_DATABASEMANAGER_WRITEBEHINDSTATEMENT_H
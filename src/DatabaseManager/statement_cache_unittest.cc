@@ -0,0 +1,134 @@
+/*
+ This file is part of MMOServer. For more information, visit http://swganh.com
+
+ Copyright (c) 2006 - 2014 The SWG:ANH Team
+
+ MMOServer is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ MMOServer is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with MMOServer.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+
+#include "DatabaseManager/StatementCache.h"
+
+using swganh::database::StatementCache;
+
+namespace {
+
+struct FakeStatement {};
+
+// Counts the statements prepared through it, as a connection would round trip for each.
+struct CountingPrepare {
+    explicit CountingPrepare(int& count) : count_(count) {}
+
+    FakeStatement* operator()() const {
+        ++count_;
+        return new FakeStatement();
+    }
+
+    int& count_;
+};
+
+}  // namespace
+
+TEST(StatementCacheTest, PreparesAStatementOnFirstUse) {
+    StatementCache<FakeStatement> cache;
+    int prepared = 0;
+    boost::atomic<bool>* lease = nullptr;
+
+    FakeStatement* statement = cache.acquire(3, CountingPrepare(prepared), lease);
+
+    EXPECT_TRUE(statement != nullptr);
+    EXPECT_TRUE(lease != nullptr);
+    EXPECT_EQ(1, prepared);
+}
+
+TEST(StatementCacheTest, ReusesAReleasedStatementWithoutPreparingItAgain) {
+    StatementCache<FakeStatement> cache;
+    int prepared = 0;
+    boost::atomic<bool>* lease = nullptr;
+
+    FakeStatement* first = cache.acquire(3, CountingPrepare(prepared), lease);
+    lease->store(false);
+
+    FakeStatement* second = cache.acquire(3, CountingPrepare(prepared), lease);
+    lease->store(false);
+
+    EXPECT_EQ(first, second);
+    EXPECT_EQ(1, prepared);
+}
+
+TEST(StatementCacheTest, RunningTheSameStatementTwiceInARowPreparesItOnce) {
+    StatementCache<FakeStatement> cache;
+    int prepared = 0;
+
+    // two executions queued back to back on one worker, each released once it has no result set
+    for (int i = 0; i < 2; ++i) {
+        boost::atomic<bool>* lease = nullptr;
+        cache.acquire(7, CountingPrepare(prepared), lease);
+
+        ASSERT_TRUE(lease != nullptr);
+        lease->store(false);
+    }
+
+    EXPECT_EQ(1, prepared);
+}
+
+TEST(StatementCacheTest, LeasedStatementGivesTheNextExecutionAStatementOfItsOwn) {
+    StatementCache<FakeStatement> cache;
+    int prepared = 0;
+    boost::atomic<bool>* lease = nullptr;
+    boost::atomic<bool>* second_lease = nullptr;
+
+    FakeStatement* first = cache.acquire(3, CountingPrepare(prepared), lease);
+    FakeStatement* second = cache.acquire(3, CountingPrepare(prepared), second_lease);
+
+    EXPECT_NE(first, second);
+    EXPECT_TRUE(second_lease == nullptr);
+    EXPECT_EQ(2, prepared);
+
+    delete second;
+}
+
+TEST(StatementCacheTest, DroppedStatementIsPreparedAgain) {
+    StatementCache<FakeStatement> cache;
+    int prepared = 0;
+    boost::atomic<bool>* lease = nullptr;
+
+    cache.acquire(3, CountingPrepare(prepared), lease);
+    cache.drop(3);
+
+    cache.acquire(3, CountingPrepare(prepared), lease);
+
+    EXPECT_TRUE(lease != nullptr);
+    EXPECT_EQ(2, prepared);
+}
+
+TEST(StatementCacheTest, FailedPrepareLeavesTheStatementFree) {
+    StatementCache<FakeStatement> cache;
+    int prepared = 0;
+    boost::atomic<bool>* lease = nullptr;
+
+    EXPECT_THROW(cache.acquire(3, [] () -> FakeStatement* {
+        throw std::runtime_error("lost connection");
+    }, lease), std::runtime_error);
+    EXPECT_TRUE(lease == nullptr);
+
+    cache.acquire(3, CountingPrepare(prepared), lease);
+
+    EXPECT_TRUE(lease != nullptr);
+    EXPECT_EQ(1, prepared);
+}
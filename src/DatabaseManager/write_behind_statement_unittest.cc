@@ -0,0 +1,167 @@
+/*
+ This file is part of MMOServer. For more information, visit http://swganh.com
+
+ Copyright (c) 2006 - 2014 The SWG:ANH Team
+
+ MMOServer is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ MMOServer is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with MMOServer.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "DatabaseManager/WriteBehindStatement.h"
+
+using namespace swganh::database;
+
+namespace {
+
+std::string quoteEscape(const std::string& value) {
+    std::string escaped;
+
+    for (auto it = value.begin(); it != value.end(); ++it) {
+        if (*it == '\'') {
+            escaped += '\\';
+        }
+
+        escaped += *it;
+    }
+
+    return escaped;
+}
+
+StatementParameter uintValue(uint64_t value) {
+    StatementParameter parameter;
+    parameter.type = SPT_uint;
+    parameter.uint_value = value;
+    return parameter;
+}
+
+StatementParameter stringValue(const std::string& value) {
+    StatementParameter parameter;
+    parameter.type = SPT_string;
+    parameter.string_value = value;
+    return parameter;
+}
+
+DirtyTable singleKeyTable() {
+    DirtyTable table;
+    table.key_columns[0] = "id";
+    table.key_count = 1;
+    return table;
+}
+
+DirtyTable doubleKeyTable() {
+    DirtyTable table;
+    table.key_columns[0] = "item_id";
+    table.key_columns[1] = "attribute_id";
+    table.key_count = 2;
+    return table;
+}
+
+}  // namespace
+
+TEST(WriteBehindStatementTest, SingleKeyRowsAreMatchedByInList) {
+    DirtyTable table = singleKeyTable();
+    table.rows[RowKey(1)].columns["amount"] = uintValue(10);
+    table.rows[RowKey(2)].columns["amount"] = uintValue(20);
+
+    std::vector<WriteBehindStatement> statements;
+    buildWriteBehindStatements("galaxy", "resource_containers", table, 100, quoteEscape, statements);
+
+    ASSERT_EQ(1u, statements.size());
+    EXPECT_EQ("UPDATE galaxy.resource_containers SET amount = CASE WHEN id=1 THEN 10 WHEN id=2 THEN 20 ELSE amount END"
+              " WHERE id IN (1,2)", statements[0].sql);
+    EXPECT_EQ("resource_containers", statements[0].table);
+    EXPECT_EQ(2u, statements[0].rows.size());
+    EXPECT_TRUE(table.rows.empty());
+}
+
+TEST(WriteBehindStatementTest, DoubleKeyRowsAreMatchedByTupleInList) {
+    DirtyTable table = doubleKeyTable();
+    table.rows[RowKey(1, 22)].columns["value"] = stringValue("15");
+    table.rows[RowKey(1, 23)].columns["value"] = stringValue("ready");
+
+    std::vector<WriteBehindStatement> statements;
+    buildWriteBehindStatements("galaxy", "item_attributes", table, 100, quoteEscape, statements);
+
+    ASSERT_EQ(1u, statements.size());
+    EXPECT_EQ("UPDATE galaxy.item_attributes SET value = CASE WHEN item_id=1 AND attribute_id=22 THEN '15'"
+              " WHEN item_id=1 AND attribute_id=23 THEN 'ready' ELSE value END"
+              " WHERE (item_id,attribute_id) IN ((1,22),(1,23))", statements[0].sql);
+}
+
+TEST(WriteBehindStatementTest, ColumnsKeepTheirValueInRowsTheyAreNotDirtyIn) {
+    DirtyTable table = singleKeyTable();
+    table.rows[RowKey(1)].columns["amount"] = uintValue(10);
+    table.rows[RowKey(2)].columns["name"] = stringValue("box");
+
+    std::vector<WriteBehindStatement> statements;
+    buildWriteBehindStatements("galaxy", "items", table, 100, quoteEscape, statements);
+
+    ASSERT_EQ(1u, statements.size());
+    EXPECT_EQ("UPDATE galaxy.items SET amount = CASE WHEN id=1 THEN 10 ELSE amount END,"
+              " name = CASE WHEN id=2 THEN 'box' ELSE name END WHERE id IN (1,2)", statements[0].sql);
+}
+
+TEST(WriteBehindStatementTest, StringValuesAreEscaped) {
+    DirtyTable table = singleKeyTable();
+    table.rows[RowKey(5)].columns["name"] = stringValue("it's");
+
+    std::vector<WriteBehindStatement> statements;
+    buildWriteBehindStatements("galaxy", "items", table, 100, quoteEscape, statements);
+
+    ASSERT_EQ(1u, statements.size());
+    EXPECT_EQ("UPDATE galaxy.items SET name = CASE WHEN id=5 THEN 'it\\'s' ELSE name END WHERE id IN (5)", statements[0].sql);
+}
+
+TEST(WriteBehindStatementTest, RowsAreSplitIntoStatementsOfMaxRows) {
+    DirtyTable table = singleKeyTable();
+
+    for (uint64_t id = 1; id <= 5; ++id) {
+        table.rows[RowKey(id)].columns["amount"] = uintValue(id);
+    }
+
+    std::vector<WriteBehindStatement> statements;
+    buildWriteBehindStatements("galaxy", "items", table, 2, quoteEscape, statements);
+
+    ASSERT_EQ(3u, statements.size());
+    EXPECT_EQ(2u, statements[0].rows.size());
+    EXPECT_EQ(2u, statements[1].rows.size());
+    EXPECT_EQ(1u, statements[2].rows.size());
+    EXPECT_EQ("UPDATE galaxy.items SET amount = CASE WHEN id=5 THEN 5 ELSE amount END WHERE id IN (5)", statements[2].sql);
+}
+
+TEST(WriteBehindStatementTest, RestoredRowsDoNotReplaceNewerValues) {
+    DirtyTable table = singleKeyTable();
+    table.rows[RowKey(1)].columns["amount"] = uintValue(10);
+    table.rows[RowKey(1)].columns["name"] = stringValue("box");
+    table.rows[RowKey(1)].dirty_since = 100;
+
+    std::vector<WriteBehindStatement> statements;
+    buildWriteBehindStatements("galaxy", "items", table, 100, quoteEscape, statements);
+
+    // marked again while the failed statement was in flight
+    table.rows[RowKey(1)].columns["amount"] = uintValue(11);
+    table.rows[RowKey(1)].dirty_since = 200;
+
+    restoreDirtyRows(statements[0].rows, table);
+
+    ASSERT_EQ(1u, table.rows.size());
+    EXPECT_EQ(11u, table.rows[RowKey(1)].columns["amount"].uint_value);
+    EXPECT_EQ("box", table.rows[RowKey(1)].columns["name"].string_value);
+    EXPECT_EQ(100u, table.rows[RowKey(1)].dirty_since);
+}
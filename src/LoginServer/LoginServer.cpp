@@ -84,7 +84,12 @@ LoginServer::LoginServer(int argc, char* argv[])
 		configuration_variables_map_["UnreliablePacketSizeServerToClient"].as<uint16_t>(), 
 		configuration_variables_map_["ServerPacketWindowSize"].as<uint32_t>(), 
 		configuration_variables_map_["ClientPacketWindowSize"].as<uint32_t>(),
-		configuration_variables_map_["UdpBufferSize"].as<uint32_t>()));
+		configuration_variables_map_["UdpBufferSize"].as<uint32_t>(),
+		swganh::network::ParseSocketBackend(configuration_variables_map_["SocketBackend"].as<std::string>()),
+		configuration_variables_map_["SocketBatchSize"].as<uint32_t>(),
+		configuration_variables_map_["SocketWriteWorkers"].as<uint32_t>(),
+		configuration_variables_map_["CompressionMinSize"].as<uint32_t>(),
+		configuration_variables_map_["CompressionStatsInterval"].as<uint32_t>()));
 
     LOG(warning) << "Config port set to " << configuration_variables_map_["BindPort"].as<uint16>();
     mService = mNetworkManager->GenerateService((char*)configuration_variables_map_["BindAddress"].as<std::string>().c_str(), configuration_variables_map_["BindPort"].as<uint16_t>(),configuration_variables_map_["ServiceMessageHeap"].as<uint32_t>()*1024,false);
@@ -47,6 +47,8 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "ZoneServer/WorldManager.h"
 #include "ZoneServer/ZoneOpcodes.h"
 
+#include "anh/Utils/clock.h"
+
 
 
 #include "Common/byte_buffer.h"
@@ -332,19 +334,12 @@ bool MessageLib::sendOpenedContainer(uint64 objectId, PlayerObject* targetObject
 //
 void MessageLib::sendUpdateTransformMessage(MovingObject* object)
 {
+    if(!mDeadReckoning.shouldSend(object->getId(), object->mPosition, object->rotation_angle(), object->getParentId(), Anh_Utils::Clock::getSingleton()->getLocalTime()))
+    {
+        return;
+    }
 
-    mMessageFactory->StartMessage();
-    mMessageFactory->addUint32(opUpdateTransformMessage);
-    mMessageFactory->addUint64(object->getId());
-    mMessageFactory->addUint16(static_cast<uint16>(object->mPosition.x * 4.0f + 0.5f));
-    mMessageFactory->addUint16(static_cast<uint16>(object->mPosition.y * 4.0f + 0.5f));
-    mMessageFactory->addUint16(static_cast<uint16>(object->mPosition.z * 4.0f + 0.5f));
-    mMessageFactory->addUint32(object->incInMoveCount());
-
-    mMessageFactory->addUint8(static_cast<uint8>(glm::length(object->mPosition) * 4.0f + 0.5f));
-    mMessageFactory->addUint8(static_cast<uint8>(object->rotation_angle() / 0.0625f));
-
-    _sendToInRangeUnreliable(mMessageFactory->EndMessage(),object,8,true);
+    _sendMovementToInRange(_buildUpdateTransformMessage(object, false),object,8,true);
 }
 
 //======================================================================================================================
@@ -353,24 +348,87 @@ void MessageLib::sendUpdateTransformMessage(MovingObject* object)
 //
 void MessageLib::sendUpdateTransformMessageWithParent(MovingObject* object)
 {
-    if(!object)
+    if(!object || !mDeadReckoning.shouldSend(object->getId(), object->mPosition, object->rotation_angle(), object->getParentId(), Anh_Utils::Clock::getSingleton()->getLocalTime()))
     {
         return;
     }
 
+    _sendMovementToInRange(_buildUpdateTransformMessage(object, true),object,8);
+}
+
+//======================================================================================================================
+//
+// builds the world or cell position update of an object
+//
+Message* MessageLib::_buildUpdateTransformMessage(MovingObject* object, bool with_parent)
+{
+    // cell positions are sent at twice the precision
+    float scale = with_parent ? 8.0f : 4.0f;
+
     mMessageFactory->StartMessage();
-    mMessageFactory->addUint32(opUpdateTransformMessageWithParent);
-    mMessageFactory->addUint64(object->getParentId());
+
+    if(with_parent)
+    {
+        mMessageFactory->addUint32(opUpdateTransformMessageWithParent);
+        mMessageFactory->addUint64(object->getParentId());
+    }
+    else
+    {
+        mMessageFactory->addUint32(opUpdateTransformMessage);
+    }
+
     mMessageFactory->addUint64(object->getId());
-    mMessageFactory->addUint16(static_cast<uint16>(object->mPosition.x * 8.0f + 0.5f));
-    mMessageFactory->addUint16(static_cast<uint16>(object->mPosition.y * 8.0f + 0.5f));
-    mMessageFactory->addUint16(static_cast<uint16>(object->mPosition.z * 8.0f + 0.5f));
+    mMessageFactory->addUint16(static_cast<uint16>(object->mPosition.x * scale + 0.5f));
+    mMessageFactory->addUint16(static_cast<uint16>(object->mPosition.y * scale + 0.5f));
+    mMessageFactory->addUint16(static_cast<uint16>(object->mPosition.z * scale + 0.5f));
     mMessageFactory->addUint32(object->incInMoveCount());
 
-    mMessageFactory->addUint8(static_cast<uint8>(glm::length(object->mPosition) * 8.0f + 0.5f));
+    mMessageFactory->addUint8(static_cast<uint8>(glm::length(object->mPosition) * scale + 0.5f));
     mMessageFactory->addUint8(static_cast<uint8>(object->rotation_angle() / 0.0625f));
 
-    _sendToInRangeUnreliable(mMessageFactory->EndMessage(),object,8);
+    return mMessageFactory->EndMessage();
+}
+
+//======================================================================================================================
+//
+// the current position for observers whose last position update of an object was dropped
+// and for everyone in range of objects that stopped after a suppressed update
+//
+void MessageLib::sendMovementCatchUps()
+{
+    uint64 now = Anh_Utils::Clock::getSingleton()->getLocalTime();
+
+    mDeadReckoning.flush(now, [this] (uint64 objectId) -> bool
+    {
+        MovingObject* object = dynamic_cast<MovingObject*>(gWorldManager->getObjectById(objectId));
+
+        if(!object)
+        {
+            return false;
+        }
+
+        _sendMovementToInRange(_buildUpdateTransformMessage(object, object->getParentId() != 0), object, 8);
+        return true;
+    });
+
+    mMovementInterest.catchUp(now, mMessageFactory->HeapWarningLevel(), [this] (uint64 observerId, uint64 targetId) -> uint32
+    {
+        PlayerObject*	player	= dynamic_cast<PlayerObject*>(gWorldManager->getObjectById(observerId));
+        MovingObject*	object	= dynamic_cast<MovingObject*>(gWorldManager->getObjectById(targetId));
+
+        // one of them is gone or they don't see each other anymore
+        if(!_checkPlayer(player) || !object || !object->checkRegisteredWatchers(player))
+        {
+            return 0;
+        }
+
+        Message* message = _buildUpdateTransformMessage(object, object->getParentId() != 0);
+        uint32 size = message->getSize();
+
+        player->getClient()->SendChannelAUnreliable(message, player->getAccountId(), CR_Client, 8);
+
+        return size;
+    });
 }
 
 //======================================================================================================================
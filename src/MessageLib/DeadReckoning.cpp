@@ -0,0 +1,196 @@
+/*
+---------------------------------------------------------------------------------------
+This source file is part of SWG:ANH (Star Wars Galaxies - A New Hope - Server Emulator)
+
+For more information, visit http://www.swganh.com
+
+Copyright (c) 2006 - 2014 The SWG:ANH Team
+---------------------------------------------------------------------------------------
+Use of this source code is governed by the GPL v3 license that can be found
+in the COPYING file or at http://www.gnu.org/licenses/gpl-3.0.html
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+---------------------------------------------------------------------------------------
+*/
+
+#include "DeadReckoning.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "anh/logger.h"
+
+//======================================================================================================================
+
+namespace
+{
+    const float kPi								= 3.14159265f;
+
+    // an object with a suppressed update that didn't update for this long stopped
+    const uint64 kSettleTime					= 500;
+
+    // objects without an update for this long are forgotten
+    const uint64 kStateTimeout					= 60000;
+
+    const uint64 kStatsInterval					= 60000;
+
+    // the difference of two headings in radians, across the wrap at a full turn
+    float headingDifference(float a, float b)
+    {
+        float difference = std::fmod(std::fabs(a - b), 2.0f * kPi);
+        return std::min(difference, 2.0f * kPi - difference);
+    }
+}
+
+//======================================================================================================================
+
+DeadReckoning::DeadReckoning()
+    : mMaxErrorSquared(0.5f * 0.5f)
+    , mMaxHeading(15.0f * kPi / 180.0f)
+    , mMaxInterval(2000)
+    , mLastStatsLog(0)
+{
+}
+
+//======================================================================================================================
+
+void DeadReckoning::configure(float maxError, float maxHeading, uint32 maxInterval)
+{
+    mMaxErrorSquared	= maxError * maxError;
+    mMaxHeading			= maxHeading * kPi / 180.0f;
+    mMaxInterval		= maxInterval;
+}
+
+//======================================================================================================================
+
+void DeadReckoning::_setSent(SentState& state, uint64 now)
+{
+    state.mPosition		= state.mLastPosition;
+    state.mHeading		= state.mLastHeading;
+    state.mSentAt		= now;
+    state.mPending		= false;
+}
+
+//======================================================================================================================
+
+bool DeadReckoning::shouldSend(uint64 objectId, const glm::vec3& position, float heading, uint64 parentId, uint64 now)
+{
+    mStats.mUpdates++;
+
+    std::pair<SentStateMap::iterator, bool> inserted = mStates.insert(std::make_pair(objectId, SentState()));
+    SentState& state = inserted.first->second;
+
+    state.mLastUpdate	= now;
+    state.mLastPosition	= position;
+    state.mLastHeading	= heading;
+
+    if(inserted.second)
+    {
+        mStats.mSentNew++;
+        state.mParentId = parentId;
+        _setSent(state, now);
+        return true;
+    }
+
+    if(state.mParentId != parentId)
+    {
+        mStats.mSentCell++;
+        state.mParentId = parentId;
+        _setSent(state, now);
+        return true;
+    }
+
+    uint64 elapsed = now - state.mSentAt;
+
+    if(elapsed >= mMaxInterval)
+    {
+        mStats.mSentInterval++;
+        _setSent(state, now);
+        return true;
+    }
+
+    glm::vec3 error = position - state.mPosition;
+
+    if(glm::dot(error, error) > mMaxErrorSquared)
+    {
+        mStats.mSentError++;
+        _setSent(state, now);
+        return true;
+    }
+
+    if(headingDifference(heading, state.mHeading) > mMaxHeading)
+    {
+        mStats.mSentHeading++;
+        _setSent(state, now);
+        return true;
+    }
+
+    mStats.mSuppressed++;
+    state.mPending = true;
+    return false;
+}
+
+//======================================================================================================================
+
+void DeadReckoning::flush(uint64 now, std::function<bool (uint64 objectId)> send)
+{
+    SentStateMap::iterator it = mStates.begin();
+
+    while(it != mStates.end())
+    {
+        SentState& state = it->second;
+
+        if(state.mPending && (now - state.mLastUpdate >= kSettleTime))
+        {
+            if(!send(it->first))
+            {
+                it = mStates.erase(it);
+                continue;
+            }
+
+            mStats.mSettled++;
+
+            // it stands still where it updated last
+            _setSent(state, now);
+        }
+
+        if(!state.mPending && (now - state.mLastUpdate >= kStateTimeout))
+        {
+            it = mStates.erase(it);
+            continue;
+        }
+
+        ++it;
+    }
+
+    if(now - mLastStatsLog >= kStatsInterval)
+    {
+        mLastStatsLog = now;
+        logStats();
+    }
+}
+
+//======================================================================================================================
+
+void DeadReckoning::logStats()
+{
+    uint64 sent = mStats.mUpdates - mStats.mSuppressed;
+    float ratio = mStats.mUpdates ? (100.0f * mStats.mSuppressed / mStats.mUpdates) : 0.0f;
+
+    LOG(info) << "DeadReckoning : " << mStates.size() << " objects, " << mStats.mSuppressed << " of " << mStats.mUpdates
+              << " position updates suppressed (" << ratio << "%), sent " << sent << " (" << mStats.mSentNew << " new, "
+              << mStats.mSentError << " error, " << mStats.mSentHeading << " heading, " << mStats.mSentInterval << " interval, "
+              << mStats.mSentCell << " cell), " << mStats.mSettled << " settled";
+}
@@ -0,0 +1,123 @@
+/*
+---------------------------------------------------------------------------------------
+This source file is part of SWG:ANH (Star Wars Galaxies - A New Hope - Server Emulator)
+
+For more information, visit http://www.swganh.com
+
+Copyright (c) 2006 - 2014 The SWG:ANH Team
+---------------------------------------------------------------------------------------
+Use of this source code is governed by the GPL v3 license that can be found
+in the COPYING file or at http://www.gnu.org/licenses/gpl-3.0.html
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+---------------------------------------------------------------------------------------
+*/
+
+#ifndef ANH_MESSAGELIB_DEADRECKONING_H
+#define ANH_MESSAGELIB_DEADRECKONING_H
+
+#include <functional>
+#include <unordered_map>
+
+#include <glm/glm.hpp>
+
+#include "Utils/typedefs.h"
+
+//======================================================================================================================
+
+struct DeadReckoningStats
+{
+    DeadReckoningStats()
+        : mUpdates(0), mSuppressed(0), mSentNew(0), mSentError(0), mSentHeading(0), mSentInterval(0), mSentCell(0), mSettled(0)
+    {}
+
+    uint64	mUpdates;		// every position update asked about
+    uint64	mSuppressed;	// of those, the ones close enough to the last one sent
+    uint64	mSentNew;		// first update of an object
+    uint64	mSentError;
+    uint64	mSentHeading;
+    uint64	mSentInterval;
+    uint64	mSentCell;		// moved into another cell or out into the world
+    uint64	mSettled;		// last position sent once the object stopped updating
+};
+
+//======================================================================================================================
+
+/*	@brief	DeadReckoning decides which position updates of a moving object are worth broadcasting.
+*
+*	The transform messages carry no velocity, observers see an object where it was sent last. An update only goes out
+*	when its position is further than the allowed error from that one, the heading turned further than allowed, the
+*	object changed its cell or the max interval since the last one passed.
+*	An object whose last update was suppressed and that stopped updating gets its final position sent by flush().
+*/
+class DeadReckoning
+{
+public:
+
+    DeadReckoning();
+
+    /*	@param	maxError		in m between the position sent last and the real one
+    *	@param	maxHeading		in degrees between the heading sent last and the current one
+    *	@param	maxInterval		in ms between two updates of an object
+    */
+    void			configure(float maxError, float maxHeading, uint32 maxInterval);
+
+    /*	@brief	true if the update of the object has to be sent, it is taken as sent then
+    *	@param	heading		in radians
+    *	@param	parentId	the cell of the object, 0 in the world
+    */
+    bool			shouldSend(uint64 objectId, const glm::vec3& position, float heading, uint64 parentId, uint64 now);
+
+    /*	@brief	sends the final position of the objects whose last update was suppressed and that stopped updating.
+    *	send broadcasts the current position of the object, it returns false if the object is gone.
+    */
+    void			flush(uint64 now, std::function<bool (uint64 objectId)> send);
+
+    const DeadReckoningStats&	getStats() const { return mStats; }
+    void			logStats();
+
+private:
+
+    struct SentState
+    {
+        SentState() : mHeading(0.0f), mParentId(0), mSentAt(0), mLastUpdate(0), mLastHeading(0.0f), mPending(false) {}
+
+        glm::vec3		mPosition;
+        float			mHeading;
+        uint64			mParentId;
+        uint64			mSentAt;
+
+        // the latest update, sent or not
+        uint64			mLastUpdate;
+        glm::vec3		mLastPosition;
+        float			mLastHeading;
+
+        bool			mPending;		// the last update was suppressed
+    };
+
+    typedef std::unordered_map<uint64, SentState>	SentStateMap;
+
+    void			_setSent(SentState& state, uint64 now);
+
+    SentStateMap		mStates;
+    DeadReckoningStats	mStats;
+
+    float				mMaxErrorSquared;
+    float				mMaxHeading;	// in radians
+    uint64				mMaxInterval;
+    uint64				mLastStatsLog;
+};
+
+#endif
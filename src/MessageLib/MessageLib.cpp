@@ -32,6 +32,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include <boost/lexical_cast.hpp>
 
 #include "anh/logger.h"
+#include "anh/Utils/clock.h"
 
 #include "Common/atMacroString.h"
 #include "Common/Crc.h"
@@ -59,6 +60,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "ZoneServer/GameSystemManagers/Resource Manager/CurrentResource.h"
 #include "ZoneServer/GameSystemManagers/Resource Manager/ResourceContainer.h"
 #include "ZoneServer/GameSystemManagers/UI Manager/UIOpcodes.h"
+#include "ZoneServer/GameSystemManagers/Spatial Index Manager/SpatialIndexManager.h"
 #include "ZoneServer/GameSystemManagers/Spatial Index Manager/Zmap.h"
 
 #include "ZoneServer/Objects/Inventory.h"
@@ -205,7 +207,9 @@ bool MessageLib::_checkDistance(const glm::vec3& mPosition1, Object* object, uin
 // broadcasts a message to all players in range of the given player
 // we use our registered playerlist here so it will be pretty fast :)
 void MessageLib::_sendToInRangeUnreliable(Message* message, Object* const object, unsigned char priority, bool to_self) {
-    gContainerManager->sendToRegisteredPlayers(object, [=] (PlayerObject* const recipient) {
+    MulticastRecipients recipients;
+
+    gContainerManager->sendToRegisteredPlayers(object, [=, &recipients] (PlayerObject* const recipient) {
         //thats something for debugmode only
         if(!_checkPlayer(recipient)) {
             //an invalid player at this point is like armageddon and Ultymas birthday combined at one time
@@ -215,11 +219,40 @@ void MessageLib::_sendToInRangeUnreliable(Message* message, Object* const object
         }
 
 		if(_checkDistance(recipient->GetCreature()->mPosition, object, mMessageFactory->HeapWarningLevel())) {
-            // clone our message
-            mMessageFactory->StartMessage();
-            mMessageFactory->addData(message->getData(),message->getSize());
+            recipients.push_back(recipient);
+        }
+    });
+
+    if(to_self) {
+        const PlayerObject* const player = dynamic_cast<const PlayerObject*>(object);
+
+        if(_checkPlayer(player)) {
+            recipients.push_back(player);
+        }
+    }
+
+    _sendMulticast(message, recipients, priority, true);
+}
 
-            recipient->getClient()->SendChannelAUnreliable(mMessageFactory->EndMessage(), recipient->getAccountId(), CR_Client, priority);
+//======================================================================================================================
+//
+// like _sendToInRangeUnreliable, but MovementInterest decides who gets the update instead of _checkDistance
+//
+void MessageLib::_sendMovementToInRange(Message* message, Object* const object, unsigned char priority, bool to_self) {
+    MulticastRecipients recipients;
+
+    uint64 now				= Anh_Utils::Clock::getSingleton()->getLocalTime();
+    uint32 heap_warning		= mMessageFactory->HeapWarningLevel();
+    uint32 size				= message->getSize();
+
+    gContainerManager->sendToRegisteredPlayers(object, [=, &recipients] (PlayerObject* const recipient) {
+        if(!_checkPlayer(recipient)) {
+            DLOG (error) << "MessageLib::_sendMovementToInRange : Invalid Player in sendtoInrange : " << recipient->getId();
+            return;
+        }
+
+        if(mMovementInterest.shouldSend(recipient->getId(), object->getId(), _getInterestTier(recipient, object), size, now, heap_warning)) {
+            recipients.push_back(recipient);
         }
     });
 
@@ -227,41 +260,56 @@ void MessageLib::_sendToInRangeUnreliable(Message* message, Object* const object
         const PlayerObject* const player = dynamic_cast<const PlayerObject*>(object);
 
         if(_checkPlayer(player)) {
-            player->getClient()->SendChannelAUnreliable(message, player->getAccountId(), CR_Client, priority);
+            recipients.push_back(player);
         }
-		else
-			mMessageFactory->DestroyMessage(message);
-    } else {
-        // If the message is sent to self then the process of sending destroys it
-        // otherwise we have to destroy it ourselves.
-        mMessageFactory->DestroyMessage(message);
     }
+
+    _sendMulticast(message, recipients, priority, true);
+}
+
+//======================================================================================================================
+//
+// the MovementInterest tier of the pair, from what they do to each other and their distance
+//
+InterestTier MessageLib::_getInterestTier(PlayerObject* const observer, Object* const target) {
+    CreatureObject* body = observer->GetCreature();
+    if(!body) {
+        return InterestTier_Near;
+    }
+
+    // us being targeted, targeting or fighting is worth every update
+    bool relevant = (body->getTargetId() == target->getId()) || body->checkDefenderList(target->getId());
+
+    ObjectType type = target->getType();
+    if(!relevant && (type == ObjType_Player || type == ObjType_Creature || type == ObjType_NPC)) {
+        CreatureObject* creature = static_cast<CreatureObject*>(target);
+
+        relevant = (creature->getTargetId() == body->getId()) || (body->getGroupId() && body->getGroupId() == creature->getGroupId());
+    }
+
+    uint32 frame = gSpatialIndexManager->getFrame();
+    glm::vec3 delta = target->getWorldPosition(frame) - body->getWorldPosition(frame);
+
+    return mMovementInterest.getTier(relevant, glm::dot(delta, delta));
 }
 
 void MessageLib::_sendToInRangeUnreliableChat(Message* message, const CreatureObject* object, unsigned char priority, uint32_t crc) {
     ObjectListType in_range_players;
     mGrid->GetChatRangeCellContents(object->getGridBucket(), &in_range_players);
 
-    Message* cloned_message;
+    MulticastRecipients recipients;
 
-    std::for_each(in_range_players.begin(), in_range_players.end(), [=, &cloned_message] (Object* object) {
+    std::for_each(in_range_players.begin(), in_range_players.end(), [=, &recipients] (Object* object) {
         CreatureObject* creature = static_cast<CreatureObject*>(object);
 		PlayerObject* player = creature->GetGhost();
 
         if(_checkPlayer(player) && (!player->checkIgnoreList(crc))) {
-            // clone our message
-            mMessageFactory->StartMessage();
-            mMessageFactory->addData(message->getData(), message->getSize());
-            cloned_message = mMessageFactory->EndMessage();
-
-            // replace the target id
-            char* data = cloned_message->getData() + 12;
-            *(reinterpret_cast<uint64_t*>(data)) = player->getId();
-            player->getClient()->SendChannelAUnreliable(cloned_message, player->getAccountId(), CR_Client, priority);
+            recipients.push_back(player);
         }
     });
 
-    mMessageFactory->DestroyMessage(message);
+    // replace the target id
+    _sendMulticast(message, recipients, priority, true, 12);
 }
 
 void MessageLib::SendSpatialToInRangeUnreliable_(Message* message, Object* const object, PlayerObject* const player_object) {
@@ -291,30 +339,18 @@ void MessageLib::SendSpatialToInRangeUnreliable_(Message* message, Object* const
         }
     }
 
-    // Create a container for cloned messages.
-    // @todo: We shouldn't have to create whole copies of messages that are (with exception of the
-    // target id) the exact same. This is a waste of memory especially with denser populations.
-    Message* cloned_message = NULL;
+    // Collect the recipients, they all get the same message with only their target id replaced.
+    MulticastRecipients recipients;
 
     // Create our lambda that we'll use to handle the inrange sending
-    auto send_rule = [=, &cloned_message ] (PlayerObject* const recipient) {
+    auto send_rule = [=, &recipients] (PlayerObject* const recipient) {
         // If the player is not online, or if the sender is in the player's ignore list
         // then pass over this iteration.
         if (!_checkPlayer(recipient) || (senders_name_crc && recipient->checkIgnoreList(senders_name_crc))) {
-            //mMessageFactory->DestroyMessage(message);
             return;
         }
 
-        // Clone the message and send it out to this player.
-        mMessageFactory->StartMessage();
-        mMessageFactory->addData(message->getData(), message->getSize());
-        cloned_message = mMessageFactory->EndMessage();
-
-        // Replace the target id.
-        char* data = cloned_message->getData() + 12;
-        *(reinterpret_cast<uint64_t*>(data)) = recipient->getId();
-
-        recipient->getClient()->SendChannelAUnreliable(cloned_message, recipient->getAccountId(), CR_Client, 5);
+        recipients.push_back(recipient);
     };
 
     // If no player_object is passed it means this is not an instance, send to the known
@@ -330,7 +366,8 @@ void MessageLib::SendSpatialToInRangeUnreliable_(Message* message, Object* const
         gContainerManager->sendToGroupedRegisteredPlayers(player_object, send_rule, true);
     }
 
-    mMessageFactory->DestroyMessage(message);
+    // Replace the target id.
+    _sendMulticast(message, recipients, 5, true, 12);
 }
 
 void MessageLib::_sendToInRangeUnreliableChatGroup(Message* message, const CreatureObject* object, unsigned char priority, uint32_t crc) {
@@ -339,29 +376,21 @@ void MessageLib::_sendToInRangeUnreliableChatGroup(Message* message, const Creat
     ObjectListType in_range_players;
     mGrid->GetPlayerViewingRangeCellContents(mGrid->getCellId(position.x, position.z), &in_range_players);
 
-    Message* cloned_message;
-    bool failed = false;
+    MulticastRecipients recipients;
 
-    std::for_each(in_range_players.begin(), in_range_players.end(), [=, &cloned_message] (Object* iter_object) {
+    std::for_each(in_range_players.begin(), in_range_players.end(), [=, &recipients] (Object* iter_object) {
         CreatureObject* creature = static_cast<CreatureObject*>(iter_object);
 		PlayerObject* player = creature->GetGhost();
 
         if(_checkPlayer(player) && object->getGroupId()
                 && (player->GetCreature()->getGroupId() == object->getGroupId())
         && !player->checkIgnoreList(crc)) {
-            // clone our message
-            mMessageFactory->StartMessage();
-            mMessageFactory->addData(message->getData(),message->getSize());
-            cloned_message = mMessageFactory->EndMessage();
-
-            // replace the target id
-            char* data = cloned_message->getData() + 12;
-            *(reinterpret_cast<uint64_t*>(data)) = player->getId();
-            player->getClient()->SendChannelAUnreliable(cloned_message, player->getAccountId(), CR_Client, priority);
+            recipients.push_back(player);
         }
     });
 
-	mMessageFactory->DestroyMessage(message);
+    // replace the target id
+    _sendMulticast(message, recipients, priority, true, 12);
 }
 
 //======================================================================================================================
@@ -372,19 +401,17 @@ void MessageLib::_sendToInRange(Message* message, const Object* object, unsigned
     ObjectListType in_range_players;
 	mGrid->GetPlayerViewingRangeCellContents(object->getGridBucket(), &in_range_players);
 
-    std::for_each(in_range_players.begin(), in_range_players.end(), [=] (Object* object) {
+    MulticastRecipients recipients;
+
+    std::for_each(in_range_players.begin(), in_range_players.end(), [=, &recipients] (Object* object) {
         CreatureObject* creature = static_cast<CreatureObject*>(object);
 		PlayerObject* player = creature->GetGhost();
         if(_checkPlayer(player)) {
-            // clone our message
-            mMessageFactory->StartMessage();
-            mMessageFactory->addData(message->getData(),message->getSize());
-
-            player->getClient()->SendChannelA(mMessageFactory->EndMessage(), player->getAccountId(), CR_Client, priority);
+            recipients.push_back(player);
         }
     });
 
-    mMessageFactory->DestroyMessage(message);
+    _sendMulticast(message, recipients, priority, false);
 }
 
 //======================================================================================================================
@@ -402,18 +429,16 @@ void MessageLib::_sendToInstancedPlayers(Message* message, unsigned char priorit
     ObjectListType in_range_players;
     mGrid->GetPlayerViewingRangeCellContents(mGrid->getCellId(position.x, position.z), &in_range_players);
 
-    std::for_each(in_range_players.begin(), in_range_players.end(), [=] (Object* object) {
+    MulticastRecipients recipients;
+
+    std::for_each(in_range_players.begin(), in_range_players.end(), [=, &recipients] (Object* object) {
         PlayerObject* player = dynamic_cast<PlayerObject*>(object);
         if (_checkPlayer(player)) {
-            // Clone the message.
-            mMessageFactory->StartMessage();
-            mMessageFactory->addData(message->getData(),message->getSize());
-
-            (player->getClient())->SendChannelA(mMessageFactory->EndMessage(), player->getAccountId(), CR_Client, priority);
+            recipients.push_back(player);
         }
     });
 
-    mMessageFactory->DestroyMessage(message);
+    _sendMulticast(message, recipients, priority, false);
 }
 //======================================================================================================================
 //
@@ -430,7 +455,9 @@ void MessageLib::_sendToInstancedPlayersUnreliable(Message* message, unsigned ch
     ObjectListType in_range_players;
 	mGrid->GetPlayerViewingRangeCellContents(player->getGridBucket(), &in_range_players);
 
-    std::for_each(in_range_players.begin(), in_range_players.end(), [=] (Object* object) {
+    MulticastRecipients recipients;
+
+    std::for_each(in_range_players.begin(), in_range_players.end(), [=, &recipients] (Object* object) {
         PlayerObject* in_range_player = static_cast<PlayerObject*>(object);
 
         if((player->GetCreature()->getGroupId() != 0) && (in_range_player->GetCreature()->getGroupId() != player->GetCreature()->getGroupId())) {
@@ -439,17 +466,11 @@ void MessageLib::_sendToInstancedPlayersUnreliable(Message* message, unsigned ch
         }
 
         if (_checkPlayer(in_range_player)) {
-            // Clone the message.
-            mMessageFactory->StartMessage();
-            mMessageFactory->addData(message->getData(),message->getSize());
-
-            in_range_player->getClient()->SendChannelAUnreliable(
-                mMessageFactory->EndMessage(),
-                in_range_player->getAccountId(), CR_Client, priority);
+            recipients.push_back(in_range_player);
         }
     });
 
-    mMessageFactory->DestroyMessage(message);
+    _sendMulticast(message, recipients, priority, true);
 }
 
 //======================================================================================================================
@@ -459,24 +480,112 @@ void MessageLib::_sendToInstancedPlayersUnreliable(Message* message, unsigned ch
 void MessageLib::_sendToAll(Message* message, unsigned char priority, bool unreliable) const {
     const PlayerAccMap* const players = gWorldManager->getPlayerAccMap();
 
-    std::for_each(players->begin(), players->end(), [=] (const std::pair<uint32_t, const PlayerObject*>& element) {
+    MulticastRecipients recipients;
+    recipients.reserve(players->size());
+
+    std::for_each(players->begin(), players->end(), [=, &recipients] (const std::pair<uint32_t, const PlayerObject*>& element) {
         const PlayerObject* const player = element.second;
 
         if(_checkPlayer(player)) {
+            recipients.push_back(player);
+        }
+    });
+
+    _sendMulticast(message, recipients, priority, unreliable);
+}
+
+//======================================================================================================================
+//
+// sends the message to all recipients. The ConnectionServer gets one opClusterMulticast message per batch of
+// recipients and fans it out to the clients locally, instead of one routed copy per recipient.
+// The uint64 at the patch offset of the message is replaced by the id of the recipient.
+//
+void MessageLib::_sendMulticast(Message* message, const MulticastRecipients& recipients, unsigned char priority, bool unreliable, uint16 patch_offset) const {
+    uint32 entry_size = (patch_offset == MULTICAST_NO_PATCH) ? sizeof(uint32) : sizeof(uint32) + sizeof(uint64);
+
+    // opcode, fastpath, patch offset and recipient count
+    uint32 header_size = sizeof(uint32) + sizeof(uint8) + sizeof(uint16) + sizeof(uint16);
+
+    // a session sends larger unreliables as reliables, so unreliable envelopes are kept to one packet
+    uint32 envelope_limit = unreliable ? MULTICAST_MAX_UNRELIABLE_SIZE : 0xffff;
+
+    uint32 batch_size = 0;
+    if(message->getSize() + header_size < envelope_limit) {
+        batch_size = std::min<uint32>(MULTICAST_MAX_RECIPIENTS, (envelope_limit - header_size - message->getSize()) / entry_size);
+    }
+
+    auto send_single = [=] (const PlayerObject* const player) {
+        Message* shared_message = mMessageFactory->CreateSharedMessage(message);
+
+        if(patch_offset != MULTICAST_NO_PATCH) {
+            shared_message->setPatch(patch_offset, player->getId());
+        }
+
+        if(unreliable) {
+            player->getClient()->SendChannelAUnreliable(shared_message, player->getAccountId(), CR_Client, priority);
+        } else {
+            player->getClient()->SendChannelA(shared_message, player->getAccountId(), CR_Client, priority);
+        }
+    };
+
+    // a single recipient or a payload too large for an envelope goes out the old way
+    if(recipients.size() < 2 || batch_size < 2) {
+        std::for_each(recipients.begin(), recipients.end(), send_single);
+
+        mMessageFactory->DestroyMessage(message);
+        return;
+    }
+
+    // an envelope only reaches the clients of the ConnectionServer it is sent to, so recipients are grouped by session
+    MulticastRecipients by_session(recipients);
+    std::stable_sort(by_session.begin(), by_session.end(), [] (const PlayerObject* const a, const PlayerObject* const b) {
+        return a->getClient()->getSession() < b->getClient()->getSession();
+    });
+
+    uint32 group_begin = 0;
+    while(group_begin < by_session.size()) {
+        Session* session = by_session[group_begin]->getClient()->getSession();
+
+        uint32 group_end = group_begin + 1;
+        while(group_end < by_session.size() && by_session[group_end]->getClient()->getSession() == session) {
+            ++group_end;
+        }
+
+        if(group_end - group_begin < 2) {
+            send_single(by_session[group_begin]);
+            group_begin = group_end;
+            continue;
+        }
+
+        for(uint32 begin = group_begin; begin < group_end; begin += batch_size) {
+            uint32 end = std::min<uint32>(begin + batch_size, group_end);
+
             mMessageFactory->StartMessage();
-            mMessageFactory->addData(message->getData(),message->getSize());
+            mMessageFactory->addUint32(opClusterMulticast);
+            mMessageFactory->addUint8(unreliable ? 1 : 0);
+            mMessageFactory->addUint16(patch_offset);
+            mMessageFactory->addUint16(static_cast<uint16>(end - begin));
+
+            for(uint32 i = begin; i < end; ++i) {
+                mMessageFactory->addUint32(by_session[i]->getAccountId());
+
+                if(patch_offset != MULTICAST_NO_PATCH) {
+                    mMessageFactory->addUint64(by_session[i]->getId());
+                }
+            }
+
+            mMessageFactory->addData(message->getData(), message->getSize());
 
+            // the clients of the batch share this session, any of them will do
             if(unreliable) {
-                player->getClient()->SendChannelAUnreliable(
-                    mMessageFactory->EndMessage(),
-                    player->getAccountId(), CR_Client, priority);
+                by_session[begin]->getClient()->SendChannelAUnreliable(mMessageFactory->EndMessage(), 0, CR_Connection, priority);
             } else {
-                player->getClient()->SendChannelA(
-                    mMessageFactory->EndMessage(),
-                    player->getAccountId(), CR_Client, priority);
+                by_session[begin]->getClient()->SendChannelA(mMessageFactory->EndMessage(), 0, CR_Connection, priority);
             }
         }
-    });
+
+        group_begin = group_end;
+    }
 
     mMessageFactory->DestroyMessage(message);
 }
@@ -898,6 +1007,11 @@ void MessageLib::broadcastDelta(swganh::messages::DeltasMessage& message, const
 
 }
 
+void MessageLib::flushDeltas()
+{
+	creature_message_builder_->FlushStatDeltas();
+}
+
 MessageFactory* MessageLib::getFactory_()
 {
 	MessageFactory* factory;
@@ -37,11 +37,15 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 
 #include "Common/OutOfBand.h"
 
+#include "NetworkManager/MessageOpcodes.h"
+
 #include "ZoneServer/MoodTypes.h"
 #include "ZoneServer/ObjectController/ObjectController.h"
 #include "ZoneServer/GameSystemManagers/Skill Manager/Skill.h"   //for skillmodslist
 #include "ZoneServer/SocialChatTypes.h"
 
+#include "MessageLib/DeadReckoning.h"
+#include "MessageLib/MovementInterest.h"
 #include "MessageLib\messages\deltas_message.h"
 #include "MessageLib\/messages\baselines_message.h"
 #include "Utils/ConcurrentQueue.h"
@@ -94,6 +98,7 @@ typedef struct tagResourceLocation ResourceLocation;
 typedef std::set<PlayerObject*>			PlayerObjectSetML;
 typedef std::list<PlayerObject*>		PlayerList;
 typedef std::list<Object*>				ObjectList;
+typedef std::vector<const PlayerObject*>	MulticastRecipients;
 
 typedef utils::ConcurrentQueueLight< MessageFactory*>			ConcurrentMessageFactoryQueue;
 
@@ -134,6 +139,13 @@ public:
 
 	void				sendBaseline(swganh::messages::BaselinesMessage& message, PlayerObject* player);
 
+	/*	@brief sends the deltas the message builders coalesced during the current tick. Called once per zone tick
+	*
+	*/
+	void				flushDeltas();
+
+	CreatureMessageBuilder*	getCreatureMessageBuilder() { return creature_message_builder_.get(); }
+
 
 
     // multiple messages, messagelib.cpp
@@ -292,6 +304,13 @@ public:
     void				sendUpdateTransformMessage(MovingObject* object);
     void				sendUpdateTransformMessageWithParent(MovingObject* object);
 
+    /*	@brief	sends the current position to the observers that missed the last position update of an object
+    *	and are due again, see MovementInterest, and the final position of objects that stopped, see DeadReckoning
+    */
+    void				sendMovementCatchUps();
+    MovementInterest*	getMovementInterest() { return &mMovementInterest; }
+    DeadReckoning*		getDeadReckoning() { return &mDeadReckoning; }
+
     // position updates. used with Tutorial
     void				sendUpdateTransformMessage(MovingObject* object, PlayerObject* player);
     void				sendUpdateTransformMessageWithParent(MovingObject* object, PlayerObject* player);
@@ -686,6 +705,13 @@ private:
 	*
 	*/
 	void				_sendToInRangeUnreliable(Message* message, Object* const object, unsigned char priority, bool to_self = true);
+
+	/*	@brief sends the given unreliable movement update to the players in range that MovementInterest picks
+	*
+	*/
+	void				_sendMovementToInRange(Message* message, Object* const object, unsigned char priority, bool to_self = true);
+	InterestTier		_getInterestTier(PlayerObject* const observer, Object* const target);
+	Message*			_buildUpdateTransformMessage(MovingObject* object, bool with_parent);
 	
 	/*	@brief sends the given reliable Message to all players in range
 	*
@@ -698,6 +724,11 @@ private:
 	void				_sendToInstancedPlayersUnreliable(Message* message, unsigned char priority, PlayerObject* player) const;
 	void				_sendToInstancedPlayers(Message* message, unsigned char priority, PlayerObject* const player) const;
 	void				_sendToAll(Message* message, unsigned char priority, bool unreliable = false) const;
+
+	/*	@brief sends the given Message to all recipients in one multicast message per batch of recipients,
+	*	the ConnectionServer fans it out to their clients. The uint64 at patch_offset is replaced by the recipients id.
+	*/
+	void				_sendMulticast(Message* message, const MulticastRecipients& recipients, unsigned char priority, bool unreliable, uint16 patch_offset = MULTICAST_NO_PATCH) const;
    
     /**
      * Sends a spatial message to in-range players.
@@ -746,6 +777,8 @@ private:
 	zmap*				mGrid;
 
     MessageFactory*								mMessageFactory;
+    MovementInterest							mMovementInterest;
+    DeadReckoning								mDeadReckoning;
 
 	ConcurrentMessageFactoryQueue					factory_queue_;
 	swganh::app::SwganhKernel*						kernel_;
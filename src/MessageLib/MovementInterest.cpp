@@ -0,0 +1,258 @@
+/*
+---------------------------------------------------------------------------------------
+This source file is part of SWG:ANH (Star Wars Galaxies - A New Hope - Server Emulator)
+
+For more information, visit http://www.swganh.com
+
+Copyright (c) 2006 - 2014 The SWG:ANH Team
+---------------------------------------------------------------------------------------
+Use of this source code is governed by the GPL v3 license that can be found
+in the COPYING file or at http://www.gnu.org/licenses/gpl-3.0.html
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+---------------------------------------------------------------------------------------
+*/
+
+#include "MovementInterest.h"
+
+#include <algorithm>
+#include <sstream>
+
+#include "anh/logger.h"
+
+//======================================================================================================================
+
+namespace
+{
+    // a pair gains its tier's weight with every update and is sent at kSendPriority
+    const uint32 kTierWeight[InterestTier_Count]	= { 4, 4, 2, 1 };
+    const uint32 kSendPriority						= 4;
+
+    // the longest a pair waits for an update, 0 for never
+    const uint64 kTierInterval[InterestTier_Count]	= { 0, 0, 500, 1000 };
+
+    // the budget of an observer is per window of this many ms
+    const uint64 kBudgetWindow						= 100;
+
+    // pairs without an update for this long are forgotten
+    const uint64 kPairTimeout						= 30000;
+
+    const uint64 kStatsInterval						= 60000;
+
+    const char* kTierNames[InterestTier_Count]		= { "relevant", "near", "mid", "far" };
+}
+
+//======================================================================================================================
+
+MovementInterest::MovementInterest()
+    : mNearRangeSquared(32.0f * 32.0f)
+    , mMidRangeSquared(96.0f * 96.0f)
+    , mBudget(2048)
+    , mLastStatsLog(0)
+{
+}
+
+//======================================================================================================================
+
+void MovementInterest::configure(float nearRange, float midRange, uint32 budget)
+{
+    mNearRangeSquared	= nearRange * nearRange;
+    mMidRangeSquared	= std::max(midRange, nearRange) * std::max(midRange, nearRange);
+    mBudget				= budget;
+}
+
+//======================================================================================================================
+
+InterestTier MovementInterest::getTier(bool relevant, float distance_squared) const
+{
+    if(relevant)
+    {
+        return InterestTier_Relevant;
+    }
+
+    if(distance_squared <= mNearRangeSquared)
+    {
+        return InterestTier_Near;
+    }
+
+    if(distance_squared <= mMidRangeSquared)
+    {
+        return InterestTier_Mid;
+    }
+
+    return InterestTier_Far;
+}
+
+//======================================================================================================================
+
+uint32 MovementInterest::getBudget(uint32 heapWarningLevel) const
+{
+    return mBudget >> std::min<uint32>(heapWarningLevel / 3, 3);
+}
+
+//======================================================================================================================
+
+void MovementInterest::_refreshWindow(ObserverState& observer, uint64 now)
+{
+    if(now - observer.mWindowStart >= kBudgetWindow)
+    {
+        observer.mWindowStart = now;
+        observer.mWindowBytes = 0;
+    }
+}
+
+//======================================================================================================================
+
+bool MovementInterest::_takeBudget(ObserverState& observer, uint32 size, uint32 budget, uint64 now)
+{
+    _refreshWindow(observer, now);
+
+    if(observer.mWindowBytes + size > budget)
+    {
+        return false;
+    }
+
+    observer.mWindowBytes += size;
+    return true;
+}
+
+//======================================================================================================================
+
+bool MovementInterest::shouldSend(uint64 observerId, uint64 targetId, InterestTier tier, uint32 size, uint64 now, uint32 heapWarningLevel)
+{
+    ObserverState&	observer_state	= mObservers[observerId];
+    PairState&		pair			= observer_state.mTargets[targetId];
+
+    pair.mTier		= tier;
+    pair.mLastSeen	= now;
+
+    bool send = true;
+
+    if(pair.mTier == InterestTier_Relevant)
+    {
+        // goes out regardless, but still counts against the budget
+        _refreshWindow(observer_state, now);
+        observer_state.mWindowBytes += size;
+    }
+    else
+    {
+        pair.mPriority += kTierWeight[pair.mTier];
+
+        send = (pair.mPriority >= kSendPriority) || (now - pair.mLastSent >= kTierInterval[pair.mTier]);
+
+        if(send && !_takeBudget(observer_state, size, getBudget(heapWarningLevel), now))
+        {
+            mStats.mBudgetDrops++;
+            send = false;
+        }
+    }
+
+    if(!send)
+    {
+        pair.mPending = true;
+
+        mStats.mDropped[pair.mTier]++;
+        mStats.mBytesSaved += size;
+        return false;
+    }
+
+    pair.mPriority	= 0;
+    pair.mLastSent	= now;
+    pair.mPending	= false;
+
+    mStats.mSent[pair.mTier]++;
+    mStats.mBytesSent += size;
+    return true;
+}
+
+//======================================================================================================================
+
+void MovementInterest::catchUp(uint64 now, uint32 heapWarningLevel, std::function<uint32 (uint64 observerId, uint64 targetId)> send)
+{
+    uint32 budget = getBudget(heapWarningLevel);
+
+    ObserverMap::iterator observer_it = mObservers.begin();
+
+    while(observer_it != mObservers.end())
+    {
+        ObserverState& observer_state = observer_it->second;
+        PairMap::iterator pair_it = observer_state.mTargets.begin();
+
+        while(pair_it != observer_state.mTargets.end())
+        {
+            PairState& pair = pair_it->second;
+
+            _refreshWindow(observer_state, now);
+
+            if(pair.mPending && (now - pair.mLastSent >= kTierInterval[pair.mTier]) && (observer_state.mWindowBytes < budget))
+            {
+                uint32 size = send(observer_it->first, pair_it->first);
+
+                if(!size)
+                {
+                    pair_it = observer_state.mTargets.erase(pair_it);
+                    continue;
+                }
+
+                observer_state.mWindowBytes += size;
+
+                pair.mPriority	= 0;
+                pair.mLastSent	= now;
+                pair.mPending	= false;
+
+                mStats.mCatchUps++;
+                mStats.mBytesSent += size;
+            }
+
+            if(!pair.mPending && (now - pair.mLastSeen >= kPairTimeout))
+            {
+                pair_it = observer_state.mTargets.erase(pair_it);
+                continue;
+            }
+
+            ++pair_it;
+        }
+
+        if(observer_state.mTargets.empty())
+        {
+            observer_it = mObservers.erase(observer_it);
+            continue;
+        }
+
+        ++observer_it;
+    }
+
+    if(now - mLastStatsLog >= kStatsInterval)
+    {
+        mLastStatsLog = now;
+        logStats();
+    }
+}
+
+//======================================================================================================================
+
+void MovementInterest::logStats()
+{
+    std::stringstream tiers;
+
+    for(uint32 i = 0; i < InterestTier_Count; i++)
+    {
+        tiers << " " << kTierNames[i] << " " << mStats.mSent[i] << "/" << mStats.mDropped[i];
+    }
+
+    LOG(info) << "MovementInterest : " << mObservers.size() << " observers, sent/dropped" << tiers.str()
+              << ", " << mStats.mBytesSent << " bytes sent, " << mStats.mBytesSaved << " bytes saved, "
+              << mStats.mBudgetDrops << " over budget, " << mStats.mCatchUps << " caught up";
+}
@@ -0,0 +1,153 @@
+/*
+---------------------------------------------------------------------------------------
+This source file is part of SWG:ANH (Star Wars Galaxies - A New Hope - Server Emulator)
+
+For more information, visit http://www.swganh.com
+
+Copyright (c) 2006 - 2014 The SWG:ANH Team
+---------------------------------------------------------------------------------------
+Use of this source code is governed by the GPL v3 license that can be found
+in the COPYING file or at http://www.gnu.org/licenses/gpl-3.0.html
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+---------------------------------------------------------------------------------------
+*/
+
+#ifndef ANH_MESSAGELIB_MOVEMENTINTEREST_H
+#define ANH_MESSAGELIB_MOVEMENTINTEREST_H
+
+#include <functional>
+#include <unordered_map>
+
+#include "Utils/typedefs.h"
+
+//======================================================================================================================
+
+enum InterestTier
+{
+    InterestTier_Relevant	= 0,	// grouped, targeted or fighting each other - every update
+    InterestTier_Near		= 1,
+    InterestTier_Mid		= 2,
+    InterestTier_Far		= 3,
+
+    InterestTier_Count		= 4
+};
+
+struct MovementInterestStats
+{
+    MovementInterestStats()
+        : mBytesSent(0), mBytesSaved(0), mBudgetDrops(0), mCatchUps(0)
+    {
+        for(uint32 i = 0; i < InterestTier_Count; i++)
+        {
+            mSent[i] = 0;
+            mDropped[i] = 0;
+        }
+    }
+
+    uint64	mSent[InterestTier_Count];
+    uint64	mDropped[InterestTier_Count];
+    uint64	mBytesSent;
+    uint64	mBytesSaved;
+    uint64	mBudgetDrops;	// due by their tier but over the budget of the observer
+    uint64	mCatchUps;		// last positions sent later to observers that missed them
+};
+
+//======================================================================================================================
+
+/*	@brief	MovementInterest decides which observer gets which movement update of an object.
+*
+*	Every observer/target pair is put in a tier by their relation and distance. A pair gains priority with
+*	every update of the target by the weight of its tier and the update goes out once the priority is high
+*	enough or the tier's interval passed, near and relevant pairs get every update. An observer gets at most
+*	its budget of bytes per budget window, relevant updates go out regardless.
+*	Pairs that missed the last update of their target get its current position from catchUp(), so objects
+*	that stopped moving don't stay where an observer saw them last.
+*/
+class MovementInterest
+{
+public:
+
+    MovementInterest();
+
+    /*	@param	nearRange	up to here every update is sent
+    *	@param	midRange	up to here every second update, beyond every fourth
+    *	@param	budget		the bytes of movement updates an observer gets per budget window
+    */
+    void			configure(float nearRange, float midRange, uint32 budget);
+
+    /*	@brief	decides whether the observer gets the update of the target, size bytes long
+    *	@param	tier				see getTier
+    *	@param	heapWarningLevel	the message heap under pressure shrinks the budgets
+    */
+    bool			shouldSend(uint64 observerId, uint64 targetId, InterestTier tier, uint32 size, uint64 now, uint32 heapWarningLevel);
+
+    /*	@brief	calls send(observer, target) for the pairs whose last update was dropped and that are due again, as long as
+    *	the observer has budget left. send returns the bytes it sent, 0 if the pair is gone. Pairs that didn't see an
+    *	update for a while are dropped.
+    */
+    void			catchUp(uint64 now, uint32 heapWarningLevel, std::function<uint32 (uint64 observerId, uint64 targetId)> send);
+
+    /*	@param	relevant	whether observer and target are grouped, target each other or fight
+    *	@param	distanceSquared	between observer and target
+    */
+    InterestTier	getTier(bool relevant, float distanceSquared) const;
+
+    // the bytes an observer gets per budget window, the heap filling up halves it down to an eighth
+    uint32			getBudget(uint32 heapWarningLevel) const;
+
+    const MovementInterestStats&	getStats() const { return mStats; }
+    void			logStats();
+
+private:
+
+    struct PairState
+    {
+        PairState() : mPriority(0), mLastSent(0), mLastSeen(0), mTier(InterestTier_Near), mPending(false) {}
+
+        uint32			mPriority;
+        uint64			mLastSent;
+        uint64			mLastSeen;
+        InterestTier	mTier;
+        bool			mPending;		// the last update didn't go out
+    };
+
+    typedef std::unordered_map<uint64, PairState>	PairMap;
+
+    struct ObserverState
+    {
+        ObserverState() : mWindowStart(0), mWindowBytes(0) {}
+
+        uint64			mWindowStart;
+        uint32			mWindowBytes;
+        PairMap			mTargets;
+    };
+
+    typedef std::unordered_map<uint64, ObserverState>	ObserverMap;
+
+    // starts a new budget window if the last one is over
+    void			_refreshWindow(ObserverState& observer, uint64 now);
+    bool			_takeBudget(ObserverState& observer, uint32 size, uint32 budget, uint64 now);
+
+    ObserverMap				mObservers;
+    MovementInterestStats	mStats;
+
+    float					mNearRangeSquared;
+    float					mMidRangeSquared;
+    uint32					mBudget;
+    uint64					mLastStatsLog;
+};
+
+#endif
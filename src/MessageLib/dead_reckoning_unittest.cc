@@ -0,0 +1,192 @@
+/*
+ This file is part of MMOServer. For more information, visit http://swganh.com
+
+ Copyright (c) 2006 - 2014 The SWG:ANH Team
+
+ MMOServer is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ MMOServer is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with MMOServer.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "MessageLib/DeadReckoning.h"
+
+namespace {
+
+const uint64 kObject = 1;
+
+// 0.5m of error, 15 degrees of heading, 2s between updates
+void configureDefault(DeadReckoning& reckoning) {
+    reckoning.configure(0.5f, 15.0f, 2000);
+}
+
+bool update(DeadReckoning& reckoning, float x, uint64 now, float heading = 0.0f, uint64 parentId = 0) {
+    return reckoning.shouldSend(kObject, glm::vec3(x, 0.0f, 0.0f), heading, parentId, now);
+}
+
+// moves along x by step every 100ms, starting at now, and tells which updates went out
+std::vector<bool> moveSteadily(DeadReckoning& reckoning, float x, float step, uint64 now, uint32 count) {
+    std::vector<bool> sent;
+
+    for (uint32 i = 0; i < count; i++) {
+        sent.push_back(update(reckoning, x + i * step, now + i * 100));
+    }
+
+    return sent;
+}
+
+}  // namespace
+
+TEST(DeadReckoningTest, SendsTheFirstUpdateOfAnObject) {
+    DeadReckoning reckoning;
+    configureDefault(reckoning);
+
+    EXPECT_TRUE(update(reckoning, 0.0f, 1000));
+    EXPECT_EQ(1u, reckoning.getStats().mSentNew);
+}
+
+TEST(DeadReckoningTest, SuppressesUpdatesCloseToTheLastOneSent) {
+    DeadReckoning reckoning;
+    configureDefault(reckoning);
+
+    // 0.2m every 100ms, the third step is more than 0.5m off the first update
+    std::vector<bool> sent = moveSteadily(reckoning, 0.0f, 0.2f, 1000, 6);
+
+    bool expected[] = { true, false, false, true, false, false };
+    EXPECT_EQ(std::vector<bool>(expected, expected + 6), sent);
+    EXPECT_EQ(4u, reckoning.getStats().mSuppressed);
+}
+
+TEST(DeadReckoningTest, SendsOnceThePositionIsOffByMoreThanTheError) {
+    DeadReckoning reckoning;
+    configureDefault(reckoning);
+
+    update(reckoning, 0.0f, 1000);
+
+    EXPECT_FALSE(update(reckoning, 0.4f, 1100));
+    EXPECT_TRUE(update(reckoning, 0.6f, 1200));
+    EXPECT_EQ(1u, reckoning.getStats().mSentError);
+
+    // measured from the position sent last
+    EXPECT_FALSE(update(reckoning, 1.0f, 1300));
+}
+
+TEST(DeadReckoningTest, SendsEveryUpdateOfAnObjectMovingFurtherThanTheError) {
+    DeadReckoning reckoning;
+    configureDefault(reckoning);
+
+    // observers never fall behind a runner by more than the error, however straight it runs
+    std::vector<bool> sent = moveSteadily(reckoning, 0.0f, 1.0f, 1000, 25);
+
+    EXPECT_EQ(std::vector<bool>(25, true), sent);
+    EXPECT_EQ(0u, reckoning.getStats().mSuppressed);
+}
+
+TEST(DeadReckoningTest, SendsOnceTheHeadingTurnedFurtherThanAllowed) {
+    DeadReckoning reckoning;
+    configureDefault(reckoning);
+
+    const float degree = 3.14159265f / 180.0f;
+
+    update(reckoning, 0.0f, 1000);
+
+    EXPECT_FALSE(update(reckoning, 0.0f, 1100, 10.0f * degree));
+    EXPECT_TRUE(update(reckoning, 0.0f, 1200, 20.0f * degree));
+    EXPECT_EQ(1u, reckoning.getStats().mSentHeading);
+
+    // across the wrap around
+    EXPECT_FALSE(update(reckoning, 0.0f, 1300, 20.0f * degree - 2.0f * 3.14159265f));
+}
+
+TEST(DeadReckoningTest, SendsOnceTheIntervalPassed) {
+    DeadReckoning reckoning;
+    configureDefault(reckoning);
+
+    update(reckoning, 0.0f, 1000);
+
+    EXPECT_FALSE(update(reckoning, 0.0f, 2000));
+    EXPECT_FALSE(update(reckoning, 0.0f, 2999));
+    EXPECT_TRUE(update(reckoning, 0.0f, 3000));
+    EXPECT_EQ(1u, reckoning.getStats().mSentInterval);
+}
+
+TEST(DeadReckoningTest, SendsWhenTheObjectChangedItsCell) {
+    DeadReckoning reckoning;
+    configureDefault(reckoning);
+
+    update(reckoning, 0.0f, 1000);
+
+    EXPECT_TRUE(update(reckoning, 0.0f, 1100, 0.0f, 42));
+    EXPECT_EQ(1u, reckoning.getStats().mSentCell);
+}
+
+TEST(DeadReckoningTest, SendsTheFinalPositionOnceTheObjectSettled) {
+    DeadReckoning reckoning;
+    configureDefault(reckoning);
+
+    // stops 0.4m off the position sent
+    moveSteadily(reckoning, 0.0f, 0.2f, 1000, 3);
+
+    std::vector<uint64> settled;
+    auto send = [&settled] (uint64 objectId) -> bool {
+        settled.push_back(objectId);
+        return true;
+    };
+
+    // not before it stopped updating for a while
+    reckoning.flush(1300, send);
+    EXPECT_TRUE(settled.empty());
+
+    reckoning.flush(1700, send);
+    ASSERT_EQ(1u, settled.size());
+    EXPECT_EQ(kObject, settled[0]);
+    EXPECT_EQ(1u, reckoning.getStats().mSettled);
+
+    // it is not pending anymore
+    reckoning.flush(2200, send);
+    EXPECT_EQ(1u, settled.size());
+
+    // and observers got it where it updated last
+    EXPECT_FALSE(update(reckoning, 0.8f, 2300));
+}
+
+TEST(DeadReckoningTest, ForgetsObjectsThatAreGoneWhenSettling) {
+    DeadReckoning reckoning;
+    configureDefault(reckoning);
+
+    moveSteadily(reckoning, 0.0f, 0.2f, 1000, 3);
+
+    reckoning.flush(1700, [] (uint64) { return false; });
+    EXPECT_EQ(0u, reckoning.getStats().mSettled);
+
+    // it is new again
+    EXPECT_TRUE(update(reckoning, 0.4f, 1800));
+    EXPECT_EQ(2u, reckoning.getStats().mSentNew);
+}
+
+TEST(DeadReckoningTest, SendsTheFirstStepOffFromRest) {
+    DeadReckoning reckoning;
+    configureDefault(reckoning);
+
+    // stands still, the updates after the first are suppressed
+    for (uint64 now = 1000; now <= 1800; now += 100) {
+        update(reckoning, 0.0f, now);
+    }
+
+    EXPECT_TRUE(update(reckoning, 1.0f, 1900));
+    EXPECT_TRUE(update(reckoning, 2.0f, 2000));
+}
@@ -28,9 +28,8 @@ struct BaseDeltasMessage : public BaseSwgMessage
         buffer.write(object_type);//yalp / creo / weao
         buffer.write(view_type);//3/6/8/9 etc
         
-		//this is actually hardcoded shit - the size is 
-		//+2 for update count and +2 for every different member descriptor
-		//to their defense with the current setup there can only be one member per delta
+		//the size is +2 for update count and +2 for the first member descriptor
+		//the descriptors of further members (see BaseMessageBuilder::AppendDeltasMessage) are part of data
 		buffer.write<uint32_t>(data.size() + 4);
 
         buffer.write<uint16_t>(update_count);//updated elements
@@ -0,0 +1,222 @@
+/*
+ This file is part of MMOServer. For more information, visit http://swganh.com
+
+ Copyright (c) 2006 - 2014 The SWG:ANH Team
+
+ MMOServer is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ MMOServer is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with MMOServer.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "MessageLib/MovementInterest.h"
+
+namespace {
+
+const uint64 kObserver = 1;
+const uint64 kTarget = 2;
+
+// near up to 10m, mid up to 20m, 100 bytes per window
+void configureSmall(MovementInterest& interest) {
+    interest.configure(10.0f, 20.0f, 100);
+}
+
+// feeds count updates 10ms apart, starting at now, and tells which went out
+std::vector<bool> feedUpdates(MovementInterest& interest, InterestTier tier, uint64 now, uint32 count) {
+    std::vector<bool> sent;
+
+    for (uint32 i = 0; i < count; i++) {
+        sent.push_back(interest.shouldSend(kObserver, kTarget, tier, 10, now + i * 10, 0));
+    }
+
+    return sent;
+}
+
+}  // namespace
+
+TEST(MovementInterestTest, PutsRelevantPairsInTheRelevantTierAtAnyDistance) {
+    MovementInterest interest;
+    configureSmall(interest);
+
+    EXPECT_EQ(InterestTier_Relevant, interest.getTier(true, 1000.0f * 1000.0f));
+}
+
+TEST(MovementInterestTest, TiersOtherPairsByDistance) {
+    MovementInterest interest;
+    configureSmall(interest);
+
+    EXPECT_EQ(InterestTier_Near, interest.getTier(false, 10.0f * 10.0f));
+    EXPECT_EQ(InterestTier_Mid, interest.getTier(false, 15.0f * 15.0f));
+    EXPECT_EQ(InterestTier_Mid, interest.getTier(false, 20.0f * 20.0f));
+    EXPECT_EQ(InterestTier_Far, interest.getTier(false, 21.0f * 21.0f));
+}
+
+TEST(MovementInterestTest, SendsEveryUpdateOfNearPairs) {
+    MovementInterest interest;
+    configureSmall(interest);
+
+    std::vector<bool> sent = feedUpdates(interest, InterestTier_Near, 1000, 4);
+
+    EXPECT_EQ(std::vector<bool>(4, true), sent);
+}
+
+TEST(MovementInterestTest, SendsEverySecondUpdateOfMidPairs) {
+    MovementInterest interest;
+    configureSmall(interest);
+
+    // the first goes out as the pair never saw an update
+    std::vector<bool> sent = feedUpdates(interest, InterestTier_Mid, 1000, 5);
+
+    bool expected[] = { true, false, true, false, true };
+    EXPECT_EQ(std::vector<bool>(expected, expected + 5), sent);
+}
+
+TEST(MovementInterestTest, SendsEveryFourthUpdateOfFarPairs) {
+    MovementInterest interest;
+    configureSmall(interest);
+
+    std::vector<bool> sent = feedUpdates(interest, InterestTier_Far, 2000, 5);
+
+    bool expected[] = { true, false, false, false, true };
+    EXPECT_EQ(std::vector<bool>(expected, expected + 5), sent);
+}
+
+TEST(MovementInterestTest, SendsAMidUpdateOnceTheTierIntervalPassed) {
+    MovementInterest interest;
+    configureSmall(interest);
+
+    EXPECT_TRUE(interest.shouldSend(kObserver, kTarget, InterestTier_Mid, 10, 1000, 0));
+    EXPECT_FALSE(interest.shouldSend(kObserver, kTarget, InterestTier_Mid, 10, 1010, 0));
+
+    // the priority alone would send this one, the interval sends it before
+    EXPECT_TRUE(interest.shouldSend(kObserver, kTarget, InterestTier_Mid, 10, 1510, 0));
+}
+
+TEST(MovementInterestTest, DropsUpdatesOverTheBudgetOfTheWindow) {
+    MovementInterest interest;
+    configureSmall(interest);
+
+    EXPECT_TRUE(interest.shouldSend(kObserver, 2, InterestTier_Near, 40, 1000, 0));
+    EXPECT_TRUE(interest.shouldSend(kObserver, 3, InterestTier_Near, 40, 1010, 0));
+    EXPECT_FALSE(interest.shouldSend(kObserver, 4, InterestTier_Near, 40, 1020, 0));
+    EXPECT_EQ(1u, interest.getStats().mBudgetDrops);
+
+    // a new window, a new budget
+    EXPECT_TRUE(interest.shouldSend(kObserver, 4, InterestTier_Near, 40, 1100, 0));
+}
+
+TEST(MovementInterestTest, SendsRelevantUpdatesOverTheBudget) {
+    MovementInterest interest;
+    configureSmall(interest);
+
+    EXPECT_TRUE(interest.shouldSend(kObserver, 2, InterestTier_Relevant, 80, 1000, 0));
+    EXPECT_TRUE(interest.shouldSend(kObserver, 2, InterestTier_Relevant, 80, 1010, 0));
+
+    // but they used it up for the others
+    EXPECT_FALSE(interest.shouldSend(kObserver, 3, InterestTier_Near, 10, 1020, 0));
+}
+
+TEST(MovementInterestTest, HalvesTheBudgetAsTheHeapFillsUpDownToAnEighth) {
+    MovementInterest interest;
+    interest.configure(10.0f, 20.0f, 800);
+
+    EXPECT_EQ(800u, interest.getBudget(0));
+    EXPECT_EQ(800u, interest.getBudget(2));
+    EXPECT_EQ(400u, interest.getBudget(3));
+    EXPECT_EQ(200u, interest.getBudget(6));
+    EXPECT_EQ(100u, interest.getBudget(9));
+    EXPECT_EQ(100u, interest.getBudget(30));
+}
+
+TEST(MovementInterestTest, DropsUpdatesOverTheBudgetTheHeapLeaves) {
+    MovementInterest interest;
+    configureSmall(interest);
+
+    // a quarter of 100 bytes
+    EXPECT_TRUE(interest.shouldSend(kObserver, 2, InterestTier_Near, 20, 1000, 6));
+    EXPECT_FALSE(interest.shouldSend(kObserver, 3, InterestTier_Near, 20, 1010, 6));
+}
+
+TEST(MovementInterestTest, CatchesUpOnADroppedUpdateOnceItIsDue) {
+    MovementInterest interest;
+    configureSmall(interest);
+
+    interest.shouldSend(kObserver, kTarget, InterestTier_Mid, 10, 1000, 0);
+    interest.shouldSend(kObserver, kTarget, InterestTier_Mid, 10, 1010, 0);
+
+    std::vector<uint64> caught_up;
+    auto send = [&caught_up] (uint64, uint64 target) -> uint32 {
+        caught_up.push_back(target);
+        return 10;
+    };
+
+    // not due before the tier interval passed
+    interest.catchUp(1100, 0, send);
+    EXPECT_TRUE(caught_up.empty());
+
+    interest.catchUp(1510, 0, send);
+    ASSERT_EQ(1u, caught_up.size());
+    EXPECT_EQ(kTarget, caught_up[0]);
+    EXPECT_EQ(1u, interest.getStats().mCatchUps);
+
+    // it is not pending anymore
+    interest.catchUp(2100, 0, send);
+    EXPECT_EQ(1u, caught_up.size());
+}
+
+TEST(MovementInterestTest, CatchesUpOnlyWithinTheBudgetTheHeapLeaves) {
+    MovementInterest interest;
+    configureSmall(interest);
+
+    interest.shouldSend(kObserver, kTarget, InterestTier_Mid, 10, 1000, 0);
+    interest.shouldSend(kObserver, kTarget, InterestTier_Mid, 10, 1010, 0);
+
+    // 50 of 100 bytes used in the window of the catch up
+    interest.shouldSend(kObserver, 3, InterestTier_Relevant, 50, 1510, 0);
+
+    uint32 calls = 0;
+    auto send = [&calls] (uint64, uint64) -> uint32 {
+        calls++;
+        return 10;
+    };
+
+    // a quarter of the budget is used up already
+    interest.catchUp(1510, 6, send);
+    EXPECT_EQ(0u, calls);
+
+    interest.catchUp(1510, 0, send);
+    EXPECT_EQ(1u, calls);
+}
+
+TEST(MovementInterestTest, ForgetsPairsTheCatchUpCannotReach) {
+    MovementInterest interest;
+    configureSmall(interest);
+
+    interest.shouldSend(kObserver, kTarget, InterestTier_Mid, 10, 1000, 0);
+    interest.shouldSend(kObserver, kTarget, InterestTier_Mid, 10, 1010, 0);
+
+    uint32 calls = 0;
+    auto gone = [&calls] (uint64, uint64) -> uint32 {
+        calls++;
+        return 0;
+    };
+
+    interest.catchUp(1510, 0, gone);
+    interest.catchUp(2510, 0, gone);
+
+    EXPECT_EQ(1u, calls);
+    EXPECT_EQ(0u, interest.getStats().mCatchUps);
+}
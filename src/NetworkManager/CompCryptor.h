@@ -42,7 +42,6 @@ public:
     CompCryptor(void);
     ~CompCryptor(void);
 
-    int                               Compress(int8* inData, uint32 inLen, int8* outData, uint32 outLen);
     int                               Decompress(int8* inData, uint32 inLen, int8* outData, uint32 outLen);
 
     int                               Encrypt(int8* data, uint32 len, uint32 seed);
@@ -52,7 +51,7 @@ public:
 
 private:
     z_stream*                         mStreamData;
-    static const uint32               mCrcTable[256];
+    bool                              mStreamReady;
 };
 
 
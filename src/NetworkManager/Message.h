@@ -28,9 +28,13 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #ifndef ANH_LOGINSERVER_MESSAGE_H
 #define ANH_LOGINSERVER_MESSAGE_H
 
+#include <algorithm>
 #include <cstdint>
+#include <cstring>
 #include <string>
 
+#include <boost/atomic.hpp>
+
 #include "Utils/typedefs.h"
 #include "Utils/bstring.h"
 
@@ -69,6 +73,10 @@ public:
         , mFastpath(false)
         , mPendingDelete(false)
         , mData(0)
+        , mSharedPayload(nullptr)
+        , mReferences(0)
+        , mPatchOffset(0)
+        , mPatchSize(0)
     {}
 
     void                        Init(int8* data, uint16 len)      {
@@ -114,8 +122,20 @@ public:
     bool                        getFastpath(void)                 {
         return mFastpath;
     }
+
+	/*	@brief	a message can only be freed once it is flagged and no shared message references its payload anymore
+	*/
     bool                        getPendingDelete(void)            {
-        return mPendingDelete;
+        return mPendingDelete && (mReferences == 0);
+    }
+
+	/*	@brief	the message owning the payload of a shared message, NULL if the message owns its data
+	*/
+    Message*                    getSharedPayload(void)            {
+        return mSharedPayload;
+    }
+    uint32                      getReferences(void)               {
+        return mReferences;
     }
 
     void                        setData(int8* data)               {
@@ -160,9 +180,48 @@ public:
 	*	Please note that no messages after a message flagged as still in use (false) can be freed up
 	*/
 	void                        setPendingDelete(bool pending)    {
+        // a shared message gives up its reference to the payload the first time it is flagged
+        if(pending && !mPendingDelete && mSharedPayload)
+            --mSharedPayload->mReferences;
+
         mPendingDelete = pending;
     }
 
+	/*	@brief	makes this message a shared message, it references the (immutable) payload of the given message instead
+	*	of carrying a copy. The payload stays on the heap until all shared messages are flagged for deletion.
+	*	Only the network layer should read a shared message, the get / peek helpers do not see the patch.
+	*/
+    void                        setSharedPayload(Message* payload)  {
+        ++payload->mReferences;
+
+        mSharedPayload = payload;
+        mData = payload->getData();
+        mSize = payload->getSize();
+        mIndex = 0;
+    }
+
+	/*	@brief	sets the per recipient patch of a shared message, the 8 bytes at offset replace the bytes of the payload
+	*	when the message is written into a packet (the target id of the chat messages for example).
+	*/
+    void                        setPatch(uint16 offset, uint64 value)   {
+        mPatchOffset = offset;
+        mPatchSize = sizeof(uint64);
+        memcpy(mPatch, &value, sizeof(uint64));
+    }
+    bool                        hasPatch(void)                    {
+        return mPatchSize != 0;
+    }
+
+	/*	@brief	applies the patch to len bytes of the payload starting at offset which have been copied to dest
+	*/
+    void                        applyPatch(int8* dest, uint16 offset, uint16 len)    {
+        uint32 start = std::max<uint32>(offset, mPatchOffset);
+        uint32 end = std::min<uint32>(offset + len, mPatchOffset + mPatchSize);
+
+        if(start < end)
+            memcpy(dest + (start - offset), mPatch + (start - mPatchOffset), end - start);
+    }
+
     void                        getInt8(int8& data)               {
         data = *(int8*)&mData[mIndex];
         mIndex += sizeof(int8);
@@ -337,6 +396,12 @@ private:
 
     int8*                       mData;
 
+    Message*                    mSharedPayload;
+    boost::atomic<uint32>       mReferences;
+    uint16                      mPatchOffset;
+    uint8                       mPatchSize;
+    int8                        mPatch[8];
+
 };
 
 class CompareMsg
@@ -28,17 +28,34 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "MessageFactory.h"
 
 #include "anh/Utils/clock.h"
+#include "anh/size_class_arena.h"
 #include "NetworkManager/Session.h"
 
 #include <algorithm>
 #include <cassert>
 #include <cstring>
+#include <limits>
 
 #include "anh/logger.h"
 
-// TODO: There is no bounds checking on the heap yet.
 //======================================================================================================================
 
+namespace
+{
+    // room for the payload a new message starts out with, it moves to a larger block when it grows past that
+    const uint32 kInitialPayload = 128;
+
+    // the live messages a garbage collection pass looks at, so a single pass doesnt stall its thread
+    const uint32 kSweepBatch = 128;
+
+    // all factories share the blocks, every thread allocates from and frees into a cache of its own
+    swganh::SizeClassArena& getMessageArena()
+    {
+        static swganh::SizeClassArena arena(sizeof(Message), sizeof(Message) + 0x10000);
+        return arena;
+    }
+}
+
 MessageFactory* MessageFactory::mSingleton = 0;
 
 //======================================================================================================================
@@ -47,26 +64,25 @@ MessageFactory::MessageFactory(uint32 heapSize,uint32 serviceId)
     : mCurrentMessage(0)
     , mCurrentMessageEnd(0)
     , mCurrentMessageStart(0)
-    , mHeapStart(0)
-    , mHeapEnd(0)
-    , mHeapRollover(0)
-    , mMessageHeap(NULL)
+    , mCurrentMessageClass(0)
+    , mSweepCursor(0)
+    , mSweepOldest(std::numeric_limits<uint64>::max())
+    , mOldestMessageTime(0)
+    , mClassBytesInUse(getMessageArena().GetClassCount(), 0)
+    , mBytesInUse(0)
     , mHeapTotalSize(heapSize)
     , mMessagesCreated(0)
     , mMessagesDestroyed(0)
+    , mSharedMessagesCreated(0)
+    , mSharedBytesSaved(0)
     , mServiceId(0)
     , mHeapWarnLevel(80.0)
     , mMaxHeapUsedPercent(0)
+    , mCurrentUsed(0)
 {
     // the singleton is only for use with the zone - the services use their own instantiations as we need 1 factory per thread
     // as the factory is not thread safe
 
-    // Allocate our message heap.
-    mMessageHeap = new int8[mHeapTotalSize];
-    memset(mMessageHeap, 0xed, mHeapTotalSize);
-    mHeapStart = mMessageHeap;
-    mHeapEnd = mMessageHeap;
-
     mLastHeapLevel = 0;
     mLastHeapLevelTime = gClock->getSingleton()->getStoredTime();
 
@@ -80,7 +96,16 @@ MessageFactory::~MessageFactory()
 {
     // Here is the place for deletes of member data! Not in the Shutdown().
     // But now start to pray that no one still uses these messages. Who knows in this mess?
-    delete[] mMessageHeap;
+    while(!mLiveMessages.empty())
+    {
+        _freeMessage(static_cast<uint32>(mLiveMessages.size() - 1));
+    }
+
+    if(mCurrentMessage)
+    {
+        mCurrentMessage->~Message();
+        getMessageArena().Free(mCurrentMessageStart, mCurrentMessageClass);
+    }
 
     // mSingleton = 0;
     // Actually, we can't null mSingleton since network manager calls this code directly,
@@ -102,24 +127,13 @@ void MessageFactory::Process(void)
 }
 
 //======================================================================================================================
-// important is, that the size of the message class is not nuking our heap bounds!
+
 void MessageFactory::StartMessage(void)
 {
     // Do some garbage collection if we can.
     _processGarbageCollection();
 
-    // Initialize the message start and end.
-    mCurrentMessageStart = mHeapStart;
-
-    assert(mCurrentMessage==0 && "Can't handle more than one message at once.");
-
-    mCurrentMessageEnd = mCurrentMessageStart;
-
-    // Adjust start bounds if necessary.
-    _adjustMessageStart(sizeof(Message));
-
-    mCurrentMessage = new(mCurrentMessageStart) Message();
-    mCurrentMessageEnd = mCurrentMessageStart + sizeof(Message);
+    _startMessage(sizeof(Message) + kInitialPayload);
 }
 
 //======================================================================================================================
@@ -148,41 +162,40 @@ uint32 MessageFactory::HeapWarningLevel(void)
 
 //======================================================================================================================
 
+uint64 MessageFactory::getOldestMessageAge(void)
+{
+    if(mLiveMessages.empty() || !mOldestMessageTime)
+    {
+        return 0;
+    }
+
+    uint64 now = gClock->getSingleton()->getStoredTime();
+
+    return (now > mOldestMessageTime) ? now - mOldestMessageTime : 0;
+}
+
+//======================================================================================================================
+
 Message* MessageFactory::EndMessage(void)
 {
     assert(mCurrentMessage && "Must call StartMessage before EndMessage.");
 
-    // Do some garbage collection if we can.
-    //_processGarbageCollection();
-
     // Just cast the message start
     Message* message = mCurrentMessage;
 
     message->setData(mCurrentMessageStart + sizeof(Message));
     message->setSize((uint16)(mCurrentMessageEnd - mCurrentMessageStart) - sizeof(Message));
     message->setCreateTime(gClock->getSingleton()->getStoredTime());
-    mCurrentMessageStart = mCurrentMessageEnd;
+
+    LiveMessage live = { message, mCurrentMessageClass };
+    mLiveMessages.push_back(live);
 
     // Zero out our mCurrentMessage so we know we're not working on one.
     mCurrentMessage = 0;
 
-    //adjust heapstart to past our new message
-    mHeapStart += message->getSize() + sizeof(Message);
-
     //Update our stats.
     mMessagesCreated++;
-    mCurrentUsed = ((float)_getHeapSize() / (float)mHeapTotalSize)* 100.0f;
-    mMaxHeapUsedPercent = std::max<float>(mMaxHeapUsedPercent,  mCurrentUsed);
 
-	/*
-    // warn if we get near our boundaries
-    if(mCurrentUsed > mHeapWarnLevel)
-    {
-        mHeapWarnLevel = static_cast<float>(mCurrentUsed+1.2);
-        LOG(warning) << "MessageFactory Heap at " << mCurrentUsed;
-    } else if (((mCurrentUsed+2.2) < mHeapWarnLevel) && mHeapWarnLevel > 80.0)
-        mHeapWarnLevel = mCurrentUsed;
-	*/
     return message;
 }
 
@@ -196,13 +209,47 @@ void MessageFactory::DestroyMessage(Message* message)
 
 //======================================================================================================================
 
+Message* MessageFactory::CreateSharedMessage(Message* payload)
+{
+    // always reference the owner of the payload, the payload of a shared message isnt in the block behind it
+    if(payload->getSharedPayload())
+    {
+        payload = payload->getSharedPayload();
+    }
+
+    // the payload stays alive until the last shared message is flagged for deletion
+    _processGarbageCollection();
+
+    // only the message itself needs a block
+    _startMessage(sizeof(Message));
+
+    Message* message = mCurrentMessage;
+
+    message->setSharedPayload(payload);
+    message->setCreateTime(gClock->getSingleton()->getStoredTime());
+
+    LiveMessage live = { message, mCurrentMessageClass };
+    mLiveMessages.push_back(live);
+
+    mCurrentMessage = 0;
+
+    //Update our stats.
+    mMessagesCreated++;
+    mSharedMessagesCreated++;
+    mSharedBytesSaved += payload->getSize();
+
+    return message;
+}
+
+//======================================================================================================================
+
 void MessageFactory::addInt8(int8 data)
 {
     // Make sure we've called StartMessage()
     assert(mCurrentMessage && "Must call StartMessage before adding data");
 
-    // Adjust start bounds if necessary.
-    _adjustHeapStartBounds(sizeof(data));
+    // Make room if necessary.
+    _reserve(sizeof(data));
 
     // Insert our data and move our end pointer.
     *mCurrentMessageEnd = data;
@@ -216,8 +263,8 @@ void MessageFactory::addUint8(uint8 data)
     // Make sure we've called StartMessage()
     assert(mCurrentMessage && "Must call StartMessage before adding data");
 
-    // Adjust start bounds if necessary.
-    _adjustHeapStartBounds(sizeof(data));
+    // Make room if necessary.
+    _reserve(sizeof(data));
 
     // Insert our data and move our end pointer.
     *mCurrentMessageEnd = (uint8)data;
@@ -231,8 +278,8 @@ void MessageFactory::addInt16(int16 data)
     // Make sure we've called StartMessage()
     assert(mCurrentMessage && "Must call StartMessage before adding data");
 
-    // Adjust start bounds if necessary.
-    _adjustHeapStartBounds(sizeof(data));
+    // Make room if necessary.
+    _reserve(sizeof(data));
 
     // Insert our data and move our end pointer.
     *((int16*)mCurrentMessageEnd) = data;
@@ -246,8 +293,8 @@ void MessageFactory::addUint16(uint16 data)
     // Make sure we've called StartMessage()
     assert(mCurrentMessage && " no current message");
 
-    // Adjust start bounds if necessary.
-    _adjustHeapStartBounds(sizeof(data));
+    // Make room if necessary.
+    _reserve(sizeof(data));
 
     // Insert our data and move our end pointer.
     *((uint16*)mCurrentMessageEnd) = data;
@@ -261,8 +308,8 @@ void MessageFactory::addInt32(int32 data)
     // Make sure we've called StartMessage()
     assert(mCurrentMessage && "Must call StartMessage before adding data");
 
-    // Adjust start bounds if necessary.
-    _adjustHeapStartBounds(sizeof(data));
+    // Make room if necessary.
+    _reserve(sizeof(data));
 
     // Insert our data and move our end pointer.
     *((int32*)mCurrentMessageEnd) = data;
@@ -276,8 +323,8 @@ void MessageFactory::addUint32(uint32 data)
     // Make sure we've called StartMessage()
     assert(mCurrentMessage && "Must call StartMessage before adding data");
 
-    // Adjust start bounds if necessary.
-    _adjustHeapStartBounds(sizeof(data));
+    // Make room if necessary.
+    _reserve(sizeof(data));
 
     // Insert our data and move our end pointer.
     *((uint32*)mCurrentMessageEnd) = data;
@@ -291,8 +338,8 @@ void MessageFactory::addInt64(int64 data)
     // Make sure we've called StartMessage()
     assert(mCurrentMessage && "Must call StartMessage before adding data");
 
-    // Adjust start bounds if necessary.
-    _adjustHeapStartBounds(sizeof(data));
+    // Make room if necessary.
+    _reserve(sizeof(data));
 
     // Insert our data and move our end pointer.
     *((int64*)mCurrentMessageEnd) = data;
@@ -306,8 +353,8 @@ void MessageFactory::addUint64(uint64 data)
     // Make sure we've called StartMessage()
     assert(mCurrentMessage && "Must call StartMessage before adding data");
 
-    // Adjust start bounds if necessary.
-    _adjustHeapStartBounds(sizeof(data));
+    // Make room if necessary.
+    _reserve(sizeof(data));
 
     // Insert our data and move our end pointer.
     *((uint64*)mCurrentMessageEnd) = data;
@@ -321,8 +368,8 @@ void MessageFactory::addFloat(float data)
     // Make sure we've called StartMessage()
     assert(mCurrentMessage && "Must call StartMessage before adding data");
 
-    // Adjust start bounds if necessary.
-    _adjustHeapStartBounds(sizeof(data));
+    // Make room if necessary.
+    _reserve(sizeof(data));
 
     // Insert our data and move our end pointer.
     *((float*)mCurrentMessageEnd) = data;
@@ -336,8 +383,8 @@ void MessageFactory::addDouble(double data)
     // Make sure we've called StartMessage()
     assert(mCurrentMessage && "Must call StartMessage before adding data");
 
-    // Adjust start bounds if necessary.
-    _adjustHeapStartBounds(sizeof(data));
+    // Make room if necessary.
+    _reserve(sizeof(data));
 
     // Insert our data and move our end pointer.
     *((double*)mCurrentMessageEnd) = data;
@@ -357,8 +404,8 @@ void MessageFactory::addString(const std::string& string)
 
 void MessageFactory::addString(const std::wstring& string)
 {
-    // Adjust start bounds if necessary.
-    _adjustHeapStartBounds(string.size());
+    // Make room if necessary.
+    _reserve(4 + string.size() * 2);
 
     // First insert the string length
     *((uint32*)mCurrentMessageEnd) = string.length();
@@ -372,8 +419,8 @@ void MessageFactory::addString(const std::wstring& string)
 
 void MessageFactory::addString(const std::u16string& string)
 {
-    // Adjust start bounds if necessary.
-    _adjustHeapStartBounds(string.size());
+    // Make room if necessary.
+    _reserve(4 + string.size() * 2);
 
     // First insert the string length
     *((uint32*)mCurrentMessageEnd) = string.length();
@@ -416,8 +463,8 @@ void MessageFactory::addString(const BString& data)
     // Make sure we've called StartMessage()
     assert(mCurrentMessage && "Must call StartMessage before adding data");
 
-    // Adjust start bounds if necessary.
-    _adjustHeapStartBounds(data.getDataLength());
+    // Make room if necessary.
+    _reserve(4 + data.getDataLength());
 
     // Insert our data and move our end pointer.
     switch(data.getType())
@@ -454,8 +501,8 @@ void MessageFactory::addData(const int8* data, uint16 len)
     // Make sure we've called StartMessage()
     assert(mCurrentMessage && "Must call StartMessage before adding data");
 
-    // Adjust start bounds if necessary.
-    _adjustHeapStartBounds(len);
+    // Make room if necessary.
+    _reserve(len);
 
     // Insert our data and move our end pointer.
     memcpy(mCurrentMessageEnd, data, len);
@@ -469,8 +516,8 @@ void MessageFactory::addData(const uint8_t* data, uint16 len)
     // Make sure we've called StartMessage()
     assert(mCurrentMessage && "Must call StartMessage before adding data");
 
-    // Adjust start bounds if necessary.
-    _adjustHeapStartBounds(len);
+    // Make room if necessary.
+    _reserve(len);
 
     // Insert our data and move our end pointer.
     memcpy(reinterpret_cast<uint8_t*>(mCurrentMessageEnd), data, len);
@@ -479,6 +526,22 @@ void MessageFactory::addData(const uint8_t* data, uint16 len)
 
 //======================================================================================================================
 
+int8* MessageFactory::allocateData(uint16 len)
+{
+    // Make sure we've called StartMessage()
+    assert(mCurrentMessage && "Must call StartMessage before adding data");
+
+    // Make room if necessary.
+    _reserve(len);
+
+    int8* data = mCurrentMessageEnd;
+    mCurrentMessageEnd += len;
+
+    return data;
+}
+
+//======================================================================================================================
+
 void MessageFactory::_processGarbageCollection(void)
 {
 	// warn if we get near our boundaries
@@ -486,209 +549,211 @@ void MessageFactory::_processGarbageCollection(void)
     {
         mHeapWarnLevel = static_cast<float>(mCurrentUsed+1.2);
         LOG(warning) << "MessageFactory::_processGarbageCollection MessageFactory Heap at " << mCurrentUsed;
+        _logStats();
     } else if (((mCurrentUsed+2.2) < mHeapWarnLevel) && mHeapWarnLevel > 80.0)
         mHeapWarnLevel = mCurrentUsed;
 
-    // Just check to see if the oldest message is ready to be deleted yet.
-    //start with the oldest message
-    assert(mHeapEnd < mMessageHeap + mHeapTotalSize && "mHeapEnd not within mMessageHeap bounds");
-    Message* message = reinterpret_cast<Message*>(mHeapEnd);
-
-    //when the oldest Message wont get deleted No other messages get deleted from the heap !!!!!!!!
-
-
+    // every message is freed as soon as it is done with, a stuck message only holds on to its own block
+    uint64 now = Anh_Utils::Clock::getSingleton()->getStoredTime();
     uint32 count = 0;
-    bool further = true;
 
 	//do not stall through excessive work
-    while( (count <= 100) && further)    {
-        if (mHeapEnd != mHeapStart)        {
-			//delete all messages marked for deletion
-            if (message->getPendingDelete())	{
-                message->~Message();
-                
-                mHeapEnd += message->getSize() + sizeof(Message);
-
-                mMessagesDestroyed++;
-
-                // If we're at the end of the queue, rollover to the front again.
-                if (mHeapEnd == mHeapRollover)	{
-                    if (mHeapEnd == mHeapStart)                    {
-                        mHeapStart = mMessageHeap;
-                    }
-
-                    mHeapEnd		= mMessageHeap;
-                    mHeapRollover	= 0;
-                }
-
-                message = reinterpret_cast<Message*>(mHeapEnd);
-
-                if(!message)
-                    return;
+    while(count < kSweepBatch)
+    {
+        if(mSweepCursor >= mLiveMessages.size())
+        {
+            // a full sweep is done, it saw every message still alive
+            mOldestMessageTime = mLiveMessages.empty() ? 0 : mSweepOldest;
+            mSweepOldest = std::numeric_limits<uint64>::max();
+            mSweepCursor = 0;
 
-				//sanity checks for debugging
-                assert(mHeapEnd < mMessageHeap + mHeapTotalSize  && "mHeapEnd not within mMessageHeap bounds");
+            if(mLiveMessages.empty())
+            {
+                return;
+            }
+        }
 
-                further = (mHeapEnd != mHeapStart) && message->getPendingDelete();
+        Message* message = mLiveMessages[mSweepCursor].message;
 
-            }//pending delete
+        //delete all messages marked for deletion
+        if(message->getPendingDelete())
+        {
+            // the last message takes its place, the cursor looks at it next
+            _freeMessage(mSweepCursor);
+        }
+        else
+        {
+            mSweepOldest = std::min(mSweepOldest, message->getCreateTime());
 
 			//a session might indeed stall - in this case we need to get rid of it
 			//we realize this when we have messages older than 60 seconds
 			//alternatively someone might have forgot to close a message
-            else if(Anh_Utils::Clock::getSingleton()->getStoredTime() - message->getCreateTime() > MESSAGE_MAX_LIFE_TIME)
+            if(now - message->getCreateTime() > MESSAGE_MAX_LIFE_TIME)
             {
-                further = false;
-                if (!message->mLogged)
-                {
-                    LOG(warning) <<  "MessageFactory::_processGarbageCollection Garbage Collection found a new stuck message! Message age : " 
-						<< ( uint32((Anh_Utils::Clock::getSingleton()->getStoredTime() - message->getCreateTime())/1000))
-						<< " seconds";
-
-                    message->mLogged = true;
-                    message->mLogTime = Anh_Utils::Clock::getSingleton()->getStoredTime();    
-                }
-
-                Session* session = (Session*)message->mSession;
-
-                if(!session)
-                {
-                    LOG(info) << "MessageFactory::_processGarbageCollection Garbage Collection found sessionless packet";
-                    message->setPendingDelete(true);
-					return;
-                }
-                else if(Anh_Utils::Clock::getSingleton()->getStoredTime() >(message->mLogTime +10000))
-                {
-                    LOG(warning) << "MessageFactory::_processGarbageCollection Garbage Collection found an old stuck message!"
-                    << "age : "<< (uint32((Anh_Utils::Clock::getSingleton()->getStoredTime() - message->getCreateTime())/1000))
-                    << "Session status : " << session->getStatus();
-                    message->mLogTime  = Anh_Utils::Clock::getSingleton()->getStoredTime();
-                    return;
-                }
-                else if(Anh_Utils::Clock::getSingleton()->getStoredTime() - message->getCreateTime() > MESSAGE_MAX_LIFE_TIME*2)
-                {
-
-                    // make sure that the status is not set again from Destroy to Disconnecting
-                    // otherwise we wont ever get rid of that session
-                    if(session->getStatus() < SSTAT_Disconnecting)
-                    {
-                        session->setCommand(SCOM_Disconnect);
-                        LOG(warning) << "MessageFactory::_processGarbageCollection : Garbage Collection Message Heap Time out. Destroying Session";
-                    }
-                     if(session->getStatus() == SSTAT_Destroy)
-                     {
-                         LOG(warning) << "MessageFactory::_processGarbageCollection : Garbage Collection Message Heap Time out. Session about to Destroyed.";
-                     }
-                     return;
-                 }
-
+                _checkStuckMessage(message, now);
             }
-            else
-                return;
 
-        }//Heap start != Heapend
-        else        {
-            return;
+            mSweepCursor++;
         }
 
-        //we need to be accurate here
         count++;
     }
-
 }
 
 //======================================================================================================================
 
-void MessageFactory::_adjustHeapStartBounds(uint32 size)
+void MessageFactory::_checkStuckMessage(Message* message, uint64 now)
 {
-    // Are we going to overflow our heap?
-    uint32 heapSize = _getHeapSize();
-
-    // _getHeapSize() returns the size of already constructed packets,
-    // but NOT the parts we already have been added for THIS message under construction.
-
-    uint32 messageSize = (mCurrentMessageEnd - mCurrentMessageStart);
+    if (!message->mLogged)
+    {
+        LOG(warning) <<  "MessageFactory::_processGarbageCollection Garbage Collection found a new stuck message! Message age : "
+            << ( uint32((now - message->getCreateTime())/1000))
+            << " seconds";
 
-    //assert(mHeapTotalSize > messageSize + heapSize + size);
-    assert(mHeapTotalSize > messageSize + heapSize && "Message heap overflow.");
+        message->mLogged = true;
+        message->mLogTime = now;
+    }
 
-    // Check to see if this add is going to push past the heap boundry.
-    if(mCurrentMessageEnd + size > mMessageHeap + mHeapTotalSize)
+    // a flagged payload waits for its shared messages, these get flagged once their sessions are done with them
+    if(message->getReferences())
     {
-        // We've gone past the end of our heap, copy this message to the front of the heap and continue
+        return;
+    }
 
-        memcpy(mMessageHeap, mCurrentMessageStart, messageSize);
+    Session* session = (Session*)message->mSession;
 
-        // Reset our main heap pointer(s)
-        if(mHeapStart == mHeapEnd)
+    if(!session)
+    {
+        LOG(info) << "MessageFactory::_processGarbageCollection Garbage Collection found sessionless packet";
+        message->setPendingDelete(true);
+    }
+    else if(now >(message->mLogTime +10000))
+    {
+        LOG(warning) << "MessageFactory::_processGarbageCollection Garbage Collection found an old stuck message!"
+        << "age : "<< (uint32((now - message->getCreateTime())/1000))
+        << "Session status : " << session->getStatus();
+        message->mLogTime  = now;
+    }
+    else if(now - message->getCreateTime() > MESSAGE_MAX_LIFE_TIME*2)
+    {
+        // make sure that the status is not set again from Destroy to Disconnecting
+        // otherwise we wont ever get rid of that session
+        if(session->getStatus() < SSTAT_Disconnecting)
+        {
+            session->setCommand(SCOM_Disconnect);
+            LOG(warning) << "MessageFactory::_processGarbageCollection : Garbage Collection Message Heap Time out. Destroying Session";
+        }
+        if(session->getStatus() == SSTAT_Destroy)
         {
-            mHeapEnd = mMessageHeap;
+            LOG(warning) << "MessageFactory::_processGarbageCollection : Garbage Collection Message Heap Time out. Session about to Destroyed.";
         }
+    }
+}
 
-        mHeapStart		= mMessageHeap;
-        mHeapRollover	= mCurrentMessageStart;
+//======================================================================================================================
 
-        // Reinit our message pointers.
-        mCurrentMessage			= (Message*)mMessageHeap;
-        mCurrentMessageStart	= mMessageHeap;
-        mCurrentMessageEnd		= mMessageHeap + messageSize;
+void MessageFactory::_freeMessage(uint32 index)
+{
+    LiveMessage live = mLiveMessages[index];
 
-        mCurrentMessage->setData(mMessageHeap + sizeof(Message));
+    mLiveMessages[index] = mLiveMessages.back();
+    mLiveMessages.pop_back();
 
-       LOG(warning)<< "Heap Rollover Service " << mServiceId << "STATS: MessageHeap - size:"
-        << heapSize << " maxUsed: " << mMaxHeapUsedPercent <<", created: " << mMessagesCreated <<", destroyed: " << mMessagesDestroyed;
-    }
+    live.message->~Message();
+    getMessageArena().Free(live.message, live.sizeClass);
+    _released(live.sizeClass);
+
+    mMessagesDestroyed++;
 }
 
-// the trouble is, that if we start a new Message we need to check whether the size of the message class is still inside the heap bounds.
-// However mCurrentMessage is 0 at that point
-void MessageFactory::_adjustMessageStart(uint32 size)
+//======================================================================================================================
+
+void MessageFactory::_startMessage(uint32 size)
 {
-    // Are we going to overflow our heap?
-    uint32 heapSize = _getHeapSize();
+    assert(mCurrentMessage==0 && "Can't handle more than one message at once.");
+
+    mCurrentMessageClass = getMessageArena().GetClass(size);
+    mCurrentMessageStart = static_cast<int8*>(getMessageArena().Allocate(mCurrentMessageClass));
+    _allocated(mCurrentMessageClass);
 
-    // _getHeapSize() returns the size of already constructed packets,
-    // but NOT the parts we already have been added for THIS message under construction.
+    mCurrentMessage = new(mCurrentMessageStart) Message();
+    mCurrentMessageEnd = mCurrentMessageStart + sizeof(Message);
+}
 
-    uint32 messageSize = (mCurrentMessageEnd - mCurrentMessageStart);
+//======================================================================================================================
 
-    //assert(mHeapTotalSize > messageSize + heapSize + size);
-    assert(mHeapTotalSize > messageSize + heapSize && "Message heap overflow.");
+void MessageFactory::_reserve(uint32 size)
+{
+    uint32 messageSize = (uint32)(mCurrentMessageEnd - mCurrentMessageStart);
 
-    // Check to see if this add is going to push past the heap boundry.
-    if(mCurrentMessageEnd + size > mMessageHeap + mHeapTotalSize)
+    if(messageSize + size <= getMessageArena().GetClassSize(mCurrentMessageClass))
     {
-        // We've gone past the end of our heap, copy this message to the front of the heap and continue
+        return;
+    }
 
-        memcpy(mMessageHeap, mCurrentMessageStart, messageSize);
+    // move the message into a block of the class it fits now
+    uint32 sizeClass = getMessageArena().GetClass(messageSize + size);
+    assert(sizeClass != swganh::SizeClassArena::kNoClass && "Message exceeds the largest message block.");
 
-        // Reset our main heap pointer(s)
-        if(mHeapStart == mHeapEnd)
-        {
-            mHeapEnd = mMessageHeap;
-        }
+    int8* start = static_cast<int8*>(getMessageArena().Allocate(sizeClass));
+    _allocated(sizeClass);
 
-        mHeapStart		= mMessageHeap;
-        mHeapRollover	= mCurrentMessageStart;
+    memcpy(start, mCurrentMessageStart, messageSize);
 
-        // Reinit our message pointers.
-        mCurrentMessage			= (Message*)mMessageHeap;
-        mCurrentMessageStart	= mMessageHeap;
-        mCurrentMessageEnd		= mMessageHeap + messageSize;
+    getMessageArena().Free(mCurrentMessageStart, mCurrentMessageClass);
+    _released(mCurrentMessageClass);
 
-        //mCurrentMessage->setData(mMessageHeap + sizeof(Message));
+    // Reinit our message pointers.
+    mCurrentMessage			= (Message*)start;
+    mCurrentMessageStart	= start;
+    mCurrentMessageEnd		= start + messageSize;
+    mCurrentMessageClass	= sizeClass;
 
-        LOG(warning)<< "Heap Rollover Service " << mServiceId << "STATS: MessageHeap - size:"
-        << heapSize << " maxUsed: " << mMaxHeapUsedPercent <<", created: " << mMessagesCreated <<", destroyed: " << mMessagesDestroyed;
-    }
+    mCurrentMessage->setData(start + sizeof(Message));
 }
 
 //======================================================================================================================
 
+void MessageFactory::_allocated(uint32 sizeClass)
+{
+    uint64 bytes = getMessageArena().GetClassSize(sizeClass);
 
+    mClassBytesInUse[sizeClass] += bytes;
+    mBytesInUse += bytes;
 
+    mCurrentUsed = ((float)mBytesInUse / (float)mHeapTotalSize)* 100.0f;
+    mMaxHeapUsedPercent = std::max<float>(mMaxHeapUsedPercent,  mCurrentUsed);
+}
 
+//======================================================================================================================
 
+void MessageFactory::_released(uint32 sizeClass)
+{
+    uint64 bytes = getMessageArena().GetClassSize(sizeClass);
 
+    mClassBytesInUse[sizeClass] -= bytes;
+    mBytesInUse -= bytes;
 
+    mCurrentUsed = ((float)mBytesInUse / (float)mHeapTotalSize)* 100.0f;
+}
+
+//======================================================================================================================
 
+void MessageFactory::_logStats(void)
+{
+    LOG(warning) << "Service " << mServiceId << " STATS: MessageHeap - in use: " << mBytesInUse << " bytes of " << mHeapTotalSize
+        << ", live: " << mLiveMessages.size() << ", oldest: " << (getOldestMessageAge() / 1000) << "s"
+        << ", maxUsed: " << mMaxHeapUsedPercent << ", created: " << mMessagesCreated << ", destroyed: " << mMessagesDestroyed
+        << ", shared: " << mSharedMessagesCreated << ", shared bytes saved: " << mSharedBytesSaved;
+
+    for(uint32 i = 0; i < mClassBytesInUse.size(); ++i)
+    {
+        if(mClassBytesInUse[i])
+        {
+            LOG(warning) << "    " << getMessageArena().GetClassSize(i) << " byte blocks: " << (mClassBytesInUse[i] / getMessageArena().GetClassSize(i))
+                << " in use, " << getMessageArena().GetPool(i).GetCapacity() << " held";
+        }
+    }
+}
+
+//======================================================================================================================
@@ -30,6 +30,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 
 #include <cstdint>
 #include <string>
+#include <vector>
 #include <assert.h>
 #include "Utils/typedefs.h"
 
@@ -63,6 +64,10 @@ public:
 
     void                    DestroyMessage(Message* message);
 
+    // creates a message referencing the payload of the given message instead of copying it
+    // used to send the same message to many recipients, see Message::setSharedPayload
+    Message*                CreateSharedMessage(Message* payload);
+
     static MessageFactory*	getSingleton(void);
 	static MessageFactory*	getSingleton(uint32_t heap_size);
     static void             destroySingleton(void);
@@ -88,34 +93,84 @@ public:
     void					addString(const unsigned short* ustring);
     void                    addData(const int8* data, uint16 len);
     void                    addData(const uint8_t* data, uint16 len);
+    // makes room for len bytes and returns where they go, for data gathered from several places
+    int8*                   allocateData(uint16 len);
 
     float					getHeapsize() {
         return mCurrentUsed;
     }
+
+    uint32					getSharedMessagesCreated() {
+        return mSharedMessagesCreated;
+    }
+
+    // the payload bytes the shared messages did not copy
+    uint64					getSharedBytesSaved() {
+        return mSharedBytesSaved;
+    }
+
+    // the memory held by the messages alive, in total and per size class
+    uint64					getBytesInUse() {
+        return mBytesInUse;
+    }
+
+    uint32					getSizeClassCount() {
+        return static_cast<uint32>(mClassBytesInUse.size());
+    }
+
+    uint64					getClassBytesInUse(uint32 sizeClass) {
+        return mClassBytesInUse[sizeClass];
+    }
+
+    uint32					getLiveMessages() {
+        return static_cast<uint32>(mLiveMessages.size());
+    }
+
+    // the age of the oldest message alive as of the last full garbage collection sweep
+    uint64					getOldestMessageAge(void);
+
 private:
 
+    struct LiveMessage
+    {
+        Message*            message;
+        uint32              sizeClass;
+    };
+
     void                    _processGarbageCollection(void);
-    void                    _adjustHeapStartBounds(uint32 size);
-    //make sure our messageclass size is put inside heap bounds
-    void					_adjustMessageStart(uint32 size);
-    void                    _adjustHeapEndBounds(uint32 size);
-    uint32                  _getHeapSize(void);
+    // a stuck message holds its block until its session is done with it or gets disconnected
+    void                    _checkStuckMessage(Message* message, uint64 now);
+    void                    _freeMessage(uint32 index);
+    // places a new message into a block holding at least size bytes
+    void                    _startMessage(uint32 size);
+    // makes room for size more bytes in the message under construction
+    void                    _reserve(uint32 size);
+    void                    _allocated(uint32 sizeClass);
+    void                    _released(uint32 sizeClass);
+    void                    _logStats(void);
 
     Message*                mCurrentMessage;
     int8*                   mCurrentMessageEnd;
     int8*                   mCurrentMessageStart;
+    uint32                  mCurrentMessageClass;
 
-    int8*                   mHeapStart;
-    int8*                   mHeapEnd;
-    int8*                   mHeapRollover;
-    int8*                   mMessageHeap;
+    // the messages alive in any order, the garbage collection sweeps them a slice at a time
+    std::vector<LiveMessage> mLiveMessages;
+    uint32                  mSweepCursor;
+    uint64                  mSweepOldest;
+    uint64                  mOldestMessageTime;
+
+    std::vector<uint64>     mClassBytesInUse;
+    uint64                  mBytesInUse;
     uint64									mLastTime; //last message about stuck messages
-    uint32                  mHeapTotalSize; //total heapsize used AND unused
+    uint32                  mHeapTotalSize; //the budget the heap usage is measured against
 
 
     // Statistics
     uint32                  mMessagesCreated;
     uint32                  mMessagesDestroyed;
+    uint32                  mSharedMessagesCreated;
+    uint64                  mSharedBytesSaved;
     uint32					mServiceId;
     float					mHeapWarnLevel;
     float                   mMaxHeapUsedPercent;
@@ -165,19 +220,6 @@ inline void MessageFactory::destroySingleton(void)
 
 //======================================================================================================================
 
-inline uint32 MessageFactory::_getHeapSize(void)
-{
-    if (mHeapStart >= mHeapEnd)
-    {
-        return (uint32)(mHeapStart - mHeapEnd);
-    }
-
-    return (uint32)mHeapTotalSize-(mHeapEnd - mHeapStart);
-    //return (uint32)(mMessageHeap + mHeapTotalSize - mHeapEnd + mHeapStart - mMessageHeap);
-}
-
-//======================================================================================================================
-
 #endif  //MMOSERVER_LOGINSERVER_MESSAGEFACTORY_H
 
 
@@ -43,6 +43,7 @@ enum MessageOpcodes
     opClusterZoneTransferApprovedByTicket	= 0xA608F0B2,
     opClusterZoneTransferDenied				= 0x7B4AF214,
     opClusterZoneTransferCharacter			= 0x74C4FC34,
+    opClusterMulticast						= 0xF1F423CD,
     opTutorialServerStatusRequest			= 0x5E48A399,
     opTutorialServerStatusReply				= 0x989EDF5A,
     opSelectCharacter						= 0xb5098d76,
@@ -62,6 +63,19 @@ enum MessageOpcodes
     opLauncherSessionCreated                = 0x2e4e6574
 };
 
+//======================================================================================================================
+//
+// opClusterMulticast carries one client message for many accounts from a zone to the ConnectionServer :
+// uint8 fastpath, uint16 patch offset, uint16 recipient count, per recipient the uint32 account id (followed by
+// the uint64 that replaces the payload at the patch offset, unless it is MULTICAST_NO_PATCH) and finally the payload
+//
+
+#define MULTICAST_NO_PATCH			0xffff
+#define MULTICAST_MAX_RECIPIENTS	256
+
+// the largest unreliable envelope, a session sends larger ones reliably
+#define MULTICAST_MAX_UNRELIABLE_SIZE	MAX_PACKET_SIZE
+
 
 #endif // ANH_COMMON_MESSAGEOPCODES_H
 
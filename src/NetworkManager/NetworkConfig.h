@@ -30,6 +30,8 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 
 #include <stdint.h>
 
+#include "anh/network/datagram_io.h"
+
 /**
  * \brief A catalog of available Network Configuration options.
  */
@@ -39,7 +41,7 @@ public:
 	/**
 	 * \brief Initializes the configuration options.
 	 */
-	NetworkConfig(uint16_t reliable_size_server_to_server, uint16_t unreliable_size_server_to_server, uint16_t reliable_size_server_to_client, uint16_t unreliable_size_server_to_client, uint32_t server_packet_window, uint32_t client_packet_window, uint32_t udp_buffer_size) 
+	NetworkConfig(uint16_t reliable_size_server_to_server, uint16_t unreliable_size_server_to_server, uint16_t reliable_size_server_to_client, uint16_t unreliable_size_server_to_client, uint32_t server_packet_window, uint32_t client_packet_window, uint32_t udp_buffer_size, swganh::network::SocketBackend socket_backend = swganh::network::SOCKET_BACKEND_SELECT, uint32_t socket_batch_size = 32, uint32_t socket_write_workers = 2, uint32_t compression_min_size = 48, uint32_t compression_stats_interval = 300) 
 		: reliable_size_server_to_server_(reliable_size_server_to_server)
 		, unreliable_size_server_to_server_(unreliable_size_server_to_server)
 		, reliable_size_server_to_client_(reliable_size_server_to_client)
@@ -47,6 +49,11 @@ public:
 		, server_packet_window_(server_packet_window)
 		, client_packet_window_(client_packet_window)
 		, udp_buffer_size_(udp_buffer_size)
+		, socket_backend_(socket_backend)
+		, socket_batch_size_(socket_batch_size)
+		, socket_write_workers_(socket_write_workers)
+		, compression_min_size_(compression_min_size)
+		, compression_stats_interval_(compression_stats_interval)
 	{
 	}
 
@@ -83,6 +90,29 @@ public:
 		return udp_buffer_size_;
 	}
 
+	const swganh::network::SocketBackend getSocketBackend() const {
+		return socket_backend_;
+	}
+
+	const uint32_t getSocketBatchSize() const {
+		return socket_batch_size_;
+	}
+
+	const uint32_t getSocketWriteWorkers() const {
+		return socket_write_workers_;
+	}
+
+	const uint32_t getCompressionMinSize() const {
+		return compression_min_size_;
+	}
+
+	/**
+	 * \brief seconds between the compression stats of a service in the log, 0 for none
+	 */
+	const uint32_t getCompressionStatsInterval() const {
+		return compression_stats_interval_;
+	}
+
 private:
 	uint16_t	reliable_size_server_to_server_;
 	uint16_t	unreliable_size_server_to_server_;
@@ -91,6 +121,11 @@ private:
 	uint32_t	server_packet_window_;
 	uint32_t	client_packet_window_;
 	uint32_t	udp_buffer_size_;
+	swganh::network::SocketBackend	socket_backend_;
+	uint32_t	socket_batch_size_;
+	uint32_t	socket_write_workers_;
+	uint32_t	compression_min_size_;
+	uint32_t	compression_stats_interval_;
 };
 
 #endif
\ No newline at end of file
@@ -101,14 +101,14 @@ public:
         mReadIndex = index;
     }
     void                          setWriteIndex(uint16 index)         {
-        mReadIndex = index;
+        mWriteIndex = index;
     }
 
     uint16                        getReadIndex(void)                  {
         return mReadIndex;
     }
     uint16                        getWriteIndex(void)                 {
-        return mReadIndex;
+        return mWriteIndex;
     }
 
     uint64                        getTimeCreated(void)                {
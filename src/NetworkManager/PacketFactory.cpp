@@ -28,14 +28,14 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "PacketFactory.h"
 #include "Packet.h"
 
+#include "anh/logger.h"
+
 
 //======================================================================================================================
 
 PacketFactory::PacketFactory(bool serverservice, NetworkConfig& network_configuration)
     : mPacketPool(sizeof(Packet))
 {
-    mPacketCount = 0;
-
     if(serverservice)
         mMaxPayLoad = network_configuration.getServerToServerReliableSize();
     else
@@ -50,7 +50,8 @@ PacketFactory::~PacketFactory(void)
     // Destory our clock
     // delete mClock;
 
-    mPacketPool.purge_memory();
+    LOG(info) << "PacketFactory: " << mPacketPool.GetCapacity() << " packets allocated, at most "
+              << mPacketPool.GetHighWaterMark() << " in use";
 }
 
 //======================================================================================================================
@@ -66,15 +67,11 @@ void PacketFactory::Process(void)
 
 Packet* PacketFactory::CreatePacket(void)
 {
-
-    boost::recursive_mutex::scoped_lock lk(mPacketFactoryMutex);
-    Packet* newPacket = new(mPacketPool.malloc()) Packet();
+    Packet* newPacket = new(mPacketPool.Allocate()) Packet();
 
     newPacket->setTimeCreated(Anh_Utils::Clock::getSingleton()->getStoredTime());
     newPacket->setMaxPayload(mMaxPayLoad);
 
-    mPacketCount++;
-
     return newPacket;
 }
 
@@ -82,10 +79,7 @@ Packet* PacketFactory::CreatePacket(void)
 
 void PacketFactory::DestroyPacket(Packet* packet)
 {
-    boost::recursive_mutex::scoped_lock lk(mPacketFactoryMutex);
-
-    mPacketPool.free(packet);
-    mPacketCount--;
+    mPacketPool.Free(packet);
 }
 
 //======================================================================================================================
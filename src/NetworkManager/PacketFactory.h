@@ -32,11 +32,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "anh/Utils/clock.h"
 #include "NetworkConfig.h"
 #include "Packet.h"
-#include <boost/pool/pool.hpp>
-
-//======================================================================================================================
-
-typedef boost::pool<boost::default_user_allocator_malloc_free> PacketPool;
+#include "anh/block_pool.h"
 
 //======================================================================================================================
 
@@ -49,16 +45,16 @@ public:
 
     void		Process(void);
 
+    // thread safe, every thread creates from and destroys into a cache of its own
     Packet*		CreatePacket(void);
     void		DestroyPacket(Packet* packet);
 
+    swganh::BlockPool&	getPacketPool(void) { return mPacketPool; }
+
     uint16		mMaxPayLoad;
 
 private:
-    uint32							mPacketCount;
-
-    PacketPool						mPacketPool;
-    boost::recursive_mutex			mPacketFactoryMutex;
+    swganh::BlockPool				mPacketPool;
 };
 
 //======================================================================================================================
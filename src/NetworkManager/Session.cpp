@@ -71,14 +71,8 @@ Session::Session(void) :
     mEncryptKey(0),
     mRequestId(0),
     mOutgoingPingSequence(1),
-    mFragmentedPacketTotalSize(0),
-    mFragmentedPacketCurrentSize(0),
-    mFragmentedPacketStartSequence(0),
-    mFragmentedPacketCurrentSequence(0),
-    mRoutedFragmentedPacketTotalSize(0),
-    mRoutedFragmentedPacketCurrentSize(0),
-    mRoutedFragmentedPacketStartSequence(0),
-    mRoutedFragmentedPacketCurrentSequence(0),
+    mFragments(MAX_FRAGMENTED_MESSAGE_SIZE),
+    mRoutedFragments(MAX_FRAGMENTED_MESSAGE_SIZE),
     mConnectStartEvent(0),
     mLastConnectRequestSent(0),
     mLastPacketSent(0),
@@ -90,16 +84,15 @@ Session::Session(void) :
     mClientPacketsReceived(0),
     mServerPacketsSent(0),
     mServerPacketsReceived(0),
-    mOutSequenceNext(0),
     mInSequenceNext(0),
-    mOutSequenceRollover(false),
-    mNextPacketSequenceSent(0),
     mLastRemotePacketAckReceived(0),
-    mWindowSizeCurrent(8000),
     mWindowResendSize(8000),
+    mCongestion(RELIABLE_WINDOW_MIN_SIZE, 8000, RELIABLE_WINDOW_INITIAL_SIZE),
     mSendDelayedAck(false),
     mInOutgoingQueue(false),
     mInIncomingQueue(false),
+    mWriteScheduled(false),
+    mWriteDeadline(0),
     mStatus(SSTAT_Initialize),
     mCommand(SCOM_None),
     avgTime(0),
@@ -193,50 +186,10 @@ Session::~Session(void)
         message->mSession = NULL;
     }
 
-    PacketWindowList::iterator it = mNewWindowPacketList.begin();
-
-    while(it != mNewWindowPacketList.end())
-    {
-        Packet* packet = (*it);
-        mPacketFactory->DestroyPacket(packet);
-        mNewWindowPacketList.erase(it++);
-    }
-
-    it = mNewRolloverWindowPacketList.begin();
-
-    while(it != mNewRolloverWindowPacketList.end())
-    {
-        Packet* packet = (*it);
-        mPacketFactory->DestroyPacket(packet);
-        mNewRolloverWindowPacketList.erase(it++);
-    }
-
-    it = mWindowPacketList.begin();
-
-    while(it != mWindowPacketList.end())
-    {
-        Packet* packet = (*it);
-        mPacketFactory->DestroyPacket(packet);
-        mWindowPacketList.erase(it++);
-    }
-
-    it = mRolloverWindowPacketList.begin();
-
-    while(it != mRolloverWindowPacketList.end())
-    {
-        Packet* packet = (*it);
-        mPacketFactory->DestroyPacket(packet);
-        mRolloverWindowPacketList.erase(it++);
-    }
-
-    it = mNewWindowPacketList.begin();
-
-    while(it != mNewWindowPacketList.end())
-    {
-        Packet* packet = (*it);
+    // our build packets, sent or not
+    mReliableWindow.Clear([this] (Packet* packet) {
         mPacketFactory->DestroyPacket(packet);
-        mNewWindowPacketList.erase(it++);
-    }
+    });
 
     Packet* packet;
     while(mOutgoingReliablePacketQueue.pop(packet))
@@ -249,6 +202,15 @@ Session::~Session(void)
         mPacketFactory->DestroyPacket(packet);
     }
 
+    // the fragments of messages that never completed
+    mFragments.Reset([this] (Packet* fragment) {
+        mPacketFactory->DestroyPacket(fragment);
+    });
+
+    mRoutedFragments.Reset([this] (Packet* fragment) {
+        mPacketFactory->DestroyPacket(fragment);
+    });
+
     //PacketQueue                 mOutgoingReliablePacketQueue;		//these are packets put on by the sessionwrite thread to send
     //PacketQueue                 mOutgoingUnreliablePacketQueue;   //build unreliables they will get send directly by the socket write thread  without storing for possible r esends
 
@@ -266,11 +228,12 @@ void Session::ProcessWriteThread(void)
     uint64 now = Anh_Utils::Clock::getSingleton()->getLocalTime();
 
     //only process when we are busy - we dont need to iterate through possible resends all the time
-    if((!mUnreliableMessageQueue.filled())&&(!mOutgoingMessageQueue.size()) && (!mNewWindowPacketList.size()))
+    //unless our housekeeping is due or packets wait for their acks
+    if((!mUnreliableMessageQueue.filled())&&(!mOutgoingMessageQueue.size()) && (!mReliableWindow.GetSize()))
     {
-        if(!mSendDelayedAck)
+        if(!mSendDelayedAck && mCommand == SCOM_None)
         {
-            if(now - mLastWriteThreadTime < 500)
+            if((now - mLastWriteThreadTime < 500) && (now - mLastHouseKeepingTimeTime < 1000))
             {
                 endCount++;
                 return;
@@ -307,7 +270,8 @@ void Session::ProcessWriteThread(void)
     uint32 pUnreliableBuild = 0;
 
     //build reliable packets dont use timeGetTime ... -its expensive
-    while((pBuild < 200) && mOutgoingMessageQueue.size())
+    //dont let the window run into half the sequence space the acks could no longer tell apart
+    while((pBuild < 200) && mOutgoingMessageQueue.size() && (mReliableWindow.GetSize() < RELIABLE_WINDOW_BUILD_LIMIT))
     {
         pBuild += _buildPackets();
     }
@@ -322,88 +286,17 @@ void Session::ProcessWriteThread(void)
         pUnreliableBuild += _buildPacketsUnreliable();
     }
 
-    // Now check to see if we can send any more reliable packets out the wire yet.  NOT optimized
-    PacketWindowList::iterator	iter;
-    PacketWindowList::iterator	iterRoll;
-
-    Packet*						windowPacket	= NULL;
-    uint32						packetsSent		= 0;
-
-    //Rollover happens when our sequence reaches 65535
-    //the old (< sequence = 0)packets go in the rolloverqueue and wait for being send and/or acknowledged and then deleted
-    if(mOutSequenceRollover)
-    {
-        boost::recursive_mutex::scoped_lock lk(mSessionMutex);
-		//mutex still for the mNewRolloverWindowPacketList
-
-        iterRoll = mRolloverWindowPacketList.begin();
-
-        //the list contains all packets those already send / resend and those not already send are in the back
-        //this means we always iterate through the oldest packets first until we get to the new packets
-        //up to the point that our packetwindowsize of packets is send
-
-        //it will make sense to use a separate list for already send packets as we do not want to iterate constantly through
-        //old but not yet acknowledged packets - this doesnt seem to be a problem though
-
-
-        iterRoll = mNewRolloverWindowPacketList.begin();
-
-        while(iterRoll != mNewRolloverWindowPacketList.end())
-        {
-
-            windowPacket = *iterRoll;
-            windowPacket->setReadIndex(2);
-            /*uint16 sequence = ntohs(*/windowPacket->getUint16(); 
-
-
-            // If we've sent our mWindowSizeCurrent of packets, break out and wait for some acks.
-            // make sure we send at least a minimum as we dont want any stalling
-            if (packetsSent >= mWindowSizeCurrent)
-                break;
-
-            _addOutgoingReliablePacket(windowPacket);
-			//dont call the mutex again were already in it
-			windowPacket->setTimeQueued(Anh_Utils::Clock::getSingleton()->getStoredTime());
-			
-            iterRoll = mNewRolloverWindowPacketList.erase(iterRoll);
-            mRolloverWindowPacketList.push_back(windowPacket);
-            packetsSent++;
-
-            mNextPacketSequenceSent++;
-        }
-    }
-
+    // Now send as many of our build packets as the congestion window allows
+    // the window holds them until they are acknowledged, a resend pushes the same packet again
     boost::recursive_mutex::scoped_lock lk(mSessionMutex);
-	
-	//WindowPacketList is our current window of send and not yet acknowledged packets
-    //A Rollover might still be in existance
-
-    iter = mNewWindowPacketList.begin();
-
-    //mNewWindoPacketList has the not yet send Packets
-    while(iter != mNewWindowPacketList.end())
-    {
-
-        windowPacket = *iter;
-        //windowPacket->setReadIndex(2);
-        //uint16 sequence = ntohs(windowPacket->getUint16());
 
-        // If we've sent our mWindowSizeCurrent of packets, break out and wait for some acks.
-        // make sure we send at least a minimum as we dont wont any stalling
-        if (packetsSent >= mWindowSizeCurrent)
-            break;
+    _resendData(now);
 
-		_addOutgoingReliablePacket(windowPacket);
-		//the sessionmutex is already called
-
-        //mWindoPacketList has the already send but not yet acknowledged Packets
-        mWindowPacketList.push_back(windowPacket);
-        packetsSent++;
-
-        ++mNextPacketSequenceSent;
-
-        mNewWindowPacketList.erase(iter++);
+    Packet* windowPacket = NULL;
 
+    while((mReliableWindow.GetOutstanding() < mCongestion.GetWindow()) && mReliableWindow.SendNext(now, windowPacket))
+    {
+        _addOutgoingReliablePacket(windowPacket);
     }
 
     lk.unlock();
@@ -467,13 +360,55 @@ void Session::ProcessWriteThread(void)
 	    
     }
 
-	//we might stall if the last packets get lost and the client wont generate ooo packets ( or those get lost)
-    if(!this->mServerService )    {
-        _resendData();
+}
+
+
+//======================================================================================================================
+
+uint64 Session::getNextWriteTime(uint64 now)
+{
+    // a pending disconnect, of a timed out session as well, goes out with the next pass
+    if(mCommand == SCOM_Disconnect || mSendDelayedAck || mUnreliableMessageQueue.filled() || mOutgoingReliablePacketQueue.filled() || mOutgoingUnreliablePacketQueue.filled())
+    {
+        return now;
+    }
+
+    boost::recursive_mutex::scoped_lock lk(mSessionMutex);
+
+    if(!mOutgoingMessageQueue.empty() && (mReliableWindow.GetSize() < RELIABLE_WINDOW_BUILD_LIMIT))
+    {
+        return now;
+    }
+
+    //the congestion window has room for packets we didnt send yet - otherwise the next ack schedules us
+    if(mReliableWindow.GetUnsent() && (mReliableWindow.GetOutstanding() < mCongestion.GetWindow()))
+    {
+        return now;
     }
 
+    uint64 nextWrite = mLastHouseKeepingTimeTime + 1000;
+
+    //the oldest packet in flight is due for a resend
+    uint64 oldestSent = mReliableWindow.GetOldestSendTime();
+
+    if(oldestSent)
+    {
+        uint64 timeout = mReliableWindow.HasSelectiveAcks() ? mCongestion.GetLossTimeout() : mCongestion.GetRetransmitTimeout();
+        nextWrite = std::min(nextWrite, oldestSent + timeout);
+    }
+
+    return nextWrite;
 }
 
+//======================================================================================================================
+
+void Session::_scheduleWrite(void)
+{
+    if(mSocketWriteThread)
+    {
+        mSocketWriteThread->ScheduleSession(this);
+    }
+}
 
 //======================================================================================================================
 void Session::SendChannelA(Message* message)
@@ -504,6 +439,8 @@ void Session::SendChannelA(Message* message)
 		boost::recursive_mutex::scoped_lock lk(mSessionMutex);
         mOutgoingMessageQueue.push(message);
     }
+
+    _scheduleWrite();
 }
 
 void Session::SendChannelAUnreliable(Message* message)
@@ -527,6 +464,8 @@ void Session::SendChannelAUnreliable(Message* message)
     else	{
         mUnreliableMessageQueue.push(message);
 	}
+
+    _scheduleWrite();
 }
 
 
@@ -583,6 +522,16 @@ void Session::SortSessionPacket(Packet* packet, uint16 type)
 }
 //======================================================================================================================
 void Session::HandleSessionPacket(Packet* packet)
+{
+    _handleSessionPacket(packet);
+
+    // acks, pongs and resends might have been queued, an ack might have freed up our window
+    _scheduleWrite();
+}
+
+//======================================================================================================================
+
+void Session::_handleSessionPacket(Packet* packet)
 {
     // Reset our packet read index and start parsing...
     packet->setReadIndex(0);
@@ -914,8 +863,14 @@ void Session::_processMultiPacket(Packet* packet)
         // Get the size of our next packet and increment our index
         packetSize = packet->getUint8();
 
+        if (packet->getReadIndex() + packetSize > packet->getSize())
+        {
+            LOG(info) << "Session::_processMultiPacket packet of " << packetSize << " bytes past the end of the multi-packet";
+            mPacketFactory->DestroyPacket(newPacket);
+            break;
+        }
+
         // insert the data.
-        newPacket->Reset();
         newPacket->addData(&(packet->getData()[packet->getReadIndex()]), packetSize);
         packet->setReadIndex(packet->getReadIndex() + packetSize);
         // Process the new packet.
@@ -1152,169 +1107,30 @@ void Session::_processDataChannelB(Packet* packet)
 //======================================================================================================================
 void Session::_processDataChannelAck(Packet* packet)
 {
-    Packet* windowPacket = 0;
-    uint16 windowPacketSequence = 0;
-    PacketWindowList::iterator iter;
-    PacketWindowList::iterator itN;
-
     // Get the sequence off our incoming packet
     packet->setReadIndex(2);  //skip the header
     uint16 sequence = ntohs(packet->getUint16());
 
-    boost::recursive_mutex::scoped_lock lk(mSessionMutex);
-    uint32 pDel = 0;
-
-    // If our windowQueue is empty, this is a dupe ack for the last packet that was on it.  Just return.
-    if(mOutSequenceRollover)
-    {
-        if((!mRolloverWindowPacketList.size()) && (!mNewRolloverWindowPacketList.size()))
-        {
-            mOutSequenceRollover = false;
-        }
-        // this is an ack for the new queue	 so the old queue can go completely
-        else if((sequence < (0xFFFF - (mRolloverWindowPacketList.size()+mNewRolloverWindowPacketList.size()))))
-        {
-
-			DLOG(info) << "Data Channel Ack Rollover complete. Windowsize " << mWindowSizeCurrent <<  " ack seq new queue " << sequence;
-            mLastRemotePacketAckReceived = Anh_Utils::Clock::getSingleton()->getLocalTime();
-
-            mOutSequenceRollover = false;
-            iter = mRolloverWindowPacketList.begin();
-
-            //now that communication is reestablished we can resize our window again
-            if(mWindowSizeCurrent < mWindowResendSize)
-            {
-                mWindowSizeCurrent += uint32(mWindowResendSize/10);
-                if(mWindowSizeCurrent >mWindowResendSize)
-                    mWindowSizeCurrent = mWindowResendSize;
-            }
-            //destroy them now they are acknowleged
-            //they dont have to be resend
-            while(iter != mRolloverWindowPacketList.end())
-            {
-                pDel ++;
-                mPacketFactory->DestroyPacket(*iter);
-                mRolloverWindowPacketList.erase(iter);
-                iter = mRolloverWindowPacketList.begin();
-
-
-            }
-        }
-        else//else if(sequence < 0xFFFF - mRolloverWindowPacketList.size()) thats an ack purely for the old list
-        {
-            //only parts of the old queue can go
-            iter = mRolloverWindowPacketList.begin();
-            windowPacket = *iter;
-            windowPacket->setReadIndex(2);
-            windowPacketSequence = ntohs(windowPacket->getUint16());
-
-            if(sequence < windowPacketSequence)
-            {
-            }
-            else
-            {
-
-                // This is a proper ack, so handle it.
-                if(mWindowSizeCurrent < mWindowResendSize)
-                {
-                    // I dont go with a set window of packets in our queues here as I think
-                    // that the servers (especially the zones) need to keep on sending
-                    // especially when loads of players log on to one zone in this situation we get easily a few thousand to tenthsnd messages
-                    // in a short time
-                    mWindowSizeCurrent += uint32(mWindowResendSize/10);
-                    if(mWindowSizeCurrent >mWindowResendSize)
-                        mWindowSizeCurrent = mWindowResendSize;
-                }
-                while(sequence >= windowPacketSequence)
-                {
-                    pDel ++;
-                    mPacketFactory->DestroyPacket(*iter);
-                    mRolloverWindowPacketList.erase(iter);
-
-                    // If the list is empty, break out
-                    if(mRolloverWindowPacketList.size() == 0)
-                    {
-                        DLOG(info) << "Data Channel Ack Rollover complete. Windowsize " << mWindowSizeCurrent <<  " ack seq new queue " << sequence;
-                        windowPacket = 0;
-                        windowPacketSequence = 0;
-
-                        if(mNewRolloverWindowPacketList.size() == 0)
-                            mOutSequenceRollover = false;
-
-                        break;
-                    }
-
-                    iter = mRolloverWindowPacketList.begin();
-                    windowPacket = *iter;
-                    windowPacket->setReadIndex(2);
-                    windowPacketSequence = ntohs(windowPacket->getUint16());
-                }//while(sequence >= windowPacketSequence)
-
-                mLastRemotePacketAckReceived = Anh_Utils::Clock::getSingleton()->getStoredTime();
-
-                // Our current window increases here, as we know come communication is back.
-
-            }//if(sequence < windowPacketSequence)
-
-            mPacketFactory->DestroyPacket(packet);
-            DLOG(info) << "Data Channel Ack Rollover complete. Windowsize " << mWindowSizeCurrent <<  " ack seq new queue " << sequence;
-
-            return;
-        }//else if(sequence < 0xFFFF - mRolloverWindowPacketList.size())
-    }	   //if the rollover was gone completely we continue with the regular list
+    uint64 now = Anh_Utils::Clock::getSingleton()->getLocalTime();
+    uint64 rtt = 0;
 
-    if (mWindowPacketList.size() == 0)
-    {
-        //gLogger->log(LogManager::DEBUG,"Dupe ACK received - Nothing in resend window - seq: %u, Session:0x%x%.4x", sequence, mService->getId(), getId());
-        mPacketFactory->DestroyPacket(packet);
-        return;
-    }
+    boost::recursive_mutex::scoped_lock lk(mSessionMutex);
 
-    iter = mWindowPacketList.begin();
-    windowPacket = *iter;
-    windowPacket->setReadIndex(2); //skip the header
-    windowPacketSequence = ntohs(windowPacket->getUint16());
+    // the ack covers all packets up to its sequence - dupe acks and acks out of bounds release nothing
+    uint32 released = mReliableWindow.Acknowledge(sequence, now, [this] (Packet* windowPacket) {
+        mPacketFactory->DestroyPacket(windowPacket);
+    }, rtt);
 
-    if (sequence < windowPacketSequence)
-    {
-        // Dpulicate ack, drop it.
-        //gLogger->log(LogManager::DEBUG, "Dupe ACK received - No such packet in window - ackSeq: %u, expect: %u, Session:0x%x%.4x", sequence, windowPacketSequence, mService->getId(), getId());
-    }
-    else if (sequence > windowPacketSequence + mWindowPacketList.size())
+    if (released)
     {
-        // This ack is way out of bounds, log a message and drop it.
-        //gLogger->log(LogManager::DEBUG, "DataChannelAck:  Ack out of bounds - ackSeq: %u, expect: %u, Session:0x%x%.4x", sequence, windowPacketSequence, mService->getId(), getId());
-    }
-    else
-    {
-        // This is a proper ack, so handle it.
-        if(mWindowSizeCurrent < mWindowResendSize)
-        {
-            mWindowSizeCurrent += uint32(mWindowResendSize/10);
-            if(mWindowSizeCurrent >mWindowResendSize)
-                mWindowSizeCurrent = mWindowResendSize;
-        }
-
-        while (sequence >= windowPacketSequence)
-        {
-            pDel ++;
-            mPacketFactory->DestroyPacket(*iter);
-            mWindowPacketList.erase(iter);
-
-            // If the window is empty, break out
-            if (mWindowPacketList.size() == 0)
-                break;
-
-            iter = mWindowPacketList.begin();
-            windowPacket = *iter;
-            windowPacket->setReadIndex(2); //skip the header
-            windowPacketSequence = ntohs(windowPacket->getUint16());
-        }
+        // the window grows with the acks as long as the roundtrips dont point at a queue building up
+        mCongestion.OnAck(released, rtt);
 
         mLastRemotePacketAckReceived = Anh_Utils::Clock::getSingleton()->getStoredTime();
-
     }
 
+    lk.unlock();
+
     // Destroy our incoming packet, it's not needed any longer.
     mPacketFactory->DestroyPacket(packet);
 }
@@ -1323,127 +1139,54 @@ void Session::_processDataChannelAck(Packet* packet)
 //======================================================================================================================
 void Session::_processDataOrderPacket(Packet* packet)
 {
-
-    boost::recursive_mutex::scoped_lock lk(mSessionMutex); // mRolloverWindowPacketList and WindowPacketList get accessed by the socketwritethread and by the socketreadthread both through the session
-
     packet->setReadIndex(2);
     uint16 sequence = ntohs(packet->getUint16());
-	//
-    PacketWindowList::iterator	iter			= mWindowPacketList.begin();
-    PacketWindowList::iterator	iterRoll = mRolloverWindowPacketList.begin();
 
-    // If the window packet list is empty just bail out now.
-    if (iter == mWindowPacketList.end()) {
-		mPacketFactory->DestroyPacket(packet);
-        return;
-    }
-
-    Packet*						windowPacket	= *iter;
-
-
-    windowPacket->setReadIndex(2);
-    uint16 windowSequence = ntohs(windowPacket->getUint16());
-
-
-    LOG(warning) << "Out-Of-order packet session 0x"<< mService->getId() << mId <<" OOOPacket had  sequence: " << sequence <<" windowsequ : " << windowSequence;
-	LOG(warning) << "";
-
-    //Do some bounds checking
-    if (sequence < windowSequence)
-    {
-        LOG(warning) << "Out-Of-Order packet sequence too small, may be a duplicate or we handled our acks wrong.  seq: " << sequence << ", expect >: " << windowSequence;
-		mPacketFactory->DestroyPacket(packet);
-        return;
-    }
+    uint64 now = Anh_Utils::Clock::getSingleton()->getLocalTime();
+    uint32 lost = 0;
 
-    if (sequence > windowSequence + mWindowPacketList.size())    {
-        LOG(warning) << "Rollover Out-Of-Order packet  seq: " << sequence << ", expect >: " << windowSequence;
-		mPacketFactory->DestroyPacket(packet);
-        return;
-    }
+    boost::recursive_mutex::scoped_lock lk(mSessionMutex); // the window gets accessed by the socketwritethread and by the socketreadthread both through the session
 
-	//in situations of a lot of packet loss we lower the size of our send window to minimize packet loss
-	if (mWindowSizeCurrent > (mWindowResendSize/10))
-		mWindowSizeCurrent = 0;
+    auto resend = [this] (Packet* windowPacket) {
+        _addOutgoingReliablePacket(windowPacket);
+    };
 
-    //The location of the packetsequence out of order has NOBEARING on the question on which list we will find the last properly received Packet!!!
-    if(mRolloverWindowPacketList.size()&& (sequence > (65535-mRolloverWindowPacketList.size())))
+    if (mServerService)
     {
-		LOG(warning) << "_processDataOrderPacket its the rollover list";
-        //jupp its on the rolloverlist
+        // our own servers report the last packet they received in order, everything after it that had
+        // the time to arrive is missing
+        uint64 rtt = 0;
+        uint32 released = mReliableWindow.Acknowledge(sequence, now, [this] (Packet* windowPacket) {
+            mPacketFactory->DestroyPacket(windowPacket);
+        }, rtt);
 
-        for (iterRoll = mRolloverWindowPacketList.begin(); iterRoll != mRolloverWindowPacketList.end(); iterRoll++)
+        if (released)
         {
-            // Grab our window packet
-            windowPacket = (*iterRoll);
-            windowPacket->setReadIndex(2);
-            uint16 windowRollSequence = ntohs(windowPacket->getUint16());
-
-            // If it's smaller than the order packet send it, otherwise break;
-            if (windowRollSequence < sequence )
-            {
-
-                if(Anh_Utils::Clock::getSingleton()->getLocalTime() - windowPacket->getTimeOOHSent() < 200)
-                    break;
-
-                _addOutgoingReliablePacket(windowPacket);
-
-                windowPacket->setTimeOOHSent(Anh_Utils::Clock::getSingleton()->getLocalTime());
-
-                if (mWindowSizeCurrent > (mWindowResendSize/10))
-                    mWindowSizeCurrent--;
-
-            }
+            mCongestion.OnAck(released, rtt);
         }
-    }
-
-
-
-
-    uint64 localTime = Anh_Utils::Clock::getSingleton()->getLocalTime();
-
-	LOG(warning) << "_processDataOrderPacket :: resend start sequence  : " << windowSequence;
-	LOG(warning) << "_processDataOrderPacket :: time  : now : " << localTime << " old :" << windowPacket->getTimeOOHSent();
-
-    uint16 seq;
 
-	for (iter = mWindowPacketList.begin(); iter != mWindowPacketList.end(); iter++)
+        lost = mReliableWindow.Resend(now, mCongestion.GetLossTimeout(), mCongestion.GetWindow(), resend);
+    }
+    else
     {
-        // Grab our window packet
-        windowPacket = (*iter);
-        windowPacket->setReadIndex(2);
-		seq = ntohs(windowPacket->getUint16());
-
-        // always send ALL packets on the list
-		uint64 old =  windowPacket->getTimeOOHSent();
-        //make sure we do not spam the connection needlessly with packets
-        if(localTime - windowPacket->getTimeOOHSent() > 1000)        {
-			
-			LOG(warning) << "_processDataOrderPacket :: added : " << seq;
-			LOG(warning) << "_processDataOrderPacket :: time  : now : " << localTime << " old :" << old;
-            //_addOutgoingReliablePacket(windowPacket);
-			_addOutgoingUnreliablePacket(windowPacket);
-
-            windowPacket->setTimeOOHSent(localTime);
-
-        }
-        else
+        // the client reports the packet it received ahead of a gap - it doesnt need that one anymore,
+        // the ones in the gap get resent once they had the time to arrive
+        if (!mReliableWindow.AcknowledgeSelective(sequence))
         {
-			LOG(warning) << "_processDataOrderPacket :: time spam guard : now : " << localTime << " old :" << old;
-            mPacketFactory->DestroyPacket(packet);
-            return;
+            DLOG(info) << "Out-Of-Order packet not in flight, may be a duplicate or we handled our acks wrong. seq: " << sequence << ", window: " << mReliableWindow.GetFirstSequence();
         }
-    }
 
-	windowPacket->setReadIndex(2);
-    seq = windowPacket->getUint16(); 
+        lost = mReliableWindow.ResendLost(now, mCongestion.GetLossTimeout(), mCongestion.GetWindow(), resend);
+    }
 
-	localTime = Anh_Utils::Clock::getSingleton()->getLocalTime();
-	uint64 packet_time =  windowPacket->getTimeOOHSent();
+    if (lost)
+    {
+        mCongestion.OnLoss(lost, now);
 
-	LOG(warning) << "_processDataOrderPacket :: resend stop sequence  : " << seq;
-	LOG(warning) << "_processDataOrderPacket :: time  : now : " << localTime << " old :" << packet_time;
+        DLOG(info) << "Out-Of-Order packet session 0x" << mService->getId() << mId << " seq: " << sequence << " resent: " << lost << " window: " << mCongestion.GetWindow();
+    }
 
+    lk.unlock();
 
     // Destroy our incoming packet, it's not needed any longer.
     mPacketFactory->DestroyPacket(packet);
@@ -1452,81 +1195,34 @@ void Session::_processDataOrderPacket(Packet* packet)
 //======================================================================================================================
 //
 // resend packets in case we stall due to packetloss
-// the waittime is set to 700ms which might seem long, but we do not want to flood the line with unnecessarily (double)send
-// packets
+// packets behind one the remote side reported out of order go once they had the time to arrive, everything
+// else once the retransmission timeout measured from the roundtrips passed without an ack
 //
 
-void Session::_resendData()
+void Session::_resendData(uint64 now)
 {
+    boost::recursive_mutex::scoped_lock lk(mSessionMutex); // the window gets accessed by the socketwritethread and by the socketreadthread both through the session
 
-    boost::recursive_mutex::scoped_lock lk(mSessionMutex); // mRolloverWindowPacketList and WindowPacketList get accessed by the socketwritethread and by the socketreadthread both through the session
-
-    PacketWindowList::iterator	iter			= mWindowPacketList.begin();
-    PacketWindowList::iterator	iterRoll = mRolloverWindowPacketList.begin();
+    auto resend = [this] (Packet* windowPacket) {
+        _addOutgoingReliablePacket(windowPacket);
+    };
 
-    Packet*		windowPacket;
-
-    // If the window packet list is empty just bail out now.
-    if (mWindowPacketList.size() == 0)    {
-        return;
-    }
+    uint32 lost = mReliableWindow.ResendLost(now, mCongestion.GetLossTimeout(), mCongestion.GetWindow(), resend);
 
-    uint64 localTime = Anh_Utils::Clock::getSingleton()->getLocalTime();
-    uint64 waitTime = 0;
-    uint64 oooTime = 0;
-    uint32 packetsSend = 0;
-
-    for (iterRoll = mRolloverWindowPacketList.begin(); iterRoll != mRolloverWindowPacketList.end(); iterRoll++)
+    if (lost)
     {
-        // Grab our window packet
-        windowPacket = (*iterRoll);
-
-        // If it's smaller than the order packet send it, otherwise break;
-        if(windowPacket->getTimeSent() == 0)
-            return;
-
-        waitTime = localTime - windowPacket->getTimeSent();
-        oooTime = localTime - windowPacket->getTimeOOHSent();
-
-        if((waitTime> 700)&&(oooTime > 700))
-        {
-            windowPacket->setTimeOOHSent(localTime);
-            _addOutgoingReliablePacket(windowPacket);
-            packetsSend++;
-        }
-        else
-        {
-            return;
-        }
+        mCongestion.OnLoss(lost, now);
     }
 
-    localTime = Anh_Utils::Clock::getSingleton()->getLocalTime();
-    for (iter = mWindowPacketList.begin(); iter != mWindowPacketList.end(); iter++)
-    {
-
-        // Grab our window packet
-        windowPacket = (*iter);
+    //we might stall if the last packets get lost and the remote side wont generate ooo packets ( or those get lost)
+    uint32 timedOut = mReliableWindow.Resend(now, mCongestion.GetRetransmitTimeout(), mCongestion.GetWindow(), resend);
 
-        if(windowPacket->getTimeSent() == 0)
-            return;
+    if (timedOut)
+    {
+        mCongestion.OnTimeout(now);
 
-        waitTime = localTime - windowPacket->getTimeSent();
-        oooTime = localTime - windowPacket->getTimeOOHSent();
-        if((waitTime> 700)&&(oooTime > 700))
-            //if(waitTime> 700)
-        {
-            windowPacket->setTimeOOHSent(localTime);
-            _addOutgoingReliablePacket(windowPacket);
-            packetsSend++;
-        }
-        else
-        {
-            //gLogger->log(LogManager::WARNING, "_resendData WaitTime : %I64u; Packets send %u", waitTime, packetsSend);
-            return;
-        }
+        DLOG(info) << "Session::_resendData session 0x" << mService->getId() << mId << " resent: " << timedOut << " timeout now: " << mCongestion.GetRetransmitTimeout();
     }
-
-    //gLogger->log(LogManager::WARNING, "_resendData WaitTime : %I64u; Packets send %u", waitTime, packetsSend);
 }
 
 
@@ -1535,14 +1231,6 @@ void Session::_processFragmentedPacket(Packet* packet)
 {
     packet->setReadIndex(2); //skip the header
     uint16 sequence = ntohs(packet->getUint16());
-    uint8 priority = 0;
-    uint8 routed = 0;
-    uint8 dest = 0;
-    uint32 accountId = 0;
-
-    //if (mService->getId() == 1)
-    {
-    }
 
     // check our sequence number.
     if (sequence < mInSequenceNext)
@@ -1568,112 +1256,9 @@ void Session::_processFragmentedPacket(Packet* packet)
     // Need to send out acks
     mSendDelayedAck = true;
 
-    // If we are not already processing a multi-packet message, start to.
-    if (mFragmentedPacketTotalSize == 0)
-    {
-        mFragmentedPacketTotalSize = ntohl(packet->getUint32());
-
-        mFragmentedPacketCurrentSize = packet->getSize() - 8;  // -2 header, -2 sequence, -4 size - crc compflag have already been removed
-        mFragmentedPacketCurrentSequence = mFragmentedPacketStartSequence = sequence;
-
-        packet->setReadIndex(8);	//2opcode, 2 sequence and 4 size
-        priority = packet->getUint8();
-
-        if (priority > 0x10)
-        {
-            // the packet has had a proper sequence .. otherwise we wouldnt be here ...
-           LOG(warning) << "Start incoming fragged packets - total: " << mFragmentedPacketTotalSize << " seq: " << sequence;
-
-        }
-
-        // Now push the packet into our fragmented queue
-        mIncomingFragmentedPacketQueue.push(packet);
-    }
-    // This is the next packet in the multi-packet sequence.
-    else
+    if (_addFragment(mFragments, packet))
     {
-        mFragmentedPacketCurrentSize += packet->getSize() - 4;  // -2 header, -2 sequence
-        mFragmentedPacketCurrentSequence = sequence;
-
-        //if (mService->getId() == 1)
-        {
-        }
-
-        // If this is our last packet, send them all up to the application
-        if (mFragmentedPacketCurrentSize >= mFragmentedPacketTotalSize)
-        {
-            mIncomingFragmentedPacketQueue.push(packet);
-            Packet* fragment = 0;
-
-            // Build the message from the fragmented packet here and send it up
-            mMessageFactory->StartMessage();
-            uint32 fragmentCount = mIncomingFragmentedPacketQueue.size();
-            for (uint32 i = 0; i < fragmentCount; i++)
-            {
-                fragment = mIncomingFragmentedPacketQueue.front();
-                mIncomingFragmentedPacketQueue.pop();
-
-                // if this is the first packet, make sure to skip the size.
-                if (i == 0)
-                {
-                    fragment->setReadIndex(8);	//2opcode, 2 sequence and 4 size
-                    priority = fragment->getUint8();
-                    routed = fragment->getUint8();
-
-                    if (routed)
-                    {
-                        dest = fragment->getUint8();
-                        accountId = fragment->getUint32();
-                        mMessageFactory->addData(fragment->getData() + 15, fragment->getSize() - 15); // -2 header, -2 sequence, -4 size, -2 priority/routing, -5 routing header
-                    }
-                    else
-                    {
-                        mMessageFactory->addData(fragment->getData() + 10, fragment->getSize() - 10); // -2 header, -2 sequence, -4 size, -2 priority/routing
-                    }
-                }
-                // This is just additional data
-                else
-                {
-                    mMessageFactory->addData(fragment->getData() + 4, fragment->getSize() - 4); // -2 header, -2 sequence
-                }
-
-                // delete our fragment
-                mPacketFactory->DestroyPacket(fragment);
-            }
-            Message* newMessage = mMessageFactory->EndMessage();
-
-            // Set our message variables.
-            if (routed)
-                newMessage->setRouted(true);
-            else
-                newMessage->setRouted(false);
-
-            newMessage->setPriority(priority);
-            newMessage->setDestinationId(dest);
-            newMessage->setAccountId(accountId);
-
-            if (priority > 0x10)
-            {
-                LOG(info) << "Fragmented Packet priority messup!!!";
-                return;
-            }
-
-
-            // Push the message on our incoming queue
-            _addIncomingMessage(newMessage, priority);
-
-            // Clear our size counters
-            mFragmentedPacketTotalSize = 0;
-            mFragmentedPacketCurrentSize = 0;
-            mFragmentedPacketCurrentSequence = 0;
-            mFragmentedPacketStartSequence = 0;
-        }
-        // This is just the next packet in sequence.  Throw it on the queue
-        else
-        {
-            mIncomingFragmentedPacketQueue.push(packet);
-        }
-
+        _processAssembledMessage(mFragments, false);
     }
 }
 
@@ -1682,108 +1267,105 @@ void Session::_processRoutedFragmentedPacket(Packet* packet)
 {
     packet->setReadIndex(2); //skip the header
 
-    uint16 sequence = ntohs(packet->getUint16());
-
-    uint8 priority = 0;
-    uint8 dest = 0;
-    uint32 accountId = 0;
-
-
     // Inc our in seq
     mInSequenceNext++;
 
     // Need to send out acks
     mSendDelayedAck = true;
 
-    // If we are not already processing a multi-packet message, start to.
-    if (mRoutedFragmentedPacketTotalSize == 0)
+    if (_addFragment(mRoutedFragments, packet))
     {
-        mRoutedFragmentedPacketTotalSize = ntohl(packet->getUint32());
+        _processAssembledMessage(mRoutedFragments, true);
+    }
+}
 
-        mRoutedFragmentedPacketCurrentSize = packet->getSize() - 8;  // -2 header, -2 sequence, -4 size -
-        mRoutedFragmentedPacketCurrentSequence = mRoutedFragmentedPacketStartSequence = sequence;
+//======================================================================================================================
+//
+// the fragments stay in their packets until the message is complete, only then the payload is gathered
+// into the message in a single copy
+//
 
-        // Now push the packet into our fragmented queue
-        mIncomingRoutedFragmentedPacketQueue.push(packet);
-    }
-    // This is the next packet in the multi-packet sequence.
-    else
+bool Session::_addFragment(PacketAssembler& fragments, Packet* packet)
+{
+    // the rest of a message dropped for its size, it mustn't be taken for the start of the next one
+    if (fragments.IsDiscarding())
     {
-        mRoutedFragmentedPacketCurrentSize += packet->getSize() - 4;  // -2 header, -2 sequence
+        // -2 header, -2 sequence
+        fragments.Discard(std::max<uint32>(packet->getSize(), 4) - 4);
+        mPacketFactory->DestroyPacket(packet);
+        return false;
+    }
 
-        mRoutedFragmentedPacketCurrentSequence = sequence;
+    // If we are not already processing a multi-packet message, start to.
+    if (!fragments.IsStarted())
+    {
+        packet->setReadIndex(4);	//2opcode, 2 sequence
+        uint32 totalSize = ntohl(packet->getUint32());
 
-        // If this is our last packet, send them all up to the application
-        if (mRoutedFragmentedPacketCurrentSize == mRoutedFragmentedPacketTotalSize)
+        // -2 header, -2 sequence, -4 size - crc compflag have already been removed
+        if (packet->getSize() < 8 || !fragments.Start(totalSize, packet, reinterpret_cast<const char*>(packet->getData()) + 8, packet->getSize() - 8))
         {
-            mIncomingRoutedFragmentedPacketQueue.push(packet);
-            Packet* fragment = 0;
+            LOG(warning) << "Session::_addFragment dropped fragmented message of " << totalSize << " bytes on session 0x" << mService->getId() << mId;
+            mPacketFactory->DestroyPacket(packet);
+            return false;
+        }
 
-            // Build the message from the fragmented packet here and send it up
-            mMessageFactory->StartMessage();
+        return fragments.IsComplete();
+    }
 
-            uint32 fragmentCount = mIncomingRoutedFragmentedPacketQueue.size();
+    // This is the next packet in the multi-packet sequence.
+    // -2 header, -2 sequence
+    return fragments.Add(packet, reinterpret_cast<const char*>(packet->getData()) + 4, packet->getSize() - 4);
+}
 
-            for (uint32 i = 0; i < fragmentCount; i++)
-            {
-                fragment = mIncomingRoutedFragmentedPacketQueue.front();
-                mIncomingRoutedFragmentedPacketQueue.pop();
-
-                // if this is the first packet, make sure to skip the size.
-                if (i == 0)
-                {
-                    fragment->setReadIndex(8);	//2opcode, 2 sequence and 4 size
-
-                    priority = fragment->getUint8();
-                    fragment->getUint8(); // routed
-                    dest = fragment->getUint8();
-                    accountId = fragment->getUint32();
-
-                    mMessageFactory->addData(fragment->getData() + 15, fragment->getSize() - 15); // -2 header, -2 sequence, -4 size, -2 priority/routing, -5 routing header
-
-                }
-                // This is just additional data
-                else
-                {
-                    mMessageFactory->addData(fragment->getData() + 4, fragment->getSize() - 4); // -2 header, -2 sequence
-                }
-
-                // delete our fragment
-                mPacketFactory->DestroyPacket(fragment);
-            }
-            Message* newMessage = mMessageFactory->EndMessage();
+//======================================================================================================================
 
-            // Set our message variables.
+void Session::_processAssembledMessage(PacketAssembler& fragments, bool routed)
+{
+    uint8 priority = 0;
+    uint8 dest = 0;
+    uint32 accountId = 0;
 
-            newMessage->setRouted(true);
-            newMessage->setPriority(priority);
+    // priority and routing, a routed message carries a 5 byte routing header after that
+    uint8 header[7] = {0};
+    fragments.CopyTo(reinterpret_cast<char*>(header), 0, sizeof(header));
 
-            if (priority > 0x10)
-            {
+    priority = header[0];
+    routed = routed || header[1];
 
-                LOG(info) << "Fragmented Packet priority messup!!!";
-                return;
-            }
+    uint32 headerSize = routed ? 7 : 2;
 
-            newMessage->setDestinationId(dest);
-            newMessage->setAccountId(accountId);
+    if (routed)
+    {
+        dest = header[2];
+        memcpy(&accountId, header + 3, sizeof(accountId));
+    }
 
-            // Push the message on our incoming queue
-            _addIncomingMessage(newMessage, priority);
+    uint32 size = std::max(fragments.GetTotalSize(), headerSize) - headerSize;
 
-            // Clear our size counters
-            mRoutedFragmentedPacketTotalSize = 0;
-            mRoutedFragmentedPacketCurrentSize = 0;
-            mRoutedFragmentedPacketCurrentSequence = 0;
-            mRoutedFragmentedPacketStartSequence = 0;
-        }
-        // This is just the next packet in sequence.  Throw it on the queue
-        else
-        {
-            mIncomingRoutedFragmentedPacketQueue.push(packet);
-        }
+    if (priority > 0x10 || size > 0xffff)
+    {
+        LOG(info) << "Fragmented Packet priority messup!!!";
 
+        fragments.Reset([this] (Packet* fragment) { mPacketFactory->DestroyPacket(fragment); });
+        return;
     }
+
+    // Build the message from the fragments here and send it up
+    mMessageFactory->StartMessage();
+    fragments.CopyTo(reinterpret_cast<char*>(mMessageFactory->allocateData(static_cast<uint16>(size))), headerSize, size);
+    Message* newMessage = mMessageFactory->EndMessage();
+
+    fragments.Reset([this] (Packet* fragment) { mPacketFactory->DestroyPacket(fragment); });
+
+    // Set our message variables.
+    newMessage->setRouted(routed);
+    newMessage->setPriority(priority);
+    newMessage->setDestinationId(dest);
+    newMessage->setAccountId(accountId);
+
+    // Push the message on our incoming queue
+    _addIncomingMessage(newMessage, priority);
 }
 
 //======================================================================================================================
@@ -2029,7 +1611,7 @@ void Session::_buildOutgoingReliableRoutedPackets(Message* message)
 
         newPacket->addUint16(SESSIONOP_DataFrag2);
 
-        newPacket->addUint16(htons(mOutSequenceNext));
+        newPacket->addUint16(htons(mReliableWindow.GetNextSequence()));
 
         newPacket->addUint32(htonl(messageSize + 7));
 
@@ -2038,7 +1620,7 @@ void Session::_buildOutgoingReliableRoutedPackets(Message* message)
         newPacket->addUint8(1);                               // There is a routing header next
         newPacket->addUint8(message->getDestinationId());
         newPacket->addUint32(message->getAccountId());
-        newPacket->addData(message->getData(), mMaxPacketSize- envelopeSize); // -2 header, -2 sequence, -4 size, -2 priority/routing, -5 routing, -2 crc
+        _addMessageData(newPacket, message, 0, mMaxPacketSize- envelopeSize); // -2 header, -2 sequence, -4 size, -2 priority/routing, -5 routing, -2 crc
         messageIndex += mMaxPacketSize - envelopeSize;                         // -2 header, -2 sequence, -4 size, -2 priority/routing, -5 routing, -2 crc
 
 
@@ -2047,15 +1629,8 @@ void Session::_buildOutgoingReliableRoutedPackets(Message* message)
         newPacket->setIsCompressed(false);
         newPacket->setIsEncrypted(true);
 
-        // Push the packet on our outgoing queue
-        boost::recursive_mutex::scoped_lock lk(mSessionMutex);
-
-        mNewWindowPacketList.push_back(newPacket);
-
-        if(!++mOutSequenceNext)
-            _handleOutSequenceRollover();
-
-        lk.unlock();
+        // Push the packet on our send window
+        _addWindowPacket(newPacket);
 
         // Now build any remaining packets.
         while (messageSize > messageIndex)
@@ -2065,8 +1640,8 @@ void Session::_buildOutgoingReliableRoutedPackets(Message* message)
             // Build our remaining packets
             newPacket->addUint16(SESSIONOP_DataFrag2);
 
-            newPacket->addUint16(htons(mOutSequenceNext));
-            newPacket->addData(message->getData() + messageIndex, std::min<uint16>(mMaxPacketSize - 7, messageSize - messageIndex));
+            newPacket->addUint16(htons(mReliableWindow.GetNextSequence()));
+            _addMessageData(newPacket, message, messageIndex, std::min<uint16>(mMaxPacketSize - 7, messageSize - messageIndex));
 
             //no new routing header necessary here
             messageIndex += mMaxPacketSize - 7;  // -2 header, -2 sequence, -3 comp/crc
@@ -2077,13 +1652,8 @@ void Session::_buildOutgoingReliableRoutedPackets(Message* message)
 
             newPacket->setIsEncrypted(true);
 
-            // Push the packet on our outgoing queue
-            boost::recursive_mutex::scoped_lock lk(mSessionMutex);
-
-            mNewWindowPacketList.push_back(newPacket);
-
-            if(!++mOutSequenceNext)
-                _handleOutSequenceRollover();
+            // Push the packet on our send window
+            _addWindowPacket(newPacket);
         }
     }
     else
@@ -2093,25 +1663,19 @@ void Session::_buildOutgoingReliableRoutedPackets(Message* message)
         newPacket = mPacketFactory->CreatePacket();
 
         newPacket->addUint16(SESSIONOP_DataChannel2);
-        //newPacket->setSequence(mOutSequenceNext);
-        newPacket->addUint16(htons(mOutSequenceNext));
+        newPacket->addUint16(htons(mReliableWindow.GetNextSequence()));
         newPacket->addUint8(message->getPriority());
 
         newPacket->addUint8(message->getRouted());
         newPacket->addUint8(message->getDestinationId());
         newPacket->addUint32(message->getAccountId());
-        newPacket->addData(message->getData(), message->getSize());  // -2 header, -2 sequence, -2 priority/routing, -5 routing, -3 comp/crc
+        _addMessageData(newPacket, message, 0, message->getSize());  // -2 header, -2 sequence, -2 priority/routing, -5 routing, -3 comp/crc
         newPacket->setIsCompressed(false);
 
         newPacket->setIsEncrypted(true);
 
-        // Push the packet on our outgoing queue
-        boost::recursive_mutex::scoped_lock lk(mSessionMutex);
-
-        mNewWindowPacketList.push_back(newPacket);
-
-        if(!++mOutSequenceNext)
-            _handleOutSequenceRollover();
+        // Push the packet on our send window
+        _addWindowPacket(newPacket);
     }
     message->setPendingDelete(true);
 }
@@ -2137,7 +1701,7 @@ void Session::_buildOutgoingReliablePackets(Message* message)
 
         newPacket->addUint16(SESSIONOP_DataFrag1);
 
-        newPacket->addUint16(htons(mOutSequenceNext));
+        newPacket->addUint16(htons(mReliableWindow.GetNextSequence()));
 
         newPacket->addUint32(htonl(messageSize + 2));
 
@@ -2146,7 +1710,7 @@ void Session::_buildOutgoingReliablePackets(Message* message)
         newPacket->addUint8(0);                     // This byte is always 0 on the client
 
 
-        newPacket->addData(message->getData(), mMaxPacketSize - envelopeSize); // -2 header, -2 sequence, -4 size, -2 priority/routing, -2 crc
+        _addMessageData(newPacket, message, 0, mMaxPacketSize - envelopeSize); // -2 header, -2 sequence, -4 size, -2 priority/routing, -2 crc
         messageIndex += mMaxPacketSize - envelopeSize;                         // -2 header, -2 sequence, -4 size, -2 priority/routing, -2 crc
 
         // Data channels need compression and encryption
@@ -2154,13 +1718,8 @@ void Session::_buildOutgoingReliablePackets(Message* message)
         newPacket->setIsCompressed(true);
         newPacket->setIsEncrypted(true);
 
-        // Push the packet on our outgoing queue
-        //boost::recursive_mutex::scoped_lock lk(mSessionMutex);
-
-        mNewWindowPacketList.push_back(newPacket);
-
-        if(!++mOutSequenceNext)
-            _handleOutSequenceRollover();
+        // Push the packet on our send window
+        _addWindowPacket(newPacket);
 
         // Now build any remaining packets.
         while (messageSize > messageIndex)
@@ -2170,8 +1729,8 @@ void Session::_buildOutgoingReliablePackets(Message* message)
             // Build our remaining packets
             newPacket->addUint16(SESSIONOP_DataFrag1);
 
-            newPacket->addUint16(htons(mOutSequenceNext));
-            newPacket->addData(message->getData() + messageIndex, std::min<uint16>(mMaxPacketSize - 7, messageSize - messageIndex));
+            newPacket->addUint16(htons(mReliableWindow.GetNextSequence()));
+            _addMessageData(newPacket, message, messageIndex, std::min<uint16>(mMaxPacketSize - 7, messageSize - messageIndex));
 
             messageIndex += mMaxPacketSize - 7;  // -2 header, -2 sequence, -3 comp/crc
 
@@ -2181,13 +1740,8 @@ void Session::_buildOutgoingReliablePackets(Message* message)
 
             newPacket->setIsEncrypted(true);
 
-            // Push the packet on our outgoing queue
-            //boost::recursive_mutex::scoped_lock lk(mSessionMutex);
-
-            mNewWindowPacketList.push_back(newPacket);
-
-            if(!++mOutSequenceNext)
-                _handleOutSequenceRollover();
+            // Push the packet on our send window
+            _addWindowPacket(newPacket);
         }
     }
     else
@@ -2197,11 +1751,10 @@ void Session::_buildOutgoingReliablePackets(Message* message)
         newPacket = mPacketFactory->CreatePacket();
 
         newPacket->addUint16(SESSIONOP_DataChannel1);
-        //newPacket->setSequence(mOutSequenceNext);
-        newPacket->addUint16(htons(mOutSequenceNext));
+        newPacket->addUint16(htons(mReliableWindow.GetNextSequence()));
         newPacket->addUint8(message->getPriority());
         newPacket->addUint8(0);//NOT routed
-        newPacket->addData(message->getData(), message->getSize());  // -2 header, -2 sequence, -2 priority/routing, -5 routing, -2 crc
+        _addMessageData(newPacket, message, 0, message->getSize());  // -2 header, -2 sequence, -2 priority/routing, -5 routing, -2 crc
 
         // Data channels need compression and encryption
         // no compression in server server communication!
@@ -2209,13 +1762,8 @@ void Session::_buildOutgoingReliablePackets(Message* message)
 
         newPacket->setIsEncrypted(true);
 
-        // Push the packet on our outgoing queue
-        //boost::recursive_mutex::scoped_lock lk(mSessionMutex);
-
-        mNewWindowPacketList.push_back(newPacket);
-
-        if(!++mOutSequenceNext)
-            _handleOutSequenceRollover();
+        // Push the packet on our send window
+        _addWindowPacket(newPacket);
     }
     message->setPendingDelete(true);
 }
@@ -2239,7 +1787,7 @@ void Session::_buildOutgoingUnreliablePackets(Message* message)
         newPacket->addUint8(message->getDestinationId());
         newPacket->addUint32(message->getAccountId());
     }
-    newPacket->addData(message->getData(), message->getSize());
+    _addMessageData(newPacket, message, 0, message->getSize());
 
     // dont compress unreliables
     newPacket->setIsCompressed(false);
@@ -2248,8 +1796,23 @@ void Session::_buildOutgoingUnreliablePackets(Message* message)
     // Push the packet on our outgoing queue
 	
     _addOutgoingUnreliablePacket(newPacket);
-	message->setPendingDelete(true);    
+	message->setPendingDelete(true);
+
+}
+
+//======================================================================================================================
+
+void Session::_addMessageData(Packet* packet, Message* message, uint16 offset, uint16 len)
+{
+    uint16 writeIndex = packet->getWriteIndex();
+
+    packet->addData(message->getData() + offset, len);
 
+    // shared messages carry their recipient specific bytes separately from the payload
+    if(message->hasPatch())
+    {
+        message->applyPatch(packet->getData() + writeIndex, offset, len);
+    }
 }
 
 
@@ -2435,7 +1998,7 @@ void Session::_buildMultiDataPacket()
     Message*	message = 0;
 
     newPacket->addUint16(SESSIONOP_DataChannel1);
-    newPacket->addUint16(htons(mOutSequenceNext));
+    newPacket->addUint16(htons(mReliableWindow.GetNextSequence()));
     newPacket->addUint16(0x1900);
 
     while(!mMultiMessageQueue.empty())
@@ -2453,7 +2016,7 @@ void Session::_buildMultiDataPacket()
 
         newPacket->addUint8(message->getPriority());
         newPacket->addUint8(0);	//Routing byte -> zero for channel1
-        newPacket->addData(message->getData(), message->getSize());
+        _addMessageData(newPacket, message, 0, message->getSize());
 
         message->setPendingDelete(true);
     }
@@ -2461,12 +2024,7 @@ void Session::_buildMultiDataPacket()
     newPacket->setIsCompressed(true);
     newPacket->setIsEncrypted(true);
 
-    boost::recursive_mutex::scoped_lock lk(mSessionMutex);
-    mNewWindowPacketList.push_back(newPacket);
-
-    //sequence of packets uint16 +1 for every packet rollover from 0xffff to 0
-    if(!++mOutSequenceNext)
-        _handleOutSequenceRollover();
+    _addWindowPacket(newPacket);
 }
 
 //======================================================================
@@ -2479,7 +2037,7 @@ void Session::_buildRoutedMultiDataPacket()
     Message*	message = 0;
 
     newPacket->addUint16(SESSIONOP_DataChannel2); //server server communication !!!!!
-    newPacket->addUint16(htons(mOutSequenceNext));
+    newPacket->addUint16(htons(mReliableWindow.GetNextSequence()));
     newPacket->addUint16(0x1900);
     //newPacket->addUint8(0);
     //newPacket->addUint8(0x19);
@@ -2508,7 +2066,7 @@ void Session::_buildRoutedMultiDataPacket()
         //accountId = fragment->getUint32();
 
 
-        newPacket->addData(message->getData(), message->getSize());
+        _addMessageData(newPacket, message, 0, message->getSize());
 
         message->setPendingDelete(true);
 
@@ -2517,12 +2075,7 @@ void Session::_buildRoutedMultiDataPacket()
     newPacket->setIsCompressed(false); //server server !!! save the cycles!!!
     newPacket->setIsEncrypted(true);
 
-    //boost::recursive_mutex::scoped_lock lk(mSessionMutex);
-    mNewWindowPacketList.push_back(newPacket);
-
-    //sequence of packets uint16 +1 for every packet rollover from 0xffff to 0
-    if(!++mOutSequenceNext)
-        _handleOutSequenceRollover();
+    _addWindowPacket(newPacket);
 }
 
 //======================================================================
@@ -2543,7 +2096,7 @@ void Session::_buildUnreliableMultiDataPacket()
         newPacket->addUint8(message->getSize() + 2); // count priority + routing flag
         newPacket->addUint8(message->getPriority());
         newPacket->addUint8(0);
-        newPacket->addData(message->getData(), message->getSize());
+        _addMessageData(newPacket, message, 0, message->getSize());
 
         message->setPendingDelete(true);
     }
@@ -2557,17 +2110,18 @@ void Session::_buildUnreliableMultiDataPacket()
 
 //======================================================================================================================
 
-void Session::_handleOutSequenceRollover()
+void Session::_addWindowPacket(Packet* packet)
 {
-    //rollover of the packet sequence from 0xffff to 0
-    DLOG(info) << "Session Sequence Rollover queuesize " << mWindowPacketList.size() << " nextseqsent: " << mNextPacketSequenceSent << " Service " << mService->getId();
-    mOutSequenceRollover = true;
-
-    mRolloverWindowPacketList = mWindowPacketList;
-    mNewRolloverWindowPacketList = mNewWindowPacketList;
+    // the packet got the next sequence of the window written into it when it was build
+    // the window sequence wraps from 0xffff to 0 on its own
+    boost::recursive_mutex::scoped_lock lk(mSessionMutex);
 
-    mWindowPacketList.clear();
-    mNewWindowPacketList.clear();
+    if(!mReliableWindow.Push(packet))
+    {
+        // cant happen as long as we stop building at RELIABLE_WINDOW_BUILD_LIMIT
+        LOG(error) << "Session::_addWindowPacket window full, dropping sequence " << mReliableWindow.GetNextSequence() << " session 0x" << mService->getId() << mId;
+        mPacketFactory->DestroyPacket(packet);
+    }
 }
 
 //======================================================================================================================
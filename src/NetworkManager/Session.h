@@ -31,10 +31,14 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include <list>
 #include <queue>
 
+#include <boost/atomic.hpp>
 #include <boost/thread/recursive_mutex.hpp>
 #include <boost/thread/thread.hpp>
 
 #include "anh/Utils/clock.h"
+#include "anh/network/congestion_control.h"
+#include "anh/network/fragment_assembler.h"
+#include "anh/network/reliable_window.h"
 #include "Utils/typedefs.h"
 #include "Utils/ConcurrentQueue.h"
 
@@ -59,6 +63,13 @@ typedef utils::ConcurrentQueueLight<Packet*>			ConcurrentPacketQueue;
 //typedef std::priority_queue<Message*,std::vector<Message*>,CompareMsg>  MessageQueue;
 typedef std::queue<Message*>							MessageQueue;
 typedef utils::ConcurrentQueueLight<Message*>			ConcurrentMessageQueue;
+typedef swganh::network::ReliableWindow<Packet*>		PacketWindow;
+typedef swganh::network::FragmentAssembler<Packet*>		PacketAssembler;
+
+#define RELIABLE_WINDOW_MIN_SIZE		4		// the congestion window never closes below this many packets in flight
+#define RELIABLE_WINDOW_INITIAL_SIZE	32		// packets in flight before the first roundtrip got measured
+#define RELIABLE_WINDOW_BUILD_LIMIT		0x6000	// stop building packets while this many wait for their ack
+#define MAX_FRAGMENTED_MESSAGE_SIZE		0x10006	// a message holds 0xffff bytes, plus priority, routing and routing header
 
 //======================================================================================================================
 
@@ -92,6 +103,7 @@ public:
     void                        ProcessReadThread(void);
     void                        ProcessWriteThread(void);
 
+    // handles an incoming packet and schedules a write pass for whatever it queued
     void                        HandleSessionPacket(Packet* packet);
     void                        SortSessionPacket(Packet* packet, uint16 type);
     void                        HandleFastpathPacket(Packet* packet);
@@ -150,13 +162,13 @@ public:
     }
 
 	uint32					  getWindowSizeCurrent()							{
-        return mWindowSizeCurrent;
+        return mCongestion.GetWindow();
     }
 
 
     void						  setResendWindowSize(uint32 resendWindowSize)	  {
         mWindowResendSize = resendWindowSize;
-        mWindowSizeCurrent = resendWindowSize;
+        mCongestion.SetMaxWindow(resendWindowSize);
     }
     void                        setClient(NetworkClient* client)                {
         mClient = client;
@@ -193,6 +205,7 @@ public:
     }
     void                        setCommand(SessionCommand command)              {
         mCommand = command;
+        _scheduleWrite();
     }
     void                        setInOutgoingQueue(bool in)                     {
         mInOutgoingQueue = in;
@@ -214,10 +227,34 @@ public:
         return mServerService;
     }
 
+    // the SocketWriteThread queues a session for a write pass only once at a time,
+    // returns true if the session wasnt queued yet and has to be queued by the caller
+    bool                        markWriteScheduled()                            {
+        return !mWriteScheduled.exchange(true);
+    }
+    void                        clearWriteScheduled()                           {
+        mWriteScheduled = false;
+    }
+
+    // the deadline the SocketWriteThread filed us under, only ever touched by the write thread
+    uint64                      getWriteDeadline()                              {
+        return mWriteDeadline;
+    }
+    void                        setWriteDeadline(uint64 deadline)               {
+        mWriteDeadline = deadline;
+    }
+
+    // the local time the next write pass is due - now if outgoing work is pending or the congestion window has room
+    // for unsent packets, the next resend or housekeeping (timeouts, pings) otherwise
+    uint64                      getNextWriteTime(uint64 now);
+
     uint64					  mLastPacketDestroyed;
     uint64					  mHash;
 
 private:
+    void                        _handleSessionPacket(Packet* packet);
+    void                        _scheduleWrite(void);
+
     void                        _processSessionRequestPacket(Packet* packet);
     void                        _processDisconnectPacket(Packet* packet);
     void                        _processMultiPacket(Packet* packet);
@@ -226,10 +263,11 @@ private:
     void                        _processDataChannelPacket(Packet* packet, bool fastPath);
     void                        _processDataChannelB(Packet* packet);
 
-    void						  _resendData();
+    void						  _resendData(uint64 now);
 
-	/*@brief	_processDataOrderPacket handles an out of order packet. The packet gives the sequence of the packet the remote side expects
-	*			we iterate then through all our unacknowledged packets and resend them
+	/*@brief	_processDataOrderPacket handles an out of order packet. A client gives the sequence it received ahead of a gap,
+	*			our own servers the last sequence they received in order. The packets of the gap that had the time to
+	*			arrive get resent
 	*			Packet* packet is the Out of Order Packet received
 	*/
     void                        _processDataOrderPacket(Packet* packet);
@@ -237,6 +275,9 @@ private:
     void                        _processDataChannelAck(Packet* packet);
     void                        _processFragmentedPacket(Packet* packet);
     void						  _processRoutedFragmentedPacket(Packet* packet);
+    // keeps the fragment, true once it completes the message
+    bool                        _addFragment(PacketAssembler& fragments, Packet* packet);
+    void                        _processAssembledMessage(PacketAssembler& fragments, bool routed);
     void                        _processPingPacket(Packet* packet);
 
     void                        _processConnectCommand(void);
@@ -256,12 +297,15 @@ private:
     void                        _buildOutgoingReliablePackets(Message* message);
     void						  _buildOutgoingReliableRoutedPackets(Message* message);
     void                        _buildOutgoingUnreliablePackets(Message* message);
+    // copies len bytes of the message starting at offset into the packet, including the patch of a shared message
+    void                        _addMessageData(Packet* packet, Message* message, uint16 offset, uint16 len);
     void                        _addOutgoingReliablePacket(Packet* packet);
     void                        _addOutgoingUnreliablePacket(Packet* packet);
     void                        _resendOutgoingPackets(void);
     void                        _sendPingPacket(bool request);
 
-    void						  _handleOutSequenceRollover();
+    // pushes a build reliable packet on our send window under the sequence it was build with
+    void                        _addWindowPacket(Packet* packet);
 
 
     //we want to use bigger packets in the zone connection server communication!
@@ -287,16 +331,9 @@ private:
     uint32                      mRequestId;
     uint32                      mOutgoingPingSequence;
 
-    // Incoming fragmented packet processing.
-    uint32                      mFragmentedPacketTotalSize;
-    uint32                      mFragmentedPacketCurrentSize;
-    uint16					  mFragmentedPacketStartSequence;
-    uint16					  mFragmentedPacketCurrentSequence;
-
-    uint32                      mRoutedFragmentedPacketTotalSize;
-    uint32                      mRoutedFragmentedPacketCurrentSize;
-    uint16					  mRoutedFragmentedPacketStartSequence;
-    uint16					  mRoutedFragmentedPacketCurrentSequence;
+    // Incoming fragmented packet processing, the packets are kept until their message is complete
+    PacketAssembler             mFragments;
+    PacketAssembler             mRoutedFragments;
 
     uint64                      mConnectStartEvent;       // For SCOM_Connect commands
     uint64                      mLastConnectRequestSent;
@@ -320,19 +357,18 @@ private:
     uint64                      mServerPacketsReceived;
 
     // Reliability
-    uint16                      mOutSequenceNext;
     uint16                      mInSequenceNext;
 
 	bool						out_of_order;
-    bool						mOutSequenceRollover;
-    uint16                      mNextPacketSequenceSent;
     uint64                      mLastRemotePacketAckReceived;
-    uint32 volatile             mWindowSizeCurrent;		//amount of packets we want to send in one round as to prevent drowning clients with connectionproblems
-    uint32                      mWindowResendSize;	    //
+    uint32                      mWindowResendSize;	    //the configured window, the congestion window never grows past it
+    swganh::network::CongestionControl mCongestion;     //amount of packets we want in flight as to prevent drowning clients with connectionproblems
 
     bool volatile				mSendDelayedAck;        // We processed some incoming packets, send an ack
     bool volatile               mInOutgoingQueue;       // Are we already in the queue?
     bool volatile               mInIncomingQueue;       // Are we already in the queue?
+    boost::atomic<bool>         mWriteScheduled;        // Are we already queued for a write pass?
+    uint64                      mWriteDeadline;
 
     uint16                      mLastSequenceAcked;
 
@@ -352,14 +388,9 @@ private:
     // Packet queues.
     ConcurrentPacketQueue       mOutgoingReliablePacketQueue;		//these are packets put on by the sessionwrite thread to send
     ConcurrentPacketQueue       mOutgoingUnreliablePacketQueue;   //build unreliables they will get send directly by the socket write thread  without storing for possible r esends
-    PacketWindowList            mWindowPacketList;				//our build packets - ready to get send
-    PacketWindowList			  mRolloverWindowPacketList;		//send packets after a rollover they await sending and / or acknowledgement by the client
-    PacketWindowList			  mNewRolloverWindowPacketList;
-    PacketWindowList            mNewWindowPacketList;
+    PacketWindow                mReliableWindow;				//our build packets by sequence - they await sending and / or acknowledgement
     
 
-    PacketQueue                 mIncomingFragmentedPacketQueue;
-    PacketQueue                 mIncomingRoutedFragmentedPacketQueue;
     PacketWindowList            mIncomingPacketList;
 
     boost::recursive_mutex	  mSessionMutex;
@@ -71,6 +71,7 @@ SocketReadThread::SocketReadThread(SOCKET socket, SocketWriteThread* writeThread
     mSessionFactory(0),
     mPacketFactory(0),
     mCompCryptor(0),
+    mDatagramIo(0),
     mSocket(0),
     mIsRunning(false)
 {
@@ -100,8 +101,31 @@ SocketReadThread::SocketReadThread(SOCKET socket, SocketWriteThread* writeThread
 
     mCompCryptor = new CompCryptor();
 
+    // the select backend reads a single datagram at a time
+    mDatagramIo = new swganh::network::DatagramIo(socket, network_configuration.getSocketBackend(), network_configuration.getSocketBatchSize(), 0);
+
+    uint32 batchSize = 1;
+    if(mDatagramIo->GetBackend() == swganh::network::SOCKET_BACKEND_EPOLL)
+    {
+        batchSize = network_configuration.getSocketBatchSize();
+    }
+
+    LOG(info) << "Socket Read Thread using the " << swganh::network::GetSocketBackendName(mDatagramIo->GetBackend()) << " backend, batch size " << batchSize;
+
     // Allocate our receive packets
-    mReceivePacket = mPacketFactory->CreatePacket();
+    mReceivePackets.resize(batchSize);
+    mDatagrams.resize(batchSize);
+
+    for(uint32 i = 0; i < batchSize; ++i)
+    {
+        mReceivePackets[i] = mPacketFactory->CreatePacket();
+
+        memset(&mDatagrams[i], 0, sizeof(swganh::network::Datagram));
+        mDatagrams[i].data = mReceivePackets[i]->getData();
+        mDatagrams[i].capacity = mMessageMaxSize;
+    }
+
+    mReceivePacket = mReceivePackets[0];
     mDecompressPacket = mPacketFactory->CreatePacket();
 
     // start our thread
@@ -133,23 +157,14 @@ SocketReadThread::~SocketReadThread()
     delete mMessageFactory;
 
     delete mCompCryptor;
+
+    delete mDatagramIo;
 }
 
 //======================================================================================================================
 
 void SocketReadThread::run(void)
 {
-    struct sockaddr_in  from;
-    uint32              address, fromLen = sizeof(from), count;
-    int16               recvLen = 0;
-    uint16              port = 0;
-    uint16              decompressLen = 0;
-    Session*            session;
-    fd_set              socketSet;
-    struct              timeval tv;
-
-    FD_ZERO(&socketSet);
-
     // Call our internal _startup method
     _startup();
 
@@ -179,86 +194,51 @@ void SocketReadThread::run(void)
             mSocketWriteThread->NewSession(newSession);
         }
 
-        // Reset our internal members so we can use the packet again.
-        mReceivePacket->Reset();
-        mDecompressPacket->Reset();
+        // We're going to block for 250us, the epoll backend rounds that up to a millisecond.
+        uint32 count = mDatagramIo->Receive(&mDatagrams[0], static_cast<uint32>(mDatagrams.size()), 250);
 
-        // Build a new fd_set structure
-        FD_SET(mSocket, &socketSet);
+        for(uint32 i = 0; i < count; ++i)
+        {
+            // Reset our internal members so we can use the packets again.
+            mReceivePacket = mReceivePackets[i];
+            mReceivePacket->Reset();
+            mDecompressPacket->Reset();
 
-        // We're going to block for 250ms.
-        tv.tv_sec   = 0;
-        tv.tv_usec  = 250;
+            _processDatagram(mDatagrams[i]);
 
-        count = select(mSocket+1, &socketSet, 0, 0, &tv);
+            // the session keeps a packet it was handed, read the next datagram into its replacement
+            mReceivePackets[i] = mReceivePacket;
+            mDatagrams[i].data = mReceivePacket->getData();
+        }
 
-        if(count && FD_ISSET(mSocket, &socketSet))
+        // the select backend only reads a single datagram per pass
+        if(mDatagramIo->GetBackend() == swganh::network::SOCKET_BACKEND_SELECT)
         {
-            //LOG(info) << "Message received on port " << port;
-            // Read any incoming packets.
-            recvLen = recvfrom(mSocket, mReceivePacket->getData(),(int) mMessageMaxSize, 0, (sockaddr*)&from, reinterpret_cast<socklen_t*>(&fromLen));
-
-            if(recvLen <= 0)
-            {
-#if(ANH_PLATFORM == ANH_PLATFORM_WIN32)
-				//LOG(warning) << "Connection Error : " << errno;
-				
-                int errorNr = 0;
-                errorNr = WSAGetLastError();
-				//disconnect server in case the remotehost has disconnected
-				if(errorNr == 10054)	
-				{
-					 // Get our remote Address and port
-					address		= from.sin_addr.s_addr;
-					port		= from.sin_port;
-
-					uint64 hash = address | (((uint64)port) << 32);
-
-		            boost::mutex::scoped_lock lk(mSocketReadMutex);
-
-					AddressSessionMap::iterator i = mAddressSessionMap.find(hash);
-
-					if(i != mAddressSessionMap.end())
-					{
-						session = (*i).second;
-					}
-					session->setCommand(SCOM_Disconnect);
-
-					LOG(warning) << "ConnectionClosed from Remotehost ";
-					continue;
-				}
-
-                char errorMsg[512];
-
-                if(FormatMessage(FORMAT_MESSAGE_FROM_SYSTEM, NULL, errorNr, MAKELANGID(LANG_NEUTRAL,SUBLANG_DEFAULT),(LPTSTR)errorMsg, (sizeof(errorMsg) / sizeof(TCHAR)) - 1, NULL))
-                {
-                    LOG(warning) << "Error(recvFrom): " << errorNr << " : " << errorMsg;
-                }
-                else
-                {
-                    LOG(warning) << "Error(recvFrom): " << errorNr;
-                }
-#endif
-                continue;
-            }
+            boost::this_thread::sleep(boost::posix_time::microseconds(10));
+        }
+    }
 
-            if(recvLen > mMessageMaxSize)
-            {
-                LOG(info) << "Socket Read Thread Received Size > mMessageMaxSize: " << recvLen;
-            }
+    // Shutdown internally
+    _shutdown();
+}
 
-            // Get our remote Address and port
-            address		= from.sin_addr.s_addr;
-            port		= from.sin_port;
+//======================================================================================================================
 
-            uint64 hash = address | (((uint64)port) << 32);
+void SocketReadThread::_processDatagram(const swganh::network::Datagram& datagram)
+{
+    Session*            session = NULL;
+    uint16              decompressLen = 0;
+    int16               recvLen = static_cast<int16>(datagram.length);
 
-            // Grab our packet type
-            mReceivePacket->Reset();           // Reset our internal members so we can use the packet again.
-            mReceivePacket->setSize(recvLen); // crc is subtracted by the decryption
+    if(recvLen <= 0)
+    {
+#if(ANH_PLATFORM == ANH_PLATFORM_WIN32)
+        int errorNr = datagram.error;
 
-            uint8  packetTypeLow	= mReceivePacket->peekUint8();
-            uint16 packetType		= mReceivePacket->getUint16();
+        //disconnect server in case the remotehost has disconnected
+        if(errorNr == 10054)
+        {
+            uint64 hash = datagram.address | (((uint64)datagram.port) << 32);
 
             boost::mutex::scoped_lock lk(mSocketReadMutex);
 
@@ -266,209 +246,247 @@ void SocketReadThread::run(void)
 
             if(i != mAddressSessionMap.end())
             {
-                session = (*i).second;
+                (*i).second->setCommand(SCOM_Disconnect);
             }
-            else
+
+            LOG(warning) << "ConnectionClosed from Remotehost ";
+            return;
+        }
+
+        char errorMsg[512];
+
+        if(FormatMessage(FORMAT_MESSAGE_FROM_SYSTEM, NULL, errorNr, MAKELANGID(LANG_NEUTRAL,SUBLANG_DEFAULT),(LPTSTR)errorMsg, (sizeof(errorMsg) / sizeof(TCHAR)) - 1, NULL))
+        {
+            LOG(warning) << "Error(recvFrom): " << errorNr << " : " << errorMsg;
+        }
+        else
+        {
+            LOG(warning) << "Error(recvFrom): " << errorNr;
+        }
+#endif
+        return;
+    }
+
+    if(recvLen > mMessageMaxSize)
+    {
+        LOG(info) << "Socket Read Thread Received Size > mMessageMaxSize: " << recvLen;
+    }
+
+    // Get our remote Address and port
+    uint32 address	= datagram.address;
+    uint16 port		= datagram.port;
+
+    uint64 hash = address | (((uint64)port) << 32);
+
+    // Grab our packet type
+    mReceivePacket->Reset();           // Reset our internal members so we can use the packet again.
+    mReceivePacket->setSize(recvLen); // crc is subtracted by the decryption
+
+    uint8  packetTypeLow	= mReceivePacket->peekUint8();
+    uint16 packetType		= mReceivePacket->getUint16();
+
+    boost::mutex::scoped_lock lk(mSocketReadMutex);
+
+    AddressSessionMap::iterator i = mAddressSessionMap.find(hash);
+
+    if(i != mAddressSessionMap.end())
+    {
+        session = (*i).second;
+    }
+    else
+    {
+        // We should only be creating a new session if it's a session request packet
+        if(packetType == SESSIONOP_SessionRequest)
+        {
+            session = mSessionFactory->CreateSession();
+            session->setSocketReadThread(this);
+            session->setPacketFactory(mPacketFactory);
+            session->setAddress(address);  // Store the address and port in network order so we don't have to
+            session->setPort(port);  // convert them all the time.  Only convert for humans.
+            session->setResendWindowSize(mSessionResendWindowSize);
+
+            // Insert the session into our address map and process list
+            mAddressSessionMap.insert(std::make_pair(hash, session));
+            mSocketWriteThread->NewSession(session);
+            session->mHash = hash;
+
+            LOG(info) << "Added Service " << mSessionFactory->getService()->getId() << ": New Session(" 
+            <<inet_ntoa(*((in_addr*)(&address))) << ", " << ntohs(session->getPort()) << "), AddressMap: " << mAddressSessionMap.size();
+        }
+        else
+        {
+            LOG(warning) << "Socket Read Thread Session not found. Type:0x" << packetType;
+
+            lk.unlock();
+
+            return;
+        }
+    }
+
+    lk.unlock();
+
+    // I don't like any of the code below, but it's going to take me a bit to work out a good way to handle decompression
+    // and decryption.  It's dependent on session layer protocol information, which should not be looked at here.  Should
+    // be placed in Session, though I'm not sure how or where yet.
+    // Set the size of the packet
+
+    // Validate our date header.  If it's not a valid header, drop it.
+    if(packetType > 0x00ff && (packetType & 0x00ff) == 0 && session != NULL)
+    {
+        switch(packetType)
+        {
+        case SESSIONOP_Disconnect:
+        case SESSIONOP_DataAck1:
+        case SESSIONOP_DataAck2:
+        case SESSIONOP_DataAck3:
+        case SESSIONOP_DataAck4:
+        case SESSIONOP_DataOrder1:
+        case SESSIONOP_DataOrder2:
+        case SESSIONOP_DataOrder3:
+        case SESSIONOP_DataOrder4:
+        case SESSIONOP_Ping:
+        {
+            // Before we do anything else, check the CRC.
+            uint32 packetCrc = mCompCryptor->GenerateCRC(mReceivePacket->getData(), recvLen - 2, session->getEncryptKey());  // - 2 crc
+
+            uint8 crcLow  = (uint8)*(mReceivePacket->getData() + recvLen - 1);
+            uint8 crcHigh = (uint8)*(mReceivePacket->getData() + recvLen - 2);
+
+            if (crcLow != (uint8)packetCrc || crcHigh != (uint8)(packetCrc >> 8))
             {
-                // We should only be creating a new session if it's a session request packet
-                if(packetType == SESSIONOP_SessionRequest)
-                {
-                    session = mSessionFactory->CreateSession();
-                    session->setSocketReadThread(this);
-                    session->setPacketFactory(mPacketFactory);
-                    session->setAddress(address);  // Store the address and port in network order so we don't have to
-                    session->setPort(port);  // convert them all the time.  Only convert for humans.
-                    session->setResendWindowSize(mSessionResendWindowSize);
-
-                    // Insert the session into our address map and process list
-                    mAddressSessionMap.insert(std::make_pair(hash, session));
-                    mSocketWriteThread->NewSession(session);
-                    session->mHash = hash;
-
-                    LOG(info) << "Added Service " << mSessionFactory->getService()->getId() << ": New Session(" 
-                    <<inet_ntoa(from.sin_addr) << ", " << ntohs(session->getPort()) << "), AddressMap: " << mAddressSessionMap.size();
-                }
-                else
-                {
-                    LOG(warning) << "Socket Read Thread Session not found. Type:0x" << packetType;
-
-                    lk.unlock();
-
-                    continue;
-                }
+                // CRC mismatch.  Dropping packet.
+                //gLogger->hexDump(mReceivePacket->getData(),mReceivePacket->getSize());
+                DLOG(info) << "DIS/ACK/ORDER/PING dropped.";
+                return;
             }
 
-            lk.unlock();
+            // Decrypt the packet
+            mCompCryptor->Decrypt(mReceivePacket->getData() + 2, recvLen - 4, session->getEncryptKey());
+
+            // Send the packet to the session.
+            session->HandleSessionPacket(mReceivePacket);
+            mReceivePacket = mPacketFactory->CreatePacket();
+        }
+        break;
+
+        case SESSIONOP_MultiPacket:
+        case SESSIONOP_NetStatRequest:
+        case SESSIONOP_NetStatResponse:
+        case SESSIONOP_DataChannel1:
+        case SESSIONOP_DataChannel2:
+        case SESSIONOP_DataChannel3:
+        case SESSIONOP_DataChannel4:
+        case SESSIONOP_DataFrag1:
+        case SESSIONOP_DataFrag2:
+        case SESSIONOP_DataFrag3:
+        case SESSIONOP_DataFrag4:
+        {
+            // Before we do anything else, check the CRC.
+            uint32 packetCrc = mCompCryptor->GenerateCRC(mReceivePacket->getData(), recvLen - 2, session->getEncryptKey());
 
-            // I don't like any of the code below, but it's going to take me a bit to work out a good way to handle decompression
-            // and decryption.  It's dependent on session layer protocol information, which should not be looked at here.  Should
-            // be placed in Session, though I'm not sure how or where yet.
-            // Set the size of the packet
+            uint8 crcLow  = (uint8)*(mReceivePacket->getData() + recvLen - 1);
+            uint8 crcHigh = (uint8)*(mReceivePacket->getData() + recvLen - 2);
 
-            // Validate our date header.  If it's not a valid header, drop it.
-            if(packetType > 0x00ff && (packetType & 0x00ff) == 0 && session != NULL)
+            if (crcLow != (uint8)packetCrc || crcHigh != (uint8)(packetCrc >> 8))
             {
-                switch(packetType)
-                {
-                case SESSIONOP_Disconnect:
-                case SESSIONOP_DataAck1:
-                case SESSIONOP_DataAck2:
-                case SESSIONOP_DataAck3:
-                case SESSIONOP_DataAck4:
-                case SESSIONOP_DataOrder1:
-                case SESSIONOP_DataOrder2:
-                case SESSIONOP_DataOrder3:
-                case SESSIONOP_DataOrder4:
-                case SESSIONOP_Ping:
-                {
-                    // Before we do anything else, check the CRC.
-                    uint32 packetCrc = mCompCryptor->GenerateCRC(mReceivePacket->getData(), recvLen - 2, session->getEncryptKey());  // - 2 crc
-
-                    uint8 crcLow  = (uint8)*(mReceivePacket->getData() + recvLen - 1);
-                    uint8 crcHigh = (uint8)*(mReceivePacket->getData() + recvLen - 2);
-
-                    if (crcLow != (uint8)packetCrc || crcHigh != (uint8)(packetCrc >> 8))
-                    {
-                        // CRC mismatch.  Dropping packet.
-                        //gLogger->hexDump(mReceivePacket->getData(),mReceivePacket->getSize());
-                        DLOG(info) << "DIS/ACK/ORDER/PING dropped.";
-                        continue;
-                    }
-
-                    // Decrypt the packet
-                    mCompCryptor->Decrypt(mReceivePacket->getData() + 2, recvLen - 4, session->getEncryptKey());
-
-                    // Send the packet to the session.
-                    session->HandleSessionPacket(mReceivePacket);
-                    mReceivePacket = mPacketFactory->CreatePacket();
-                }
-                break;
+                // CRC mismatch.  Dropping packet.
 
-                case SESSIONOP_MultiPacket:
-                case SESSIONOP_NetStatRequest:
-                case SESSIONOP_NetStatResponse:
-                case SESSIONOP_DataChannel1:
-                case SESSIONOP_DataChannel2:
-                case SESSIONOP_DataChannel3:
-                case SESSIONOP_DataChannel4:
-                case SESSIONOP_DataFrag1:
-                case SESSIONOP_DataFrag2:
-                case SESSIONOP_DataFrag3:
-                case SESSIONOP_DataFrag4:
-                {
-                    // Before we do anything else, check the CRC.
-                    uint32 packetCrc = mCompCryptor->GenerateCRC(mReceivePacket->getData(), recvLen - 2, session->getEncryptKey());
-
-                    uint8 crcLow  = (uint8)*(mReceivePacket->getData() + recvLen - 1);
-                    uint8 crcHigh = (uint8)*(mReceivePacket->getData() + recvLen - 2);
-
-                    if (crcLow != (uint8)packetCrc || crcHigh != (uint8)(packetCrc >> 8))
-                    {
-                        // CRC mismatch.  Dropping packet.
-
-                       LOG(info) << "Socket Read Thread: Reliable Packet dropped." << packetType << " CRC mismatch.";
-                        mCompCryptor->Decrypt(mReceivePacket->getData() + 2, recvLen - 4, session->getEncryptKey());  // don't hardcode the header buffer or CRC len.
-                        continue;
-                    }
-
-                    // Decrypt the packet
-                    mCompCryptor->Decrypt(mReceivePacket->getData() + 2, recvLen - 4, session->getEncryptKey());  // don't hardcode the header buffer or CRC len.
-
-                    // Decompress the packet
-                    decompressLen = mCompCryptor->Decompress(mReceivePacket->getData() + 2, recvLen - 5, mDecompressPacket->getData() + 2, mDecompressPacket->getMaxPayload() - 5);
-
-                    if(decompressLen > 0)
-                    {
-                        mDecompressPacket->setIsCompressed(true);
-                        mDecompressPacket->setSize(decompressLen + 2); // add the packet header size
-                        *((uint16*)(mDecompressPacket->getData())) = *((uint16*)mReceivePacket->getData());
-                        session->HandleSessionPacket(mDecompressPacket);
-                        mDecompressPacket = mPacketFactory->CreatePacket();
-
-                        break;
-                    }
-                    else
-                    {
-                        // we have to remove comp/crc
-                        mReceivePacket->setSize(mReceivePacket->getSize() - 3);
-                    }
-                }
-
-                case SESSIONOP_SessionRequest:
-                case SESSIONOP_SessionResponse:
-                case SESSIONOP_FatalError:
-                case SESSIONOP_FatalErrorResponse:
-                    //case SESSIONOP_Reset:
-                {
-                    // Send the packet to the session.
-
-                    session->HandleSessionPacket(mReceivePacket);
-                    mReceivePacket = mPacketFactory->CreatePacket();
-                }
-                break;
+               LOG(info) << "Socket Read Thread: Reliable Packet dropped." << packetType << " CRC mismatch.";
+                mCompCryptor->Decrypt(mReceivePacket->getData() + 2, recvLen - 4, session->getEncryptKey());  // don't hardcode the header buffer or CRC len.
+                return;
+            }
 
-                default:
-                {
-                    DLOG(info) << "SocketReadThread: Dont know what todo with this packet! --tmr <3";
-                }
-                break;
+            // Decrypt the packet
+            mCompCryptor->Decrypt(mReceivePacket->getData() + 2, recvLen - 4, session->getEncryptKey());  // don't hardcode the header buffer or CRC len.
+
+            // Decompress the packet
+            decompressLen = mCompCryptor->Decompress(mReceivePacket->getData() + 2, recvLen - 5, mDecompressPacket->getData() + 2, mDecompressPacket->getMaxPayload() - 5);
+
+            if(decompressLen > 0)
+            {
+                mDecompressPacket->setIsCompressed(true);
+                mDecompressPacket->setSize(decompressLen + 2); // add the packet header size
+                *((uint16*)(mDecompressPacket->getData())) = *((uint16*)mReceivePacket->getData());
+                session->HandleSessionPacket(mDecompressPacket);
+                mDecompressPacket = mPacketFactory->CreatePacket();
 
-                } //end switch(sessionOp)
+                break;
             }
-            // Validate that our data is actually fastpath
-            else if(packetTypeLow < 0x0d && session != NULL) // highest fastpath I've seen is 0x0b -tmr
+            else
             {
-                // Before we do anything else, check the CRC.
-                uint32	packetCrc	= mCompCryptor->GenerateCRC(mReceivePacket->getData(), recvLen - 2, session->getEncryptKey());
-                uint8	crcLow		= (uint8)*(mReceivePacket->getData() + recvLen - 1);
-                uint8	crcHigh		= (uint8)*(mReceivePacket->getData() + recvLen - 2);
-
-                if(crcLow != (uint8)packetCrc || crcHigh != (uint8)(packetCrc >> 8))
-                {
-                    // CRC mismatch.  Dropping packet.
-                    LOG(info) << "Packet dropped.  CRC mismatch.";
-                    continue;
-                }
-
-                // It's a 'fastpath' packet.  Send it directly up the data channel
-                mCompCryptor->Decrypt(mReceivePacket->getData() + 1, recvLen - 3, session->getEncryptKey());  // don't hardcode the header buffer or CRc len.
-
-                // Decompress the packet
-                decompressLen	= 0;
-                uint8 compFlag	= (uint8)*(mReceivePacket->getData() + recvLen - 3);
-
-                if(compFlag == 1)
-                {
-                    decompressLen = mCompCryptor->Decompress(mReceivePacket->getData() + 1, recvLen - 4, mDecompressPacket->getData() + 1, mDecompressPacket->getMaxPayload() - 4);
-                }
-
-                if(decompressLen > 0)
-                {
-                    mDecompressPacket->setIsCompressed(true);
-                    mDecompressPacket->setSize(decompressLen + 1); // add the packet header size
-
-                    *((uint8*)(mDecompressPacket->getData())) = *((uint8*)mReceivePacket->getData());
-
-                    // send the packet up the stack
-                    session->HandleFastpathPacket(mDecompressPacket);
-                    mDecompressPacket = mPacketFactory->CreatePacket();
-                }
-                else
-                {
-                    // send the packet up the stack, remove comp/crc
-                    mReceivePacket->setSize(mReceivePacket->getSize() - 3);
-
-                    session->HandleFastpathPacket(mReceivePacket);
-                    mReceivePacket = mPacketFactory->CreatePacket();
-                }
+                // we have to remove comp/crc
+                mReceivePacket->setSize(mReceivePacket->getSize() - 3);
             }
         }
 
-        boost::this_thread::sleep(boost::posix_time::microseconds(10));
+        case SESSIONOP_SessionRequest:
+        case SESSIONOP_SessionResponse:
+        case SESSIONOP_FatalError:
+        case SESSIONOP_FatalErrorResponse:
+            //case SESSIONOP_Reset:
+        {
+            // Send the packet to the session.
+
+            session->HandleSessionPacket(mReceivePacket);
+            mReceivePacket = mPacketFactory->CreatePacket();
+        }
+        break;
+
+        default:
+        {
+            DLOG(info) << "SocketReadThread: Dont know what todo with this packet! --tmr <3";
+        }
+        break;
+
+        } //end switch(sessionOp)
     }
+    // Validate that our data is actually fastpath
+    else if(packetTypeLow < 0x0d && session != NULL) // highest fastpath I've seen is 0x0b -tmr
+    {
+        // Before we do anything else, check the CRC.
+        uint32	packetCrc	= mCompCryptor->GenerateCRC(mReceivePacket->getData(), recvLen - 2, session->getEncryptKey());
+        uint8	crcLow		= (uint8)*(mReceivePacket->getData() + recvLen - 1);
+        uint8	crcHigh		= (uint8)*(mReceivePacket->getData() + recvLen - 2);
 
-    // Shutdown internally
-    _shutdown();
+        if(crcLow != (uint8)packetCrc || crcHigh != (uint8)(packetCrc >> 8))
+        {
+            // CRC mismatch.  Dropping packet.
+            LOG(info) << "Packet dropped.  CRC mismatch.";
+            return;
+        }
+
+        // It's a 'fastpath' packet.  Send it directly up the data channel
+        mCompCryptor->Decrypt(mReceivePacket->getData() + 1, recvLen - 3, session->getEncryptKey());  // don't hardcode the header buffer or CRc len.
+
+        // Decompress the packet
+        decompressLen	= 0;
+        uint8 compFlag	= (uint8)*(mReceivePacket->getData() + recvLen - 3);
+
+        if(compFlag == 1)
+        {
+            decompressLen = mCompCryptor->Decompress(mReceivePacket->getData() + 1, recvLen - 4, mDecompressPacket->getData() + 1, mDecompressPacket->getMaxPayload() - 4);
+        }
+
+        if(decompressLen > 0)
+        {
+            mDecompressPacket->setIsCompressed(true);
+            mDecompressPacket->setSize(decompressLen + 1); // add the packet header size
+
+            *((uint8*)(mDecompressPacket->getData())) = *((uint8*)mReceivePacket->getData());
+
+            // send the packet up the stack
+            session->HandleFastpathPacket(mDecompressPacket);
+            mDecompressPacket = mPacketFactory->CreatePacket();
+        }
+        else
+        {
+            // send the packet up the stack, remove comp/crc
+            mReceivePacket->setSize(mReceivePacket->getSize() - 3);
+
+            session->HandleFastpathPacket(mReceivePacket);
+            mReceivePacket = mPacketFactory->CreatePacket();
+        }
+    }
 }
 
 //======================================================================================================================
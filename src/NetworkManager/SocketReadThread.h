@@ -30,10 +30,12 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 
 #include "Utils/typedefs.h"
 #include "NetworkConfig.h"
+#include "anh/network/datagram_io.h"
 #include <boost/thread/mutex.hpp>
 #include <boost/thread/thread.hpp>
 #include <list>
 #include <map>
+#include <vector>
 
 //======================================================================================================================
 
@@ -90,7 +92,9 @@ protected:
 
     void                          _startup(void);
     void                          _shutdown(void);
+    void                          _processDatagram(const swganh::network::Datagram& datagram);
 
+    // the packet of the datagram being processed, replaced once it has been handed to a session
     Packet*                       mReceivePacket;
     Packet*                       mDecompressPacket;
 
@@ -100,6 +104,9 @@ protected:
     PacketFactory*                mPacketFactory;
     MessageFactory*               mMessageFactory;
     CompCryptor*                  mCompCryptor;
+    swganh::network::DatagramIo*  mDatagramIo;
+    std::vector<Packet*>          mReceivePackets;
+    std::vector<swganh::network::Datagram> mDatagrams;
     NewConnection                 mNewConnection;
 
     SOCKET                        mSocket;
@@ -30,6 +30,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "anh/logger.h"
 
 #include "CompCryptor.h"
+#include "anh/network/packet_compressor.h"
 #include "Packet.h"
 #include "Service.h"
 #include "Session.h"
@@ -38,6 +39,8 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 
 #include "anh/Utils/rand.h"
 
+#include <algorithm>
+
 #if defined(__GNUC__)
 // GCC implements tr1 in the <tr1/*> headers. This does not conform to the TR1
 // spec, which requires the header without the tr1/ prefix.
@@ -69,8 +72,11 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 SocketWriteThread::SocketWriteThread(SOCKET socket, Service* service, bool serverservice, NetworkConfig& network_configuration) :
     mService(0),
     mCompCryptor(0),
+    mCompressor(0),
+    mDatagramIo(0),
     mSocket(0),
-    mIsRunning(false)
+    mIsRunning(false),
+    mSleeping(false)
 {
     mSocket = socket;
     mService = service;
@@ -94,6 +100,20 @@ SocketWriteThread::SocketWriteThread(SOCKET socket, Service* service, bool serve
     // Create our CompCryptor object.
     mCompCryptor = new CompCryptor();
 
+    // only we send, a single deflate stream set up once does for all our packets
+    mCompressor = new swganh::network::PacketCompressor(network_configuration.getCompressionMinSize());
+    mCompressionStatsInterval = network_configuration.getCompressionStatsInterval() * 1000;
+
+    // the workers building the packets of our sessions, sessions are sharded by id
+    uint32 workers = std::max<uint32>(network_configuration.getSocketWriteWorkers(), 1);
+
+    for(uint32 i = 0; i < workers; ++i)	{
+        mWorkers.push_back(new utils::ActiveObject());
+    }
+
+    // packets are built right into the send batch of the datagram io
+    mDatagramIo = new swganh::network::DatagramIo(socket, network_configuration.getSocketBackend(), network_configuration.getSocketBatchSize(), SEND_BUFFER_SIZE);
+
     // start our thread
     boost::thread t(std::tr1::bind(&SocketWriteThread::run, this));
 
@@ -110,6 +130,7 @@ SocketWriteThread::SocketWriteThread(SOCKET socket, Service* service, bool serve
     //our thread load values
     //mThreadTime = mLastThreadTime = 0;
     mLastTime =   Anh_Utils::Clock::getSingleton()->getLocalTime();
+    mLastCompressionStats = mLastTime;
     //lastThreadProcessingTime = threadProcessingTime = 0;
 
 }
@@ -124,7 +145,14 @@ SocketWriteThread::~SocketWriteThread()
     mThread.interrupt();
     mThread.join();
 
+    for(uint32 i = 0; i < mWorkers.size(); ++i)	{
+        delete mWorkers[i];
+    }
+
     delete mCompCryptor;
+    delete mCompressor;
+
+    delete mDatagramIo;
 
     // delete(mClock);
 }
@@ -148,13 +176,21 @@ void SocketWriteThread::run()
 		//}
 		uint32 packetsSend = 0;
 
+		// sessions whose resend, keepalive or pacing deadline passed
+		_scheduleDueSessions(Anh_Utils::Clock::getSingleton()->getLocalTime());
+
         while(mSessionQueue.pop(session))	{
-            uint32 packetCount = 0;
+			// woken before its deadline
+			if(session->getWriteDeadline())	{
+				mDeadlines.erase(std::make_pair(session->getWriteDeadline(), session));
+				session->setWriteDeadline(0);
+			}
 
-            // Process our session
-			active_.Send( [=] {
+            // Process our session, always on the same worker so its passes stay in order
+			mWorkers[session->getId() % mWorkers.size()]->Send( [=] {
 				session->ProcessWriteThread();
 				mAsyncSessionQueue.push(session);
+				_wakeUp();
 			}
 			);
 
@@ -164,12 +200,19 @@ void SocketWriteThread::run()
 			_send(session);
 		}
 
+		// the epoll backend only collected the datagrams of this pass
+		mDatagramIo->Flush();
+
+		if(mCompressionStatsInterval)	{
+			_logCompressionStats(Anh_Utils::Clock::getSingleton()->getLocalTime());
+		}
+
 		//if((!this->mServerService) && sessionCount)	{
 			//DLOG(info) << "SocketWriteThread::run() END";
 			//DLOG(info) << "sending : " << packetsSend << "Packets";
 		//}
 
-        boost::this_thread::sleep(boost::posix_time::milliseconds(1));
+        _waitForWork();
     }
 
     // Shutdown internally
@@ -197,8 +240,8 @@ void SocketWriteThread::_shutdown(void)
 
 void SocketWriteThread::_sendPacket(Packet* packet, Session* session)
 {
-    struct sockaddr     toAddr;
-    uint32              sent, toLen = sizeof(toAddr), outLen;
+    uint32              outLen;
+    int8*               sendBuffer = mDatagramIo->GetSendBuffer();
 
 
     // Going to simulate network packet loss here.
@@ -216,25 +259,20 @@ void SocketWriteThread::_sendPacket(Packet* packet, Session* session)
     // Set our TimeSent
     packet->setTimeSent(Anh_Utils::Clock::getSingleton()->getStoredTime());
 
-    // Setup our to address
-    toAddr.sa_family = AF_INET;
-    *((unsigned int*)&toAddr.sa_data[2]) = session->getAddress();     // Ports and addresses are stored in network order.
-    *((unsigned short*)&(toAddr.sa_data[0])) = session->getPort();    // Only need to convert for humans.
-
     // Copy our 2 byte header.
-    *((uint16*)mSendBuffer) = *((uint16*)packet->getData());
+    *((uint16*)sendBuffer) = *((uint16*)packet->getData());
 
     // Compress the packet if needed.
     if(packet->getIsCompressed())
     {
         if(packetTypeLow == 0)
         {
-            // Compress our packet, but not the header
-            outLen = mCompCryptor->Compress(packet->getData() + 2, packet->getSize() - 2, mSendBuffer + 2, sizeof(mSendBuffer));
+            // Compress our packet, but not the header - leave room for the compression flag and crc
+            outLen = mCompressor->Compress(packet->getData() + 2, packet->getSize() - 2, sendBuffer + 2, SEND_BUFFER_SIZE - 5);
         }
         else
         {
-            outLen = mCompCryptor->Compress(packet->getData() + 1, packet->getSize() - 1, mSendBuffer + 1, sizeof(mSendBuffer));
+            outLen = mCompressor->Compress(packet->getData() + 1, packet->getSize() - 1, sendBuffer + 1, SEND_BUFFER_SIZE - 4);
         }
 
         // If we compressed it, place a 1 at the end of the buffer.
@@ -242,36 +280,36 @@ void SocketWriteThread::_sendPacket(Packet* packet, Session* session)
         {
             if(packetTypeLow == 0)
             {
-                mSendBuffer[outLen + 2] = 1;
+                sendBuffer[outLen + 2] = 1;
                 outLen += 3;  //thats 2 (uncompressed) headerbytes plus the encryption flag
             }
             else
             {
-                mSendBuffer[outLen + 1] = 1;
+                sendBuffer[outLen + 1] = 1;
                 outLen += 2;
             }
         }
         // else a 0 - so no compression
         else
         {
-            memcpy(mSendBuffer, packet->getData(), packet->getSize());
+            memcpy(sendBuffer, packet->getData(), packet->getSize());
             outLen = packet->getSize();
 
-            mSendBuffer[outLen] = 0;
+            sendBuffer[outLen] = 0;
             outLen += 1;
         }
     }
     else if(packetType == SESSIONOP_SessionResponse || packetType == SESSIONOP_CriticalError)
     {
-        memcpy(mSendBuffer, packet->getData(), packet->getSize());
+        memcpy(sendBuffer, packet->getData(), packet->getSize());
         outLen = packet->getSize();
     }
     else
     {
-        memcpy(mSendBuffer, packet->getData(), packet->getSize());
+        memcpy(sendBuffer, packet->getData(), packet->getSize());
         outLen = packet->getSize();
 
-        mSendBuffer[outLen] = 0;
+        sendBuffer[outLen] = 0;
         outLen += 1;
     }
 
@@ -280,36 +318,145 @@ void SocketWriteThread::_sendPacket(Packet* packet, Session* session)
     {
         if(packetTypeLow == 0)
         {
-            mCompCryptor->Encrypt(mSendBuffer + 2, outLen - 2, session->getEncryptKey()); // -2 header is not encrypted
+            mCompCryptor->Encrypt(sendBuffer + 2, outLen - 2, session->getEncryptKey()); // -2 header is not encrypted
         }
         else if(packetTypeLow < 0x0d)
         {
-            mCompCryptor->Encrypt(mSendBuffer + 1, outLen - 1, session->getEncryptKey()); // - 1 header is not encrypted
+            mCompCryptor->Encrypt(sendBuffer + 1, outLen - 1, session->getEncryptKey()); // - 1 header is not encrypted
         }
 
-        packet->setCRC(mCompCryptor->GenerateCRC(mSendBuffer, outLen, session->getEncryptKey()));
+        packet->setCRC(mCompCryptor->GenerateCRC(sendBuffer, outLen, session->getEncryptKey()));
 
 
-        mSendBuffer[outLen] = (uint8)(packet->getCRC() >> 8);
-        mSendBuffer[outLen + 1] = (uint8)packet->getCRC();
+        sendBuffer[outLen] = (uint8)(packet->getCRC() >> 8);
+        sendBuffer[outLen + 1] = (uint8)packet->getCRC();
         outLen += 2;
     }
 
     //LOG(info) << "Sending message to " << session->getAddressString() << " on port " << ntohs(session->getPort());
-    sent = sendto(mSocket, mSendBuffer, outLen, 0, &toAddr, toLen);
-
-    if (sent < 0)
-    {
-        LOG(warning) << "Unkown Error from socket sendto: " << errno;
-    }
+    // Ports and addresses are stored in network order.  Only need to convert for humans.
+    mDatagramIo->Send(outLen, session->getAddress(), session->getPort());
 }
 
 //======================================================================================================================
 
 void SocketWriteThread::NewSession(Session* session)
 {
+    ScheduleSession(session);
+}
+
+//======================================================================================================================
+
+void SocketWriteThread::ScheduleSession(Session* session)
+{
+    // already queued, the pending pass picks up the new work
+    if(!session->markWriteScheduled())	{
+        return;
+    }
+
     //using concurrent queue that has a recursive mutex
     mSessionQueue.push(session);
+    _wakeUp();
+}
+
+//======================================================================================================================
+
+void SocketWriteThread::_scheduleDueSessions(uint64 now)
+{
+    while(!mDeadlines.empty() && mDeadlines.begin()->first <= now)	{
+        Session* session = mDeadlines.begin()->second;
+
+        mDeadlines.erase(mDeadlines.begin());
+        session->setWriteDeadline(0);
+
+        if(session->markWriteScheduled())	{
+            mSessionQueue.push(session);
+        }
+    }
+}
+
+//======================================================================================================================
+
+void SocketWriteThread::_reschedule(Session* session)
+{
+    // from here on every new piece of work queues the session again
+    session->clearWriteScheduled();
+
+    uint64 now = Anh_Utils::Clock::getSingleton()->getLocalTime();
+    uint64 next = session->getNextWriteTime(now);
+
+    if(next <= now)	{
+        ScheduleSession(session);
+        return;
+    }
+
+    // a wake up in between already queued us, its pass drops the deadline again
+    session->setWriteDeadline(next);
+    mDeadlines.insert(std::make_pair(next, session));
+}
+
+//======================================================================================================================
+
+void SocketWriteThread::_logCompressionStats(uint64 now)
+{
+    if(now < mLastCompressionStats + mCompressionStatsInterval)	{
+        return;
+    }
+
+    mLastCompressionStats = now;
+
+    const swganh::network::CompressionStats& stats = mCompressor->GetStats();
+
+    if(stats.packets)	{
+        LOG(info) << "Packet compression on port " << mService->getLocalPort() << (mServerService ? " (server)" : " (client)")
+                  << ": " << stats.packets << " packets, " << stats.compressed << " compressed, "
+                  << stats.skipped_small << " too small, " << stats.skipped_entropy << " incompressible, "
+                  << stats.expanded << " not smaller; " << stats.bytes_in << " bytes in, " << stats.bytes_out << " out, "
+                  << (stats.microseconds / 1000) << "ms, skip rate " << static_cast<uint32>(stats.GetSkipRate() * 100.0) << "%";
+    }
+
+    mCompressor->ResetStats();
+}
+
+//======================================================================================================================
+
+void SocketWriteThread::_wakeUp()
+{
+    if(mSleeping)	{
+        boost::mutex::scoped_lock lk(mWakeMutex);
+        mWakeCondition.notify_one();
+    }
+}
+
+//======================================================================================================================
+
+void SocketWriteThread::_waitForWork()
+{
+    // sleep until a session gets work or the next deadline, the second is merely a safety net
+    uint64 timeout = 1000;
+
+    if(!mDeadlines.empty())	{
+        uint64 now = Anh_Utils::Clock::getSingleton()->getLocalTime();
+        uint64 deadline = mDeadlines.begin()->first;
+
+        timeout = (deadline > now) ? std::min<uint64>(deadline - now, timeout) : 0;
+    }
+
+    if(!timeout)	{
+        return;
+    }
+
+    mSleeping = true;
+
+    {
+        boost::mutex::scoped_lock lk(mWakeMutex);
+
+        if(!mSessionQueue.filled() && !mAsyncSessionQueue.filled() && !mExit)	{
+            mWakeCondition.timed_wait(lk, boost::posix_time::milliseconds(timeout));
+        }
+    }
+
+    mSleeping = false;
 }
 
 //======================================================================================================================
@@ -333,10 +480,10 @@ void SocketWriteThread::_send(Session* session)
         session->DestroyPacket(packet);
     }
 
-	// If the session is still in a connected state, Put us back in the queue.
-	// otherwise inform the service that we need destroying
+	// If the session is still in a connected state, schedule its next pass.
+	// otherwise inform the service that we need destroying - it stays marked as scheduled so nobody queues it again
 	if (session->getStatus() != SSTAT_Disconnected)	{
-		mSessionQueue.push(session);
+		_reschedule(session);
 	}	else	{
 		session->setStatus(SSTAT_Destroy);
 		mService->AddSessionToProcessQueue(session);
@@ -34,7 +34,12 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "Utils/ActiveObject.h"
 
 #include "NetworkConfig.h"
+#include <boost/atomic.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
 #include <boost/thread/thread.hpp>
+#include <set>
+#include <vector>
 
 #define SEND_BUFFER_SIZE 8192
 
@@ -45,8 +50,14 @@ class Packet;
 class Session;
 class CompCryptor;
 
+namespace swganh	{
+namespace network	{
+	class PacketCompressor;
+}}
+
 typedef utils::ConcurrentQueue<Session*>			SessionQueue;
 typedef utils::ConcurrentQueueLight  <Session*>		SessionQueueLight;
+typedef std::set<std::pair<uint64, Session*> >		SessionDeadlineSet;
 
 //======================================================================================================================
 
@@ -61,6 +72,15 @@ public:
 
     void			NewSession(Session* session);
 
+	/**
+	* Queues a write pass for the session, called whenever it gains outgoing work.
+	* Idle sessions are only visited again once their resend / keepalive deadline is due
+	*
+	* \param session the session to process
+	*
+	*/
+    void			ScheduleSession(Session* session);
+
     bool			getIsRunning(void) {
         return mIsRunning;
     }
@@ -91,10 +111,21 @@ private:
 	*/
 	void				_send(Session* session);
 
+	void				_scheduleDueSessions(uint64 now);
+	void				_reschedule(Session* session);
+	void				_wakeUp();
+	void				_waitForWork();
+
+	/**
+	* Logs what the compression of our packets saved and cost since the last time
+	*/
+	void				_logCompressionStats(uint64 now);
+
     uint16				mMessageMaxSize;
-    int8				mSendBuffer[SEND_BUFFER_SIZE];
     Service*			mService;
     CompCryptor*		mCompCryptor;
+    swganh::network::PacketCompressor*	mCompressor;
+    swganh::network::DatagramIo*	mDatagramIo;
     SOCKET				mSocket;
     bool				mIsRunning;
     uint64			    mLastTime;
@@ -114,13 +145,21 @@ private:
 
     SessionQueueLight			mSessionQueue;
 	SessionQueueLight			mAsyncSessionQueue;
+	SessionDeadlineSet			mDeadlines;
+
+	uint64						mCompressionStatsInterval;
+	uint64						mLastCompressionStats;
+
+	boost::atomic<bool>			mSleeping;
+	boost::mutex				mWakeMutex;
+	boost::condition_variable	mWakeCondition;
 
     boost::thread   			mThread;
     boost::recursive_mutex      mSocketWriteMutex;
 
     bool						mExit;
 
-	utils::ActiveObject				active_;
+	std::vector<utils::ActiveObject*>	mWorkers;
 };
 
 //======================================================================================================================
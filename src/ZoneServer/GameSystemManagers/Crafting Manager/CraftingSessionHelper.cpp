@@ -56,6 +56,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "MessageLib/MessageLib.h"
 
 #include "DatabaseManager/Database.h"
+#include "DatabaseManager/WriteBehindQueue.h"
 #include "DatabaseManager/DatabaseCallback.h"
 #include "DatabaseManager/DatabaseResult.h"
 #include "DatabaseManager/DataBinding.h"
@@ -594,7 +595,7 @@ void CraftingSession::handleFillSlotResource(uint64 resContainerId,uint32 slotId
         {
             resContainer->setAmount(newContainerAmount);
             gMessageLib->sendResourceContainerUpdateAmount(resContainer,mOwner);
-            mDatabase->executeSqlAsync(NULL,NULL,"UPDATE %s.resource_containers SET amount=%u WHERE id=%"PRIu64"",mDatabase->galaxy(),newContainerAmount,resContainer->getId());
+            gWorldManager->getWriteBehindQueue()->markUint("resource_containers", resContainer->getId(), "amount", newContainerAmount);
             
         }
 
@@ -897,7 +898,7 @@ void CraftingSession::bagResource(ManufactureSlot* manSlot,uint64 containerId)
 
                         gMessageLib->sendResourceContainerUpdateAmount(resCont,mOwner);
 
-                        gWorldManager->getKernel()->GetDatabase()->executeSqlAsync(NULL,NULL,"UPDATE %s.resource_containers SET amount=%u WHERE id=%"PRIu64"",mDatabase->galaxy(),newAmount,resCont->getId());
+                        gWorldManager->getWriteBehindQueue()->markUint("resource_containers", resCont->getId(), "amount", newAmount);
                         
                     }
                     // target container full, put in what fits, create a new one
@@ -908,7 +909,7 @@ void CraftingSession::bagResource(ManufactureSlot* manSlot,uint64 containerId)
                         resCont->setAmount(maxAmount);
 
                         gMessageLib->sendResourceContainerUpdateAmount(resCont,mOwner);
-                        gWorldManager->getKernel()->GetDatabase()->executeSqlAsync(NULL,NULL,"UPDATE %s.resource_containers SET amount=%u WHERE id=%"PRIu64"",mDatabase->galaxy(),maxAmount,resCont->getId());
+                        gWorldManager->getWriteBehindQueue()->markUint("resource_containers", resCont->getId(), "amount", maxAmount);
 
 						gObjectFactory->requestNewResourceContainer(inventory_, (*resIt).first, inventory_->getId(),99,selectedNewAmount);
                     }
@@ -1403,7 +1404,7 @@ void CraftingSession::updateResourceContainer(uint64 containerID, uint32 newAmou
 
         resContainer->setAmount(newAmount);
         gMessageLib->sendResourceContainerUpdateAmount(resContainer,mOwner);
-        mDatabase->executeSqlAsync(NULL,NULL,"UPDATE %s.resource_containers SET amount=%u WHERE id=%"PRIu64"",mDatabase->galaxy(),newAmount,resContainer->getId());
+        gWorldManager->getWriteBehindQueue()->markUint("resource_containers", resContainer->getId(), "amount", newAmount);
        
     }
 
@@ -0,0 +1,230 @@
+/*
+---------------------------------------------------------------------------------------
+This source file is part of SWG:ANH (Star Wars Galaxies - A New Hope - Server Emulator)
+
+For more information, visit http://www.swganh.com
+
+Copyright (c) 2006 - 2014 The SWG:ANH Team
+---------------------------------------------------------------------------------------
+Use of this source code is governed by the GPL v3 license that can be found
+in the COPYING file or at http://www.gnu.org/licenses/gpl-3.0.html
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+---------------------------------------------------------------------------------------
+*/
+
+#include "ZoneServer/GameSystemManagers/NPC Manager/NpcHandlerQueue.h"
+
+#include <algorithm>
+
+#include "anh/logger.h"
+
+#include "ZoneServer/WorldManager.h"
+#include "ZoneServer/GameSystemManagers/NPC Manager/NpcManager.h"
+#include "ZoneServer/GameSystemManagers/NPC Manager/NPCObject.h"
+
+//=============================================================================
+
+NpcHandlerQueue::NpcHandlerQueue(uint64 tickInterval)
+    : mTickInterval(tickInterval)
+    , mNextGeneration(1)
+{
+}
+
+//=============================================================================
+
+NpcHandlerQueue::~NpcHandlerQueue()
+{
+}
+
+//=============================================================================
+
+void NpcHandlerQueue::add(uint64 npcId, uint64 due)
+{
+    std::pair<NpcHandlerMap::iterator, bool> result = mHandlers.insert(std::make_pair(npcId, NpcHandler()));
+
+    // already queued, the existing timer stays
+    if(!result.second)
+    {
+        return;
+    }
+
+    result.first->second.mDue = due;
+    _push(npcId, result.first->second);
+}
+
+//=============================================================================
+
+void NpcHandlerQueue::remove(uint64 npcId)
+{
+    // the heap entry goes stale and is skipped once it surfaces
+    mHandlers.erase(npcId);
+}
+
+//=============================================================================
+
+void NpcHandlerQueue::reschedule(uint64 npcId, uint64 due)
+{
+    NpcHandlerMap::iterator it = mHandlers.find(npcId);
+    if(it == mHandlers.end())
+    {
+        return;
+    }
+
+    it->second.mDue = due;
+    _push(npcId, it->second);
+}
+
+//=============================================================================
+
+void NpcHandlerQueue::clear()
+{
+    mHandlers.clear();
+    mHeap.clear();
+}
+
+//=============================================================================
+
+void NpcHandlerQueue::process(uint64 callTime)
+{
+    mStats.mDue			= 0;
+    mStats.mProcessed	= 0;
+    mStats.mOverdue		= 0;
+
+    while(!mHeap.empty() && mHeap.front().mDue <= callTime)
+    {
+        NpcHandlerEntry entry = mHeap.front();
+
+        std::pop_heap(mHeap.begin(), mHeap.end());
+        mHeap.pop_back();
+
+        NpcHandlerMap::iterator it = mHandlers.find(entry.mNpcId);
+        if(it == mHandlers.end() || it->second.mGeneration != entry.mGeneration)
+        {
+            // removed or rescheduled since
+            continue;
+        }
+
+        ++mStats.mDue;
+
+        if((callTime - entry.mDue) >= mTickInterval)
+        {
+            ++mStats.mOverdue;
+        }
+
+        NPCObject* npc = _resolve(entry.mNpcId, it->second);
+        if(!npc)
+        {
+            // Remove the expired object...
+            mHandlers.erase(it);
+            continue;
+        }
+
+        ++mStats.mProcessed;
+
+        uint64 waitTime = NpcManager::Instance()->handleNpc(npc, callTime - entry.mDue);
+
+        // the npc manager may have removed or requeued the handler meanwhile
+        it = mHandlers.find(entry.mNpcId);
+        if(it == mHandlers.end() || it->second.mGeneration != entry.mGeneration)
+        {
+            continue;
+        }
+
+        if(waitTime)
+        {
+            // Set next execution time.
+            it->second.mDue = callTime + waitTime;
+            _push(entry.mNpcId, it->second);
+        }
+        else
+        {
+            // Requested to remove the handler.
+            mHandlers.erase(it);
+        }
+    }
+
+    _compact();
+
+    mStats.mQueued			= static_cast<uint32>(mHandlers.size());
+    mStats.mTotalDue		+= mStats.mDue;
+    mStats.mTotalProcessed	+= mStats.mProcessed;
+    mStats.mTotalOverdue	+= mStats.mOverdue;
+
+    if(mStats.mOverdue)
+    {
+        DLOG(info) << "NpcHandlerQueue::process: " << mStats.mOverdue << " of " << mStats.mDue << " due npc handlers were overdue, " << mStats.mQueued << " queued";
+    }
+}
+
+//=============================================================================
+
+void NpcHandlerQueue::_push(uint64 npcId, NpcHandler& handler)
+{
+    handler.mGeneration = mNextGeneration++;
+
+    mHeap.push_back(NpcHandlerEntry(handler.mDue, npcId, handler.mGeneration));
+    std::push_heap(mHeap.begin(), mHeap.end());
+}
+
+//=============================================================================
+//
+// Stale entries of removed npc's with far away timers would pile up in the heap,
+// rebuild it from the live handlers once they make up less than half of it.
+//
+
+void NpcHandlerQueue::_compact()
+{
+    if(mHeap.size() <= (mHandlers.size() * 2) + 256)
+    {
+        return;
+    }
+
+    mHeap.clear();
+
+    NpcHandlerMap::iterator it = mHandlers.begin();
+    while(it != mHandlers.end())
+    {
+        mHeap.push_back(NpcHandlerEntry(it->second.mDue, it->first, it->second.mGeneration));
+        ++it;
+    }
+
+    std::make_heap(mHeap.begin(), mHeap.end());
+}
+
+//=============================================================================
+
+NPCObject* NpcHandlerQueue::_resolve(uint64 npcId, NpcHandler& handler)
+{
+    if(handler.mNpc && !handler.mObject.expired())
+    {
+        return handler.mNpc;
+    }
+
+    // npc's may be queued before they are added to the object map or get recreated under the same id,
+    // so resolve on first use and whenever the cached object went away
+    handler.mNpc = NULL;
+
+    std::shared_ptr<Object> object = gWorldManager->getSharedObjectById(npcId);
+
+    NPCObject* npc = dynamic_cast<NPCObject*>(object.get());
+    if(npc)
+    {
+        handler.mNpc	= npc;
+        handler.mObject	= object;
+    }
+
+    return npc;
+}
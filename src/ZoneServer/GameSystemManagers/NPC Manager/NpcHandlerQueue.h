@@ -0,0 +1,144 @@
+/*
+---------------------------------------------------------------------------------------
+This source file is part of SWG:ANH (Star Wars Galaxies - A New Hope - Server Emulator)
+
+For more information, visit http://www.swganh.com
+
+Copyright (c) 2006 - 2014 The SWG:ANH Team
+---------------------------------------------------------------------------------------
+Use of this source code is governed by the GPL v3 license that can be found
+in the COPYING file or at http://www.gnu.org/licenses/gpl-3.0.html
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+---------------------------------------------------------------------------------------
+*/
+
+#ifndef ANH_ZONESERVER_NPC_HANDLER_QUEUE_H
+#define ANH_ZONESERVER_NPC_HANDLER_QUEUE_H
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "Utils/typedefs.h"
+
+//=============================================================================
+
+class NPCObject;
+class Object;
+
+//=============================================================================
+//
+// Counters of the last handled tick and totals since server start.
+//
+
+class NpcHandlerQueueStats
+{
+public:
+    NpcHandlerQueueStats()
+        : mDue(0),mProcessed(0),mOverdue(0),mQueued(0),mTotalDue(0),mTotalProcessed(0),mTotalOverdue(0) {}
+
+    uint32	mDue;			// handlers whose timer expired this tick
+    uint32	mProcessed;		// handlers that reached a live npc
+    uint32	mOverdue;		// handlers that already missed a previous tick
+    uint32	mQueued;		// handlers left in the queue after the tick
+
+    uint64	mTotalDue;
+    uint64	mTotalProcessed;
+    uint64	mTotalOverdue;
+};
+
+//=============================================================================
+//
+// Deadline ordered queue of npc handlers, replacing the id->time maps which were swept completely
+// on every tick. Handlers sit in a binary min-heap on their due time, so a tick only pops the npc's
+// that are actually due. Removing or rescheduling a handler is O(1): the handler gets a new generation
+// and its old heap entry is dropped when it surfaces.
+//
+// The typed NPCObject* is resolved once and cached together with a weak reference to the object,
+// so due handlers no longer pay for an object map lookup and a dynamic_cast per tick.
+//
+
+class NpcHandlerQueue
+{
+public:
+
+    explicit NpcHandlerQueue(uint64 tickInterval);
+    ~NpcHandlerQueue();
+
+    // queues the npc, keeps the current due time if it is already queued
+    void	add(uint64 npcId, uint64 due);
+    void	remove(uint64 npcId);
+
+    // moves the due time of a queued npc
+    void	reschedule(uint64 npcId, uint64 due);
+
+    void	clear();
+
+    // handles all npc's due at callTime through the NpcManager
+    void	process(uint64 callTime);
+
+    bool	contains(uint64 npcId) const {
+        return mHandlers.find(npcId) != mHandlers.end();
+    }
+
+    const NpcHandlerQueueStats&	getStats() const {
+        return mStats;
+    }
+
+private:
+
+    class NpcHandler
+    {
+    public:
+        NpcHandler() : mDue(0),mGeneration(0),mNpc(NULL) {}
+
+        uint64					mDue;
+        uint32					mGeneration;
+        NPCObject*				mNpc;
+        std::weak_ptr<Object>	mObject;
+    };
+
+    class NpcHandlerEntry
+    {
+    public:
+        NpcHandlerEntry(uint64 due, uint64 npcId, uint32 generation) : mDue(due),mNpcId(npcId),mGeneration(generation) {}
+
+        // std heap functions build a max-heap, so compare inverted
+        bool operator< (const NpcHandlerEntry& right) const
+        {
+            return(mDue > right.mDue);
+        }
+
+        uint64	mDue;
+        uint64	mNpcId;
+        uint32	mGeneration;
+    };
+
+    typedef std::unordered_map<uint64, NpcHandler>	NpcHandlerMap;
+    typedef std::vector<NpcHandlerEntry>			NpcHandlerHeap;
+
+    void		_push(uint64 npcId, NpcHandler& handler);
+    void		_compact();
+    NPCObject*	_resolve(uint64 npcId, NpcHandler& handler);
+
+    NpcHandlerMap			mHandlers;
+    NpcHandlerHeap			mHeap;
+    NpcHandlerQueueStats	mStats;
+    uint64					mTickInterval;
+    uint32					mNextGeneration;
+};
+
+#endif
@@ -46,6 +46,22 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 
 
 #include "ZoneServer\WorldManager.h"
+
+//=============================================================================
+
+namespace {
+
+void selectPersistentNpcs(std::stringstream& sql,const char* galaxy)
+{
+	sql << "SELECT persistent_npcs.id,persistent_npcs.parentId,persistent_npcs.firstName,persistent_npcs.lastName,persistent_npcs.posture,persistent_npcs.state,persistent_npcs.cl,"
+		<< "persistent_npcs.oX,persistent_npcs.oY,persistent_npcs.oZ,persistent_npcs.oW,persistent_npcs.x,persistent_npcs.y,persistent_npcs.z,"
+		<< "persistent_npcs.type,persistent_npcs.stf_variable_id,persistent_npcs.stf_file_id,faction.name,"
+		<< "persistent_npcs.moodId,persistent_npcs.family,persistent_npcs.scale "
+		<< "FROM " << galaxy << ".persistent_npcs "
+		<< "INNER JOIN " << galaxy << ".faction ON (persistent_npcs.faction = faction.id)";
+}
+
+}
 //=============================================================================
 
 bool					PersistentNpcFactory::mInsFlag    = false;
@@ -138,21 +154,68 @@ void PersistentNpcFactory::handleDatabaseJobComplete(void* ref,swganh::database:
 
 void PersistentNpcFactory::requestObject(ObjectFactoryCallback* ofCallback,uint64 id,uint16 subGroup,uint16 subType,DispatchClient* client)
 {
-    mDatabase->executeSqlAsync(this,new(mQueryContainerPool.ordered_malloc()) QueryContainerBase(ofCallback,PersistentNpcQuery_MainData,client),
-                               "SELECT persistent_npcs.id,persistent_npcs.parentId,persistent_npcs.firstName,persistent_npcs.lastName,persistent_npcs.posture,persistent_npcs.state,persistent_npcs.cl,"
-                               "persistent_npcs.oX,persistent_npcs.oY,persistent_npcs.oZ,persistent_npcs.oW,persistent_npcs.x,persistent_npcs.y,persistent_npcs.z,"
-                               "persistent_npcs.type,persistent_npcs.stf_variable_id,persistent_npcs.stf_file_id,faction.name,"
-                               "persistent_npcs.moodId,persistent_npcs.family,persistent_npcs.scale "
-                               "FROM %s.persistent_npcs "
-                               "INNER JOIN %s.faction ON (persistent_npcs.faction = faction.id) "
-                               "WHERE (persistent_npcs.id = %"PRIu64")",
-                               mDatabase->galaxy(),mDatabase->galaxy(),id);
-    
+	std::stringstream sql;
+
+	selectPersistentNpcs(sql,mDatabase->galaxy());
+	sql << " WHERE (persistent_npcs.id = " << id << ")";
+
+    mDatabase->executeSqlAsync(this,new(mQueryContainerPool.ordered_malloc()) QueryContainerBase(ofCallback,PersistentNpcQuery_MainData,client),sql.str());
+}
+
+//=============================================================================
+// the attributes are read first, an npc registers its inventory with the world as soon as it is created
+
+void PersistentNpcFactory::requestObjects(ObjectFactoryCallback* ofCallback,const std::string& filter,DispatchClient* client,BulkLoadCallback done)
+{
+	std::stringstream attributeSql;
+	attributeSql << "SELECT persistent_npc_attributes.npc_id,attributes.name,persistent_npc_attributes.value,attributes.internal"
+		<< " FROM " << mDatabase->galaxy() << ".persistent_npc_attributes"
+		<< " INNER JOIN " << mDatabase->galaxy() << ".attributes ON (persistent_npc_attributes.attribute_id = attributes.id)"
+		<< " INNER JOIN " << mDatabase->galaxy() << ".persistent_npcs ON (persistent_npc_attributes.npc_id = persistent_npcs.id)"
+		<< filter << " ORDER BY persistent_npc_attributes.npc_id,persistent_npc_attributes.order";
+
+	std::stringstream sql;
+
+	selectPersistentNpcs(sql,mDatabase->galaxy());
+	sql << filter;
+
+    std::string npcSql = sql.str();
+
+    mDatabase->executeCheckedAsyncSql(attributeSql.str(), [=] (swganh::database::DatabaseResult* result) {
+        if (!result) {
+            done(false,0);
+            return;
+        }
+
+        std::shared_ptr<ObjectAttributeMap> attributes = std::make_shared<ObjectAttributeMap>();
+
+        _readObjectAttributes(*attributes,result);
+
+        mDatabase->executeCheckedAsyncSql(npcSql, [=] (swganh::database::DatabaseResult* result) {
+            if (!result) {
+                done(false,0);
+                return;
+            }
+
+            uint64 count = result->getRowCount();
+
+            for(uint64 i = 0; i < count; i++)
+            {
+                NPCObject* npc = _createPersistentNpc(result,i);
+
+                _addAttributes(npc,*attributes);
+
+                ofCallback->handleObjectReady(npc,client);
+            }
+
+            done(true,static_cast<uint32>(count));
+        });
+    });
 }
 
 //=============================================================================
 
-NPCObject* PersistentNpcFactory::_createPersistentNpc(swganh::database::DatabaseResult* result)
+NPCObject* PersistentNpcFactory::_createPersistentNpc(swganh::database::DatabaseResult* result,uint64 row)
 {
     if (!result->getRowCount()) {
     	return nullptr;
@@ -161,8 +224,9 @@ NPCObject* PersistentNpcFactory::_createPersistentNpc(swganh::database::Database
     NPCObject*		npc	;
     NpcIdentifier	npcIdentifier;
 
+    result->resetRowIndex(static_cast<int>(row));
     result->getNextRow(mNpcIdentifierBinding,(void*)&npcIdentifier);
-    result->resetRowIndex();
+    result->resetRowIndex(static_cast<int>(row));
 
     switch(npcIdentifier.mFamilyId)
     {
@@ -70,6 +70,11 @@ public:
     void			handleDatabaseJobComplete(void* ref,swganh::database::DatabaseResult* result);
     void			requestObject(ObjectFactoryCallback* ofCallback,uint64 id,uint16 subGroup,uint16 subType,DispatchClient* client);
 
+	/*	@brief loads all npcs that pass the filter, joins and a where clause on the persistent_npcs table.
+	*	One query for their attributes and one for the npcs themselves
+	*/
+    void			requestObjects(ObjectFactoryCallback* ofCallback,const std::string& filter,DispatchClient* client,BulkLoadCallback done);
+
 private:
 
     PersistentNpcFactory(swganh::app::SwganhKernel*	kernel);
@@ -77,7 +82,7 @@ private:
     void				_setupDatabindings();
     void				_destroyDatabindings();
 
-    NPCObject*			_createPersistentNpc(swganh::database::DatabaseResult* result);
+    NPCObject*			_createPersistentNpc(swganh::database::DatabaseResult* result,uint64 row = 0);
 
     static PersistentNpcFactory*	mSingleton;
     static bool						mInsFlag;
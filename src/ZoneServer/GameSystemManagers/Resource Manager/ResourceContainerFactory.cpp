@@ -143,6 +143,53 @@ void ResourceContainerFactory::requestObject(ObjectFactoryCallback* ofCallback,u
     
 }
 
+//=============================================================================
+
+void ResourceContainerFactory::requestObjects(ObjectFactoryCallback* ofCallback,const std::string& filter,DispatchClient* client,BulkLoadCallback done)
+{
+	std::stringstream attributeSql;
+	attributeSql << "SELECT object_attributes.object_id,attributes.name,object_attributes.value,attributes.internal FROM " << mDatabase->galaxy() << ".object_attributes"
+		<< " INNER JOIN " << mDatabase->galaxy() << ".attributes ON (object_attributes.attribute_id = attributes.id)"
+		<< " INNER JOIN " << mDatabase->galaxy() << ".resource_containers ON (object_attributes.object_id = resource_containers.id)"
+		<< filter << " ORDER BY object_attributes.object_id,object_attributes.order";
+
+	std::stringstream sql;
+	sql << "SELECT resource_containers.* FROM " << mDatabase->galaxy() << ".resource_containers" << filter;
+
+    std::string containerSql = sql.str();
+
+    mDatabase->executeCheckedAsyncSql(attributeSql.str(), [=] (swganh::database::DatabaseResult* result) {
+        if (!result) {
+            done(false,0);
+            return;
+        }
+
+        std::shared_ptr<ObjectAttributeMap> attributes = std::make_shared<ObjectAttributeMap>();
+
+        _readObjectAttributes(*attributes,result);
+
+        mDatabase->executeCheckedAsyncSql(containerSql, [=] (swganh::database::DatabaseResult* result) {
+            if (!result) {
+                done(false,0);
+                return;
+            }
+
+            uint32 count = static_cast<uint32>(result->getRowCount());
+
+            for(uint32 i = 0; i < count; i++)
+            {
+                ResourceContainer* container = _createResourceContainer(result);
+
+                _addAttributes(container,*attributes);
+
+                ofCallback->handleObjectReady(container,client);
+            }
+
+            done(true,count);
+        });
+    });
+}
+
 //=============================================================================>>
 
 ResourceContainer* ResourceContainerFactory::_createResourceContainer(swganh::database::DatabaseResult* result)
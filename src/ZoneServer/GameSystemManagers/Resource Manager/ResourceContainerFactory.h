@@ -67,6 +67,11 @@ public:
     void			handleDatabaseJobComplete(void* ref,swganh::database::DatabaseResult* result);
     void			requestObject(ObjectFactoryCallback* ofCallback,uint64 id,uint16 subGroup,uint16 subType,DispatchClient* client);
 
+	/*	@brief loads all resource containers that pass the filter, joins and a where clause on the resource_containers table.
+	*	One query for their attributes and one for the containers themselves
+	*/
+    void			requestObjects(ObjectFactoryCallback* ofCallback,const std::string& filter,DispatchClient* client,BulkLoadCallback done);
+
 	/*	@brief saves the location of an Object to the db including its parent
 	*	/param object this is the object from which we save the location
 	*/
@@ -73,6 +73,7 @@ void SpatialIndexManager::Shutdown()
 }
 
 SpatialIndexManager::SpatialIndexManager()
+    : mFrame(1)
 {
     mSpatialGrid = new zmap();
     gMessageLib->setGrid(mSpatialGrid);
@@ -176,6 +177,9 @@ void SpatialIndexManager::UpdateObject(Object *updateObject)
 		LOG(error) << "SpatialIndexManager::UpdateObject ghost panik !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!";
 	}
 
+    // we moved, range queries see the new position this frame already
+    updateObject->invalidateWorldPosition();
+
     uint32 oldBucket = updateObject->getGridBucket();
 
     uint32 newBucket = getGrid()->getCellId(updateObject->getWorldPosition().x, updateObject->getWorldPosition().z);
@@ -946,10 +950,9 @@ void SpatialIndexManager::createInWorld(Object* object)
 //
 // get the Objects in range of the player ie everything in the Object Bucket
 // NO players, NO creatures, NO regions
+// visitObjectsInRange itself is a template in the header, these are its out of line parts
 //
-void SpatialIndexManager::getObjectsInRange(const Object* const object, ObjectSet* result_set, uint32 object_types, float range, bool cell_content) {
-    ObjectList 	result_list;
-
+uint32 SpatialIndexManager::_getGridRange(float range) {
     //see that we do not query more grids than necessary
     uint32_t CustomRange = range / (MAPWIDTH/GRIDWIDTH);
 
@@ -961,61 +964,40 @@ void SpatialIndexManager::getObjectsInRange(const Object* const object, ObjectSe
         CustomRange = 1;
     }
 
-    glm::vec3 position = object->getWorldPosition();
-    getGrid()->GetCustomRangeCellContents(getGrid()->getCellId(position.x, position.z), CustomRange, &result_list, Bucket_Objects);
-
-    std::for_each(result_list.begin(), result_list.end(), [object, position, result_set, object_types, range, cell_content] (Object* range_object) {
-        if (range_object == object) {
-            return;
-        }
-
-        ObjectType type = range_object->getType();
+    return CustomRange;
+}
 
-        if ((range_object->getType() & object_types) == static_cast<uint32_t>(type)) {
-            if (glm::distance(object->getWorldPosition(), range_object->getWorldPosition()) <= range) {
-                result_set->insert(range_object);
-            }
+void SpatialIndexManager::_visitBuildingContent(Object* building, const std::function<void (Object* object)>& visit) {
+    static_cast<BuildingObject*>(building)->ViewObjects(nullptr, 0, false, [&visit] (Object* child) {
+        // players in cells are in the grid, too
+        if (child->getGridBucket() == 0xffffffff) {
+            visit(child);
         }
+    });
+}
 
-        // if its a building, add objects of our types it contains if wished
-        if(type == ObjType_Building && cell_content) {
-            ObjectList cells = static_cast<BuildingObject*>(range_object)->getAllCellChilds();
-
-            std::for_each(cells.begin(), cells.end(), [=] (Object* cell) {
-                ObjectType type = cell->getType();
-
-                if ((type & object_types) == static_cast<uint32_t>(type)) {
-                    TangibleObject* tangible = static_cast<TangibleObject*>(cell);
-
-                    glm::vec3 tangible_position = tangible->getWorldPosition();
+void SpatialIndexManager::getObjectsInRange(const Object* const object, ObjectSet* result_set, uint32 object_types, float range, bool cell_content) {
+    visitObjectsInRange(object, object_types, range, cell_content, [result_set] (Object* range_object, float) {
+        result_set->insert(range_object);
+    });
+}
 
-                    if (glm::distance(tangible_position, position) <= range) {
-                        result_set->insert(tangible);
-                    }
-                }
-            });
-        }
+void SpatialIndexManager::getObjectsInRange(const Object* const object, ObjectVector* result, uint32 object_types, float range, bool cell_content) {
+    visitObjectsInRange(object, object_types, range, cell_content, [result] (Object* range_object, float) {
+        result->push_back(range_object);
     });
 }
 
 void SpatialIndexManager::viewCreaturesInRange(const Object* const object, std::function<void (Object* const creature)> callback)
 {
-	ObjectList result_list;
-	
-	getGrid()->GetViewingRangeCellContents(object->getGridBucket(), &result_list, (Bucket_Creatures&Bucket_Players));
-
-    std::for_each(result_list.begin(), result_list.end(), [&] (Object* creature) {
+	getGrid()->VisitRangeCellContents(object->getGridBucket(), getGrid()->getViewRange(), (Bucket_Creatures&Bucket_Players), [&] (Object* creature) {
 		callback(creature);
 	});
 }
 
 void SpatialIndexManager::viewObjectsInRange(const Object* const object, std::function<void (Object* const object)> callback)
 {
-	ObjectList result_list;
-	
-	getGrid()->GetViewingRangeCellContents(object->getGridBucket(), &result_list, Bucket_Objects);// (Bucket_Creatures&Bucket_Players));
-
-    std::for_each(result_list.begin(), result_list.end(), [&] (Object* creature) {
+	getGrid()->VisitRangeCellContents(object->getGridBucket(), getGrid()->getViewRange(), Bucket_Objects, [&] (Object* creature) {// (Bucket_Creatures&Bucket_Players));
 		callback(creature);
 	});
 }
@@ -1023,34 +1005,21 @@ void SpatialIndexManager::viewObjectsInRange(const Object* const object, std::fu
 
 void SpatialIndexManager::viewPlayersInRange(const Object* const object, std::function<void (Object* const player)> callback)
 {
-	ObjectList result_list;
-	
-	getGrid()->GetViewingRangeCellContents(object->getGridBucket(), &result_list, (Bucket_Players));
-
-    std::for_each(result_list.begin(), result_list.end(), [&] (Object* player) {
+	getGrid()->VisitRangeCellContents(object->getGridBucket(), getGrid()->getViewRange(), (Bucket_Players), [&] (Object* player) {
 		callback(player);
 	});
 }
 
 void SpatialIndexManager::viewAllInRange(const Object* const object, std::function<void (Object* const object)> callback)
 {
-	ObjectList result_list;
-	
-	getGrid()->GetViewingRangeCellContents(object->getGridBucket(), &result_list, (Bucket_Players&Bucket_Creatures&Bucket_Players));
-
-    std::for_each(result_list.begin(), result_list.end(), [&] (Object* all) {
+	getGrid()->VisitRangeCellContents(object->getGridBucket(), getGrid()->getViewRange(), (Bucket_Players&Bucket_Creatures&Bucket_Players), [&] (Object* all) {
 		callback(all);
 	});
 }
 
 void SpatialIndexManager::getPlayersInRange(const Object* const object, PlayerObjectSet* result_set, bool cell_content) {
     //please note that players are always in the grid, even if in a cell!!!!
-    ObjectList result_list;
-    glm::vec3 position = object->getWorldPosition();
-
-	getGrid()->GetPlayerViewingRangeCellContents(object->getGridBucket(), &result_list);
-
-    std::for_each(result_list.begin(), result_list.end(), [object, result_set, cell_content] (Object* player) {
+	getGrid()->VisitPlayerRangeCellContents(object->getGridBucket(), getGrid()->getViewRange(), [object, result_set, cell_content] (Object* player) {
         if (object == player) {
             return;
         }
@@ -1063,10 +1032,17 @@ void SpatialIndexManager::getPlayersInRange(const Object* const object, PlayerOb
 
 
 void SpatialIndexManager::sendToPlayersInRange(const Object* const object, bool cellContent, std::function<void (PlayerObject* player)> callback) {
-    PlayerObjectSet		in_range_players;
-    gSpatialIndexManager->getPlayersInRange(object, &in_range_players, cellContent);
+    // every player is in one grid cell only, no need to collect them into a set first
+	getGrid()->VisitPlayerRangeCellContents(object->getGridBucket(), getGrid()->getViewRange(), [&] (Object* player) {
+        if (object == player) {
+            return;
+        }
 
-    std::for_each(in_range_players.begin(), in_range_players.end(), [=] (PlayerObject* target) {
+        if (player->getParentId() && !cellContent) {
+            return;
+        }
+
+        PlayerObject* target = (static_cast<CreatureObject*>(player))->GetGhost();
         if (target->isConnected()) {
             callback(target);
         }
@@ -1107,10 +1083,7 @@ uint64 SpatialIndexManager::getObjectMainParent(Object* object) {
 // send to all players in chatrange
 void SpatialIndexManager::sendToChatRange(Object* container, std::function<void (PlayerObject* const player)> callback) {
     //get the Objects and unregister as necessary
-    ObjectListType player_list;
-    getGrid()->GetChatRangeCellContents(container->getGridBucket(), &player_list);
-
-    std::for_each(player_list.begin(), player_list.end(), [callback] (Object* object) {
+    getGrid()->VisitPlayerRangeCellContents(container->getGridBucket(), getGrid()->getChatRange(), [&callback] (Object* object) {
 		callback((static_cast<CreatureObject*>(object))->GetGhost());
     });
 }
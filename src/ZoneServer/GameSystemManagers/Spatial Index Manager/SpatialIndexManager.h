@@ -30,6 +30,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 
 //#include "ZoneServer/Objects/Object/ObjectFactoryCallback.h"
 
+#include <functional>
 #include <list>
 #include <map>
 #include <vector>
@@ -86,6 +87,11 @@ class SpatialIndexManager
 		// retrieve spatial index for this zone
 		zmap*					getGrid(){ return mSpatialGrid; }
 
+		/*	@brief	starts a new frame, world positions cached by range queries are computed again from here on
+		*/
+		void					beginFrame(){ if(++mFrame == 0) mFrame = 1; }
+		uint32					getFrame() const { return mFrame; }
+
 		// add / delete an object, make sure to cleanup any other references
 		float					_GetMessageHeapLoadViewingRange();
 		
@@ -129,8 +135,19 @@ class SpatialIndexManager
         
 		
 
+		/*	@brief	calls visitor(object, distance_squared) for every object of objTypes within range of object, without collecting them first
+		*	@param	cellContent	whether the contents of buildings in range are visited, too
+		*	the visitor is a template parameter so it is called directly and never copied into a std::function. The distances
+		*	are compared squared and world positions are cached for the frame, nothing is allocated
+		*/
+		template<typename Visitor>
+		void					visitObjectsInRange(const Object* const object, uint32 objTypes, float range, bool cellContent, Visitor&& visitor);
+
 		//cave performs a range check
 		void					getObjectsInRange(const Object* const object,ObjectSet* resultSet,uint32 objTypes,float range, bool cellContent);
+
+		//appends to the vector, keep it around between calls to reuse its capacity
+		void					getObjectsInRange(const Object* const object,ObjectVector* result,uint32 objTypes,float range, bool cellContent);
 		void					getPlayersInRange(const Object* const object,PlayerObjectSet* resultSet, bool cellContent);
 
 		void					viewCreaturesInRange(const Object* const object, std::function<void (Object* const creature)> callback);
@@ -179,6 +196,13 @@ class SpatialIndexManager
 		void					_CheckObjectIterationForDestruction(Object* toBeTested, Object* toBeUpdated);
 		void					_ObjectCreationIteration(std::list<Object*>* FinalList, Object* updateObject);
 		void					_CheckObjectIterationForCreation(Object* toBeTested, Object* toBeUpdated);
+
+		//the number of grid rows around a position that cover range
+		uint32					_getGridRange(float range);
+
+		//calls visit with the contents of a building that are not in the grid themselves, visit only holds a reference
+		//so it fits the small buffer of the std::function
+		void					_visitBuildingContent(Object* building, const std::function<void (Object* object)>& visit);
 		
 		
 		
@@ -188,6 +212,8 @@ class SpatialIndexManager
 		
 		zmap*							mSpatialGrid;
 
+		uint32							mFrame;
+
 		utils::ActiveObject				active_;
 		
 		//Anh_Utils::Scheduler*			mSubsystemScheduler;
@@ -196,6 +222,46 @@ class SpatialIndexManager
 		
 };
 
+//======================================================================================================================
+
+template<typename Visitor>
+void SpatialIndexManager::visitObjectsInRange(const Object* const object, uint32 object_types, float range, bool cell_content, Visitor&& visitor)
+{
+    uint32 frame = mFrame;
+    glm::vec3 position = object->getWorldPosition(frame);
+    float range_squared = range * range;
+
+    auto check_in_range = [&] (Object* candidate) {
+        if (candidate == object) {
+            return;
+        }
+
+        ObjectType type = candidate->getType();
+
+        if ((type & object_types) != static_cast<uint32_t>(type)) {
+            return;
+        }
+
+        glm::vec3 delta = candidate->getWorldPosition(frame) - position;
+        float distance_squared = glm::dot(delta, delta);
+
+        if (distance_squared <= range_squared) {
+            visitor(candidate, distance_squared);
+        }
+    };
+
+    getGrid()->VisitRangeCellContents(getGrid()->getCellId(position.x, position.z), _getGridRange(range), Bucket_Objects, [&] (Object* range_object) {
+        check_in_range(range_object);
+
+        // if its a building, visit objects of our types it contains if wished
+        if(range_object->getType() == ObjType_Building && cell_content) {
+            _visitBuildingContent(range_object, [&check_in_range] (Object* child) {
+                check_in_range(child);
+            });
+        }
+    });
+}
+
 
 
 //======================================================================================================================
@@ -2,23 +2,63 @@
 
 #include <cassert>
 #include <algorithm>
+#include <chrono>
+#include <iterator>
+
+#include <boost/geometry.hpp>
+#include <boost/geometry/index/rtree.hpp>
 
 #include "ZoneServer/Objects/Object/Object.h"
 #include "ZoneServer/Objects/RegionObject.h"
 //#include "PlayerObject.h"
 
-using std::find_if;
-using std::for_each;
-using std::remove_if;
 using std::shared_ptr;
 
+namespace bgi = boost::geometry::index;
+
+typedef boost::geometry::model::point<float, 2, boost::geometry::cs::cartesian>	RegionPoint;
+typedef boost::geometry::model::box<RegionPoint>								RegionBox;
+typedef std::pair<RegionBox, RegionObject*>										RegionTreeEntry;
 
+struct RegionIndex	{
+    bgi::rtree<RegionTreeEntry, bgi::rstar<16>>	tree;
+
+    // the rectangle every region went in with, needed to take it out again
+    std::unordered_map<uint64, RegionBox>		bounds;
+
+    // the regions containing the object of the current updateRegions, reused between calls
+    std::vector<RegionTreeEntry>				found;
+};
+
+namespace	{
+    // the rectangle isObjectInRegionBoundary_ tests, the height spans x and the width z
+    RegionBox getRegionBounds(RegionObject* region)
+    {
+        return RegionBox(RegionPoint(region->mPosition.x, region->mPosition.z),
+                         RegionPoint(region->mPosition.x + region->getHeight(), region->mPosition.z + region->getWidth()));
+    }
+
+    // log the region stats every this many updates
+    const uint64 kRegionStatsInterval = 100000;
+}
 
 
 zmap* zmap::ZMAP = NULL;
 
 
+uint32 ObjectGridSlots::GetSlot(const Object* object)
+{
+    return object->getGridSlot();
+}
+
+void ObjectGridSlots::SetSlot(Object* object, uint32 slot)
+{
+    object->setGridSlot(slot);
+}
+
 zmap::zmap()
+    : mCells(kCellCount)
+    , mRegionIndex(new RegionIndex())
 {
     mCurrentSubCellID = 0;
 
@@ -26,88 +66,73 @@ zmap::zmap()
 
     viewRange = VIEWRANGE;
     chatRange = CHATRANGE;
-
-    uint32 x = 0, i = 0, j = 0;
-
-
-    // Setup the lookup array...
-
-    for (x = 0; x <= GRIDWIDTH; x++) {
-        for (j = 0; j <= GRIDHEIGHT; j++) {
-            zmap_lookup[x][j] = i;
-            ObjectStruct* bucket = new(ObjectStruct);
-            ZMapCells.insert(std::make_pair(i,bucket));
-            i++;
-
-        }
-    }
 }
 
 zmap::~zmap()
 {
-    uint32 x = 0, i = 0, j = 0;
+}
 
-    for(x = 0; x <= GRIDWIDTH; x++)
-    {
-        for(j = 0; j <= GRIDHEIGHT; j++)
-        {
-            std::map<uint32, ObjectStruct*>::iterator it = ZMapCells.find(i);
+// the regions the object is in are looked up in the index, the ones it entered and left are the
+// difference to the regions it was in before, both sorted by id
+void zmap::updateRegions(Object* object) {
+    auto start = std::chrono::steady_clock::now();
 
+    std::vector<RegionTreeEntry>& found = mRegionIndex->found;
+    found.clear();
 
-            (*it).second->Creatures.clear();
-            (*it).second->Players.clear();
-            (*it).second->Objects.clear();
-            (*it).second->SubCells.clear();
+    mRegionIndex->tree.query(bgi::intersects(RegionPoint(object->mPosition.x, object->mPosition.z)), std::back_inserter(found));
 
-            delete(	ZMapCells[i]);
-            i++;
+    std::sort(found.begin(), found.end(), [] (const RegionTreeEntry& a, const RegionTreeEntry& b) {
+        return a.second->getId() < b.second->getId();
+    });
 
-        }
-    }
-}
+    Uint64Set& region_set = object->zmapSubCells;
 
-void zmap::updateRegions(Object* object) {
-	// Check the regions the object is currently in and remove any it's no longer in.
-	Uint64Set& region_set = object->zmapSubCells;
-    
-    auto region_set_end = region_set.end();
-    auto region_set_it = region_set.begin();
+    auto previous = region_set.begin();
+    auto current = found.begin();
 
-    while (region_set_it != region_set_end) {
-        auto region = findRegion(*region_set_it);
+    while (previous != region_set.end() || current != found.end()) {
+        if (current == found.end() || (previous != region_set.end() && *previous < current->second->getId())) {
+            // not in there anymore - the region might be gone altogether
+            auto region = findRegion(*previous);
+            region_set.erase(previous++);
 
-        if (!region) {
-            region_set.erase(region_set_it++);
+            if (region) {
+                region->onObjectLeave(object);
+                mRegionStats.mLeaves++;
+            }
             continue;
         }
 
-        if (! isObjectInRegionBoundary_(object, region)) {
-            region->onObjectLeave(object);
-            region_set.erase(region_set_it++);
+        if (previous == region_set.end() || current->second->getId() < *previous) {
+            region_set.insert(previous, current->second->getId());
+            current->second->onObjectEnter(object);
+            mRegionStats.mEnters++;
+
+            ++current;
             continue;
         }
 
-        ++region_set_it;
+        // still in there
+        ++previous;
+        ++current;
     }
 
-    // Now check for any new regions the object may have entered.
-    auto it = ZMapCells.find(object->getGridBucket());
-    if (it == ZMapCells.end()) {
-        assert(false && "Object has reference to an invalid grid bucket!");
-        return;
-    }
+    uint64 micros = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
 
-    SharedObjectListType& list = (*it).second->SubCells;
-    for_each(list.begin(), list.end(), [this, &region_set, object] (shared_ptr<Object> list_object) {
-        shared_ptr<RegionObject> region = std::static_pointer_cast<RegionObject>(list_object);
+    mRegionStats.mQueries++;
+    mRegionStats.mQueryMicros += micros;
+    mRegionStats.mPeakQueryMicros = std::max(mRegionStats.mPeakQueryMicros, micros);
 
-        // If the object is not already in the region and is now within 
-        // the region's bounds, add it.
-        if (region_set.find(region->getId()) == region_set.end() && isObjectInRegionBoundary_(object, region)) {
-            object->zmapSubCells.insert(region->getId());
-            region->onObjectEnter(object);
-        }
-    });
+    if ((mRegionStats.mQueries % kRegionStatsInterval) == 0) {
+        _logRegionStats();
+    }
+}
+
+void zmap::_logRegionStats() {
+    LOG(info) << "zmap::updateRegions : " << mRegions.size() << " regions, " << mRegionStats.mQueries << " updates averaging "
+              << (mRegionStats.mQueryMicros / std::max<uint64>(1, mRegionStats.mQueries)) << "us, peak " << mRegionStats.mPeakQueryMicros
+              << "us, " << mRegionStats.mEnters << " enters, " << mRegionStats.mLeaves << " leaves";
 }
 
 bool zmap::isObjectInRegionBoundary_(Object* object, shared_ptr<RegionObject> region) {
@@ -125,146 +150,97 @@ bool zmap::isObjectInRegionBoundary_(Object* object, shared_ptr<RegionObject> re
 
 
 void zmap::addRegion(std::shared_ptr<RegionObject> region) {
-    uint32_t low_x = region->mPosition.x;
-    uint32_t low_z = region->mPosition.z;
-    uint32_t width = region->getWidth();
-    uint32_t height = region->getHeight();
-
-    uint32_t lowerLeft	= _getCellId(low_x,			low_z);
-    uint32_t lowerRight	= _getCellId(low_x+width,	low_z);
-    uint32_t upperLeft	= _getCellId(low_x,			low_z+height);
-    uint32_t upperRight	= _getCellId(low_x+width,	low_z+height);
-
-    int cellCountZ = (upperLeft - lowerLeft)/GRIDWIDTH;
-    int cellCountX = (lowerRight - lowerLeft);
-	assert(cellCountX >= 0 && "zmap zellcount");
-	assert(cellCountZ >= 0 && "zmap zellcount");
-
-    for (int i=0; i <= cellCountZ; ++i) {
-        for (int j=0; j <= cellCountX; ++j) {
-            auto it = ZMapCells.find((lowerLeft + j + i * GRIDWIDTH));
-            (*it).second->SubCells.push_back(region);
-        }
-    }
+    // a region added again replaces the one we had
+    RemoveRegion(region->getId());
+
+    RegionBox bounds = getRegionBounds(region.get());
 
-	subCells.insert(std::make_pair(region->getId(), region));
+    mRegionIndex->tree.insert(std::make_pair(bounds, region.get()));
+    mRegionIndex->bounds[region->getId()] = bounds;
 
-    return;
+    mRegions[region->getId()] = region;
 }
 
 std::shared_ptr<RegionObject> zmap::findRegion(uint64_t region_id) {
-    auto it = find_if(subCells.begin(), subCells.end(), [region_id] (const SubCellMap::value_type& map_entry) {
-        return map_entry.second->getId() == region_id;
-    });
+    auto it = mRegions.find(region_id);
 
-    // If we found the region in the cell map return it, otherwise return a nullptr.
-    return (it != subCells.end()) ? (*it).second : nullptr;
+    // If we found the region return it, otherwise return a nullptr.
+    return (it != mRegions.end()) ? (*it).second : nullptr;
 }
 
 bool zmap::isObjectInRegion(Object* object, uint64 region_id) {
-    auto it = find_if(subCells.begin(), subCells.end(), [this, object, region_id] (const SubCellMap::value_type& map_entry) {
-        return isObjectInRegionBoundary_(object, map_entry.second);
-    });
+    auto region = findRegion(region_id);
 
-    // If we found the region in the cell map return it, otherwise return a nullptr.
-    return it != subCells.end();
+    return region && isObjectInRegionBoundary_(object, region);
 }
 
 void zmap::RemoveRegion(uint64 regionId) {
-    SubCellMap::iterator it	 = subCells.begin();
-    SubCellMap::iterator end = subCells.end();
-
-    while(it != end)    {
-		if((*it).second->getId() == regionId)        {
-            //get cells
-			uint32 lowerLeft  = _getCellId((*it).second->mPosition.x, (*it).second->mPosition.z);
-			uint32 lowerRight = _getCellId((*it).second->mPosition.x + (*it).second->getWidth(),	(*it).second->mPosition.z);
-			uint32 upperLeft  = _getCellId((*it).second->mPosition.x, (*it).second->mPosition.z + (*it).second->getHeight());
-			uint32 upperRight = _getCellId((*it).second->mPosition.x + (*it).second->getWidth(),	(*it).second->mPosition.z + (*it).second->getHeight());
-
-            unsigned int cellCountZ = (lowerLeft - upperLeft)/GRIDWIDTH;
-            unsigned int cellCountX = (lowerLeft - lowerRight);
-
-            for(unsigned int i=0; i < cellCountZ; i++)	{
-                for(unsigned int j=0; j < cellCountX; j++)	{
-                    std::map<uint32, ObjectStruct*>::iterator it = ZMapCells.find((lowerLeft + j + i * GRIDWIDTH));
-
-                    SharedObjectListType			cellList	= (*it).second->SubCells;
-                    SharedObjectListType::iterator	CellListit	= cellList.begin();
-
-                    while(CellListit != cellList.begin())	{
-						if((*CellListit)->getId() == regionId)	{
-                            cellList.erase(CellListit);
-                            break;
-                        }
-                        CellListit++;
-                    }
-                }
-            }
-
-            it = subCells.erase(it);
-			continue;
-        }
-        ++it;
+    auto it = mRegions.find(regionId);
+    if (it == mRegions.end()) {
+        return;
     }
+
+    auto bounds = mRegionIndex->bounds.find(regionId);
+    mRegionIndex->tree.remove(std::make_pair(bounds->second, (*it).second.get()));
+    mRegionIndex->bounds.erase(bounds);
+
+    // objects still in there drop it on their next update
+    mRegions.erase(it);
 }
 
 uint32 zmap::_getCellId(float x, float z)
 {
-    return zmap_lookup[( ( ((uint32)z) + (MAPWIDTH/2) )/GRIDWIDTH)][((((uint32)x) + (MAPHEIGHT/2))/GRIDHEIGHT)];
+    // the rows of the grid are GRIDHEIGHT+1 cells apart, the same ids the lookup table handed out
+    return ((((uint32)z) + (MAPWIDTH/2))/GRIDWIDTH) * (GRIDHEIGHT+1) + ((((uint32)x) + (MAPHEIGHT/2))/GRIDHEIGHT);
 }
 
-
-bool zmap::RemoveObject(Object *removeObject)
+uint32 zmap::_getBucketList(Object* object)
 {
-    uint32 cellId = removeObject->getGridBucket();
-
-    if(!GetCellValidFlag(cellId))    {
-        DLOG(info) << "zmap::RemoveObject :: bucket " << cellId << " NOT valid";
-        return false;
-    }
-
-    //DLOG(info) << "zmap::RemoveObject :: " << removeObject->getId() << " bucket " << cellId << " ";
-
-    ObjectListType *list;
-
-    std::map<uint32, ObjectStruct*>::iterator it = ZMapCells.find(cellId);
-
-    switch(removeObject->getType())
+    switch(object->getType())
     {
     case ObjType_Player:
-    {
-        list = &(*it).second->Players;
-    }
-    break;
+        return 2;
 
     case ObjType_Creature:
     case ObjType_NPC:
-    {
-        list = &(*it).second->Creatures;
-    }
-    break;
+        return 0;
 
     default:
-    {
-        list = &(*it).second->Objects;
+        return 1;
     }
-    break;
+}
+
+uint32 zmap::_getBucketMask(uint32 type)
+{
+    if(type == 0)    {
+        assert(false && "zmap::GetCellContents QueryType must NOT be 0");
+        return 0;
     }
 
-	bool found = false;
-    for(ObjectListType::iterator remove_it = list->begin(); remove_it != list->end(); remove_it++)    {
-        if((*remove_it)->getId() == removeObject->getId())      {
-            list->erase(remove_it);
-			found = true;
-            break;
-        }
+    // the type is only checked for being set, any type gets all buckets
+    return Bucket_Creatures | Bucket_Objects | Bucket_Players;
+}
+
+void zmap::_insertObject(Object* object, uint32 CellID)
+{
+    object->setGridBucket(CellID);
+    mCells.Insert(CellID, _getBucketList(object), object);
+}
+
+
+bool zmap::RemoveObject(Object *removeObject)
+{
+    uint32 cellId = removeObject->getGridBucket();
+
+    if(!GetCellValidFlag(cellId))    {
+        DLOG(info) << "zmap::RemoveObject :: bucket " << cellId << " NOT valid";
+        return false;
+    }
+
+    // was removeObject part of the bucket?
+    if(!mCells.Remove(cellId, _getBucketList(removeObject), removeObject))	{
+        return false;
     }
-	
-	// was removeObject part of the bucket?
-	if(!found)	{
-		return false;
-	}
 
     //make sure we can use the mGridBucket to determine what bucket we *are* in
     //so we do not have to search the list on insert
@@ -282,11 +258,10 @@ bool zmap::RemoveObject(Object *removeObject)
     while(set_it != region_set->end())    {
         auto region = findRegion(*set_it);
 
-        if (!region) {
-		    region_set->erase(set_it++);		
+        if (region) {
+		    region->onObjectLeave(removeObject);
         }
 
-		region->onObjectLeave(removeObject);
 		region_set->erase(set_it++);	
     }
 	return true;
@@ -296,62 +271,24 @@ bool zmap::RemoveObject(Object *removeObject)
 
 void zmap::GetCellContents(uint32 CellID, ObjectListType* list, uint32 type)
 {
-    if(type == 0)    {
-        assert(false && "zmap::GetCellContents QueryType must NOT be 0");
-    }
-    
-	if(CellID > (GRIDWIDTH*GRIDHEIGHT))    {
+    uint32 mask = _getBucketMask(type);
+
+	if(!GetCellValidFlag(CellID))    {
         DLOG(info) << "zmap::GetCellContents :: bucket " << CellID << " out of grid";
         return;
     }
 
-    //DLOG(info) << "zmap::GetCellContents :: bucket " << CellID << " type : " << type;
-
-    ObjectListType::iterator it = list->begin();
-
-    std::map<uint32, ObjectStruct*>::iterator mapIt = ZMapCells.find(CellID);
-
-    //make a copy of the list !!!!
-    //splice removes the entries!!!
-    ObjectListType listCopy;
-
-    if(type&&Bucket_Objects)    {
-        listCopy = (*mapIt).second->Objects;
-        list->splice(it, listCopy);
-    }
-
-    if(type&&Bucket_Players)    {
-        listCopy = (*mapIt).second->Players;
-        list->splice(it, listCopy);
-    }
-
-    if(type&&Bucket_Creatures)    {
-        listCopy = (*mapIt).second->Creatures;
-        list->splice(it, listCopy);
-    }
-
+    mCells.Visit(CellID, mask, [list] (Object* object) { list->push_back(object); });
 }
 
 
 
 void	zmap::GetPlayerCellContents(uint32 CellID, ObjectListType* list)
 {
-    //Pesudo
-    // 1. Return list of objects in cell
-    //if(CellID) >
-
-    if(CellID > (GRIDWIDTH*GRIDHEIGHT))
+    if(!GetCellValidFlag(CellID))
         return;
 
-    ObjectListType::iterator it = list->begin();
-
-    std::map<uint32, ObjectStruct*>::iterator mapIt = ZMapCells.find(CellID);
-
-    ObjectListType listCopy;
-
-    listCopy = (*mapIt).second->Players;
-    list->splice(it, listCopy);
-
+    mCells.Visit(CellID, Bucket_Players, [list] (Object* object) { list->push_back(object); });
 }
 
 //=================================================
@@ -369,13 +306,7 @@ bool zmap::GetCellValidFlag(uint32 CellID)
 
 void	zmap::GetChatRangeCellContents(uint32 CellID, ObjectListType* list)
 {
-    GetPlayerGridContentsListRow(CellID, list);
-
-    for(int i = 1; i <= chatRange; i++)    {
-        GetPlayerGridContentsListRow(CellID + (i*GRIDWIDTH), list);
-        GetPlayerGridContentsListRow(CellID - (i*GRIDWIDTH), list);
-    }
-
+    VisitPlayerRangeCellContents(CellID, chatRange, [list] (Object* object) { list->push_back(object); });
 }
 
 //=====================================================
@@ -384,24 +315,15 @@ void	zmap::GetChatRangeCellContents(uint32 CellID, ObjectListType* list)
 //this will be done by the var iteration
 void zmap::GetGridContentsListRow(uint32 CellID, ObjectListType* list, uint32 type)
 {
-    GetCellContents(CellID,list, type);
-
-    for(int i = 1; i <= viewRange; i++)    {
-        GetCellContents(CellID + i,list, type);
-        GetCellContents(CellID - i,list, type);
-    }
+    auto collect = [list] (Object* object) { list->push_back(object); };
+    _visitCells(CellID - viewRange, (viewRange*2)+1, 1, _getBucketMask(type), collect);
 }
 
 
 void	 zmap::GetPlayerGridContentsListRow(uint32 CellID, ObjectListType* list)
 {
-    GetPlayerCellContents(CellID,list);
-
-    for(int i = 1; i <= viewRange; i++)    {
-        GetPlayerCellContents(CellID + i,list);
-        GetPlayerCellContents(CellID - i,list);
-    }
-
+    auto collect = [list] (Object* object) { list->push_back(object); };
+    _visitCells(CellID - viewRange, (viewRange*2)+1, 1, Bucket_Players, collect);
 }
 
 
@@ -412,43 +334,27 @@ void	 zmap::GetPlayerGridContentsListRow(uint32 CellID, ObjectListType* list)
 //
 void	zmap::GetPlayerGridContentsListColumnDown(uint32 CellID, ObjectListType* list)
 {
-
-    GetPlayerCellContents(CellID, list);
-
-    for(int i = 1; i <= (viewRange*2)-1; i++)    {
-        GetPlayerCellContents(CellID - (i*GRIDWIDTH), list);
-    }
+    auto collect = [list] (Object* object) { list->push_back(object); };
+    _visitCells(CellID, viewRange*2, -GRIDWIDTH, Bucket_Players, collect);
 }
 
 
 void	zmap::GetGridContentsListColumnDown(uint32 CellID, ObjectListType* list, uint32 type)
 {
-    GetCellContents(CellID, list, type);
-
-    for(int i = 1; i <= (viewRange*2)-1; i++)    {
-        GetCellContents(CellID - (i*GRIDWIDTH), list, type);
-    }
+    auto collect = [list] (Object* object) { list->push_back(object); };
+    _visitCells(CellID, viewRange*2, -GRIDWIDTH, _getBucketMask(type), collect);
 }
 
 void	zmap::GetGridContentsListColumnUp(uint32 CellID, ObjectListType* list, uint32 type)
 {
-
-    GetCellContents(CellID, list, type);
-
-    for(int i = 1; i <= (viewRange*2)-1; i++)    {
-        GetCellContents(CellID + (i*GRIDWIDTH), list, type);
-    }
+    auto collect = [list] (Object* object) { list->push_back(object); };
+    _visitCells(CellID, viewRange*2, GRIDWIDTH, _getBucketMask(type), collect);
 }
 
 void	zmap::GetPlayerGridContentsListColumnUp(uint32 CellID, ObjectListType* list)
 {
-
-    GetPlayerCellContents(CellID, list);
-
-    for(int i = 1; i <= (viewRange*2)-1; i++)    {
-        GetPlayerCellContents(CellID + (i*GRIDWIDTH), list);
-    }
-
+    auto collect = [list] (Object* object) { list->push_back(object); };
+    _visitCells(CellID, viewRange*2, GRIDWIDTH, Bucket_Players, collect);
 }
 
 
@@ -457,116 +363,61 @@ void	zmap::GetPlayerGridContentsListColumnUp(uint32 CellID, ObjectListType* list
 // when getting content on the edges just spare the *middle* (pointy) cell
 void	zmap::GetGridContentsListRowLeft(uint32 CellID, ObjectListType* list, uint32 type)
 {
-
-    GetCellContents(CellID, list, type);
-
-    for(int i = 1; i <= ((viewRange*2)-1); i++)    {
-        GetCellContents(CellID - i, list, type);
-    }
-
+    auto collect = [list] (Object* object) { list->push_back(object); };
+    _visitCells(CellID, viewRange*2, -1, _getBucketMask(type), collect);
 }
 
 void	zmap::GetPlayerGridContentsListRowLeft(uint32 CellID, ObjectListType* list)
 {
-
-    GetPlayerCellContents(CellID, list);
-
-    for(int i = 1; i <= ((viewRange*2)-1); i++)    {
-        GetPlayerCellContents(CellID - i, list);
-    }
-
+    auto collect = [list] (Object* object) { list->push_back(object); };
+    _visitCells(CellID, viewRange*2, -1, Bucket_Players, collect);
 }
 
 
 void	zmap::GetGridContentsListRowRight(uint32 CellID, ObjectListType* list, uint32 type)
 {
-
-    GetCellContents(CellID, list, type);
-
-    for(int i = 1; i <= ((viewRange*2)-1); i++)    {
-        GetCellContents(CellID + i, list, type);
-    }
-
+    auto collect = [list] (Object* object) { list->push_back(object); };
+    _visitCells(CellID, viewRange*2, 1, _getBucketMask(type), collect);
 }
 
 void	zmap::GetPlayerGridContentsListRowRight(uint32 CellID, ObjectListType* list)
 {
-
-    GetPlayerCellContents(CellID, list);
-
-    for(int i = 1; i <= ((viewRange*2)-1); i++)    {
-        GetPlayerCellContents(CellID + i, list);
-    }
-
+    auto collect = [list] (Object* object) { list->push_back(object); };
+    _visitCells(CellID, viewRange*2, 1, Bucket_Players, collect);
 }
 
 
 void	zmap::GetGridContentsListColumn(uint32 CellID, ObjectListType* list, uint32 type)
 {
-
-    GetCellContents(CellID, list, type);
-
-    for(int i = 1; i <= viewRange; i++)    {
-        GetCellContents(CellID + (i*GRIDWIDTH), list, type);
-        GetCellContents(CellID - (i*GRIDWIDTH), list, type);
-    }
-
+    auto collect = [list] (Object* object) { list->push_back(object); };
+    _visitCells(CellID - (viewRange*GRIDWIDTH), (viewRange*2)+1, GRIDWIDTH, _getBucketMask(type), collect);
 }
 
 void	zmap::GetPlayerGridContentsListColumn(uint32 CellID, ObjectListType* list)
 {
-
-    GetPlayerCellContents(CellID, list);
-
-    for(int i = 1; i <= viewRange; i++)    {
-        GetPlayerCellContents(CellID + (i*GRIDWIDTH), list);
-        GetPlayerCellContents(CellID - (i*GRIDWIDTH), list);
-    }
-
+    auto collect = [list] (Object* object) { list->push_back(object); };
+    _visitCells(CellID - (viewRange*GRIDWIDTH), (viewRange*2)+1, GRIDWIDTH, Bucket_Players, collect);
 }
 
 void	zmap::GetViewingRangeCellContents(uint32 CellID, ObjectListType* list, uint32 type)
 {
-    //gLogger->log(LogManager::DEBUG,"zmap::GetAllViewingRangeCellContents :: bucket %u", CellID);
-
-    GetGridContentsListRow(CellID, list, type);
-
-    for(int i = 1; i <= viewRange; i++)    {
-        GetGridContentsListRow(CellID + (i*GRIDWIDTH), list, type);
-        GetGridContentsListRow(CellID - (i*GRIDWIDTH), list, type);
-    }
+    VisitRangeCellContents(CellID, viewRange, type, [list] (Object* object) { list->push_back(object); });
 }
 
 void	zmap::GetPlayerViewingRangeCellContents(uint32 CellID, ObjectListType* list)
 {
-
-    GetPlayerGridContentsListRow(CellID, list);
-
-    for(int i = 1; i <= viewRange; i++)    {
-        GetPlayerGridContentsListRow(CellID + (i*GRIDWIDTH), list);
-        GetPlayerGridContentsListRow(CellID - (i*GRIDWIDTH), list);
-    }
-
+    VisitPlayerRangeCellContents(CellID, viewRange, [list] (Object* object) { list->push_back(object); });
 }
 
 
 // limited to max viewing range for now
-//
+// every row once, the middle row was queried three times before
 void	zmap::GetCustomRangeCellContents(uint32 CellID, uint32 range, ObjectListType* list, uint32 type)
 {
-    // query the grid with the custom range
-    // TODO: need any failsafes concerning the cells???
-
     if(range > VIEWRANGE)
         range = VIEWRANGE;
 
-    GetGridContentsListRow(CellID, list, type);
-
-    for(uint32 i = 0; i <= range; i++)    {
-        GetGridContentsListRow(CellID + (i*GRIDWIDTH), list, type);
-        GetGridContentsListRow(CellID - (i*GRIDWIDTH), list, type);
-    }
-
+    VisitRangeCellContents(CellID, range, type, [list] (Object* object) { list->push_back(object); });
 }
 
 
@@ -590,35 +441,7 @@ uint32 zmap::AddObject(Object *newObject)
         return finalBucket;
     }
 
-    newObject->setGridBucket(finalBucket);
-
-    ObjectListType* list;
-
-    std::map<uint32, ObjectStruct*>::iterator mapIt = ZMapCells.find(finalBucket);
-
-    switch(newObject->getType())
-    {
-    case ObjType_Player:
-    {
-        list = &(*mapIt).second->Players;
-    }
-    break;
-
-    case ObjType_Creature:
-    case ObjType_NPC:
-    {
-        list = &(*mapIt).second->Creatures;
-    }
-    break;
-
-    default:
-    {
-        list = &(*mapIt).second->Objects;
-    }
-    break;
-    }
-
-    list->push_back(newObject);
+    _insertObject(newObject, finalBucket);
 
     return finalBucket;
 }
@@ -644,37 +467,14 @@ void zmap::UpdateObject(Object *updateObject)
         return;
     }
 
+    if(!GetCellValidFlag(newBucket))    {
+        assert(false && "zmap::UpdateObject :: couldnt find grid cell :(");
+        return;
+    }
+
     //get out of old bucket
     RemoveObject(updateObject);
 
     //put into new bucket
-    updateObject->setGridBucket(newBucket);
-
-    ObjectListType* list;
-
-    std::map<uint32, ObjectStruct*>::iterator mapIt = ZMapCells.find(newBucket);
-
-    switch(updateObject->getType())
-    {
-    case ObjType_Player:
-    {
-        list = &(*mapIt).second->Players;
-    }
-    break;
-
-    case ObjType_Creature:
-    case ObjType_NPC:
-    {
-        list = &(*mapIt).second->Creatures;
-    }
-    break;
-
-    default:
-    {
-        list = &(*mapIt).second->Objects;
-    }
-    break;
-    }
-
-    list->push_back(updateObject);
+    _insertObject(updateObject, newBucket);
 }
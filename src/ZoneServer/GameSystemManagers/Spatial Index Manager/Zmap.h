@@ -7,9 +7,11 @@
 #include <map>
 #include <memory>
 #include <set>
+#include <unordered_map>
 #include <vector>
 
 #include "Utils/typedefs.h"
+#include "anh/flat_grid.h"
 
 class Object;
 class RegionObject;
@@ -32,24 +34,39 @@ enum qtype	{
 };
 
 typedef std::list<Object*> ObjectListType;
-typedef std::list<std::shared_ptr<Object>> SharedObjectListType;
+typedef std::vector<Object*> ObjectVector;
 typedef std::set<Object*> ObjectSet;
-typedef std::multimap<uint32, std::shared_ptr<RegionObject>> SubCellMap;
 
+typedef std::unordered_map<uint64, std::shared_ptr<RegionObject>> ZmapRegionMap;
+
+//the R-tree over the region rectangles, see Zmap.cpp
+struct RegionIndex;
+
+struct RegionIndexStats	{
+	RegionIndexStats() : mQueries(0), mQueryMicros(0), mPeakQueryMicros(0), mEnters(0), mLeaves(0) {}
+
+	uint64	mQueries;			// updateRegions calls
+	uint64	mQueryMicros;		// time spent in them
+	uint64	mPeakQueryMicros;
+	uint64	mEnters;
+	uint64	mLeaves;
+};
+
+//the bit of a bucket is the list it is kept in, see _getBucketList()
 enum BucketType {
 	Bucket_Creatures = 1,
 	Bucket_Objects	 = 2,
 	Bucket_Players	 = 4
 };
 
-struct ObjectStruct	{
-public:	
-	ObjectListType       Objects;
-	ObjectListType       Creatures;
-	ObjectListType       Players;
-	SharedObjectListType SubCells;
+//keeps the position of an object in its bucket list on the object itself
+struct ObjectGridSlots	{
+	static uint32	GetSlot(const Object* object);
+	static void		SetSlot(Object* object, uint32 slot);
 };
 
+typedef swganh::FlatGrid<Object*, ObjectGridSlots, 3> ObjectGrid;
+
 class zmap {
 public:
 	// Contructor & Destructor
@@ -77,6 +94,9 @@ public:
 
 	bool				isObjectInRegion(Object* object, uint64 regionid);
 	void				RemoveRegion(uint64 regionId);
+
+	uint32				getRegionCount() const { return static_cast<uint32>(mRegions.size()); }
+	const RegionIndexStats& getRegionStats() const { return mRegionStats; }
     	
 
 	//Get the contents of current cell of the player, looked up by CellID
@@ -117,8 +137,26 @@ public:
 	void				GetPlayerViewingRangeCellContents(uint32 CellID, ObjectListType* list);
 	
 	void				GetCustomRangeCellContents(uint32 CellID, uint32 range, ObjectListType* list, uint32 type);
-	
-	
+
+	/*	@brief calls visitor(Object*) for every object in the cells up to rowRange rows and viewRange columns
+	*	away from CellID, without collecting them into a list first. type is the same as with GetCellContents,
+	*	every bucket is visited for any type but 0. Every cell is visited only once.
+	*/
+	template<typename Visitor>
+	void				VisitRangeCellContents(uint32 CellID, uint32 rowRange, uint32 type, Visitor&& visitor)
+	{
+		_visitRange(CellID, rowRange, _getBucketMask(type), visitor);
+	}
+
+	template<typename Visitor>
+	void				VisitPlayerRangeCellContents(uint32 CellID, uint32 rowRange, Visitor&& visitor)
+	{
+		_visitRange(CellID, rowRange, Bucket_Players, visitor);
+	}
+
+	uint32				getViewRange() const { return viewRange; }
+	uint32				getChatRange() const { return chatRange; }
+
 
 	uint32 getCellId(float x, float z){return _getCellId(x, z);}
 
@@ -130,17 +168,50 @@ private:
 	
 	bool		isObjectInRegionBoundary_(Object* object, std::shared_ptr<RegionObject> region);
 
-	//This is the actual Hashtable that stores the data
-	typedef std::map<uint32, ObjectListType>		MapHandler;
-	
-	std::map<uint32, ObjectStruct*>					ZMapCells;
-
-
-	
-	ObjectListType									EmptyCell;//for the return of nonexisting grids
-	ObjectStruct									EmptyStruct;
-
-	uint32	zmap_lookup[GRIDWIDTH+1][GRIDHEIGHT+1]; // one extra for protection
+	void		_logRegionStats();
+
+	//the list of the bucket an object goes into
+	uint32		_getBucketList(Object* object);
+
+	//the lists a query type asks for
+	uint32		_getBucketMask(uint32 type);
+
+	void		_insertObject(Object* object, uint32 CellID);
+
+	//calls the visitor with the objects of count cells starting at CellID, step cells apart
+	template<typename Visitor>
+	void		_visitCells(uint32 CellID, int32 count, int32 step, uint32 mask, Visitor& visitor)
+	{
+		for(int32 i = 0; i < count; i++)	{
+			uint32 cell = CellID + (i*step);
+			if(GetCellValidFlag(cell))	{
+				mCells.Visit(cell, mask, visitor);
+			}
+		}
+	}
+
+	template<typename Visitor>
+	void		_visitRange(uint32 CellID, uint32 rowRange, uint32 mask, Visitor& visitor)
+	{
+		if(!mask)	{
+			return;
+		}
+
+		for(int32 row = -static_cast<int32>(rowRange); row <= static_cast<int32>(rowRange); row++)	{
+			_visitCells(CellID + (row*GRIDWIDTH) - viewRange, (viewRange*2)+1, 1, mask, visitor);
+		}
+	}
+
+	//one cell more in either direction for protection, the same count the lookup table had
+	static const uint32	kCellCount = (GRIDWIDTH+1)*(GRIDHEIGHT+1);
+
+	//the objects of every cell, indexed by the cell id
+	ObjectGrid										mCells;
+
+	//all regions by id, and their rectangles in the index
+	ZmapRegionMap									mRegions;
+	std::unique_ptr<RegionIndex>					mRegionIndex;
+	RegionIndexStats								mRegionStats;
 		
 
 	uint32		mCurrentSubCellID;
@@ -152,7 +223,6 @@ protected:
 	//FILE*			ZoneLogs;
 
 	static zmap*	ZMAP;
-	SubCellMap		subCells;
 
 
 };
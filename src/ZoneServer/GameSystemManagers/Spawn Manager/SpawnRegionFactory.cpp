@@ -37,6 +37,37 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 
 //=============================================================================
 
+namespace {
+
+void selectSpawnRegions(std::stringstream& sql,const char* galaxy)
+{
+    sql << "SELECT spawn_regions.id,spawn_regions.spawn_type,planet_regions.region_name,planet_regions.region_file,planet_regions.x,planet_regions.z,"
+        << "planet_regions.width,planet_regions.height,spawn_regions.parent_id,spawn_regions.mission"
+        << " FROM " << galaxy << ".spawn_regions"
+        << " INNER JOIN " << galaxy << ".planet_regions ON (spawn_regions.region_id = planet_regions.region_id)";
+}
+
+std::shared_ptr<SpawnRegion> createSpawnRegion(std::unique_ptr<sql::ResultSet>& result_set)
+{
+    std::shared_ptr<SpawnRegion> spawn = std::make_shared<SpawnRegion>();
+    spawn->setId(result_set->getUInt64(1));
+    spawn->setSpawnType(result_set->getUInt(2));
+    spawn->setRegionName(result_set->getString(3));
+    spawn->setNameFile(result_set->getString(4));
+    spawn->mPosition.x = result_set->getDouble(5);
+    spawn->mPosition.z = result_set->getDouble(6);
+    spawn->setWidth(result_set->getDouble(7));
+    spawn->setHeight(result_set->getDouble(8));
+    spawn->setMission(result_set->getUInt(9));
+    spawn->setLoadState(LoadState_Loaded);
+
+    return spawn;
+}
+
+}
+
+//=============================================================================
+
 SpawnRegionFactory::SpawnRegionFactory(swganh::app::SwganhKernel*	kernel) : FactoryBase(kernel) {}
 
 //=============================================================================
@@ -52,12 +83,10 @@ void SpawnRegionFactory::handleDatabaseJobComplete(void* ref,swganh::database::D
 void SpawnRegionFactory::requestObject(ObjectFactoryCallback* ofCallback,uint64 id,uint16 subGroup,uint16 subType,DispatchClient* client)
 {
     // setup our statement
-    int8 sql[128];
-    sprintf(sql,"SELECT spawn_regions.id,spawn_regions.spawn_type,planet_regions.region_name,planet_regions.region_file,planet_regions.x,planet_regions.z,"
-            "planet_regions.width,planet_regions.height,spawn_regions.parent_id,spawn_regions.mission"
-            " FROM %s.spawn_regions"
-            " INNER JOIN %s.planet_regions ON (spawn_regions.region_id = planet_regions.region_id)"
-            " WHERE (spawn_regions.id = %"PRIu64")",mDatabase->galaxy(),mDatabase->galaxy(),id);
+    std::stringstream sql;
+
+    selectSpawnRegions(sql,mDatabase->galaxy());
+    sql << " WHERE (spawn_regions.id = " << id << ")";
 
     mDatabase->executeAsyncSql(sql, [=] (swganh::database::DatabaseResult* result) {
         if (!result) {
@@ -70,20 +99,36 @@ void SpawnRegionFactory::requestObject(ObjectFactoryCallback* ofCallback,uint64
             LOG(warning) << "Unable to load SpawnRegion with region id: " << id;
             return;
         }
-        std::shared_ptr<SpawnRegion> spawn = std::make_shared<SpawnRegion>();
-        spawn->setId(result_set->getUInt64(1));
-        spawn->setSpawnType(result_set->getUInt(2));
-        spawn->setRegionName(result_set->getString(3));
-        spawn->setNameFile(result_set->getString(4));
-        spawn->mPosition.x = result_set->getDouble(5);
-        spawn->mPosition.z = result_set->getDouble(6);
-        spawn->setWidth(result_set->getDouble(7));
-        spawn->setHeight(result_set->getDouble(8));
-        spawn->setMission(result_set->getUInt(9));
-        spawn->setLoadState(LoadState_Loaded);
-
-        ofCallback->handleObjectReady(spawn);
+        ofCallback->handleObjectReady(createSpawnRegion(result_set));
+
+    });
+}
+
+//=============================================================================
+
+void SpawnRegionFactory::requestObjects(ObjectFactoryCallback* ofCallback,const std::string& filter,DispatchClient* client,BulkLoadCallback done)
+{
+    std::stringstream sql;
+
+    selectSpawnRegions(sql,mDatabase->galaxy());
+    sql << filter;
+
+    mDatabase->executeCheckedAsyncSql(sql.str(), [=] (swganh::database::DatabaseResult* result) {
+        if (!result) {
+            done(false,0);
+            return;
+        }
+
+        std::unique_ptr<sql::ResultSet>& result_set = result->getResultSet();
+        uint32 count = 0;
+
+        while(result_set->next())
+        {
+            ofCallback->handleObjectReady(createSpawnRegion(result_set));
+            count++;
+        }
 
+        done(true,count);
     });
 }
 
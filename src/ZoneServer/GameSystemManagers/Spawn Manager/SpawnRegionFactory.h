@@ -57,6 +57,10 @@ public:
     void			handleDatabaseJobComplete(void* ref,swganh::database::DatabaseResult* result);
     void			requestObject(ObjectFactoryCallback* ofCallback,uint64 id,uint16 subGroup,uint16 subType,DispatchClient* client);
 
+	/*	@brief loads all spawn regions that pass the filter, joins and a where clause on the spawn_regions table, in one query
+	*/
+    void			requestObjects(ObjectFactoryCallback* ofCallback,const std::string& filter,DispatchClient* client,BulkLoadCallback done);
+
 };
 
 //=============================================================================
@@ -26,6 +26,9 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 */
 
 #include "BuildingFactory.h"
+
+#include <cppconn/resultset.h>
+
 #include "anh/logger.h"
 
 #include "BuildingObject.h"
@@ -41,6 +44,34 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 
 //=============================================================================
 
+namespace {
+
+void selectBuildings(std::stringstream& sql,const char* galaxy)
+{
+	sql << "SELECT buildings.id,buildings.oX,buildings.oY,buildings.oZ,buildings.oW,buildings.x,"
+		<< "buildings.y,buildings.z,building_types.model,building_types.width,building_types.height,"
+		<< "building_types.file,building_types.name,building_types.family "
+		<< "FROM " << galaxy << ".buildings INNER JOIN " << galaxy << ".building_types ON (buildings.type_id = building_types.id)";
+}
+
+typedef std::map<uint64,std::vector<SpawnPoint*> >	SpawnPointMap;
+typedef std::map<uint64,std::vector<uint64> >		CellIdMap;
+
+void deleteSpawnPoints(SpawnPointMap& spawnPoints)
+{
+    for(SpawnPointMap::iterator it = spawnPoints.begin(); it != spawnPoints.end(); ++it)
+    {
+        for(std::vector<SpawnPoint*>::iterator spawnPoint = (*it).second.begin(); spawnPoint != (*it).second.end(); ++spawnPoint)
+            delete(*spawnPoint);
+    }
+
+    spawnPoints.clear();
+}
+
+}
+
+//=============================================================================
+
 bool				BuildingFactory::mInsFlag    = false;
 BuildingFactory*	BuildingFactory::mSingleton  = NULL;
 
@@ -188,13 +219,125 @@ void BuildingFactory::handleDatabaseJobComplete(void* ref,swganh::database::Data
 
 void BuildingFactory::requestObject(ObjectFactoryCallback* ofCallback,uint64 id,uint16 subGroup,uint16 subType,DispatchClient* client)
 {
-    mDatabase->executeSqlAsync(this,new(mQueryContainerPool.ordered_malloc()) QueryContainerBase(ofCallback,BFQuery_MainData,client),
-                               "SELECT buildings.id,buildings.oX,buildings.oY,buildings.oZ,buildings.oW,buildings.x,"
-                               "buildings.y,buildings.z,building_types.model,building_types.width,building_types.height,"
-                               "building_types.file,building_types.name,building_types.family "
-                               "FROM %s.buildings INNER JOIN %s.building_types ON (buildings.type_id = building_types.id) "
-                               "WHERE (buildings.id = %"PRIu64")",mDatabase->galaxy(),mDatabase->galaxy(),id);
-    
+	std::stringstream sql;
+
+	selectBuildings(sql,mDatabase->galaxy());
+	sql << " WHERE (buildings.id = " << id << ")";
+
+    mDatabase->executeSqlAsync(this,new(mQueryContainerPool.ordered_malloc()) QueryContainerBase(ofCallback,BFQuery_MainData,client),sql.str());
+}
+
+//=============================================================================
+// the spawn points and cells are read before the buildings are created, a failed query drops all of it
+
+void BuildingFactory::requestObjects(ObjectFactoryCallback* ofCallback,const std::string& filter,DispatchClient* client,BulkLoadCallback done)
+{
+	std::stringstream spawnSql;
+	spawnSql << "SELECT spawn_clone.parentId,spawn_clone.oX,spawn_clone.oY,spawn_clone.oZ,spawn_clone.oW,"
+		<< "spawn_clone.cell_x,spawn_clone.cell_y,spawn_clone.cell_z,spawn_clone.city,buildings.id"
+		<< " FROM " << mDatabase->galaxy() << ".spawn_clone"
+		<< " INNER JOIN " << mDatabase->galaxy() << ".cells ON (spawn_clone.parentid = cells.id)"
+		<< " INNER JOIN " << mDatabase->galaxy() << ".buildings ON (cells.parent_id = buildings.id)"
+		<< filter;
+
+	std::stringstream cellSql;
+	cellSql << "SELECT cells.id,cells.parent_id FROM " << mDatabase->galaxy() << ".cells"
+		<< " INNER JOIN " << mDatabase->galaxy() << ".buildings ON (cells.parent_id = buildings.id)"
+		<< filter;
+
+	std::stringstream sql;
+
+	selectBuildings(sql,mDatabase->galaxy());
+	sql << filter;
+
+    std::string cellQuery = cellSql.str();
+    std::string buildingQuery = sql.str();
+
+    mDatabase->executeCheckedAsyncSql(spawnSql.str(), [=] (swganh::database::DatabaseResult* result) {
+        if (!result) {
+            done(false,0);
+            return;
+        }
+
+        std::shared_ptr<SpawnPointMap> spawnPoints = std::make_shared<SpawnPointMap>();
+        uint64 spawnCount = result->getRowCount();
+
+        for(uint64 i = 0; i < spawnCount; i++)
+        {
+            SpawnPoint* spawnPoint = new SpawnPoint();
+
+            result->getNextRow(mSpawnBinding,spawnPoint);
+
+            (*spawnPoints)[result->getResultSet()->getUInt64(10)].push_back(spawnPoint);
+        }
+
+        mDatabase->executeCheckedAsyncSql(cellQuery, [=] (swganh::database::DatabaseResult* result) {
+            if (!result) {
+                deleteSpawnPoints(*spawnPoints);
+                done(false,0);
+                return;
+            }
+
+            std::shared_ptr<CellIdMap> cells = std::make_shared<CellIdMap>();
+            std::unique_ptr<sql::ResultSet>& result_set = result->getResultSet();
+
+            while(result_set->next())
+                (*cells)[result_set->getUInt64(2)].push_back(result_set->getUInt64(1));
+
+            mDatabase->executeCheckedAsyncSql(buildingQuery, [=] (swganh::database::DatabaseResult* result) {
+                if (!result) {
+                    deleteSpawnPoints(*spawnPoints);
+                    done(false,0);
+                    return;
+                }
+
+                uint32 count = static_cast<uint32>(result->getRowCount());
+
+                for(uint32 i = 0; i < count; i++)
+                {
+                    BuildingObject* building = _createBuilding(result);
+
+                    if(building->getBuildingFamily() == BuildingFamily_Cloning_Facility)
+                    {
+                        SpawnPointMap::iterator spawns = spawnPoints->find(building->getId());
+
+                        if(spawns == spawnPoints->end())
+                        {
+                            LOG(error) << "Cloning facility [" << building->getId() << "] has no spawn points";
+                        }
+                        else
+                        {
+                            for(std::vector<SpawnPoint*>::iterator spawnPoint = (*spawns).second.begin(); spawnPoint != (*spawns).second.end(); ++spawnPoint)
+                                building->addSpawnPoint(*spawnPoint);
+
+                            spawnPoints->erase(spawns);
+                        }
+                    }
+
+                    CellIdMap::iterator buildingCells = cells->find(building->getId());
+
+                    if(buildingCells == cells->end())
+                    {
+                        ofCallback->handleObjectReady(building,client);
+                        continue;
+                    }
+
+                    // store us for later lookup
+                    mObjectLoadMap.insert(std::make_pair(building->getId(),new(mILCPool.ordered_malloc()) InLoadingContainer(building,ofCallback,client)));
+
+                    building->setLoadCount(static_cast<uint32>((*buildingCells).second.size()));
+
+                    for(std::vector<uint64>::iterator cellId = (*buildingCells).second.begin(); cellId != (*buildingCells).second.end(); ++cellId)
+                        mCellFactory->createCell(this,*cellId,building->getId(),client);
+                }
+
+                // spawn points of buildings that are no cloning facility
+                deleteSpawnPoints(*spawnPoints);
+
+                done(true,count);
+            });
+        });
+    });
 }
 
 //=============================================================================
@@ -71,6 +71,11 @@ public:
     void			handleDatabaseJobComplete(void* ref,swganh::database::DatabaseResult* result);
     void			requestObject(ObjectFactoryCallback* ofCallback,uint64 id,uint16 subGroup,uint16 subType,DispatchClient* client);
 
+	/*	@brief loads all buildings that pass the filter, joins and a where clause on the buildings table, with their cells.
+	*	One query each for the clone spawn points, the cells and the buildings
+	*/
+    void			requestObjects(ObjectFactoryCallback* ofCallback,const std::string& filter,DispatchClient* client,BulkLoadCallback done);
+
     void			releaseAllPoolsMemory();
 
 private:
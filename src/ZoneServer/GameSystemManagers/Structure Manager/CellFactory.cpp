@@ -35,6 +35,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 //#include "ZoneServer/Objects/Creature Object/CreatureObject.h"
 #include "Zoneserver/objects/PlayerStructureTerminal.h"
 #include "ZoneServer/Objects/Object/ObjectFactory.h"
+#include "ZoneServer/Objects/ItemFactory.h"
 #include "Zoneserver/objects/Shuttle.h"
 #include "ZoneServer/WorldManager.h"
 #include "DatabaseManager/Database.h"
@@ -66,6 +67,7 @@ CellFactory*	CellFactory::Init(swganh::app::SwganhKernel*	kernel)
 //=============================================================================
 
 CellFactory::CellFactory(swganh::app::SwganhKernel*	kernel) : FactoryBase(kernel)
+    , mStartupLoad(false)
 {
     _setupDatabindings();
 }
@@ -90,26 +92,7 @@ void CellFactory::handleDatabaseJobComplete(void* ref,swganh::database::Database
     {
     case CellFQuery_MainData:
     {
-        CellObject* cell = _createCell(result);
-        uint64		cellId = cell->getId();
-
-        QueryContainerBase* asContainer = new(mQueryContainerPool.ordered_malloc()) QueryContainerBase(asyncContainer->mOfCallback,CellFQuery_Objects,asyncContainer->mClient);
-        asContainer->mObject = cell;
-
-        mDatabase->executeSqlAsync(this,asContainer,"(SELECT \'terminals\',id FROM %s.terminals WHERE parent_id = %"PRIu64")"
-               
-                                   " UNION (SELECT \'ticket_collectors\',id FROM %s.ticket_collectors WHERE (parent_id=%"PRIu64"))"
-                                   " UNION (SELECT \'persistent_npcs\',id FROM %s.persistent_npcs WHERE parentId=%"PRIu64")"
-                                   " UNION (SELECT \'shuttles\',id FROM %s.shuttles WHERE parentId=%"PRIu64")"
-                                   " UNION (SELECT \'items\',id FROM %s.items WHERE parent_id=%"PRIu64")"
-                                   " UNION (SELECT \'resource_containers\',id FROM %s.resource_containers WHERE parent_id=%"PRIu64")",
-                                   mDatabase->galaxy(),cellId,
-                                   mDatabase->galaxy(),cellId,
-                                   mDatabase->galaxy(),cellId,
-                                   
-                                   mDatabase->galaxy(),cellId,
-                                   mDatabase->galaxy(),cellId,
-                                   mDatabase->galaxy(),cellId);       
+        _handleCellCreated(_createCell(result),asyncContainer->mOfCallback,asyncContainer->mClient);
     }
     break;
 
@@ -124,33 +107,28 @@ void CellFactory::handleDatabaseJobComplete(void* ref,swganh::database::Database
 
         uint64 count = result->getRowCount();
 
-        if(count > 0)
+        CellContentList content;
+        content.reserve(static_cast<uint32>(count));
+
+        for(uint32 i = 0; i < count; i++)
         {
-            // store us for later lookup
-            mObjectLoadMap.insert(std::make_pair(cell->getId(),new(mILCPool.ordered_malloc()) InLoadingContainer(cell,asyncContainer->mOfCallback,asyncContainer->mClient)));
-            cell->setLoadCount(static_cast<uint32>(count));
-
-            for(uint32 i = 0; i < count; i++)
-            {
-                result->getNextRow(binding,&queryContainer);
-
-                if(strcmp(queryContainer.mString.getAnsi(),"terminals") == 0)
-                    gObjectFactory->requestObject(ObjType_Tangible,TanGroup_Terminal,0,this,queryContainer.mId,asyncContainer->mClient);
-                
-                else if(strcmp(queryContainer.mString.getAnsi(),"ticket_collectors") == 0)
-                    gObjectFactory->requestObject(ObjType_Tangible,TanGroup_TicketCollector,0,this,queryContainer.mId,asyncContainer->mClient);
-                else if(strcmp(queryContainer.mString.getAnsi(),"persistent_npcs") == 0)
-                    gObjectFactory->requestObject(ObjType_NPC,CreoGroup_PersistentNpc,0,this,queryContainer.mId,asyncContainer->mClient);
-                else if(strcmp(queryContainer.mString.getAnsi(),"shuttles") == 0)
-                    gObjectFactory->requestObject(ObjType_Creature,CreoGroup_Shuttle,0,this,queryContainer.mId,asyncContainer->mClient);
-                else if(strcmp(queryContainer.mString.getAnsi(),"items") == 0)
-                    gObjectFactory->requestObject(ObjType_Tangible,TanGroup_Item,0,this,queryContainer.mId,asyncContainer->mClient);
-                else if(strcmp(queryContainer.mString.getAnsi(),"resource_containers") == 0)
-                    gObjectFactory->requestObject(ObjType_Tangible,TanGroup_ResourceContainer,0,this,queryContainer.mId,asyncContainer->mClient);
-            }
+            result->getNextRow(binding,&queryContainer);
+
+            if(strcmp(queryContainer.mString.getAnsi(),"terminals") == 0)
+                content.push_back(CellContent(CellContent_Terminal,queryContainer.mId));
+            else if(strcmp(queryContainer.mString.getAnsi(),"ticket_collectors") == 0)
+                content.push_back(CellContent(CellContent_TicketCollector,queryContainer.mId));
+            else if(strcmp(queryContainer.mString.getAnsi(),"persistent_npcs") == 0)
+                content.push_back(CellContent(CellContent_PersistentNpc,queryContainer.mId));
+            else if(strcmp(queryContainer.mString.getAnsi(),"shuttles") == 0)
+                content.push_back(CellContent(CellContent_Shuttle,queryContainer.mId));
+            else if(strcmp(queryContainer.mString.getAnsi(),"items") == 0)
+                content.push_back(CellContent(CellContent_Item,queryContainer.mId));
+            else if(strcmp(queryContainer.mString.getAnsi(),"resource_containers") == 0)
+                content.push_back(CellContent(CellContent_ResourceContainer,queryContainer.mId));
         }
-        else
-            asyncContainer->mOfCallback->handleObjectReady(cell,asyncContainer->mClient);
+
+        _requestCellContent(cell,content,asyncContainer->mOfCallback,asyncContainer->mClient);
 
         mDatabase->destroyDataBinding(binding);
     }
@@ -181,20 +159,157 @@ void CellFactory::requestStructureCell(ObjectFactoryCallback* ofCallback,uint64
 
 //=============================================================================
 
-CellObject* CellFactory::_createCell(swganh::database::DatabaseResult* result)
+void CellFactory::createCell(ObjectFactoryCallback* ofCallback,uint64 id,uint64 parentId,DispatchClient* client)
 {
-    if (!result->getRowCount()) {
-    	return nullptr;
+    CellObject* cell = _newCell();
+
+    cell->setId(id);
+    cell->setParentId(parentId);
+
+    _handleCellCreated(cell,ofCallback,client);
+}
+
+//=============================================================================
+
+void CellFactory::_handleCellCreated(CellObject* cell,ObjectFactoryCallback* ofCallback,DispatchClient* client)
+{
+    uint64 cellId = cell->getId();
+
+    // on startup the content comes in by itself
+    if(mStartupLoad)
+    {
+        mStartupCells.insert(std::make_pair(cellId,cell));
+
+        ParkedContentMap::iterator it = mParkedContent.find(cellId);
+
+        if(it != mParkedContent.end())
+        {
+            for(std::vector<Object*>::iterator object = (*it).second.begin(); object != (*it).second.end(); ++object)
+                _addToCell(cell,*object);
+
+            mParkedContent.erase(it);
+        }
+
+        ofCallback->handleObjectReady(cell,client);
+        return;
     }
 
+    QueryContainerBase* asContainer = new(mQueryContainerPool.ordered_malloc()) QueryContainerBase(ofCallback,CellFQuery_Objects,client);
+    asContainer->mObject = cell;
+
+    mDatabase->executeSqlAsync(this,asContainer,"(SELECT \'terminals\',id FROM %s.terminals WHERE parent_id = %"PRIu64")"
+               
+                               " UNION (SELECT \'ticket_collectors\',id FROM %s.ticket_collectors WHERE (parent_id=%"PRIu64"))"
+                               " UNION (SELECT \'persistent_npcs\',id FROM %s.persistent_npcs WHERE parentId=%"PRIu64")"
+                               " UNION (SELECT \'shuttles\',id FROM %s.shuttles WHERE parentId=%"PRIu64")"
+                               " UNION (SELECT \'items\',id FROM %s.items WHERE parent_id=%"PRIu64")"
+                               " UNION (SELECT \'resource_containers\',id FROM %s.resource_containers WHERE parent_id=%"PRIu64")",
+                               mDatabase->galaxy(),cellId,
+                               mDatabase->galaxy(),cellId,
+                               mDatabase->galaxy(),cellId,
+                                   
+                               mDatabase->galaxy(),cellId,
+                               mDatabase->galaxy(),cellId,
+                               mDatabase->galaxy(),cellId);       
+}
+
+//=============================================================================
+// content loaded in bulk on startup, its cell might not be there yet
+
+void CellFactory::_handleStartupContent(Object* object)
+{
+    StartupCellMap::iterator it = mStartupCells.find(object->getParentId());
+
+    if(it == mStartupCells.end())
+    {
+        mParkedContent[object->getParentId()].push_back(object);
+        return;
+    }
+
+    _addToCell((*it).second,object);
+
+    // the building of the cell might have been reported already
+    gWorldManager->checkLoadComplete();
+}
+
+//=============================================================================
+
+void CellFactory::_requestCellContent(CellObject* cell,const CellContentList& content,ObjectFactoryCallback* ofCallback,DispatchClient* client)
+{
+    if(content.empty())
+    {
+        ofCallback->handleObjectReady(cell,client);
+        return;
+    }
+
+    // store us for later lookup
+    mObjectLoadMap.insert(std::make_pair(cell->getId(),new(mILCPool.ordered_malloc()) InLoadingContainer(cell,ofCallback,client)));
+    cell->setLoadCount(static_cast<uint32>(content.size()));
+
+    // the items of the cell with everything inside of them in one go
+    std::vector<uint64> items;
+
+    for(CellContentList::const_iterator it = content.begin(); it != content.end(); ++it)
+    {
+        switch((*it).mType)
+        {
+        case CellContent_Terminal:
+            gObjectFactory->requestObject(ObjType_Tangible,TanGroup_Terminal,0,this,(*it).mId,client);
+            break;
+        case CellContent_TicketCollector:
+            gObjectFactory->requestObject(ObjType_Tangible,TanGroup_TicketCollector,0,this,(*it).mId,client);
+            break;
+        case CellContent_PersistentNpc:
+            gObjectFactory->requestObject(ObjType_NPC,CreoGroup_PersistentNpc,0,this,(*it).mId,client);
+            break;
+        case CellContent_Shuttle:
+            gObjectFactory->requestObject(ObjType_Creature,CreoGroup_Shuttle,0,this,(*it).mId,client);
+            break;
+        case CellContent_Item:
+            items.push_back((*it).mId);
+            break;
+        case CellContent_ResourceContainer:
+            gObjectFactory->requestObject(ObjType_Tangible,TanGroup_ResourceContainer,0,this,(*it).mId,client);
+            break;
+        default:
+            break;
+        }
+    }
+
+    gItemFactory->requestItems(this,items,client);
+}
+
+//=============================================================================
+
+void CellFactory::beginStartupLoad()
+{
+    mStartupLoad = true;
+}
+
+//=============================================================================
+
+void CellFactory::endStartupLoad()
+{
+    mStartupLoad = false;
+
+    StartupCellMap().swap(mStartupCells);
+
+    for(ParkedContentMap::iterator it = mParkedContent.begin(); it != mParkedContent.end(); ++it)
+        LOG(warning) << "CellFactory::endStartupLoad : cell " << (*it).first << " never loaded, " << (*it).second.size() << " objects inside of it are dropped";
+
+    ParkedContentMap().swap(mParkedContent);
+}
+
+//=============================================================================
+
+CellObject* CellFactory::_newCell()
+{
     CellObject* cell = new CellObject();
     cell->setCapacity(500);
 	cell->object_type_ = SWG_CELL;
 
 	gObjectManager->LoadSlotsForObject(cell);
 
-    result->getNextRow(mCellBinding,(void*)cell);
-
 	auto permissions_objects_ = gObjectManager->GetPermissionsMap();
 	cell->SetPermissions(permissions_objects_.find(swganh::object::WORLD_CELL_PERMISSION)->second.get());//CREATURE_PERMISSION
 	
@@ -205,6 +320,21 @@ CellObject* CellFactory::_createCell(swganh::database::DatabaseResult* result)
 
 //=============================================================================
 
+CellObject* CellFactory::_createCell(swganh::database::DatabaseResult* result)
+{
+    if (!result->getRowCount()) {
+    	return nullptr;
+    }
+
+    CellObject* cell = _newCell();
+
+    result->getNextRow(mCellBinding,(void*)cell);
+
+	return cell;
+}
+
+//=============================================================================
+
 void CellFactory::_setupDatabindings()
 {
     mCellBinding = mDatabase->createDataBinding(2);
@@ -226,12 +356,41 @@ void CellFactory::handleObjectReady(Object* object,DispatchClient* client)
     InLoadingContainer* ilc = _getObject(object->getParentId());
 
     if (! ilc) {//Crashbug fix: http://paste.swganh.org/viewp.php?id=20100627114151-8f7df7f74013af71c0d0b00bc240770d
+        if(mStartupLoad)
+        {
+            _handleStartupContent(object);
+            return;
+        }
+
         LOG(warning) << "Could not locate InLoadingContainer for object parent id [" << object->getParentId() << "]";
         return;
     }
 
     CellObject*			cell = dynamic_cast<CellObject*>(ilc->mObject);
 
+    _addToCell(cell,object);
+	cell->incLoad();
+
+	//LOG(info) << "cellFactory::handleObjectReady -> cell load stuff" << object->getId() << "for " << cell->getId();
+	//LOG(info) << "loadcount : " << cell->getLoadCount() << " : count : " << cell->getLoad();
+
+	if(cell->getLoadCount() == cell->getLoad())
+    {
+		//LOG(info) << "cellFactory::handleObjectReady -> cell done " << cell->getId();
+
+        if(!(_removeFromObjectLoadMap(cell->getId())))
+            LOG(warning) << "Failed removing object from loadmap";
+
+        ilc->mOfCallback->handleObjectReady(cell,ilc->mClient);
+
+        mILCPool.free(ilc);
+    }
+}
+
+//=============================================================================
+
+void CellFactory::_addToCell(CellObject* cell,Object* object)
+{
     gWorldManager->addObject(object,true);
 
 
@@ -280,22 +439,6 @@ void CellFactory::handleObjectReady(Object* object,DispatchClient* client)
 
 	gObjectManager->LoadSlotsForObject(object);
 	cell->InitializeObject(object);
-	cell->incLoad();
-
-	//LOG(info) << "cellFactory::handleObjectReady -> cell load stuff" << object->getId() << "for " << cell->getId();
-	//LOG(info) << "loadcount : " << cell->getLoadCount() << " : count : " << cell->getLoad();
-
-	if(cell->getLoadCount() == cell->getLoad())
-    {
-		//LOG(info) << "cellFactory::handleObjectReady -> cell done " << cell->getId();
-
-        if(!(_removeFromObjectLoadMap(cell->getId())))
-            LOG(warning) << "Failed removing object from loadmap";
-
-        ilc->mOfCallback->handleObjectReady(cell,ilc->mClient);
-
-        mILCPool.free(ilc);
-    }
 }
 
 //=============================================================================
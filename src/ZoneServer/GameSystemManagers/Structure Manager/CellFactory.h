@@ -31,6 +31,8 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "ZoneServer/Objects/Object/ObjectFactoryCallback.h"
 #include "ZoneServer/Objects/FactoryBase.h"
 
+#include <vector>
+
 #define 	gCellFactory	CellFactory::getSingletonPtr()
 
 //=============================================================================
@@ -51,6 +53,30 @@ enum CellFQuery
     CellFQuery_Objects	= 2
 };
 
+enum CellContentType
+{
+    CellContent_Terminal			= 0,
+    CellContent_TicketCollector		= 1,
+    CellContent_PersistentNpc		= 2,
+    CellContent_Shuttle				= 3,
+    CellContent_Item				= 4,
+    CellContent_ResourceContainer	= 5
+};
+
+//=============================================================================
+
+class CellContent
+{
+public:
+
+    CellContent(uint32 type,uint64 id) : mType(type),mId(id) {}
+
+    uint32	mType;
+    uint64	mId;
+};
+
+typedef std::vector<CellContent>			CellContentList;
+
 //=============================================================================
 
 class CellFactory : public FactoryBase, public ObjectFactoryCallback
@@ -69,19 +95,43 @@ public:
     void			requestObject(ObjectFactoryCallback* ofCallback,uint64 id,uint16 subGroup,uint16 subType,DispatchClient* client);
     void			requestStructureCell(ObjectFactoryCallback* ofCallback,uint64 id,uint16 subGroup,uint16 subType,DispatchClient* client);
 
+	/*	@brief creates a cell whose row was read along with the cells of other buildings
+	*/
+    void			createCell(ObjectFactoryCallback* ofCallback,uint64 id,uint64 parentId,DispatchClient* client);
+
+	/*	@brief on startup the zone loads the content of all cells of the planet in bulk, one query per object class,
+	*	with us as callback. Cells created meanwhile do not query their content, cells and content are linked in
+	*	whatever order they arrive
+	*/
+    void			beginStartupLoad();
+    void			endStartupLoad();
+
 private:
 
     CellFactory(swganh::app::SwganhKernel*	kernel);
 
+    void			_handleCellCreated(CellObject* cell,ObjectFactoryCallback* ofCallback,DispatchClient* client);
+    void			_handleStartupContent(Object* object);
+    void			_requestCellContent(CellObject* cell,const CellContentList& content,ObjectFactoryCallback* ofCallback,DispatchClient* client);
+    void			_addToCell(CellObject* cell,Object* object);
+
     void			_setupDatabindings();
     void			_destroyDatabindings();
 
+    CellObject*		_newCell();
     CellObject*		_createCell(swganh::database::DatabaseResult* result);
 
     static CellFactory*		mSingleton;
     static bool				mInsFlag;
 
     swganh::database::DataBinding*			mCellBinding;
+
+    typedef std::map<uint64,CellObject*>			StartupCellMap;
+    typedef std::map<uint64,std::vector<Object*> >	ParkedContentMap;
+
+    StartupCellMap			mStartupCells;
+    ParkedContentMap		mParkedContent;
+    bool					mStartupLoad;
 };
 
 //=============================================================================
@@ -45,6 +45,8 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "Utils/utils.h"
 #include <cassert>
 
+#include <cppconn/resultset.h>
+
 // itemtypes
 
 // weapons				1
@@ -70,6 +72,23 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 
 //=============================================================================
 
+namespace {
+
+typedef std::map<uint64,std::vector<uint64> >	HopperIdMap;
+
+void selectFactories(std::stringstream& sql,const char* galaxy)
+{
+    sql << "SELECT s.id,s.owner,s.oX,s.oY,s.oZ,s.oW,s.x,s.y,s.z,"
+        << "std.type,std.object_string,std.stf_name, std.stf_file, s.name,"
+        << "std.lots_used, f.active, std.maint_cost_wk, std.power_used, std.schematicMask, s.condition, std.max_condition, f.ManSchematicId "
+        << "FROM " << galaxy << ".structures s INNER JOIN " << galaxy << ".structure_type_data std ON (s.type = std.type)"
+        << " INNER JOIN " << galaxy << ".factories f ON (s.id = f.id)";
+}
+
+}
+
+//=============================================================================
+
 bool				FactoryFactory::mInsFlag    = false;
 FactoryFactory*		FactoryFactory::mSingleton  = NULL;
 
@@ -366,16 +385,103 @@ void FactoryFactory::requestObject(ObjectFactoryCallback* ofCallback,uint64 id,u
 {
     //request the harvesters Data first
 
-    int8 sql[1024];
-    sprintf(sql,	"SELECT s.id,s.owner,s.oX,s.oY,s.oZ,s.oW,s.x,s.y,s.z,"
-            "std.type,std.object_string,std.stf_name, std.stf_file, s.name,"
-            "std.lots_used, f.active, std.maint_cost_wk, std.power_used, std.schematicMask, s.condition, std.max_condition, f.ManSchematicId "
-            "FROM %s.structures s INNER JOIN %s.structure_type_data std ON (s.type = std.type) INNER JOIN %s.factories f ON (s.id = f.id) "
-            "WHERE (s.id = %"PRIu64")",
-            mDatabase->galaxy(),mDatabase->galaxy(),mDatabase->galaxy(),id);
+    std::stringstream sql;
+
+    selectFactories(sql,mDatabase->galaxy());
+    sql << " WHERE (s.id = " << id << ")";
+
     QueryContainerBase* asynContainer = new(mQueryContainerPool.ordered_malloc()) QueryContainerBase(ofCallback,FFQuery_MainData,client,id);
 
-    mDatabase->executeSqlAsync(this,asynContainer,sql);
+    mDatabase->executeSqlAsync(this,asynContainer,sql.str());
+}
+
+//=============================================================================
+// the hoppers carry what is inside of them, they are still loaded one by one through the tangible factory
+
+void FactoryFactory::requestObjects(ObjectFactoryCallback* ofCallback,const std::string& filter,DispatchClient* client,BulkLoadCallback done)
+{
+    std::stringstream attributeSql;
+    attributeSql << "SELECT sa.structure_id,attributes.name,sa.value,attributes.internal FROM " << mDatabase->galaxy() << ".structure_attributes sa"
+                 << " INNER JOIN " << mDatabase->galaxy() << ".attributes ON (sa.attribute_id = attributes.id)"
+                 << " INNER JOIN " << mDatabase->galaxy() << ".structures s ON (s.id = sa.structure_id)"
+                 << " INNER JOIN " << mDatabase->galaxy() << ".factories f ON (s.id = f.id)" << filter
+                 << " ORDER BY sa.structure_id,sa.order";
+
+    std::stringstream hopperSql;
+    hopperSql << "SELECT items.parent_id,items.id FROM " << mDatabase->galaxy() << ".items"
+              << " INNER JOIN " << mDatabase->galaxy() << ".structures s ON (s.id = items.parent_id)"
+              << " INNER JOIN " << mDatabase->galaxy() << ".factories f ON (s.id = f.id)" << filter
+              << " AND (items.item_type IN (2773,2774))";
+
+    std::stringstream sql;
+
+    selectFactories(sql,mDatabase->galaxy());
+    sql << filter;
+
+    std::string hopperQuery = hopperSql.str();
+    std::string factoryQuery = sql.str();
+
+    mDatabase->executeCheckedAsyncSql(attributeSql.str(), [=] (swganh::database::DatabaseResult* result) {
+        if (!result) {
+            done(false,0);
+            return;
+        }
+
+        std::shared_ptr<ObjectAttributeMap> attributes = std::make_shared<ObjectAttributeMap>();
+        _readObjectAttributes(*attributes,result);
+
+        mDatabase->executeCheckedAsyncSql(hopperQuery, [=] (swganh::database::DatabaseResult* result) {
+            if (!result) {
+                done(false,0);
+                return;
+            }
+
+            std::shared_ptr<HopperIdMap> hoppers = std::make_shared<HopperIdMap>();
+            std::unique_ptr<sql::ResultSet>& result_set = result->getResultSet();
+
+            while(result_set->next())
+                (*hoppers)[result_set->getUInt64(1)].push_back(result_set->getUInt64(2));
+
+            mDatabase->executeCheckedAsyncSql(factoryQuery, [=] (swganh::database::DatabaseResult* result) {
+                if (!result) {
+                    done(false,0);
+                    return;
+                }
+
+                uint32 count = static_cast<uint32>(result->getRowCount());
+
+                for(uint32 i = 0; i < count; i++)
+                {
+                    FactoryObject* factory = new(FactoryObject);
+                    _createFactory(result,factory);
+
+                    ObjectAttributeMap::iterator factoryAttributes = attributes->find(factory->getId());
+
+                    if(factoryAttributes != attributes->end())
+                    {
+                        for(ObjectAttributeList::iterator attribute = (*factoryAttributes).second.begin(); attribute != (*factoryAttributes).second.end(); ++attribute)
+                            factory->addInternalAttribute(BString((*attribute).mKey.c_str()),(*attribute).mValue);
+                    }
+
+                    HopperIdMap::iterator factoryHoppers = hoppers->find(factory->getId());
+
+                    if(factoryHoppers == hoppers->end())
+                    {
+                        LOG(error) << "Factory [" << factory->getId() << "] has no hoppers";
+                        ofCallback->handleObjectReady(factory,client);
+                        continue;
+                    }
+
+                    mObjectLoadMap.insert(std::make_pair(factory->getId(),new(mILCPool.ordered_malloc()) InLoadingContainer(factory,ofCallback,client,static_cast<uint32>((*factoryHoppers).second.size()))));
+
+                    for(std::vector<uint64>::iterator hopper = (*factoryHoppers).second.begin(); hopper != (*factoryHoppers).second.end(); ++hopper)
+                        gTangibleFactory->requestObject(this,*hopper,TanGroup_Hopper,0,NULL);
+                }
+
+                done(true,count);
+            });
+        });
+    });
 }
 
 //the factories hopper is accessed - update the hoppers contents
@@ -74,6 +74,11 @@ public:
     virtual void	handleObjectReady(Object* object,DispatchClient* client);
     void			handleDatabaseJobComplete(void* ref,swganh::database::DatabaseResult* result);
     void			requestObject(ObjectFactoryCallback* ofCallback,uint64 id,uint16 subGroup,uint16 subType,DispatchClient* client);
+
+	/*	@brief loads all factories that pass the filter, a where clause on the structures s and factories f tables.
+	*	One query each for the attributes, the hopper ids and the factories, the hoppers follow one by one
+	*/
+    void			requestObjects(ObjectFactoryCallback* ofCallback,const std::string& filter,DispatchClient* client,BulkLoadCallback done);
     void			upDateHopper(ObjectFactoryCallback* ofCallback,uint64 hopperId, DispatchClient* client, FactoryObject* factory);
 
     void			releaseAllPoolsMemory();
@@ -42,6 +42,41 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 
 //=============================================================================
 
+namespace {
+
+typedef std::map<uint64,structure_admin_class>	AdminDataMap;
+typedef std::map<uint64,HResourceList>			HopperContentMap;
+
+void selectHarvesters(std::stringstream& sql,const char* galaxy)
+{
+    sql << "SELECT s.id,s.owner,s.oX,s.oY,s.oZ,s.oW,s.x,s.y,s.z,std.type,std.object_string,std.stf_name, std.stf_file, s.name, std.lots_used, std.resource_Category, h.ResourceID, h.active, h.rate, std.maint_cost_wk, std.power_used, s.condition, std.max_condition, std.repair_cost "
+        << "FROM " << galaxy << ".structures s INNER JOIN " << galaxy << ".structure_type_data std ON (s.type = std.type)"
+        << " INNER JOIN " << galaxy << ".harvesters h ON (s.id = h.id)";
+}
+
+// rows of structure id, player id, admin type and player name
+void readAdminData(AdminDataMap& admins,swganh::database::DatabaseResult* result)
+{
+    std::unique_ptr<sql::ResultSet>& result_set = result->getResultSet();
+
+    while(result_set->next())
+    {
+        structure_admin_class& admin_data = admins[result_set->getUInt64(1)];
+        std::string type = result_set->getString(3);
+
+        if(type == "ADMIN")
+            admin_data.admin_add_(result_set->getInt64(2), result_set->getString(4));
+        else if(type == "BAN")
+            admin_data.ban_add_(result_set->getInt64(2), result_set->getString(4));
+        else if((type == "ENTRY") || (type == "HOPPER"))
+            admin_data.entry_add_(result_set->getInt64(2), result_set->getString(4));
+    }
+}
+
+}
+
+//=============================================================================
+
 bool				HarvesterFactory::mInsFlag    = false;
 HarvesterFactory*	HarvesterFactory::mSingleton  = NULL;
 
@@ -249,17 +284,122 @@ void HarvesterFactory::requestObject(ObjectFactoryCallback* ofCallback,uint64 id
 {
     //request the harvesters Data first
 
-    int8 sql2[1024];
-    sprintf(sql2,	"SELECT s.id,s.owner,s.oX,s.oY,s.oZ,s.oW,s.x,s.y,s.z,std.type,std.object_string,std.stf_name, std.stf_file, s.name, std.lots_used, std.resource_Category, h.ResourceID, h.active, h.rate, std.maint_cost_wk, std.power_used, s.condition, std.max_condition, std.repair_cost "
-            "FROM %s.structures s INNER JOIN %s.structure_type_data std ON (s.type = std.type) INNER JOIN %s.harvesters h ON (s.id = h.id) "
-            "WHERE (s.id = %"PRIu64")",
-            mDatabase->galaxy(),mDatabase->galaxy(),mDatabase->galaxy(),id);
+    std::stringstream sql;
+
+    selectHarvesters(sql,mDatabase->galaxy());
+    sql << " WHERE (s.id = " << id << ")";
+
     QueryContainerBase* asynContainer = new(mQueryContainerPool.ordered_malloc()) QueryContainerBase(ofCallback,HFQuery_MainData,client,id);
 
-    mDatabase->executeSqlAsync(this,asynContainer,sql2);
+    mDatabase->executeSqlAsync(this,asynContainer,sql.str());
     
 }
 
+//=============================================================================
+
+void HarvesterFactory::requestObjects(ObjectFactoryCallback* ofCallback,const std::string& filter,DispatchClient* client,BulkLoadCallback done)
+{
+    std::stringstream attributeSql;
+    attributeSql << "SELECT sa.structure_id,attributes.name,sa.value,attributes.internal FROM " << mDatabase->galaxy() << ".structure_attributes sa"
+                 << " INNER JOIN " << mDatabase->galaxy() << ".attributes ON (sa.attribute_id = attributes.id)"
+                 << " INNER JOIN " << mDatabase->galaxy() << ".structures s ON (s.id = sa.structure_id)"
+                 << " INNER JOIN " << mDatabase->galaxy() << ".harvesters h ON (s.id = h.id)" << filter
+                 << " ORDER BY sa.structure_id,sa.order";
+
+    std::stringstream adminSql;
+    adminSql << "SELECT sad.StructureID, sad.PlayerID, sad.AdminType, c.firstname FROM " << mDatabase->galaxy() << ".structure_admin_data sad"
+             << " INNER JOIN " << mDatabase->galaxy() << ".characters c ON (c.id = sad.PlayerID)"
+             << " INNER JOIN " << mDatabase->galaxy() << ".structures s ON (s.id = sad.StructureID)"
+             << " INNER JOIN " << mDatabase->galaxy() << ".harvesters h ON (s.id = h.id)" << filter;
+
+    std::stringstream resourceSql;
+    resourceSql << "SELECT hr.ID, hr.resourceID, hr.quantity FROM " << mDatabase->galaxy() << ".harvester_resources hr"
+                << " INNER JOIN " << mDatabase->galaxy() << ".structures s ON (s.id = hr.ID)"
+                << " INNER JOIN " << mDatabase->galaxy() << ".harvesters h ON (s.id = h.id)" << filter;
+
+    std::stringstream sql;
+
+    selectHarvesters(sql,mDatabase->galaxy());
+    sql << filter;
+
+    std::string adminQuery = adminSql.str();
+    std::string resourceQuery = resourceSql.str();
+    std::string harvesterQuery = sql.str();
+
+    mDatabase->executeCheckedAsyncSql(attributeSql.str(), [=] (swganh::database::DatabaseResult* result) {
+        if (!result) {
+            done(false,0);
+            return;
+        }
+
+        std::shared_ptr<ObjectAttributeMap> attributes = std::make_shared<ObjectAttributeMap>();
+        _readObjectAttributes(*attributes,result);
+
+        mDatabase->executeCheckedAsyncSql(adminQuery, [=] (swganh::database::DatabaseResult* result) {
+            if (!result) {
+                done(false,0);
+                return;
+            }
+
+            std::shared_ptr<AdminDataMap> admins = std::make_shared<AdminDataMap>();
+            readAdminData(*admins,result);
+
+            mDatabase->executeCheckedAsyncSql(resourceQuery, [=] (swganh::database::DatabaseResult* result) {
+                if (!result) {
+                    done(false,0);
+                    return;
+                }
+
+                std::shared_ptr<HopperContentMap> hoppers = std::make_shared<HopperContentMap>();
+                std::unique_ptr<sql::ResultSet>& result_set = result->getResultSet();
+
+                while(result_set->next())
+                    (*hoppers)[result_set->getUInt64(1)].push_back(std::make_pair(result_set->getUInt64(2),static_cast<float>(result_set->getDouble(3))));
+
+                mDatabase->executeCheckedAsyncSql(harvesterQuery, [=] (swganh::database::DatabaseResult* result) {
+                    if (!result) {
+                        done(false,0);
+                        return;
+                    }
+
+                    uint32 count = static_cast<uint32>(result->getRowCount());
+
+                    for(uint32 i = 0; i < count; i++)
+                    {
+                        HarvesterObject* harvester = new(HarvesterObject);
+                        _createHarvester(result,harvester);
+
+                        HopperContentMap::iterator hopper = hoppers->find(harvester->getId());
+
+                        if(hopper != hoppers->end())
+                            harvester->getResourceList()->swap((*hopper).second);
+
+                        ObjectAttributeMap::iterator harvesterAttributes = attributes->find(harvester->getId());
+
+                        if(harvesterAttributes != attributes->end())
+                        {
+                            for(ObjectAttributeList::iterator attribute = (*harvesterAttributes).second.begin(); attribute != (*harvesterAttributes).second.end(); ++attribute)
+                                harvester->addInternalAttribute(BString((*attribute).mKey.c_str()),(*attribute).mValue);
+                        }
+
+                        AdminDataMap::iterator admin_data = admins->find(harvester->getId());
+
+                        if(admin_data != admins->end())
+                            harvester->admin_data_ = (*admin_data).second;
+
+                        harvester->admin_data_.structure_id_	= harvester->getId();
+                        harvester->admin_data_.owner_id_		= harvester->getOwner();
+
+                        ofCallback->handleObjectReady(harvester,client);
+                    }
+
+                    done(true,count);
+                });
+            });
+        });
+    });
+}
+
 
 //=============================================================================
 
@@ -73,6 +73,11 @@ public:
     void			handleDatabaseJobComplete(void* ref,swganh::database::DatabaseResult* result);
     void			requestObject(ObjectFactoryCallback* ofCallback,uint64 id,uint16 subGroup,uint16 subType,DispatchClient* client);
 
+	/*	@brief loads all harvesters that pass the filter, a where clause on the structures s and harvesters h tables.
+	*	One query each for the attributes, the admin lists, the hopper contents and the harvesters
+	*/
+    void			requestObjects(ObjectFactoryCallback* ofCallback,const std::string& filter,DispatchClient* client,BulkLoadCallback done);
+
     void			releaseAllPoolsMemory();
 
 private:
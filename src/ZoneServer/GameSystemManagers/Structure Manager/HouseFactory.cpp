@@ -48,6 +48,43 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 
 //=============================================================================
 
+namespace {
+
+typedef std::map<uint64,structure_admin_class>	AdminDataMap;
+typedef std::map<uint64,std::vector<uint64> >	CellIdMap;
+
+void selectHouses(std::stringstream& sql,const char* galaxy)
+{
+    sql << "SELECT s.id,s.owner,s.oX,s.oY,s.oZ,s.oW,s.x,s.y,s.z, "
+        << "std.type,std.object_string,std.stf_name, std.stf_file, s.name, "
+        << "std.lots_used, h.private, std.maint_cost_wk, s.condition, std.max_condition, std.max_storage "
+        << "FROM " << galaxy << ".structures s INNER JOIN " << galaxy << ".structure_type_data std ON (s.type = std.type)"
+        << " INNER JOIN " << galaxy << ".houses h ON (s.id = h.id)";
+}
+
+// rows of structure id, player id, admin type and player name
+void readAdminData(AdminDataMap& admins,swganh::database::DatabaseResult* result)
+{
+    std::unique_ptr<sql::ResultSet>& result_set = result->getResultSet();
+
+    while(result_set->next())
+    {
+        structure_admin_class& admin_data = admins[result_set->getUInt64(1)];
+        std::string type = result_set->getString(3);
+
+        if(type == "ADMIN")
+            admin_data.admin_add_(result_set->getInt64(2), result_set->getString(4));
+        else if(type == "BAN")
+            admin_data.ban_add_(result_set->getInt64(2), result_set->getString(4));
+        else if((type == "ENTRY") || (type == "HOPPER"))
+            admin_data.entry_add_(result_set->getInt64(2), result_set->getString(4));
+    }
+}
+
+}
+
+//=============================================================================
+
 bool				HouseFactory::mInsFlag    = false;
 HouseFactory*		HouseFactory::mSingleton  = NULL;
 
@@ -256,22 +293,137 @@ void HouseFactory::requestObject(ObjectFactoryCallback* ofCallback,uint64 id,uin
 {
     //request the houses Data first
 
-    int8 sql[1024];
-    sprintf(sql,	"SELECT s.id,s.owner,s.oX,s.oY,s.oZ,s.oW,s.x,s.y,s.z, "
-            "std.type,std.object_string,std.stf_name, std.stf_file, s.name, "
-            "std.lots_used, h.private, std.maint_cost_wk, s.condition, std.max_condition, std.max_storage "
-            "FROM %s.structures s INNER JOIN %s.structure_type_data std ON (s.type = std.type) INNER JOIN %s.houses h ON (s.id = h.id) "
-            "WHERE (s.id = %"PRIu64")",
-            mDatabase->galaxy(),mDatabase->galaxy(),mDatabase->galaxy(),id);
+    std::stringstream sql;
+
+    selectHouses(sql,mDatabase->galaxy());
+    sql << " WHERE (s.id = " << id << ")";
 
     QueryContainerBase* asynContainer = new(mQueryContainerPool.ordered_malloc()) QueryContainerBase(ofCallback,HOFQuery_MainData,client,id);
 
-    mDatabase->executeSqlAsync(this,asynContainer,sql);
+    mDatabase->executeSqlAsync(this,asynContainer,sql.str());
     
 }
 
 //=============================================================================
 
+void HouseFactory::requestObjects(ObjectFactoryCallback* ofCallback,const std::string& filter,DispatchClient* client,BulkLoadCallback done)
+{
+    std::stringstream attributeSql;
+    attributeSql << "SELECT sa.structure_id,attributes.name,sa.value,attributes.internal FROM " << mDatabase->galaxy() << ".structure_attributes sa"
+                 << " INNER JOIN " << mDatabase->galaxy() << ".attributes ON (sa.attribute_id = attributes.id)"
+                 << " INNER JOIN " << mDatabase->galaxy() << ".structures s ON (s.id = sa.structure_id)"
+                 << " INNER JOIN " << mDatabase->galaxy() << ".houses h ON (s.id = h.id)" << filter
+                 << " ORDER BY sa.structure_id,sa.order";
+
+    std::stringstream adminSql;
+    adminSql << "SELECT sad.StructureID, sad.PlayerID, sad.AdminType, c.firstname FROM " << mDatabase->galaxy() << ".structure_admin_data sad"
+             << " INNER JOIN " << mDatabase->galaxy() << ".characters c ON (c.id = sad.PlayerID)"
+             << " INNER JOIN " << mDatabase->galaxy() << ".structures s ON (s.id = sad.StructureID)"
+             << " INNER JOIN " << mDatabase->galaxy() << ".houses h ON (s.id = h.id)" << filter;
+
+    std::stringstream cellSql;
+    cellSql << "SELECT structure_cells.id,structure_cells.parent_id FROM " << mDatabase->galaxy() << ".structure_cells"
+            << " INNER JOIN " << mDatabase->galaxy() << ".structures s ON (s.id = structure_cells.parent_id)"
+            << " INNER JOIN " << mDatabase->galaxy() << ".houses h ON (s.id = h.id)" << filter
+            << " ORDER BY structure_cells.id";
+
+    std::stringstream sql;
+
+    selectHouses(sql,mDatabase->galaxy());
+    sql << filter;
+
+    std::string adminQuery = adminSql.str();
+    std::string cellQuery = cellSql.str();
+    std::string houseQuery = sql.str();
+
+    mDatabase->executeCheckedAsyncSql(attributeSql.str(), [=] (swganh::database::DatabaseResult* result) {
+        if (!result) {
+            done(false,0);
+            return;
+        }
+
+        std::shared_ptr<ObjectAttributeMap> attributes = std::make_shared<ObjectAttributeMap>();
+        _readObjectAttributes(*attributes,result);
+
+        mDatabase->executeCheckedAsyncSql(adminQuery, [=] (swganh::database::DatabaseResult* result) {
+            if (!result) {
+                done(false,0);
+                return;
+            }
+
+            std::shared_ptr<AdminDataMap> admins = std::make_shared<AdminDataMap>();
+            readAdminData(*admins,result);
+
+            mDatabase->executeCheckedAsyncSql(cellQuery, [=] (swganh::database::DatabaseResult* result) {
+                if (!result) {
+                    done(false,0);
+                    return;
+                }
+
+                std::shared_ptr<CellIdMap> cells = std::make_shared<CellIdMap>();
+                std::unique_ptr<sql::ResultSet>& result_set = result->getResultSet();
+
+                while(result_set->next())
+                    (*cells)[result_set->getUInt64(2)].push_back(result_set->getUInt64(1));
+
+                mDatabase->executeCheckedAsyncSql(houseQuery, [=] (swganh::database::DatabaseResult* result) {
+                    if (!result) {
+                        done(false,0);
+                        return;
+                    }
+
+                    uint32 count = static_cast<uint32>(result->getRowCount());
+
+                    for(uint32 i = 0; i < count; i++)
+                    {
+                        HouseObject* house = new(HouseObject);
+                        _createHouse(result,house);
+
+                        ObjectAttributeMap::iterator houseAttributes = attributes->find(house->getId());
+
+                        if(houseAttributes != attributes->end())
+                        {
+                            for(ObjectAttributeList::iterator attribute = (*houseAttributes).second.begin(); attribute != (*houseAttributes).second.end(); ++attribute)
+                                house->addInternalAttribute(BString((*attribute).mKey.c_str()),(*attribute).mValue);
+                        }
+
+                        AdminDataMap::iterator admin_data = admins->find(house->getId());
+
+                        if(admin_data != admins->end())
+                            house->admin_data_ = (*admin_data).second;
+
+                        house->admin_data_.structure_id_	= house->getId();
+                        house->admin_data_.owner_id_		= house->getOwner();
+
+                        CellIdMap::iterator houseCells = cells->find(house->getId());
+
+                        if(houseCells == cells->end())
+                        {
+                            ofCallback->handleObjectReady(house,client);
+                            continue;
+                        }
+
+                        // the cells are ordered, the first one has the lowest id
+                        house->setMinCellId((*houseCells).second.front());
+
+                        // store us for later lookup
+                        mObjectLoadMap.insert(std::make_pair(house->getId(),new(mILCPool.ordered_malloc()) InLoadingContainer(house,ofCallback,client)));
+
+                        house->setLoadCount(static_cast<uint32>((*houseCells).second.size()));
+
+                        for(std::vector<uint64>::iterator cellId = (*houseCells).second.begin(); cellId != (*houseCells).second.end(); ++cellId)
+                            mCellFactory->createCell(this,*cellId,house->getId(),client);
+                    }
+
+                    done(true,count);
+                });
+            });
+        });
+    });
+}
+
+//=============================================================================
+
 void HouseFactory::_setupDatabindings()
 {
     mHouseBinding = mDatabase->createDataBinding(20);
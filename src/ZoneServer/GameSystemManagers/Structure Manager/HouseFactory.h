@@ -75,6 +75,11 @@ public:
     void			handleDatabaseJobComplete(void* ref,swganh::database::DatabaseResult* result);
     void			requestObject(ObjectFactoryCallback* ofCallback,uint64 id,uint16 subGroup,uint16 subType,DispatchClient* client);
 
+	/*	@brief loads all houses that pass the filter, a where clause on the structures s and houses h tables, with their cells.
+	*	One query each for the attributes, the admin lists, the cells and the houses
+	*/
+    void			requestObjects(ObjectFactoryCallback* ofCallback,const std::string& filter,DispatchClient* client,BulkLoadCallback done);
+
     void			releaseAllPoolsMemory();
 
 private:
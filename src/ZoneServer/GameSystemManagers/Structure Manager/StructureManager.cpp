@@ -58,6 +58,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "Common/OutOfBand.h"
 #include "MessageLib/MessageLib.h"
 #include "DatabaseManager/Database.h"
+#include "DatabaseManager/WriteBehindQueue.h"
 #include "anh/Utils/rand.h"
 #include "Utils/MathFunctions.h"
 
@@ -1259,7 +1260,7 @@ uint32 StructureManager::deductPower(PlayerObject* player, uint32 amount)
                 else
                 {
                     gMessageLib->sendResourceContainerUpdateAmount(resCont,player);
-                    mDatabase->executeSqlAsync(NULL,NULL,"UPDATE %s.resource_containers SET amount=%u WHERE id=%"PRIu64"",mDatabase->galaxy(),newAmount,resCont->getId());
+                    gWorldManager->getWriteBehindQueue()->markUint("resource_containers", resCont->getId(), "amount", newAmount);
 
                 }
 
@@ -35,7 +35,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "ZoneServer/Objects/Object/ObjectFactoryCallback.h"
 #include "ZoneServer/Objects/Tangible Object/TangibleEnums.h"
 #include "ZoneServer/WorldManager.h"
-#include "anh/utils/Scheduler.h"
+#include "anh/utils/TimingWheelScheduler.h"
 #include "ZoneServer\GameSystemManagers\UI Manager\UICallback.h"
 #include "ZoneServer\GameSystemManagers\Structure Manager\StructureManagerTypes.h"
 
@@ -40,7 +40,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "ZoneServer/GameSystemManagers/Container Manager/ContainerManager.h"
 
 #include "MessageLib/MessageLib.h"
-#include "anh/utils/Scheduler.h"
+#include "anh/utils/TimingWheelScheduler.h"
 
 SkillTeachContainer::SkillTeachContainer()
 {}
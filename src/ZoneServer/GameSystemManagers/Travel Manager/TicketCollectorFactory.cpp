@@ -109,6 +109,28 @@ void TicketCollectorFactory::requestObject(ObjectFactoryCallback* ofCallback,uin
 
 //=============================================================================
 
+void TicketCollectorFactory::requestObjects(ObjectFactoryCallback* ofCallback,const std::string& filter,DispatchClient* client,BulkLoadCallback done)
+{
+	std::stringstream sql;
+	sql << "SELECT ticket_collectors.* FROM " << mDatabase->galaxy() << ".ticket_collectors" << filter;
+
+    mDatabase->executeCheckedAsyncSql(sql.str(), [=] (swganh::database::DatabaseResult* result) {
+        if (!result) {
+            done(false,0);
+            return;
+        }
+
+        uint32 count = static_cast<uint32>(result->getRowCount());
+
+        for(uint32 i = 0; i < count; i++)
+            ofCallback->handleObjectReady(_createTicketCollector(result),client);
+
+        done(true,count);
+    });
+}
+
+//=============================================================================
+
 TicketCollector* TicketCollectorFactory::_createTicketCollector(swganh::database::DatabaseResult* result)
 {
 	if (!result->getRowCount()) {
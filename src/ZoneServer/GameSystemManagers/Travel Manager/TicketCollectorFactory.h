@@ -67,6 +67,10 @@ public:
     void			handleDatabaseJobComplete(void* ref,swganh::database::DatabaseResult* result);
     void			requestObject(ObjectFactoryCallback* ofCallback,uint64 id,uint16 subGroup,uint16 subType,DispatchClient* client);
 
+	/*	@brief loads all ticket collectors that pass the filter, joins and a where clause on the ticket_collectors table, in one query
+	*/
+    void			requestObjects(ObjectFactoryCallback* ofCallback,const std::string& filter,DispatchClient* client,BulkLoadCallback done);
+
 private:
 
     TicketCollectorFactory(swganh::app::SwganhKernel*	kernel);
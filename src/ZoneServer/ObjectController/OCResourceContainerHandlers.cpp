@@ -40,6 +40,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "ZoneServer/GameSystemManagers/Container Manager/ContainerManager.h"
 #include "MessageLib/MessageLib.h"
 #include "DatabaseManager/Database.h"
+#include "DatabaseManager/WriteBehindQueue.h"
 #include "NetworkManager/Message.h"
 
 #include <boost/lexical_cast.hpp>
@@ -92,7 +93,7 @@ void ObjectController::_handleResourceContainerTransfer(uint64 targetId,Message*
 
                 gMessageLib->sendResourceContainerUpdateAmount(targetContainer,playerObject);
 
-                mDatabase->executeSqlAsync(NULL,NULL,"UPDATE %s.resource_containers SET amount=%u WHERE id=%"PRIu64"",mDatabase->galaxy(),newAmount,targetContainer->getId());
+                gWorldManager->getWriteBehindQueue()->markUint("resource_containers", targetContainer->getId(), "amount", newAmount);
 
                 // delete old container
 				TangibleObject* container = dynamic_cast<TangibleObject*>(gWorldManager->getObjectById(selectedContainer->getParentId()));
@@ -109,9 +110,9 @@ void ObjectController::_handleResourceContainerTransfer(uint64 targetId,Message*
                 gMessageLib->sendResourceContainerUpdateAmount(targetContainer,playerObject);
                 gMessageLib->sendResourceContainerUpdateAmount(selectedContainer,playerObject);
 
-                mDatabase->executeSqlAsync(NULL,NULL,"UPDATE %s.resource_containers SET amount=%u WHERE id=%"PRIu64"",mDatabase->galaxy(),maxAmount,targetContainer->getId());
+                gWorldManager->getWriteBehindQueue()->markUint("resource_containers", targetContainer->getId(), "amount", maxAmount);
                 
-                mDatabase->executeSqlAsync(NULL,NULL,"UPDATE %s.resource_containers SET amount=%u WHERE id=%"PRIu64"",mDatabase->galaxy(),selectedNewAmount,selectedContainer->getId());
+                gWorldManager->getWriteBehindQueue()->markUint("resource_containers", selectedContainer->getId(), "amount", selectedNewAmount);
                 
             }
         }
@@ -171,7 +172,7 @@ void ObjectController::_handleResourceContainerSplit(uint64 targetId,Message* me
     }
     // update selected container contents
     selectedContainer->setAmount(selectedContainer->getAmount() - splitOffAmount);
-    mDatabase->executeSqlAsync(NULL,NULL,"UPDATE %s.resource_containers SET amount=%u WHERE id=%"PRIu64"",mDatabase->galaxy(),selectedContainer->getAmount(),selectedContainer->getId());
+    gWorldManager->getWriteBehindQueue()->markUint("resource_containers", selectedContainer->getId(), "amount", selectedContainer->getAmount());
 
     gMessageLib->sendResourceContainerUpdateAmount(selectedContainer,playerObject);
 
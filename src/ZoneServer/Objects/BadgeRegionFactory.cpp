@@ -34,6 +34,31 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 
 #include "Utils/utils.h"
 
+//=============================================================================
+
+namespace {
+
+std::shared_ptr<BadgeRegion> createBadgeRegion(std::unique_ptr<sql::ResultSet>& result_set)
+{
+    std::shared_ptr<BadgeRegion> badge_region = std::make_shared<BadgeRegion>(result_set->getUInt(2));
+
+    badge_region->setId(result_set->getUInt64(1));
+    badge_region->setRegionName(result_set->getString(3));
+    badge_region->setNameFile(result_set->getString(4));
+    badge_region->mPosition.x = result_set->getDouble(5);
+    badge_region->mPosition.z = result_set->getDouble(6);
+    badge_region->setWidth(result_set->getDouble(7));
+    badge_region->setHeight(result_set->getDouble(8));
+    badge_region->setParentId(result_set->getUInt64(9));
+    badge_region->setLoadState(LoadState_Loaded);
+
+    return badge_region;
+}
+
+}
+
+//=============================================================================
+
 BadgeRegionFactory::BadgeRegionFactory(swganh::app::SwganhKernel*	kernel) : FactoryBase(kernel)
 {}
 
@@ -64,21 +89,40 @@ void BadgeRegionFactory::requestObject(ObjectFactoryCallback* ofCallback,uint64
             LOG(warning) << "Unable to load badges with region id: " << id;
             return;
         }
-        std::shared_ptr<BadgeRegion> badge_region = std::make_shared<BadgeRegion>(result_set->getUInt(2));
-
-        badge_region->setId(result_set->getUInt64(1));
-        badge_region->setRegionName(result_set->getString(3));
-        badge_region->setNameFile(result_set->getString(4));
-        badge_region->mPosition.x = result_set->getDouble(5);
-        badge_region->mPosition.z = result_set->getDouble(6);
-        badge_region->setWidth(result_set->getDouble(7));
-        badge_region->setHeight(result_set->getDouble(8));
-        badge_region->setParentId(result_set->getUInt64(9));
-        badge_region->setLoadState(LoadState_Loaded);
-
-        ofCallback->handleObjectReady(badge_region);
+        ofCallback->handleObjectReady(createBadgeRegion(result_set));
     });
 
 }
 
+//=============================================================================
+// reads what sp_BadgeGetByRegion reads, for all regions that pass the filter
+
+void BadgeRegionFactory::requestObjects(ObjectFactoryCallback* ofCallback,const std::string& filter,DispatchClient* client,BulkLoadCallback done)
+{
+    std::stringstream sql;
+
+    sql << "SELECT badge_regions.id,badge_regions.badge_id,planet_regions.region_name,planet_regions.region_file,planet_regions.x,planet_regions.z,"
+        << "planet_regions.width,planet_regions.height,badge_regions.parent_id FROM " << mDatabase->galaxy() << ".badge_regions"
+        << " INNER JOIN " << mDatabase->galaxy() << ".planet_regions ON (badge_regions.region_id = planet_regions.region_id)"
+        << filter;
+
+    mDatabase->executeCheckedAsyncSql(sql.str(), [=] (swganh::database::DatabaseResult* result) {
+        if (!result) {
+            done(false,0);
+            return;
+        }
+
+        std::unique_ptr<sql::ResultSet>& result_set = result->getResultSet();
+        uint32 count = 0;
+
+        while(result_set->next())
+        {
+            ofCallback->handleObjectReady(createBadgeRegion(result_set));
+            count++;
+        }
+
+        done(true,count);
+    });
+}
+
 
@@ -53,7 +53,11 @@ public:
     BadgeRegionFactory(swganh::app::SwganhKernel*	kernel);
     ~BadgeRegionFactory();
     void			handleDatabaseJobComplete(void* ref,swganh::database::DatabaseResult* result);
-    void			requestObject(ObjectFactoryCallback* ofCallback,uint64 id,uint16 subGroup,uint16 subType,DispatchClient* client);  
+    void			requestObject(ObjectFactoryCallback* ofCallback,uint64 id,uint16 subGroup,uint16 subType,DispatchClient* client);
+
+	/*	@brief loads all badge regions that pass the filter, joins and a where clause on the badge_regions table, in one query
+	*/
+    void			requestObjects(ObjectFactoryCallback* ofCallback,const std::string& filter,DispatchClient* client,BulkLoadCallback done);
 };
 
 //=============================================================================
@@ -37,6 +37,37 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "City.h"
 #include "ZoneServer/Objects/Object/ObjectFactoryCallback.h"
 
+//=============================================================================
+
+namespace {
+
+void selectCities(std::stringstream& sql,const char* galaxy)
+{
+    sql << "SELECT cities.id,cities.city_name,planet_regions.region_name,planet_regions.region_file,planet_regions.x,planet_regions.z,"
+        << "planet_regions.width,planet_regions.height FROM " << galaxy << ".cities"
+		<< " INNER JOIN " << galaxy << ".planet_regions ON (cities.city_region = planet_regions.region_id)";
+}
+
+std::shared_ptr<City> createCity(std::unique_ptr<sql::ResultSet>& result_set)
+{
+    std::shared_ptr<City> city = std::make_shared<City>();
+    city->setId(result_set->getUInt64(1));
+    city->setCityName(result_set->getString(2));
+    city->setRegionName(result_set->getString(3));
+    city->setNameFile(result_set->getString(4));
+    city->mPosition.x = result_set->getDouble(5);
+    city->mPosition.z = result_set->getDouble(6);
+    city->setWidth(result_set->getDouble(7));
+    city->setHeight(result_set->getDouble(8));
+
+    city->setLoadState(LoadState_Loaded);
+
+    return city;
+}
+
+}
+
+//=============================================================================
 
 CityFactory::CityFactory(swganh::app::SwganhKernel*	kernel) : FactoryBase(kernel)
 {}
@@ -59,10 +90,8 @@ void CityFactory::requestObject(ObjectFactoryCallback* ofCallback,uint64 id,uint
     // setup our statement
 	std::stringstream sql;
     
-    sql << "SELECT cities.id,cities.city_name,planet_regions.region_name,planet_regions.region_file,planet_regions.x,planet_regions.z,"
-        << "planet_regions.width,planet_regions.height FROM " << mDatabase->galaxy() << ".cities"
-		<< " INNER JOIN " << mDatabase->galaxy() << ".planet_regions ON (cities.city_region = planet_regions.region_id)"
-        << " WHERE (cities.id = " << id << ");";
+    selectCities(sql,mDatabase->galaxy());
+    sql << " WHERE (cities.id = " << id << ");";
 
 
     mDatabase->executeAsyncSql(sql, [=] (swganh::database::DatabaseResult* result) {
@@ -77,18 +106,34 @@ void CityFactory::requestObject(ObjectFactoryCallback* ofCallback,uint64 id,uint
             return;
         }
 
-        std::shared_ptr<City> city = std::make_shared<City>();
-        city->setId(result_set->getUInt64(1));
-        city->setCityName(result_set->getString(2));
-        city->setRegionName(result_set->getString(3));
-        city->setNameFile(result_set->getString(4));
-        city->mPosition.x = result_set->getDouble(5);
-        city->mPosition.z = result_set->getDouble(6);
-        city->setWidth(result_set->getDouble(7));
-        city->setHeight(result_set->getDouble(8));
+        ofCallback->handleObjectReady(createCity(result_set));
+    });
+}
+
+//=============================================================================
+
+void CityFactory::requestObjects(ObjectFactoryCallback* ofCallback,const std::string& filter,DispatchClient* client,BulkLoadCallback done)
+{
+	std::stringstream sql;
+
+    selectCities(sql,mDatabase->galaxy());
+    sql << filter;
 
-        city->setLoadState(LoadState_Loaded);
+    mDatabase->executeCheckedAsyncSql(sql.str(), [=] (swganh::database::DatabaseResult* result) {
+        if (!result) {
+            done(false,0);
+            return;
+        }
+
+        std::unique_ptr<sql::ResultSet>& result_set = result->getResultSet();
+        uint32 count = 0;
+
+        while(result_set->next())
+        {
+            ofCallback->handleObjectReady(createCity(result_set));
+            count++;
+        }
 
-        ofCallback->handleObjectReady(city);
+        done(true,count);
     });
 }
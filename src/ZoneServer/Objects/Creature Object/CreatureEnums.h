@@ -161,6 +161,21 @@ enum CreaturePvPStatus
     CreaturePvPStatus_Duel			=	0x00000040
 };
 
+//=============================================================================
+//
+// stat lists with pending deltas, merged by the CreatureMessageBuilder at the end of a tick
+//
+
+enum CreatureStatDelta
+{
+    CreatureStatDelta_None			=	0x00,
+    CreatureStatDelta_Base			=	0x01,	// view 1
+    CreatureStatDelta_Wound			=	0x02,	// view 3
+    CreatureStatDelta_Encumberance	=	0x04,	// view 4
+    CreatureStatDelta_Current		=	0x08,	// view 6
+    CreatureStatDelta_Max			=	0x10	// view 6
+};
+
 //=============================================================================
 
 enum CreatureEquipSlot :
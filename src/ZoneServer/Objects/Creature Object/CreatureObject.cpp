@@ -47,6 +47,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "ZoneServer/WorldConfig.h"
 #include "ZoneServer/Tutorial.h"
 #include "MessageLib/MessageLib.h"
+#include "ZoneServer/Objects/Creature Object/creature_message_builder.h"
 
 // events
 #include "Zoneserver/GameSystemManagers/Event Manager/IncapRecoveryEvent.h"
@@ -111,6 +112,10 @@ CreatureObject::CreatureObject()
 , mIncapCount(0)
 , mMoodId(0)
 , mReady(false)
+, stat_delta_dirty_(CreatureStatDelta_None)
+, stat_delta_changes_(0)
+, stat_delta_frame_(0xffffffff)
+, ham_revision_(0)
 {
     mType = ObjType_Creature;
 	object_type_ = SWG_CREATURE;
@@ -1315,10 +1320,9 @@ void CreatureObject::SetStatCurrent(uint16_t stat_index, int32_t value)
 
 void CreatureObject::SetStatCurrent(uint16_t stat_index, int32_t value, boost::unique_lock<boost::mutex>& lock)
 {
-    stat_current_list_.update(stat_index, value);
-
-	auto dispatcher = GetEventDispatcher();
-	dispatcher->Dispatch(std::make_shared<CreatureObjectEvent>("CreatureObject::StatCurrent", this));
+    if(stat_current_list_.update(stat_index, value))	{
+		MarkStatDelta_(CreatureStatDelta_Current, lock);
+	}
 	//dispatcher->DispatchMainThread(std::make_shared<CreatureObjectEvent>("CreatureObject::PersistStatCurrent", (this)));
 }
 
@@ -1353,32 +1357,28 @@ void CreatureObject::AddStatCurrent(uint16_t stat_index, int32_t value)
 void CreatureObject::AddStatCurrent(uint16_t stat_index, int32_t value, boost::unique_lock<boost::mutex>& lock)
 {
     int32_t new_value = stat_current_list_[stat_index] + value;
-    stat_current_list_.update(stat_index, new_value);
+    if(stat_current_list_.update(stat_index, new_value))	{
+		MarkStatDelta_(CreatureStatDelta_Current, lock);
+	}
 	lock.unlock();
 
-	auto dispatcher = GetEventDispatcher();
-	dispatcher->Dispatch(std::make_shared<CreatureObjectEvent>("CreatureObject::StatCurrent", this));
 	//dispatcher->DispatchMainThread(std::make_shared<CreatureObjectEvent>("CreatureObject::PersistStatCurrent", (this)));
 }
 
 void CreatureObject::DeductStatCurrent(uint16_t stat_index, int32_t value)
 {
     auto lock = AcquireLock();
-    lock.unlock();
-
-	auto dispatcher = GetEventDispatcher();
-	dispatcher->Dispatch(std::make_shared<CreatureObjectEvent>("CreatureObject::StatCurrent", this));
-	//dispatcher->DispatchMainThread(std::make_shared<CreatureObjectEvent>("CreatureObject::PersistStatCurrent", (this)));
+    DeductStatCurrent(stat_index, value, lock);
 }
 
 void CreatureObject::DeductStatCurrent(uint16_t stat_index, int32_t value, boost::unique_lock<boost::mutex>& lock)
 {
     int32_t current = stat_current_list_[stat_index];
-    stat_current_list_.update(stat_index, (current > value) ? (current - value) : 0);
+    if(stat_current_list_.update(stat_index, (current > value) ? (current - value) : 0))	{
+		MarkStatDelta_(CreatureStatDelta_Current, lock);
+	}
     lock.unlock();
 
-	auto dispatcher = GetEventDispatcher();
-	dispatcher->Dispatch(std::make_shared<CreatureObjectEvent>("CreatureObject::StatCurrent", this));
 	//dispatcher->DispatchMainThread(std::make_shared<CreatureObjectEvent>("CreatureObject::PersistStatCurrent", (this)));
 }
 
@@ -1412,10 +1412,10 @@ void CreatureObject::SetStatMax(uint16_t stat_index, int32_t value)
 
 void CreatureObject::SetStatMax(uint16_t stat_index, int32_t value, boost::unique_lock<boost::mutex>& lock)
 {
-    stat_max_list_.update(stat_index, value);
-	auto dispatcher = GetEventDispatcher();
+    if(stat_max_list_.update(stat_index, value))	{
+		MarkStatDelta_(CreatureStatDelta_Max, lock);
+	}
 	lock.unlock();
-	dispatcher->Dispatch(std::make_shared<CreatureObjectEvent>("CreatureObject::StatMax", this));
 	//DISPATCH(Creature, StatMax);
 	
 
@@ -1451,10 +1451,10 @@ void CreatureObject::AddStatMax(uint16_t stat_index, int32_t value)
 
 void CreatureObject::AddStatMax(uint16_t stat_index, int32_t value, boost::unique_lock<boost::mutex>& lock)
 {
-    stat_max_list_.update(stat_index, stat_max_list_[stat_index] + value);
-	auto dispatcher = GetEventDispatcher();
+    if(stat_max_list_.update(stat_index, stat_max_list_[stat_index] + value))	{
+		MarkStatDelta_(CreatureStatDelta_Max, lock);
+	}
 	lock.unlock();
-	dispatcher->Dispatch(std::make_shared<CreatureObjectEvent>("CreatureObject::StatMax", this));
     //DISPATCH(Creature, StatMax);
 }
 
@@ -1467,11 +1467,10 @@ void CreatureObject::DeductStatMax(uint16_t stat_index, int32_t value)
 void CreatureObject::DeductStatMax(uint16_t stat_index, int32_t value, boost::unique_lock<boost::mutex>& lock)
 {
     int32_t current = stat_max_list_[stat_index];
-    stat_max_list_.update(stat_index, (current > value) ? (current - value) : 0);
-    
-	auto dispatcher = GetEventDispatcher();
+    if(stat_max_list_.update(stat_index, (current > value) ? (current - value) : 0))	{
+		MarkStatDelta_(CreatureStatDelta_Max, lock);
+	}
 	lock.unlock();
-	dispatcher->Dispatch(std::make_shared<CreatureObjectEvent>("CreatureObject::StatMax", this));
 }
 
 std::vector<int32_t> CreatureObject::GetMaxStats(void)
@@ -1526,11 +1525,10 @@ void CreatureObject::SetStatBase(uint16_t stat_index, int32_t value)
 
 void CreatureObject::SetStatBase(uint16_t stat_index, int32_t value, boost::unique_lock<boost::mutex>& lock)
 {
-    stat_base_list_.update(stat_index, value);
-
-	auto dispatcher = GetEventDispatcher();
+    if(stat_base_list_.update(stat_index, value))	{
+		MarkStatDelta_(CreatureStatDelta_Base, lock);
+	}
 	lock.unlock();
-	dispatcher->Dispatch(std::make_shared<CreatureObjectEvent>("CreatureObject::StatBase", this));
 //    DISPATCH(Creature, StatBase);
 }
 
@@ -1543,10 +1541,10 @@ void CreatureObject::AddStatBase(uint16_t stat_index, int32_t value)
 void CreatureObject::AddStatBase(uint16_t stat_index, int32_t value, boost::unique_lock<boost::mutex>& lock)
 {
     uint32_t new_stat = stat_base_list_[stat_index] + value;
-    stat_base_list_.update(stat_index, new_stat);
-	auto dispatcher = GetEventDispatcher();
+    if(stat_base_list_.update(stat_index, new_stat))	{
+		MarkStatDelta_(CreatureStatDelta_Base, lock);
+	}
 	lock.unlock();
-	dispatcher->Dispatch(std::make_shared<CreatureObjectEvent>("CreatureObject::StatBase", this));
 }
 
 void CreatureObject::DeductStatBase(uint16_t stat_index, int32_t value)
@@ -1558,11 +1556,10 @@ void CreatureObject::DeductStatBase(uint16_t stat_index, int32_t value)
 void CreatureObject::DeductStatBase(uint16_t stat_index, int32_t value, boost::unique_lock<boost::mutex>& lock)
 {
     int32_t current = stat_base_list_[stat_index];
-    stat_base_list_.update(stat_index, (current > value) ? current - value : 0);
-	
-	auto dispatcher = GetEventDispatcher();
+    if(stat_base_list_.update(stat_index, (current > value) ? current - value : 0))	{
+		MarkStatDelta_(CreatureStatDelta_Base, lock);
+	}
 	lock.unlock();
-	dispatcher->Dispatch(std::make_shared<CreatureObjectEvent>("CreatureObject::StatBase", this));
 }
 
 std::vector<int32_t> CreatureObject::GetBaseStats()
@@ -1598,6 +1595,31 @@ bool  CreatureObject::SerializeBaseStats(swganh::messages::BaseSwgMessage* messa
     return stat_base_list_.Serialize(message);
 }
 
+void CreatureObject::MarkStatDelta_(uint32_t stat_delta, boost::unique_lock<boost::mutex>& lock)
+{
+	++stat_delta_changes_;
+	stat_delta_dirty_ |= stat_delta;
+	ham_revision_.fetch_add(1, boost::memory_order_release);
+
+	// the builder is told once per flush, further changes until then only set their bit
+	uint32_t frame = CreatureMessageBuilder::GetStatDeltaFrame();
+	if(stat_delta_frame_ != frame)	{
+		stat_delta_frame_ = frame;
+		GetEventDispatcher()->Dispatch(std::make_shared<CreatureObjectEvent>("CreatureObject::StatDelta", this));
+	}
+}
+
+uint32_t CreatureObject::TakeStatDeltas(uint32_t& changes, boost::unique_lock<boost::mutex>& lock)
+{
+	uint32_t stat_delta = stat_delta_dirty_;
+	changes = stat_delta_changes_;
+
+	stat_delta_dirty_ = CreatureStatDelta_None;
+	stat_delta_changes_ = 0;
+
+	return stat_delta;
+}
+
 void CreatureObject::InitStatWound( int32_t value)
 {
     auto lock = AcquireLock();
@@ -1629,11 +1651,10 @@ void CreatureObject::SetStatWound(uint16_t stat_index, int32_t value)
 
 void CreatureObject::SetStatWound(uint16_t stat_index, int32_t value, boost::unique_lock<boost::mutex>& lock)
 {
-    stat_wound_list_.update(stat_index, value);
-    
-	auto dispatcher = GetEventDispatcher();
+    if(stat_wound_list_.update(stat_index, value))	{
+		MarkStatDelta_(CreatureStatDelta_Wound, lock);
+	}
 	lock.unlock();
-	dispatcher->Dispatch(std::make_shared<CreatureObjectEvent>("CreatureObject::StatWound", this));
 	
 }
 
@@ -1645,11 +1666,10 @@ void CreatureObject::AddStatWound(uint16_t stat_index, int32_t value)
 
 void CreatureObject::AddStatWound(uint16_t stat_index, int32_t value, boost::unique_lock<boost::mutex>& lock)
 {
-    stat_wound_list_.update(stat_index, stat_wound_list_[stat_index] + value);
-	
-	auto dispatcher = GetEventDispatcher();
+    if(stat_wound_list_.update(stat_index, stat_wound_list_[stat_index] + value))	{
+		MarkStatDelta_(CreatureStatDelta_Wound, lock);
+	}
 	lock.unlock();
-	dispatcher->Dispatch(std::make_shared<CreatureObjectEvent>("CreatureObject::StatWound", this));
 	
 }
 
@@ -1662,11 +1682,10 @@ void CreatureObject::DeductStatWound(uint16_t stat_index, int32_t value)
 void CreatureObject::DeductStatWound(uint16_t stat_index, int32_t value, boost::unique_lock<boost::mutex>& lock)
 {
     int32_t current = stat_wound_list_[stat_index];
-    stat_wound_list_.update(stat_index, (current > value) ? current - value : 0);
-	
-	auto dispatcher = GetEventDispatcher();
+    if(stat_wound_list_.update(stat_index, (current > value) ? current - value : 0))	{
+		MarkStatDelta_(CreatureStatDelta_Wound, lock);
+	}
 	lock.unlock();
-	dispatcher->Dispatch(std::make_shared<CreatureObjectEvent>("CreatureObject::StatWound", this));
 }
 
 std::vector<int32_t> CreatureObject::GetStatWounds()
@@ -1711,11 +1730,10 @@ void CreatureObject::SetStatEncumberance(uint16_t stat_index, int32_t value)
 
 void CreatureObject::SetStatEncumberance(uint16_t stat_index, int32_t value, boost::unique_lock<boost::mutex>& lock)
 {
-	stat_encumberance_list_.update(stat_index, value);
-	
-	auto dispatcher = GetEventDispatcher();
+	if(stat_encumberance_list_.update(stat_index, value))	{
+		MarkStatDelta_(CreatureStatDelta_Encumberance, lock);
+	}
 	lock.unlock();
-	dispatcher->Dispatch(std::make_shared<CreatureObjectEvent>("CreatureObject::StatEncumberance", this));
 	
 }
 
@@ -1728,11 +1746,10 @@ void CreatureObject::AddStatEncumberance(uint16_t stat_index, int32_t value)
 void CreatureObject::AddStatEncumberance(uint16_t stat_index, int32_t value, boost::unique_lock<boost::mutex>& lock)
 {
     int32_t new_stat = stat_encumberance_list_[stat_index] + value;
-    stat_encumberance_list_.update(stat_index, new_stat);
-    
-	auto dispatcher = GetEventDispatcher();
+    if(stat_encumberance_list_.update(stat_index, new_stat))	{
+		MarkStatDelta_(CreatureStatDelta_Encumberance, lock);
+	}
 	lock.unlock();
-	dispatcher->Dispatch(std::make_shared<CreatureObjectEvent>("CreatureObject::StatEncumberance", this));
 }
 
 void CreatureObject::DeductStatEncumberance(uint16_t stat_index, int32_t value)
@@ -1744,10 +1761,10 @@ void CreatureObject::DeductStatEncumberance(uint16_t stat_index, int32_t value)
 void CreatureObject::DeductStatEncumberance(uint16_t stat_index, int32_t value, boost::unique_lock<boost::mutex>& lock)
 {
     int32_t current = stat_encumberance_list_[stat_index];
-    stat_encumberance_list_.update(stat_index, (current > value) ? (current - value) : 0);
-    auto dispatcher = GetEventDispatcher();
+    if(stat_encumberance_list_.update(stat_index, (current > value) ? (current - value) : 0))	{
+		MarkStatDelta_(CreatureStatDelta_Encumberance, lock);
+	}
 	lock.unlock();
-	dispatcher->Dispatch(std::make_shared<CreatureObjectEvent>("CreatureObject::StatEncumberance", this));
 }
 
 std::vector<int32_t> CreatureObject::GetStatEncumberances()
@@ -2121,6 +2138,7 @@ void CreatureObject::SetPosture(uint8 posture)
 void CreatureObject::SetPosture(uint8 posture, boost::unique_lock<boost::mutex>& lock)
 {
     states.posture_ = posture;
+	ham_revision_.fetch_add(1, boost::memory_order_release);
 	GetEventDispatcher()->Dispatch(std::make_shared<CreatureObjectEvent>("CreatureObject::Posture", this));
 }
 
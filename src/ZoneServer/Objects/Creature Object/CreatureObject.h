@@ -34,6 +34,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include <ZoneServer\Objects\Creature Object\CreatureEnums.h>
 #include <map>
 #include <list>
+#include <boost/atomic.hpp>
 #include <MessageLib\messages\containers\network_vector.h>
 #include <MessageLib\messages\containers\network_set.h>
 #include <MessageLib\messages\containers\network_map.h>
@@ -544,6 +545,16 @@ class CreatureObject : public MovingObject// , public std::enable_shared_from_th
 		bool SerializeBaseStats(swganh::messages::BaseSwgMessage* message);
 		bool SerializeBaseStats(swganh::messages::BaseSwgMessage* message, boost::unique_lock<boost::mutex>& lock);
 
+		/**	@brief	returns the CreatureStatDelta bits of the stat lists changed since the last call and clears them
+		*	/param uint32_t& changes receives the number of stat changes recorded meanwhile
+		*/
+		uint32_t TakeStatDeltas(uint32_t& changes, boost::unique_lock<boost::mutex>& lock);
+
+		/**	@brief	counts the changes to the stat lists and the posture, the HamService uses it to tell
+		*	whether its copy of the ham of a regenerating creature is still current. Readable without the lock
+		*/
+		uint32_t GetHamRevision() const { return ham_revision_.load(boost::memory_order_acquire); }
+
 		// Battle Fatigue
 		void AddBattleFatigue(uint32_t battle_fatigue);
 		void AddBattleFatigue(uint32_t battle_fatigue, boost::unique_lock<boost::mutex>& lock);
@@ -639,6 +650,14 @@ class CreatureObject : public MovingObject// , public std::enable_shared_from_th
 		swganh::containers::NetworkVector<int32_t> stat_max_list_;
 		swganh::containers::NetworkVector<int32_t> stat_encumberance_list_;
 
+		// stat changes are announced once per tick, the builder serializes all pending list deltas in one go
+		void MarkStatDelta_(uint32_t stat_delta, boost::unique_lock<boost::mutex>& lock);
+
+		uint32_t			stat_delta_dirty_;
+		uint32_t			stat_delta_changes_;
+		uint32_t			stat_delta_frame_;
+		boost::atomic<uint32_t>	ham_revision_;
+
 		swganh::containers::NetworkSet<std::string> skills_;
 		swganh::containers::NetworkMap<std::string, SkillModStruct, SkillModStruct> skill_mod_list_;
 		
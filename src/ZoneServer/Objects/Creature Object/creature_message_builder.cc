@@ -27,6 +27,8 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 
 #include <memory>
 
+#include <boost/thread/locks.hpp>
+
 #include "ZoneServer\Objects\Object\Object_Enums.h"
 #include "ZoneServer\Objects\Creature Object\creature_message_builder.h"
 #include "ZoneServer\Objects\Creature Object\CreatureObject.h"
@@ -51,6 +53,8 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 using namespace swganh::event_dispatcher;
 using namespace swganh::messages;
 
+boost::atomic<uint32_t> CreatureMessageBuilder::stat_delta_frame_(0);
+
 void CreatureMessageBuilder::RegisterEventHandlers()
 {
 	event_dispatcher_->Subscribe("CreatureObject::StateBitmask", [this] (std::shared_ptr<EventInterface> incoming_event)
@@ -80,35 +84,13 @@ void CreatureMessageBuilder::RegisterEventHandlers()
 
     });
 
-	event_dispatcher_->Subscribe("CreatureObject::StatCurrent", [this] (std::shared_ptr<EventInterface> incoming_event)
-    {
-        auto value_event = std::static_pointer_cast<CreatureObjectEvent>(incoming_event);
-        BuildStatCurrentDelta(value_event->Get());
-
-    });
-    event_dispatcher_->Subscribe("CreatureObject::StatMax", [this] (std::shared_ptr<EventInterface> incoming_event)
-    {
-        auto value_event = std::static_pointer_cast<CreatureObjectEvent>(incoming_event);
-        BuildStatMaxDelta(value_event->Get());
-
-    });
-	event_dispatcher_->Subscribe("CreatureObject::StatEncumberance", [this] (std::shared_ptr<EventInterface> incoming_event)
-    {
-        auto value_event = std::static_pointer_cast<CreatureObjectEvent>(incoming_event);
-        BuildStatEncumberanceDelta(value_event->Get());
-
-    });
-	event_dispatcher_->Subscribe("CreatureObject::StatWound", [this] (std::shared_ptr<EventInterface> incoming_event)
+	// base, wound, encumberance, current and max stats are merged and sent by FlushStatDeltas
+	event_dispatcher_->Subscribe("CreatureObject::StatDelta", [this] (std::shared_ptr<EventInterface> incoming_event)
     {
         auto value_event = std::static_pointer_cast<CreatureObjectEvent>(incoming_event);
-        BuildStatWoundDelta(value_event->Get());
-
-    });
-	event_dispatcher_->Subscribe("CreatureObject::StatBase", [this] (std::shared_ptr<EventInterface> incoming_event)
-    {
-        auto value_event = std::static_pointer_cast<CreatureObjectEvent>(incoming_event);
-        BuildStatBaseDelta(value_event->Get());
 
+        boost::lock_guard<boost::mutex> lock(stat_delta_mutex_);
+        stat_delta_queue_.push_back(value_event->Get()->getId());
     });
 
 	event_dispatcher_->Subscribe("CreatureObject::EquipmentItem", [this] (std::shared_ptr<EventInterface> incoming_event)
@@ -170,7 +152,7 @@ void CreatureMessageBuilder::BuildEquipmentDelta(CreatureObject* const creature)
 
 void CreatureMessageBuilder::BuildStatEncumberanceDelta(CreatureObject* const creature)
 {
-	LOG(info) << "CreatureMessageBuilder::BuildStatEncumberanceDelta: " << creature->getId();
+	DLOG(info) << "CreatureMessageBuilder::BuildStatEncumberanceDelta: " << creature->getId();
 	DeltasMessage message = CreateDeltasMessage(creature, VIEW_4, 2, SWG_CREATURE);
 	if(creature->SerializeStatEncumberances(&message))
 		gMessageLib->broadcastDelta(message,creature);
@@ -179,7 +161,7 @@ void CreatureMessageBuilder::BuildStatEncumberanceDelta(CreatureObject* const cr
 
 void CreatureMessageBuilder::BuildStatCurrentDelta(CreatureObject* const  creature)
 {
-	LOG(info) << "CreatureMessageBuilder::BuildStatCurrentDelta : " << creature->getId();
+	DLOG(info) << "CreatureMessageBuilder::BuildStatCurrentDelta : " << creature->getId();
     DeltasMessage message = CreateDeltasMessage(creature, VIEW_6, 13, SWG_CREATURE);
     if(creature->SerializeCurrentStats(&message))
 		gMessageLib->broadcastDelta(message,creature);
@@ -187,7 +169,7 @@ void CreatureMessageBuilder::BuildStatCurrentDelta(CreatureObject* const  creatu
 
 void CreatureMessageBuilder::BuildStatMaxDelta(CreatureObject* const  creature)
 {
-	LOG(info) << "CreatureMessageBuilder::BuildStatMaxDelta : " << creature->getId();
+	DLOG(info) << "CreatureMessageBuilder::BuildStatMaxDelta : " << creature->getId();
     DeltasMessage message = CreateDeltasMessage(creature, VIEW_6, 14, SWG_CREATURE);
     if(creature->SerializeMaxStats(&message))
 		gMessageLib->broadcastDelta(message,creature);
@@ -195,7 +177,7 @@ void CreatureMessageBuilder::BuildStatMaxDelta(CreatureObject* const  creature)
 
 void CreatureMessageBuilder::BuildStatBaseDelta(CreatureObject* const  creature)
 {
-	LOG(info) << "CreatureMessageBuilder::BuildStatBaseDelta : " << creature->getId();
+	DLOG(info) << "CreatureMessageBuilder::BuildStatBaseDelta : " << creature->getId();
     DeltasMessage message = CreateDeltasMessage(creature, VIEW_1, 2, SWG_CREATURE);
     if(creature->SerializeBaseStats(&message))
 		gMessageLib->broadcastDelta(message,creature);
@@ -203,9 +185,111 @@ void CreatureMessageBuilder::BuildStatBaseDelta(CreatureObject* const  creature)
 
 
 
+void CreatureMessageBuilder::FlushStatDeltas()
+{
+	{
+		boost::lock_guard<boost::mutex> lock(stat_delta_mutex_);
+		stat_delta_flush_.swap(stat_delta_queue_);
+
+		// changes announced from now on belong to the next flush
+		stat_delta_frame_.fetch_add(1, boost::memory_order_release);
+	}
+
+	if(stat_delta_flush_.empty())	{
+		return;
+	}
+
+	uint64_t changes = 0;
+	uint64_t deltas_sent = 0;
+
+	for(auto id : stat_delta_flush_)
+	{
+		// a creature may have been destroyed since it announced its changes
+		auto creature = std::dynamic_pointer_cast<CreatureObject>(gWorldManager->getSharedObjectById(id));
+		if(!creature)	{
+			continue;
+		}
+
+		uint32_t creature_changes = 0;
+		deltas_sent += BuildStatDeltas(creature.get(), creature_changes);
+		changes += creature_changes;
+	}
+
+	stat_delta_flush_.clear();
+
+	boost::lock_guard<boost::mutex> lock(stat_delta_mutex_);
+	stat_delta_counters_.changes			+= changes;
+	stat_delta_counters_.deltas_sent		+= deltas_sent;
+	stat_delta_counters_.deltas_suppressed	+= changes - deltas_sent;
+}
+
+StatDeltaCounters CreatureMessageBuilder::GetStatDeltaCounters()
+{
+	boost::lock_guard<boost::mutex> lock(stat_delta_mutex_);
+	return stat_delta_counters_;
+}
+
+uint32_t CreatureMessageBuilder::BuildStatDeltas(CreatureObject* const  creature, uint32_t& changes)
+{
+	std::vector<DeltasMessage> messages;
+	
+	{
+		auto lock = creature->AcquireLock();
+
+		uint32_t stat_delta = creature->TakeStatDeltas(changes, lock);
+		if(stat_delta == CreatureStatDelta_None)	{
+			// already picked up by an earlier announcement
+			return 0;
+		}
+
+		if(stat_delta & CreatureStatDelta_Base)	{
+			DeltasMessage message = CreateDeltasMessage(creature, VIEW_1, 2, SWG_CREATURE);
+			if(creature->SerializeBaseStats(&message, lock))
+				messages.push_back(std::move(message));
+		}
+
+		if(stat_delta & CreatureStatDelta_Wound)	{
+			DeltasMessage message = CreateDeltasMessage(creature, VIEW_3, 17, SWG_CREATURE);
+			if(creature->SerializeStatWounds(&message, lock))
+				messages.push_back(std::move(message));
+		}
+
+		if(stat_delta & CreatureStatDelta_Encumberance)	{
+			DeltasMessage message = CreateDeltasMessage(creature, VIEW_4, 2, SWG_CREATURE);
+			if(creature->SerializeStatEncumberances(&message, lock))
+				messages.push_back(std::move(message));
+		}
+
+		// current and max stats share view 6 and go out as one delta with two members
+		DeltasMessage ham = CreateDeltasMessage(creature, VIEW_6, 13, SWG_CREATURE, 0);
+
+		if(stat_delta & CreatureStatDelta_Current)	{
+			DeltasMessage member = CreateDeltasMessage(creature, VIEW_6, 13, SWG_CREATURE);
+			if(creature->SerializeCurrentStats(&member, lock))
+				AppendDeltasMessage(ham, member);
+		}
+
+		if(stat_delta & CreatureStatDelta_Max)	{
+			DeltasMessage member = CreateDeltasMessage(creature, VIEW_6, 14, SWG_CREATURE);
+			if(creature->SerializeMaxStats(&member, lock))
+				AppendDeltasMessage(ham, member);
+		}
+
+		if(ham.update_count)	{
+			messages.push_back(std::move(ham));
+		}
+	}
+
+	for(auto& message : messages)	{
+		gMessageLib->broadcastDelta(message, creature);
+	}
+
+	return static_cast<uint32_t>(messages.size());
+}
+
 void CreatureMessageBuilder::BuildStatWoundDelta(CreatureObject* const  creature)
 {
-	LOG(info) << "CreatureMessageBuilder::BuildStatWoundDelta : " << creature->getId();
+	DLOG(info) << "CreatureMessageBuilder::BuildStatWoundDelta : " << creature->getId();
     DeltasMessage message = CreateDeltasMessage(creature, VIEW_3, 17, SWG_CREATURE);
     if(creature->SerializeStatWounds(&message))
 		gMessageLib->broadcastDelta(message,creature);
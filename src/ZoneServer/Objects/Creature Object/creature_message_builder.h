@@ -30,7 +30,10 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 
 #include <cstdint>
 #include <string>
+#include <vector>
+#include <boost/atomic.hpp>
 #include <boost/optional.hpp>
+#include <boost/thread/mutex.hpp>
 
 #include "ZoneServer\Objects\Tangible Object\tangible_message_builder.h"
 
@@ -42,6 +45,18 @@ namespace	event_dispatcher	{
 
 class CreatureObject;
 
+/**
+ * Counters of the coalesced stat deltas since server start.
+ */
+struct StatDeltaCounters
+{
+    StatDeltaCounters() : changes(0), deltas_sent(0), deltas_suppressed(0) {}
+
+    uint64_t changes;				// stat list updates recorded by the creatures
+    uint64_t deltas_sent;			// merged deltas broadcast
+    uint64_t deltas_suppressed;		// deltas a broadcast per change would have sent in addition
+};
+
 class CreatureMessageBuilder : public BaseMessageBuilder
 {
 public:
@@ -53,6 +68,20 @@ public:
 
     virtual void RegisterEventHandlers();
 
+    /**
+     * Broadcasts the stat changes of all creatures announced since the last call, one delta
+     * per creature and view no matter how many stats changed. Called once per zone tick.
+     */
+    void FlushStatDeltas();
+
+    StatDeltaCounters GetStatDeltaCounters();
+
+    /**
+     * The flush a stat change is announced for, creatures announce their changes again once
+     * a flush passed without picking them up.
+     */
+    static uint32_t GetStatDeltaFrame() { return stat_delta_frame_.load(boost::memory_order_acquire); }
+
     // deltas
 	static void BuildInventoryCreditsDelta(CreatureObject* const  creature);
 	static void BuildBankCreditsDelta(CreatureObject* const  creature);
@@ -98,6 +127,7 @@ public:
     static void BuildEquipmentDelta(CreatureObject* const  creature);
     static void BuildDisguiseDelta(CreatureObject* const  creature);
     static void BuildStationaryDelta(CreatureObject* const  creature);
+    static uint32_t BuildStatDeltas(CreatureObject* const  creature, uint32_t& changes);
     static void BuildUpdatePvpStatusMessage(const std::shared_ptr<CreatureObject>& object);
 
     // baselines
@@ -108,4 +138,11 @@ public:
 
 private:
     typedef swganh::event_dispatcher::ValueEvent<CreatureObject*> CreatureObjectEvent;
+
+    boost::mutex stat_delta_mutex_;
+    std::vector<uint64_t> stat_delta_queue_;
+    std::vector<uint64_t> stat_delta_flush_;
+    StatDeltaCounters stat_delta_counters_;
+
+    static boost::atomic<uint32_t> stat_delta_frame_;
 };
@@ -37,7 +37,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "ZoneServer\Objects\VehicleController.h"
 
 #include "ZoneServer/Objects/Object/ObjectFactoryCallback.h"
-#include "ZoneServer/Objects/Tangible Object/TangibleFactory.h"
+#include "ZoneServer/Objects/ItemFactory.h"
 #include "Zoneserver/Objects/VehicleControllerFactory.h"
 #include "Zoneserver/Objects/waypoints/WaypointFactory.h"
 #include "Zoneserver/Objects/waypoints/WaypointObject.h"
@@ -156,19 +156,6 @@ void DatapadFactory::handleDatabaseJobComplete(void* ref,swganh::database::Datab
     }
     break;
 
-    case DPFQuery_ItemId:
-    {
-        uint64 id;
-        swganh::database::DataBinding* binding = mDatabase->createDataBinding(1);
-
-        binding->addField(swganh::database::DFT_uint64,0,8);
-        result->getNextRow(binding,&id);
-
-        gTangibleFactory->requestObject(this,id,TanGroup_Item,0,asyncContainer->mClient);
-        mDatabase->destroyDataBinding(binding);
-    }
-    break;
-
     case DPFQuery_MSParent:
     {
         uint64 id;
@@ -206,7 +193,9 @@ void DatapadFactory::handleDatabaseJobComplete(void* ref,swganh::database::Datab
             return;
         }
         mObjectLoadMap.insert(std::make_pair(datapad->getId(),new(mILCPool.ordered_malloc()) InLoadingContainer(datapad,datapad,NULL,1)));
-        gTangibleFactory->requestObject(this,asyncContainer->mId,TanGroup_Item,0,NULL);
+
+        // the schematic comes with the item it makes
+        gItemFactory->requestItems(this,std::vector<uint64>(1,asyncContainer->mId),NULL);
 
     }
     break;
@@ -230,6 +219,11 @@ void DatapadFactory::handleDatabaseJobComplete(void* ref,swganh::database::Datab
 
         mObjectLoadMap.insert(std::make_pair(datapad->getId(),new(mILCPool.ordered_malloc()) InLoadingContainer(datapad,asyncContainer->mOfCallback,asyncContainer->mClient,static_cast<uint32>(count))));
 
+        // every kind of datapad object comes in one go, the schematics with the items they make
+        std::vector<uint64> waypoints;
+        std::vector<uint64> schematics;
+        std::vector<uint64> vehicles;
+
         for(uint32 i = 0; i < count; i++)
         {
             result->getNextRow(binding,&queryContainer);
@@ -237,24 +231,32 @@ void DatapadFactory::handleDatabaseJobComplete(void* ref,swganh::database::Datab
             if(strcmp(queryContainer.mString.getAnsi(),"waypoints") == 0)
             {
                 ++datapad->mWaypointUpdateCounter;
-                mWaypointFactory->requestObject(this,queryContainer.mId,0,0,asyncContainer->mClient);
+                waypoints.push_back(queryContainer.mId);
             }
 
             else if(strcmp(queryContainer.mString.getAnsi(),"manschematics") == 0)
             {
                 ++datapad->mManSUpdateCounter;
-                gTangibleFactory->requestObject(this,queryContainer.mId,TanGroup_Item,0,asyncContainer->mClient);
-
+                schematics.push_back(queryContainer.mId);
             }
             else if(strcmp(queryContainer.mString.getAnsi(),"vehicles") == 0)
             {
                 //datapad counter gets updated in vehicle factory
-                gVehicleControllerFactory->requestObject(this,queryContainer.mId,0,0,asyncContainer->mClient);
-
+                vehicles.push_back(queryContainer.mId);
             }
 
         }
 
+        uint64 characterId = datapad->getParentId();
+
+        // the datapad, its object count and its objects, then the waypoints and the vehicles with their attributes
+        gItemFactory->countCharacterLoad(characterId,static_cast<uint32>(waypoints.size() + vehicles.size()),
+                                         3 + (waypoints.empty() ? 0 : 1) + (vehicles.empty() ? 0 : 2));
+
+        mWaypointFactory->requestWaypoints(this,waypoints,asyncContainer->mClient);
+        gItemFactory->requestItems(this,schematics,asyncContainer->mClient,0,characterId);
+        gVehicleControllerFactory->requestVehicles(this,vehicles,asyncContainer->mClient);
+
         mDatabase->destroyDataBinding(binding);
     }
     break;
@@ -402,57 +404,16 @@ void DatapadFactory::handleObjectReady(Object* object,DispatchClient* client)
             datapad = dynamic_cast<Datapad*>(mIlc->mObject);
 
             //parentId of schematics is the datapad!
-            //add the msco to the datapad
-
+            //add the msco to the datapad, its item came along with it
             datapad->addManufacturingSchematic(dynamic_cast<ManufacturingSchematic*>(object));
 
-            //now load the associated item
-            QueryContainerBase* asContainer = new(mQueryContainerPool.ordered_malloc()) QueryContainerBase(this,DPFQuery_ItemId,NULL);
-            asContainer->mObject = datapad;
-            asContainer->mId = item->getId();//queryContainer.mId;
-            int8 sql[256];
-            sprintf(sql,"SELECT items.id FROM %s.items WHERE (parent_id=%"PRIu64")",mDatabase->galaxy(),item->getId());
-            mDatabase->executeSqlAsync(this,asContainer,sql);
-
-            mObjectLoadMap.insert(std::make_pair(item->getId(),new(mILCPool.ordered_malloc()) InLoadingContainer(datapad,0,0,1)));
-
+            mIlc->mLoadCounter--;
         }
         else
         {
-            uint64 id						= object->getParentId();
-            //we are loading the corresponding tangible object to have all the items attributes available for display/usage
-            //find the corresponding schematic
-
-            //temp mILc
-            InLoadingContainer*mIlcDPad		= _getObject(id);
-            if(!mIlcDPad)
-            {
-            	LOG(warning) << "Failed getting mIlcDPad during ObjType_Tangible";
-                return;
-            }
-            datapad							= dynamic_cast<Datapad*>(mIlcDPad->mObject);
-            _removeFromObjectLoadMap(id);
-            mILCPool.free(mIlcDPad);
-
-            //regular mIlc
-            theID							= datapad->getId();
-            mIlc							= _getObject(theID);
-
-            if(!mIlc)
-            {
-            	LOG(warning) << "Failed getting ilc during ObjType_Tangible";
-                return;
-            }
-
-            ManufacturingSchematic* schem	= datapad->getManufacturingSchematicById(id);
-
-            //this is the item associated to the Man schematic
-            //set the man schematic pointer and decrease the loadcount
-            mIlc->mLoadCounter--;
-            schem->setItem(dynamic_cast<Item*>(object));
+            LOG(warning) << "DatapadFactory::handleObjectReady : unexpected item " << object->getId() << " in datapad " << object->getParentId();
+            return;
         }
-
-
     }
     break;
 
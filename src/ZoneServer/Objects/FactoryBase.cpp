@@ -106,8 +106,6 @@ void FactoryBase::_buildAttributeMap(Object* object,swganh::database::DatabaseRe
 
     Attribute_QueryContainer	attribute;
     uint64						count = result->getRowCount();
-    int8						str[256];
-    BStringVector				dataElements;
 
     for(uint64 i = 0; i < count; i++)
     {
@@ -118,27 +116,7 @@ void FactoryBase::_buildAttributeMap(Object* object,swganh::database::DatabaseRe
             attribute.mInternal = result_set->getUInt(3);
 
             //result->getNextRow(mAttributeBinding,(void*)&attribute);
-			if(common::memcrc(attribute.mKey) == common::memcrc("cat_manf_schem_ing_resource"))
-            {
-				BString v(attribute.mValue.c_str());
-                v.split(dataElements,' ');
-                sprintf(str,"cat_manf_schem_ing_resource.\"%s",dataElements[0].getAnsi());
-
-                attribute.mKey		= str;
-                attribute.mValue	= dataElements[1].getAnsi();
-
-                //add key to the worldmanager
-				if(gWorldManager->getAttributeKey(common::memcrc(attribute.mKey)) == "")
-                {
-                    gWorldManager->mObjectAttributeKeyMap.insert(std::make_pair(common::memcrc(attribute.mKey),attribute.mKey));
-                }
-
-            }
-
-            if(attribute.mInternal)
-				object->addInternalAttribute(BString(attribute.mKey.c_str()),std::string(attribute.mValue));
-            else
-                object->addAttribute(attribute.mKey,std::string(attribute.mValue));
+            _addAttribute(object,attribute);
         }
     }
 
@@ -146,3 +124,98 @@ void FactoryBase::_buildAttributeMap(Object* object,swganh::database::DatabaseRe
 }
 
 //=============================================================================
+// the attributes of several objects in one result, the owners id leads every row
+
+void FactoryBase::_buildAttributeMaps(ObjectIdMap& objects,swganh::database::DatabaseResult* result)
+{
+    std::unique_ptr<sql::ResultSet>& result_set = result->getResultSet();
+
+    Attribute_QueryContainer	attribute;
+    uint64						count = result->getRowCount();
+
+    for(uint64 i = 0; i < count; i++)
+    {
+        if (result_set->next())
+        {
+            ObjectIdMap::iterator it = objects.find(result_set->getUInt64(1));
+
+            if(it == objects.end())
+                continue;
+
+            attribute.mKey		= result_set->getString(2);
+            attribute.mValue	= result_set->getString(3);
+            attribute.mInternal = result_set->getUInt(4);
+
+            _addAttribute((*it).second,attribute);
+        }
+    }
+
+    for(ObjectIdMap::iterator it = objects.begin(); it != objects.end(); ++it)
+        (*it).second->setLoadState(LoadState_Loaded);
+}
+
+//=============================================================================
+// holds the attributes of several objects until the objects are created, the owners id leads every row
+
+void FactoryBase::_readObjectAttributes(ObjectAttributeMap& lists,swganh::database::DatabaseResult* result)
+{
+    std::unique_ptr<sql::ResultSet>& result_set = result->getResultSet();
+
+    Attribute_QueryContainer	attribute;
+
+    while(result_set->next())
+    {
+        attribute.mKey		= result_set->getString(2);
+        attribute.mValue	= result_set->getString(3);
+        attribute.mInternal = result_set->getUInt(4);
+
+        lists[result_set->getUInt64(1)].push_back(attribute);
+    }
+}
+
+//=============================================================================
+
+void FactoryBase::_addAttributes(Object* object,ObjectAttributeMap& lists)
+{
+    ObjectAttributeMap::iterator it = lists.find(object->getId());
+
+    if(it != lists.end())
+    {
+        for(ObjectAttributeList::iterator attribute = (*it).second.begin(); attribute != (*it).second.end(); ++attribute)
+            _addAttribute(object,*attribute);
+    }
+
+    object->setLoadState(LoadState_Loaded);
+}
+
+//=============================================================================
+
+void FactoryBase::_addAttribute(Object* object,Attribute_QueryContainer& attribute)
+{
+    int8			str[256];
+    BStringVector	dataElements;
+
+    if(common::memcrc(attribute.mKey) == common::memcrc("cat_manf_schem_ing_resource"))
+    {
+        BString v(attribute.mValue.c_str());
+        v.split(dataElements,' ');
+        sprintf(str,"cat_manf_schem_ing_resource.\"%s",dataElements[0].getAnsi());
+
+        attribute.mKey		= str;
+        attribute.mValue	= dataElements[1].getAnsi();
+
+        //add key to the worldmanager
+        if(gWorldManager->getAttributeKey(common::memcrc(attribute.mKey)) == "")
+        {
+            gWorldManager->mObjectAttributeKeyMap.insert(std::make_pair(common::memcrc(attribute.mKey),attribute.mKey));
+        }
+
+    }
+
+    if(attribute.mInternal)
+        object->addInternalAttribute(BString(attribute.mKey.c_str()),std::string(attribute.mValue));
+    else
+        object->addAttribute(attribute.mKey,std::string(attribute.mValue));
+}
+
+//=============================================================================
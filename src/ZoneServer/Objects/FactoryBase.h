@@ -28,7 +28,9 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #ifndef ANH_ZONESERVER_FACTORY_BASE_H
 #define ANH_ZONESERVER_FACTORY_BASE_H
 
+#include <functional>
 #include <map>
+#include <vector>
 #include <boost/pool/pool.hpp>
 
 #include "Utils/bstring.h"
@@ -56,10 +58,19 @@ class Object;
 class Item;
 class QueryContainerBase;
 class SpawnData;
+class Attribute_QueryContainer;
 
 //=============================================================================
 
 typedef std::map<uint64,InLoadingContainer*>	ObjectLoadMap;
+typedef std::map<uint64,Object*>				ObjectIdMap;
+
+typedef std::vector<Attribute_QueryContainer>	ObjectAttributeList;
+typedef std::map<uint64,ObjectAttributeList>		ObjectAttributeMap;
+
+// told once a bulk request is through with the number of objects it created, loaded is false if one of its queries failed
+typedef std::function<void(bool loaded,uint32 count)>	BulkLoadCallback;
+typedef std::function<void(BulkLoadCallback done)>		BulkLoadRequest;
 
 //=============================================================================
 
@@ -90,6 +101,10 @@ public:
 protected:
 
     void				_buildAttributeMap(Object* object,swganh::database::DatabaseResult* result);
+    void				_buildAttributeMaps(ObjectIdMap& objects,swganh::database::DatabaseResult* result);
+    void				_readObjectAttributes(ObjectAttributeMap& lists,swganh::database::DatabaseResult* result);
+    void				_addAttributes(Object* object,ObjectAttributeMap& lists);
+    void				_addAttribute(Object* object,Attribute_QueryContainer& attribute);
 
     InLoadingContainer* _getObject(uint64 id);
     bool				_removeFromObjectLoadMap(uint64 id);
@@ -30,6 +30,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "anh/logger.h"
 
 #include "Zoneserver/Objects/Inventory.h"
+#include "ZoneServer/Objects/ItemFactory.h"
 #include "ZoneServer/Objects/Object/ObjectFactoryCallback.h"
 #include "ZoneServer/Objects/Tangible Object/TangibleFactory.h"
 #include "ZoneServer\Objects\Object\ObjectManager.h"
@@ -165,17 +166,22 @@ void InventoryFactory::handleDatabaseJobComplete(void* ref,swganh::database::Dat
 
         mObjectLoadMap.insert(std::make_pair(inventory->getId(),new(mILCPool.ordered_malloc()) InLoadingContainer(inventory,asyncContainer->mOfCallback,asyncContainer->mClient,static_cast<uint8>(count))));
 
+        // the items come with everything inside of them in a few queries per container level
+        std::vector<uint64> items;
+
         for(uint32 i = 0; i < count; i++)
         {
             result->getNextRow(binding,&queryContainer);
 
             
             if(strcmp(queryContainer.mString.getAnsi(),"items") == 0)
-                mTangibleFactory->requestObject(this,queryContainer.mId,TanGroup_Item,0,asyncContainer->mClient);
+                items.push_back(queryContainer.mId);
             else if(strcmp(queryContainer.mString.getAnsi(),"resource_containers") == 0)
                 mTangibleFactory->requestObject(this,queryContainer.mId,TanGroup_ResourceContainer,0,asyncContainer->mClient);
         }
 
+        gItemFactory->requestItems(this,items,asyncContainer->mClient,0,inventory->getParentId());
+
         mDatabase->destroyDataBinding(binding);
     }
     break;
@@ -57,11 +57,28 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "ZoneServer/WorldConfig.h"
 
 #include "Utils/utils.h"
+#include "anh/Utils/clock.h"
 
 #include <cassert>
 
 //=============================================================================
 
+namespace {
+
+void selectItemMainData(std::stringstream& sql,const char* galaxy)
+{
+	sql << "SELECT items.id,items.parent_id,items.item_family,items.item_type,items.privateowner_id,items.oX,items.oY, items.oZ,items.oW,"
+		<< "items.x,items.y,items.z,items.planet_id,items.customName,item_types.object_string,item_types.stf_name,item_types.stf_file,"
+		<< "item_types.stf_detail_name,item_types.stf_detail_file,items.maxCondition,items.damage,items.dynamicint32,"
+		<< "item_types.equipSlots,item_types.equipRestrictions, item_customization.1, item_customization.2, item_types.container "
+		<< "FROM " << galaxy << ".items INNER JOIN " << galaxy << ".item_types ON (items.item_type = item_types.id) "
+		<< "LEFT JOIN " << galaxy << ".item_customization ON (items.id = item_customization.id)";
+}
+
+}
+
+//=============================================================================
+
 bool			ItemFactory::mInsFlag    = false;
 ItemFactory*	ItemFactory::mSingleton  = NULL;
 
@@ -204,15 +221,16 @@ void ItemFactory::handleDatabaseJobComplete(void* ref,swganh::database::Database
         //otherwise enter us on the loadmap for future reference
         mObjectLoadMap.insert(std::make_pair(item->getId(),new(mILCPool.ordered_malloc()) InLoadingContainer(item,asyncContainer->mOfCallback,asyncContainer->mClient,static_cast<uint32>(count))));
 
-        // request all children
+        // request all children, the items with everything inside of them in one go
+        std::vector<uint64> items;
+
         for(uint64 i = 0; i < count; i++)
         {
             result->getNextRow(binding,&queryContainer);
 
             if(strcmp(queryContainer.mString.getAnsi(),"items") == 0)
             {
-                // increase our iteration depth
-                requestContainerContent(this,queryContainer.mId, 0, 0, asyncContainer->mClient, asyncContainer->mDepth+1);
+                items.push_back(queryContainer.mId);
             }
             else if(strcmp(queryContainer.mString.getAnsi(),"resource_containers") == 0)
             {
@@ -220,8 +238,24 @@ void ItemFactory::handleDatabaseJobComplete(void* ref,swganh::database::Database
                 gTangibleFactory->requestObject(this,queryContainer.mId,TanGroup_ResourceContainer, 0, asyncContainer->mClient);
             }
         }
+
+        // increase our iteration depth
+        requestItems(this,items,asyncContainer->mClient,asyncContainer->mDepth+1);
     }
     break;
+
+    case ItemFactoryQuery_TreeMainData:
+        _handleTreeMainData(static_cast<ItemTreeLoad*>(asyncContainer->mOfCallback),result);
+        break;
+
+    case ItemFactoryQuery_TreeAttributes:
+        _handleTreeAttributes(static_cast<ItemTreeLoad*>(asyncContainer->mOfCallback),result);
+        break;
+
+    case ItemFactoryQuery_TreeResourceContainers:
+        _handleTreeResourceContainers(static_cast<ItemTreeLoad*>(asyncContainer->mOfCallback),result);
+        break;
+
     default:
         break;
     }
@@ -238,12 +272,8 @@ void ItemFactory::requestObject(ObjectFactoryCallback* ofCallback,uint64 id,uint
 
 	std::stringstream sql;
 
-	sql << "SELECT items.id,items.parent_id,items.item_family,items.item_type,items.privateowner_id,items.oX,items.oY, items.oZ,items.oW,"
-		<< "items.x,items.y,items.z,items.planet_id,items.customName,item_types.object_string,item_types.stf_name,item_types.stf_file,"
-		<< "item_types.stf_detail_name,item_types.stf_detail_file,items.maxCondition,items.damage,items.dynamicint32,"
-		<< "item_types.equipSlots,item_types.equipRestrictions, item_customization.1, item_customization.2, item_types.container "
-		<< "FROM " << mDatabase->galaxy() << ".items INNER JOIN " << mDatabase->galaxy() << ".item_types ON (items.item_type = item_types.id) "
-		<< "LEFT JOIN " << mDatabase->galaxy() << ".item_customization ON (items.id = item_customization.id) WHERE items.id = " << id << ";";
+	selectItemMainData(sql,mDatabase->galaxy());
+	sql << " WHERE items.id = " << id << ";";
 
     mDatabase->executeSqlAsync(this,asContainer, sql.str());
    
@@ -251,33 +281,294 @@ void ItemFactory::requestObject(ObjectFactoryCallback* ofCallback,uint64 id,uint
 
 //=============================================================================
 
-void ItemFactory::requestContainerContent(ObjectFactoryCallback* ofCallback,uint64 id,uint16 subGroup,uint16 subType,DispatchClient* client, uint32 depth)
+void ItemFactory::requestItems(ObjectFactoryCallback* ofCallback,const std::vector<uint64>& ids,DispatchClient* client,uint32 depth,uint64 characterId)
 {
-    QueryContainerBase* asContainer = new(mQueryContainerPool.ordered_malloc()) QueryContainerBase(ofCallback,ItemFactoryQuery_MainData,client,id);
-    asContainer->mDepth = depth;
-
-    mDatabase->executeSqlAsync(this,asContainer,
-                               "SELECT items.id,items.parent_id,items.item_family,items.item_type,items.privateowner_id,items.oX,items.oY,"
-                               "items.oZ,items.oW,items.x,items.y,items.z,items.planet_id,items.customName,"
-                               "item_types.object_string,item_types.stf_name,item_types.stf_file,item_types.stf_detail_name,"
-                               "item_types.stf_detail_file,items.maxCondition,items.damage,items.dynamicint32,"
-                               "item_types.equipSlots,item_types.equipRestrictions, item_customization.1, item_customization.2, item_types.container "
-                               "FROM %s.items "
-                               "INNER JOIN %s.item_types ON (items.item_type = item_types.id) "
-                               "LEFT JOIN %s.item_customization ON (items.id = item_customization.id)"
-                               "WHERE items.id = %"PRIu64"",mDatabase->galaxy(),mDatabase->galaxy(),mDatabase->galaxy(),id);
-  
+    if(ids.empty())
+        return;
+
+    ItemTreeLoad* load = new ItemTreeLoad(ofCallback,client,depth,characterId);
+    load->mStartTime = Anh_Utils::Clock::getSingleton()->getLocalTime();
+
+	std::stringstream condition;
+	condition << "items.id IN (";
+
+    for(uint32 i = 0; i < ids.size(); i++)
+    {
+        if(i)
+            condition << ",";
+
+        condition << ids[i];
+    }
+
+	condition << ")";
+
+    _requestTreeLevel(load,condition.str());
+}
+
+//=============================================================================
+
+void ItemFactory::beginCharacterLoad(uint64 characterId)
+{
+    CharacterLoad& load = mCharacterLoads[characterId];
+
+    load = CharacterLoad();
+    load.mStartTime = Anh_Utils::Clock::getSingleton()->getLocalTime();
+}
+
+//=============================================================================
+
+void ItemFactory::endCharacterLoad(uint64 characterId)
+{
+    CharacterLoadMap::iterator it = mCharacterLoads.find(characterId);
+
+    if(it == mCharacterLoads.end())
+        return;
+
+    LOG(info) << "ItemFactory::endCharacterLoad : character " << characterId << " loaded " << (*it).second.mObjects << " items and datapad objects with "
+              << (*it).second.mQueries << " queries in " << (Anh_Utils::Clock::getSingleton()->getLocalTime() - (*it).second.mStartTime) << "ms";
+
+    mCharacterLoads.erase(it);
+}
+
+//=============================================================================
+
+void ItemFactory::countCharacterLoad(uint64 characterId,uint32 objects,uint32 queries)
+{
+    CharacterLoadMap::iterator it = mCharacterLoads.find(characterId);
+
+    if(it == mCharacterLoads.end())
+        return;
+
+    (*it).second.mObjects += objects;
+    (*it).second.mQueries += queries;
+}
+
+//=============================================================================
+
+void ItemFactory::_requestTreeLevel(ItemTreeLoad* load,const std::string& condition)
+{
+	std::stringstream sql;
+
+	selectItemMainData(sql,mDatabase->galaxy());
+	sql << " WHERE " << condition << ";";
+
+    load->mQueries++;
+    load->mPending++;
+
+    mDatabase->executeSqlAsync(this,new(mQueryContainerPool.ordered_malloc()) QueryContainerBase(load,ItemFactoryQuery_TreeMainData,load->mClient), sql.str());
+}
+
+//=============================================================================
+// creates the items of a level and asks for the attributes of all of them at once
+
+void ItemFactory::_handleTreeMainData(ItemTreeLoad* load,swganh::database::DatabaseResult* result)
+{
+    load->mPending--;
+
+    uint64 count = result->getRowCount();
+
+    if(count)
+    {
+        load->mLevels.push_back(std::vector<Item*>());
+        std::vector<Item*>& level = load->mLevels.back();
+
+		std::stringstream ids;
+
+        for(uint64 i = 0; i < count; i++)
+        {
+            Item* item = _createItem(result,i);
+
+            level.push_back(item);
+            load->mItems.insert(std::make_pair(item->getId(),item));
+            load->mLevel.insert(std::make_pair(item->getId(),item));
+
+            if(i)
+                ids << ",";
+
+            ids << item->getId();
+        }
+
+		std::stringstream sql;
+		sql << "SELECT item_attributes.item_id,attributes.name,item_attributes.value,attributes.internal FROM " << mDatabase->galaxy() << ".item_attributes"
+            << " INNER JOIN " << mDatabase->galaxy() << ".attributes ON (item_attributes.attribute_id = attributes.id)"
+			<< " WHERE item_attributes.item_id IN (" << ids.str() << ") ORDER BY item_attributes.item_id,item_attributes.order";
+
+        load->mQueries++;
+        load->mPending++;
+
+        mDatabase->executeSqlAsync(this,new(mQueryContainerPool.ordered_malloc()) QueryContainerBase(load,ItemFactoryQuery_TreeAttributes,load->mClient), sql.str());
+    }
+
+    _checkTreeLoad(load);
+}
+
+//=============================================================================
+// the containers of the level get their content as the next level
+
+void ItemFactory::_handleTreeAttributes(ItemTreeLoad* load,swganh::database::DatabaseResult* result)
+{
+    load->mPending--;
+
+    _buildAttributeMaps(load->mLevel,result);
+
+    // make sure we dont iterate in loops! max iteration depth should probably not exceed 5
+    uint16 ContainerDepth = gWorldConfig->getPlayerContainerDepth();
+
+	std::stringstream containers;
+    bool hasContainers = false;
+
+    for(ObjectIdMap::iterator it = load->mLevel.begin(); it != load->mLevel.end(); ++it)
+    {
+        _postProcessAttributes((*it).second);
+
+        Item* item = dynamic_cast<Item*>((*it).second);
+
+        // a manufacturing schematic holds the item it makes, it comes as the next level like container content
+        if((item->getCapacity() || item->getItemType() == ItemType_ManSchematic) && (load->mDepth <= ContainerDepth))
+        {
+            item->setLoadState(LoadState_ContainerContent);
+
+            if(hasContainers)
+                containers << ",";
+
+            containers << item->getId();
+            hasContainers = true;
+        }
+    }
+
+    load->mLevel.clear();
+
+    if(hasContainers)
+    {
+        load->mDepth++;
+
+        _requestTreeLevel(load,"items.parent_id IN (" + containers.str() + ")");
+
+		std::stringstream sql;
+		sql << "SELECT resource_containers.id FROM " << mDatabase->galaxy() << ".resource_containers"
+			<< " WHERE resource_containers.parent_id IN (" << containers.str() << ")";
+
+        load->mQueries++;
+        load->mPending++;
+
+        mDatabase->executeSqlAsync(this,new(mQueryContainerPool.ordered_malloc()) QueryContainerBase(load,ItemFactoryQuery_TreeResourceContainers,load->mClient), sql.str());
+    }
+
+    _checkTreeLoad(load);
+}
+
+//=============================================================================
+
+void ItemFactory::_handleTreeResourceContainers(ItemTreeLoad* load,swganh::database::DatabaseResult* result)
+{
+    load->mPending--;
+
+    uint64 count = result->getRowCount();
+    uint64 id;
+
+    swganh::database::DataBinding* binding = mDatabase->createDataBinding(1);
+    binding->addField(swganh::database::DFT_uint64,0,8);
+
+    // no need to worry about iteration depth with resourceContainers
+    for(uint64 i = 0; i < count; i++)
+    {
+        result->getNextRow(binding,&id);
+
+        load->mPending++;
+        gTangibleFactory->requestObject(load,id,TanGroup_ResourceContainer,0,load->mClient);
+    }
+
+    mDatabase->destroyDataBinding(binding);
+
+    _checkTreeLoad(load);
+}
+
+//=============================================================================
+// once nothing is outstanding anymore the tree is put together bottom up,
+// a container is complete before it goes into its parent
+
+void ItemFactory::_checkTreeLoad(ItemTreeLoad* load)
+{
+    if(load->mPending)
+        return;
+
+    for(uint32 level = static_cast<uint32>(load->mLevels.size()); level > 1; level--)
+    {
+        std::vector<Item*>& items = load->mLevels[level - 1];
+
+        for(std::vector<Item*>::iterator it = items.begin(); it != items.end(); ++it)
+        {
+            ObjectIdMap::iterator parent = load->mItems.find((*it)->getParentId());
+
+            (*it)->setLoadState(LoadState_Loaded);
+
+            // the schematic owns its item, it is not a world object
+            if(ManufacturingSchematic* schematic = dynamic_cast<ManufacturingSchematic*>((*parent).second))
+            {
+                schematic->setItem(*it);
+                continue;
+            }
+
+            gWorldManager->addObject(*it,true);
+            (*parent).second->InitializeObject(*it);
+        }
+    }
+
+    if(load->mCharacterId && mCharacterLoads.count(load->mCharacterId))
+    {
+        countCharacterLoad(load->mCharacterId,static_cast<uint32>(load->mItems.size()),load->mQueries);
+    }
+    else
+    {
+        LOG(info) << "ItemFactory::requestItems : loaded " << load->mItems.size() << " items in " << load->mLevels.size() << " levels with "
+                  << load->mQueries << " queries in " << (Anh_Utils::Clock::getSingleton()->getLocalTime() - load->mStartTime) << "ms";
+    }
+
+    if(!load->mLevels.empty())
+    {
+        std::vector<Item*>& items = load->mLevels.front();
+
+        for(std::vector<Item*>::iterator it = items.begin(); it != items.end(); ++it)
+        {
+            (*it)->setLoadState(LoadState_Loaded);
+            load->mOfCallback->handleObjectReady(*it,load->mClient);
+        }
+    }
+
+    delete load;
+}
+
+//=============================================================================
+//handles the ObjectReady callback of the resource containers inside of the tree
+
+void ItemTreeLoad::handleObjectReady(Object* object,DispatchClient* client)
+{
+    ObjectIdMap::iterator parent = mItems.find(object->getParentId());
+
+    if(parent != mItems.end())
+    {
+        gWorldManager->addObject(object,true);
+        (*parent).second->InitializeObject(object);
+    }
+    else
+    {
+        LOG(warning) << "ItemTreeLoad::handleObjectReady could not locate parent " << object->getParentId() << " of " << object->getId();
+    }
+
+    mPending--;
+    gItemFactory->_checkTreeLoad(this);
 }
 
 //=============================================================================
 
-Item* ItemFactory::_createItem(swganh::database::DatabaseResult* result)
+Item* ItemFactory::_createItem(swganh::database::DatabaseResult* result,uint64 row)
 {
     Item*			item;
     ItemIdentifier	itemIdentifier;
 
+    result->resetRowIndex(static_cast<int>(row));
     result->getNextRow(mItemIdentifierBinding,(void*)&itemIdentifier);
-    result->resetRowIndex();
+    result->resetRowIndex(static_cast<int>(row));
 
     switch(itemIdentifier.mFamilyId)
     {
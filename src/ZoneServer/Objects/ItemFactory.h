@@ -31,6 +31,9 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "ZoneServer/Objects/FactoryBase.h"
 #include "ZoneServer/Objects/Object/ObjectFactoryCallback.h"
 
+#include <map>
+#include <vector>
+
 #define		gItemFactory	ItemFactory::getSingletonPtr()
 
 //=============================================================================
@@ -43,6 +46,7 @@ class DataBinding;
 }}
 class DispatchClient;
 class ObjectFactoryCallback;
+class ItemTreeLoad;
 
 //=============================================================================
 
@@ -51,7 +55,10 @@ enum ItemFactoryQuery
     ItemFactoryQuery_MainData				= 1,
     ItemFactoryQuery_Attributes				= 2,
     NonPersistantItemFactoryQuery_MainData	= 3,
-    ItemFactoryQuery_Items					= 4
+    ItemFactoryQuery_Items					= 4,
+    ItemFactoryQuery_TreeMainData			= 5,
+    ItemFactoryQuery_TreeAttributes			= 6,
+    ItemFactoryQuery_TreeResourceContainers	= 7
 };
 
 //=============================================================================
@@ -76,22 +83,62 @@ public:
 	*/
 	virtual void			saveLocation(Object* object);
     void					requestObject(ObjectFactoryCallback* ofCallback,uint64 id,uint16 subGroup,uint16 subType,DispatchClient* client);
-    void					requestContainerContent(ObjectFactoryCallback* ofCallback,uint64 id,uint16 subGroup,uint16 subType,DispatchClient* client, uint32 depth = 0);
+
+	/*	@brief loads the items and everything they contain, one level of the tree at a time
+	*	every level costs a query for the items, one for their attributes and one for the resource containers
+	*	inside of them, no matter how many items there are. handleObjectReady is called for every item in ids
+	*	once the whole tree below it is loaded
+	*	/param ids the items to load, usually all the children of an inventory or a container
+	*	/param depth the container depth of the items, the tree ends at the players container depth
+	*	/param characterId the character whose load the items and queries are counted towards, 0 logs them on their own
+	*/
+    void					requestItems(ObjectFactoryCallback* ofCallback,const std::vector<uint64>& ids,DispatchClient* client,uint32 depth = 0,uint64 characterId = 0);
+
+	/*	@brief counts the items and queries of everything loaded for a character until endCharacterLoad,
+	*	which logs the totals and the time taken
+	*/
+    void					beginCharacterLoad(uint64 characterId);
+    void					endCharacterLoad(uint64 characterId);
+
+	/*	@brief counts objects loaded by other factories towards a character load, if one is running
+	*/
+    void					countCharacterLoad(uint64 characterId,uint32 objects,uint32 queries);
 
 private:
 
+    friend class ItemTreeLoad;
+
     ItemFactory(swganh::app::SwganhKernel*	kernel);
 
+    void					_requestTreeLevel(ItemTreeLoad* load,const std::string& condition);
+    void					_handleTreeMainData(ItemTreeLoad* load,swganh::database::DatabaseResult* result);
+    void					_handleTreeAttributes(ItemTreeLoad* load,swganh::database::DatabaseResult* result);
+    void					_handleTreeResourceContainers(ItemTreeLoad* load,swganh::database::DatabaseResult* result);
+    void					_checkTreeLoad(ItemTreeLoad* load);
+
     void					_postProcessAttributes(Object* object);
 
     void					_setupDatabindings();
     void					_destroyDatabindings();
 
-    Item*					_createItem(swganh::database::DatabaseResult* result);
+    Item*					_createItem(swganh::database::DatabaseResult* result,uint64 row = 0);
+
+    struct CharacterLoad
+    {
+        CharacterLoad() : mStartTime(0),mObjects(0),mQueries(0) {}
+
+        uint64				mStartTime;
+        uint32				mObjects;
+        uint32				mQueries;
+    };
+
+    typedef std::map<uint64,CharacterLoad>	CharacterLoadMap;
 
     static ItemFactory*		mSingleton;
     static bool				mInsFlag;
 
+    CharacterLoadMap		mCharacterLoads;
+
     swganh::database::DataBinding*			mItemIdentifierBinding;
     swganh::database::DataBinding*			mItemBinding;
 };
@@ -111,5 +158,38 @@ public:
 
 //=============================================================================
 
+class ItemTreeLoad : public ObjectFactoryCallback
+{
+public:
+
+    ItemTreeLoad(ObjectFactoryCallback* ofCallback,DispatchClient* client,uint32 depth,uint64 characterId)
+        : mOfCallback(ofCallback),mClient(client),mDepth(depth),mCharacterId(characterId),mStartTime(0),mQueries(0),mPending(0) {}
+
+    // the resource containers inside of our items report back here
+    virtual void			handleObjectReady(Object* object,DispatchClient* client);
+
+    ObjectFactoryCallback*	mOfCallback;
+    DispatchClient*			mClient;
+
+    // the container depth of the level currently loading
+    uint32					mDepth;
+
+    uint64					mCharacterId;
+    uint64					mStartTime;
+    uint32					mQueries;
+
+    // queries and resource containers we still wait for
+    uint32					mPending;
+
+    // the items of every level, the requested ones first
+    std::vector<std::vector<Item*> >	mLevels;
+
+    // every item of the tree, and the ones of the level waiting for their attributes
+    ObjectIdMap				mItems;
+    ObjectIdMap				mLevel;
+};
+
+//=============================================================================
+
 #endif
 
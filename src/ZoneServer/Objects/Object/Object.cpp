@@ -69,6 +69,8 @@ Object::Object()
     , mDataTransformCounter(0)
 	, mStatic(false)
     , zmapCellID(0xffffffff)
+    , zmapSlot(0xffffffff)
+    , mWorldPositionFrame(0)
 	
 {
     mDirection = glm::quat();
@@ -98,6 +100,8 @@ Object::Object(uint64 id,uint64 parentId,std::string model,ObjectType type,const
     , mTypeOptions(0)
     , mDataTransformCounter(0)
     , zmapCellID(0xffffffff)
+    , zmapSlot(0xffffffff)
+    , mWorldPositionFrame(0)
 {
     mObjectController.setObject(this);
 	custom_name_		= std::u16string();
@@ -787,6 +791,21 @@ glm::vec3 Object::getWorldPosition() const
            );
 }
 
+glm::vec3 Object::getWorldPosition(uint32 frame) const
+{
+    // outside of any parent it's just our position
+    if (! getParentId()) {
+        return mPosition;
+    }
+
+    if (mWorldPositionFrame != frame) {
+        mWorldPosition = getWorldPosition();
+        mWorldPositionFrame = frame;
+    }
+
+    return mWorldPosition;
+}
+
 //=============================================================================
 
 
@@ -261,6 +261,10 @@ public:
 	uint32						getGridBucket() const { return zmapCellID; }
 	void						setGridBucket(uint32 id){ zmapCellID = id; }
 
+	// position in the list of our grid bucket, lets the zmap remove us without searching
+	uint32						getGridSlot() const { return zmapSlot; }
+	void						setGridSlot(uint32 slot){ zmapSlot = slot; }
+
 	
 	uint32						getDataTransformCounter(){ return mDataTransformCounter; }
 	uint32						incDataTransformCounter(){ return ++mDataTransformCounter; }
@@ -297,6 +301,16 @@ public:
         */
     glm::vec3 getWorldPosition() const;
 
+    /*! The world position as getWorldPosition(), computed at most once per spatial index frame
+        *  for objects inside a parent. Range queries use it for every candidate.
+        *
+        * \param frame The current frame of the spatial index.
+        */
+    glm::vec3 getWorldPosition(uint32 frame) const;
+
+    // makes the next getWorldPosition(frame) compute the position again
+    void invalidateWorldPosition(){ mWorldPositionFrame = 0; }
+
     /*! Returns the current object's root (last containing Object in the world) parent. If the object is the root it returns itself. This is used to determine the creatures world Position in a cell
 		*	
         *
@@ -599,9 +613,13 @@ protected:
 	uint32					mTypeOptions;
 	uint32					mDataTransformCounter;
 	uint32					zmapCellID;
+	uint32					zmapSlot;
 private:
 	glm::vec3		        mLastUpdatePosition;	// Position where SI was updated.
 
+	mutable glm::vec3		mWorldPosition;			// cached by getWorldPosition(frame)
+	mutable uint32			mWorldPositionFrame;
+
 	//registered Players that are watching us
 	PlayerObjectSet				mKnownPlayers;
 
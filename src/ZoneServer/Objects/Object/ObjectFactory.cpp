@@ -1062,6 +1062,14 @@ void ObjectFactory::requestObject(ObjectType objType,uint16 subGroup,uint16 subT
         break;
     }
 }
+
+//=============================================================================
+
+void ObjectFactory::requestRegions(uint16 subGroup,ObjectFactoryCallback* ofCallback,const std::string& filter,BulkLoadCallback done,DispatchClient* client)
+{
+    mRegionFactory->requestObjects(ofCallback,subGroup,filter,client,done);
+}
+
 void ObjectFactory::releaseAllPoolsMemory()
 {
     mDbAsyncPool.release_memory();
@@ -31,6 +31,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "Object_Enums.h"
 #include "ZoneServer/Objects/Tangible Object/TangibleEnums.h"
 #include "DatabaseManager/DatabaseCallback.h"
+#include "ZoneServer/Objects/FactoryBase.h"
 #include "Utils/bstring.h"
 #include "Utils/typedefs.h"
 
@@ -98,6 +99,9 @@ public:
 
     void					requestObject(ObjectType objType,uint16 subGroup,uint16 subType,ObjectFactoryCallback* ofCallback,uint64 id,DispatchClient* client = 0);
 
+    // loads all regions of the group that pass the filter in one go, done is told how many there were
+    void					requestRegions(uint16 subGroup,ObjectFactoryCallback* ofCallback,const std::string& filter,BulkLoadCallback done,DispatchClient* client = 0);
+
     // create new objects in the database
     void					requestNewClonedItem(ObjectFactoryCallback* ofCallback,uint64 templateId,uint64 parentId);//creates a clone item after a tangible template - out of a crate for exampl
     void					requestNewDefaultItem(ObjectFactoryCallback* ofCallback,uint32 schemCrc,uint64 parentId,uint16 planetId, const glm::vec3& position, const BString& customName = "");
@@ -112,6 +112,20 @@ swganh::messages::DeltasMessage BaseMessageBuilder::CreateDeltasMessage(const Ob
     return message;
 }
 
+void BaseMessageBuilder::AppendDeltasMessage(swganh::messages::DeltasMessage& message, const swganh::messages::DeltasMessage& member)
+{
+	if(message.update_count == 0)	{
+		// the first member index is written by the message header
+		message.update_type = member.update_type;
+	}
+	else	{
+		message.data.write<uint16_t>(member.update_type);
+	}
+
+	message.data.write(member.data.data(), member.data.size());
+	message.update_count += member.update_count;
+}
+
 boost::optional<swganh::messages::BaselinesMessage> ObjectMessageBuilder::BuildBaseline3(Object* object, boost::unique_lock<boost::mutex>& lock)
 {
     auto message = CreateBaselinesMessage(object, lock, VIEW_3);
@@ -68,6 +68,11 @@ public:
 	static swganh::messages::BaselinesMessage CreateBaselinesMessage(const Object* object, boost::unique_lock<boost::mutex>& lock, uint8_t view_type, uint16_t opcount = 0) ;
 	static swganh::messages::DeltasMessage CreateDeltasMessage(const Object* object, uint8_t view_type, uint16_t update_type, uint32_t object_type, uint16_t update_count = 1) ;
 
+	/*	@brief appends the members of a delta to a delta of the same object and view, so several
+	*	members go out in one message. A message created with an update_count of 0 takes over the first member
+	*/
+	static void AppendDeltasMessage(swganh::messages::DeltasMessage& message, const swganh::messages::DeltasMessage& member) ;
+
 	/*
 	
 
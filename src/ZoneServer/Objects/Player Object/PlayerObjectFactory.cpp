@@ -44,7 +44,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "ZoneServer/Objects/Player Object/PlayerObject.h"
 #include "ZoneServer\Objects\Object\ObjectManager.h"
 
-#include "ZoneServer/Objects/Tangible Object/TangibleFactory.h"
+#include "ZoneServer/Objects/ItemFactory.h"
 #include "ZoneServer/Tutorial.h"
 #include "ZoneServer/Objects/Weapon.h"
 #include "ZoneServer/WorldConfig.h"
@@ -511,14 +511,18 @@ void PlayerObjectFactory::handleDatabaseJobComplete(void* ref,swganh::database::
 		LOG(info) << "POFQuery_EquippedItems before : " << mIlc->mLoadCounter;
         mIlc->mLoadCounter += static_cast<uint32>(count);
 		LOG(info) << "POFQuery_EquippedItems after : " << mIlc->mLoadCounter;
+        // the equipped items come with everything inside of them in a few queries per container level
+        std::vector<uint64> items;
+
         for(uint64 i = 0; i < count; i++)
         {
             result->getNextRow(binding,&id);
-            gTangibleFactory->requestObject(this,id,TanGroup_Item,0,asyncContainer->mClient);
-
+            items.push_back(id);
         }
         mDatabase->destroyDataBinding(binding);
 
+        gItemFactory->requestItems(this,items,asyncContainer->mClient,0,playerObject->GetCreature()->getId());
+
         // get the datapad here to avoid a race condition
         // request datapad
 		mDatapadFactory->requestObject(this,playerObject->GetCreature()->getId() + DATAPAD_OFFSET,TanGroup_Datapad,TanType_CharacterDatapad,asyncContainer->mClient);
@@ -692,6 +696,9 @@ void PlayerObjectFactory::requestObject(ObjectFactoryCallback* ofCallback,uint64
 {
     QueryContainerBase* asyncContainer = new(mQueryContainerPool.ordered_malloc()) QueryContainerBase(ofCallback,POFQuery_MainPlayerData,client);
 
+    // everything loaded for the character is counted until it is done
+    gItemFactory->beginCharacterLoad(id);
+
 
     int8 sql[8152];
     sprintf(sql,"SELECT characters.id,characters.parent_Id,characters.account_id,characters.oX,characters.oY,characters.oZ,characters.oW,"//7
@@ -1131,6 +1138,8 @@ void PlayerObjectFactory::handleObjectReady(Object* object,DispatchClient* clien
 
         if(!(_removeFromObjectLoadMap(creature->getId())))
             LOG(warning) << "Failed removing object from loadmap";
+
+        gItemFactory->endCharacterLoad(creature->getId());
         
         Datapad* dpad = player->getDataPad();
         if(!dpad)        {
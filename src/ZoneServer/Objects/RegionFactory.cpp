@@ -73,3 +73,26 @@ void RegionFactory::requestObject(ObjectFactoryCallback* ofCallback,uint64 id,ui
         break;
     }
 }
+
+//=============================================================================
+
+void RegionFactory::requestObjects(ObjectFactoryCallback* ofCallback,uint16 subGroup,const std::string& filter,DispatchClient* client,BulkLoadCallback done)
+{
+    switch(subGroup)
+    {
+    case Region_City:
+        mCityFactory->requestObjects(ofCallback,filter,client,done);
+        break;
+    case Region_Badge:
+        mBadgeRegionFactory->requestObjects(ofCallback,filter,client,done);
+        break;
+    case Region_Spawn:
+        mSpawnRegionFactory->requestObjects(ofCallback,filter,client,done);
+        break;
+
+    default:
+        LOG(error) << "Unknown group [" << subGroup << "]";
+        done(false,0);
+        break;
+    }
+}
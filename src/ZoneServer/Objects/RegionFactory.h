@@ -55,6 +55,10 @@ public:
 
     virtual void			handleDatabaseJobComplete(void* ref,swganh::database::DatabaseResult* result) {}
     void					requestObject(ObjectFactoryCallback* ofCallback,uint64 id,uint16 subGroup,uint16 subType,DispatchClient* client);
+
+	/*	@brief loads all regions of the group that pass the filter in one query
+	*/
+    void					requestObjects(ObjectFactoryCallback* ofCallback,uint16 subGroup,const std::string& filter,DispatchClient* client,BulkLoadCallback done);
     
     void					releaseAllPoolsMemory();
 private:
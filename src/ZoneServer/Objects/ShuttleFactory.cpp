@@ -40,6 +40,19 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 
 //=============================================================================
 
+namespace {
+
+void selectShuttles(std::stringstream& sql,const char* galaxy)
+{
+	sql <<"SELECT shuttles.id,shuttles.parentId,shuttles.firstName,shuttles.lastName,shuttles.oX,shuttles.oY,shuttles.oZ,shuttles.oW,shuttles.x,shuttles.y,shuttles.z,"
+		<< "shuttle_types.object_string,shuttle_types.name,shuttle_types.file,shuttles.awayTime,shuttles.inPortTime,shuttles.collectorId "
+		<< "FROM " << galaxy << ".shuttles INNER JOIN " << galaxy << ".shuttle_types ON (shuttles.shuttle_type = shuttle_types.id)";
+}
+
+}
+
+//=============================================================================
+
 bool			ShuttleFactory::mInsFlag    = false;
 ShuttleFactory*	ShuttleFactory::mSingleton  = NULL;
 
@@ -110,10 +123,8 @@ void ShuttleFactory::requestObject(ObjectFactoryCallback* ofCallback, uint64 id,
 {
 	std::stringstream sql;
 
-	sql <<"SELECT shuttles.id,shuttles.parentId,shuttles.firstName,shuttles.lastName,shuttles.oX,shuttles.oY,shuttles.oZ,shuttles.oW,shuttles.x,shuttles.y,shuttles.z,"
-		<< "shuttle_types.object_string,shuttle_types.name,shuttle_types.file,shuttles.awayTime,shuttles.inPortTime,shuttles.collectorId "
-		<< "FROM " << mDatabase->galaxy() << ".shuttles INNER JOIN " << mDatabase->galaxy() << ".shuttle_types ON (shuttles.shuttle_type = shuttle_types.id) "
-		<< "WHERE (shuttles.id = " << id << ")";
+	selectShuttles(sql,mDatabase->galaxy());
+	sql << " WHERE (shuttles.id = " << id << ")";
 
     mDatabase->executeSqlAsync(this,new(mQueryContainerPool.ordered_malloc()) QueryContainerBase(ofCallback,SHFQuery_MainData,client), sql.str());
                                                               
@@ -122,6 +133,30 @@ void ShuttleFactory::requestObject(ObjectFactoryCallback* ofCallback, uint64 id,
 
 //=============================================================================
 
+void ShuttleFactory::requestObjects(ObjectFactoryCallback* ofCallback,const std::string& filter,DispatchClient* client,BulkLoadCallback done)
+{
+	std::stringstream sql;
+
+	selectShuttles(sql,mDatabase->galaxy());
+	sql << filter;
+
+    mDatabase->executeCheckedAsyncSql(sql.str(), [=] (swganh::database::DatabaseResult* result) {
+        if (!result) {
+            done(false,0);
+            return;
+        }
+
+        uint32 count = static_cast<uint32>(result->getRowCount());
+
+        for(uint32 i = 0; i < count; i++)
+            ofCallback->handleObjectReady(_createShuttle(result),client);
+
+        done(true,count);
+    });
+}
+
+//=============================================================================
+
 Shuttle* ShuttleFactory::_createShuttle(swganh::database::DatabaseResult* result)
 {
     if (!result->getRowCount()) {
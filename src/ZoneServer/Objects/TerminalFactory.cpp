@@ -26,6 +26,9 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 */
 
 #include "TerminalFactory.h"
+
+#include <cppconn/resultset.h>
+
 #include "ZoneServer/Objects/BankTerminal.h"
 #include "Zoneserver/Objects/PlayerStructureTerminal.h"
 #include "BazaarTerminal.h"
@@ -44,6 +47,20 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 
 //=============================================================================
 
+namespace {
+
+void selectTerminals(std::stringstream& sql,const char* galaxy)
+{
+	sql << "SELECT terminals.id, terminals.parent_id, terminals.oX, terminals.oY, terminals.oZ,terminals.oW,terminals.x,"
+		<< "terminals.y,terminals.z,terminals.terminal_type,terminal_types.object_string,terminal_types.name,terminal_types.file,"
+		<< "terminals.dataStr,terminals.dataInt1,terminals.customName"
+		<< " FROM " << galaxy << ".terminals INNER JOIN " << galaxy << ".terminal_types ON (terminals.terminal_type = terminal_types.id)";
+}
+
+}
+
+//=============================================================================
+
 bool				TerminalFactory::mInsFlag    = false;
 TerminalFactory*	TerminalFactory::mSingleton  = NULL;
 
@@ -160,18 +177,117 @@ void TerminalFactory::handleDatabaseJobComplete(void* ref,swganh::database::Data
 
 void TerminalFactory::requestObject(ObjectFactoryCallback* ofCallback,uint64 id,uint16 subGroup,uint16 subType,DispatchClient* client)
 {
-    mDatabase->executeSqlAsync(this,new(mQueryContainerPool.ordered_malloc()) QueryContainerBase(ofCallback,TFQuery_MainData,client),
-                               "SELECT terminals.id, terminals.parent_id, terminals.oX, terminals.oY, terminals.oZ,terminals.oW,terminals.x,"
-                               "terminals.y,terminals.z,terminals.terminal_type,terminal_types.object_string,terminal_types.name,terminal_types.file,"
-                               "terminals.dataStr,terminals.dataInt1,terminals.customName"
-                               " FROM %s.terminals INNER JOIN %s.terminal_types ON (terminals.terminal_type = terminal_types.id)"
-                               " WHERE (terminals.id = %"PRIu64")",mDatabase->galaxy(),mDatabase->galaxy(), id);
-  
+	std::stringstream sql;
+
+	selectTerminals(sql,mDatabase->galaxy());
+	sql << " WHERE (terminals.id = " << id << ")";
+
+    mDatabase->executeSqlAsync(this,new(mQueryContainerPool.ordered_malloc()) QueryContainerBase(ofCallback,TFQuery_MainData,client),sql.str());
+}
+
+//=============================================================================
+// nothing is handed out before the elevators have their destinations, a failed query drops all of them
+
+void TerminalFactory::requestObjects(ObjectFactoryCallback* ofCallback,const std::string& filter,DispatchClient* client,BulkLoadCallback done)
+{
+	std::stringstream sql;
+
+	selectTerminals(sql,mDatabase->galaxy());
+	sql << filter;
+
+    mDatabase->executeCheckedAsyncSql(sql.str(), [=] (swganh::database::DatabaseResult* result) {
+        if (!result) {
+            done(false,0);
+            return;
+        }
+
+        std::shared_ptr<std::vector<Terminal*>> terminals = std::make_shared<std::vector<Terminal*>>();
+        std::shared_ptr<ObjectIdMap> elevators = std::make_shared<ObjectIdMap>();
+        uint64 count = result->getRowCount();
+
+		std::stringstream ids;
+
+        for(uint64 i = 0; i < count; i++)
+        {
+            Terminal* terminal = _createTerminal(result,i);
+
+            terminals->push_back(terminal);
+
+            if(terminal->getLoadState() == LoadState_Loaded)
+                continue;
+
+            if(!elevators->empty())
+                ids << ",";
+
+            ids << terminal->getId();
+            elevators->insert(std::make_pair(terminal->getId(),terminal));
+        }
+
+        auto deliver = [=] () {
+            for(std::vector<Terminal*>::iterator it = terminals->begin(); it != terminals->end(); ++it)
+                ofCallback->handleObjectReady(*it,client);
+
+            done(true,static_cast<uint32>(terminals->size()));
+        };
+
+        if(elevators->empty())
+        {
+            deliver();
+            return;
+        }
+
+		std::stringstream elevatorSql;
+		elevatorSql << "SELECT * FROM " << mDatabase->galaxy() << ".terminal_elevator_data WHERE id IN (" << ids.str() << ") ORDER BY id,direction";
+
+        mDatabase->executeCheckedAsyncSql(elevatorSql.str(), [=] (swganh::database::DatabaseResult* result) {
+            if (!result) {
+                for(std::vector<Terminal*>::iterator it = terminals->begin(); it != terminals->end(); ++it)
+                    delete(*it);
+
+                done(false,0);
+                return;
+            }
+
+            // the rows of an elevator are ordered by direction. A one way elevator takes its first row, one going both
+            // ways its first two, up is first
+            std::map<uint64,uint32> rowsRead;
+            uint64 rowCount = result->getRowCount();
+
+            for(uint64 i = 0; i < rowCount; i++)
+            {
+                result->resetRowIndex(static_cast<int>(i));
+                result->getResultSet()->next();
+
+                ObjectIdMap::iterator it = elevators->find(result->getResultSet()->getUInt64(1));
+
+                if(it == elevators->end())
+                    continue;
+
+                ElevatorTerminal* terminal = dynamic_cast<ElevatorTerminal*>((*it).second);
+                uint32 read = rowsRead[terminal->getId()]++;
+
+                if(read > 1 || (read == 1 && terminal->mTanType != TanType_ElevatorTerminal))
+                    continue;
+
+                result->resetRowIndex(static_cast<int>(i));
+
+                if(terminal->mTanType == TanType_ElevatorUpTerminal || (terminal->mTanType == TanType_ElevatorTerminal && read == 0))
+                    result->getNextRow(mElevetorDataUpBinding,(void*)terminal);
+                else
+                    result->getNextRow(mElevetorDataDownBinding,(void*)terminal);
+            }
+
+            for(ObjectIdMap::iterator it = elevators->begin(); it != elevators->end(); ++it)
+                (*it).second->setLoadState(LoadState_Loaded);
+
+            deliver();
+        });
+    });
 }
 
 //=============================================================================
 
-Terminal* TerminalFactory::_createTerminal(swganh::database::DatabaseResult* result)
+Terminal* TerminalFactory::_createTerminal(swganh::database::DatabaseResult* result,uint64 row)
 {
     if (!result->getRowCount()) {
     	return nullptr;
@@ -183,8 +299,9 @@ Terminal* TerminalFactory::_createTerminal(swganh::database::DatabaseResult* res
     swganh::database::DataBinding* typeBinding = mDatabase->createDataBinding(1);
     typeBinding->addField(swganh::database::DFT_uint32, 0, 4, 9);
 
+    result->resetRowIndex(static_cast<int>(row));
     result->getNextRow(typeBinding, &tanType);
-    result->resetRowIndex();
+    result->resetRowIndex(static_cast<int>(row));
 
     mDatabase->destroyDataBinding(typeBinding);
 
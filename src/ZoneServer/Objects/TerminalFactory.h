@@ -67,6 +67,11 @@ public:
     void			handleDatabaseJobComplete(void* ref,swganh::database::DatabaseResult* result);
     void			requestObject(ObjectFactoryCallback* ofCallback,uint64 id,uint16 subGroup,uint16 subType,DispatchClient* client);
 
+	/*	@brief loads all terminals that pass the filter, joins and a where clause on the terminals and terminal_types tables.
+	*	One query for all of them and one for the destinations of the elevators among them
+	*/
+    void			requestObjects(ObjectFactoryCallback* ofCallback,const std::string& filter,DispatchClient* client,BulkLoadCallback done);
+
 private:
 
     TerminalFactory(swganh::app::SwganhKernel*	kernel);
@@ -74,7 +79,7 @@ private:
     void			_setupDatabindings();
     void			_destroyDatabindings();
 
-    Terminal*		_createTerminal(swganh::database::DatabaseResult* result);
+    Terminal*		_createTerminal(swganh::database::DatabaseResult* result,uint64 row = 0);
 
     static TerminalFactory*		mSingleton;
     static bool					mInsFlag;
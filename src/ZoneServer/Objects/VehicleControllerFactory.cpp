@@ -41,6 +41,8 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "DatabaseManager/DatabaseResult.h"
 #include "DatabaseManager/DataBinding.h"
 
+#include <cppconn/resultset.h>
+
 #include "ZoneServer\Objects\Object\ObjectManager.h"
 
 #include "MessageLib/MessageLib.h"
@@ -101,6 +103,78 @@ void VehicleControllerFactory::requestObject(ObjectFactoryCallback* ofCallback,u
 
 //=============================================================================
 
+void VehicleControllerFactory::requestVehicles(ObjectFactoryCallback* ofCallback,const std::vector<uint64>& ids,DispatchClient* client)
+{
+    if(ids.empty())
+        return;
+
+    std::stringstream idList;
+
+    for(uint32 i = 0; i < ids.size(); i++)
+    {
+        if(i)
+            idList << ",";
+
+        idList << ids[i];
+    }
+
+    std::stringstream sql;
+    sql << "SELECT vehicles.id, vehicle_types.vehicle_object_string, vehicle_types.vehicle_itno_object_string, vehicle_types.vehicle_name_file,"
+        << " vehicle_types.vehicle_detail_file, vehicle_types.vehicle_name, vehicles.vehicle_types_id, vehicles.parent, vehicles.vehicle_hitpoint_loss,"
+        << " vehicles.vehicle_incline_acceleration, vehicles.vehicle_flat_acceleration"
+        << " FROM " << mDatabase->galaxy() << ".vehicles INNER JOIN " << mDatabase->galaxy() << ".vehicle_types ON (vehicles.vehicle_types_id = vehicle_types.id)"
+        << " WHERE vehicles.id IN (" << idList.str() << ")";
+
+    std::string attributeSql = "SELECT vehicle_attributes.vehicles_id, attributes.name, vehicle_attributes.attribute_value, attributes.internal"
+                               " FROM " + std::string(mDatabase->galaxy()) + ".attributes"
+                               " INNER JOIN " + std::string(mDatabase->galaxy()) + ".vehicle_attributes ON (attributes.id = vehicle_attributes.attribute_id)"
+                               " WHERE vehicle_attributes.vehicles_id IN (" + idList.str() + ") ORDER BY vehicle_attributes.vehicles_id, vehicle_attributes.attribute_order";
+
+    mDatabase->executeAsyncSql(sql, [=] (swganh::database::DatabaseResult* result) {
+        if (!result) {
+            return;
+        }
+
+        std::shared_ptr<ObjectIdMap> vehicles = std::make_shared<ObjectIdMap>();
+        uint64 count = result->getRowCount();
+
+        for(uint64 i = 0; i < count; i++)
+        {
+            VehicleController* vehicle = new VehicleController();
+
+            result->getNextRow(mVehicle_Binding,vehicle);
+
+            vehicle->setId(result->getResultSet()->getUInt64(1));
+            vehicle->setDetail(vehicle->getName().getAnsi());
+
+            vehicles->insert(std::make_pair(vehicle->getId(),vehicle));
+        }
+
+        if (vehicles->empty()) {
+            return;
+        }
+
+        mDatabase->executeAsyncSql(attributeSql, [=] (swganh::database::DatabaseResult* result) {
+            if (!result) {
+                return;
+            }
+
+            // sets the vehicles loaded as well
+            _buildAttributeMaps(*vehicles,result);
+
+            for(ObjectIdMap::iterator it = vehicles->begin(); it != vehicles->end(); ++it)
+            {
+                if(ofCallback == this)
+                    handleObjectReady((*it).second,client);
+                else
+                    ofCallback->handleObjectReady((*it).second,client);
+            }
+        });
+    });
+}
+
+//=============================================================================
+
 void VehicleControllerFactory::handleDatabaseJobComplete(void* ref,swganh::database::DatabaseResult* result)
 {
     QueryContainerBase* asyncContainer = reinterpret_cast<QueryContainerBase*>(ref);
@@ -261,6 +335,19 @@ void VehicleControllerFactory::_setupDatabindings()
     mVehicleCreo_Binding->addField(swganh::database::DFT_uint32,offsetof(VehicleController,incline_acceleration_),4,3);
     mVehicleCreo_Binding->addField(swganh::database::DFT_uint32,offsetof(VehicleController,flat_acceleration_),4,4);
 
+    //vehicles.id, the itno fields, then the creo fields
+    mVehicle_Binding = mDatabase->createDataBinding(10);
+	mVehicle_Binding->addField(swganh::database::DFT_stdstring,offsetof(VehicleController,mPhysicalModel),256,1);
+	mVehicle_Binding->addField(swganh::database::DFT_stdstring,offsetof(VehicleController,template_string_),256,2);
+    mVehicle_Binding->addField(swganh::database::DFT_bstring,offsetof(VehicleController,mNameFile),64,3);
+    mVehicle_Binding->addField(swganh::database::DFT_bstring,offsetof(VehicleController,mDetailFile),64,4);
+    mVehicle_Binding->addField(swganh::database::DFT_bstring,offsetof(VehicleController,mName),64,5);
+    mVehicle_Binding->addField(swganh::database::DFT_uint32,offsetof(VehicleController,type_id_),4,6);
+    mVehicle_Binding->addField(swganh::database::DFT_uint64,offsetof(VehicleController,mParentId),8,7);
+    mVehicle_Binding->addField(swganh::database::DFT_uint32,offsetof(VehicleController,hit_point_loss_),4,8);
+    mVehicle_Binding->addField(swganh::database::DFT_uint32,offsetof(VehicleController,incline_acceleration_),4,9);
+    mVehicle_Binding->addField(swganh::database::DFT_uint32,offsetof(VehicleController,flat_acceleration_),4,10);
+
 
 }
 //=============================================================================
@@ -269,6 +356,7 @@ void VehicleControllerFactory::_destroyDatabindings()
 {
     mDatabase->destroyDataBinding(mVehicleItno_Binding);
     mDatabase->destroyDataBinding(mVehicleCreo_Binding);
+    mDatabase->destroyDataBinding(mVehicle_Binding);
 }
 
 //=============================================================================
@@ -31,6 +31,8 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "ZoneServer/Objects/FactoryBase.h"
 #include "ZoneServer/Objects/Object/ObjectFactoryCallback.h"
 
+#include <vector>
+
 //Forward Declerations
 class Database;
 class swganh::database::DatabaseCallback;
@@ -74,6 +76,11 @@ public:
     void					requestObject(ObjectFactoryCallback* ofCallback,uint64 id,uint16 subGroup,uint16 subType,DispatchClient* client);
     void					createVehicle(uint32 vehicle_type,PlayerObject* targetPlayer);
 
+	/*	@brief loads the vehicles with one query for them and one for all their attributes,
+	*	handleObjectReady is called for every one of them
+	*/
+    void					requestVehicles(ObjectFactoryCallback* ofCallback,const std::vector<uint64>& ids,DispatchClient* client);
+
 
 private:
 
@@ -89,6 +96,7 @@ private:
 
     swganh::database::DataBinding*				mVehicleItno_Binding;
     swganh::database::DataBinding*				mVehicleCreo_Binding;
+    swganh::database::DataBinding*				mVehicle_Binding;
 
 };
 
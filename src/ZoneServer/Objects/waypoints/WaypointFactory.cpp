@@ -37,6 +37,19 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 
 //=============================================================================
 
+namespace {
+
+void selectWaypoints(std::stringstream& sql,const char* galaxy)
+{
+	sql <<	"SELECT waypoints.waypoint_id,waypoints.owner_id,waypoints.x,waypoints.y,waypoints.z, waypoints.name,planet.name, waypoints.planet_id, "
+		<<	"waypoints.active,waypoints.type FROM "	<<	galaxy	<<	".waypoints INNER JOIN " <<	galaxy
+		<<	".planet ON (waypoints.planet_id = planet.planet_id)";
+}
+
+}
+
+//=============================================================================
+
 bool				WaypointFactory::mInsFlag    = false;
 WaypointFactory*	WaypointFactory::mSingleton  = NULL;
 
@@ -92,6 +105,22 @@ void WaypointFactory::handleDatabaseJobComplete(void* ref,swganh::database::Data
     }
     break;
 
+    case WaypointFQuery_Waypoints:
+    {
+        uint64 count = result->getRowCount();
+
+        for(uint64 i = 0; i < count; i++)
+        {
+            std::shared_ptr<WaypointObject> waypoint = _createWaypoint(result);
+
+            // can't check waypoints on other planets in tutorial
+            if (!gWorldConfig->isTutorial())	{
+                asyncContainer->mOfCallback->handleObjectReady(waypoint);
+            }
+        }
+    }
+    break;
+
     default:
         break;
     }
@@ -104,9 +133,8 @@ void WaypointFactory::handleDatabaseJobComplete(void* ref,swganh::database::Data
 void WaypointFactory::requestObject(ObjectFactoryCallback* ofCallback,uint64 id,uint16 subGroup,uint16 subType,DispatchClient* client)
 {
 	std::stringstream sql;
-	sql <<	"SELECT waypoints.waypoint_id,waypoints.owner_id,waypoints.x,waypoints.y,waypoints.z, waypoints.name,planet.name, waypoints.planet_id, "
-		<<	"waypoints.active,waypoints.type FROM "	<<	mDatabase->galaxy()	<<	".waypoints INNER JOIN " <<	mDatabase->galaxy()
-		<<	".planet ON (waypoints.planet_id = planet.planet_id) WHERE (waypoints.waypoint_id = " << id << ");";
+	selectWaypoints(sql,mDatabase->galaxy());
+	sql <<	" WHERE (waypoints.waypoint_id = " << id << ");";
     
 	mDatabase->executeSqlAsync(this,new(mQueryContainerPool.ordered_malloc()) QueryContainerBase(ofCallback,WaypointFQuery_MainData,client), sql.str());
                                
@@ -115,6 +143,30 @@ void WaypointFactory::requestObject(ObjectFactoryCallback* ofCallback,uint64 id,
 
 //=============================================================================
 
+void WaypointFactory::requestWaypoints(ObjectFactoryCallback* ofCallback,const std::vector<uint64>& ids,DispatchClient* client)
+{
+    if(ids.empty())
+        return;
+
+	std::stringstream sql;
+	selectWaypoints(sql,mDatabase->galaxy());
+	sql <<	" WHERE waypoints.waypoint_id IN (";
+
+    for(uint32 i = 0; i < ids.size(); i++)
+    {
+        if(i)
+            sql << ",";
+
+        sql << ids[i];
+    }
+
+	sql <<	");";
+
+	mDatabase->executeSqlAsync(this,new(mQueryContainerPool.ordered_malloc()) QueryContainerBase(ofCallback,WaypointFQuery_Waypoints,client), sql.str());
+}
+
+//=============================================================================
+
 std::shared_ptr<WaypointObject> WaypointFactory::_createWaypoint(swganh::database::DatabaseResult* result)
 {
 	std::shared_ptr<WaypointObject> waypoint = std::make_shared<WaypointObject>();
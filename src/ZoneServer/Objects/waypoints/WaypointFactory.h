@@ -30,6 +30,8 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 
 #include "ZoneServer/Objects/FactoryBase.h"
 
+#include <vector>
+
 #define	 gWaypointFactory	WaypointFactory::getSingletonPtr()
 
 //=============================================================================
@@ -47,7 +49,8 @@ class WaypointObject;
 
 enum WaypointFQuery
 {
-    WaypointFQuery_MainData	= 1
+    WaypointFQuery_MainData	= 1,
+    WaypointFQuery_Waypoints	= 2
 };
 
 //=============================================================================
@@ -66,6 +69,10 @@ public:
     void			handleDatabaseJobComplete(void* ref,swganh::database::DatabaseResult* result);
     void			requestObject(ObjectFactoryCallback* ofCallback,uint64 id,uint16 subGroup,uint16 subType,DispatchClient* client);
 
+	/*	@brief loads the waypoints in one query, handleObjectReady is called for every one of them
+	*/
+    void			requestWaypoints(ObjectFactoryCallback* ofCallback,const std::vector<uint64>& ids,DispatchClient* client);
+
 private:
 
     WaypointFactory(swganh::app::SwganhKernel*	kernel);
@@ -35,6 +35,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "Common/Event.h"
 
 #include "DatabaseManager/Database.h"
+#include "DatabaseManager/WriteBehindQueue.h"
 #include "DatabaseManager/DataBinding.h"
 #include "DatabaseManager/DatabaseResult.h"
 
@@ -654,10 +655,7 @@ void	ArtisanManager::finishSampling(PlayerObject* player, CurrentResource* resou
 
                     gMessageLib->sendResourceContainerUpdateAmount(resCont,player);
 
-                    stringstream query_stream;
-                    query_stream << "UPDATE "<<gWorldManager->getKernel()->GetDatabase()->galaxy()<<".resource_containers SET amount=" << newAmount
-                                 << " WHERE id=" << resCont->getId();
-                    gWorldManager->getKernel()->GetDatabase()->executeAsyncSql(query_stream);
+                    gWorldManager->getWriteBehindQueue()->markUint("resource_containers", resCont->getId(), "amount", newAmount);
                 }
                 // target container full, put in what fits, create a new one
                 else if(newAmount > maxAmount)
@@ -667,10 +665,7 @@ void	ArtisanManager::finishSampling(PlayerObject* player, CurrentResource* resou
                     resCont->setAmount(maxAmount);
 
                     gMessageLib->sendResourceContainerUpdateAmount(resCont,player);
-                    stringstream query_stream;
-                    query_stream << "UPDATE "<<gWorldManager->getKernel()->GetDatabase()->galaxy()<<".resource_containers SET amount=" << newAmount
-                                 << " WHERE id=" << resCont->getId();
-                    gWorldManager->getKernel()->GetDatabase()->executeAsyncSql(query_stream);
+                    gWorldManager->getWriteBehindQueue()->markUint("resource_containers", resCont->getId(), "amount", maxAmount);
                     gObjectFactory->requestNewResourceContainer(inventory,resource->getId(),inventory->getId(),99,selectedNewAmount);
                 }
 
@@ -28,8 +28,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "ZoneServer\Services\ham\ham_service.h"
 
 #include <boost/asio/placeholders.hpp>
-
-#include <map>
+#include <boost/thread/locks.hpp>
 
 #include <ZoneServer\Services\scene_events.h>
 #include <ZoneServer\Worldmanager.h>
@@ -427,18 +426,30 @@ bool HamService::ApplyModifiedHamCosts(CreatureObject* creature, int32_t healthC
 
 void HamService::addToRegeneration(uint64 id)
 {
-	auto find_itr = reg_.find(id);
-	if(find_itr != reg_.end())	{
+	boost::lock_guard<boost::mutex> lock(mutex_);
+
+	uint32_t slot;
+	if(regeneration_.Find(id, slot))	{
 		DLOG (info) << "HamManager::UpdateCurrentHitpoints : " << id << "was already on the regenration timer";
 		return;
 	}
+
+	std::shared_ptr<Object> object = gWorldManager->getSharedObjectById(id);
+	CreatureObject* creature = dynamic_cast<CreatureObject*>(object.get());
+	if(!creature)	{
+		return;
+	}
 		
 	DLOG (info) << "HamManager::UpdateCurrentHitpoints : " << id << "was added to the regenration timer";
 	
-	//currently hardcoded one regeneration event per second
-	ptime next_time = second_clock::local_time() + seconds(1);
-	reg_.insert(std::make_pair(id,std::make_pair(next_time , id)));
-	
+	regeneration_.Add(id, creature->getObjectType() == SWG_PLAYER);
+
+	// the ham is copied into the engine on the next tick
+	RegenerationObject regeneration_object;
+	regeneration_object.creature	= creature;
+	regeneration_object.object		= object;
+	regeneration_object.synced		= false;
+	regeneration_objects_.push_back(regeneration_object);
 }
 
 int32 HamService::getModifiedHitPoints(CreatureObject* creature, const uint16_t statIndex)
@@ -448,29 +459,26 @@ int32 HamService::getModifiedHitPoints(CreatureObject* creature, const uint16_t
 
 }
 
-uint32_t  HamService::regenerationModifier(CreatureObject* creature, uint16_t mainstatIndex)
+float HamService::postureModifier_(uint8_t posture)
 {
-	
-
-	float modifier = 1;
-	uint32_t result;
-	uint32_t mDivider = 50;
-
 	//todo either script it or get some sort of configuration manager
-	switch(creature->GetPosture())	{
-		case CreaturePosture_Crouched : modifier = 1.25f;	break;
+	switch(posture)	{
+		case CreaturePosture_Crouched : return 1.25f;
 		case CreaturePosture_LyingDown :
-		case CreaturePosture_Sitting : modifier = 1.75f;	break;
+		case CreaturePosture_Sitting : return 1.75f;
 		case CreaturePosture_Incapacitated : 
-		case CreaturePosture_Dead : modifier = 0.0f;	break;
-		case CreaturePosture_KnockedDown : modifier = 0.75f;	break;
-		default : modifier = 1;
+		case CreaturePosture_Dead : return 0.0f;
+		case CreaturePosture_KnockedDown : return 0.75f;
+		default : return 1.0f;
 	}
+}
+
+uint32_t  HamService::regenerationModifier(CreatureObject* creature, uint16_t mainstatIndex)
+{
+	uint32_t mDivider = 50;
 
 	//mainstatindex+2 is constitution for health; willpower for mind and STAMINA for action
-	result = (uint32_t)((creature->GetStatCurrent(mainstatIndex+2) / mDivider) * modifier);
-	
-	LOG(error) << "HamService::regenerationModifier_ " << creature->getId() << " will heal for : " << result;
+	uint32_t result = (uint32_t)((creature->GetStatCurrent(mainstatIndex+2) / mDivider) * postureModifier_(creature->GetPosture()));
 	
 	// Test for creatures	
 	if (creature->getObjectType() == SWG_PLAYER)	{
@@ -480,55 +488,95 @@ uint32_t  HamService::regenerationModifier(CreatureObject* creature, uint16_t ma
 	return((result/10)+1);
 }
 
-bool HamService::regenerate_(uint64 id)
+void HamService::syncRegeneration_(uint32_t slot, CreatureObject* creature)
 {
-	CreatureObject* creature = dynamic_cast<CreatureObject*>(gWorldManager->getObjectById(id));
-	
-	bool done = true;
+	auto lock = creature->AcquireLock();
 
-	if(!creature)	{
-		//bail out
-		return true;
+	regeneration_.SetPostureModifier(slot, postureModifier_(creature->GetPosture(lock)));
+
+	for(uint16_t statIndex = HamBar_Health; statIndex <= HamBar_Willpower; statIndex++)	{
+		int32_t modified_hitpoints = creature->GetStatMax(statIndex, lock) - creature->GetStatEncumberance(statIndex, lock) - creature->GetStatWound(statIndex, lock);
+		regeneration_.SetBar(slot, statIndex, creature->GetStatCurrent(statIndex, lock), modified_hitpoints);
 	}
 
-	//regeneration only for health action mind
-	//LOG (info) << "HamService::regenerate_ : " << creature->getId();
-	
-	for(uint16_t mainstatIndex = HamBar_Health; mainstatIndex <= HamBar_Willpower;mainstatIndex++)	{
-		int32_t maxPool = creature->GetStatMax(mainstatIndex);
-		if(creature->GetStatCurrent(mainstatIndex) < maxPool ){
-			//LOG (error) << "HamService::regenerate_ : " << creature->getId() << " needs to be healed";
-			int32_t newPool = UpdateCurrentHitpoints(creature, mainstatIndex, regenerationModifier(creature, mainstatIndex));
-			if (newPool && creature->GetStatCurrent(mainstatIndex) < maxPool )	{
-				done = false;
-			}
+	regeneration_.SetRevision(slot, creature->GetHamRevision());
+}
+
+bool HamService::applyRegeneration_(uint32_t slot, CreatureObject* creature)
+{
+	auto lock = creature->AcquireLock();
+
+	// damage or a buff since the engine got its copy, skip this tick rather than overwriting it
+	if(creature->GetHamRevision() != regeneration_.GetRevision(slot))	{
+		return false;
+	}
+
+	uint16_t changed = regeneration_.GetChangedBars(slot);
+
+	for(uint16_t statIndex = HamBar_Health; statIndex <= HamBar_Willpower; statIndex++)	{
+		if(changed & (1 << statIndex))	{
+			creature->SetStatCurrent(statIndex, regeneration_.GetCurrent(slot, statIndex), lock);
 		}
 	}
 
-	return done;
-	
+	// our own updates do not invalidate the copy
+	regeneration_.SetRevision(slot, creature->GetHamRevision());
+	return true;
 }
 
-void HamService::handleTick_(const boost::system::error_code& e)
+void HamService::removeFromRegeneration_(uint32_t slot)
 {
-    ptime current_time = second_clock::local_time();
+	// mirror the engine, the last slot moves into the removed one
+	regeneration_.Remove(slot);
+
+	regeneration_objects_[slot] = regeneration_objects_.back();
+	regeneration_objects_.pop_back();
+}
 
+void HamService::handleTick_(const boost::system::error_code& e)
+{
     boost::lock_guard<boost::mutex> lock(mutex_);
-	auto iterator = reg_.begin();
 
-	while(iterator != reg_.end())	{
-		if(current_time > iterator->second.first)	{
-			if(regenerate_(iterator->second.second)){
-				reg_.erase(iterator++);
+	// refresh the copies of creatures that changed since the last tick, backwards so removing
+	// a slot only moves an already visited one
+	for(uint32_t slot = regeneration_.Size(); slot-- > 0; )	{
+		RegenerationObject& regeneration_object = regeneration_objects_[slot];
+
+		if(regeneration_object.object.expired())	{
+			removeFromRegeneration_(slot);
+			continue;
+		}
+
+		if(!regeneration_object.synced || regeneration_object.creature->GetHamRevision() != regeneration_.GetRevision(slot))	{
+			syncRegeneration_(slot, regeneration_object.creature);
+			regeneration_object.synced = true;
+		}
+	}
+
+	regeneration_.Regenerate();
+
+	for(uint32_t slot = regeneration_.Size(); slot-- > 0; )	{
+		RegenerationObject& regeneration_object = regeneration_objects_[slot];
+
+		if(regeneration_.GetChangedBars(slot))	{
+			// the object may have gone away while the engine ran
+			std::shared_ptr<Object> object = regeneration_object.object.lock();
+			if(!object)	{
+				removeFromRegeneration_(slot);
+				continue;
+			}
+
+			if(!applyRegeneration_(slot, regeneration_object.creature))	{
+				continue;
 			}
-			else
-				iterator++;
 		}
-		else
-			iterator++;
+
+		if(!regeneration_.IsRegenerating(slot))	{
+			removeFromRegeneration_(slot);
+		}
 	}
 
 	timer_.expires_from_now(boost::posix_time::seconds(1));
 	timer_.async_wait(boost::bind(&HamService::handleTick_, this, boost::asio::placeholders::error));
 
-}
\ No newline at end of file
+}
@@ -5,12 +5,13 @@
 
 #include "ham_service_interface.h"
 #include "anh/app/swganh_kernel.h"
+#include "anh/ham/regeneration_engine.h"
 #include <boost/thread/mutex.hpp>
 #include <boost/asio/deadline_timer.hpp>
-#include <map>
 //#include <list>
 #include <cstdint>
 #include <memory>
+#include <vector>
 
 namespace Anh_Utils
 {
@@ -18,7 +19,7 @@ class Clock;
 class Scheduler;
 }
 
-typedef std::pair<boost::posix_time::ptime, uint64> RegenerationQueueType;
+class Object;
 
 enum BarIndex
 {
@@ -155,7 +156,8 @@ public:
 	int32			getCurrentDamage(CreatureObject* creature, const uint16_t statIndex);
     
 	/*	@brief this will handle the regeneration tick.
-	*	We iterate through the map with the Ids and apply regeneration to every creature on it
+	*	Creatures whose ham changed since the last tick are copied into the regeneration engine, which
+	*	regenerates all of them in one pass. Only the bars that actually changed are written back
 	*/
 	void			handleTick_(const boost::system::error_code& e);
 
@@ -205,16 +207,33 @@ public:
 	void			SetHam(CreatureObject* creature, const uint16_t statIndex, const int32_t value);
 
 private:
-	/*	@brief regenerate_ will handle the regeneration event for the given creature
-	*	@param uint64 id the id of the creature that wants to regenerate
-	*	@returns true if the creature is to be removed from the map
+	/*	@brief the creature in a slot of the regeneration engine, kept in the same order as the slots
 	*/
-	bool			regenerate_(uint64 id);
+	struct RegenerationObject
+	{
+		CreatureObject*			creature;
+		std::weak_ptr<Object>	object;
+		bool					synced;
+	};
+
+	static float	postureModifier_(uint8_t posture);
+
+	/*	@brief syncRegeneration_ copies the ham of the creature into its slot of the engine
+	*/
+	void			syncRegeneration_(uint32_t slot, CreatureObject* creature);
+
+	/*	@brief writes the regenerated bars back to the creature
+	*	@returns false if the creature changed meanwhile, it is synced again on the next tick
+	*/
+	bool			applyRegeneration_(uint32_t slot, CreatureObject* creature);
+
+	void			removeFromRegeneration_(uint32_t slot);
 	
 	boost::asio::deadline_timer					timer_;
 
 	boost::mutex								mutex_;
-    std::map<uint64_t,RegenerationQueueType>	reg_;
+	swganh::ham::RegenerationEngine				regeneration_;
+	std::vector<RegenerationObject>				regeneration_objects_;
     boost::mutex								ham_mutex_;
     swganh::app::SwganhKernel*					kernel_;
 	
@@ -3,6 +3,7 @@
 
 #include "terrain_service.h"
 
+#include <algorithm>
 #include <map>
 
 #include <ZoneServer\Services\scene_events.h>
@@ -14,6 +15,7 @@
 #include "anh/tre/resource_manager.h"
 //#include "anh/tre/visitors/terrain/layer_visitor.h"
 #include "anh/tre/visitors/terrain/terrain_visitor.h"
+#include "anh/tre/visitors/terrain/height_field_cache.h"
 
 #include "anh/tre/visitors/terrain/detail/container_layer.h"
 #include "anh/tre/visitors/terrain/detail/boundary_layer.h"
@@ -39,7 +41,20 @@ TerrainService::TerrainService(swganh::app::SwganhKernel* kernel) : kernel_(kern
             SceneEntry entry;
             entry.terrain_visitor_ = kernel_->GetResourceManager()->GetResourceByName<TerrainVisitor>(real_event->terrain_filename, false);
 
-            boost::lock_guard<boost::mutex> lock(terrain_mutex_);
+            // sample at the resolution the client builds its terrain mesh with
+            auto header = entry.terrain_visitor_->GetHeader();
+            float sample_spacing = 2.0f;
+            if(header->tiles_per_chunk && header->chunk_width > 0.0f)
+            {
+                sample_spacing = header->chunk_width / header->tiles_per_chunk;
+            }
+
+            std::shared_ptr<TerrainVisitor> visitor = entry.terrain_visitor_;
+            entry.height_cache_ = std::make_shared<HeightFieldCache>(header->map_width, sample_spacing, [this, visitor] (float x, float z) {
+                return calculateHeight(visitor.get(), x, z);
+            });
+
+            boost::unique_lock<boost::shared_mutex> lock(terrain_mutex_);
             scenes_.insert(SceneMap::value_type(real_event->scene_id, std::move(entry)));
         }
         catch(...)
@@ -54,7 +69,7 @@ TerrainService::TerrainService(swganh::app::SwganhKernel* kernel) : kernel_(kern
 		
         auto real_event = std::static_pointer_cast<swganh::simulation::DestroySceneEvent>(newEvent);
 
-        boost::lock_guard<boost::mutex> lock(terrain_mutex_);
+        boost::unique_lock<boost::shared_mutex> lock(terrain_mutex_);
         this->scenes_.erase(real_event->scene_id);
 		
     });
@@ -107,7 +122,7 @@ bool TerrainService::waterHeightHelper(swganh::tre::ContainerLayer* layer, float
 
 float TerrainService::GetWaterHeight(uint32_t scene_id, float x, float z, float raw)
 {
-    boost::lock_guard<boost::mutex> lock(terrain_mutex_);
+    boost::shared_lock<boost::shared_mutex> lock(terrain_mutex_);
     auto itr = scenes_.find(scene_id);
     if(itr != scenes_.end())
     {
@@ -138,36 +153,60 @@ float TerrainService::GetWaterHeight(uint32_t scene_id, float x, float z, float
 
 float TerrainService::GetHeight(uint32_t scene_id, float x, float z, bool raw)
 {
-    boost::lock_guard<boost::mutex> lock(terrain_mutex_);
+    boost::shared_lock<boost::shared_mutex> lock(terrain_mutex_);
     auto itr = scenes_.find(scene_id);
     if(itr != scenes_.end())
     {
-        //Read in height at this point
-        auto& layers = itr->second.terrain_visitor_->GetLayers();
-        auto& fractals = itr->second.terrain_visitor_->GetFractals();
-
-        float affector_transform = 1.0f;
-        float height_result = 0.0f;
-
-		std::vector<ContainerLayer*>::iterator itCL;
-        for(itCL = layers.begin(); itCL != layers.end(); itCL ++)
-        {
-            if((*itCL)->enabled)
-            {
-                processLayerHeight((*itCL), x, z, height_result, affector_transform, fractals);
-            }
-        }
+        float height_result = itr->second.height_cache_->GetHeight(x, z);
 
         if(!raw)
         {
             //Todo:Apply any necessary layer modifications
         }
 
-        return (float) height_result;
+        return height_result;
     }
     return FLT_MIN;
 }
 
+void TerrainService::GetHeights(uint32_t scene_id, const glm::vec2* positions, size_t count, float* heights)
+{
+    boost::shared_lock<boost::shared_mutex> lock(terrain_mutex_);
+    auto itr = scenes_.find(scene_id);
+    if(itr == scenes_.end())
+    {
+        std::fill(heights, heights + count, FLT_MIN);
+        return;
+    }
+
+    HeightFieldCache* height_cache = itr->second.height_cache_.get();
+    for(size_t i = 0; i < count; ++i)
+    {
+        heights[i] = height_cache->GetHeight(positions[i].x, positions[i].y);
+    }
+}
+
+float TerrainService::calculateHeight(TerrainVisitor* terrain_visitor, float x, float z)
+{
+    //Read in height at this point
+    auto& layers = terrain_visitor->GetLayers();
+    auto& fractals = terrain_visitor->GetFractals();
+
+    float affector_transform = 1.0f;
+    float height_result = 0.0f;
+
+    std::vector<ContainerLayer*>::iterator itCL;
+    for(itCL = layers.begin(); itCL != layers.end(); itCL ++)
+    {
+        if((*itCL)->enabled)
+        {
+            processLayerHeight((*itCL), x, z, height_result, affector_transform, fractals);
+        }
+    }
+
+    return height_result;
+}
+
 bool TerrainService::IsWater(uint32_t scene_id, float x, float z, bool raw)
 {
     float water_height = GetWaterHeight(scene_id, x, z, raw);
@@ -182,9 +221,9 @@ bool TerrainService::IsWater(uint32_t scene_id, float x, float z, bool raw)
 
 float TerrainService::processLayerHeight(ContainerLayer* layer, float x, float z, float& base_value, float affector_transform, std::map<uint32_t,Fractal*>& fractals)
 {
-    std::vector<BoundaryLayer*> boundaries = layer->boundaries;
-    std::vector<HeightLayer*> heights = layer->heights;
-    std::vector<FilterLayer*> filters = layer->filters;
+    const std::vector<BoundaryLayer*>& boundaries = layer->boundaries;
+    const std::vector<HeightLayer*>& heights = layer->heights;
+    const std::vector<FilterLayer*>& filters = layer->filters;
 
     float transform_value = 0.0f;
     bool has_boundaries = false;
@@ -250,7 +289,7 @@ float TerrainService::processLayerHeight(ContainerLayer* layer, float x, float z
                 }
             }
 
-            std::vector<ContainerLayer*> children = layer->children;
+            const std::vector<ContainerLayer*>& children = layer->children;
 
             for (unsigned int i = 0; i < children.size(); i++)
             {
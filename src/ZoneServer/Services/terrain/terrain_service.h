@@ -6,7 +6,8 @@
 #include "terrain_service_interface.h"
 #include "anh/app/swganh_kernel.h"
 
-#include <boost/thread/mutex.hpp>
+#include <boost/thread/shared_mutex.hpp>
+#include <glm/glm.hpp>
 #include <map>
 #include <list>
 #include <cstdint>
@@ -21,6 +22,7 @@ class TerrainVisitor;
 class Fractal;
 
 class ContainerLayer;
+class HeightFieldCache;
 }
 }
 
@@ -40,6 +42,7 @@ struct LayerEntry
 struct SceneEntry
 {
     std::shared_ptr<swganh::tre::TerrainVisitor> terrain_visitor_;
+    std::shared_ptr<swganh::tre::HeightFieldCache> height_cache_;
     //std::list<LayerEntry> layers_;
 };
 
@@ -63,6 +66,11 @@ public:
 	*/
     virtual float GetHeight(uint32_t scene_id, float x, float z, bool raw=false);
 
+	/*	@brief gets the heights of count (x, z) positions in one go, see GetHeight
+	*	heights needs to hold count entries, FLT_MIN is written for unknown scenes
+	*/
+    virtual void GetHeights(uint32_t scene_id, const glm::vec2* positions, size_t count, float* heights);
+
 	/*	@brief tests for the water height at a defined (float x, float y ) spot
 	*	and then determines if the spot is low enough to have water
 	*	scene_id is the id of the scene (instance)
@@ -75,10 +83,15 @@ private:
 
     bool waterHeightHelper(swganh::tre::ContainerLayer* layer, float x, float z, float& result);
 
+    /*	@brief evaluates all layers of the terrain at the given spot, this is what the height caches sample
+    */
+    float calculateHeight(swganh::tre::TerrainVisitor* terrain_visitor, float x, float z);
+
     float processLayerHeight(swganh::tre::ContainerLayer* layer, float x, float z, float& base_value, float affector_transform, std::map<uint32_t, swganh::tre::Fractal*>& fractals);
     float calculateFeathering(float value, int featheringType);
 
-    boost::mutex terrain_mutex_;
+    // guards the scene map only, cached heights are read without taking a lock
+    boost::shared_mutex terrain_mutex_;
     SceneMap scenes_;
     swganh::app::SwganhKernel* kernel_;
 };
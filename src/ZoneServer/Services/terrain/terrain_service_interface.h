@@ -4,6 +4,8 @@
 
 #include "anh/service/service_interface.h"
 
+#include <glm/glm.hpp>
+
 namespace swganh
 {
 namespace terrain
@@ -16,6 +18,8 @@ public:
 
     virtual float GetHeight(uint32_t scene_id, float x, float z, bool raw=false) = 0;
 
+    virtual void GetHeights(uint32_t scene_id, const glm::vec2* positions, size_t count, float* heights) = 0;
+
     virtual float GetWaterHeight(uint32_t scene_id, float x, float z, float raw=false) = 0;
 
     virtual bool IsWater(uint32_t scene_id, float x, float z, bool raw=false) = 0;
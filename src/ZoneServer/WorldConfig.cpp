@@ -209,6 +209,66 @@ void	WorldConfig::handleDatabaseJobComplete(void* ref,swganh::database::Database
         mGroupMissionUpdateTime = 30000;
     }
 
+    // how often the write behind queue sends the rows marked dirty since the last flush
+    mWriteBehindInterval = getConfiguration<uint32>("Zone_WriteBehind_Interval",5000);
+    if(mWriteBehindInterval < 1000 || mWriteBehindInterval > 60000)
+    {
+        mWriteBehindInterval = 5000;
+    }
+
+    // every connected player is saved once per interval, the saves spread over it
+    mPlayerSaveInterval = getConfiguration<uint32>("Zone_PlayerSave_Interval",120000);
+    if(mPlayerSaveInterval < 10000 || mPlayerSaveInterval > 3600000)
+    {
+        mPlayerSaveInterval = 120000;
+    }
+
+    // the most players written per second, a larger zone stretches the interval
+    mPlayerSaveBudget = getConfiguration<uint32>("Zone_PlayerSave_Budget",20);
+    if(mPlayerSaveBudget < 1 || mPlayerSaveBudget > 1000)
+    {
+        mPlayerSaveBudget = 20;
+    }
+
+    // every movement update of objects this close, fewer of those further away
+    mInterestNearRange = getConfiguration<float>("Zone_Interest_NearRange",32.0f);
+    if(mInterestNearRange < 8.0f || mInterestNearRange > 256.0f)
+    {
+        mInterestNearRange = 32.0f;
+    }
+
+    mInterestMidRange = getConfiguration<float>("Zone_Interest_MidRange",96.0f);
+    if(mInterestMidRange < mInterestNearRange || mInterestMidRange > 512.0f)
+    {
+        mInterestMidRange = mInterestNearRange * 3.0f;
+    }
+
+    // the bytes of movement updates a client gets per 100ms, grouped and fighting clients get theirs regardless
+    mInterestClientBudget = getConfiguration<uint32>("Zone_Interest_ClientBudget",2048);
+    if(mInterestClientBudget < 256 || mInterestClientBudget > 65536)
+    {
+        mInterestClientBudget = 2048;
+    }
+
+    // position updates close to the one observers got last aren't sent
+    mReckoningMaxError = getConfiguration<float>("Zone_Reckoning_MaxError",0.5f);
+    if(mReckoningMaxError < 0.0f || mReckoningMaxError > 8.0f)
+    {
+        mReckoningMaxError = 0.5f;
+    }
+
+    mReckoningMaxHeading = getConfiguration<float>("Zone_Reckoning_MaxHeading",15.0f);
+    if(mReckoningMaxHeading < 0.0f || mReckoningMaxHeading > 180.0f)
+    {
+        mReckoningMaxHeading = 15.0f;
+    }
+
+    mReckoningMaxInterval = getConfiguration<uint32>("Zone_Reckoning_MaxInterval",2000);
+    if(mReckoningMaxInterval < 250 || mReckoningMaxInterval > 30000)
+    {
+        mReckoningMaxInterval = 2000;
+    }
+
 	//now load the zones specifics
     if(!mLoadComplete)
     {
@@ -110,6 +110,42 @@ public:
         return mGroupMissionUpdateTime;
     }
 
+    uint32				getWriteBehindInterval() {
+        return mWriteBehindInterval;
+    }
+
+    uint32				getPlayerSaveInterval() {
+        return mPlayerSaveInterval;
+    }
+
+    uint32				getPlayerSaveBudget() {
+        return mPlayerSaveBudget;
+    }
+
+    float				getInterestNearRange() {
+        return mInterestNearRange;
+    }
+
+    float				getInterestMidRange() {
+        return mInterestMidRange;
+    }
+
+    uint32				getInterestClientBudget() {
+        return mInterestClientBudget;
+    }
+
+    float				getReckoningMaxError() {
+        return mReckoningMaxError;
+    }
+
+    float				getReckoningMaxHeading() {
+        return mReckoningMaxHeading;
+    }
+
+    uint32				getReckoningMaxInterval() {
+        return mReckoningMaxInterval;
+    }
+
     uint16				getPlayerContainerDepth() {
         return mContainerDepth;
     }
@@ -219,6 +255,25 @@ private:
 
     // GroupMissionUpdateTime determines how often we update the waypoints for our group
     uint32				mGroupMissionUpdateTime;
+
+    // WriteBehindInterval determines how often rows marked dirty are written, in ms
+    uint32				mWriteBehindInterval;
+
+    // PlayerSaveInterval is how often each player is saved in ms, PlayerSaveBudget the most saves per second
+    uint32				mPlayerSaveInterval;
+    uint32				mPlayerSaveBudget;
+
+    // movement updates are sent in full up to InterestNearRange, thinned out up to InterestMidRange and more so beyond,
+    // a client gets at most InterestClientBudget bytes of them per 100ms
+    float				mInterestNearRange;
+    float				mInterestMidRange;
+    uint32				mInterestClientBudget;
+
+    // a position update is only sent if it is more than ReckoningMaxError m off the position observers got last,
+    // its heading turned more than ReckoningMaxHeading degrees or ReckoningMaxInterval ms passed since the last one
+    float				mReckoningMaxError;
+    float				mReckoningMaxHeading;
+    uint32				mReckoningMaxInterval;
 };
 
 //=============================================================================
@@ -33,7 +33,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 
 #include "anh/logger.h"
 
-#include "anh/Utils/Scheduler.h"
+#include "anh/Utils/TimingWheelScheduler.h"
 #include "Utils/VariableTimeScheduler.h"
 #include "Utils/utils.h"
 
@@ -42,6 +42,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "DatabaseManager/Database.h"
 #include "DatabaseManager/DataBinding.h"
 #include "DatabaseManager/DatabaseResult.h"
+#include "DatabaseManager/WriteBehindQueue.h"
 
 #include "MessageLib/MessageLib.h"
 
@@ -59,6 +60,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "ZoneServer/GameSystemManagers/Spawn Manager/CreatureSpawnRegion.h"
 //#include "ZoneServer/Objects/FactoryStructures/FactoryFactory.h"
 #include "ZoneServer/GameSystemManagers/Structure Manager/FactoryObject.h"
+#include "ZoneServer/GameSystemManagers/Structure Manager/CellFactory.h"
 #include "ZoneServer/GameSystemManagers/FireworkManager.h"
 #include "ZoneServer/GameSystemManagers/Forage Manager/ForageManager.h"
 #include "ZoneServer/GameSystemManagers/Group Manager/GroupManager.h"
@@ -101,11 +103,16 @@ WorldManager*	WorldManager::mSingleton  = NULL;
 
 WorldManager::WorldManager(uint32 zoneId, ZoneServer* zoneServer,swganh::app::SwganhKernel*	kernel, std::string trn, bool writeResourceMaps)
     : mWM_DB_AsyncPool(sizeof(WMAsyncContainer))
+    , mNpcActiveHandlers(250)
+    , mNpcDormantHandlers(2500)
+    , mNpcReadyHandlers(1000)
     , kernel_(kernel)
     , mZoneServer(zoneServer)
     , mState(WMState_StartUp)
     , mServerTime(0)
     , mTotalObjectCount(0)
+    , mStartupTime(0)
+    , mStartupPhaseTime(0)
     , mZoneId(zoneId)
 	, mTrn(trn)
 {
@@ -113,6 +120,20 @@ WorldManager::WorldManager(uint32 zoneId, ZoneServer* zoneServer,swganh::app::Sw
 
 	SpatialIndexManager::Init(getKernel()->GetDatabase());
 
+    // statement run on every save, each database connection prepares it once
+    swganh::database::Database* database = getKernel()->GetDatabase();
+    std::string galaxy = database->galaxy();
+
+    database->registerStatement("WorldManager::storeCharacterPosition", "UPDATE " + galaxy + ".characters SET parent_id=?, "
+        "oX=?, oY=?, oZ=?, oW=?, x=?, y=?, z=?, planet_id=? WHERE id=?");
+
+    // single row updates of the busiest tables are coalesced and written in batches
+    mWriteBehind.reset(new swganh::database::WriteBehindQueue(database));
+    mWriteBehind->registerTable("item_attributes", "item_id", "attribute_id");
+    mWriteBehind->registerTable("resource_containers", "id");
+    mWriteBehindReportTime = 0;
+    mPlayerSaveCursor = 0;
+
 
     // load planet names and terrain files so we can start heightmap loading
     _loadPlanetNamesAndFiles();
@@ -125,17 +146,17 @@ WorldManager::WorldManager(uint32 zoneId, ZoneServer* zoneServer,swganh::app::Sw
 		zoneId, "", trn));
 	
     // create schedulers
-    mSubsystemScheduler		= new Anh_Utils::Scheduler();
-    mObjControllerScheduler = new Anh_Utils::Scheduler();
-    mHamRegenScheduler		= new Anh_Utils::Scheduler();
-    mStomachFillingScheduler= new Anh_Utils::Scheduler();
-    mPlayerScheduler		= new Anh_Utils::Scheduler();
-    mEntertainerScheduler	= new Anh_Utils::Scheduler();
-    //mImagedesignerScheduler	= new Anh_Utils::Scheduler();
+    mSubsystemScheduler		= new Anh_Utils::TimingWheelScheduler();
+    mObjControllerScheduler = new Anh_Utils::TimingWheelScheduler();
+    mHamRegenScheduler		= new Anh_Utils::TimingWheelScheduler();
+    mStomachFillingScheduler= new Anh_Utils::TimingWheelScheduler();
+    mPlayerScheduler		= new Anh_Utils::TimingWheelScheduler();
+    mEntertainerScheduler	= new Anh_Utils::TimingWheelScheduler();
+    //mImagedesignerScheduler	= new Anh_Utils::TimingWheelScheduler();
     mBuffScheduler			= new Anh_Utils::VariableTimeScheduler(100, 100);
-    mMissionScheduler		= new Anh_Utils::Scheduler();
-    mNpcManagerScheduler	= new Anh_Utils::Scheduler();
-    mAdminScheduler			= new Anh_Utils::Scheduler();
+    mMissionScheduler		= new Anh_Utils::TimingWheelScheduler();
+    mNpcManagerScheduler	= new Anh_Utils::TimingWheelScheduler();
+    mAdminScheduler			= new Anh_Utils::TimingWheelScheduler();
 
     LoadCurrentGlobalTick();
 
@@ -164,6 +185,8 @@ WorldManager::WorldManager(uint32 zoneId, ZoneServer* zoneServer,swganh::app::Sw
     _registerScriptHooks();
 
     // initiate loading of objects
+    mStartupTime = mStartupPhaseTime = Anh_Utils::Clock::getSingleton()->getLocalTime();
+
     int8 sql[128];
     
 	sprintf(sql, "SELECT %s.sf_getZoneObjectCount(%i);", getKernel()->GetDatabase()->galaxy(), mZoneId);
@@ -178,6 +201,7 @@ WorldManager::WorldManager(uint32 zoneId, ZoneServer* zoneServer,swganh::app::Sw
         // we got the total objectCount we need to load
         mTotalObjectCount = result_set->getUInt(1);
         LOG(info) << "Loading " << mTotalObjectCount << " World Manager Objects... ";
+        _logStartupPhase("object count");
 
         _loadWorldObjects();
     } ) ;
@@ -219,6 +243,9 @@ void WorldManager::Shutdown()
         playerIt = mPlayerAccMap.begin();
     }
 
+    // whatever the players left dirty is written before the zone goes down
+    mWriteBehind->flushSync();
+
     // timers
     delete(mAdminScheduler);
     delete(mNpcManagerScheduler);
@@ -300,10 +327,7 @@ void WorldManager::handleObjectReady(Object* object,DispatchClient* client)
     // check if we are done loading
 	//LOG(info) << "WorldManager::handleObjectReady " << object_map_.size() << " : " << mTotalObjectCount;
 	//LOG(info) << object->GetTemplate();
-    if ((mState == WMState_StartUp) && (object_map_.size() + mCreatureSpawnRegionMap.size() >= mTotalObjectCount))
-    {
-        _handleLoadComplete();
-    }
+    checkLoadComplete();
 }
 void WorldManager::handleObjectReady(shared_ptr<Object> object)
 {
@@ -311,6 +335,13 @@ void WorldManager::handleObjectReady(shared_ptr<Object> object)
 	//LOG(info) << "WorldManager::handleObjectReady " << object_map_.size() << " : " << mTotalObjectCount;
 	//LOG(info) << object->GetTemplate();
 	// check if we are done loading
+    checkLoadComplete();
+}
+
+//======================================================================================================================
+
+void WorldManager::checkLoadComplete()
+{
     if ((mState == WMState_StartUp) && (object_map_.size() + mCreatureSpawnRegionMap.size() >= mTotalObjectCount))
     {
         _handleLoadComplete();
@@ -370,6 +401,8 @@ bool	WorldManager::_handleTick(uint64 callTime,void* ref)
 
 void WorldManager::Process()
 {
+    gSpatialIndexManager->beginFrame();
+
     _processSchedulers();
 }
 
@@ -556,6 +589,37 @@ bool WorldManager::_handleServerTimeUpdate(uint64 callTime,void* ref)
     return(true);
 }
 
+//======================================================================================================================
+//
+// write the rows marked dirty since the last flush
+//
+
+bool WorldManager::_handleWriteBehindFlush(uint64 callTime,void* ref)
+{
+    mWriteBehind->flush();
+
+    if(callTime - mWriteBehindReportTime >= 600000)
+    {
+        mWriteBehindReportTime = callTime;
+        mWriteBehind->logStats();
+    }
+
+    return true;
+}
+
+//======================================================================================================================
+//
+// send the current position of objects to the observers that missed their last movement update,
+// and of objects that stopped after a suppressed one
+//
+
+bool WorldManager::_handleMovementCatchUps(uint64 callTime,void* ref)
+{
+    gMessageLib->sendMovementCatchUps();
+
+    return true;
+}
+
 //======================================================================================================================
 //
 // update busy crafting tools, called every 2 seconds
@@ -604,10 +668,10 @@ bool WorldManager::_handleCraftToolTimers(uint64 callTime,void* ref)
 
                 it = mBusyCraftTools.erase(it);
                 tool->setAttribute("craft_tool_status","@crafting:tool_status_ready");
-                getKernel()->GetDatabase()->executeSqlAsync(0,0,"UPDATE %s.item_attributes SET value='@crafting:tool_status_ready' WHERE item_id=%"PRIu64" AND attribute_id=18",getKernel()->GetDatabase()->galaxy(),tool->getId());
+                mWriteBehind->markString("item_attributes", swganh::database::RowKey(tool->getId(), AttrType_CraftToolStatus), "value", "@crafting:tool_status_ready");
 
                 tool->setAttribute("craft_tool_time",boost::lexical_cast<std::string>(tool->getTimer()));
-                getKernel()->GetDatabase()->executeSqlAsync(0,0,"UPDATE %s.item_attributes SET value='%i' WHERE item_id=%"PRIu64" AND attribute_id=%u",getKernel()->GetDatabase()->galaxy(),tool->getId(),tool->getTimer(),AttrType_CraftToolTime);
+                mWriteBehind->markString("item_attributes", swganh::database::RowKey(tool->getId(), AttrType_CraftToolTime), "value", boost::lexical_cast<std::string>(tool->getTimer()));
 
 
                 continue;
@@ -617,7 +681,8 @@ bool WorldManager::_handleCraftToolTimers(uint64 callTime,void* ref)
 
             tool->setAttribute("craft_tool_time",boost::lexical_cast<std::string>(tool->getTimer()));
             //gLogger->log(LogManager::DEBUG,"timer : %i",tool->getTimer());
-            getKernel()->GetDatabase()->executeSqlAsync(0,0,"UPDATE %s.item_attributes SET value='%i' WHERE item_id=%"PRIu64" AND attribute_id=%u",getKernel()->GetDatabase()->galaxy(),tool->getId(),tool->getTimer(),AttrType_CraftToolTime);
+            // written with the next flush, a tool ticking every second ends up written once per flush
+            mWriteBehind->markString("item_attributes", swganh::database::RowKey(tool->getId(), AttrType_CraftToolTime), "value", boost::lexical_cast<std::string>(tool->getTimer()));
 
         }
 
@@ -824,6 +889,10 @@ void WorldManager::_handleLoadComplete()
 	// register script hooks
 	_startWorldScripts();
 
+	// cells loaded later on query their content themselves
+	gCellFactory->endStartupLoad();
+
+	_logStartupPhase("objects loaded");
 	LOG(info) << "World load complete";
 
 	// switch into running state
@@ -840,11 +909,16 @@ void WorldManager::_handleLoadComplete()
 	mSubsystemScheduler->addTask(fastdelegate::MakeDelegate(this,&WorldManager::_handleCraftToolTimers),3,1000,NULL);
 	mSubsystemScheduler->addTask(fastdelegate::MakeDelegate(this,&WorldManager::_handleNpcConversionTimers),8,1000,NULL);
 
-	setSaveTaskId(mSubsystemScheduler->addTask(fastdelegate::MakeDelegate(this,&WorldManager::_handlePlayerSaveTimers), 4, 120000, NULL));
+	setSaveTaskId(mSubsystemScheduler->addTask(fastdelegate::MakeDelegate(this,&WorldManager::_handlePlayerSaveTimers), 4, 1000, NULL));
 	
 	mSubsystemScheduler->addTask(fastdelegate::MakeDelegate(this,&WorldManager::_handleGeneralObjectTimers),5,2000,NULL);
 	mSubsystemScheduler->addTask(fastdelegate::MakeDelegate(this,&WorldManager::_handleGroupObjectTimers),5,gWorldConfig->getGroupMissionUpdateTime(),NULL);
 	mSubsystemScheduler->addTask(fastdelegate::MakeDelegate(this,&WorldManager::_handleVariousUpdates),7,1000, NULL);
+	mSubsystemScheduler->addTask(fastdelegate::MakeDelegate(this,&WorldManager::_handleWriteBehindFlush),2,gWorldConfig->getWriteBehindInterval(),NULL);
+
+	gMessageLib->getMovementInterest()->configure(gWorldConfig->getInterestNearRange(), gWorldConfig->getInterestMidRange(), gWorldConfig->getInterestClientBudget());
+	gMessageLib->getDeadReckoning()->configure(gWorldConfig->getReckoningMaxError(), gWorldConfig->getReckoningMaxHeading(), gWorldConfig->getReckoningMaxInterval());
+	mSubsystemScheduler->addTask(fastdelegate::MakeDelegate(this,&WorldManager::_handleMovementCatchUps),6,250,NULL);
 
 	// Init NPC Manager, will load lairs from the DB.
 	(void)NpcManager::Instance();
@@ -1330,6 +1404,7 @@ void WorldManager::removePlayerfromAccountMap(uint64 playerID)
         if(playerAccIt != mPlayerAccMap.end())        {
             LOG(info) << "Player left [" << player->getId() << "] Total players on zone [" << (getPlayerAccMap()->size() -1) << "]";
             mPlayerAccMap.erase(playerAccIt);
+            mCharacterSaveImages.erase(player->getAccountId());
         }
         else
         {
@@ -47,6 +47,8 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 
 //#include "ScriptEngine/ScriptEventListener.h"
 
+#include "ZoneServer/GameSystemManagers/NPC Manager/NpcHandlerQueue.h"
+#include "ZoneServer/Objects/FactoryBase.h"
 #include "ZoneServer/Objects/Object/ObjectFactoryCallback.h"
 #include "ZoneServer/Objects/Tangible Object/TangibleEnums.h"
 #include "ZoneServer/WorldManagerEnums.h"
@@ -67,6 +69,11 @@ namespace	app	{
 class	SwganhKernel;
 }}
 
+namespace	swganh	{
+namespace	database	{
+class	WriteBehindQueue;
+}}
+
 class DispatchClient;
 class WMAsyncContainer;
 class Script;
@@ -87,7 +94,7 @@ class Weather;
 namespace Anh_Utils
 {
 class Clock;
-class Scheduler;
+class TimingWheelScheduler;
 class VariableTimeScheduler;
 }
 
@@ -116,16 +123,42 @@ typedef std::map<uint64, uint64>				PlayerObjectReviveMap;
 // a list of busy craft tools needing regular updates
 typedef std::vector<uint64>						CraftTools;
 
+// what the last periodic save of a character wrote, the next one only writes what differs
+struct CharacterSaveImage
+{
+    CharacterSaveImage() : mSaved(false), mParentId(0) {}
+
+    bool		mSaved;
+    uint64		mParentId;
+    glm::vec3	mPosition;
+    glm::quat	mDirection;
+    std::string	mAttributes;
+};
+
+typedef std::unordered_map<uint32, CharacterSaveImage>	CharacterSaveImages;
+
+// periodic saves of a save cycle, or of all cycles
+struct PlayerSaveStats
+{
+    PlayerSaveStats() : mPerformed(0), mSkipped(0), mPositionWrites(0), mAttributeWrites(0), mPeakQueuedJobs(0) {}
+
+    uint64		mPerformed;
+    uint64		mSkipped;
+    uint64		mPositionWrites;
+    uint64		mAttributeWrites;
+    uint32		mPeakQueuedJobs;
+};
+
 // Creature spawn regions.
 typedef std::map<uint64, const std::shared_ptr<CreatureSpawnRegion>>	CreatureSpawnRegionMap;
 
 // Containers with handlers to Npc-objects handled by the NpcManager (or what we are going to call it its final version).
 // The active container will be the most often checked, and the Dormant the less checked container.
 
-// And yes. Handlers... handlers... no object refs that will be invalid all the time.
-typedef std::map<uint64, uint64>				NpcDormantHandlers;
-typedef std::map<uint64, uint64>				NpcReadyHandlers;
-typedef std::map<uint64, uint64>				NpcActiveHandlers;
+// The queues are ordered by due time, a tick only visits the npc's that are actually due.
+typedef NpcHandlerQueue							NpcDormantHandlers;
+typedef NpcHandlerQueue							NpcReadyHandlers;
+typedef NpcHandlerQueue							NpcActiveHandlers;
 typedef std::map<uint64, uint64>				AdminRequestHandlers;
 
 // AttributeKey map
@@ -214,6 +247,9 @@ public:
 
     virtual void            handleObjectReady(std::shared_ptr<Object>);
 
+    // on startup, finishes the load once all objects are in, also for objects that were not handed to us
+    void					checkLoadComplete();
+
     // TimerCallback
     virtual void			handleTimer(uint32 id, void* container);
 
@@ -297,6 +333,11 @@ public:
     // checks if the player save timer is up
     bool					checkSavePlayer(PlayerObject* playerObject);
 
+    // counters of the periodic saves since startup
+    const PlayerSaveStats&	getPlayerSaveStats() {
+        return mPlayerSaveTotals;
+    }
+
     // find a player, returns NULL if not found
     PlayerObject*			getPlayerByAccId(uint32 accId);
 
@@ -350,6 +391,17 @@ public:
     void					addActiveNpc(uint64 creature, uint64 when);
     void					removeActiveNpc(uint64 creature);
 
+    // per tick due/processed/overdue counters of the npc handler queues
+    const NpcHandlerQueueStats&	getDormantNpcStats() const {
+        return mNpcDormantHandlers.getStats();
+    }
+    const NpcHandlerQueueStats&	getReadyNpcStats() const {
+        return mNpcReadyHandlers.getStats();
+    }
+    const NpcHandlerQueueStats&	getActiveNpcStats() const {
+        return mNpcActiveHandlers.getStats();
+    }
+
     void					addAdminRequest(uint64 requestId, uint64 when);
     void					cancelAdminRequest(int32 requestId);
 
@@ -429,7 +481,7 @@ public:
         return mvPlanetNames.size();
     }
   
-    Anh_Utils::Scheduler*	getPlayerScheduler() {
+    Anh_Utils::TimingWheelScheduler*	getPlayerScheduler() {
         return mPlayerScheduler;
     }
 
@@ -445,7 +497,12 @@ public:
 	*
 	*
 	*/
-	Anh_Utils::Scheduler*	getSubsystemScheduler(){ return mSubsystemScheduler;}
+	Anh_Utils::TimingWheelScheduler*	getSubsystemScheduler(){ return mSubsystemScheduler;}
+
+	/*	@brief returns the queue single row updates are held back in and written in batches
+	*	rows marked dirty are written every Zone_WriteBehind_Interval ms and before a player leaves the zone
+	*/
+	swganh::database::WriteBehindQueue*	getWriteBehindQueue(){ return mWriteBehind.get();}
 
 
     // non-persistent ids in use
@@ -492,10 +549,15 @@ private:
     bool	_handleNpcConversionTimers(uint64 callTime,void* ref);
     bool	_handleFireworkLaunchTimers(uint64 callTime,void* ref);
     bool	_handleVariousUpdates(uint64 callTime, void* ref);
+    bool	_handleWriteBehindFlush(uint64 callTime, void* ref);
+    bool	_handleMovementCatchUps(uint64 callTime, void* ref);
 
-//		Save players, who haven't saved in x minutes
+//		Save a share of the players every second, each once per save interval
     bool	_handlePlayerSaveTimers(uint64 callTime, void* ref);
 
+    // writes what changed since the last periodic save, false if nothing did
+    bool	_saveChangedPlayerData(PlayerObject* player_object);
+
     bool	_handlePlayerMovementUpdateTimers(uint64 callTime, void* ref);
 
     bool	_handleGeneralObjectTimers(uint64 callTime, void* ref);
@@ -515,15 +577,33 @@ private:
     // New Method of Loading objects from DB.
     void    _loadWorldObjects();
 
-    // load buildings and their contents
+    // load the content of all cells of the planet, one bulk request per object class
+    void	_loadCellContents();
+
+    // load buildings and their cells
     void	_loadBuildings();
 
-    // loads all child objects of the given parent
+    // load the player houses with their cells, the harvesters and the factories, one bulk request per kind
+    void	_loadStructures();
+
+    // loads all child objects of the given parent, one bulk request per object class
     void	_loadAllObjects(uint64 parentId);
 
+    // loads the cities, badge and spawn regions of the planet, one bulk request per group
+    void	_loadRegions();
+
+    // runs a bulk request for a class of objects, it is retried when one of its queries fails
+    void	_loadObjectClass(const std::string& name,BulkLoadRequest request,uint32 attempt = 0);
+
+    // loads the items that pass the filter with everything inside of them
+    void	_requestItems(ObjectFactoryCallback* ofCallback,const std::string& filter,BulkLoadCallback done);
+
     // planet names and neceessary terrain file names
     void    _loadPlanetNamesAndFiles();
 
+    // logs the time a startup phase took
+    void	_logStartupPhase(const char* phase);
+
     // load our script hooks
     void	_registerScriptHooks();
 
@@ -593,18 +673,18 @@ private:
     CreatureQueue				mObjControllersToProcess;
     Weather						mCurrentWeather;
     //ScriptEventListener			mWorldScriptsListener;
-    Anh_Utils::Scheduler*		mAdminScheduler;
+    Anh_Utils::TimingWheelScheduler*		mAdminScheduler;
     Anh_Utils::VariableTimeScheduler* mBuffScheduler;
 
-    Anh_Utils::Scheduler*		mEntertainerScheduler;
-    Anh_Utils::Scheduler*		mScoutScheduler;
-    Anh_Utils::Scheduler*		mHamRegenScheduler;
-    Anh_Utils::Scheduler*		mStomachFillingScheduler;
-    Anh_Utils::Scheduler*		mMissionScheduler;
-    Anh_Utils::Scheduler*		mNpcManagerScheduler;
-    Anh_Utils::Scheduler*		mObjControllerScheduler;
-    Anh_Utils::Scheduler*		mPlayerScheduler;
-    Anh_Utils::Scheduler*		mSubsystemScheduler;
+    Anh_Utils::TimingWheelScheduler*		mEntertainerScheduler;
+    Anh_Utils::TimingWheelScheduler*		mScoutScheduler;
+    Anh_Utils::TimingWheelScheduler*		mHamRegenScheduler;
+    Anh_Utils::TimingWheelScheduler*		mStomachFillingScheduler;
+    Anh_Utils::TimingWheelScheduler*		mMissionScheduler;
+    Anh_Utils::TimingWheelScheduler*		mNpcManagerScheduler;
+    Anh_Utils::TimingWheelScheduler*		mObjControllerScheduler;
+    Anh_Utils::TimingWheelScheduler*		mPlayerScheduler;
+    Anh_Utils::TimingWheelScheduler*		mSubsystemScheduler;
     ZoneServer*					mZoneServer;
     WMState						mState;
     uint64						mNonPersistantId;
@@ -612,9 +692,18 @@ private:
     uint64						mServerTime;
     uint64						mTick;
     uint32						mTotalObjectCount;
+    uint64						mStartupTime;
+    uint64						mStartupPhaseTime;
 
 
     uint64						mSaveTaskId;
+    CharacterSaveImages			mCharacterSaveImages;
+    uint32						mPlayerSaveCursor;
+    PlayerSaveStats				mPlayerSaveCycle;
+    PlayerSaveStats				mPlayerSaveTotals;
+
+    std::unique_ptr<swganh::database::WriteBehindQueue>	mWriteBehind;
+    uint64						mWriteBehindReportTime;
 
 	/*	@brief the kernel stores the baseservices that are made accessible to the entire simulation
 	*	this includes the db, the messageservice, the terrain service and all other services that will be added in the future
@@ -38,14 +38,24 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 //#include "ScriptEngine/ScriptSupport.h"
 
 #include "ZoneServer/GameSystemManagers/CharacterLoginHandler.h"
+#include "ZoneServer/GameSystemManagers/NPC Manager/PersistentNpcFactory.h"
+#include "ZoneServer/GameSystemManagers/Resource Manager/ResourceContainerFactory.h"
 #include "ZoneServer/GameSystemManagers/Spawn Manager/CreatureSpawnRegion.h"
+#include "ZoneServer/GameSystemManagers/Structure Manager/BuildingFactory.h"
+#include "ZoneServer/GameSystemManagers/Structure Manager/CellFactory.h"
 #include "ZoneServer/GameSystemManagers/Structure Manager/FactoryFactory.h"
 #include "ZoneServer/GameSystemManagers/Group Manager/GroupObject.h"
 #include "ZoneServer/GameSystemManagers/Group Manager/GroupManager.h"
 #include "ZoneServer/GameSystemManagers/Structure Manager/HarvesterFactory.h"
 #include "ZoneServer/GameSystemManagers/Structure Manager/HouseFactory.h"
+#include "ZoneServer/GameSystemManagers/Travel Manager/TicketCollectorFactory.h"
 #include "ZoneServer/Objects/Object/ObjectFactory.h"
+#include "ZoneServer/Objects/ItemFactory.h"
 #include "ZoneServer/Objects/Player Object/PlayerObject.h"
+#include "ZoneServer/Objects/ShuttleFactory.h"
+#include "ZoneServer/Objects/TerminalFactory.h"
+
+#include "anh/Utils/clock.h"
 
 #include <anh\app\swganh_kernel.h>
 
@@ -53,15 +63,29 @@ using std::stringstream;
 
 //======================================================================================================================
 
+namespace {
+
+// a bulk request whose queries fail is given this many more tries
+const uint32 kStartupLoadRetries = 2;
+
+}
+
+//======================================================================================================================
+
 void WorldManager::_loadWorldObjects()
 {
     if(mTotalObjectCount > 0)
     {
-        // this loads all buildings with cells and objects they contain
+        // cells and what is inside of them are loaded independently and linked as they come in
+        gCellFactory->beginStartupLoad();
+
         _loadBuildings();	 //NOT PlayerStructures!!!!!!!!!!!!!!!!!!!!!!!!!! they are handled seperately further down
+        _loadCellContents();
 
         if(mZoneId!=41)
         {
+            _loadStructures();
+
             // load objects in world
             _loadAllObjects(0);
 
@@ -203,68 +227,11 @@ void WorldManager::_loadWorldObjects()
 
         if(mZoneId != 41)
         {
-            // load cities
-            stringstream query_stream;
-            query_stream << "SELECT id FROM "<<getKernel()->GetDatabase()->galaxy()<<".cities WHERE planet_id=" << mZoneId
-                         << " ORDER BY id;";
-            getKernel()->GetDatabase()->executeAsyncSql(query_stream, [=] (swganh::database::DatabaseResult* result) {
-                if (! result) {
-                    return;
-                }
-
-                std::unique_ptr<sql::ResultSet>& result_set = result->getResultSet();
-
-                while(result_set->next())
-                {
-                    gObjectFactory->requestObject(ObjType_Region, Region_City, 0, this, result_set->getUInt64(1));
-                }
-				if (result_set->rowsCount())	{
-					LOG(info)  << "Loaded " << result_set->rowsCount() << " City Regions";
-				}
-				else
-					LOG(info) <<"Unable to load cities with region id: " << mZoneId;
-            });
-
-            // load badge regions
-            query_stream.str(std::string());
-            query_stream << "SELECT id FROM "<<getKernel()->GetDatabase()->galaxy()<<".badge_regions WHERE planet_id=" << mZoneId
-                         << " ORDER BY id;";
-            getKernel()->GetDatabase()->executeAsyncSql(query_stream, [=] (swganh::database::DatabaseResult* result) {
-                if (! result) {
-                    return;
-                }
-
-                std::unique_ptr<sql::ResultSet>& result_set = result->getResultSet();
-
-                while(result_set->next())
-                {
-                    gObjectFactory->requestObject(ObjType_Region, Region_Badge, 0, this, result_set->getUInt64(1));
-                }
-                LOG(info) << "Loaded " << result_set->rowsCount() << " Badge Regions";
-                
-            });
-
-            //load spawn regions
-            query_stream.str(std::string());
-            query_stream << "SELECT id FROM "<<getKernel()->GetDatabase()->galaxy()<<".spawn_regions WHERE planet_id=" << mZoneId
-                         << " ORDER BY id;";
-            getKernel()->GetDatabase()->executeAsyncSql(query_stream, [=] (swganh::database::DatabaseResult* result) {
-                if (! result) {
-                    return;
-                }
-
-                std::unique_ptr<sql::ResultSet>& result_set = result->getResultSet();
-
-                while(result_set->next())
-                {
-                    gObjectFactory->requestObject(ObjType_Region, Region_Spawn, 0, this, result_set->getUInt64(1));
-                }
-                LOG(info) << "Loaded " << result_set->rowsCount() << " Spawn Regions";
-               
-            });
+            // load cities, badge and spawn regions
+            _loadRegions();
 
             // load world scripts
-            query_stream.str(std::string());
+            stringstream query_stream;
             query_stream << "SELECT priority,file FROM "<<getKernel()->GetDatabase()->galaxy()<<".config_zone_scripts WHERE planet_id=" << mZoneId
                          << " ORDER BY id;";
             getKernel()->GetDatabase()->executeAsyncSql(query_stream, [=] (swganh::database::DatabaseResult* result) {
@@ -309,130 +276,214 @@ void WorldManager::_loadWorldObjects()
                 LOG(info) << "Loaded " << result_set->rowsCount() << " Creature Spawn Regions";
                 
             });
+        }
+    }
+    // no objects to load, so we are done
+    else
+    {
+        _handleLoadComplete();
+    }
+}
 
-            // load harvesters
-            query_stream.str(std::string());
-            query_stream << "SELECT s.id FROM "<<getKernel()->GetDatabase()->galaxy()<<".structures s INNER JOIN "<<getKernel()->GetDatabase()->galaxy()<<".harvesters h ON (s.id = h.id) WHERE zone=" << mZoneId
-                         << " ORDER BY id;";
-            getKernel()->GetDatabase()->executeAsyncSql(query_stream, [=] (swganh::database::DatabaseResult* result) {
-                if (! result) {
-                    return;
-                }
-                std::unique_ptr<sql::ResultSet>& result_set = result->getResultSet();
+//======================================================================================================================
+// loads what sits inside of the cells of the planet, buildings and houses alike. Every class is read in bulk and
+// handed to the cell factory, which links it to its cell whenever both are there
 
-                while(result_set->next())
-                {
-                    gHarvesterFactory->requestObject(this,result_set->getUInt64(1),0,0,0);
-                }
-                LOG(info) << "Loaded " << result_set->rowsCount() << " Player Harvesters";
-                
-            });
+void WorldManager::_loadCellContents()
+{
+    swganh::database::Database* database = getKernel()->GetDatabase();
 
-            // load factories
-            query_stream.str(std::string());
-            query_stream << "SELECT s.id FROM "<<getKernel()->GetDatabase()->galaxy()<<".structures s INNER JOIN "<<getKernel()->GetDatabase()->galaxy()<<".factories f ON (s.id = f.id) WHERE zone=" << mZoneId
-                         << " ORDER BY id;";
-            getKernel()->GetDatabase()->executeAsyncSql(query_stream, [=] (swganh::database::DatabaseResult* result) {
-                if (! result) {
-                    return;
-                }
+    stringstream cells;
+    cells << "(SELECT cells.id FROM " << database->galaxy() << ".cells INNER JOIN " << database->galaxy() << ".buildings"
+          << " ON (cells.parent_id = buildings.id) WHERE buildings.planet_id = " << mZoneId
+          << " UNION SELECT structure_cells.id FROM " << database->galaxy() << ".structure_cells INNER JOIN " << database->galaxy() << ".structures"
+          << " ON (structure_cells.parent_id = structures.id) WHERE structures.zone = " << mZoneId << ") planet_cells";
 
-                std::unique_ptr<sql::ResultSet>& result_set = result->getResultSet();
+    std::string planet_cells = cells.str();
 
-                while(result_set->next())
-                {
-                    gFactoryFactory->requestObject(this,result_set->getUInt64(1),0,0,0);
-                }
-                LOG(info) << "Loaded " << result_set->rowsCount() << " Player Factories";
-                
-            });
+    _loadObjectClass("Terminals in Cells", [=] (BulkLoadCallback done) {
+        gTerminalFactory->requestObjects(gCellFactory," INNER JOIN " + planet_cells + " ON (terminals.parent_id = planet_cells.id)",0,done);
+    });
 
-            // load playerhouses
-            query_stream.str(std::string());
-            query_stream << "SELECT s.id FROM "<<getKernel()->GetDatabase()->galaxy()<<".structures s INNER JOIN "<<getKernel()->GetDatabase()->galaxy()<<".houses h ON (s.id = h.id) WHERE zone=" << mZoneId
-                         << " ORDER BY id;";
-            getKernel()->GetDatabase()->executeAsyncSql(query_stream, [=] (swganh::database::DatabaseResult* result) {
-                if (! result) {
-                    return;
-                }
+    _loadObjectClass("Ticket Collectors in Cells", [=] (BulkLoadCallback done) {
+        gTicketCollectorFactory->requestObjects(gCellFactory," INNER JOIN " + planet_cells + " ON (ticket_collectors.parent_id = planet_cells.id)",0,done);
+    });
 
-                std::unique_ptr<sql::ResultSet>& result_set = result->getResultSet();
+    _loadObjectClass("Persistent NPCs in Cells", [=] (BulkLoadCallback done) {
+        PersistentNpcFactory::getSingletonPtr()->requestObjects(gCellFactory," INNER JOIN " + planet_cells + " ON (persistent_npcs.parentId = planet_cells.id)",0,done);
+    });
 
-                while(result_set->next())
-                {
-                    gHouseFactory->requestObject(this,result_set->getUInt64(1),0,0,0);
-                }
-                LOG(info) << "Loaded " << result_set->rowsCount() << " Player Houses";
-                
-            });
-        }
-    }
-    // no objects to load, so we are done
-    else
-    {
-        _handleLoadComplete();
-    }
+    _loadObjectClass("Shuttles in Cells", [=] (BulkLoadCallback done) {
+        gShuttleFactory->requestObjects(gCellFactory," INNER JOIN " + planet_cells + " ON (shuttles.parentId = planet_cells.id)",0,done);
+    });
+
+    _loadObjectClass("Items in Cells", [=] (BulkLoadCallback done) {
+        _requestItems(gCellFactory," INNER JOIN " + planet_cells + " ON (items.parent_id = planet_cells.id)",done);
+    });
+
+    _loadObjectClass("Resource Containers in Cells", [=] (BulkLoadCallback done) {
+        gResourceContainerFactory->requestObjects(gCellFactory," INNER JOIN " + planet_cells + " ON (resource_containers.parent_id = planet_cells.id)",0,done);
+    });
 }
+
+//======================================================================================================================
+
 void WorldManager::_loadBuildings()
 {
-    stringstream query_stream;
-    query_stream << "SELECT id FROM "<<getKernel()->GetDatabase()->galaxy()<<".buildings WHERE planet_id = " << mZoneId;
-    getKernel()->GetDatabase()->executeAsyncSql(query_stream, [=] (swganh::database::DatabaseResult* result) {
-        if (! result) {
+    stringstream filter;
+    filter << " WHERE buildings.planet_id = " << mZoneId;
+
+    std::string buildings = filter.str();
+
+    _loadObjectClass("Buildings", [=] (BulkLoadCallback done) {
+        gBuildingFactory->requestObjects(this,buildings,0,done);
+    });
+}
+
+void WorldManager::_loadStructures()
+{
+    stringstream filter;
+    filter << " WHERE s.zone = " << mZoneId;
+
+    std::string structures = filter.str();
+
+    _loadObjectClass("Player Houses", [=] (BulkLoadCallback done) {
+        gHouseFactory->requestObjects(this,structures,0,done);
+    });
+
+    _loadObjectClass("Player Harvesters", [=] (BulkLoadCallback done) {
+        gHarvesterFactory->requestObjects(this,structures,0,done);
+    });
+
+    _loadObjectClass("Player Factories", [=] (BulkLoadCallback done) {
+        gFactoryFactory->requestObjects(this,structures,0,done);
+    });
+}
+
+//======================================================================================================================
+
+void WorldManager::_loadRegions()
+{
+    stringstream filter;
+
+    filter << " WHERE cities.planet_id = " << mZoneId << " ORDER BY cities.id";
+    std::string cities = filter.str();
+
+    filter.str(std::string());
+    filter << " WHERE badge_regions.planet_id = " << mZoneId << " ORDER BY badge_regions.id";
+    std::string badge_regions = filter.str();
+
+    filter.str(std::string());
+    filter << " WHERE spawn_regions.planet_id = " << mZoneId << " ORDER BY spawn_regions.id";
+    std::string spawn_regions = filter.str();
+
+    _loadObjectClass("City Regions", [=] (BulkLoadCallback done) {
+        gObjectFactory->requestRegions(Region_City,this,cities,done);
+    });
+
+    _loadObjectClass("Badge Regions", [=] (BulkLoadCallback done) {
+        gObjectFactory->requestRegions(Region_Badge,this,badge_regions,done);
+    });
+
+    _loadObjectClass("Spawn Regions", [=] (BulkLoadCallback done) {
+        gObjectFactory->requestRegions(Region_Spawn,this,spawn_regions,done);
+    });
+}
+
+//======================================================================================================================
+
+void WorldManager::_loadAllObjects(uint64 parentId)
+{
+    uint32 zoneId = mZoneId;
+
+    // the objects of a class on this planet with the given parent
+    auto children = [=] (const char* table,const char* parent_column) -> std::string {
+        stringstream filter;
+        filter << " WHERE (" << table << "." << parent_column << " = " << parentId << ") AND (" << table << ".planet_id = " << zoneId << ")";
+        return filter.str();
+    };
+
+    std::string terminals = children("terminals","parent_id") + " AND (terminal_types.name NOT LIKE 'unknown')";
+    std::string ticket_collectors = children("ticket_collectors","parent_id");
+    std::string persistent_npcs = children("persistent_npcs","parentId");
+    std::string shuttles = children("shuttles","parentId");
+    std::string items = children("items","parent_id");
+    std::string resource_containers = children("resource_containers","parent_id");
+
+    _loadObjectClass("Terminals", [=] (BulkLoadCallback done) {
+        gTerminalFactory->requestObjects(this,terminals,0,done);
+    });
+
+    _loadObjectClass("Ticket Collectors", [=] (BulkLoadCallback done) {
+        gTicketCollectorFactory->requestObjects(this,ticket_collectors,0,done);
+    });
+
+    _loadObjectClass("Persistent NPCs", [=] (BulkLoadCallback done) {
+        PersistentNpcFactory::getSingletonPtr()->requestObjects(this,persistent_npcs,0,done);
+    });
+
+    _loadObjectClass("Shuttles", [=] (BulkLoadCallback done) {
+        gShuttleFactory->requestObjects(this,shuttles,0,done);
+    });
+
+    _loadObjectClass("Items", [=] (BulkLoadCallback done) {
+        _requestItems(this,items,done);
+    });
+
+    _loadObjectClass("Resource Containers", [=] (BulkLoadCallback done) {
+        gResourceContainerFactory->requestObjects(this,resource_containers,0,done);
+    });
+}
+
+//======================================================================================================================
+
+void WorldManager::_loadObjectClass(const std::string& name,BulkLoadRequest request,uint32 attempt)
+{
+    request([=] (bool loaded,uint32 count) {
+        if(loaded)
+        {
+            LOG(info) << "Loaded " << count << " " << name;
             return;
         }
 
-        std::unique_ptr<sql::ResultSet>& result_set = result->getResultSet();
-
-        while(result_set->next())
+        if(attempt < kStartupLoadRetries)
         {
-            gObjectFactory->requestObject(ObjType_Building,0,0,this,result_set->getUInt64(1));
+            LOG(warning) << "Loading " << name << " failed, trying again";
+            _loadObjectClass(name,request,attempt + 1);
+            return;
         }
-        LOG(info) << "Loaded " << result_set->rowsCount() << " Buildings";
+
+        LOG(error) << "Loading " << name << " failed " << (attempt + 1) << " times, the zone can not complete its startup without them";
     });
 }
 
-void WorldManager::_loadAllObjects(uint64 parentId)
+//======================================================================================================================
+// the items are found in one query, the item factory loads them with everything inside of them a level at a time
+
+void WorldManager::_requestItems(ObjectFactoryCallback* ofCallback,const std::string& filter,BulkLoadCallback done)
 {
     stringstream query_stream;
-    query_stream << "(SELECT \'terminals\',terminals.id FROM "<<getKernel()->GetDatabase()->galaxy()<<".terminals INNER JOIN "<<getKernel()->GetDatabase()->galaxy()<<".terminal_types ON (terminals.terminal_type = terminal_types.id)"
-                 << " WHERE (terminal_types.name NOT LIKE 'unknown') AND (terminals.parent_id = " << parentId << ") AND (terminals.planet_id = "<< mZoneId << " ))"
-                 //<< " UNION (SELECT \'containers\',containers.id FROM "<<getKernel()->GetDatabase()->galaxy()<<".containers INNER JOIN "<<getKernel()->GetDatabase()->galaxy()<<".container_types ON (containers.container_type = container_types.id)"
-                 //<< " WHERE (container_types.name NOT LIKE 'unknown') AND (containers.parent_id = " << parentId << ") AND (containers.planet_id = "<< mZoneId << "))"
-                 << " UNION (SELECT \'ticket_collectors\',ticket_collectors.id FROM "<<getKernel()->GetDatabase()->galaxy()<<".ticket_collectors WHERE (parent_id=" << parentId << ") AND (planet_id="<< mZoneId << "))"
-                 << " UNION (SELECT \'persistent_npcs\',persistent_npcs.id FROM "<<getKernel()->GetDatabase()->galaxy()<<".persistent_npcs WHERE (parentId=" << parentId << ") AND (planet_id = "<< mZoneId << "))"
-                 << " UNION (SELECT \'shuttles\',shuttles.id FROM "<<getKernel()->GetDatabase()->galaxy()<<".shuttles WHERE (parentId=" << parentId << ") AND (planet_id = "<< mZoneId << "))"
-                 << " UNION (SELECT \'items\',items.id FROM "<<getKernel()->GetDatabase()->galaxy()<<".items WHERE (parent_id=" << parentId << ") AND (planet_id = "<< mZoneId << "))"
-                 << " UNION (SELECT \'resource_containers\',resource_containers.id FROM "<<getKernel()->GetDatabase()->galaxy()<<".resource_containers WHERE (parent_id=" << parentId << ") AND (planet_id = "<< mZoneId <<"))";
-    
-        getKernel()->GetDatabase()->executeAsyncSql(query_stream, [=] (swganh::database::DatabaseResult* result) {
+    query_stream << "SELECT items.id FROM " << getKernel()->GetDatabase()->galaxy() << ".items" << filter;
+
+    getKernel()->GetDatabase()->executeCheckedAsyncSql(query_stream.str(), [=] (swganh::database::DatabaseResult* result) {
         if (! result) {
+            done(false,0);
             return;
         }
 
         std::unique_ptr<sql::ResultSet>& result_set = result->getResultSet();
 
+        std::vector<uint64> items;
+        items.reserve(static_cast<uint32>(result_set->rowsCount()));
+
         while(result_set->next())
         {
-            std::string str = result_set->getString(1);
-            uint64_t id = result_set->getUInt64(2);
-            if(strcmp(str.c_str(),"terminals") == 0)
-                gObjectFactory->requestObject(ObjType_Tangible,TanGroup_Terminal,0,this,id);
-            else if(strcmp(str.c_str(),"ticket_collectors") == 0)
-                gObjectFactory->requestObject(ObjType_Tangible,TanGroup_TicketCollector,0,this,id);
-            else if(strcmp(str.c_str(),"shuttles") == 0)
-                gObjectFactory->requestObject(ObjType_Creature,CreoGroup_Shuttle,0,this,id);
-
-            if(strcmp(str.c_str(),"containers") == 0)
-                gObjectFactory->requestObject(ObjType_Tangible,TanGroup_Container,0,this,id);
-            else if(strcmp(str.c_str(),"persistent_npcs") == 0)
-                gObjectFactory->requestObject(ObjType_NPC,CreoGroup_PersistentNpc,0,this,id);
-            else if(strcmp(str.c_str(),"items") == 0)
-                gObjectFactory->requestObject(ObjType_Tangible,TanGroup_Item,0,this,id);
-            else if(strcmp(str.c_str(),"resource_containers") == 0)
-                gObjectFactory->requestObject(ObjType_Tangible,TanGroup_ResourceContainer,0,this,id);
+            items.push_back(result_set->getUInt64(1));
         }
-        LOG(info) << "Loaded " << result_set->rowsCount() << " Objects";
+
+        gItemFactory->requestItems(ofCallback,items,NULL);
+
+        done(true,static_cast<uint32>(items.size()));
     });
 }
 
@@ -460,5 +511,18 @@ void    WorldManager::_loadPlanetNamesAndFiles()
         
     } ) ;
 }
+
+//======================================================================================================================
+
+void WorldManager::_logStartupPhase(const char* phase)
+{
+    uint64 now = Anh_Utils::Clock::getSingleton()->getLocalTime();
+
+    LOG(info) << "Zone startup : " << phase << " after " << (now - mStartupPhaseTime) << "ms (" << (now - mStartupTime) << "ms total, "
+              << object_map_.size() << " of " << mTotalObjectCount << " objects)";
+
+    mStartupPhaseTime = now;
+}
+
 void WorldManager::handleDatabaseJobComplete(void* ref,swganh::database::DatabaseResult* result)
 {}
@@ -46,10 +46,8 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 
 void WorldManager::addDormantNpc(uint64 creature, uint64 when)
 {
-    // gLogger->log(LogManager::DEBUG,"Adding dormant NPC handler... %"PRIu64"",  creature);
-
     uint64 expireTime = Anh_Utils::Clock::getSingleton()->getLocalTime();
-    mNpcDormantHandlers.insert(std::make_pair(creature, expireTime + when));
+    mNpcDormantHandlers.add(creature, expireTime + when);
 }
 
 //======================================================================================================================
@@ -59,12 +57,7 @@ void WorldManager::addDormantNpc(uint64 creature, uint64 when)
 
 void WorldManager::removeDormantNpc(uint64 creature)
 {
-    NpcDormantHandlers::iterator it = mNpcDormantHandlers.find(creature);
-    if (it != mNpcDormantHandlers.end())
-    {
-        // Remove creature.
-        mNpcDormantHandlers.erase(it);
-    }
+    mNpcDormantHandlers.remove(creature);
 }
 
 //======================================================================================================================
@@ -74,14 +67,11 @@ void WorldManager::removeDormantNpc(uint64 creature)
 
 void WorldManager::forceHandlingOfDormantNpc(uint64 creature)
 {
-    NpcDormantHandlers::iterator it = mNpcDormantHandlers.find(creature);
-    if (it != mNpcDormantHandlers.end())
-    {
-        // Change the event time to NOW.
-        uint64 now = Anh_Utils::Clock::getSingleton()->getLocalTime();
-        (*it).second = now;
-    }
+    // Change the event time to NOW.
+    uint64 now = Anh_Utils::Clock::getSingleton()->getLocalTime();
+    mNpcDormantHandlers.reschedule(creature, now);
 }
+
 //======================================================================================================================
 //
 // Handle the queue of Dormant npc's.
@@ -89,45 +79,7 @@ void WorldManager::forceHandlingOfDormantNpc(uint64 creature)
 
 bool WorldManager::_handleDormantNpcs(uint64 callTime, void* ref)
 {
-    NpcDormantHandlers::iterator it = mNpcDormantHandlers.begin();
-    while (it != mNpcDormantHandlers.end())
-    {
-        //  The timer has expired?
-        if (callTime >= ((*it).second))
-        {
-            // Yes, handle it.
-            NPCObject* npc = dynamic_cast<NPCObject*>(this->getObjectById((*it).first));
-            if (npc)
-            {
-                // uint64 waitTime = NpcManager::Instance()->handleDormantNpc(creature, callTime - (*it).second);
-                // gLogger->log(LogManager::DEBUG,"Dormant... ID = %"PRIu64"",  (*it).first);
-                uint64 waitTime = NpcManager::Instance()->handleNpc(npc, callTime - (*it).second);
-
-                if (waitTime)
-                {
-                    // Set next execution time.
-                    (*it).second = callTime + waitTime;
-					it++;
-                }
-                else
-                {
-                    // gLogger->log(LogManager::DEBUG,"Removed dormant NPC handler... %"PRIu64"",  (*it).first);
-
-                    // Requested to remove the handler.
-                    mNpcDormantHandlers.erase(it++);
-                }
-            }
-            else
-            {
-                // Remove the expired object...
-                mNpcDormantHandlers.erase(it++);
-            }
-        }
-        else
-        {
-            ++it;
-        }
-    }
+    mNpcDormantHandlers.process(callTime);
     return true;
 }
 
@@ -139,8 +91,7 @@ bool WorldManager::_handleDormantNpcs(uint64 callTime, void* ref)
 void WorldManager::addReadyNpc(uint64 creature, uint64 when)
 {
     uint64 expireTime = Anh_Utils::Clock::getSingleton()->getLocalTime();
-
-    mNpcReadyHandlers.insert(std::make_pair(creature, expireTime + when));
+    mNpcReadyHandlers.add(creature, expireTime + when);
 }
 
 //======================================================================================================================
@@ -150,12 +101,7 @@ void WorldManager::addReadyNpc(uint64 creature, uint64 when)
 
 void WorldManager::removeReadyNpc(uint64 creature)
 {
-    NpcReadyHandlers::iterator it = mNpcReadyHandlers.find(creature);
-    if (it != mNpcReadyHandlers.end())
-    {
-        // Remove creature.
-        mNpcReadyHandlers.erase(it);
-    }
+    mNpcReadyHandlers.remove(creature);
 }
 
 //======================================================================================================================
@@ -165,13 +111,9 @@ void WorldManager::removeReadyNpc(uint64 creature)
 
 void WorldManager::forceHandlingOfReadyNpc(uint64 creature)
 {
-    NpcReadyHandlers::iterator it = mNpcReadyHandlers.find(creature);
-    if (it != mNpcReadyHandlers.end())
-    {
-        // Change the event time to NOW.
-        uint64 now = Anh_Utils::Clock::getSingleton()->getLocalTime();
-        (*it).second = now;
-    }
+    // Change the event time to NOW.
+    uint64 now = Anh_Utils::Clock::getSingleton()->getLocalTime();
+    mNpcReadyHandlers.reschedule(creature, now);
 }
 
 //======================================================================================================================
@@ -181,44 +123,7 @@ void WorldManager::forceHandlingOfReadyNpc(uint64 creature)
 
 bool WorldManager::_handleReadyNpcs(uint64 callTime, void* ref)
 {
-    NpcReadyHandlers::iterator it = mNpcReadyHandlers.begin();
-    while (it != mNpcReadyHandlers.end())
-    {
-        //  The timer has expired?
-        if (callTime >= ((*it).second))
-        {
-            // Yes, handle it.
-            NPCObject* npc = dynamic_cast<NPCObject*>(this->getObjectById((*it).first));
-            if (npc)
-            {
-                // uint64 waitTime = NpcManager::Instance()->handleReadyNpc(creature, callTime - (*it).second);
-                // gLogger->log(LogManager::DEBUG,"Ready...");
-                // gLogger->log(LogManager::DEBUG,"Ready... ID = %"PRIu64"",  (*it).first);
-                uint64 waitTime = NpcManager::Instance()->handleNpc(npc, callTime - (*it).second);
-                if (waitTime)
-                {
-                    // Set next execution time.
-                    (*it).second = callTime + waitTime;
-                }
-                else
-                {
-                    // Requested to remove the handler.
-                    mNpcReadyHandlers.erase(it++);
-                    // gLogger->log(LogManager::DEBUG,"Removed ready NPC handler...");
-                }
-            }
-            else
-            {
-                // Remove the expired object...
-                mNpcReadyHandlers.erase(it++);
-                // gLogger->log(LogManager::DEBUG,"Removed ready NPC handler...");
-            }
-        }
-        else
-        {
-            ++it;
-        }
-    }
+    mNpcReadyHandlers.process(callTime);
     return true;
 }
 
@@ -230,8 +135,7 @@ bool WorldManager::_handleReadyNpcs(uint64 callTime, void* ref)
 void WorldManager::addActiveNpc(uint64 creature, uint64 when)
 {
     uint64 expireTime = Anh_Utils::Clock::getSingleton()->getLocalTime();
-
-    mNpcActiveHandlers.insert(std::make_pair(creature, expireTime + when));
+    mNpcActiveHandlers.add(creature, expireTime + when);
 }
 
 //======================================================================================================================
@@ -241,12 +145,7 @@ void WorldManager::addActiveNpc(uint64 creature, uint64 when)
 
 void WorldManager::removeActiveNpc(uint64 creature)
 {
-    NpcActiveHandlers::iterator it = mNpcActiveHandlers.find(creature);
-    if (it != mNpcActiveHandlers.end())
-    {
-        // Remove creature.
-        mNpcActiveHandlers.erase(it);
-    }
+    mNpcActiveHandlers.remove(creature);
 }
 
 //======================================================================================================================
@@ -255,44 +154,7 @@ void WorldManager::removeActiveNpc(uint64 creature)
 //
 bool WorldManager::_handleActiveNpcs(uint64 callTime, void* ref)
 {
-    NpcActiveHandlers::iterator it = mNpcActiveHandlers.begin();
-    while (it != mNpcActiveHandlers.end())
-    {
-        //  The timer has expired?
-        if (callTime >= ((*it).second))
-        {
-            // Yes, handle it.
-            NPCObject* npc = dynamic_cast<NPCObject*>(this->getObjectById((*it).first));
-            if (npc)
-            {
-                // uint64 waitTime = NpcManager::Instance()->handleActiveNpc(creature, callTime - (*it).second);
-                // gLogger->log(LogManager::DEBUG,"Active...");
-                // gLogger->log(LogManager::DEBUG,"Active... ID = %"PRIu64"",  (*it).first);
-                uint64 waitTime = NpcManager::Instance()->handleNpc(npc, callTime - (*it).second);
-                if (waitTime)
-                {
-                    // Set next execution time.
-                    (*it).second = callTime + waitTime;
-                }
-                else
-                {
-                    // Requested to remove the handler.
-                    mNpcActiveHandlers.erase(it++);
-                    // gLogger->log(LogManager::DEBUG,"Removed active NPC handler...");
-                }
-            }
-            else
-            {
-                // Remove the expired object...
-                mNpcActiveHandlers.erase(it++);
-                // gLogger->log(LogManager::DEBUG,"Removed active NPC handler...");
-            }
-        }
-        else
-        {
-            ++it;
-        }
-    }
+    mNpcActiveHandlers.process(callTime);
     return true;
 }
 
@@ -35,7 +35,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "DatabaseManager/DatabaseResult.h"
 #include "MessageLib/MessageLib.h"
 
-#include "anh/Utils/Scheduler.h"
+#include "anh/Utils/TimingWheelScheduler.h"
 #include "Utils/VariableTimeScheduler.h"
 #include "Utils/utils.h"
 #include "NetworkManager/MessageFactory.h"
@@ -27,9 +27,10 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 
 #include "ZoneServer/WorldManager.h"
 
+#include <algorithm>
 #include <sstream>
 
-#include "anh/Utils/Scheduler.h"
+#include "anh/Utils/TimingWheelScheduler.h"
 #include "Utils/typedefs.h"
 #include "Utils/VariableTimeScheduler.h"
 #include "Utils/utils.h"
@@ -37,6 +38,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "DatabaseManager/Database.h"
 #include "DatabaseManager/DataBinding.h"
 #include "DatabaseManager/DatabaseResult.h"
+#include "DatabaseManager/WriteBehindQueue.h"
 
 #include "MessageLib/MessageLib.h"
 
@@ -91,77 +93,34 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 
 using std::stringstream;
 
-//======================================================================================================================
-
-void WorldManager::savePlayer(uint32 accId, bool remove, WMLogOut logout_type, CharacterLoadingContainer* clContainer) {
-    // Lookup the requested player and abort if not found
-    PlayerObject* player_object = getPlayerByAccId(accId);
-    if(!player_object) {
-        DLOG(warning) << "WorldManager::savePlayer could not find player with AccId:" << accId << ", save aborted.";
-		SAFE_DELETE(clContainer);
-        return;
-    }
-
-    // @TODO These need to go into the factories
-	//async save as soon as all queries are send the char can be deleted
-    storeCharacterPosition_(player_object, remove, logout_type, clContainer);    
-}
-
-void WorldManager::storeCharacterPosition_(PlayerObject* player_object, bool remove, WMLogOut logout_type, CharacterLoadingContainer* clContainer) {
-	if(!player_object) {
-        DLOG(warning) << "WorldManager::storeCharacterPosition_ Trying to save character position with an invalid PlayerObject";
-        return;
-    }
-
-	if(player_object->getLoadState() == LoadState_Loading) {
-        DLOG(warning) << "WorldManager::storeCharacterPosition_ Trying to save character while loading";
-        return;
-    }
-
-    // Determine whether this is a save for a zone transfer, if so the location
-    // we save will change.
-    bool transfer = (logout_type == WMLogOut_Zone_Transfer);
-
-    stringstream query_stream;
-
-	CreatureObject* body = player_object->GetCreature();
-
-    query_stream << "UPDATE "<<getKernel()->GetDatabase()->galaxy()<<".characters SET parent_id=" << body->getParentId() << ", "
-                 << "oX=" << body->mDirection.x << ", "
-                 << "oY=" << body->mDirection.y << ", "
-                 << "oZ=" << body->mDirection.z << ", "
-                 << "oW=" << body->mDirection.w << ", "
-                 << "x=" << (transfer ? clContainer->destination.x : body->mPosition.x) << ", "
-                 << "y=" << (transfer ? clContainer->destination.y : body->mPosition.y) << ", "
-                 << "z=" << (transfer ? clContainer->destination.z : body->mPosition.z) << ", "
-				 << "planet_id=" << (transfer ? clContainer->planet : mZoneId) << " "
-                 //<< "jedistate=" << player_object->getJediState() << " "
-				 << "WHERE id=" << body->getId();
-
-	//getKernel()->GetDatabase()->executeSqlAsync(clContainer->dbCallback,clContainer, query_stream.str());
-	getKernel()->GetDatabase()->executeAsyncSql(query_stream.str(), [=] (swganh::database::DatabaseResult* result) {
-			
-			storeCharacterAttributes_(player_object, remove, logout_type, clContainer);
-			//clContainer->dbCallback->handleDatabaseJobComplete(clContainer, nullptr);
-	});
+namespace {
 
+// the parameters of the WorldManager::storeCharacterPosition statement
+swganh::database::StatementParameters characterPositionParameters(CreatureObject* body, const glm::vec3& position, uint32 planet)
+{
+    swganh::database::StatementParameters parameters;
+    parameters.addUint(body->getParentId())
+        .addDouble(body->mDirection.x)
+        .addDouble(body->mDirection.y)
+        .addDouble(body->mDirection.z)
+        .addDouble(body->mDirection.w)
+        .addDouble(position.x)
+        .addDouble(position.y)
+        .addDouble(position.z)
+        .addUint(planet)
+        .addUint(body->getId());
+
+    return parameters;
 }
 
-void WorldManager::storeCharacterAttributes_(PlayerObject* player_object, bool remove, WMLogOut logout_type, CharacterLoadingContainer* clContainer) {
-    
-	if(!player_object) {
-        DLOG(warning) << "WorldManager::storeCharacterAttributes_ Trying to save character position with an invalid PlayerObject";
-		SAFE_DELETE(clContainer);
-        return;
-    }
-
+// the character_attributes update of a character, periodic saves compare it to the last one written
+std::string characterAttributesUpdate(swganh::database::Database* database, PlayerObject* player_object)
+{
     stringstream query_stream;
 
-	auto ham = gWorldManager->getKernel()->GetServiceManager()->GetService<swganh::ham::HamService>("HamService");
-
 	CreatureObject* player_creature = player_object->GetCreature();
 
-    query_stream << "UPDATE "<<getKernel()->GetDatabase()->galaxy()<<".character_attributes SET "
+    query_stream << "UPDATE "<<database->galaxy()<<".character_attributes SET "
 				 << "health_current=" << player_creature->GetStatCurrent(HamBar_Health) << ", "
 				 << "strength_current=" << player_creature->GetStatCurrent(HamBar_Strength) << ", "
 				 << "constitution_current=" << player_creature->GetStatCurrent(HamBar_Constitution) << ", "
@@ -196,21 +155,105 @@ void WorldManager::storeCharacterAttributes_(PlayerObject* player_object, bool r
 				 << "battlefatigue=" << player_creature->GetBattleFatigue() << ", "
                  << "posture=" << (uint16) player_creature->GetPosture() << ", "
                  << "moodId=" << static_cast<uint16_t>(player_creature->getMoodId()) << ", "
-                 << "title='" << getKernel()->GetDatabase()->escapeString(player_object->getTitle().getAnsi()) << "', "
+                 << "title='" << database->escapeString(player_object->getTitle().getAnsi()) << "', "
                  << "character_flags=" << player_object->getPlayerFlags() << ", "
                  << "states=" << player_creature->GetStateBitmask() << ", "
                  << "language=" << player_object->getLanguage() << ", "
                  << "new_player_exemptions=" <<  static_cast<uint16_t>(player_object->getNewPlayerExemptions()) << " "
                  << "WHERE character_id=" << player_creature->getId();
 
-	//LOG(error) << "query : " << query_stream.str();
+    return query_stream.str();
+}
+
+}
+
+//======================================================================================================================
+
+void WorldManager::savePlayer(uint32 accId, bool remove, WMLogOut logout_type, CharacterLoadingContainer* clContainer) {
+    // Lookup the requested player and abort if not found
+    PlayerObject* player_object = getPlayerByAccId(accId);
+    if(!player_object) {
+        DLOG(warning) << "WorldManager::savePlayer could not find player with AccId:" << accId << ", save aborted.";
+		SAFE_DELETE(clContainer);
+        return;
+    }
+
+    if(logout_type == WMLogOut_No_LogOut) {
+        // @TODO These need to go into the factories
+        //async save as soon as all queries are send the char can be deleted
+        storeCharacterPosition_(player_object, remove, logout_type, clContainer);
+        return;
+    }
+
+    // the character leaves the zone, what is held back for it has to be written before
+    // anyone loads it again. The player may be gone once the rows are written
+    uint64 player_id = player_object->getId();
+
+    mWriteBehind->flush([=] (bool written) {
+        PlayerObject* player = dynamic_cast<PlayerObject*>(getObjectById(player_id));
+
+        if(!player) {
+            DLOG(warning) << "WorldManager::savePlayer player " << player_id << " was removed before its rows were written, save aborted.";
+            delete clContainer;
+            return;
+        }
+
+        // the failed rows are dirty again, give them a last try before the character is saved
+        if(!written && !mWriteBehind->flushSync()) {
+            LOG(error) << "WorldManager::savePlayer could not write the held back rows before saving player " << player_id;
+        }
+
+        storeCharacterPosition_(player, remove, logout_type, clContainer);
+    });
+}
+
+void WorldManager::storeCharacterPosition_(PlayerObject* player_object, bool remove, WMLogOut logout_type, CharacterLoadingContainer* clContainer) {
+	if(!player_object) {
+        DLOG(warning) << "WorldManager::storeCharacterPosition_ Trying to save character position with an invalid PlayerObject";
+        return;
+    }
+
+	if(player_object->getLoadState() == LoadState_Loading) {
+        DLOG(warning) << "WorldManager::storeCharacterPosition_ Trying to save character while loading";
+        return;
+    }
+
+    // Determine whether this is a save for a zone transfer, if so the location
+    // we save will change.
+    bool transfer = (logout_type == WMLogOut_Zone_Transfer);
+
+	CreatureObject* body = player_object->GetCreature();
+
+    swganh::database::StatementParameters parameters = transfer ? characterPositionParameters(body, clContainer->destination, clContainer->planet)
+        : characterPositionParameters(body, body->mPosition, mZoneId);
+
+	getKernel()->GetDatabase()->executePreparedAsync("WorldManager::storeCharacterPosition", parameters, [=] (swganh::database::DatabaseResult* result) {
+			
+			storeCharacterAttributes_(player_object, remove, logout_type, clContainer);
+	});
+
+}
+
+void WorldManager::storeCharacterAttributes_(PlayerObject* player_object, bool remove, WMLogOut logout_type, CharacterLoadingContainer* clContainer) {
+    
+	if(!player_object) {
+        DLOG(warning) << "WorldManager::storeCharacterAttributes_ Trying to save character position with an invalid PlayerObject";
+		SAFE_DELETE(clContainer);
+        return;
+    }
+
+    std::string query = characterAttributesUpdate(getKernel()->GetDatabase(), player_object);
+
+	CreatureObject* player_creature = player_object->GetCreature();
+
+	//LOG(error) << "query : " << query;
 
 	if((logout_type == WMLogOut_Zone_Transfer) && clContainer) {
-		getKernel()->GetDatabase()->executeSqlAsync(clContainer->dbCallback, clContainer, query_stream.str());
+		getKernel()->GetDatabase()->executeSqlAsync(clContainer->dbCallback, clContainer, query);
 		return;
 	}
 
-	getKernel()->GetDatabase()->executeAsyncSql(query_stream.str());
+	getKernel()->GetDatabase()->executeAsyncSql(query);
 
 	if((logout_type == WMLogOut_Char_Load) && clContainer) {
         gObjectFactory->requestObject(ObjType_Player, 0, 0, clContainer->ofCallback, clContainer->mPlayerId, clContainer->mClient);
@@ -237,6 +280,9 @@ void WorldManager::storeCharacterAttributes_(PlayerObject* player_object, bool r
 void WorldManager::savePlayerSync(uint32 accId,bool remove)
 {
     PlayerObject* playerObject = getPlayerByAccId(accId);
+
+    mWriteBehind->flushSync();
+
  /*   Ham* ham = playerObject->getHam();
 
     getKernel()->GetDatabase()->destroyResult(getKernel()->GetDatabase()->executeSynchSql("UPDATE %s.characters SET parent_id=%"PRIu64",oX=%f,oY=%f,oZ=%f,oW=%f,x=%f,y=%f,z=%f,planet_id=%u WHERE id=%"PRIu64"",
@@ -440,36 +486,111 @@ void WorldManager::warpPlanet(PlayerObject* playerObject, const glm::vec3& desti
 }
 //======================================================================================================================
 //
-// Handles the saving of all players on a fixed interval
-// eventually we will put some logic to only save x players at a time
-// in this once the server becomes more stable
+// Saves the players a share at a time, so that every connected player is visited once per save interval
+// and no more than the budget is written in a second. A player nothing changed for is skipped.
 //
 bool	WorldManager::_handlePlayerSaveTimers(uint64 callTime, void* ref)
 {
-    //uint32 playerCount = mPlayerAccMap.size();
-    //// don't save all players if > 100
-    uint32 playerSaveCount = 0;
-    PlayerAccMap::iterator playerIt = mPlayerAccMap.begin();
-    while (playerIt != mPlayerAccMap.end())
+    if(mPlayerAccMap.empty())
     {
-        const PlayerObject* const playerObject = (*playerIt).second;
-        if (playerObject)
+        return true;
+    }
+
+    uint32 ticksPerCycle = std::max<uint32>(gWorldConfig->getPlayerSaveInterval() / 1000, 1);
+    uint32 visits = static_cast<uint32>((mPlayerAccMap.size() + ticksPerCycle - 1) / ticksPerCycle);
+    uint32 budget = gWorldConfig->getPlayerSaveBudget();
+    uint32 saves = 0;
+
+    // continue behind the account saved last, players that logged in meanwhile get their turn as well
+    PlayerAccMap::iterator playerIt = mPlayerAccMap.upper_bound(mPlayerSaveCursor);
+
+    while(visits && saves < budget)
+    {
+        if(playerIt == mPlayerAccMap.end())
         {
-            if (playerObject->isConnected())
-            {
-                // TODO: don't save all players if > x players (100ish)
-                // set the timer to save rest of players again
-                // TODO: check if player has saved recently
-                // save player async
-                gWorldManager->savePlayer(playerObject->getAccountId(), false, WMLogOut_No_LogOut);
-                ++playerSaveCount;
-            }
+            LOG(info) << "Player save cycle: saved " << mPlayerSaveCycle.mPerformed << ", skipped " << mPlayerSaveCycle.mSkipped
+                      << " unchanged, position writes " << mPlayerSaveCycle.mPositionWrites << ", attribute writes " << mPlayerSaveCycle.mAttributeWrites
+                      << ", peak queued db jobs " << mPlayerSaveCycle.mPeakQueuedJobs;
 
+            mPlayerSaveCycle = PlayerSaveStats();
+            mPlayerSaveCursor = 0;
+            break;
         }
 
+        PlayerObject* playerObject = const_cast<PlayerObject*>((*playerIt).second);
+        mPlayerSaveCursor = (*playerIt).first;
         ++playerIt;
+        --visits;
+
+        if(!playerObject || !playerObject->isConnected())
+        {
+            continue;
+        }
+
+        if(_saveChangedPlayerData(playerObject))
+        {
+            ++saves;
+            ++mPlayerSaveCycle.mPerformed;
+            ++mPlayerSaveTotals.mPerformed;
+        }
+        else
+        {
+            ++mPlayerSaveCycle.mSkipped;
+            ++mPlayerSaveTotals.mSkipped;
+        }
+    }
+
+    uint32 queuedJobs = getKernel()->GetDatabase()->getPendingJobCount();
+    mPlayerSaveCycle.mPeakQueuedJobs = std::max(mPlayerSaveCycle.mPeakQueuedJobs, queuedJobs);
+    mPlayerSaveTotals.mPeakQueuedJobs = std::max(mPlayerSaveTotals.mPeakQueuedJobs, queuedJobs);
+
+    return true;
+}
+
+//======================================================================================================================
+
+bool WorldManager::_saveChangedPlayerData(PlayerObject* player_object)
+{
+    if(player_object->getLoadState() == LoadState_Loading)
+    {
+        return false;
+    }
+
+    CreatureObject* body = player_object->GetCreature();
+    CharacterSaveImage& image = mCharacterSaveImages[player_object->getAccountId()];
+
+    bool positionChanged = !image.mSaved || image.mParentId != body->getParentId()
+                           || image.mPosition != body->mPosition || image.mDirection != body->mDirection;
+
+    std::string attributes = characterAttributesUpdate(getKernel()->GetDatabase(), player_object);
+    bool attributesChanged = !image.mSaved || image.mAttributes != attributes;
+
+    if(!positionChanged && !attributesChanged)
+    {
+        return false;
     }
-    //LOG(warning) << "Periodic Save of "<< playerSaveCount <<" Players";
+
+    if(positionChanged)
+    {
+        getKernel()->GetDatabase()->executePreparedAsync("WorldManager::storeCharacterPosition", characterPositionParameters(body, body->mPosition, mZoneId));
+
+        image.mParentId = body->getParentId();
+        image.mPosition = body->mPosition;
+        image.mDirection = body->mDirection;
+        ++mPlayerSaveCycle.mPositionWrites;
+        ++mPlayerSaveTotals.mPositionWrites;
+    }
+
+    if(attributesChanged)
+    {
+        getKernel()->GetDatabase()->executeAsyncSql(attributes);
+
+        image.mAttributes.swap(attributes);
+        ++mPlayerSaveCycle.mAttributeWrites;
+        ++mPlayerSaveTotals.mAttributeWrites;
+    }
+
+    image.mSaved = true;
     return true;
 }
 //======================================================================================================================
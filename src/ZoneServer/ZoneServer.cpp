@@ -93,6 +93,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "NetworkManager/MessageFactory.h"
 #include "NetworkManager/MessageOpcodes.h"
 #include "MessageLib/MessageLib.h"
+#include "ZoneServer/Objects/Creature Object/creature_message_builder.h"
 
 #include "Common/EventDispatcher.h"
 #include "Utils/utils.h"
@@ -179,7 +180,12 @@ ZoneServer::ZoneServer(int argc, char* argv[], swganh::app::SwganhKernel*	kernel
 										kernel_->GetAppConfig().swganh_netlayer.unreliable_server_client,
 										kernel_->GetAppConfig().swganh_netlayer.server_packet_window,
 										kernel_->GetAppConfig().swganh_netlayer.client_packet_window,
-										kernel_->GetAppConfig().swganh_netlayer.udp_buffer));
+										kernel_->GetAppConfig().swganh_netlayer.udp_buffer,
+										swganh::network::ParseSocketBackend(kernel_->GetAppConfig().swganh_netlayer.socket_backend),
+										kernel_->GetAppConfig().swganh_netlayer.socket_batch_size,
+										kernel_->GetAppConfig().swganh_netlayer.socket_write_workers,
+										kernel_->GetAppConfig().swganh_netlayer.compression_min_size,
+										kernel_->GetAppConfig().swganh_netlayer.compression_stats_interval));
 
 
     // Connect to the DB and start listening for the RouterServer.
@@ -388,6 +394,9 @@ void ZoneServer::Process(void)
 	//thats the old pre NewCore dispatcher
     gEventDispatcher.Tick(current_timestep);
 
+	// one merged delta per creature and view for everything that changed during this tick
+	gMessageLib->flushDeltas();
+
     //event_dispatcher_->tick(0);
 
     //is there stalling ?
@@ -404,6 +413,9 @@ void ZoneServer::Process(void)
     {
         mLastHeartbeat = time;
 		LOG(info) << "Zone : " << kernel_->GetAppConfig().zone_name << " currently serves " << gWorldManager->getPlayerAccMap()->size() << "Players";
+
+		StatDeltaCounters stat_deltas = gMessageLib->getCreatureMessageBuilder()->GetStatDeltaCounters();
+		LOG(info) << "Zone : " << kernel_->GetAppConfig().zone_name << " stat deltas sent " << stat_deltas.deltas_sent << " for " << stat_deltas.changes << " changes, " << stat_deltas.deltas_suppressed << " suppressed";
 		
 		//tick the db so the connection wont die when we are idle to long
 		_updateDBServerList(2);
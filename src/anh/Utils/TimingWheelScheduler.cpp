@@ -0,0 +1,429 @@
+/*
+---------------------------------------------------------------------------------------
+This source file is part of SWG:ANH (Star Wars Galaxies - A New Hope - Server Emulator)
+
+For more information, visit http://www.swganh.com
+
+Copyright (c) 2006 - 2014 The SWG:ANH Team
+---------------------------------------------------------------------------------------
+Use of this source code is governed by the GPL v3 license that can be found
+in the COPYING file or at http://www.gnu.org/licenses/gpl-3.0.html
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+---------------------------------------------------------------------------------------
+*/
+
+#include "TimingWheelScheduler.h"
+
+#include <algorithm>
+
+#include "clock.h"
+
+
+namespace Anh_Utils
+{
+//======================================================================================================================
+
+const uint32 TimingWheelScheduler::InvalidSlot;
+
+//======================================================================================================================
+
+TimingWheelScheduler::TimingWheelScheduler(Anh_Utils::Clock* clock, uint64 processTimeLimit, uint64 throttleLimit)
+    : mReadyHead(0),mWheelCount(0),mNextTaskId(1),mCurrentTime(0),mClock(clock),mProcessTimeLimit(processTimeLimit),mThrottleLimit(throttleLimit),mLastProcessTime(0)
+{
+    std::fill(mBuckets, mBuckets + WheelBuckets, InvalidSlot);
+    mNextTick = _getTime();
+}
+
+TimingWheelScheduler::TimingWheelScheduler(uint64 processTimeLimit, uint64 throttleLimit)
+    : mReadyHead(0),mWheelCount(0),mNextTaskId(1),mCurrentTime(0),mProcessTimeLimit(processTimeLimit),mThrottleLimit(throttleLimit),mLastProcessTime(0)
+{
+    mClock = gClock->getSingleton();
+
+    std::fill(mBuckets, mBuckets + WheelBuckets, InvalidSlot);
+    mNextTick = _getTime();
+}
+
+//======================================================================================================================
+
+TimingWheelScheduler::~TimingWheelScheduler()
+{
+}
+
+//======================================================================================================================
+
+uint64 TimingWheelScheduler::addTask(FDCallback callback,uint8 priority,uint64 interval,void* async)
+{
+    uint32 slot = _allocateSlot();
+    TimingWheelTask& task = mTasks[slot];
+
+    task.mId			= mNextTaskId;
+    task.mPriority		= priority;
+    task.mLastCallTime	= _getTime();
+    task.mInterval		= interval;
+    task.mCallback		= callback;
+    task.mAsync			= async;
+
+    // Scheduler fires once strictly more than interval ms have passed
+    task.mExpires		= task.mLastCallTime + interval + 1;
+
+    mTaskLookup.insert(std::make_pair(mNextTaskId, slot));
+    _schedule(slot);
+
+    return(mNextTaskId++);
+}
+
+//======================================================================================================================
+
+void TimingWheelScheduler::removeTask(uint64 id)
+{
+    if(!id)
+        return;
+
+    std::unordered_map<uint64, uint32>::iterator it = mTaskLookup.find(id);
+
+    if(it == mTaskLookup.end())
+        return;
+
+    uint32 slot = it->second;
+    mTaskLookup.erase(it);
+
+    TimingWheelTask& task = mTasks[slot];
+
+    switch(task.mState)
+    {
+    case TimingWheelTask::TaskState_Wheel:
+    {
+        _unlink(slot);
+        _freeSlot(slot);
+    }
+    break;
+
+    // the stale ready entry is skipped by runTask as the slot no longer carries this id
+    case TimingWheelTask::TaskState_Ready:
+    {
+        _freeSlot(slot);
+    }
+    break;
+
+    // removed from within its own callback, runTask frees the slot once the callback returns
+    case TimingWheelTask::TaskState_Running:
+    {
+        task.mState = TimingWheelTask::TaskState_Removed;
+    }
+    break;
+
+    default:
+        break;
+    }
+}
+
+//======================================================================================================================
+
+bool TimingWheelScheduler::checkTask(uint64 id)
+{
+    if(!id)
+        return false;
+
+    return(mTaskLookup.find(id) != mTaskLookup.end());
+}
+
+//======================================================================================================================
+
+void TimingWheelScheduler::process()
+{
+    uint64	frameStartTime = _getTime();
+
+    //Check for throttle
+    if(frameStartTime < (mLastProcessTime + mThrottleLimit))
+    {
+        return;
+    }
+
+    _advance(frameStartTime);
+
+    while(runTask() && ((_getTime() - frameStartTime) < mProcessTimeLimit));
+
+    //Set internal Clock so we know when the last call was
+    mLastProcessTime = _getTime();
+}
+
+//======================================================================================================================
+
+void TimingWheelScheduler::process(uint64 currentTime)
+{
+    mCurrentTime = currentTime;
+    process();
+}
+
+//======================================================================================================================
+
+bool TimingWheelScheduler::runTask()
+{
+    while(mReadyHead < mReady.size())
+    {
+        ReadyEntry entry = mReady[mReadyHead++];
+
+        if(mTasks[entry.mSlot].mId != entry.mId || mTasks[entry.mSlot].mState != TimingWheelTask::TaskState_Ready)
+        {
+            continue;
+        }
+
+        uint64		currentTime = _getTime();
+        FDCallback	callback	= mTasks[entry.mSlot].mCallback;
+        void*		async		= mTasks[entry.mSlot].mAsync;
+
+        mTasks[entry.mSlot].mState = TimingWheelTask::TaskState_Running;
+
+        // the callback may add tasks, so the task vector can be reallocated underneath us
+        bool reschedule = callback(currentTime,async);
+
+        TimingWheelTask& task = mTasks[entry.mSlot];
+
+        if(task.mState == TimingWheelTask::TaskState_Removed)
+        {
+            _freeSlot(entry.mSlot);
+        }
+        else if(!reschedule)
+        {
+            mTaskLookup.erase(task.mId);
+            _freeSlot(entry.mSlot);
+        }
+        else
+        {
+            task.mLastCallTime	= currentTime;
+            task.mExpires		= currentTime + task.mInterval + 1;
+            _schedule(entry.mSlot);
+        }
+
+        break;
+    }
+
+    if(mReadyHead >= mReady.size())
+    {
+        mReady.clear();
+        mReadyHead = 0;
+        return(false);
+    }
+
+    return(true);
+}
+
+//======================================================================================================================
+
+uint64 TimingWheelScheduler::_getTime() const
+{
+    if(mClock)
+        return mClock->getLocalTime();
+
+    return mCurrentTime;
+}
+
+//======================================================================================================================
+//
+// moves everything that came due up to currentTime into the ready list, cascading the outer wheels down as
+// the root wheel wraps around
+//
+
+void TimingWheelScheduler::_advance(uint64 currentTime)
+{
+    uint32 readyStart = static_cast<uint32>(mReady.size());
+
+    while(mNextTick <= currentTime)
+    {
+        // nothing left in the wheel, skip the idle ticks
+        if(!mWheelCount)
+        {
+            mNextTick = currentTime + 1;
+            break;
+        }
+
+        uint32 index = static_cast<uint32>(mNextTick & WheelRootMask);
+
+        if(!index)
+        {
+            for(uint32 level = 1; level < WheelLevels; ++level)
+            {
+                uint32 levelIndex = static_cast<uint32>((mNextTick >> (WheelRootBits + (level - 1) * WheelLevelBits)) & WheelLevelMask);
+
+                _cascade(WheelRootSize + (level - 1) * WheelLevelSize + levelIndex);
+
+                if(levelIndex)
+                    break;
+            }
+        }
+
+        _expire(index);
+
+        ++mNextTick;
+    }
+
+    // tasks coming due in the same frame run highest priority first, like the heap order of Scheduler
+    if(mReady.size() - readyStart > 1)
+    {
+        std::stable_sort(mReady.begin() + readyStart, mReady.end(), ReadyPriorityCompare(mTasks));
+    }
+}
+
+//======================================================================================================================
+
+void TimingWheelScheduler::_schedule(uint32 slot)
+{
+    TimingWheelTask& task = mTasks[slot];
+
+    // already due, straight to the ready list
+    if(task.mExpires < mNextTick)
+    {
+        task.mState = TimingWheelTask::TaskState_Ready;
+        mReady.push_back(ReadyEntry(slot, task.mId));
+        return;
+    }
+
+    uint64 delta = task.mExpires - mNextTick;
+    uint32 bucket;
+
+    if(delta < WheelRootSize)
+    {
+        bucket = static_cast<uint32>(task.mExpires & WheelRootMask);
+    }
+    else
+    {
+        uint32 level = 1;
+
+        while(level < WheelLevels - 1 && delta >= (static_cast<uint64>(1) << (WheelRootBits + level * WheelLevelBits)))
+        {
+            ++level;
+        }
+
+        // clamp to the range of the outermost wheel
+        uint64 maxDelta = (static_cast<uint64>(1) << (WheelRootBits + (WheelLevels - 1) * WheelLevelBits)) - 1;
+
+        if(delta > maxDelta)
+        {
+            task.mExpires = mNextTick + maxDelta;
+        }
+
+        bucket = WheelRootSize + (level - 1) * WheelLevelSize + static_cast<uint32>((task.mExpires >> (WheelRootBits + (level - 1) * WheelLevelBits)) & WheelLevelMask);
+    }
+
+    task.mState = TimingWheelTask::TaskState_Wheel;
+    _link(slot, bucket);
+}
+
+//======================================================================================================================
+
+void TimingWheelScheduler::_cascade(uint32 bucket)
+{
+    uint32 slot = mBuckets[bucket];
+    mBuckets[bucket] = InvalidSlot;
+
+    while(slot != InvalidSlot)
+    {
+        uint32 next = mTasks[slot].mNext;
+
+        --mWheelCount;
+        _schedule(slot);
+
+        slot = next;
+    }
+}
+
+//======================================================================================================================
+
+void TimingWheelScheduler::_expire(uint32 bucket)
+{
+    uint32 slot = mBuckets[bucket];
+    mBuckets[bucket] = InvalidSlot;
+
+    while(slot != InvalidSlot)
+    {
+        TimingWheelTask& task = mTasks[slot];
+        uint32 next = task.mNext;
+
+        --mWheelCount;
+        task.mState = TimingWheelTask::TaskState_Ready;
+        mReady.push_back(ReadyEntry(slot, task.mId));
+
+        slot = next;
+    }
+}
+
+//======================================================================================================================
+
+void TimingWheelScheduler::_link(uint32 slot, uint32 bucket)
+{
+    TimingWheelTask& task = mTasks[slot];
+
+    task.mBucket	= static_cast<uint16>(bucket);
+    task.mPrev		= InvalidSlot;
+    task.mNext		= mBuckets[bucket];
+
+    if(task.mNext != InvalidSlot)
+        mTasks[task.mNext].mPrev = slot;
+
+    mBuckets[bucket] = slot;
+    ++mWheelCount;
+}
+
+//======================================================================================================================
+
+void TimingWheelScheduler::_unlink(uint32 slot)
+{
+    TimingWheelTask& task = mTasks[slot];
+
+    if(task.mPrev != InvalidSlot)
+        mTasks[task.mPrev].mNext = task.mNext;
+    else
+        mBuckets[task.mBucket] = task.mNext;
+
+    if(task.mNext != InvalidSlot)
+        mTasks[task.mNext].mPrev = task.mPrev;
+
+    task.mPrev = task.mNext = InvalidSlot;
+    --mWheelCount;
+}
+
+//======================================================================================================================
+
+uint32 TimingWheelScheduler::_allocateSlot()
+{
+    if(mFreeSlots.empty())
+    {
+        mTasks.push_back(TimingWheelTask());
+        return static_cast<uint32>(mTasks.size() - 1);
+    }
+
+    uint32 slot = mFreeSlots.back();
+    mFreeSlots.pop_back();
+
+    return slot;
+}
+
+//======================================================================================================================
+
+void TimingWheelScheduler::_freeSlot(uint32 slot)
+{
+    TimingWheelTask& task = mTasks[slot];
+
+    task.mId		= 0;
+    task.mState		= TimingWheelTask::TaskState_Free;
+    task.mCallback.clear();
+    task.mAsync		= NULL;
+
+    mFreeSlots.push_back(slot);
+}
+}
+
+//======================================================================================================================
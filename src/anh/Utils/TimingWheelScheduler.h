@@ -0,0 +1,170 @@
+/*
+---------------------------------------------------------------------------------------
+This source file is part of SWG:ANH (Star Wars Galaxies - A New Hope - Server Emulator)
+
+For more information, visit http://www.swganh.com
+
+Copyright (c) 2006 - 2014 The SWG:ANH Team
+---------------------------------------------------------------------------------------
+Use of this source code is governed by the GPL v3 license that can be found
+in the COPYING file or at http://www.gnu.org/licenses/gpl-3.0.html
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+---------------------------------------------------------------------------------------
+*/
+
+#ifndef ANH_UTILS_TIMINGWHEELSCHEDULER_H
+#define ANH_UTILS_TIMINGWHEELSCHEDULER_H
+
+#include <unordered_map>
+#include <vector>
+
+#include "Utils/typedefs.h"
+#include "Utils/FastDelegate.h"
+#include "Scheduler.h"
+
+namespace Anh_Utils
+{
+
+class Clock;
+
+//======================================================================================================================
+
+class TimingWheelTask
+{
+public:
+
+    enum TaskState
+    {
+        TaskState_Free		= 0,
+        TaskState_Wheel		= 1,	// linked into one of the wheel buckets
+        TaskState_Ready		= 2,	// due, waiting in the ready list
+        TaskState_Running	= 3,	// callback is executing
+        TaskState_Removed	= 4		// removed from within its own callback
+    };
+
+    TimingWheelTask()
+        : mId(0),mLastCallTime(0),mInterval(0),mExpires(0),mAsync(NULL),mPrev(0),mNext(0),mBucket(0),mPriority(0),mState(TaskState_Free) {}
+
+    uint64		mId;
+    uint64		mLastCallTime;
+    uint64		mInterval;
+    uint64		mExpires;
+    FDCallback	mCallback;
+    void*		mAsync;
+    uint32		mPrev;
+    uint32		mNext;
+    uint16		mBucket;
+    uint8		mPriority;
+    uint8		mState;
+};
+
+//======================================================================================================================
+/*@brief TimingWheelScheduler is a drop in replacement for Scheduler which keeps its tasks in a hierarchical timing wheel
+*	(one millisecond root wheel of 256 buckets, four outer wheels of 64 buckets each, covering ~49 days).
+*	addTask/removeTask/checkTask are O(1) and process() only touches the buckets that came due since the last call,
+*	instead of walking every registered task like Scheduler::runTask() does.
+*
+*	Semantics are those of Scheduler: a task fires once more than interval ms passed since its last call, is
+*	rescheduled while its callback returns true, tasks due in the same frame run highest priority first and
+*	process() honours the processing time limit and the throttle limit.
+*/
+class TimingWheelScheduler
+{
+public:
+
+    /*	@brief	Creates a scheduler driven by the given clock. Passing NULL creates a scheduler which is only advanced
+    *	through process(uint64), as used by the unit tests and benchmarks.
+    */
+    TimingWheelScheduler(Anh_Utils::Clock* clock, uint64 processTimeLimit = 100, uint64 throttleLimit = 0);
+    TimingWheelScheduler(uint64 processTimeLimit = 100, uint64 throttleLimit = 0);
+    ~TimingWheelScheduler();
+
+    uint64	addTask(FDCallback callback,uint8 priority,uint64 interval,void* async);
+    void	removeTask(uint64 id);
+    bool	checkTask(uint64 id);
+    void	process();
+    void	process(uint64 currentTime);
+    bool	runTask();
+
+    uint32	getTaskCount() const {
+        return static_cast<uint32>(mTaskLookup.size());
+    }
+
+private:
+
+    enum
+    {
+        WheelRootBits	= 8,
+        WheelLevelBits	= 6,
+        WheelLevels		= 5,
+        WheelRootSize	= 1 << WheelRootBits,
+        WheelLevelSize	= 1 << WheelLevelBits,
+        WheelRootMask	= WheelRootSize - 1,
+        WheelLevelMask	= WheelLevelSize - 1,
+        WheelBuckets	= WheelRootSize + (WheelLevels - 1) * WheelLevelSize
+    };
+
+    static const uint32 InvalidSlot = 0xffffffff;
+
+    struct ReadyEntry
+    {
+        ReadyEntry(uint32 slot, uint64 id) : mSlot(slot), mId(id) {}
+
+        uint32	mSlot;
+        uint64	mId;
+    };
+
+    struct ReadyPriorityCompare
+    {
+        ReadyPriorityCompare(const std::vector<TimingWheelTask>& tasks) : mTasks(tasks) {}
+
+        bool operator()(const ReadyEntry& left, const ReadyEntry& right) const
+        {
+            return mTasks[left.mSlot].mPriority > mTasks[right.mSlot].mPriority;
+        }
+
+        const std::vector<TimingWheelTask>& mTasks;
+    };
+
+    uint64	_getTime() const;
+    void	_advance(uint64 currentTime);
+    void	_schedule(uint32 slot);
+    void	_cascade(uint32 bucket);
+    void	_expire(uint32 bucket);
+    void	_link(uint32 slot, uint32 bucket);
+    void	_unlink(uint32 slot);
+    uint32	_allocateSlot();
+    void	_freeSlot(uint32 slot);
+
+    std::vector<TimingWheelTask>			mTasks;
+    std::vector<uint32>						mFreeSlots;
+    std::unordered_map<uint64, uint32>		mTaskLookup;
+    std::vector<ReadyEntry>					mReady;
+    uint32									mReadyHead;
+    uint32									mBuckets[WheelBuckets];
+    uint32									mWheelCount;
+
+    uint64				mNextTick;
+    uint64				mNextTaskId;
+    uint64				mCurrentTime;
+    Anh_Utils::Clock*	mClock;
+    uint64				mProcessTimeLimit, mThrottleLimit, mLastProcessTime;
+};
+}
+
+#endif
+
+//======================================================================================================================
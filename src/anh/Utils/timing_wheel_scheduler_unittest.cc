@@ -0,0 +1,262 @@
+/*
+ This file is part of MMOServer. For more information, visit http://swganh.com
+
+ Copyright (c) 2006 - 2014 The SWG:ANH Team
+
+ MMOServer is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ MMOServer is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with MMOServer.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <gtest/gtest.h>
+
+#include <iostream>
+#include <vector>
+
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+#include "anh/Utils/clock.h"
+#include "anh/Utils/Scheduler.h"
+#include "anh/Utils/TimingWheelScheduler.h"
+
+using Anh_Utils::TimingWheelScheduler;
+
+// Wrapping tests in an anonymous namespace prevents potential name conflicts
+namespace {
+
+// schedulers without a clock are only advanced through process(uint64)
+Anh_Utils::Clock* const kNoClock = NULL;
+
+class TaskRecorder
+{
+public:
+    TaskRecorder() : calls(0), repeat(true), scheduler(NULL), remove_id(0) {}
+
+    bool handleTask(uint64 call_time, void* ref) {
+        ++calls;
+        call_times.push_back(call_time);
+        order.push_back(reinterpret_cast<uint64>(ref));
+
+        if (scheduler && remove_id) {
+            scheduler->removeTask(remove_id);
+        }
+
+        return repeat;
+    }
+
+    uint32 calls;
+    bool repeat;
+    TimingWheelScheduler* scheduler;
+    uint64 remove_id;
+    std::vector<uint64> call_times;
+    std::vector<uint64> order;
+};
+
+TEST(TimingWheelSchedulerTests, TaskFiresOnceIntervalHasPassed) {
+    TimingWheelScheduler scheduler(kNoClock);
+    TaskRecorder recorder;
+
+    scheduler.addTask(fastdelegate::MakeDelegate(&recorder, &TaskRecorder::handleTask), 1, 100, NULL);
+
+    scheduler.process(100);
+    EXPECT_EQ(0, recorder.calls);
+
+    scheduler.process(101);
+    EXPECT_EQ(1, recorder.calls);
+    EXPECT_EQ(101, recorder.call_times[0]);
+}
+
+TEST(TimingWheelSchedulerTests, TaskRepeatsWhileCallbackReturnsTrue) {
+    TimingWheelScheduler scheduler(kNoClock);
+    TaskRecorder recorder;
+
+    uint64 id = scheduler.addTask(fastdelegate::MakeDelegate(&recorder, &TaskRecorder::handleTask), 1, 1000, NULL);
+
+    for (uint64 time = 0; time <= 10000; time += 10) {
+        scheduler.process(time);
+    }
+
+    // fires at 1010, 2020, ... as the interval is measured from the actual call time
+    EXPECT_EQ(9, recorder.calls);
+    EXPECT_TRUE(scheduler.checkTask(id));
+
+    recorder.repeat = false;
+    scheduler.process(20000);
+
+    EXPECT_EQ(10, recorder.calls);
+    EXPECT_FALSE(scheduler.checkTask(id));
+    EXPECT_EQ(0, scheduler.getTaskCount());
+}
+
+TEST(TimingWheelSchedulerTests, RemovedTaskNeverFires) {
+    TimingWheelScheduler scheduler(kNoClock);
+    TaskRecorder recorder;
+
+    uint64 id = scheduler.addTask(fastdelegate::MakeDelegate(&recorder, &TaskRecorder::handleTask), 1, 500, NULL);
+    EXPECT_TRUE(scheduler.checkTask(id));
+
+    scheduler.removeTask(id);
+    EXPECT_FALSE(scheduler.checkTask(id));
+
+    scheduler.process(5000);
+    EXPECT_EQ(0, recorder.calls);
+}
+
+TEST(TimingWheelSchedulerTests, TaskCanRemoveItselfFromCallback) {
+    TimingWheelScheduler scheduler(kNoClock);
+    TaskRecorder recorder;
+    recorder.scheduler = &scheduler;
+
+    recorder.remove_id = scheduler.addTask(fastdelegate::MakeDelegate(&recorder, &TaskRecorder::handleTask), 1, 10, NULL);
+
+    scheduler.process(100);
+    scheduler.process(200);
+
+    EXPECT_EQ(1, recorder.calls);
+    EXPECT_FALSE(scheduler.checkTask(recorder.remove_id));
+}
+
+TEST(TimingWheelSchedulerTests, LongIntervalsCascadeToTheirDeadline) {
+    TimingWheelScheduler scheduler(kNoClock);
+    TaskRecorder recorder;
+    recorder.repeat = false;
+
+    // spans the root wheel and the first three outer wheels
+    const uint64 intervals[] = { 300, 20000, 1500000, 70000000 };
+
+    for (uint32 i = 0; i < 4; ++i) {
+        scheduler.addTask(fastdelegate::MakeDelegate(&recorder, &TaskRecorder::handleTask), 1, intervals[i], reinterpret_cast<void*>(intervals[i]));
+    }
+
+    for (uint64 time = 0; time <= 80000000; time += 250) {
+        scheduler.process(time);
+    }
+
+    ASSERT_EQ(4, recorder.calls);
+
+    for (uint32 i = 0; i < 4; ++i) {
+        EXPECT_EQ(intervals[i], recorder.order[i]);
+
+        // never early and at most one process() step late
+        EXPECT_GT(recorder.call_times[i], intervals[i]);
+        EXPECT_LE(recorder.call_times[i], intervals[i] + 250);
+    }
+}
+
+TEST(TimingWheelSchedulerTests, TasksDueInTheSameFrameRunByPriority) {
+    TimingWheelScheduler scheduler(kNoClock);
+    TaskRecorder recorder;
+    recorder.repeat = false;
+
+    scheduler.addTask(fastdelegate::MakeDelegate(&recorder, &TaskRecorder::handleTask), 1, 100, reinterpret_cast<void*>(1));
+    scheduler.addTask(fastdelegate::MakeDelegate(&recorder, &TaskRecorder::handleTask), 9, 50, reinterpret_cast<void*>(9));
+    scheduler.addTask(fastdelegate::MakeDelegate(&recorder, &TaskRecorder::handleTask), 5, 80, reinterpret_cast<void*>(5));
+
+    scheduler.process(1000);
+
+    ASSERT_EQ(3, recorder.calls);
+    EXPECT_EQ(9, recorder.order[0]);
+    EXPECT_EQ(5, recorder.order[1]);
+    EXPECT_EQ(1, recorder.order[2]);
+}
+
+TEST(TimingWheelSchedulerTests, ThrottleLimitSkipsEarlyProcessCalls) {
+    TimingWheelScheduler scheduler(kNoClock, 100, 500);
+    TaskRecorder recorder;
+
+    scheduler.addTask(fastdelegate::MakeDelegate(&recorder, &TaskRecorder::handleTask), 1, 10, NULL);
+
+    scheduler.process(600);
+    EXPECT_EQ(1, recorder.calls);
+
+    // within the throttle window of the last run
+    scheduler.process(700);
+    EXPECT_EQ(1, recorder.calls);
+
+    scheduler.process(1100);
+    EXPECT_EQ(2, recorder.calls);
+}
+
+/// Compares the frame cost of the linear Scheduler against the TimingWheelScheduler with the
+/// intervals used by the zone schedulers. Run with --gtest_also_run_disabled_tests.
+TEST(TimingWheelSchedulerTests, DISABLED_BenchmarkAgainstLinearScheduler) {
+    namespace pt = boost::posix_time;
+
+    Anh_Utils::Clock::Init();
+
+    const uint32 task_counts[] = { 1000, 10000, 100000 };
+    const uint32 frames = 200;
+
+    for (uint32 c = 0; c < 3; ++c) {
+        uint32 task_count = task_counts[c];
+
+        TaskRecorder linear_recorder;
+        TaskRecorder wheel_recorder;
+
+        Anh_Utils::Scheduler linear(gClock);
+        TimingWheelScheduler wheel(gClock);
+
+        std::vector<uint64> linear_ids;
+        std::vector<uint64> wheel_ids;
+
+        pt::ptime start = pt::microsec_clock::universal_time();
+        for (uint32 i = 0; i < task_count; ++i) {
+            linear_ids.push_back(linear.addTask(fastdelegate::MakeDelegate(&linear_recorder, &TaskRecorder::handleTask), 1, 125 + (i % 64) * 1000, NULL));
+        }
+        pt::time_duration linear_add = pt::microsec_clock::universal_time() - start;
+
+        start = pt::microsec_clock::universal_time();
+        for (uint32 i = 0; i < task_count; ++i) {
+            wheel_ids.push_back(wheel.addTask(fastdelegate::MakeDelegate(&wheel_recorder, &TaskRecorder::handleTask), 1, 125 + (i % 64) * 1000, NULL));
+        }
+        pt::time_duration wheel_add = pt::microsec_clock::universal_time() - start;
+
+        start = pt::microsec_clock::universal_time();
+        for (uint32 i = 0; i < frames; ++i) {
+            linear.process();
+        }
+        pt::time_duration linear_process = pt::microsec_clock::universal_time() - start;
+
+        start = pt::microsec_clock::universal_time();
+        for (uint32 i = 0; i < frames; ++i) {
+            wheel.process();
+        }
+        pt::time_duration wheel_process = pt::microsec_clock::universal_time() - start;
+
+        // cancel one percent of the tasks, as object controllers and stomach timers do all the time
+        start = pt::microsec_clock::universal_time();
+        for (uint32 i = 0; i < task_count; i += 100) {
+            linear.removeTask(linear_ids[i]);
+        }
+        pt::time_duration linear_remove = pt::microsec_clock::universal_time() - start;
+
+        start = pt::microsec_clock::universal_time();
+        for (uint32 i = 0; i < task_count; i += 100) {
+            wheel.removeTask(wheel_ids[i]);
+        }
+        pt::time_duration wheel_remove = pt::microsec_clock::universal_time() - start;
+
+        std::cout << task_count << " tasks, " << frames << " frames:" << std::endl
+                  << "  Scheduler            add " << linear_add.total_microseconds() << "us"
+                  << "  process " << linear_process.total_microseconds() << "us"
+                  << "  remove " << linear_remove.total_microseconds() << "us"
+                  << "  calls " << linear_recorder.calls << std::endl
+                  << "  TimingWheelScheduler add " << wheel_add.total_microseconds() << "us"
+                  << "  process " << wheel_process.total_microseconds() << "us"
+                  << "  remove " << wheel_remove.total_microseconds() << "us"
+                  << "  calls " << wheel_recorder.calls << std::endl;
+    }
+
+    Anh_Utils::Clock::destroySingleton();
+}
+
+}  // namespace
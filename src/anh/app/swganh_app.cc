@@ -178,6 +178,11 @@ options_description AppConfig::BuildConfigDescription()
 	("ServerPacketWindowSize", boost::program_options::value<uint32_t>(&swganh_netlayer.server_packet_window)->default_value(800), "amount of packets we send before receiving an ack")
 	("ClientPacketWindowSize", boost::program_options::value<uint32_t>(&swganh_netlayer.client_packet_window)->default_value(80), "amount of packets we send before receiving an ack. Please note that the clients UDP Buffer is limited")
 	("UdpBufferSize", boost::program_options::value<uint32_t>(&swganh_netlayer.udp_buffer)->default_value(4096), "Kernel UDP Buffer size in kb. This needs to be massive so the servers can keep communicating")
+	("SocketBackend", boost::program_options::value<std::string>(&swganh_netlayer.socket_backend)->default_value("select"), "socket io backend, select or epoll. epoll reads and writes batches of datagrams with recvmmsg / sendmmsg and is linux only")
+	("SocketBatchSize", boost::program_options::value<uint32_t>(&swganh_netlayer.socket_batch_size)->default_value(32), "datagrams read and written per system call by the epoll backend")
+	("SocketWriteWorkers", boost::program_options::value<uint32_t>(&swganh_netlayer.socket_write_workers)->default_value(2), "threads building the outgoing packets of the sessions, sessions are sharded by id")
+	("CompressionMinSize", boost::program_options::value<uint32_t>(&swganh_netlayer.compression_min_size)->default_value(48), "payloads below this many bytes are sent uncompressed, deflate costs more than it saves on them")
+	("CompressionStatsInterval", boost::program_options::value<uint32_t>(&swganh_netlayer.compression_stats_interval)->default_value(300), "seconds between the packet compression stats of every service in the log, 0 for none")
     
     ;
 
@@ -87,6 +87,11 @@ struct AppConfig {
 		uint32_t	server_packet_window;
 		uint32_t	client_packet_window;
 		uint32_t	udp_buffer;
+		std::string	socket_backend;
+		uint32_t	socket_batch_size;
+		uint32_t	socket_write_workers;
+		uint32_t	compression_min_size;
+		uint32_t	compression_stats_interval;
 	}swganh_netlayer;
 
     /*!
@@ -0,0 +1,334 @@
+// This file is part of SWGANH which is released under the MIT license.
+// See file LICENSE or go to http://swganh.com/LICENSE
+
+#include "block_pool.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+#include <boost/atomic.hpp>
+#include <boost/thread/mutex.hpp>
+
+using namespace swganh;
+
+namespace {
+	// the depot head carries a counter next to the pointer, bumped on every change, so a
+	// batch popped and pushed again in between can't fool a compare and swap
+#if UINTPTR_MAX > 0xffffffffu
+	const int kTagShift = 48;
+#else
+	const int kTagShift = 32;
+#endif
+	const uint64_t kPointerMask = (static_cast<uint64_t>(1) << kTagShift) - 1;
+
+	const size_t kBlockAlignment = 16;
+}
+
+namespace swganh {
+namespace detail {
+
+	// a free block, the first one of a batch also links the batches in the depot
+	struct BlockPoolNode
+	{
+		BlockPoolNode* next;
+		BlockPoolNode* next_batch;
+		uint32_t count;
+	};
+
+	struct BlockPoolDepot
+	{
+		BlockPoolDepot(size_t block_size_, uint32_t batch_size_, uint32_t blocks_per_chunk_)
+			: block_size(block_size_)
+			, batch_size(batch_size_)
+			, blocks_per_chunk(blocks_per_chunk_)
+			, head(0)
+			, capacity(0)
+			, in_use(0)
+			, high_water(0)
+			, exchanges(0)
+		{
+		}
+
+		~BlockPoolDepot()
+		{
+			std::for_each(chunks.begin(), chunks.end(), [] (char* chunk) { std::free(chunk); });
+		}
+
+		static BlockPoolNode* GetNode(uint64_t tagged)
+		{
+			return reinterpret_cast<BlockPoolNode*>(static_cast<uintptr_t>(tagged & kPointerMask));
+		}
+
+		static uint64_t Tag(BlockPoolNode* node, uint64_t previous)
+		{
+			return static_cast<uint64_t>(reinterpret_cast<uintptr_t>(node)) | (((previous >> kTagShift) + 1) << kTagShift);
+		}
+
+		void Push(BlockPoolNode* batch)
+		{
+			uint64_t current = head.load(boost::memory_order_relaxed);
+
+			do
+			{
+				batch->next_batch = GetNode(current);
+			}
+			while (!head.compare_exchange_weak(current, Tag(batch, current), boost::memory_order_release, boost::memory_order_relaxed));
+		}
+
+		BlockPoolNode* Pop()
+		{
+			uint64_t current = head.load(boost::memory_order_acquire);
+
+			for (;;)
+			{
+				BlockPoolNode* batch = GetNode(current);
+
+				if (!batch)
+				{
+					return nullptr;
+				}
+
+				// the batch may be taken and its block handed out meanwhile, the memory stays
+				// ours though and the tag makes the swap fail then
+				BlockPoolNode* next = batch->next_batch;
+
+				if (head.compare_exchange_weak(current, Tag(next, current), boost::memory_order_acquire, boost::memory_order_acquire))
+				{
+					return batch;
+				}
+			}
+		}
+
+		/**
+			splits a new chunk into batches, hands out the first and pushes the rest
+		*/
+		BlockPoolNode* Carve()
+		{
+			char* chunk = static_cast<char*>(std::malloc(block_size * blocks_per_chunk));
+
+			if (!chunk)
+			{
+				throw std::bad_alloc();
+			}
+
+			{
+				boost::mutex::scoped_lock lock(chunk_mutex);
+				chunks.push_back(chunk);
+			}
+
+			capacity.fetch_add(blocks_per_chunk, boost::memory_order_relaxed);
+
+			BlockPoolNode* first = nullptr;
+
+			for (uint32_t start = 0; start < blocks_per_chunk; start += batch_size)
+			{
+				uint32_t count = std::min(batch_size, blocks_per_chunk - start);
+				BlockPoolNode* batch = reinterpret_cast<BlockPoolNode*>(chunk + start * block_size);
+
+				for (uint32_t i = 0; i < count; ++i)
+				{
+					BlockPoolNode* node = reinterpret_cast<BlockPoolNode*>(chunk + (start + i) * block_size);
+					node->next = (i + 1 < count) ? reinterpret_cast<BlockPoolNode*>(chunk + (start + i + 1) * block_size) : nullptr;
+				}
+
+				batch->count = count;
+
+				if (first)
+				{
+					Push(batch);
+				}
+				else
+				{
+					first = batch;
+				}
+			}
+
+			return first;
+		}
+
+		/**
+			the allocations and frees a cache made since its last exchange
+		*/
+		void Account(int64_t& balance)
+		{
+			exchanges.fetch_add(1, boost::memory_order_relaxed);
+
+			int64_t now_in_use = in_use.fetch_add(balance, boost::memory_order_relaxed) + balance;
+			balance = 0;
+
+			int64_t highest = high_water.load(boost::memory_order_relaxed);
+			while (now_in_use > highest && !high_water.compare_exchange_weak(highest, now_in_use, boost::memory_order_relaxed))
+			{
+			}
+		}
+
+		const size_t block_size;
+		const uint32_t batch_size;
+		const uint32_t blocks_per_chunk;
+
+		boost::atomic<uint64_t> head;
+
+		boost::atomic<uint64_t> capacity;
+		boost::atomic<int64_t> in_use;
+		boost::atomic<int64_t> high_water;
+		boost::atomic<uint64_t> exchanges;
+
+		boost::mutex chunk_mutex;
+		std::vector<char*> chunks;
+	};
+
+	struct BlockPoolCache
+	{
+		explicit BlockPoolCache(const std::shared_ptr<BlockPoolDepot>& depot_)
+			: depot(depot_)
+			, head(nullptr)
+			, count(0)
+			, balance(0)
+		{
+		}
+
+		// the thread ended or the pool is gone, everything goes back to the depot
+		~BlockPoolCache()
+		{
+			if (head)
+			{
+				head->count = count;
+				depot->Push(head);
+			}
+
+			depot->Account(balance);
+		}
+
+		std::shared_ptr<BlockPoolDepot> depot;
+		BlockPoolNode* head;
+		uint32_t count;
+		int64_t balance;
+	};
+
+}}
+
+using detail::BlockPoolNode;
+using detail::BlockPoolCache;
+
+BlockPool::BlockPool(size_t block_size, uint32_t batch_size, uint32_t blocks_per_chunk)
+{
+	block_size = std::max(block_size, sizeof(BlockPoolNode));
+	block_size = (block_size + kBlockAlignment - 1) & ~(kBlockAlignment - 1);
+
+	batch_size = std::max<uint32_t>(batch_size, 1);
+	blocks_per_chunk = std::max(blocks_per_chunk, batch_size);
+
+	depot_ = std::make_shared<detail::BlockPoolDepot>(block_size, batch_size, blocks_per_chunk);
+}
+
+BlockPool::~BlockPool()
+{
+	// only the cache of this thread goes now, those of other threads when they end
+	cache_.reset();
+}
+
+void* BlockPool::Allocate()
+{
+	BlockPoolCache* cache = GetCache_();
+
+	if (!cache->head)
+	{
+		BlockPoolNode* batch = depot_->Pop();
+
+		if (!batch)
+		{
+			batch = depot_->Carve();
+		}
+
+		cache->head = batch;
+		cache->count = batch->count;
+		depot_->Account(cache->balance);
+	}
+
+	BlockPoolNode* node = cache->head;
+	cache->head = node->next;
+	--cache->count;
+	++cache->balance;
+
+	return node;
+}
+
+void BlockPool::Free(void* block)
+{
+	if (!block)
+	{
+		return;
+	}
+
+	BlockPoolCache* cache = GetCache_();
+
+	BlockPoolNode* node = static_cast<BlockPoolNode*>(block);
+	node->next = cache->head;
+	cache->head = node;
+	++cache->count;
+	--cache->balance;
+
+	// keep a batch in reserve and hand the one on top of it back
+	uint32_t batch_size = depot_->batch_size;
+
+	if (cache->count >= batch_size * 2)
+	{
+		BlockPoolNode* batch = cache->head;
+		BlockPoolNode* last = batch;
+
+		for (uint32_t i = 1; i < batch_size; ++i)
+		{
+			last = last->next;
+		}
+
+		cache->head = last->next;
+		cache->count -= batch_size;
+
+		last->next = nullptr;
+		batch->count = batch_size;
+
+		depot_->Push(batch);
+		depot_->Account(cache->balance);
+	}
+}
+
+size_t BlockPool::GetBlockSize() const
+{
+	return depot_->block_size;
+}
+
+uint64_t BlockPool::GetCapacity() const
+{
+	return depot_->capacity.load(boost::memory_order_relaxed);
+}
+
+int64_t BlockPool::GetInUse() const
+{
+	return depot_->in_use.load(boost::memory_order_relaxed);
+}
+
+int64_t BlockPool::GetHighWaterMark() const
+{
+	return depot_->high_water.load(boost::memory_order_relaxed);
+}
+
+uint64_t BlockPool::GetDepotExchanges() const
+{
+	return depot_->exchanges.load(boost::memory_order_relaxed);
+}
+
+BlockPoolCache* BlockPool::GetCache_()
+{
+	BlockPoolCache* cache = cache_.get();
+
+	// a cache left behind by a pool that lived at the same address before
+	if (!cache || cache->depot != depot_)
+	{
+		cache = new BlockPoolCache(depot_);
+		cache_.reset(cache);
+	}
+
+	return cache;
+}
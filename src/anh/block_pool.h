@@ -0,0 +1,80 @@
+// This file is part of SWGANH which is released under the MIT license.
+// See file LICENSE or go to http://swganh.com/LICENSE
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include <boost/thread/tss.hpp>
+
+namespace swganh
+{
+	namespace detail
+	{
+		struct BlockPoolDepot;
+		struct BlockPoolCache;
+	}
+
+	/**
+		@brief A pool of fixed size blocks for allocations from many threads.
+
+		Every thread allocates from and frees into a cache of its own without any
+		synchronization. A cache that runs dry takes a batch of blocks from the shared depot,
+		one that overflows hands a batch back, both with a single compare and swap on the
+		depot's lock free stack. Blocks freed by another thread than the one that allocated
+		them simply end up in that thread's cache. A thread's cache goes back to the depot
+		when the thread ends.
+
+		The depot grows by chunks of blocks and only gives its memory back when the pool and
+		every thread that used it are gone.
+	*/
+	class BlockPool
+	{
+	public:
+		BlockPool(size_t block_size, uint32_t batch_size = 32, uint32_t blocks_per_chunk = 256);
+		~BlockPool();
+
+		/**
+			@returns a block of at least the block size, aligned for any type
+		*/
+		void* Allocate();
+
+		/**
+			@param block from Allocate() of this pool, from any thread
+		*/
+		void Free(void* block);
+
+		size_t GetBlockSize() const;
+
+		/**
+			@brief the number of blocks carved from chunks, the memory the pool holds
+		*/
+		uint64_t GetCapacity() const;
+
+		/**
+			@brief blocks handed out and not yet freed, as of the last exchange of every
+			thread with the depot, it lags by up to two batches per thread
+		*/
+		int64_t GetInUse() const;
+
+		/**
+			@brief the highest GetInUse() seen
+		*/
+		int64_t GetHighWaterMark() const;
+
+		/**
+			@brief the batches the caches took from and gave back to the depot
+		*/
+		uint64_t GetDepotExchanges() const;
+
+	private:
+		BlockPool(const BlockPool&);
+		BlockPool& operator=(const BlockPool&);
+
+		detail::BlockPoolCache* GetCache_();
+
+		std::shared_ptr<detail::BlockPoolDepot> depot_;
+		boost::thread_specific_ptr<detail::BlockPoolCache> cache_;
+	};
+}
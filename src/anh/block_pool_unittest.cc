@@ -0,0 +1,270 @@
+/*
+ This file is part of MMOServer. For more information, visit http://swganh.com
+
+ Copyright (c) 2006 - 2014 The SWG:ANH Team
+
+ MMOServer is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ MMOServer is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with MMOServer.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <set>
+#include <vector>
+
+#include <boost/atomic.hpp>
+#include <boost/pool/pool.hpp>
+#include <boost/thread/recursive_mutex.hpp>
+#include <boost/thread/thread.hpp>
+
+#include "anh/block_pool.h"
+
+using swganh::BlockPool;
+
+namespace {
+
+/// A single producer single consumer ring handing blocks from one thread to another.
+class Handoff {
+public:
+    explicit Handoff(uint32_t size) : slots_(size), head_(0), tail_(0) {}
+
+    bool Push(void* block) {
+        uint32_t head = head_.load(boost::memory_order_relaxed);
+        if (head - tail_.load(boost::memory_order_acquire) == slots_.size()) {
+            return false;
+        }
+        slots_[head % slots_.size()] = block;
+        head_.store(head + 1, boost::memory_order_release);
+        return true;
+    }
+
+    void* Pop() {
+        uint32_t tail = tail_.load(boost::memory_order_relaxed);
+        if (tail == head_.load(boost::memory_order_acquire)) {
+            return nullptr;
+        }
+        void* block = slots_[tail % slots_.size()];
+        tail_.store(tail + 1, boost::memory_order_release);
+        return block;
+    }
+
+private:
+    std::vector<void*> slots_;
+    boost::atomic<uint32_t> head_;
+    boost::atomic<uint32_t> tail_;
+};
+
+/// Producers allocate and stamp blocks, consumers check the stamp and free them.
+template<typename Allocate, typename Free>
+uint64_t RunHandoff(uint32_t pairs, uint32_t blocks_per_pair, Allocate allocate, Free free) {
+    std::vector<std::unique_ptr<Handoff>> handoffs;
+    boost::atomic<uint64_t> corrupted(0);
+    boost::thread_group threads;
+
+    for (uint32_t pair = 0; pair < pairs; ++pair) {
+        handoffs.emplace_back(new Handoff(256));
+        Handoff* handoff = handoffs.back().get();
+
+        threads.create_thread([=] {
+            for (uint32_t i = 0; i < blocks_per_pair; ++i) {
+                uint32_t* block = static_cast<uint32_t*>(allocate());
+                block[0] = pair;
+                block[1] = i;
+                while (!handoff->Push(block)) {
+                    boost::this_thread::yield();
+                }
+            }
+        });
+
+        threads.create_thread([=, &corrupted] {
+            for (uint32_t i = 0; i < blocks_per_pair; ++i) {
+                uint32_t* block;
+                while (!(block = static_cast<uint32_t*>(handoff->Pop()))) {
+                    boost::this_thread::yield();
+                }
+                if (block[0] != pair || block[1] != i) {
+                    ++corrupted;
+                }
+                free(block);
+            }
+        });
+    }
+
+    threads.join_all();
+    return corrupted;
+}
+
+/// Every thread allocates bursts of blocks and frees them again itself, like acks and resends.
+template<typename Allocate, typename Free>
+void RunBursts(uint32_t threads_count, uint32_t blocks_per_thread, Allocate allocate, Free free) {
+    boost::thread_group threads;
+
+    for (uint32_t thread = 0; thread < threads_count; ++thread) {
+        threads.create_thread([=] {
+            void* burst[64];
+            for (uint32_t i = 0; i < blocks_per_thread; i += 64) {
+                for (uint32_t j = 0; j < 64; ++j) {
+                    burst[j] = allocate();
+                }
+                for (uint32_t j = 0; j < 64; ++j) {
+                    free(burst[j]);
+                }
+            }
+        });
+    }
+
+    threads.join_all();
+}
+
+}  // namespace
+
+TEST(BlockPoolTest, HandsOutDistinctAlignedBlocks) {
+    BlockPool pool(100, 8, 32);
+    EXPECT_EQ(112u, pool.GetBlockSize());
+
+    std::set<void*> blocks;
+    for (int i = 0; i < 100; ++i) {
+        void* block = pool.Allocate();
+        EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(block) % 16);
+        std::memset(block, 0xab, 100);
+        EXPECT_TRUE(blocks.insert(block).second);
+    }
+
+    EXPECT_EQ(128u, pool.GetCapacity());
+
+    for (void* block : blocks) {
+        pool.Free(block);
+    }
+
+    // the freed blocks serve again before anything new is carved
+    std::set<void*> again;
+    for (int i = 0; i < 100; ++i) {
+        EXPECT_TRUE(again.insert(pool.Allocate()).second);
+    }
+    EXPECT_EQ(128u, pool.GetCapacity());
+}
+
+TEST(BlockPoolTest, TracksTheHighWaterMark) {
+    BlockPool pool(64, 4, 16);
+    std::vector<void*> blocks;
+
+    for (int i = 0; i < 40; ++i) {
+        blocks.push_back(pool.Allocate());
+    }
+
+    // in use is settled when a cache exchanges a batch with the depot
+    EXPECT_GE(pool.GetHighWaterMark(), 36);
+    EXPECT_LE(pool.GetHighWaterMark(), 40);
+
+    for (void* block : blocks) {
+        pool.Free(block);
+    }
+
+    EXPECT_LE(pool.GetInUse(), 8);
+    EXPECT_GE(pool.GetHighWaterMark(), 36);
+    EXPECT_GT(pool.GetDepotExchanges(), 0u);
+}
+
+TEST(BlockPoolTest, ReturnsTheCacheOfAnEndedThread) {
+    BlockPool pool(64, 8, 64);
+    std::vector<void*> blocks;
+
+    boost::thread thread([&] {
+        for (int i = 0; i < 60; ++i) {
+            blocks.push_back(pool.Allocate());
+        }
+        for (void* block : blocks) {
+            pool.Free(block);
+        }
+    });
+    thread.join();
+
+    // the cache of the thread went back to the depot, nothing new gets carved
+    std::set<void*> again;
+    for (int i = 0; i < 64; ++i) {
+        EXPECT_TRUE(again.insert(pool.Allocate()).second);
+    }
+    EXPECT_EQ(64u, pool.GetCapacity());
+}
+
+TEST(BlockPoolTest, FreesFromOtherThreadsFlowBack) {
+    BlockPool pool(64, 16, 256);
+
+    EXPECT_EQ(0u, RunHandoff(4, 100000,
+        [&] { return pool.Allocate(); },
+        [&] (void* block) { pool.Free(block); }));
+
+    // the consumers' caches feed the producers through the depot instead of growing
+    EXPECT_LE(pool.GetCapacity(), 16u * 1024);
+    EXPECT_LE(pool.GetHighWaterMark(), static_cast<int64_t>(pool.GetCapacity()));
+}
+
+TEST(BlockPoolTest, OutlivesItsThreads) {
+    std::unique_ptr<BlockPool> pool(new BlockPool(64));
+    void* block = nullptr;
+
+    boost::thread thread([&] { block = pool->Allocate(); });
+    thread.join();
+
+    pool->Free(block);
+    pool.reset();
+
+    // the next pool doesn't pick up the caches of this one, even at the same address
+    BlockPool other(64);
+    other.Free(other.Allocate());
+}
+
+TEST(BlockPoolTest, DISABLED_BenchmarkContention) {
+    const uint32_t kBlocks = 1000000;
+    const uint32_t counts[] = { 1, 2, 4, 8 };
+
+    for (uint32_t count : counts) {
+        boost::pool<boost::default_user_allocator_malloc_free> locked_pool(1500);
+        boost::recursive_mutex mutex;
+        auto locked_allocate = [&] { boost::recursive_mutex::scoped_lock lock(mutex); return locked_pool.malloc(); };
+        auto locked_free = [&] (void* block) { boost::recursive_mutex::scoped_lock lock(mutex); locked_pool.free(block); };
+
+        BlockPool pool(1500);
+        auto cached_allocate = [&] { return pool.Allocate(); };
+        auto cached_free = [&] (void* block) { pool.Free(block); };
+
+        auto start = std::chrono::steady_clock::now();
+        RunHandoff(count, kBlocks, locked_allocate, locked_free);
+        double locked_handoff = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        start = std::chrono::steady_clock::now();
+        RunHandoff(count, kBlocks, cached_allocate, cached_free);
+        double cached_handoff = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        start = std::chrono::steady_clock::now();
+        RunBursts(count * 2, kBlocks, locked_allocate, locked_free);
+        double locked_bursts = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        start = std::chrono::steady_clock::now();
+        RunBursts(count * 2, kBlocks, cached_allocate, cached_free);
+        double cached_bursts = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::cout << count << " producer / consumer pairs: mutex + boost::pool "
+                  << (count * kBlocks / locked_handoff / 1e6) << "M blocks/s, block pool "
+                  << (count * kBlocks / cached_handoff / 1e6) << "M blocks/s" << std::endl;
+        std::cout << (count * 2) << " threads allocating and freeing bursts: mutex + boost::pool "
+                  << (count * 2 * kBlocks / locked_bursts / 1e6) << "M blocks/s, block pool "
+                  << (count * 2 * kBlocks / cached_bursts / 1e6) << "M blocks/s" << std::endl;
+        std::cout << "  block pool: " << pool.GetCapacity() << " blocks, high water " << pool.GetHighWaterMark()
+                  << ", " << pool.GetDepotExchanges() << " depot exchanges" << std::endl;
+    }
+}
@@ -0,0 +1,102 @@
+// This file is part of SWGANH which is released under the MIT license.
+// See file LICENSE or go to http://swganh.com/LICENSE
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace swganh
+{
+	/**
+		@brief A fixed number of cells in one flat array, every cell a few compact lists.
+
+		An element knows its position in its list through Slots::GetSlot(element) and
+		Slots::SetSlot(element, slot), so it is removed in constant time by moving the last
+		element of the list into its place. The order within a list is not kept.
+
+		Lists is the number of lists per cell, a list mask selects list n with bit n. Not
+		thread safe.
+	*/
+	template<typename T, typename Slots, uint32_t Lists>
+	class FlatGrid
+	{
+	public:
+		explicit FlatGrid(uint32_t cell_count)
+			: cells_(cell_count)
+		{
+		}
+
+		uint32_t GetCellCount() const { return static_cast<uint32_t>(cells_.size()); }
+
+		const std::vector<T>& GetList(uint32_t cell, uint32_t list) const { return cells_[cell].lists[list]; }
+
+		void Insert(uint32_t cell, uint32_t list, T element)
+		{
+			std::vector<T>& elements = cells_[cell].lists[list];
+
+			Slots::SetSlot(element, static_cast<uint32_t>(elements.size()));
+			elements.push_back(element);
+		}
+
+		/**
+			@returns false if the element is not in that list, nothing changes then
+		*/
+		bool Remove(uint32_t cell, uint32_t list, T element)
+		{
+			std::vector<T>& elements = cells_[cell].lists[list];
+			uint32_t slot = Slots::GetSlot(element);
+
+			if (slot >= elements.size() || elements[slot] != element)
+			{
+				return false;
+			}
+
+			elements[slot] = elements.back();
+			Slots::SetSlot(elements[slot], slot);
+			elements.pop_back();
+
+			return true;
+		}
+
+		/**
+			@brief calls visitor with every element of the lists in list_mask
+		*/
+		template<typename Visitor>
+		void Visit(uint32_t cell, uint32_t list_mask, Visitor&& visitor) const
+		{
+			const Cell& visited = cells_[cell];
+
+			for (uint32_t list = 0; list < Lists; ++list)
+			{
+				if (!(list_mask & (1 << list)))
+				{
+					continue;
+				}
+
+				for (const T& element : visited.lists[list])
+				{
+					visitor(element);
+				}
+			}
+		}
+
+		void Clear()
+		{
+			for (Cell& cell : cells_)
+			{
+				for (std::vector<T>& elements : cell.lists)
+				{
+					elements.clear();
+				}
+			}
+		}
+
+	private:
+		struct Cell
+		{
+			std::vector<T> lists[Lists];
+		};
+
+		std::vector<Cell> cells_;
+	};
+}
@@ -0,0 +1,232 @@
+/*
+ This file is part of MMOServer. For more information, visit http://swganh.com
+
+ Copyright (c) 2006 - 2014 The SWG:ANH Team
+
+ MMOServer is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ MMOServer is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with MMOServer.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <iostream>
+#include <list>
+#include <map>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "anh/flat_grid.h"
+
+using swganh::FlatGrid;
+
+namespace {
+
+struct Element {
+    uint64_t id;
+    uint32_t cell;
+    uint32_t slot;
+};
+
+struct ElementSlots {
+    static uint32_t GetSlot(const Element* element) { return element->slot; }
+    static void SetSlot(Element* element, uint32_t slot) { element->slot = slot; }
+};
+
+typedef FlatGrid<Element*, ElementSlots, 3> Grid;
+
+// the zone grid, 411 by 411 cells walked with a row stride of 410
+const uint32_t kGridWidth = 410;
+const uint32_t kCellCount = 411 * 411;
+const uint32_t kViewRange = 3;
+
+// the cell layout the zmap had before, a map of cells holding a list per bucket
+struct ListCell {
+    std::list<Element*> lists[3];
+};
+
+}  // namespace
+
+TEST(FlatGridTest, RemovesBySwappingTheLastElementIn) {
+    Grid grid(16);
+    Element elements[4] = { {1, 5, 0}, {2, 5, 0}, {3, 5, 0}, {4, 5, 0} };
+
+    for (auto& element : elements) {
+        grid.Insert(5, 1, &element);
+    }
+
+    EXPECT_EQ(4u, grid.GetList(5, 1).size());
+    EXPECT_EQ(2u, elements[2].slot);
+
+    ASSERT_TRUE(grid.Remove(5, 1, &elements[1]));
+
+    // the last one took the slot of the removed one
+    EXPECT_EQ(3u, grid.GetList(5, 1).size());
+    EXPECT_EQ(&elements[3], grid.GetList(5, 1)[1]);
+    EXPECT_EQ(1u, elements[3].slot);
+
+    // not in that list, or not there anymore
+    EXPECT_FALSE(grid.Remove(5, 0, &elements[0]));
+    EXPECT_FALSE(grid.Remove(5, 1, &elements[1]));
+    EXPECT_EQ(3u, grid.GetList(5, 1).size());
+
+    ASSERT_TRUE(grid.Remove(5, 1, &elements[3]));
+    ASSERT_TRUE(grid.Remove(5, 1, &elements[0]));
+    ASSERT_TRUE(grid.Remove(5, 1, &elements[2]));
+    EXPECT_TRUE(grid.GetList(5, 1).empty());
+}
+
+TEST(FlatGridTest, VisitsTheListsOfTheMask) {
+    Grid grid(4);
+    Element creature = {1, 2, 0}, object = {2, 2, 0}, player = {3, 2, 0};
+
+    grid.Insert(2, 0, &creature);
+    grid.Insert(2, 1, &object);
+    grid.Insert(2, 2, &player);
+
+    std::vector<uint64_t> visited;
+    auto collect = [&visited] (Element* element) { visited.push_back(element->id); };
+
+    grid.Visit(2, 4, collect);
+    ASSERT_EQ(1u, visited.size());
+    EXPECT_EQ(3u, visited[0]);
+
+    visited.clear();
+    grid.Visit(2, 7, collect);
+    EXPECT_EQ(3u, visited.size());
+
+    visited.clear();
+    grid.Visit(1, 7, collect);
+    EXPECT_TRUE(visited.empty());
+
+    grid.Clear();
+    grid.Visit(2, 7, collect);
+    EXPECT_TRUE(visited.empty());
+}
+
+TEST(FlatGridTest, DISABLED_BenchmarkZoneUpdatesAndRangeQueries) {
+    // every object steps into a neighbouring cell, then as many viewing range queries
+    // of 7 by 7 cells as there are players, one in ten objects is one
+    const uint32_t counts[] = { 5000, 20000, 50000 };
+    const uint32_t kRounds = 20;
+
+    for (uint32_t count : counts) {
+        std::mt19937 random(7);
+
+        // the populated part of a zone, a square of 100 by 100 cells around the middle
+        std::vector<Element> elements(count);
+        for (uint32_t i = 0; i < count; ++i) {
+            uint32_t row = 155 + random() % 100;
+            uint32_t column = 155 + random() % 100;
+            elements[i].id = i + 1;
+            elements[i].cell = row * kGridWidth + column;
+        }
+
+        std::vector<uint32_t> steps(count * kRounds);
+        for (auto& step : steps) {
+            const int32_t moves[] = { 1, -1, static_cast<int32_t>(kGridWidth), -static_cast<int32_t>(kGridWidth) };
+            step = static_cast<uint32_t>(moves[random() % 4]);
+        }
+
+        uint64_t checksum = 0;
+        std::vector<uint32_t> cells(count);
+
+        // the map of lists, a list of the range gathered by copying and splicing every cell
+        std::map<uint32_t, std::unique_ptr<ListCell>> list_cells;
+        for (uint32_t cell = 0; cell < kCellCount; ++cell) {
+            list_cells[cell].reset(new ListCell);
+        }
+
+        for (uint32_t i = 0; i < count; ++i) {
+            cells[i] = elements[i].cell;
+            list_cells[cells[i]]->lists[i % 3].push_back(&elements[i]);
+        }
+
+        double list_updates = 0, list_queries = 0;
+        for (uint32_t round = 0; round < kRounds; ++round) {
+            auto start = std::chrono::steady_clock::now();
+            for (uint32_t i = 0; i < count; ++i) {
+                auto& old_list = list_cells.find(cells[i])->second->lists[i % 3];
+                for (auto it = old_list.begin(); it != old_list.end(); ++it) {
+                    if ((*it)->id == elements[i].id) {
+                        old_list.erase(it);
+                        break;
+                    }
+                }
+
+                cells[i] += steps[round * count + i];
+                list_cells.find(cells[i])->second->lists[i % 3].push_back(&elements[i]);
+            }
+            auto updated = std::chrono::steady_clock::now();
+
+            for (uint32_t i = 0; i < count; i += 10) {
+                std::list<Element*> in_range;
+                for (int32_t row = -int32_t(kViewRange); row <= int32_t(kViewRange); ++row) {
+                    for (int32_t column = -int32_t(kViewRange); column <= int32_t(kViewRange); ++column) {
+                        auto& cell = *list_cells.find(cells[i] + row * kGridWidth + column)->second;
+                        for (auto& list : cell.lists) {
+                            std::list<Element*> copy = list;
+                            in_range.splice(in_range.begin(), copy);
+                        }
+                    }
+                }
+                checksum += in_range.size();
+            }
+
+            list_updates += std::chrono::duration<double>(updated - start).count();
+            list_queries += std::chrono::duration<double>(std::chrono::steady_clock::now() - updated).count();
+        }
+
+        // the flat grid, the range visited in place
+        Grid grid(kCellCount);
+        for (uint32_t i = 0; i < count; ++i) {
+            cells[i] = elements[i].cell;
+            grid.Insert(cells[i], i % 3, &elements[i]);
+        }
+
+        double flat_updates = 0, flat_queries = 0;
+        for (uint32_t round = 0; round < kRounds; ++round) {
+            auto start = std::chrono::steady_clock::now();
+            for (uint32_t i = 0; i < count; ++i) {
+                grid.Remove(cells[i], i % 3, &elements[i]);
+                cells[i] += steps[round * count + i];
+                grid.Insert(cells[i], i % 3, &elements[i]);
+            }
+            auto updated = std::chrono::steady_clock::now();
+
+            for (uint32_t i = 0; i < count; i += 10) {
+                uint64_t in_range = 0;
+                for (int32_t row = -int32_t(kViewRange); row <= int32_t(kViewRange); ++row) {
+                    for (int32_t column = -int32_t(kViewRange); column <= int32_t(kViewRange); ++column) {
+                        grid.Visit(cells[i] + row * kGridWidth + column, 7, [&in_range] (Element*) { ++in_range; });
+                    }
+                }
+                checksum -= in_range;
+            }
+
+            flat_updates += std::chrono::duration<double>(updated - start).count();
+            flat_queries += std::chrono::duration<double>(std::chrono::steady_clock::now() - updated).count();
+        }
+
+        uint64_t updates = static_cast<uint64_t>(count) * kRounds;
+        uint64_t queries = updates / 10;
+
+        std::cout << count << " objects: map of lists " << (updates / list_updates / 1e6) << "M updates/s, "
+                  << (queries / list_queries / 1e3) << "k queries/s; flat grid " << (updates / flat_updates / 1e6)
+                  << "M updates/s, " << (queries / flat_queries / 1e3) << "k queries/s" << std::endl;
+
+        // both saw the same objects in range
+        EXPECT_EQ(0u, checksum);
+    }
+}
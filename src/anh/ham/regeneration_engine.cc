@@ -0,0 +1,164 @@
+// This file is part of SWGANH which is released under the MIT license.
+// See file LICENSE or go to http://swganh.com/LICENSE
+
+#include "regeneration_engine.h"
+
+#include <algorithm>
+
+using namespace swganh::ham;
+
+RegenerationEngine::RegenerationEngine()
+{
+}
+
+uint32_t RegenerationEngine::Add(uint64_t id, bool player)
+{
+	auto find_itr = slots_.find(id);
+	if (find_itr != slots_.end())
+	{
+		return find_itr->second;
+	}
+
+	uint32_t slot = Size();
+	slots_.insert(std::make_pair(id, slot));
+
+	ids_.push_back(id);
+	players_.push_back(player ? 1 : 0);
+	posture_modifiers_.push_back(1.0f);
+	revisions_.push_back(0);
+	changed_bars_.push_back(0);
+
+	for (uint16_t bar = 0; bar < kBarCount; ++bar)
+	{
+		current_[bar].push_back(0);
+		limits_[bar].push_back(0);
+		regenerated_[bar].push_back(0);
+	}
+
+	return slot;
+}
+
+void RegenerationEngine::Remove(uint32_t slot)
+{
+	uint32_t last = Size() - 1;
+
+	slots_.erase(ids_[slot]);
+
+	if (slot != last)
+	{
+		ids_[slot] = ids_[last];
+		players_[slot] = players_[last];
+		posture_modifiers_[slot] = posture_modifiers_[last];
+		revisions_[slot] = revisions_[last];
+		changed_bars_[slot] = changed_bars_[last];
+
+		for (uint16_t bar = 0; bar < kBarCount; ++bar)
+		{
+			current_[bar][slot] = current_[bar][last];
+			limits_[bar][slot] = limits_[bar][last];
+			regenerated_[bar][slot] = regenerated_[bar][last];
+		}
+
+		slots_[ids_[slot]] = slot;
+	}
+
+	ids_.pop_back();
+	players_.pop_back();
+	posture_modifiers_.pop_back();
+	revisions_.pop_back();
+	changed_bars_.pop_back();
+
+	for (uint16_t bar = 0; bar < kBarCount; ++bar)
+	{
+		current_[bar].pop_back();
+		limits_[bar].pop_back();
+		regenerated_[bar].pop_back();
+	}
+}
+
+bool RegenerationEngine::Find(uint64_t id, uint32_t& slot) const
+{
+	auto find_itr = slots_.find(id);
+	if (find_itr == slots_.end())
+	{
+		return false;
+	}
+
+	slot = find_itr->second;
+	return true;
+}
+
+void RegenerationEngine::Clear()
+{
+	slots_.clear();
+
+	ids_.clear();
+	players_.clear();
+	posture_modifiers_.clear();
+	revisions_.clear();
+	changed_bars_.clear();
+
+	for (uint16_t bar = 0; bar < kBarCount; ++bar)
+	{
+		current_[bar].clear();
+		limits_[bar].clear();
+		regenerated_[bar].clear();
+	}
+}
+
+uint32_t RegenerationEngine::Regenerate()
+{
+	uint32_t count = Size();
+
+	std::fill(changed_bars_.begin(), changed_bars_.end(), 0);
+
+	const uint8_t* players = players_.data();
+	const float* modifiers = posture_modifiers_.data();
+	uint16_t* changed = changed_bars_.data();
+
+	for (uint16_t bar = 0; bar < kBarCount; ++bar)
+	{
+		// the last bar of a pool drives its regeneration, it is updated after the
+		// other two so all of them see the value from before the tick
+		const int32_t* source = current_[(bar / kBarsPerPool) * kBarsPerPool + kBarsPerPool - 1].data();
+
+		int32_t* current = current_[bar].data();
+		const int32_t* limits = limits_[bar].data();
+		int32_t* regenerated = regenerated_[bar].data();
+		uint16_t bar_mask = static_cast<uint16_t>(1 << bar);
+
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			int32_t amount = static_cast<int32_t>((source[i] / kDivider) * modifiers[i]);
+			amount = players[i] ? amount : (amount / 10) + 1;
+
+			// never beyond the limit and never down to it, if a bar already exceeds it
+			amount = std::max(0, std::min(amount, limits[i] - current[i]));
+
+			current[i] += amount;
+			regenerated[i] = amount;
+			changed[i] |= (amount != 0) ? bar_mask : 0;
+		}
+	}
+
+	uint32_t changed_count = 0;
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		changed_count += (changed[i] != 0) ? 1 : 0;
+	}
+
+	return changed_count;
+}
+
+bool RegenerationEngine::IsRegenerating(uint32_t slot) const
+{
+	for (uint16_t bar = 0; bar < kBarCount; ++bar)
+	{
+		if (current_[bar][slot] < limits_[bar][slot])
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
@@ -0,0 +1,107 @@
+// This file is part of SWGANH which is released under the MIT license.
+// See file LICENSE or go to http://swganh.com/LICENSE
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace swganh
+{
+namespace ham
+{
+	/**
+		@brief Regenerates the ham bars of many creatures at once.
+
+		The engine keeps a copy of the bars of every regenerating creature in structure of
+		arrays form: one contiguous array per bar for the current hitpoints and for the
+		limit they regenerate to (max hitpoints minus wounds and encumbrance). A tick is a
+		single pass over each array that the compiler can vectorize, afterwards the owner
+		writes back the bars reported by GetChangedBars only.
+
+		The bars of a pool (health, strength, constitution etc.) regenerate by the current
+		value of the last bar of that pool / 50, scaled by the posture modifier. Non player
+		creatures regenerate a tenth of that plus one.
+
+		The engine knows nothing about the creatures themselves, the revision is a free
+		stamp for the owner to tell whether its copy of a creature is still up to date.
+	*/
+	class RegenerationEngine
+	{
+	public:
+		static const uint16_t kBarCount = 9;
+		static const uint16_t kBarsPerPool = 3;
+		static const int32_t kDivider = 50;
+
+		RegenerationEngine();
+
+		/**
+			@brief adds a creature and returns its slot. A creature that is already
+			regenerating keeps its slot. The bars start out at 0 and need to be set.
+		*/
+		uint32_t Add(uint64_t id, bool player);
+
+		/**
+			@brief removes the creature in the given slot, the creature of the last
+			slot moves into it.
+		*/
+		void Remove(uint32_t slot);
+
+		bool Find(uint64_t id, uint32_t& slot) const;
+
+		void Clear();
+
+		uint32_t Size() const { return static_cast<uint32_t>(ids_.size()); }
+
+		uint64_t GetId(uint32_t slot) const { return ids_[slot]; }
+
+		void SetPostureModifier(uint32_t slot, float modifier) { posture_modifiers_[slot] = modifier; }
+
+		void SetBar(uint32_t slot, uint16_t bar, int32_t current, int32_t limit)
+		{
+			current_[bar][slot] = current;
+			limits_[bar][slot] = limit;
+		}
+
+		int32_t GetCurrent(uint32_t slot, uint16_t bar) const { return current_[bar][slot]; }
+
+		/**
+			@brief the hitpoints the last tick added to the bar, GetCurrent minus this is
+			the value the bar had before.
+		*/
+		int32_t GetRegenerated(uint32_t slot, uint16_t bar) const { return regenerated_[bar][slot]; }
+
+		uint32_t GetRevision(uint32_t slot) const { return revisions_[slot]; }
+		void SetRevision(uint32_t slot, uint32_t revision) { revisions_[slot] = revision; }
+
+		/**
+			@brief regenerates all creatures by one tick.
+			@returns the number of creatures which had at least one bar changed
+		*/
+		uint32_t Regenerate();
+
+		/**
+			@brief bitmask (1 << bar) of the bars the last tick changed
+		*/
+		uint16_t GetChangedBars(uint32_t slot) const { return changed_bars_[slot]; }
+
+		/**
+			@brief whether any bar of the creature is still below its limit
+		*/
+		bool IsRegenerating(uint32_t slot) const;
+
+	private:
+		std::unordered_map<uint64_t, uint32_t> slots_;
+
+		std::vector<uint64_t> ids_;
+		std::vector<uint8_t> players_;
+		std::vector<float> posture_modifiers_;
+		std::vector<uint32_t> revisions_;
+		std::vector<uint16_t> changed_bars_;
+
+		std::vector<int32_t> current_[kBarCount];
+		std::vector<int32_t> limits_[kBarCount];
+		std::vector<int32_t> regenerated_[kBarCount];
+	};
+}
+}
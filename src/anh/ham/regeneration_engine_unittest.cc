@@ -0,0 +1,248 @@
+/*
+ This file is part of MMOServer. For more information, visit http://swganh.com
+
+ Copyright (c) 2006 - 2014 The SWG:ANH Team
+
+ MMOServer is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ MMOServer is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with MMOServer.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <vector>
+
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include "anh/ham/regeneration_engine.h"
+
+using swganh::ham::RegenerationEngine;
+
+namespace {
+
+const uint16_t kHealth = 0;
+const uint16_t kStrength = 1;
+const uint16_t kConstitution = 2;
+const uint16_t kAction = 3;
+
+// sets every bar of the slot to current out of limit
+void SetAllBars(RegenerationEngine& engine, uint32_t slot, int32_t current, int32_t limit) {
+    for (uint16_t bar = 0; bar < RegenerationEngine::kBarCount; ++bar) {
+        engine.SetBar(slot, bar, current, limit);
+    }
+}
+
+TEST(RegenerationEngineTest, PlayersRegenerateByTheLastBarOfThePool) {
+    RegenerationEngine engine;
+    uint32_t slot = engine.Add(1, true);
+
+    SetAllBars(engine, slot, 1000, 1000);
+    engine.SetBar(slot, kHealth, 100, 1000);
+    engine.SetBar(slot, kConstitution, 500, 1000);
+
+    EXPECT_EQ(1u, engine.Regenerate());
+
+    // 500 constitution / 50
+    EXPECT_EQ(110, engine.GetCurrent(slot, kHealth));
+    EXPECT_EQ(10, engine.GetRegenerated(slot, kHealth));
+    EXPECT_EQ(510, engine.GetCurrent(slot, kConstitution));
+}
+
+TEST(RegenerationEngineTest, NpcsRegenerateATenthPlusOne) {
+    RegenerationEngine engine;
+    uint32_t slot = engine.Add(1, false);
+
+    SetAllBars(engine, slot, 1000, 1000);
+    engine.SetBar(slot, kHealth, 100, 1000);
+    engine.SetBar(slot, kConstitution, 5000, 5000);
+
+    engine.Regenerate();
+
+    EXPECT_EQ(111, engine.GetCurrent(slot, kHealth));
+}
+
+TEST(RegenerationEngineTest, AppliesThePostureModifier) {
+    RegenerationEngine engine;
+    uint32_t sitting = engine.Add(1, true);
+    uint32_t dead = engine.Add(2, true);
+
+    SetAllBars(engine, sitting, 1000, 1000);
+    SetAllBars(engine, dead, 1000, 1000);
+    engine.SetBar(sitting, kHealth, 100, 1000);
+    engine.SetBar(dead, kHealth, 100, 1000);
+
+    engine.SetPostureModifier(sitting, 1.75f);
+    engine.SetPostureModifier(dead, 0.0f);
+
+    EXPECT_EQ(1u, engine.Regenerate());
+
+    EXPECT_EQ(135, engine.GetCurrent(sitting, kHealth));
+    EXPECT_EQ(100, engine.GetCurrent(dead, kHealth));
+}
+
+TEST(RegenerationEngineTest, StopsAtTheLimit) {
+    RegenerationEngine engine;
+    uint32_t slot = engine.Add(1, true);
+
+    SetAllBars(engine, slot, 1000, 1000);
+    engine.SetBar(slot, kAction, 995, 1000);
+    // wounded beyond the current value, must not be lowered
+    engine.SetBar(slot, kStrength, 900, 800);
+
+    EXPECT_TRUE(engine.IsRegenerating(slot));
+
+    engine.Regenerate();
+
+    EXPECT_EQ(1000, engine.GetCurrent(slot, kAction));
+    EXPECT_EQ(900, engine.GetCurrent(slot, kStrength));
+    EXPECT_FALSE(engine.IsRegenerating(slot));
+
+    EXPECT_EQ(0u, engine.Regenerate());
+}
+
+TEST(RegenerationEngineTest, ReportsOnlyChangedBars) {
+    RegenerationEngine engine;
+    uint32_t slot = engine.Add(1, true);
+
+    SetAllBars(engine, slot, 1000, 1000);
+    engine.SetBar(slot, kHealth, 10, 1000);
+    engine.SetBar(slot, kAction, 10, 1000);
+
+    engine.Regenerate();
+
+    EXPECT_EQ((1 << kHealth) | (1 << kAction), engine.GetChangedBars(slot));
+}
+
+TEST(RegenerationEngineTest, RemoveMovesTheLastCreature) {
+    RegenerationEngine engine;
+    engine.Add(1, true);
+    engine.Add(2, true);
+    uint32_t last = engine.Add(3, true);
+
+    engine.SetBar(last, kHealth, 42, 100);
+
+    // adding twice keeps the slot
+    EXPECT_EQ(last, engine.Add(3, true));
+
+    engine.Remove(0);
+
+    uint32_t slot = 0;
+    EXPECT_EQ(2u, engine.Size());
+    EXPECT_FALSE(engine.Find(1, slot));
+    ASSERT_TRUE(engine.Find(3, slot));
+    EXPECT_EQ(0u, slot);
+    EXPECT_EQ(3u, engine.GetId(slot));
+    EXPECT_EQ(42, engine.GetCurrent(slot, kHealth));
+}
+
+/// The former HamService tick: a map walk with a locked accessor call per
+/// stat and a separate update per bar.
+struct MappedCreature {
+    boost::mutex mutex;
+    bool player;
+    float modifier;
+    std::vector<int32_t> current;
+    std::vector<int32_t> limit;
+
+    int32_t GetCurrent(uint16_t bar) {
+        boost::lock_guard<boost::mutex> lock(mutex);
+        return current[bar];
+    }
+
+    int32_t GetLimit(uint16_t bar) {
+        boost::lock_guard<boost::mutex> lock(mutex);
+        return limit[bar];
+    }
+
+    void SetCurrent(uint16_t bar, int32_t value) {
+        boost::lock_guard<boost::mutex> lock(mutex);
+        current[bar] = value;
+    }
+};
+
+bool RegenerateMapped(MappedCreature& creature) {
+    bool done = true;
+
+    for (uint16_t bar = 0; bar < RegenerationEngine::kBarCount; ++bar) {
+        int32_t limit = creature.GetLimit(bar);
+        int32_t current = creature.GetCurrent(bar);
+
+        if (current < limit) {
+            int32_t amount = static_cast<int32_t>((creature.GetCurrent((bar / 3) * 3 + 2) / 50) * creature.modifier);
+            amount = creature.player ? amount : (amount / 10) + 1;
+
+            current = std::min(current + amount, limit);
+            creature.SetCurrent(bar, current);
+
+            if (current < limit) {
+                done = false;
+            }
+        }
+    }
+
+    return done;
+}
+
+/// Run with --gtest_also_run_disabled_tests.
+TEST(RegenerationEngineTest, DISABLED_BenchmarkAgainstMappedCreatures) {
+    namespace pt = boost::posix_time;
+
+    const uint32_t ticks = 20;
+    const uint32_t counts[] = { 10000, 100000 };
+
+    for (uint32_t count : counts) {
+        // deep enough that nobody is fully healed within the measured ticks
+        std::map<uint64_t, MappedCreature> mapped;
+        RegenerationEngine engine;
+
+        for (uint32_t i = 0; i < count; ++i) {
+            bool player = (i % 10) == 0;
+
+            MappedCreature& creature = mapped[i];
+            creature.player = player;
+            creature.modifier = 1.0f;
+            creature.current.assign(RegenerationEngine::kBarCount, 1000 + (i % 500));
+            creature.limit.assign(RegenerationEngine::kBarCount, 100000);
+
+            uint32_t slot = engine.Add(i, player);
+            SetAllBars(engine, slot, 1000 + (i % 500), 100000);
+        }
+
+        pt::ptime start = pt::microsec_clock::universal_time();
+        for (uint32_t tick = 0; tick < ticks; ++tick) {
+            for (auto& entry : mapped) {
+                RegenerateMapped(entry.second);
+            }
+        }
+        pt::time_duration mapped_time = pt::microsec_clock::universal_time() - start;
+
+        start = pt::microsec_clock::universal_time();
+        for (uint32_t tick = 0; tick < ticks; ++tick) {
+            engine.Regenerate();
+        }
+        pt::time_duration engine_time = pt::microsec_clock::universal_time() - start;
+
+        // both have to arrive at the same values
+        EXPECT_EQ(mapped[count - 1].current[kHealth], engine.GetCurrent(count - 1, kHealth));
+
+        std::cout << count << " creatures, " << ticks << " ticks:" << std::endl
+                  << "  mapped creatures    " << mapped_time.total_microseconds() / ticks << " us/tick" << std::endl
+                  << "  regeneration engine " << engine_time.total_microseconds() / ticks << " us/tick" << std::endl;
+    }
+}
+
+}  // namespace
@@ -0,0 +1,172 @@
+// This file is part of SWGANH which is released under the MIT license.
+// See file LICENSE or go to http://swganh.com/LICENSE
+
+#include "congestion_control.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace swganh::network;
+
+namespace {
+	// how far the smoothed round trip may exceed the fastest one, on top of a quarter of
+	// it, before we call it a queue
+	const uint64_t kQueueingSlack = 10;
+
+	const uint64_t kMinReorderWindow = 5;
+
+	// past slow start the window grows by a packet per this many acks at most, so it
+	// recovers from random loss in a number of round trips independent of its size
+	const uint32_t kAcksPerIncrease = 16;
+
+	// losing more than an eighth of the window, and more than a handful of packets, in a
+	// round trip is congestion, queue or not
+	const uint32_t kHeavyLossFraction = 8;
+	const uint32_t kHeavyLossMin = 4;
+}
+
+const uint64_t CongestionControl::kNoRtt;
+const uint64_t CongestionControl::kInitialTimeout;
+const uint64_t CongestionControl::kMinTimeout;
+const uint64_t CongestionControl::kMaxTimeout;
+
+CongestionControl::CongestionControl(uint32_t min_window, uint32_t max_window, uint32_t initial_window)
+	: min_window_(std::max<uint32_t>(min_window, 1))
+	, max_window_(std::max(max_window, min_window_))
+	, window_(std::min(std::max(initial_window, min_window_), max_window_))
+	, slow_start_threshold_(max_window_)
+	, growth_(0)
+	, has_rtt_(false)
+	, smoothed_rtt_(0.0)
+	, rtt_variance_(0.0)
+	, min_rtt_(kNoRtt)
+	, timeout_(kInitialTimeout)
+	, recovery_until_(0)
+	, round_end_(0)
+	, round_lost_(0)
+{
+}
+
+void CongestionControl::SetMaxWindow(uint32_t max_window)
+{
+	max_window_ = std::max(max_window, min_window_);
+	window_ = std::min(window_, max_window_);
+	slow_start_threshold_ = std::min(slow_start_threshold_, max_window_);
+}
+
+void CongestionControl::OnAck(uint32_t acknowledged, uint64_t rtt)
+{
+	if (rtt != kNoRtt)
+	{
+		UpdateRtt_(rtt);
+	}
+
+	if (window_ < slow_start_threshold_)
+	{
+		window_ = std::min(window_ + acknowledged, slow_start_threshold_);
+	}
+	else if (!IsQueueing())
+	{
+		uint32_t acks_per_increase = std::min(window_, kAcksPerIncrease);
+		growth_ += acknowledged;
+
+		while (growth_ >= acks_per_increase)
+		{
+			growth_ -= acks_per_increase;
+			++window_;
+		}
+	}
+
+	window_ = std::min(window_, max_window_);
+}
+
+void CongestionControl::OnLoss(uint32_t lost, uint64_t now)
+{
+	if (now >= round_end_)
+	{
+		round_end_ = now + GetRoundTrip_();
+		round_lost_ = 0;
+	}
+
+	round_lost_ += lost;
+
+	// the acks of the round trip the loss happened in dont count twice
+	if (now < recovery_until_)
+	{
+		return;
+	}
+
+	// a few losses without a queue behind them are the link dropping packets rather than
+	// us overloading it
+	if (!IsQueueing() && (round_lost_ * kHeavyLossFraction <= window_ || round_lost_ <= kHeavyLossMin))
+	{
+		slow_start_threshold_ = std::min(slow_start_threshold_, window_);
+		return;
+	}
+
+	slow_start_threshold_ = std::max(window_ / 2, min_window_);
+	window_ = slow_start_threshold_;
+	growth_ = 0;
+
+	recovery_until_ = now + GetRoundTrip_();
+}
+
+void CongestionControl::OnTimeout(uint64_t now)
+{
+	if (now >= recovery_until_)
+	{
+		slow_start_threshold_ = std::max(window_ / 2, min_window_);
+	}
+
+	window_ = min_window_;
+	growth_ = 0;
+
+	timeout_ = std::min(timeout_ * 2, kMaxTimeout);
+	recovery_until_ = now + timeout_;
+}
+
+uint64_t CongestionControl::GetLossTimeout() const
+{
+	if (!has_rtt_)
+	{
+		return timeout_;
+	}
+
+	// a quarter of the fastest round trip of reordering is tolerated before calling it a loss
+	return static_cast<uint64_t>(smoothed_rtt_) + std::max<uint64_t>(min_rtt_ / 4, kMinReorderWindow);
+}
+
+uint64_t CongestionControl::GetRoundTrip_() const
+{
+	return has_rtt_ ? std::max<uint64_t>(GetSmoothedRtt(), 1) : timeout_;
+}
+
+bool CongestionControl::IsQueueing() const
+{
+	return has_rtt_ && smoothed_rtt_ > static_cast<double>(min_rtt_ + min_rtt_ / 4 + kQueueingSlack);
+}
+
+void CongestionControl::UpdateRtt_(uint64_t rtt)
+{
+	double sample = static_cast<double>(rtt);
+
+	if (!has_rtt_)
+	{
+		smoothed_rtt_ = sample;
+		rtt_variance_ = sample / 2.0;
+		has_rtt_ = true;
+	}
+	else
+	{
+		rtt_variance_ = 0.75 * rtt_variance_ + 0.25 * std::fabs(smoothed_rtt_ - sample);
+		smoothed_rtt_ = 0.875 * smoothed_rtt_ + 0.125 * sample;
+	}
+
+	min_rtt_ = std::min(min_rtt_, rtt);
+
+	// a steady path leaves next to no variance, keep the timeout clear of the loss timeout so
+	// gaps get repaired by their selective acks before the whole window is declared lost
+	double variance = std::max(4.0 * rtt_variance_, std::max(static_cast<double>(min_rtt_) / 2.0, 10.0));
+	uint64_t timeout = static_cast<uint64_t>(smoothed_rtt_ + variance);
+	timeout_ = std::min(std::max(timeout, kMinTimeout), kMaxTimeout);
+}
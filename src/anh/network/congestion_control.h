@@ -0,0 +1,102 @@
+// This file is part of SWGANH which is released under the MIT license.
+// See file LICENSE or go to http://swganh.com/LICENSE
+#pragma once
+
+#include <cstdint>
+
+namespace swganh
+{
+namespace network
+{
+	/**
+		@brief Sizes the send window of a reliable channel from its measured round trips.
+
+		The round trip estimate and the retransmission timeout follow RFC 6298. The window
+		opens in slow start until the first loss and then grows by a packet per 16 acks, or
+		per window for small windows. While the smoothed round trip runs well above the
+		fastest one seen packets are queueing up on the path and the window stops growing.
+		Losses halve it, at most once per round trip, if there is such a queue or they add
+		up to more than an eighth of the window. Anything less is taken for the link dropping
+		packets rather than congestion and only ends slow start. A retransmission timeout
+		drops the window to the minimum and backs the timeout off.
+
+		All times are milliseconds. Not thread safe.
+	*/
+	class CongestionControl
+	{
+	public:
+		static const uint64_t kNoRtt = ~static_cast<uint64_t>(0);
+
+		static const uint64_t kInitialTimeout = 700;
+		static const uint64_t kMinTimeout = 100;
+		static const uint64_t kMaxTimeout = 4000;
+
+		CongestionControl(uint32_t min_window, uint32_t max_window, uint32_t initial_window);
+
+		/**
+			@brief the configured window of the session, the current window is clamped to it
+		*/
+		void SetMaxWindow(uint32_t max_window);
+
+		/**
+			@param acknowledged the number of packets the ack released
+			@param rtt the round trip of the acked packet or kNoRtt
+		*/
+		void OnAck(uint32_t acknowledged, uint64_t rtt);
+
+		/**
+			@brief packets behind a reported gap in the sequence had to be resent
+		*/
+		void OnLoss(uint32_t lost, uint64_t now);
+
+		/**
+			@brief packets had to be resent because their acks didn't arrive in time
+		*/
+		void OnTimeout(uint64_t now);
+
+		/**
+			@brief the number of packets that may be in flight
+		*/
+		uint32_t GetWindow() const { return window_; }
+		uint32_t GetSlowStartThreshold() const { return slow_start_threshold_; }
+
+		uint64_t GetRetransmitTimeout() const { return timeout_; }
+
+		/**
+			@brief how long after its send a packet behind a selectively acknowledged one
+			counts as lost rather than reordered
+		*/
+		uint64_t GetLossTimeout() const;
+
+		uint64_t GetSmoothedRtt() const { return static_cast<uint64_t>(smoothed_rtt_); }
+		uint64_t GetMinRtt() const { return min_rtt_; }
+
+		/**
+			@brief whether the round trips point at a queue building up on the path
+		*/
+		bool IsQueueing() const;
+
+	private:
+		void UpdateRtt_(uint64_t rtt);
+		uint64_t GetRoundTrip_() const;
+
+		uint32_t min_window_;
+		uint32_t max_window_;
+		uint32_t window_;
+		uint32_t slow_start_threshold_;
+		uint32_t growth_;
+
+		bool has_rtt_;
+		double smoothed_rtt_;
+		double rtt_variance_;
+		uint64_t min_rtt_;
+		uint64_t timeout_;
+
+		uint64_t recovery_until_;
+
+		// the losses of the current round trip
+		uint64_t round_end_;
+		uint32_t round_lost_;
+	};
+}
+}
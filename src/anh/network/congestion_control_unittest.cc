@@ -0,0 +1,363 @@
+/*
+ This file is part of MMOServer. For more information, visit http://swganh.com
+
+ Copyright (c) 2006 - 2014 The SWG:ANH Team
+
+ MMOServer is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ MMOServer is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with MMOServer.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <random>
+#include <set>
+#include <vector>
+
+#include "anh/network/congestion_control.h"
+#include "anh/network/reliable_window.h"
+
+using swganh::network::CongestionControl;
+using swganh::network::ReliableWindow;
+using swganh::network::SequenceBefore;
+
+TEST(CongestionControlTest, SlowStartsUpToTheMaximum) {
+    CongestionControl control(4, 100, 10);
+    EXPECT_EQ(10u, control.GetWindow());
+
+    control.OnAck(10, 50);
+    EXPECT_EQ(20u, control.GetWindow());
+
+    control.OnAck(200, 50);
+    EXPECT_EQ(100u, control.GetWindow());
+}
+
+TEST(CongestionControlTest, HalvesOncePerRoundTripOnHeavyLoss) {
+    CongestionControl control(4, 100, 64);
+    control.OnAck(1, 50);
+
+    control.OnLoss(16, 1000);
+    EXPECT_EQ(32u, control.GetWindow());
+
+    // same round trip
+    control.OnLoss(16, 1020);
+    EXPECT_EQ(32u, control.GetWindow());
+
+    control.OnLoss(16, 1100);
+    EXPECT_EQ(16u, control.GetWindow());
+
+    // past slow start as many acks as the window, up to 16, add a single packet
+    control.OnAck(16, 50);
+    EXPECT_EQ(17u, control.GetWindow());
+}
+
+TEST(CongestionControlTest, OnlyLeavesSlowStartOnRandomLoss) {
+    CongestionControl control(4, 100, 64);
+    control.OnAck(1, 50);
+
+    uint32_t window = control.GetWindow();
+
+    control.OnLoss(4, 1000);
+    EXPECT_EQ(window, control.GetWindow());
+    EXPECT_EQ(window, control.GetSlowStartThreshold());
+
+    // 16 acks per packet from here on
+    control.OnAck(32, 50);
+    EXPECT_EQ(window + 2, control.GetWindow());
+}
+
+TEST(CongestionControlTest, TimeoutDropsToTheMinimumAndBacksOff) {
+    CongestionControl control(4, 100, 64);
+    uint64_t timeout = control.GetRetransmitTimeout();
+
+    control.OnTimeout(0);
+
+    EXPECT_EQ(4u, control.GetWindow());
+    EXPECT_EQ(32u, control.GetSlowStartThreshold());
+    EXPECT_EQ(timeout * 2, control.GetRetransmitTimeout());
+}
+
+TEST(CongestionControlTest, EstimatesTheRetransmitTimeoutFromRoundTrips) {
+    CongestionControl control(4, 100, 10);
+    EXPECT_EQ(CongestionControl::kInitialTimeout, control.GetRetransmitTimeout());
+
+    for (uint32_t i = 0; i < 50; ++i) {
+        control.OnAck(1, 200);
+    }
+
+    EXPECT_EQ(200u, control.GetSmoothedRtt());
+    EXPECT_EQ(200u, control.GetMinRtt());
+
+    // a steady path keeps half a round trip of margin
+    EXPECT_EQ(300u, control.GetRetransmitTimeout());
+    // and a quarter of one for reordering
+    EXPECT_EQ(250u, control.GetLossTimeout());
+}
+
+TEST(CongestionControlTest, StopsGrowingWhileAQueueBuildsUp) {
+    CongestionControl control(4, 1000, 20);
+    control.OnAck(1, 20);
+    control.OnLoss(1, 100);
+
+    // round trips climbing far above the fastest one
+    while (!control.IsQueueing()) {
+        control.OnAck(1, 300);
+    }
+
+    uint32_t window = control.GetWindow();
+
+    for (uint32_t i = 0; i < 30; ++i) {
+        control.OnAck(window, 300);
+    }
+
+    EXPECT_EQ(window, control.GetWindow());
+}
+
+namespace {
+
+/// A one way link with a bottleneck, a drop tail queue, latency, jitter and random loss.
+class SimulatedLink {
+public:
+    struct Config {
+        uint64_t delay;
+        uint64_t jitter;
+        double loss;
+        // packets the bottleneck lets through per millisecond, 0 for unlimited
+        uint32_t rate;
+        // packets the bottleneck queues before it drops
+        uint32_t queue;
+    };
+
+    SimulatedLink(const Config& config, uint32_t seed)
+        : config_(config)
+        , random_(seed)
+        , next_departure_(0) {}
+
+    void Send(uint64_t now, uint32_t value) {
+        if (std::uniform_real_distribution<double>(0.0, 1.0)(random_) < config_.loss) {
+            return;
+        }
+
+        uint64_t departure = now;
+
+        if (config_.rate) {
+            // a thousandth of a millisecond resolution for the bottleneck
+            uint64_t start = std::max(now * 1000, next_departure_);
+
+            if ((start - now * 1000) * config_.rate / 1000 > config_.queue) {
+                return;
+            }
+
+            next_departure_ = start + 1000 / config_.rate;
+            departure = next_departure_ / 1000;
+        }
+
+        uint64_t jitter = config_.jitter ? std::uniform_int_distribution<uint64_t>(0, config_.jitter)(random_) : 0;
+        in_flight_.insert(std::make_pair(departure + config_.delay + jitter, value));
+    }
+
+    void Deliver(uint64_t now, std::vector<uint32_t>& values) {
+        values.clear();
+
+        while (!in_flight_.empty() && in_flight_.begin()->first <= now) {
+            values.push_back(in_flight_.begin()->second);
+            in_flight_.erase(in_flight_.begin());
+        }
+    }
+
+private:
+    Config config_;
+    std::mt19937 random_;
+    uint64_t next_departure_;
+    std::multimap<uint64_t, uint32_t> in_flight_;
+};
+
+struct SimulationResult {
+    bool complete;
+    bool in_order;
+    uint64_t duration;
+    uint32_t sent;
+    uint32_t resent;
+    uint32_t final_window;
+    uint64_t smoothed_rtt;
+};
+
+const uint32_t kAckFlag = 0x10000;
+const uint32_t kOrderFlag = 0x20000;
+
+/// Pushes count packets over a lossy link the way a session does: in sequence through
+/// the reliable window as far as the congestion window allows, cumulative acks from the
+/// remote side, an out of order notice for every packet arriving ahead of a gap and
+/// resends of what was lost or timed out.
+SimulationResult Simulate(const SimulatedLink::Config& link, uint32_t count, uint16_t first_sequence, uint32_t max_window) {
+    SimulatedLink data_link(link, 1), ack_link(link, 2);
+
+    ReliableWindow<uint32_t> window(first_sequence);
+    CongestionControl control(4, max_window, 16);
+
+    SimulationResult result = { false, true, 0, 0, 0, 0, 0 };
+
+    uint32_t queued = 0;
+    uint32_t delivered = 0;
+    uint16_t expected = first_sequence;
+    std::set<uint16_t> ahead;
+
+    std::vector<uint32_t> arrived;
+    uint32_t message = 0;
+
+    uint64_t now = 0;
+    auto resend = [&] (uint32_t item) {
+        data_link.Send(now, static_cast<uint16_t>(first_sequence + item));
+    };
+
+    for (now = 1; now < 600000 && delivered < count; ++now) {
+        // the game keeps on queueing
+        while (queued < count && window.GetSize() < 2000) {
+            window.Push(queued++);
+        }
+
+        uint64_t rtt = 0;
+
+        ack_link.Deliver(now, arrived);
+        for (uint32_t value : arrived) {
+            uint16_t sequence = static_cast<uint16_t>(value);
+
+            if (value & kAckFlag) {
+                uint32_t released = window.Acknowledge(sequence, now, [] (uint32_t) {}, rtt);
+
+                if (released) {
+                    control.OnAck(released, rtt);
+                }
+            } else {
+                window.AcknowledgeSelective(sequence);
+            }
+        }
+
+        // whatever sits behind a packet that made it is lost once it had the time to
+        // arrive as well, everything else only after the retransmission timeout
+        uint32_t lost = window.ResendLost(now, control.GetLossTimeout(), control.GetWindow(), resend);
+
+        if (lost) {
+            control.OnLoss(lost, now);
+            result.resent += lost;
+        }
+
+        if (now % 10 == 0) {
+            uint32_t resent = window.Resend(now, control.GetRetransmitTimeout(), control.GetWindow(), resend);
+
+            if (resent) {
+                control.OnTimeout(now);
+                result.resent += resent;
+            }
+        }
+
+        while (window.GetOutstanding() < control.GetWindow() && window.SendNext(now, message)) {
+            data_link.Send(now, static_cast<uint16_t>(first_sequence + message));
+            ++result.sent;
+        }
+
+        // the remote side
+        data_link.Deliver(now, arrived);
+        for (uint32_t value : arrived) {
+            uint16_t sequence = static_cast<uint16_t>(value);
+
+            if (sequence == expected) {
+                do {
+                    if (static_cast<uint16_t>(expected - first_sequence) != static_cast<uint16_t>(delivered)) {
+                        result.in_order = false;
+                    }
+
+                    ++delivered;
+                    ++expected;
+                } while (ahead.erase(expected));
+
+                ack_link.Send(now, kAckFlag | static_cast<uint16_t>(expected - 1));
+            } else if (SequenceBefore(expected, sequence)) {
+                ahead.insert(sequence);
+                ack_link.Send(now, kOrderFlag | sequence);
+            } else {
+                // a duplicate, the ack might have been lost
+                ack_link.Send(now, kAckFlag | static_cast<uint16_t>(expected - 1));
+            }
+        }
+
+        result.duration = now;
+    }
+
+    result.complete = (delivered == count);
+    result.final_window = control.GetWindow();
+    result.smoothed_rtt = control.GetSmoothedRtt();
+
+    return result;
+}
+
+SimulatedLink::Config MakeLink(uint64_t delay, uint64_t jitter, double loss, uint32_t rate, uint32_t queue) {
+    SimulatedLink::Config config = { delay, jitter, loss, rate, queue };
+    return config;
+}
+
+}  // namespace
+
+TEST(CongestionControlTest, SimulationDeliversEverythingOverACleanLink) {
+    SimulationResult result = Simulate(MakeLink(20, 0, 0.0, 0, 0), 20000, 0, 800);
+
+    EXPECT_TRUE(result.complete);
+    EXPECT_TRUE(result.in_order);
+    EXPECT_EQ(0u, result.resent);
+    EXPECT_EQ(800u, result.final_window);
+    EXPECT_NEAR(40.0, static_cast<double>(result.smoothed_rtt), 2.0);
+}
+
+TEST(CongestionControlTest, SimulationRecoversFromLossAcrossTheWrap) {
+    // starts right before the wrap and pushes more than a whole sequence space through
+    SimulationResult result = Simulate(MakeLink(50, 10, 0.05, 0, 0), 70000, 0xff00, 800);
+
+    EXPECT_TRUE(result.complete);
+    EXPECT_TRUE(result.in_order);
+    EXPECT_GT(result.resent, 0u);
+    // resends stay within a few times the loss rate
+    EXPECT_LT(result.resent, result.sent / 4);
+}
+
+TEST(CongestionControlTest, SimulationBacksOffAtABottleneck) {
+    // 10 packets per millisecond through a 100 packet queue, the window has to settle well
+    // below the configured maximum instead of flooding the queue
+    SimulationResult result = Simulate(MakeLink(10, 0, 0.0, 10, 100), 50000, 0, 8000);
+
+    EXPECT_TRUE(result.complete);
+    EXPECT_TRUE(result.in_order);
+    EXPECT_LT(result.final_window, 1000u);
+    // close to what the bottleneck allows
+    EXPECT_LT(result.duration, 50000u / 10 * 2);
+}
+
+/// Run with --gtest_also_run_disabled_tests.
+TEST(CongestionControlTest, DISABLED_SimulationSweep) {
+    const double losses[] = { 0.0, 0.01, 0.05, 0.15 };
+    const uint64_t delays[] = { 5, 50, 150 };
+
+    for (uint64_t delay : delays) {
+        for (double loss : losses) {
+            SimulationResult result = Simulate(MakeLink(delay, delay / 5, loss, 20, 200), 50000, 0, 800);
+
+            std::cout << "delay " << delay << "ms loss " << loss * 100 << "%: "
+                      << (result.complete ? "complete" : "INCOMPLETE") << (result.in_order ? "" : " OUT OF ORDER")
+                      << " in " << result.duration << "ms, "
+                      << 50000 * 1000 / std::max<uint64_t>(result.duration, 1) << " packets/s, "
+                      << result.resent << " resends, window " << result.final_window
+                      << ", srtt " << result.smoothed_rtt << "ms" << std::endl;
+        }
+    }
+}
@@ -0,0 +1,323 @@
+// This file is part of SWGANH which is released under the MIT license.
+// See file LICENSE or go to http://swganh.com/LICENSE
+
+#include "datagram_io.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#ifndef WIN32
+#include <sys/select.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#endif
+
+#include "anh/logger.h"
+
+using namespace swganh::network;
+
+#ifdef WIN32
+#define SOCKET_LAST_ERROR WSAGetLastError()
+typedef int socklen_t;
+#else
+#define SOCKET_LAST_ERROR errno
+#endif
+
+SocketBackend swganh::network::ParseSocketBackend(const std::string& name)
+{
+	if (name == "epoll")
+	{
+		return SOCKET_BACKEND_EPOLL;
+	}
+
+	return SOCKET_BACKEND_SELECT;
+}
+
+const char* swganh::network::GetSocketBackendName(SocketBackend backend)
+{
+	return (backend == SOCKET_BACKEND_EPOLL) ? "epoll" : "select";
+}
+
+DatagramIo::DatagramIo(NativeSocket socket, SocketBackend backend, uint32_t batch_size, uint32_t send_buffer_size)
+	: socket_(socket)
+	, backend_(backend)
+	, batch_size_(std::max<uint32_t>(batch_size, 1))
+	, send_buffer_size_(send_buffer_size)
+	, epoll_(-1)
+	, send_count_(0)
+	, datagrams_sent_(0)
+	, datagrams_received_(0)
+	, system_calls_(0)
+{
+#ifdef __linux__
+	headers_.resize(batch_size_);
+	vectors_.resize(batch_size_);
+	addresses_.resize(batch_size_);
+#else
+	backend_ = SOCKET_BACKEND_SELECT;
+#endif
+
+	// the select backend sends right away and only ever needs the first slot
+	uint32_t slots = (backend_ == SOCKET_BACKEND_EPOLL) ? batch_size_ : 1;
+
+	send_buffers_.resize(slots * send_buffer_size_);
+	destinations_.resize(slots);
+}
+
+DatagramIo::~DatagramIo()
+{
+#ifdef __linux__
+	if (epoll_ >= 0)
+	{
+		close(epoll_);
+	}
+#endif
+}
+
+uint32_t DatagramIo::Receive(Datagram* datagrams, uint32_t count, uint32_t timeout_us)
+{
+	if (count == 0)
+	{
+		return 0;
+	}
+
+	// only the reading side waits on the socket, it opens the epoll instance on its first read
+	if (backend_ == SOCKET_BACKEND_EPOLL && epoll_ < 0 && !OpenEpoll_())
+	{
+		backend_ = SOCKET_BACKEND_SELECT;
+	}
+
+	if (backend_ == SOCKET_BACKEND_EPOLL)
+	{
+		return ReceiveEpoll_(datagrams, count, timeout_us);
+	}
+
+	return ReceiveSelect_(datagrams, timeout_us);
+}
+
+bool DatagramIo::OpenEpoll_()
+{
+#ifdef __linux__
+	epoll_ = epoll_create1(0);
+
+	epoll_event event;
+	memset(&event, 0, sizeof(event));
+	event.events = EPOLLIN;
+	event.data.fd = socket_;
+
+	if (epoll_ < 0 || epoll_ctl(epoll_, EPOLL_CTL_ADD, socket_, &event) < 0)
+	{
+		LOG(warning) << "DatagramIo : epoll unavailable (" << errno << "), falling back to select";
+
+		if (epoll_ >= 0)
+		{
+			close(epoll_);
+			epoll_ = -1;
+		}
+
+		return false;
+	}
+
+	return true;
+#else
+	return false;
+#endif
+}
+
+uint32_t DatagramIo::ReceiveSelect_(Datagram* datagrams, uint32_t timeout_us)
+{
+	fd_set socket_set;
+	FD_ZERO(&socket_set);
+	FD_SET(socket_, &socket_set);
+
+	timeval tv;
+	tv.tv_sec = timeout_us / 1000000;
+	tv.tv_usec = timeout_us % 1000000;
+
+	++system_calls_;
+	if (select(static_cast<int>(socket_) + 1, &socket_set, 0, 0, &tv) <= 0 || !FD_ISSET(socket_, &socket_set))
+	{
+		return 0;
+	}
+
+	sockaddr_in from;
+	socklen_t from_length = sizeof(from);
+
+	Datagram& datagram = datagrams[0];
+
+	++system_calls_;
+	int length = recvfrom(socket_, datagram.data, static_cast<int>(datagram.capacity), 0, reinterpret_cast<sockaddr*>(&from), &from_length);
+
+	datagram.address = from.sin_addr.s_addr;
+	datagram.port = from.sin_port;
+
+	if (length <= 0)
+	{
+		// the caller might need the address of the failed read (a remote host that closed its port)
+		datagram.length = 0;
+		datagram.error = SOCKET_LAST_ERROR;
+		return 1;
+	}
+
+	datagram.length = static_cast<uint32_t>(length);
+	datagram.error = 0;
+
+	++datagrams_received_;
+	return 1;
+}
+
+uint32_t DatagramIo::ReceiveEpoll_(Datagram* datagrams, uint32_t count, uint32_t timeout_us)
+{
+#ifdef __linux__
+	count = std::min(count, batch_size_);
+
+	epoll_event event;
+
+	// epoll only knows milliseconds, dont turn a short wait into a busy loop though
+	int timeout_ms = static_cast<int>((timeout_us + 999) / 1000);
+
+	++system_calls_;
+	if (epoll_wait(epoll_, &event, 1, timeout_ms) <= 0)
+	{
+		return 0;
+	}
+
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		vectors_[i].iov_base = datagrams[i].data;
+		vectors_[i].iov_len = datagrams[i].capacity;
+
+		memset(&headers_[i], 0, sizeof(mmsghdr));
+		headers_[i].msg_hdr.msg_iov = &vectors_[i];
+		headers_[i].msg_hdr.msg_iovlen = 1;
+		headers_[i].msg_hdr.msg_name = &addresses_[i];
+		headers_[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+	}
+
+	++system_calls_;
+	int received = recvmmsg(socket_, &headers_[0], count, MSG_DONTWAIT, NULL);
+
+	if (received <= 0)
+	{
+		return 0;
+	}
+
+	for (int i = 0; i < received; ++i)
+	{
+		datagrams[i].length = headers_[i].msg_len;
+		datagrams[i].address = addresses_[i].sin_addr.s_addr;
+		datagrams[i].port = addresses_[i].sin_port;
+		datagrams[i].error = 0;
+	}
+
+	datagrams_received_ += received;
+	return static_cast<uint32_t>(received);
+#else
+	return ReceiveSelect_(datagrams, count, timeout_us);
+#endif
+}
+
+void DatagramIo::Send(uint32_t length, uint32_t address, uint16_t port)
+{
+	Destination& destination = destinations_[send_count_];
+	destination.length = length;
+	destination.address = address;
+	destination.port = port;
+
+	++send_count_;
+
+	if (send_count_ == destinations_.size())
+	{
+		Flush();
+	}
+}
+
+void DatagramIo::Flush()
+{
+	if (send_count_ == 0)
+	{
+		return;
+	}
+
+	if (backend_ == SOCKET_BACKEND_EPOLL)
+	{
+		FlushSendmmsg_();
+	}
+	else
+	{
+		FlushSendto_();
+	}
+
+	send_count_ = 0;
+}
+
+void DatagramIo::FlushSendto_()
+{
+	for (uint32_t i = 0; i < send_count_; ++i)
+	{
+		sockaddr_in to;
+		memset(&to, 0, sizeof(to));
+		to.sin_family = AF_INET;
+		to.sin_addr.s_addr = destinations_[i].address;
+		to.sin_port = destinations_[i].port;
+
+		++system_calls_;
+		if (sendto(socket_, &send_buffers_[i * send_buffer_size_], destinations_[i].length, 0, reinterpret_cast<sockaddr*>(&to), sizeof(to)) < 0)
+		{
+			LOG(warning) << "DatagramIo : sendto failed with " << SOCKET_LAST_ERROR;
+			continue;
+		}
+
+		++datagrams_sent_;
+	}
+}
+
+void DatagramIo::FlushSendmmsg_()
+{
+#ifdef __linux__
+	for (uint32_t i = 0; i < send_count_; ++i)
+	{
+		sockaddr_in& to = addresses_[i];
+		memset(&to, 0, sizeof(to));
+		to.sin_family = AF_INET;
+		to.sin_addr.s_addr = destinations_[i].address;
+		to.sin_port = destinations_[i].port;
+
+		vectors_[i].iov_base = &send_buffers_[i * send_buffer_size_];
+		vectors_[i].iov_len = destinations_[i].length;
+
+		memset(&headers_[i], 0, sizeof(mmsghdr));
+		headers_[i].msg_hdr.msg_iov = &vectors_[i];
+		headers_[i].msg_hdr.msg_iovlen = 1;
+		headers_[i].msg_hdr.msg_name = &to;
+		headers_[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+	}
+
+	uint32_t sent = 0;
+	while (sent < send_count_)
+	{
+		++system_calls_;
+		int result = sendmmsg(socket_, &headers_[sent], send_count_ - sent, 0);
+
+		if (result < 0)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+
+			// sendmmsg stops at the first failing datagram, drop it like sendto would and go on with the rest
+			LOG(warning) << "DatagramIo : sendmmsg failed with " << errno;
+			++sent;
+			continue;
+		}
+
+		sent += result;
+		datagrams_sent_ += result;
+	}
+#endif
+}
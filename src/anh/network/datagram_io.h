@@ -0,0 +1,148 @@
+// This file is part of SWGANH which is released under the MIT license.
+// See file LICENSE or go to http://swganh.com/LICENSE
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#ifdef WIN32
+#include <Winsock2.h>
+#else
+#include <netinet/in.h>
+#include <sys/socket.h>
+#endif
+
+namespace swganh
+{
+namespace network
+{
+#ifdef WIN32
+	typedef SOCKET NativeSocket;
+#else
+	typedef int NativeSocket;
+#endif
+
+	enum SocketBackend
+	{
+		// select() and one recvfrom / sendto per datagram, available everywhere
+		SOCKET_BACKEND_SELECT = 0,
+		// epoll and recvmmsg / sendmmsg batches, linux only
+		SOCKET_BACKEND_EPOLL
+	};
+
+	/**
+		@brief parses the SocketBackend configuration value ("select" or "epoll"),
+		anything unknown is select.
+	*/
+	SocketBackend ParseSocketBackend(const std::string& name);
+
+	const char* GetSocketBackendName(SocketBackend backend);
+
+	/**
+		@brief a datagram read from the socket
+	*/
+	struct Datagram
+	{
+		char* data;
+		uint32_t capacity;
+		uint32_t length;
+		// network order, like the session addresses
+		uint32_t address;
+		uint16_t port;
+		// the socket error if length is 0
+		int error;
+	};
+
+	/**
+		@brief Reads and writes the datagrams of an udp socket.
+
+		The select backend waits with select() and reads a single datagram per call, every
+		Send goes out in its own sendto. The epoll backend waits with epoll and reads up to a
+		batch of datagrams with one recvmmsg, Send only fills up the next slot of the send
+		batch which goes out in one sendmmsg once it is full or flushed.
+
+		The epoll backend falls back to select for reading where it isn't available. An instance is not
+		thread safe, the read and the write thread each use their own on the same socket.
+	*/
+	class DatagramIo
+	{
+	public:
+		/**
+			@param batch_size the number of datagrams read and written per system call
+			@param send_buffer_size the size of each send slot
+		*/
+		DatagramIo(NativeSocket socket, SocketBackend backend, uint32_t batch_size, uint32_t send_buffer_size);
+		~DatagramIo();
+
+		SocketBackend GetBackend() const { return backend_; }
+
+		/**
+			@brief waits up to timeout_us microseconds for the socket to become readable and
+			reads up to count datagrams into the given buffers.
+			@returns the number of datagrams read
+		*/
+		uint32_t Receive(Datagram* datagrams, uint32_t count, uint32_t timeout_us);
+
+		/**
+			@brief the buffer the next datagram to send has to be written to
+		*/
+		char* GetSendBuffer() { return &send_buffers_[send_count_ * send_buffer_size_]; }
+		uint32_t GetSendBufferSize() const { return send_buffer_size_; }
+
+		/**
+			@brief sends the length bytes written to GetSendBuffer to the address and port,
+			both in network order.
+		*/
+		void Send(uint32_t length, uint32_t address, uint16_t port);
+
+		/**
+			@brief sends all datagrams of the current batch
+		*/
+		void Flush();
+
+		uint64_t GetDatagramsSent() const { return datagrams_sent_; }
+		uint64_t GetDatagramsReceived() const { return datagrams_received_; }
+		uint64_t GetSystemCalls() const { return system_calls_; }
+
+	private:
+		DatagramIo(const DatagramIo&);
+		DatagramIo& operator=(const DatagramIo&);
+
+		struct Destination
+		{
+			uint32_t length;
+			uint32_t address;
+			uint16_t port;
+		};
+
+		bool OpenEpoll_();
+		uint32_t ReceiveSelect_(Datagram* datagrams, uint32_t timeout_us);
+		uint32_t ReceiveEpoll_(Datagram* datagrams, uint32_t count, uint32_t timeout_us);
+		void FlushSendto_();
+		void FlushSendmmsg_();
+
+		NativeSocket socket_;
+		SocketBackend backend_;
+		uint32_t batch_size_;
+		uint32_t send_buffer_size_;
+
+		int epoll_;
+
+		std::vector<char> send_buffers_;
+		std::vector<Destination> destinations_;
+		uint32_t send_count_;
+
+#ifdef __linux__
+		// the headers of the recvmmsg / sendmmsg batches
+		std::vector<mmsghdr> headers_;
+		std::vector<iovec> vectors_;
+		std::vector<sockaddr_in> addresses_;
+#endif
+
+		uint64_t datagrams_sent_;
+		uint64_t datagrams_received_;
+		uint64_t system_calls_;
+	};
+}
+}
@@ -0,0 +1,308 @@
+/*
+ This file is part of MMOServer. For more information, visit http://swganh.com
+
+ Copyright (c) 2006 - 2014 The SWG:ANH Team
+
+ MMOServer is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ MMOServer is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with MMOServer.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/thread/thread.hpp>
+
+#ifndef WIN32
+#include <arpa/inet.h>
+#include <unistd.h>
+#endif
+
+#include "anh/network/datagram_io.h"
+
+using swganh::network::Datagram;
+using swganh::network::DatagramIo;
+using swganh::network::NativeSocket;
+using swganh::network::SocketBackend;
+using swganh::network::SOCKET_BACKEND_EPOLL;
+using swganh::network::SOCKET_BACKEND_SELECT;
+
+namespace {
+
+const uint32_t kDatagramSize = 496;
+
+/// An udp socket bound to an ephemeral loopback port.
+struct LoopbackSocket {
+    LoopbackSocket() {
+        socket = ::socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+
+        sockaddr_in local;
+        memset(&local, 0, sizeof(local));
+        local.sin_family = AF_INET;
+        local.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        local.sin_port = 0;
+        bind(socket, reinterpret_cast<sockaddr*>(&local), sizeof(local));
+
+        socklen_t length = sizeof(local);
+        getsockname(socket, reinterpret_cast<sockaddr*>(&local), &length);
+
+        address = local.sin_addr.s_addr;
+        port = local.sin_port;
+    }
+
+    ~LoopbackSocket() {
+#ifdef WIN32
+        closesocket(socket);
+#else
+        close(socket);
+#endif
+    }
+
+    void SetReceiveBuffer(int size) {
+        setsockopt(socket, SOL_SOCKET, SO_RCVBUF, reinterpret_cast<char*>(&size), sizeof(size));
+    }
+
+    NativeSocket socket;
+    uint32_t address;
+    uint16_t port;
+};
+
+/// Receive buffers for a batch of datagrams.
+struct DatagramBatch {
+    explicit DatagramBatch(uint32_t count)
+        : buffers(count * kDatagramSize)
+        , datagrams(count) {
+        for (uint32_t i = 0; i < count; ++i) {
+            memset(&datagrams[i], 0, sizeof(Datagram));
+            datagrams[i].data = &buffers[i * kDatagramSize];
+            datagrams[i].capacity = kDatagramSize;
+        }
+    }
+
+    std::vector<char> buffers;
+    std::vector<Datagram> datagrams;
+};
+
+void SendNumber(DatagramIo& io, const LoopbackSocket& to, uint32_t number) {
+    memcpy(io.GetSendBuffer(), &number, sizeof(number));
+    io.Send(sizeof(number), to.address, to.port);
+}
+
+void ExpectRoundTrip(SocketBackend backend) {
+    LoopbackSocket sender_socket, receiver_socket;
+    DatagramIo sender(sender_socket.socket, backend, 8, kDatagramSize);
+    DatagramIo receiver(receiver_socket.socket, backend, 8, kDatagramSize);
+
+    for (uint32_t i = 0; i < 3; ++i) {
+        SendNumber(sender, receiver_socket, i);
+    }
+    sender.Flush();
+
+    EXPECT_EQ(3u, sender.GetDatagramsSent());
+
+    DatagramBatch batch(8);
+    std::vector<uint32_t> received;
+
+    for (uint32_t attempt = 0; attempt < 100 && received.size() < 3; ++attempt) {
+        uint32_t count = receiver.Receive(&batch.datagrams[0], 8, 10000);
+
+        for (uint32_t i = 0; i < count; ++i) {
+            const Datagram& datagram = batch.datagrams[i];
+            ASSERT_EQ(sizeof(uint32_t), datagram.length);
+            EXPECT_EQ(sender_socket.address, datagram.address);
+            EXPECT_EQ(sender_socket.port, datagram.port);
+
+            uint32_t number;
+            memcpy(&number, datagram.data, sizeof(number));
+            received.push_back(number);
+        }
+    }
+
+    ASSERT_EQ(3u, received.size());
+    for (uint32_t i = 0; i < 3; ++i) {
+        EXPECT_EQ(i, received[i]);
+    }
+}
+
+}  // namespace
+
+TEST(DatagramIoTest, ParsesTheBackendName) {
+    EXPECT_EQ(SOCKET_BACKEND_EPOLL, swganh::network::ParseSocketBackend("epoll"));
+    EXPECT_EQ(SOCKET_BACKEND_SELECT, swganh::network::ParseSocketBackend("select"));
+    EXPECT_EQ(SOCKET_BACKEND_SELECT, swganh::network::ParseSocketBackend("iocp"));
+}
+
+TEST(DatagramIoTest, SelectRoundTrip) {
+    ExpectRoundTrip(SOCKET_BACKEND_SELECT);
+}
+
+TEST(DatagramIoTest, EpollRoundTrip) {
+    ExpectRoundTrip(SOCKET_BACKEND_EPOLL);
+}
+
+TEST(DatagramIoTest, TimesOutWithoutData) {
+    LoopbackSocket socket;
+    DatagramIo io(socket.socket, SOCKET_BACKEND_EPOLL, 8, kDatagramSize);
+    DatagramBatch batch(8);
+
+    EXPECT_EQ(0u, io.Receive(&batch.datagrams[0], 8, 1000));
+}
+
+#ifdef __linux__
+TEST(DatagramIoTest, EpollBatchesSendsAndReceives) {
+    LoopbackSocket sender_socket, receiver_socket;
+    DatagramIo sender(sender_socket.socket, SOCKET_BACKEND_EPOLL, 16, kDatagramSize);
+    DatagramIo receiver(receiver_socket.socket, SOCKET_BACKEND_EPOLL, 16, kDatagramSize);
+
+    ASSERT_EQ(SOCKET_BACKEND_EPOLL, sender.GetBackend());
+
+    // nothing goes out before the batch is flushed
+    for (uint32_t i = 0; i < 10; ++i) {
+        SendNumber(sender, receiver_socket, i);
+    }
+    EXPECT_EQ(0u, sender.GetSystemCalls());
+
+    sender.Flush();
+    EXPECT_EQ(10u, sender.GetDatagramsSent());
+    EXPECT_EQ(1u, sender.GetSystemCalls());
+
+    DatagramBatch batch(16);
+    EXPECT_EQ(10u, receiver.Receive(&batch.datagrams[0], 16, 100000));
+    EXPECT_EQ(2u, receiver.GetSystemCalls());
+}
+
+TEST(DatagramIoTest, FlushesAFullBatch) {
+    LoopbackSocket sender_socket, receiver_socket;
+    DatagramIo sender(sender_socket.socket, SOCKET_BACKEND_EPOLL, 4, kDatagramSize);
+
+    for (uint32_t i = 0; i < 6; ++i) {
+        SendNumber(sender, receiver_socket, i);
+    }
+
+    EXPECT_EQ(4u, sender.GetDatagramsSent());
+
+    sender.Flush();
+    EXPECT_EQ(6u, sender.GetDatagramsSent());
+}
+#endif
+
+namespace {
+
+uint64_t NowMicroseconds() {
+    static const boost::posix_time::ptime epoch(boost::gregorian::date(2000, 1, 1));
+    return (boost::posix_time::microsec_clock::universal_time() - epoch).total_microseconds();
+}
+
+struct LoadResult {
+    uint32_t received;
+    double seconds;
+    uint64_t p99_us;
+    uint64_t system_calls;
+};
+
+/// Pushes count timestamped datagrams through loopback in bursts and reads them the way
+/// SocketReadThread does: the select backend with a datagram per pass and the 10us nap
+/// between passes, the epoll backend with a batch per pass.
+LoadResult RunLoad(SocketBackend backend, uint32_t batch_size, uint32_t count, uint32_t burst) {
+    LoopbackSocket sender_socket, receiver_socket;
+    receiver_socket.SetReceiveBuffer(8 * 1024 * 1024);
+
+    DatagramIo receiver(receiver_socket.socket, backend, batch_size, kDatagramSize);
+    DatagramBatch batch(batch_size);
+
+    boost::thread sender_thread([&] () {
+        DatagramIo sender(sender_socket.socket, backend, burst, kDatagramSize);
+
+        for (uint32_t sent = 0; sent < count; ) {
+            for (uint32_t i = 0; i < burst && sent < count; ++i, ++sent) {
+                char* buffer = sender.GetSendBuffer();
+                memset(buffer, 0, kDatagramSize);
+
+                uint64_t now = NowMicroseconds();
+                memcpy(buffer, &now, sizeof(now));
+                sender.Send(kDatagramSize, receiver_socket.address, receiver_socket.port);
+            }
+            sender.Flush();
+
+            // roughly a busy zone worth of client traffic, not a flood
+            boost::this_thread::sleep(boost::posix_time::microseconds(100));
+        }
+    });
+
+    std::vector<uint64_t> latencies;
+    latencies.reserve(count);
+
+    uint64_t start = NowMicroseconds();
+    uint64_t last = start;
+
+    while (latencies.size() < count && NowMicroseconds() - last < 500000) {
+        uint32_t received = receiver.Receive(&batch.datagrams[0], batch_size, 250);
+        uint64_t now = NowMicroseconds();
+
+        for (uint32_t i = 0; i < received; ++i) {
+            if (batch.datagrams[i].length < sizeof(uint64_t)) {
+                continue;
+            }
+
+            uint64_t stamp;
+            memcpy(&stamp, batch.datagrams[i].data, sizeof(stamp));
+            latencies.push_back(now - stamp);
+            last = now;
+        }
+
+        if (backend == SOCKET_BACKEND_SELECT) {
+            boost::this_thread::sleep(boost::posix_time::microseconds(10));
+        }
+    }
+
+    sender_thread.join();
+
+    LoadResult result;
+    result.received = static_cast<uint32_t>(latencies.size());
+    result.seconds = (last - start) / 1000000.0;
+    result.system_calls = receiver.GetSystemCalls();
+    result.p99_us = 0;
+
+    if (!latencies.empty()) {
+        std::sort(latencies.begin(), latencies.end());
+        result.p99_us = latencies[(latencies.size() * 99) / 100];
+    }
+
+    return result;
+}
+
+void PrintLoad(const char* name, uint32_t count, const LoadResult& result) {
+    std::cout << name << ": " << result.received << "/" << count << " datagrams, "
+              << static_cast<uint64_t>(result.received / std::max(result.seconds, 0.000001)) << " packets/sec, "
+              << "p99 " << result.p99_us << "us, "
+              << result.system_calls << " system calls" << std::endl;
+}
+
+}  // namespace
+
+/// Run with --gtest_also_run_disabled_tests.
+TEST(DatagramIoTest, DISABLED_BenchmarkLoopbackLoad) {
+    const uint32_t count = 200000;
+    const uint32_t bursts[] = { 8, 64 };
+
+    for (uint32_t burst : bursts) {
+        std::cout << "burst " << burst << std::endl;
+
+        PrintLoad("  select + recvfrom      ", count, RunLoad(SOCKET_BACKEND_SELECT, 1, count, burst));
+        PrintLoad("  epoll + recvmmsg (32)  ", count, RunLoad(SOCKET_BACKEND_EPOLL, 32, count, burst));
+    }
+}
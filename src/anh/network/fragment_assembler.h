@@ -0,0 +1,168 @@
+// This file is part of SWGANH which is released under the MIT license.
+// See file LICENSE or go to http://swganh.com/LICENSE
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace swganh
+{
+namespace network
+{
+	/**
+		@brief Collects the fragments of a message without copying them.
+
+		The received buffers stay alive until the message is complete, the message is a
+		scatter gather view over their payloads. It is copied once, straight into the memory
+		it ends up in, when a consumer needs it in one piece.
+
+		T is the owner of a fragment buffer, handed back on Reset(). Not thread safe.
+	*/
+	template<typename T>
+	class FragmentAssembler
+	{
+	public:
+		struct Span
+		{
+			const char* data;
+			uint32_t length;
+		};
+
+		explicit FragmentAssembler(uint32_t max_size)
+			: max_size_(max_size)
+			, total_size_(0)
+			, current_size_(0)
+			, discard_remaining_(0)
+		{
+		}
+
+		bool IsStarted() const { return !owners_.empty(); }
+		bool IsComplete() const { return IsStarted() && current_size_ >= total_size_; }
+
+		/**
+			@brief true while the later fragments of a message Start() dropped are still due,
+			they have to go to Discard() instead of starting a message of their own
+		*/
+		bool IsDiscarding() const { return discard_remaining_ != 0; }
+
+		uint32_t GetTotalSize() const { return total_size_; }
+		uint32_t GetCurrentSize() const { return current_size_; }
+		uint32_t GetFragmentCount() const { return static_cast<uint32_t>(owners_.size()); }
+
+		/**
+			@brief the first fragment the message starts with
+		*/
+		T GetFirstOwner() const { return owners_.front(); }
+
+		const std::vector<Span>& GetSpans() const { return spans_; }
+
+		/**
+			@brief starts a message with its first fragment, the one announcing its size
+
+			@returns false if the message would be larger than the maximum, nothing is kept then
+			and the rest of the message is discarded, see IsDiscarding()
+		*/
+		bool Start(uint32_t total_size, T owner, const char* data, uint32_t length)
+		{
+			if (length > total_size)
+			{
+				return false;
+			}
+
+			if (total_size > max_size_)
+			{
+				discard_remaining_ = total_size - length;
+				return false;
+			}
+
+			total_size_ = total_size;
+			current_size_ = 0;
+
+			Add(owner, data, length);
+			return true;
+		}
+
+		/**
+			@returns true once the fragments cover the announced size
+		*/
+		bool Add(T owner, const char* data, uint32_t length)
+		{
+			Span span = { data, length };
+			spans_.push_back(span);
+			owners_.push_back(owner);
+
+			current_size_ += length;
+
+			return current_size_ >= total_size_;
+		}
+
+		/**
+			@brief drops the next length bytes of a message Start() dropped
+
+			@returns true once all of it is gone
+		*/
+		bool Discard(uint32_t length)
+		{
+			discard_remaining_ -= std::min(length, discard_remaining_);
+			return discard_remaining_ == 0;
+		}
+
+		/**
+			@brief gathers length bytes of the message from offset on into destination
+
+			@returns the bytes copied, less than length if the message ends before
+		*/
+		uint32_t CopyTo(char* destination, uint32_t offset, uint32_t length) const
+		{
+			uint32_t copied = 0;
+
+			for (auto& span : spans_)
+			{
+				if (copied == length)
+				{
+					break;
+				}
+
+				if (offset >= span.length)
+				{
+					offset -= span.length;
+					continue;
+				}
+
+				uint32_t chunk = std::min(span.length - offset, length - copied);
+				std::memcpy(destination + copied, span.data + offset, chunk);
+
+				copied += chunk;
+				offset = 0;
+			}
+
+			return copied;
+		}
+
+		/**
+			@brief drops the message, release is called with the owner of every fragment
+		*/
+		template<typename Release>
+		void Reset(Release release)
+		{
+			std::for_each(owners_.begin(), owners_.end(), release);
+
+			owners_.clear();
+			spans_.clear();
+			total_size_ = 0;
+			current_size_ = 0;
+			discard_remaining_ = 0;
+		}
+
+	private:
+		uint32_t max_size_;
+		uint32_t total_size_;
+		uint32_t current_size_;
+		uint32_t discard_remaining_;
+
+		std::vector<Span> spans_;
+		std::vector<T> owners_;
+	};
+}}
@@ -0,0 +1,191 @@
+/*
+ This file is part of MMOServer. For more information, visit http://swganh.com
+
+ Copyright (c) 2006 - 2014 The SWG:ANH Team
+
+ MMOServer is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ MMOServer is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with MMOServer.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include "anh/network/fragment_assembler.h"
+
+using swganh::network::FragmentAssembler;
+
+namespace {
+
+/// Splits a message into fragments of the given payload size, like the remote side sends it.
+std::vector<std::vector<char>> Fragment(const std::vector<char>& message, uint32_t fragment_size) {
+    std::vector<std::vector<char>> fragments;
+
+    for (uint32_t offset = 0; offset < message.size(); offset += fragment_size) {
+        uint32_t length = std::min<uint32_t>(fragment_size, message.size() - offset);
+        fragments.push_back(std::vector<char>(message.begin() + offset, message.begin() + offset + length));
+    }
+
+    return fragments;
+}
+
+std::vector<char> MakeMessage(uint32_t size) {
+    std::vector<char> message(size);
+
+    for (uint32_t i = 0; i < size; ++i) {
+        message[i] = static_cast<char>(i * 31 + (i >> 8));
+    }
+
+    return message;
+}
+
+}  // namespace
+
+TEST(FragmentAssemblerTest, GathersTheMessageAcrossFragments) {
+    std::vector<char> message = MakeMessage(5000);
+    auto fragments = Fragment(message, 486);
+
+    FragmentAssembler<int> assembler(0x10000);
+    EXPECT_FALSE(assembler.IsStarted());
+
+    ASSERT_TRUE(assembler.Start(5000, 0, fragments[0].data(), fragments[0].size()));
+
+    for (uint32_t i = 1; i < fragments.size(); ++i) {
+        EXPECT_FALSE(assembler.IsComplete());
+        EXPECT_EQ(i + 1 == fragments.size(), assembler.Add(i, fragments[i].data(), fragments[i].size()));
+    }
+
+    EXPECT_TRUE(assembler.IsComplete());
+    EXPECT_EQ(fragments.size(), assembler.GetFragmentCount());
+    EXPECT_EQ(fragments.size(), assembler.GetSpans().size());
+
+    // the spans point into the fragments themselves
+    EXPECT_EQ(fragments[3].data(), assembler.GetSpans()[3].data);
+
+    // a range starting and ending mid fragment
+    std::vector<char> gathered(3000);
+    EXPECT_EQ(3000u, assembler.CopyTo(gathered.data(), 700, 3000));
+    EXPECT_EQ(0, std::memcmp(gathered.data(), message.data() + 700, 3000));
+
+    // past the end only what is there
+    EXPECT_EQ(100u, assembler.CopyTo(gathered.data(), 4900, 3000));
+
+    std::vector<int> released;
+    assembler.Reset([&] (int owner) { released.push_back(owner); });
+
+    EXPECT_EQ(fragments.size(), released.size());
+    EXPECT_EQ(0, released.front());
+    EXPECT_FALSE(assembler.IsStarted());
+    EXPECT_EQ(0u, assembler.GetCurrentSize());
+}
+
+TEST(FragmentAssemblerTest, RejectsOversizedMessages) {
+    char fragment[16] = {0};
+    FragmentAssembler<int> assembler(1000);
+
+    EXPECT_FALSE(assembler.Start(1001, 0, fragment, sizeof(fragment)));
+    EXPECT_FALSE(assembler.IsStarted());
+
+    // the first fragment cant carry more than the message
+    EXPECT_FALSE(assembler.Start(8, 0, fragment, sizeof(fragment)));
+    EXPECT_FALSE(assembler.IsStarted());
+
+    EXPECT_TRUE(assembler.Start(16, 0, fragment, sizeof(fragment)));
+    EXPECT_TRUE(assembler.IsComplete());
+}
+
+TEST(FragmentAssemblerTest, DiscardsTheRestOfADroppedMessage) {
+    std::vector<char> message = MakeMessage(3000);
+    auto fragments = Fragment(message, 486);
+
+    FragmentAssembler<int> assembler(1000);
+
+    EXPECT_FALSE(assembler.Start(3000, 0, fragments[0].data(), fragments[0].size()));
+    EXPECT_FALSE(assembler.IsStarted());
+    EXPECT_TRUE(assembler.IsDiscarding());
+
+    // the continuations are dropped until the announced size is used up
+    for (uint32_t i = 1; i < fragments.size(); ++i) {
+        EXPECT_TRUE(assembler.IsDiscarding());
+        EXPECT_EQ(i + 1 == fragments.size(), assembler.Discard(fragments[i].size()));
+    }
+
+    EXPECT_FALSE(assembler.IsDiscarding());
+
+    // the next message starts normally again
+    std::vector<char> next = MakeMessage(600);
+    EXPECT_TRUE(assembler.Start(600, 1, next.data(), 486));
+    EXPECT_TRUE(assembler.Add(2, next.data() + 486, 114));
+}
+
+TEST(FragmentAssemblerTest, DISABLED_BenchmarkBaselineBursts) {
+    // a burst of login baselines and inventory lists, up to a full message in 486 byte fragments
+    const uint32_t sizes[] = { 4000, 16000, 40000, 65000 };
+    const uint32_t kBurstBytes = 256 * 1024 * 1024;
+
+    for (uint32_t size : sizes) {
+        std::vector<char> message = MakeMessage(size);
+        auto fragments = Fragment(message, 486);
+        uint32_t rounds = kBurstBytes / size;
+
+        std::vector<char> destination(0x20000);
+        uint64_t checksum = 0;
+
+        // fragment by fragment into a message block that moves into the next size class as it outgrows it
+        auto start = std::chrono::steady_clock::now();
+        for (uint32_t round = 0; round < rounds; ++round) {
+            std::vector<char> block(256);
+            uint32_t used = 0;
+
+            for (auto& fragment : fragments) {
+                if (used + fragment.size() > block.size()) {
+                    std::vector<char> larger(block.size() * 2);
+                    while (larger.size() < used + fragment.size()) {
+                        larger.resize(larger.size() * 2);
+                    }
+                    std::memcpy(larger.data(), block.data(), used);
+                    block.swap(larger);
+                }
+                std::memcpy(block.data() + used, fragment.data(), fragment.size());
+                used += fragment.size();
+            }
+
+            checksum += block[round % size];
+        }
+        double appended = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        // the fragments are kept and gathered once into a block of the final size
+        start = std::chrono::steady_clock::now();
+        FragmentAssembler<uint32_t> assembler(0x10000);
+        for (uint32_t round = 0; round < rounds; ++round) {
+            assembler.Start(size, 0, fragments[0].data(), fragments[0].size());
+            for (uint32_t i = 1; i < fragments.size(); ++i) {
+                assembler.Add(i, fragments[i].data(), fragments[i].size());
+            }
+
+            std::vector<char> block(size);
+            assembler.CopyTo(block.data(), 0, size);
+            assembler.Reset([] (uint32_t) {});
+
+            checksum += block[round % size];
+        }
+        double gathered = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::cout << size << " byte messages in " << fragments.size() << " fragments: appended "
+                  << (rounds / appended / 1e3) << "k messages/s, gathered " << (rounds / gathered / 1e3)
+                  << "k messages/s (" << (checksum & 1) << ")" << std::endl;
+    }
+}
@@ -0,0 +1,173 @@
+// This file is part of SWGANH which is released under the MIT license.
+// See file LICENSE or go to http://swganh.com/LICENSE
+
+#include "packet_compressor.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+#include <zlib.h>
+
+using namespace swganh::network;
+
+namespace {
+	const uint32_t kEntropySamples = 512;
+
+	// c * log2(c) for every count a sample can reach
+	struct EntropyTable
+	{
+		EntropyTable()
+		{
+			terms[0] = 0.0;
+			for (uint32_t count = 1; count <= kEntropySamples; ++count)
+			{
+				terms[count] = count * std::log(static_cast<double>(count)) / std::log(2.0);
+			}
+		}
+
+		double terms[kEntropySamples + 1];
+	};
+
+	const EntropyTable& GetEntropyTable()
+	{
+		static const EntropyTable table;
+		return table;
+	}
+}
+
+const uint32_t PacketCompressor::kDefaultMinSize;
+const double PacketCompressor::kEntropyLimit = 0.875;
+
+CompressionStats::CompressionStats()
+{
+	Reset();
+}
+
+void CompressionStats::Reset()
+{
+	packets = 0;
+	compressed = 0;
+	skipped_small = 0;
+	skipped_entropy = 0;
+	expanded = 0;
+	bytes_in = 0;
+	bytes_out = 0;
+	microseconds = 0;
+}
+
+double CompressionStats::GetSkipRate() const
+{
+	return packets ? static_cast<double>(skipped_small + skipped_entropy) / packets : 0.0;
+}
+
+PacketCompressor::PacketCompressor(uint32_t min_size)
+	: stream_(new z_stream)
+	, initialized_(false)
+	, min_size_(min_size)
+{
+	std::memset(stream_, 0, sizeof(z_stream));
+	initialized_ = (deflateInit(stream_, Z_DEFAULT_COMPRESSION) == Z_OK);
+}
+
+PacketCompressor::~PacketCompressor()
+{
+	if (initialized_)
+	{
+		deflateEnd(stream_);
+	}
+
+	delete stream_;
+}
+
+uint32_t PacketCompressor::Compress(const char* data, uint32_t length, char* out, uint32_t out_capacity)
+{
+	++stats_.packets;
+	stats_.bytes_in += length;
+
+	if (length < min_size_ || !initialized_)
+	{
+		++stats_.skipped_small;
+		stats_.bytes_out += length;
+		return 0;
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	uint32_t compressed = 0;
+
+	if (EstimateEntropy(data, length) > kEntropyLimit)
+	{
+		++stats_.skipped_entropy;
+	}
+	else
+	{
+		compressed = Deflate_(data, length, out, out_capacity);
+
+		if (compressed)
+		{
+			++stats_.compressed;
+		}
+		else
+		{
+			++stats_.expanded;
+		}
+	}
+
+	stats_.microseconds += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+	stats_.bytes_out += compressed ? compressed : length;
+
+	return compressed;
+}
+
+uint32_t PacketCompressor::Deflate_(const char* data, uint32_t length, char* out, uint32_t out_capacity)
+{
+	if (deflateReset(stream_) != Z_OK)
+	{
+		return 0;
+	}
+
+	stream_->next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+	stream_->avail_in = length;
+	stream_->next_out = reinterpret_cast<Bytef*>(out);
+	// anything that isn't smaller goes out as it is, deflate stops once it fills this
+	stream_->avail_out = std::min(out_capacity, length - 1);
+
+	if (deflate(stream_, Z_FINISH) != Z_STREAM_END)
+	{
+		return 0;
+	}
+
+	return static_cast<uint32_t>(stream_->total_out);
+}
+
+double PacketCompressor::EstimateEntropy(const char* data, uint32_t length)
+{
+	if (length < 2)
+	{
+		return 0.0;
+	}
+
+	uint32_t samples = std::min(length, kEntropySamples);
+	uint16_t counts[256] = {};
+
+	// evenly spread over longer payloads
+	for (uint32_t i = 0; i < samples; ++i)
+	{
+		uint32_t index = (samples == length) ? i : static_cast<uint32_t>(static_cast<uint64_t>(i) * length / samples);
+		++counts[static_cast<uint8_t>(data[index])];
+	}
+
+	const EntropyTable& table = GetEntropyTable();
+	double sum = 0.0;
+
+	for (uint32_t i = 0; i < 256; ++i)
+	{
+		sum += table.terms[counts[i]];
+	}
+
+	double entropy = std::log(static_cast<double>(samples)) / std::log(2.0) - sum / samples;
+	double maximum = std::log(static_cast<double>(std::min<uint32_t>(samples, 256))) / std::log(2.0);
+
+	return entropy / maximum;
+}
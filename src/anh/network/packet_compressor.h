@@ -0,0 +1,92 @@
+// This file is part of SWGANH which is released under the MIT license.
+// See file LICENSE or go to http://swganh.com/LICENSE
+#pragma once
+
+#include <cstdint>
+
+typedef struct z_stream_s z_stream;
+
+namespace swganh
+{
+namespace network
+{
+	struct CompressionStats
+	{
+		CompressionStats();
+
+		void Reset();
+
+		/**
+			@brief the share of the offered packets that went out uncompressed without
+			running deflate
+		*/
+		double GetSkipRate() const;
+
+		// packets offered for compression
+		uint64_t packets;
+		uint64_t compressed;
+		uint64_t skipped_small;
+		uint64_t skipped_entropy;
+		// deflated but not smaller, sent as they were
+		uint64_t expanded;
+
+		// payload bytes offered and put on the wire for them
+		uint64_t bytes_in;
+		uint64_t bytes_out;
+
+		// spent estimating and deflating
+		uint64_t microseconds;
+	};
+
+	/**
+		@brief Deflates packet payloads, skipping those that aren't worth it.
+
+		Payloads below the minimum size don't save enough to pay for the deflate call, and
+		those whose byte distribution is close to uniform (already compressed or encrypted
+		data) won't shrink. The latter is estimated from the entropy of up to 512 sampled
+		bytes.
+
+		The deflate stream is set up once and reset per packet. Not thread safe, every
+		sending thread owns one.
+	*/
+	class PacketCompressor
+	{
+	public:
+		static const uint32_t kDefaultMinSize = 48;
+
+		// normalized entropy above which a payload is taken for incompressible, random
+		// data samples at 0.89 or more, game messages at 0.83 or less
+		static const double kEntropyLimit;
+
+		explicit PacketCompressor(uint32_t min_size = kDefaultMinSize);
+		~PacketCompressor();
+
+		/**
+			@returns the compressed length, 0 if the payload is to be sent uncompressed
+		*/
+		uint32_t Compress(const char* data, uint32_t length, char* out, uint32_t out_capacity);
+
+		const CompressionStats& GetStats() const { return stats_; }
+		void ResetStats() { stats_.Reset(); }
+
+		uint32_t GetMinSize() const { return min_size_; }
+
+		/**
+			@brief the shannon entropy of the payload relative to the most it can have at
+			its length, 0 for a single repeated byte and about 1 for random data
+		*/
+		static double EstimateEntropy(const char* data, uint32_t length);
+
+	private:
+		PacketCompressor(const PacketCompressor&);
+		PacketCompressor& operator=(const PacketCompressor&);
+
+		uint32_t Deflate_(const char* data, uint32_t length, char* out, uint32_t out_capacity);
+
+		z_stream* stream_;
+		bool initialized_;
+		uint32_t min_size_;
+		CompressionStats stats_;
+	};
+}
+}
@@ -0,0 +1,247 @@
+/*
+ This file is part of MMOServer. For more information, visit http://swganh.com
+
+ Copyright (c) 2006 - 2014 The SWG:ANH Team
+
+ MMOServer is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ MMOServer is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with MMOServer.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <zlib.h>
+
+#include "anh/network/packet_compressor.h"
+
+using swganh::network::CompressionStats;
+using swganh::network::PacketCompressor;
+
+namespace {
+
+/// Something like a game message, small integers, coordinates and utf-16 names.
+std::string MakeMessage(std::mt19937& random, uint32_t length) {
+    std::string message;
+
+    while (message.size() < length) {
+        switch (random() % 4) {
+            case 0: {
+                uint32_t value = random() % 500;
+                message.append(reinterpret_cast<const char*>(&value), 4);
+                break;
+            }
+            case 1: {
+                float value = static_cast<float>(random() % 6000) - 3000.0f;
+                message.append(reinterpret_cast<const char*>(&value), 4);
+                break;
+            }
+            case 2: {
+                uint64_t value = random() % 0xffffffffffULL;
+                message.append(reinterpret_cast<const char*>(&value), 8);
+                break;
+            }
+            default: {
+                const char* name = "p\0l\0a\0y\0e\0r\0_\0n\0a\0m\0e\0";
+                message.append(name, 22);
+                break;
+            }
+        }
+    }
+
+    message.resize(length);
+    return message;
+}
+
+std::string MakeRandom(std::mt19937& random, uint32_t length) {
+    std::string data(length, 0);
+    for (auto& byte : data) {
+        byte = static_cast<char>(random());
+    }
+    return data;
+}
+
+std::string Inflate(const char* data, uint32_t length, uint32_t expected) {
+    std::string out(expected, 0);
+    uLongf out_length = expected;
+
+    EXPECT_EQ(Z_OK, uncompress(reinterpret_cast<Bytef*>(&out[0]), &out_length, reinterpret_cast<const Bytef*>(data), length));
+    out.resize(out_length);
+    return out;
+}
+
+}  // namespace
+
+TEST(PacketCompressorTest, EstimatesEntropy) {
+    std::mt19937 random(7);
+
+    EXPECT_DOUBLE_EQ(0.0, PacketCompressor::EstimateEntropy(std::string(100, 'a').data(), 100));
+
+    std::string all_bytes;
+    for (int i = 0; i < 256; ++i) {
+        all_bytes.push_back(static_cast<char>(i));
+    }
+    EXPECT_DOUBLE_EQ(1.0, PacketCompressor::EstimateEntropy(all_bytes.data(), 256));
+
+    for (uint32_t length = 48; length <= 1400; length += 17) {
+        std::string noise = MakeRandom(random, length);
+        EXPECT_GT(PacketCompressor::EstimateEntropy(noise.data(), length), PacketCompressor::kEntropyLimit) << length;
+
+        std::string message = MakeMessage(random, length);
+        EXPECT_LT(PacketCompressor::EstimateEntropy(message.data(), length), PacketCompressor::kEntropyLimit) << length;
+    }
+}
+
+TEST(PacketCompressorTest, SkipsSmallPayloads) {
+    PacketCompressor compressor(48);
+    std::string payload(47, 0);
+    char out[64];
+
+    EXPECT_EQ(0u, compressor.Compress(payload.data(), 47, out, sizeof(out)));
+    EXPECT_EQ(1u, compressor.GetStats().skipped_small);
+    EXPECT_EQ(47u, compressor.GetStats().bytes_out);
+    EXPECT_DOUBLE_EQ(1.0, compressor.GetStats().GetSkipRate());
+}
+
+TEST(PacketCompressorTest, SkipsIncompressiblePayloads) {
+    std::mt19937 random(11);
+    PacketCompressor compressor;
+
+    std::string payload = MakeRandom(random, 400);
+    std::vector<char> out(512);
+
+    EXPECT_EQ(0u, compressor.Compress(payload.data(), 400, out.data(), 512));
+    EXPECT_EQ(1u, compressor.GetStats().skipped_entropy);
+    EXPECT_EQ(400u, compressor.GetStats().bytes_out);
+}
+
+TEST(PacketCompressorTest, CompressesAndReusesItsStream) {
+    std::mt19937 random(13);
+    PacketCompressor compressor;
+    std::vector<char> out(2048);
+    uint64_t bytes_out = 0;
+
+    for (uint32_t i = 0; i < 200; ++i) {
+        uint32_t length = 64 + random() % 1300;
+        std::string message = MakeMessage(random, length);
+
+        uint32_t compressed = compressor.Compress(message.data(), length, out.data(), 2048);
+        ASSERT_GT(compressed, 0u);
+        ASSERT_LT(compressed, length);
+
+        // the receiving side takes a leading 'x' for a compressed payload
+        EXPECT_EQ('x', out[0]);
+        ASSERT_EQ(message, Inflate(out.data(), compressed, length));
+
+        bytes_out += compressed;
+    }
+
+    const CompressionStats& stats = compressor.GetStats();
+    EXPECT_EQ(200u, stats.packets);
+    EXPECT_EQ(200u, stats.compressed);
+    EXPECT_EQ(bytes_out, stats.bytes_out);
+    EXPECT_LT(stats.bytes_out, stats.bytes_in);
+
+    compressor.ResetStats();
+    EXPECT_EQ(0u, compressor.GetStats().packets);
+}
+
+TEST(PacketCompressorTest, SendsWhatDoesntShrinkAsItIs) {
+    std::mt19937 random(17);
+    PacketCompressor compressor;
+
+    std::string message = MakeMessage(random, 200);
+    char out[16];
+
+    EXPECT_EQ(0u, compressor.Compress(message.data(), 200, out, sizeof(out)));
+    EXPECT_EQ(1u, compressor.GetStats().expanded);
+    EXPECT_EQ(200u, compressor.GetStats().bytes_out);
+}
+
+namespace {
+
+/// What CompCryptor::Compress did for every flagged packet, a fresh deflate stream each time.
+uint32_t CompressAlways(const char* data, uint32_t length, char* out, uint32_t out_capacity) {
+    z_stream stream;
+    std::memset(&stream, 0, sizeof(stream));
+    deflateInit(&stream, Z_DEFAULT_COMPRESSION);
+
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+    stream.avail_in = length;
+    stream.next_out = reinterpret_cast<Bytef*>(out);
+    stream.avail_out = out_capacity;
+
+    deflate(&stream, Z_FINISH);
+    uint32_t compressed = static_cast<uint32_t>(stream.total_out);
+    deflateEnd(&stream);
+
+    return (compressed > length) ? 0 : compressed;
+}
+
+}  // namespace
+
+TEST(PacketCompressorTest, DISABLED_BenchmarkMixedTraffic) {
+    std::mt19937 random(19);
+    std::vector<std::string> packets;
+
+    // acks and deltas, full game messages and already compressed blobs
+    for (uint32_t i = 0; i < 4000; ++i) {
+        uint32_t kind = random() % 10;
+
+        if (kind < 5) {
+            packets.push_back(MakeMessage(random, 4 + random() % 40));
+        } else if (kind < 9) {
+            packets.push_back(MakeMessage(random, 64 + random() % 1000));
+        } else {
+            packets.push_back(MakeRandom(random, 64 + random() % 1000));
+        }
+    }
+
+    std::vector<char> out(8192);
+    const uint32_t rounds = 20;
+
+    uint64_t bytes_in = 0;
+    uint64_t bytes_out = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t round = 0; round < rounds; ++round) {
+        for (const std::string& packet : packets) {
+            uint32_t length = static_cast<uint32_t>(packet.size());
+            uint32_t compressed = CompressAlways(packet.data(), length, out.data(), 8192);
+            bytes_in += length;
+            bytes_out += compressed ? compressed : length;
+        }
+    }
+    double always = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "always deflate: " << (rounds * packets.size() / always) << " packets/s, "
+              << (100.0 * bytes_out / bytes_in) << "% of the bytes" << std::endl;
+
+    PacketCompressor compressor;
+    start = std::chrono::steady_clock::now();
+    for (uint32_t round = 0; round < rounds; ++round) {
+        for (const std::string& packet : packets) {
+            compressor.Compress(packet.data(), static_cast<uint32_t>(packet.size()), out.data(), 8192);
+        }
+    }
+    double adaptive = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    const CompressionStats& stats = compressor.GetStats();
+    std::cout << "adaptive:       " << (rounds * packets.size() / adaptive) << " packets/s, "
+              << (100.0 * stats.bytes_out / stats.bytes_in) << "% of the bytes, "
+              << (100.0 * stats.GetSkipRate()) << "% skipped" << std::endl;
+}
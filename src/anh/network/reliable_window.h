@@ -0,0 +1,353 @@
+// This file is part of SWGANH which is released under the MIT license.
+// See file LICENSE or go to http://swganh.com/LICENSE
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace swganh
+{
+namespace network
+{
+	/**
+		@brief whether sequence a comes before b in the wrapping 16 bit sequence space
+	*/
+	inline bool SequenceBefore(uint16_t a, uint16_t b)
+	{
+		return static_cast<int16_t>(static_cast<uint16_t>(a - b)) < 0;
+	}
+
+	/**
+		@brief The send window of a reliable channel, indexed by its 16 bit sequence.
+
+		Packets are queued under consecutive sequences, go out in order and are released
+		once acknowledged. The slots form a ring indexed by sequence, so the wrap from 0xffff
+		to 0 needs no special handling and looking up a sequence, marking it selectively
+		acknowledged and releasing it on a cumulative ack are constant time per packet.
+
+		At most half of the sequence space is queued at once so an ack is never ambiguous.
+		Not thread safe.
+	*/
+	template<typename T>
+	class ReliableWindow
+	{
+	public:
+		static const uint32_t kMaxSize = 0x8000;
+
+		struct Slot
+		{
+			T item;
+			// when the packet first went out, 0 while unsent
+			uint64_t sent_time;
+			// when the packet was last resent, 0 if it never was
+			uint64_t resent_time;
+			// selectively acknowledged, waiting for the cumulative ack to be released
+			bool acknowledged;
+		};
+
+		explicit ReliableWindow(uint16_t first_sequence = 0, uint32_t capacity = 64)
+			: first_(first_sequence)
+			, size_(0)
+			, sent_(0)
+			, acknowledged_(0)
+			, acknowledged_end_(0)
+		{
+			uint32_t slots = 1;
+			while (slots < capacity && slots < kMaxSize)
+			{
+				slots <<= 1;
+			}
+
+			slots_.resize(slots);
+			mask_ = slots - 1;
+		}
+
+		/**
+			@brief the oldest sequence not yet acknowledged
+		*/
+		uint16_t GetFirstSequence() const { return first_; }
+
+		/**
+			@brief the sequence the next queued packet gets
+		*/
+		uint16_t GetNextSequence() const { return static_cast<uint16_t>(first_ + size_); }
+
+		uint32_t GetSize() const { return size_; }
+		uint32_t GetInFlight() const { return sent_; }
+
+		/**
+			@brief packets in flight minus the selectively acknowledged ones, what the
+			network actually still holds
+		*/
+		uint32_t GetOutstanding() const { return sent_ - acknowledged_; }
+		uint32_t GetUnsent() const { return size_ - sent_; }
+		bool IsFull() const { return size_ >= kMaxSize; }
+
+		/**
+			@brief whether the sequence went out and still waits for its ack
+		*/
+		bool IsInFlight(uint16_t sequence) const
+		{
+			return static_cast<uint16_t>(sequence - first_) < sent_;
+		}
+
+		Slot& GetSlot(uint16_t sequence) { return slots_[sequence & mask_]; }
+
+		/**
+			@brief whether the remote side reported packets ahead of a gap, see ResendLost()
+		*/
+		bool HasSelectiveAcks() const { return acknowledged_end_ != 0; }
+
+		/**
+			@brief when the oldest packet in flight that wasn't selectively acknowledged was
+			last (re)sent, the one the retransmission timer runs for
+
+			Walks the window from its start past the selectively acknowledged packets, so it is
+			only constant time while there are none ahead of the first gap.
+
+			@returns 0 if there is none
+		*/
+		uint64_t GetOldestSendTime() const
+		{
+			for (uint32_t i = 0; i < sent_; ++i)
+			{
+				const Slot& slot = slots_[static_cast<uint16_t>(first_ + i) & mask_];
+
+				if (!slot.acknowledged)
+				{
+					return GetLastSent_(slot);
+				}
+			}
+
+			return 0;
+		}
+
+		/**
+			@brief queues the item under GetNextSequence()
+			@returns false if half of the sequence space is already queued
+		*/
+		bool Push(const T& item)
+		{
+			if (IsFull())
+			{
+				return false;
+			}
+
+			if (size_ == slots_.size())
+			{
+				Grow_();
+			}
+
+			Slot& slot = GetSlot(GetNextSequence());
+			slot.item = item;
+			slot.sent_time = 0;
+			slot.resent_time = 0;
+			slot.acknowledged = false;
+
+			++size_;
+			return true;
+		}
+
+		/**
+			@brief puts the oldest unsent packet in flight
+			@returns false if there is none
+		*/
+		bool SendNext(uint64_t now, T& item)
+		{
+			if (sent_ == size_)
+			{
+				return false;
+			}
+
+			Slot& slot = GetSlot(static_cast<uint16_t>(first_ + sent_));
+			slot.sent_time = now;
+			item = slot.item;
+
+			++sent_;
+			return true;
+		}
+
+		/**
+			@brief releases everything up to and including the sequence
+
+			rtt is set to the round trip of the acknowledged sequence unless it was resent,
+			its ack might belong to either send then (Karn), or selectively acknowledged, its
+			ack waited for a gap to be repaired then.
+
+			@returns the number of packets released, 0 for duplicate and out of bounds acks
+		*/
+		template<typename Handler>
+		uint32_t Acknowledge(uint16_t sequence, uint64_t now, Handler release, uint64_t& rtt)
+		{
+			rtt = kNoRtt;
+
+			if (!IsInFlight(sequence))
+			{
+				return 0;
+			}
+
+			Slot& last = GetSlot(sequence);
+			if (last.resent_time == 0 && !last.acknowledged && now >= last.sent_time)
+			{
+				rtt = now - last.sent_time;
+			}
+
+			uint32_t count = static_cast<uint16_t>(sequence - first_) + 1;
+
+			for (uint32_t i = 0; i < count; ++i)
+			{
+				Slot& slot = GetSlot(first_);
+
+				if (slot.acknowledged)
+				{
+					--acknowledged_;
+				}
+
+				release(slot.item);
+				++first_;
+			}
+
+			size_ -= count;
+			sent_ -= count;
+			acknowledged_end_ = (acknowledged_end_ > count) ? acknowledged_end_ - count : 0;
+
+			return count;
+		}
+
+		/**
+			@brief marks a single sequence as received, it won't be resent anymore
+			@returns false if the sequence isn't in flight
+		*/
+		bool AcknowledgeSelective(uint16_t sequence)
+		{
+			if (!IsInFlight(sequence))
+			{
+				return false;
+			}
+
+			Slot& slot = GetSlot(sequence);
+
+			if (!slot.acknowledged)
+			{
+				slot.acknowledged = true;
+				++acknowledged_;
+			}
+
+			acknowledged_end_ = std::max<uint32_t>(acknowledged_end_, static_cast<uint16_t>(sequence - first_) + 1);
+			return true;
+		}
+
+		/**
+			@brief the retransmission timeout, once the oldest packet in flight that wasn't
+			selectively acknowledged timed out hands up to limit packets in flight to resend,
+			oldest first, skipping selectively acknowledged ones and those (re)sent within
+			the last timeout
+
+			Packets behind a gap wait for it to be repaired before they are acknowledged,
+			only the oldest one runs the timer so they don't time out in the meantime.
+
+			@returns the number of packets resent
+		*/
+		template<typename Handler>
+		uint32_t Resend(uint64_t now, uint64_t timeout, uint32_t limit, Handler resend)
+		{
+			uint64_t oldest = GetOldestSendTime();
+
+			if (oldest == 0 || now < oldest + timeout)
+			{
+				return 0;
+			}
+
+			return Resend_(now, timeout, limit, sent_, resend);
+		}
+
+		/**
+			@brief like Resend() but only the packets older than the newest selectively
+			acknowledged one, a packet sent after them made it so they are likely lost
+		*/
+		template<typename Handler>
+		uint32_t ResendLost(uint64_t now, uint64_t timeout, uint32_t limit, Handler resend)
+		{
+			return Resend_(now, timeout, limit, acknowledged_end_, resend);
+		}
+
+		/**
+			@brief releases all queued packets, sent or not
+		*/
+		template<typename Handler>
+		void Clear(Handler release)
+		{
+			for (uint32_t i = 0; i < size_; ++i)
+			{
+				release(GetSlot(static_cast<uint16_t>(first_ + i)).item);
+			}
+
+			first_ = GetNextSequence();
+			size_ = 0;
+			sent_ = 0;
+			acknowledged_ = 0;
+			acknowledged_end_ = 0;
+		}
+
+		static const uint64_t kNoRtt = ~static_cast<uint64_t>(0);
+
+	private:
+		static uint64_t GetLastSent_(const Slot& slot)
+		{
+			return (slot.resent_time > slot.sent_time) ? slot.resent_time : slot.sent_time;
+		}
+
+		template<typename Handler>
+		uint32_t Resend_(uint64_t now, uint64_t timeout, uint32_t limit, uint32_t end, Handler resend)
+		{
+			uint32_t resent = 0;
+
+			for (uint32_t i = 0; i < end && resent < limit; ++i)
+			{
+				Slot& slot = GetSlot(static_cast<uint16_t>(first_ + i));
+
+				if (slot.acknowledged || now < GetLastSent_(slot) + timeout)
+				{
+					continue;
+				}
+
+				slot.resent_time = now;
+				resend(slot.item);
+				++resent;
+			}
+
+			return resent;
+		}
+
+		void Grow_()
+		{
+			std::vector<Slot> slots(slots_.size() * 2);
+			uint32_t mask = static_cast<uint32_t>(slots.size()) - 1;
+
+			for (uint32_t i = 0; i < size_; ++i)
+			{
+				uint16_t sequence = static_cast<uint16_t>(first_ + i);
+				slots[sequence & mask] = slots_[sequence & mask_];
+			}
+
+			slots_.swap(slots);
+			mask_ = mask;
+		}
+
+		std::vector<Slot> slots_;
+		uint32_t mask_;
+
+		uint16_t first_;
+		uint32_t size_;
+		uint32_t sent_;
+
+		// selectively acknowledged packets and the offset past the newest of them
+		uint32_t acknowledged_;
+		uint32_t acknowledged_end_;
+	};
+
+	template<typename T> const uint32_t ReliableWindow<T>::kMaxSize;
+	template<typename T> const uint64_t ReliableWindow<T>::kNoRtt;
+}
+}
@@ -0,0 +1,213 @@
+/*
+ This file is part of MMOServer. For more information, visit http://swganh.com
+
+ Copyright (c) 2006 - 2014 The SWG:ANH Team
+
+ MMOServer is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ MMOServer is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with MMOServer.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <gtest/gtest.h>
+
+#include <functional>
+#include <vector>
+
+#include "anh/network/reliable_window.h"
+
+using swganh::network::ReliableWindow;
+using swganh::network::SequenceBefore;
+
+namespace {
+
+typedef ReliableWindow<uint32_t> Window;
+
+/// Collects whatever the window releases or resends.
+struct Collector {
+    void operator()(uint32_t item) { items.push_back(item); }
+    std::vector<uint32_t> items;
+};
+
+void PushAndSend(Window& window, uint32_t count, uint64_t now) {
+    for (uint32_t i = 0; i < count; ++i) {
+        ASSERT_TRUE(window.Push(i));
+    }
+
+    uint32_t item;
+    for (uint32_t i = 0; i < count; ++i) {
+        ASSERT_TRUE(window.SendNext(now, item));
+        EXPECT_EQ(i, item);
+    }
+}
+
+}  // namespace
+
+TEST(ReliableWindowTest, ComparesSequencesAcrossTheWrap) {
+    EXPECT_TRUE(SequenceBefore(1, 2));
+    EXPECT_FALSE(SequenceBefore(2, 1));
+    EXPECT_FALSE(SequenceBefore(5, 5));
+    EXPECT_TRUE(SequenceBefore(0xfffe, 3));
+    EXPECT_FALSE(SequenceBefore(3, 0xfffe));
+}
+
+TEST(ReliableWindowTest, SendsInOrderAndReleasesOnAck) {
+    Window window;
+    PushAndSend(window, 5, 100);
+
+    uint32_t item;
+    EXPECT_FALSE(window.SendNext(100, item));
+    EXPECT_EQ(5u, window.GetInFlight());
+
+    Collector released;
+    uint64_t rtt = 0;
+    EXPECT_EQ(3u, window.Acknowledge(2, 130, std::ref(released), rtt));
+
+    EXPECT_EQ(30u, rtt);
+    ASSERT_EQ(3u, released.items.size());
+    EXPECT_EQ(0u, released.items[0]);
+    EXPECT_EQ(2u, released.items[2]);
+    EXPECT_EQ(3, window.GetFirstSequence());
+    EXPECT_EQ(2u, window.GetInFlight());
+}
+
+TEST(ReliableWindowTest, IgnoresDuplicateAndUnsentAcks) {
+    Window window;
+    PushAndSend(window, 3, 0);
+    window.Push(3);
+
+    Collector released;
+    uint64_t rtt = 0;
+    EXPECT_EQ(2u, window.Acknowledge(1, 10, std::ref(released), rtt));
+
+    // already released
+    EXPECT_EQ(0u, window.Acknowledge(0, 10, std::ref(released), rtt));
+    EXPECT_EQ(Window::kNoRtt, rtt);
+
+    // queued but never sent
+    EXPECT_EQ(0u, window.Acknowledge(3, 10, std::ref(released), rtt));
+    EXPECT_EQ(2u, released.items.size());
+}
+
+TEST(ReliableWindowTest, WrapsWithoutRollover) {
+    Window window(0xfffa, 4);
+    PushAndSend(window, 12, 0);
+
+    EXPECT_EQ(6, window.GetNextSequence());
+    EXPECT_TRUE(window.IsInFlight(0xffff));
+    EXPECT_TRUE(window.IsInFlight(3));
+
+    Collector released;
+    uint64_t rtt = 0;
+
+    // the ack of sequence 1 covers everything queued before the wrap
+    EXPECT_EQ(8u, window.Acknowledge(1, 5, std::ref(released), rtt));
+    EXPECT_EQ(2, window.GetFirstSequence());
+    EXPECT_EQ(7u, released.items.back());
+
+    EXPECT_EQ(4u, window.Acknowledge(5, 5, std::ref(released), rtt));
+    EXPECT_EQ(0u, window.GetSize());
+}
+
+TEST(ReliableWindowTest, GrowingKeepsTheSequences) {
+    Window window(0xfff0, 2);
+
+    for (uint32_t i = 0; i < 100; ++i) {
+        ASSERT_TRUE(window.Push(i));
+    }
+
+    for (uint32_t i = 0; i < 100; ++i) {
+        EXPECT_EQ(i, window.GetSlot(static_cast<uint16_t>(0xfff0 + i)).item);
+    }
+}
+
+TEST(ReliableWindowTest, ResendsWhatTimedOutAndWasntSelectivelyAcked) {
+    Window window;
+    PushAndSend(window, 4, 100);
+
+    EXPECT_TRUE(window.AcknowledgeSelective(2));
+    EXPECT_FALSE(window.AcknowledgeSelective(9));
+
+    Collector resent;
+
+    // nothing timed out yet
+    EXPECT_EQ(0u, window.Resend(150, 100, 10, std::ref(resent)));
+
+    EXPECT_EQ(3u, window.Resend(200, 100, 10, std::ref(resent)));
+    ASSERT_EQ(3u, resent.items.size());
+    EXPECT_EQ(0u, resent.items[0]);
+    EXPECT_EQ(1u, resent.items[1]);
+    EXPECT_EQ(3u, resent.items[2]);
+
+    // the resend restarts the timeout and spoils the round trip of the ack
+    EXPECT_EQ(0u, window.Resend(250, 100, 10, std::ref(resent)));
+
+    Collector released;
+    uint64_t rtt = 0;
+    window.Acknowledge(0, 260, std::ref(released), rtt);
+    EXPECT_EQ(Window::kNoRtt, rtt);
+
+    EXPECT_EQ(1u, window.Resend(300, 100, 1, std::ref(resent)));
+}
+
+TEST(ReliableWindowTest, OnlyTheOldestPacketRunsTheTimer) {
+    Window window;
+    PushAndSend(window, 2, 100);
+    window.Push(2);
+
+    uint32_t item;
+    window.SendNext(300, item);
+
+    EXPECT_EQ(100u, window.GetOldestSendTime());
+
+    // the packets behind a gap wait for it, their own timers dont count
+    EXPECT_TRUE(window.AcknowledgeSelective(1));
+    EXPECT_TRUE(window.HasSelectiveAcks());
+
+    Collector resent;
+    EXPECT_EQ(0u, window.Resend(350, 300, 10, std::ref(resent)));
+    EXPECT_EQ(1u, window.ResendLost(350, 200, 10, std::ref(resent)));
+    EXPECT_EQ(0u, resent.items[0]);
+    EXPECT_EQ(350u, window.GetOldestSendTime());
+
+    // the timer of the oldest packet ran out, everything that timed out goes
+    EXPECT_EQ(2u, window.Resend(450, 100, 10, std::ref(resent)));
+    EXPECT_EQ(2u, resent.items.back());
+
+    Collector released;
+    uint64_t rtt = 0;
+    EXPECT_EQ(2u, window.Acknowledge(1, 500, std::ref(released), rtt));
+    EXPECT_FALSE(window.HasSelectiveAcks());
+}
+
+TEST(ReliableWindowTest, ClearReleasesEverything) {
+    Window window;
+    PushAndSend(window, 3, 0);
+    window.Push(3);
+
+    Collector released;
+    window.Clear(std::ref(released));
+
+    EXPECT_EQ(4u, released.items.size());
+    EXPECT_EQ(0u, window.GetSize());
+    EXPECT_EQ(4, window.GetNextSequence());
+}
+
+TEST(ReliableWindowTest, RefusesMoreThanHalfTheSequenceSpace) {
+    Window window;
+
+    for (uint32_t i = 0; i < Window::kMaxSize; ++i) {
+        ASSERT_TRUE(window.Push(i));
+    }
+
+    EXPECT_TRUE(window.IsFull());
+    EXPECT_FALSE(window.Push(0));
+}
@@ -0,0 +1,453 @@
+// This file is part of SWGANH which is released under the MIT license.
+// See file LICENSE or go to http://swganh.com/LICENSE
+
+#include "soe_crypto.h"
+
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define ANH_CRYPTO_X86
+#endif
+
+#if defined(ANH_CRYPTO_X86) || (defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+#define ANH_CRYPTO_LITTLE_ENDIAN
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ANH_CRYPTO_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(ANH_CRYPTO_X86) && (defined(__GNUC__) || defined(_MSC_VER))
+#define ANH_CRYPTO_CLMUL
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define ANH_CRYPTO_TARGET_CLMUL
+#else
+#define ANH_CRYPTO_TARGET_CLMUL __attribute__((target("pclmul,sse4.1")))
+#endif
+#endif
+
+using namespace swganh::network;
+
+namespace {
+	const uint32_t kCrcPolynomial = 0xEDB88320;
+
+	// the folding needs 64 bytes to start with
+	const size_t kClmulMinLength = 64;
+
+	struct CrcTables
+	{
+		CrcTables()
+		{
+			for (uint32_t i = 0; i < 256; ++i)
+			{
+				uint32_t crc = i;
+				for (int bit = 0; bit < 8; ++bit)
+				{
+					crc = (crc & 1) ? (crc >> 1) ^ kCrcPolynomial : crc >> 1;
+				}
+				table[0][i] = crc;
+			}
+
+			// table[n][i] is the crc of byte i followed by n zero bytes
+			for (uint32_t i = 0; i < 256; ++i)
+			{
+				for (int n = 1; n < 8; ++n)
+				{
+					uint32_t previous = table[n - 1][i];
+					table[n][i] = (previous >> 8) ^ table[0][previous & 0xff];
+				}
+			}
+		}
+
+		uint32_t table[8][256];
+	};
+
+	const CrcTables& GetCrcTables()
+	{
+		static const CrcTables tables;
+		return tables;
+	}
+
+	inline uint32_t Load32(const uint8_t* data)
+	{
+		uint32_t value;
+		std::memcpy(&value, data, sizeof(value));
+		return value;
+	}
+
+	inline void Store32(uint8_t* data, uint32_t value)
+	{
+		std::memcpy(data, &value, sizeof(value));
+	}
+
+	inline uint64_t Load64(const uint8_t* data)
+	{
+		uint64_t value;
+		std::memcpy(&value, data, sizeof(value));
+		return value;
+	}
+
+	inline void Store64(uint8_t* data, uint64_t value)
+	{
+		std::memcpy(data, &value, sizeof(value));
+	}
+
+	void XorTail(uint8_t* data, uint32_t length, uint32_t seed)
+	{
+		for (uint32_t i = length & ~3u; i < length; ++i)
+		{
+			data[i] ^= static_cast<uint8_t>(seed);
+		}
+	}
+
+#ifdef ANH_CRYPTO_CLMUL
+	bool CpuHasClmul()
+	{
+#ifdef _MSC_VER
+		int info[4];
+		__cpuid(info, 1);
+		// ecx: bit 1 PCLMULQDQ, bit 19 SSE4.1
+		return (info[2] & (1 << 1)) && (info[2] & (1 << 19));
+#else
+		__builtin_cpu_init();
+		return __builtin_cpu_supports("pclmul") && __builtin_cpu_supports("sse4.1");
+#endif
+	}
+
+	/*
+		Folds 64 bytes per step with carry-less multiplications and Barrett reduces the
+		result, after Intel's "Fast CRC Computation for Generic Polynomials Using PCLMULQDQ".
+		The constants are those of the reflected 0xEDB88320 polynomial. Takes and returns
+		the running state, length is at least 64 and a multiple of 16.
+	*/
+	ANH_CRYPTO_TARGET_CLMUL uint32_t Crc32Fold(uint32_t state, const uint8_t* data, size_t length)
+	{
+		static const uint64_t k1k2[2] = { 0x0154442bd4ULL, 0x01c6e41596ULL };
+		static const uint64_t k3k4[2] = { 0x01751997d0ULL, 0x00ccaa009eULL };
+		static const uint64_t k5k0[2] = { 0x0163cd6124ULL, 0x0000000000ULL };
+		static const uint64_t poly[2] = { 0x01db710641ULL, 0x01f7011641ULL };
+
+		__m128i x0, x1, x2, x3, x4, x5, x6, x7, x8;
+
+		x1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x00));
+		x2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x10));
+		x3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x20));
+		x4 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x30));
+
+		x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128(static_cast<int>(state)));
+		x0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(k1k2));
+
+		data += 64;
+		length -= 64;
+
+		// four independent 128 bit lanes, 64 bytes per step
+		while (length >= 64)
+		{
+			x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+			x6 = _mm_clmulepi64_si128(x2, x0, 0x00);
+			x7 = _mm_clmulepi64_si128(x3, x0, 0x00);
+			x8 = _mm_clmulepi64_si128(x4, x0, 0x00);
+
+			x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+			x2 = _mm_clmulepi64_si128(x2, x0, 0x11);
+			x3 = _mm_clmulepi64_si128(x3, x0, 0x11);
+			x4 = _mm_clmulepi64_si128(x4, x0, 0x11);
+
+			x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x00)));
+			x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x10)));
+			x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x20)));
+			x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x30)));
+
+			data += 64;
+			length -= 64;
+		}
+
+		// the lanes into one
+		x0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(k3k4));
+
+		x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+		x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+		x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+
+		x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+		x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+		x1 = _mm_xor_si128(_mm_xor_si128(x1, x3), x5);
+
+		x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+		x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+		x1 = _mm_xor_si128(_mm_xor_si128(x1, x4), x5);
+
+		// the remaining 16 byte blocks
+		while (length >= 16)
+		{
+			x2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+
+			x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+			x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+			x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+
+			data += 16;
+			length -= 16;
+		}
+
+		// 128 bits to 64
+		x2 = _mm_clmulepi64_si128(x1, x0, 0x10);
+		x3 = _mm_setr_epi32(~0, 0, ~0, 0);
+		x1 = _mm_srli_si128(x1, 8);
+		x1 = _mm_xor_si128(x1, x2);
+
+		x0 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(k5k0));
+
+		x2 = _mm_srli_si128(x1, 4);
+		x1 = _mm_and_si128(x1, x3);
+		x1 = _mm_clmulepi64_si128(x1, x0, 0x00);
+		x1 = _mm_xor_si128(x1, x2);
+
+		// Barrett reduction to 32 bits
+		x0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(poly));
+
+		x2 = _mm_and_si128(x1, x3);
+		x2 = _mm_clmulepi64_si128(x2, x0, 0x10);
+		x2 = _mm_and_si128(x2, x3);
+		x2 = _mm_clmulepi64_si128(x2, x0, 0x00);
+		x1 = _mm_xor_si128(x1, x2);
+
+		return static_cast<uint32_t>(_mm_extract_epi32(x1, 1));
+	}
+#endif
+
+	typedef uint32_t (*CrcFunction)(uint32_t state, const uint8_t* data, size_t length);
+
+	CrcImplementation SelectCrcImplementation()
+	{
+#ifdef ANH_CRYPTO_CLMUL
+		if (CpuHasClmul())
+		{
+			return CRC_CLMUL;
+		}
+#endif
+#ifdef ANH_CRYPTO_LITTLE_ENDIAN
+		return CRC_SLICE_BY_8;
+#else
+		return CRC_BYTEWISE;
+#endif
+	}
+
+	CrcFunction GetCrcFunction()
+	{
+		static const CrcFunction function = [] () -> CrcFunction {
+			switch (GetCrcImplementation())
+			{
+				case CRC_CLMUL: return &detail::Crc32Clmul;
+				case CRC_SLICE_BY_8: return &detail::Crc32SliceBy8;
+				default: return &detail::Crc32Bytewise;
+			}
+		}();
+
+		return function;
+	}
+}
+
+uint32_t swganh::network::SoeCrc(const void* data, uint32_t length, uint32_t seed)
+{
+	uint8_t seed_bytes[4] = {
+		static_cast<uint8_t>(seed),
+		static_cast<uint8_t>(seed >> 8),
+		static_cast<uint8_t>(seed >> 16),
+		static_cast<uint8_t>(seed >> 24)
+	};
+
+	// too short for anything but the table
+	uint32_t state = detail::Crc32Bytewise(0xffffffff, seed_bytes, sizeof(seed_bytes));
+	return ~Crc32Update(state, data, length);
+}
+
+void swganh::network::SoeEncrypt(void* data, uint32_t length, uint32_t seed)
+{
+	detail::SoeEncryptWide(static_cast<uint8_t*>(data), length, seed);
+}
+
+void swganh::network::SoeDecrypt(void* data, uint32_t length, uint32_t seed)
+{
+	detail::SoeDecryptWide(static_cast<uint8_t*>(data), length, seed);
+}
+
+uint32_t swganh::network::Crc32Update(uint32_t state, const void* data, size_t length)
+{
+	return GetCrcFunction()(state, static_cast<const uint8_t*>(data), length);
+}
+
+CrcImplementation swganh::network::GetCrcImplementation()
+{
+	static const CrcImplementation implementation = SelectCrcImplementation();
+	return implementation;
+}
+
+const char* swganh::network::GetCrcImplementationName(CrcImplementation implementation)
+{
+	switch (implementation)
+	{
+		case CRC_SLICE_BY_8: return "slice-by-8";
+		case CRC_CLMUL: return "pclmulqdq";
+		default: return "bytewise";
+	}
+}
+
+uint32_t detail::Crc32Bytewise(uint32_t state, const uint8_t* data, size_t length)
+{
+	const uint32_t* table = GetCrcTables().table[0];
+
+	for (size_t i = 0; i < length; ++i)
+	{
+		state = (state >> 8) ^ table[(state ^ data[i]) & 0xff];
+	}
+
+	return state;
+}
+
+uint32_t detail::Crc32SliceBy8(uint32_t state, const uint8_t* data, size_t length)
+{
+#ifdef ANH_CRYPTO_LITTLE_ENDIAN
+	const CrcTables& tables = GetCrcTables();
+
+	while (length >= 8)
+	{
+		uint32_t low = Load32(data) ^ state;
+		uint32_t high = Load32(data + 4);
+
+		state = tables.table[7][low & 0xff]
+			^ tables.table[6][(low >> 8) & 0xff]
+			^ tables.table[5][(low >> 16) & 0xff]
+			^ tables.table[4][low >> 24]
+			^ tables.table[3][high & 0xff]
+			^ tables.table[2][(high >> 8) & 0xff]
+			^ tables.table[1][(high >> 16) & 0xff]
+			^ tables.table[0][high >> 24];
+
+		data += 8;
+		length -= 8;
+	}
+#endif
+
+	return Crc32Bytewise(state, data, length);
+}
+
+uint32_t detail::Crc32Clmul(uint32_t state, const uint8_t* data, size_t length)
+{
+#ifdef ANH_CRYPTO_CLMUL
+	if (length >= kClmulMinLength)
+	{
+		size_t folded = length & ~static_cast<size_t>(15);
+		state = Crc32Fold(state, data, folded);
+
+		data += folded;
+		length -= folded;
+	}
+#endif
+
+	return Crc32SliceBy8(state, data, length);
+}
+
+void detail::SoeEncryptBlockwise(uint8_t* data, uint32_t length, uint32_t seed)
+{
+	for (uint32_t i = 0; i + 4 <= length; i += 4)
+	{
+		seed ^= Load32(data + i);
+		Store32(data + i, seed);
+	}
+
+	XorTail(data, length, seed);
+}
+
+void detail::SoeDecryptBlockwise(uint8_t* data, uint32_t length, uint32_t seed)
+{
+	for (uint32_t i = 0; i + 4 <= length; i += 4)
+	{
+		uint32_t block = Load32(data + i);
+		Store32(data + i, block ^ seed);
+		seed = block;
+	}
+
+	XorTail(data, length, seed);
+}
+
+/*
+	Encryption is a prefix xor over the blocks, every cipher block depends on the one
+	before it. Within a register the prefix is built with two shifts, only the xor with
+	the last cipher block of the previous register stays serial. Decryption has no such
+	dependency, every block is xored with its cipher predecessor.
+*/
+void detail::SoeEncryptWide(uint8_t* data, uint32_t length, uint32_t seed)
+{
+	uint32_t i = 0;
+
+#if defined(ANH_CRYPTO_SSE2)
+	__m128i carry = _mm_set1_epi32(static_cast<int>(seed));
+
+	for (; i + 16 <= length; i += 16)
+	{
+		__m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+		x = _mm_xor_si128(x, _mm_slli_si128(x, 4));
+		x = _mm_xor_si128(x, _mm_slli_si128(x, 8));
+		x = _mm_xor_si128(x, carry);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(data + i), x);
+
+		carry = _mm_shuffle_epi32(x, 0xff);
+	}
+
+	seed = static_cast<uint32_t>(_mm_cvtsi128_si32(carry));
+#elif defined(ANH_CRYPTO_LITTLE_ENDIAN)
+	uint64_t carry = seed;
+
+	for (; i + 8 <= length; i += 8)
+	{
+		uint64_t x = Load64(data + i);
+		x ^= x << 32;
+		x ^= carry | (carry << 32);
+		Store64(data + i, x);
+
+		carry = x >> 32;
+	}
+
+	seed = static_cast<uint32_t>(carry);
+#endif
+
+	SoeEncryptBlockwise(data + i, length - i, seed);
+}
+
+void detail::SoeDecryptWide(uint8_t* data, uint32_t length, uint32_t seed)
+{
+	uint32_t i = 0;
+
+#if defined(ANH_CRYPTO_SSE2)
+	__m128i previous = _mm_set1_epi32(static_cast<int>(seed));
+
+	for (; i + 16 <= length; i += 16)
+	{
+		__m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+		__m128i shifted = _mm_or_si128(_mm_slli_si128(x, 4), _mm_srli_si128(previous, 12));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(data + i), _mm_xor_si128(x, shifted));
+
+		previous = x;
+	}
+
+	seed = static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_shuffle_epi32(previous, 0xff)));
+#elif defined(ANH_CRYPTO_LITTLE_ENDIAN)
+	uint64_t previous = seed;
+
+	for (; i + 8 <= length; i += 8)
+	{
+		uint64_t x = Load64(data + i);
+		Store64(data + i, x ^ ((x << 32) | previous));
+
+		previous = x >> 32;
+	}
+
+	seed = static_cast<uint32_t>(previous);
+#endif
+
+	SoeDecryptBlockwise(data + i, length - i, seed);
+}
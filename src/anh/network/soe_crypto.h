@@ -0,0 +1,74 @@
+// This file is part of SWGANH which is released under the MIT license.
+// See file LICENSE or go to http://swganh.com/LICENSE
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace swganh
+{
+namespace network
+{
+	/**
+		@brief the crc32 of a soe packet, the standard reflected crc32 (0xEDB88320) of the
+		four little endian bytes of the seed followed by the data
+	*/
+	uint32_t SoeCrc(const void* data, uint32_t length, uint32_t seed);
+
+	/**
+		@brief the chained xor cipher of soe packets, in place
+
+		Every 32 bit block is xored with the previous cipher block, the first with the seed,
+		the trailing bytes with the low byte of the last cipher block. Blocks are read in
+		host order, like the original implementation did.
+	*/
+	void SoeEncrypt(void* data, uint32_t length, uint32_t seed);
+	void SoeDecrypt(void* data, uint32_t length, uint32_t seed);
+
+	/**
+		@brief feeds data to a running crc32, the state starts at 0xffffffff and is
+		inverted once at the end
+	*/
+	uint32_t Crc32Update(uint32_t state, const void* data, size_t length);
+
+	enum CrcImplementation
+	{
+		// a table lookup per byte
+		CRC_BYTEWISE = 0,
+		// eight tables, a lookup per byte but eight bytes per step without a dependency
+		// between them
+		CRC_SLICE_BY_8,
+		// carry-less multiplication folding 64 bytes per step, x86 with PCLMULQDQ and SSE4.1
+		CRC_CLMUL
+	};
+
+	/**
+		@brief the implementation Crc32Update() picked for this cpu, decided on first use
+	*/
+	CrcImplementation GetCrcImplementation();
+
+	const char* GetCrcImplementationName(CrcImplementation implementation);
+
+	namespace detail
+	{
+		// the individual implementations, exposed for the equivalence tests and benchmarks
+
+		uint32_t Crc32Bytewise(uint32_t state, const uint8_t* data, size_t length);
+		uint32_t Crc32SliceBy8(uint32_t state, const uint8_t* data, size_t length);
+
+		/**
+			@brief only valid if GetCrcImplementation() is CRC_CLMUL, falls back to
+			slice by 8 for anything shorter than 64 bytes
+		*/
+		uint32_t Crc32Clmul(uint32_t state, const uint8_t* data, size_t length);
+
+		// a block at a time, the original implementation
+		void SoeEncryptBlockwise(uint8_t* data, uint32_t length, uint32_t seed);
+		void SoeDecryptBlockwise(uint8_t* data, uint32_t length, uint32_t seed);
+
+		// 64 bit registers, or 128 bit ones where SSE2 is available
+		void SoeEncryptWide(uint8_t* data, uint32_t length, uint32_t seed);
+		void SoeDecryptWide(uint8_t* data, uint32_t length, uint32_t seed);
+	}
+}
+}
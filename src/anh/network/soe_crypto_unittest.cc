@@ -0,0 +1,243 @@
+/*
+ This file is part of MMOServer. For more information, visit http://swganh.com
+
+ Copyright (c) 2006 - 2014 The SWG:ANH Team
+
+ MMOServer is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ MMOServer is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with MMOServer.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "anh/network/soe_crypto.h"
+
+using namespace swganh::network;
+
+namespace {
+
+/// The crc of CompCryptor::GenerateCRC before it moved here, computed bit by bit.
+uint32_t ReferenceCrc(const int8_t* data, uint32_t len, uint32_t seed) {
+    uint32_t crc = 0xffffffff;
+
+    auto feed = [&crc] (uint8_t byte) {
+        crc ^= byte;
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320 : crc >> 1;
+        }
+    };
+
+    for (int i = 0; i < 4; ++i) {
+        feed(static_cast<uint8_t>(seed >> (i * 8)));
+    }
+
+    for (uint32_t i = 0; i < len; ++i) {
+        feed(static_cast<uint8_t>(data[i]));
+    }
+
+    return ~crc;
+}
+
+/// CompCryptor::Encrypt before it moved here.
+void ReferenceEncrypt(int8_t* data, uint32_t len, uint32_t seed) {
+    uint32_t blockCount = len / 4;
+    for (uint32_t count = 0; count < blockCount; count++) {
+        uint32_t block;
+        std::memcpy(&block, data + count * 4, 4);
+        block ^= seed;
+        std::memcpy(data + count * 4, &block, 4);
+        seed = block;
+    }
+
+    for (uint32_t count = blockCount * 4; count < len; count++) {
+        data[count] ^= seed;
+    }
+}
+
+/// CompCryptor::Decrypt before it moved here.
+void ReferenceDecrypt(int8_t* data, uint32_t len, uint32_t seed) {
+    uint32_t blockCount = len / 4;
+    for (uint32_t count = 0; count < blockCount; count++) {
+        uint32_t block;
+        std::memcpy(&block, data + count * 4, 4);
+        uint32_t tempSeed = block;
+        block ^= seed;
+        std::memcpy(data + count * 4, &block, 4);
+        seed = tempSeed;
+    }
+
+    for (uint32_t count = blockCount * 4; count < len; count++) {
+        data[count] ^= seed;
+    }
+}
+
+typedef uint32_t (*CrcFunction)(uint32_t, const uint8_t*, size_t);
+typedef void (*CipherFunction)(uint8_t*, uint32_t, uint32_t);
+
+std::vector<CrcFunction> GetCrcFunctions() {
+    std::vector<CrcFunction> functions;
+    functions.push_back(&detail::Crc32Bytewise);
+    functions.push_back(&detail::Crc32SliceBy8);
+
+    if (GetCrcImplementation() == CRC_CLMUL) {
+        functions.push_back(&detail::Crc32Clmul);
+    }
+
+    return functions;
+}
+
+/// Random packets of every length up to a few fragments, at every alignment.
+template<typename Check>
+void ForRandomPackets(Check check) {
+    std::mt19937 random(0x5eed);
+    std::vector<uint8_t> buffer(1500 + 16);
+
+    for (uint32_t length = 0; length <= 1500; length += (length < 300) ? 1 : 37) {
+        for (uint32_t offset = 0; offset < 8; ++offset) {
+            for (auto& byte : buffer) {
+                byte = static_cast<uint8_t>(random());
+            }
+
+            check(buffer.data() + offset, length, static_cast<uint32_t>(random()));
+        }
+    }
+}
+
+}  // namespace
+
+TEST(SoeCryptoTest, CrcMatchesKnownValues) {
+    const char* check = "123456789";
+
+    for (CrcFunction function : GetCrcFunctions()) {
+        EXPECT_EQ(0xCBF43926u, ~function(0xffffffff, reinterpret_cast<const uint8_t*>(check), 9));
+    }
+
+    EXPECT_EQ(0xCBF43926u, ~Crc32Update(0xffffffff, check, 9));
+    EXPECT_EQ(0x2144DF1Cu, SoeCrc(nullptr, 0, 0));
+}
+
+TEST(SoeCryptoTest, CrcMatchesTheReference) {
+    std::vector<CrcFunction> functions = GetCrcFunctions();
+
+    ForRandomPackets([&] (uint8_t* data, uint32_t length, uint32_t seed) {
+        uint32_t expected = ReferenceCrc(reinterpret_cast<int8_t*>(data), length, seed);
+        ASSERT_EQ(expected, SoeCrc(data, length, seed)) << "length " << length;
+
+        uint8_t seed_bytes[4] = {
+            static_cast<uint8_t>(seed), static_cast<uint8_t>(seed >> 8),
+            static_cast<uint8_t>(seed >> 16), static_cast<uint8_t>(seed >> 24) };
+
+        for (CrcFunction function : functions) {
+            uint32_t state = function(0xffffffff, seed_bytes, 4);
+            ASSERT_EQ(expected, ~function(state, data, length)) << "length " << length;
+        }
+    });
+}
+
+TEST(SoeCryptoTest, CipherMatchesTheReference) {
+    CipherFunction encrypts[] = { &detail::SoeEncryptBlockwise, &detail::SoeEncryptWide };
+    CipherFunction decrypts[] = { &detail::SoeDecryptBlockwise, &detail::SoeDecryptWide };
+
+    ForRandomPackets([&] (uint8_t* data, uint32_t length, uint32_t seed) {
+        std::vector<uint8_t> plain(data, data + length);
+
+        std::vector<uint8_t> expected(plain);
+        ReferenceEncrypt(reinterpret_cast<int8_t*>(expected.data()), length, seed);
+
+        for (int i = 0; i < 2; ++i) {
+            std::memcpy(data, plain.data(), length);
+            encrypts[i](data, length, seed);
+            ASSERT_TRUE(std::equal(expected.begin(), expected.end(), data)) << "encrypt " << i << " length " << length;
+
+            decrypts[i](data, length, seed);
+            ASSERT_TRUE(std::equal(plain.begin(), plain.end(), data)) << "decrypt " << i << " length " << length;
+        }
+
+        // and the other way round, decrypting random data
+        std::vector<uint8_t> decrypted(plain);
+        ReferenceDecrypt(reinterpret_cast<int8_t*>(decrypted.data()), length, seed);
+
+        std::memcpy(data, plain.data(), length);
+        SoeDecrypt(data, length, seed);
+        ASSERT_TRUE(std::equal(decrypted.begin(), decrypted.end(), data)) << "length " << length;
+
+        SoeEncrypt(data, length, seed);
+        ASSERT_TRUE(std::equal(plain.begin(), plain.end(), data)) << "length " << length;
+    });
+}
+
+namespace {
+
+template<typename Function>
+void PrintThroughput(const char* name, uint32_t length, Function function) {
+    const uint32_t kBytes = 256 * 1024 * 1024;
+    uint32_t rounds = kBytes / length;
+
+    std::vector<uint8_t> buffer(length, 0x5a);
+    uint32_t sink = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < rounds; ++i) {
+        sink += function(buffer.data(), length, i);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "  " << name << " " << length << " bytes: "
+              << (static_cast<double>(rounds) * length / seconds / (1024 * 1024)) << " MB/s"
+              << " (" << (sink & 1) << ")" << std::endl;
+}
+
+}  // namespace
+
+TEST(SoeCryptoTest, DISABLED_BenchmarkThroughput) {
+    std::cout << "crc implementation: " << GetCrcImplementationName(GetCrcImplementation()) << std::endl;
+
+    const uint32_t lengths[] = { 64, 496, 1400 };
+
+    for (uint32_t length : lengths) {
+        PrintThroughput("crc bytewise  ", length, [] (uint8_t* data, uint32_t length, uint32_t seed) {
+            return detail::Crc32Bytewise(seed, data, length);
+        });
+        PrintThroughput("crc slice-by-8", length, [] (uint8_t* data, uint32_t length, uint32_t seed) {
+            return detail::Crc32SliceBy8(seed, data, length);
+        });
+        if (GetCrcImplementation() == CRC_CLMUL) {
+            PrintThroughput("crc pclmulqdq ", length, [] (uint8_t* data, uint32_t length, uint32_t seed) {
+                return detail::Crc32Clmul(seed, data, length);
+            });
+        }
+
+        PrintThroughput("encrypt block ", length, [] (uint8_t* data, uint32_t length, uint32_t seed) {
+            detail::SoeEncryptBlockwise(data, length, seed);
+            return static_cast<uint32_t>(data[0]);
+        });
+        PrintThroughput("encrypt wide  ", length, [] (uint8_t* data, uint32_t length, uint32_t seed) {
+            detail::SoeEncryptWide(data, length, seed);
+            return static_cast<uint32_t>(data[0]);
+        });
+        PrintThroughput("decrypt block ", length, [] (uint8_t* data, uint32_t length, uint32_t seed) {
+            detail::SoeDecryptBlockwise(data, length, seed);
+            return static_cast<uint32_t>(data[0]);
+        });
+        PrintThroughput("decrypt wide  ", length, [] (uint8_t* data, uint32_t length, uint32_t seed) {
+            detail::SoeDecryptWide(data, length, seed);
+            return static_cast<uint32_t>(data[0]);
+        });
+    }
+}
@@ -0,0 +1,77 @@
+// This file is part of SWGANH which is released under the MIT license.
+// See file LICENSE or go to http://swganh.com/LICENSE
+
+#include "size_class_arena.h"
+
+#include <algorithm>
+
+using namespace swganh;
+
+namespace {
+	// a batch moves up to this many bytes between a thread cache and the depot, a chunk
+	// holds eight batches
+	const size_t kBatchBytes = 32 * 1024;
+	const uint32_t kMaxBatch = 32;
+	const uint32_t kBatchesPerChunk = 8;
+
+	size_t RoundUpToPowerOfTwo(size_t size)
+	{
+		size_t power = 1;
+		while (power < size)
+		{
+			power <<= 1;
+		}
+		return power;
+	}
+}
+
+const uint32_t SizeClassArena::kNoClass;
+
+SizeClassArena::SizeClassArena(size_t min_block, size_t max_block)
+	: min_block_(RoundUpToPowerOfTwo(std::max<size_t>(min_block, 16)))
+{
+	max_block = std::max(RoundUpToPowerOfTwo(max_block), min_block_);
+
+	for (size_t size = min_block_; size <= max_block; size <<= 1)
+	{
+		uint32_t batch = static_cast<uint32_t>(std::max<size_t>(1, std::min<size_t>(kMaxBatch, kBatchBytes / size)));
+		pools_.emplace_back(new BlockPool(size, batch, batch * kBatchesPerChunk));
+	}
+}
+
+uint32_t SizeClassArena::GetClass(size_t size) const
+{
+	uint32_t size_class = 0;
+
+	while (GetClassSize(size_class) < size)
+	{
+		if (++size_class == pools_.size())
+		{
+			return kNoClass;
+		}
+	}
+
+	return size_class;
+}
+
+void* SizeClassArena::Allocate(uint32_t size_class)
+{
+	return pools_[size_class]->Allocate();
+}
+
+void SizeClassArena::Free(void* block, uint32_t size_class)
+{
+	pools_[size_class]->Free(block);
+}
+
+uint64_t SizeClassArena::GetCapacityBytes() const
+{
+	uint64_t bytes = 0;
+
+	for (uint32_t i = 0; i < pools_.size(); ++i)
+	{
+		bytes += pools_[i]->GetCapacity() * GetClassSize(i);
+	}
+
+	return bytes;
+}
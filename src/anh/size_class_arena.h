@@ -0,0 +1,59 @@
+// This file is part of SWGANH which is released under the MIT license.
+// See file LICENSE or go to http://swganh.com/LICENSE
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "anh/block_pool.h"
+
+namespace swganh
+{
+	/**
+		@brief Blocks of power of two size classes, each class a BlockPool of its own.
+
+		Every thread allocates from and frees into its own cache of every class, blocks can
+		be freed in any order and from any thread. The caller remembers the class of a block
+		and hands it back on Free().
+	*/
+	class SizeClassArena
+	{
+	public:
+		static const uint32_t kNoClass = 0xffffffff;
+
+		/**
+			@param min_block the size of the smallest class, rounded up to a power of two
+			@param max_block the largest block, rounded up to a power of two
+		*/
+		SizeClassArena(size_t min_block, size_t max_block);
+
+		uint32_t GetClassCount() const { return static_cast<uint32_t>(pools_.size()); }
+
+		/**
+			@returns the smallest class holding size bytes, kNoClass if it's above the
+			largest block
+		*/
+		uint32_t GetClass(size_t size) const;
+
+		size_t GetClassSize(uint32_t size_class) const { return min_block_ << size_class; }
+
+		void* Allocate(uint32_t size_class);
+		void Free(void* block, uint32_t size_class);
+
+		const BlockPool& GetPool(uint32_t size_class) const { return *pools_[size_class]; }
+
+		/**
+			@brief the memory held by all classes
+		*/
+		uint64_t GetCapacityBytes() const;
+
+	private:
+		SizeClassArena(const SizeClassArena&);
+		SizeClassArena& operator=(const SizeClassArena&);
+
+		size_t min_block_;
+		std::vector<std::unique_ptr<BlockPool>> pools_;
+	};
+}
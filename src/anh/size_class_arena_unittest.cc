@@ -0,0 +1,82 @@
+/*
+ This file is part of MMOServer. For more information, visit http://swganh.com
+
+ Copyright (c) 2006 - 2014 The SWG:ANH Team
+
+ MMOServer is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ MMOServer is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with MMOServer.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "anh/size_class_arena.h"
+
+using swganh::SizeClassArena;
+
+TEST(SizeClassArenaTest, MapsSizesToPowerOfTwoClasses) {
+    SizeClassArena arena(100, 70000);
+
+    EXPECT_EQ(11u, arena.GetClassCount());
+    EXPECT_EQ(128u, arena.GetClassSize(0));
+    EXPECT_EQ(131072u, arena.GetClassSize(10));
+
+    EXPECT_EQ(0u, arena.GetClass(1));
+    EXPECT_EQ(0u, arena.GetClass(128));
+    EXPECT_EQ(1u, arena.GetClass(129));
+    EXPECT_EQ(10u, arena.GetClass(131072));
+    EXPECT_EQ(SizeClassArena::kNoClass, arena.GetClass(131073));
+}
+
+TEST(SizeClassArenaTest, FreesInAnyOrder) {
+    SizeClassArena arena(128, 8192);
+    std::mt19937 random(3);
+
+    std::vector<std::pair<void*, uint32_t>> blocks;
+
+    for (int round = 0; round < 10; ++round) {
+        for (int i = 0; i < 500; ++i) {
+            size_t size = 1 + random() % 8192;
+            uint32_t size_class = arena.GetClass(size);
+            void* block = arena.Allocate(size_class);
+            std::memset(block, 0x5a, size);
+            blocks.push_back(std::make_pair(block, size_class));
+        }
+
+        // free a random half, the rest stays alive across rounds
+        std::shuffle(blocks.begin(), blocks.end(), random);
+        for (size_t i = blocks.size() / 2; i < blocks.size(); ++i) {
+            arena.Free(blocks[i].first, blocks[i].second);
+        }
+        blocks.resize(blocks.size() / 2);
+    }
+
+    uint64_t capacity = arena.GetCapacityBytes();
+
+    for (auto& block : blocks) {
+        arena.Free(block.first, block.second);
+    }
+
+    // the same load again fits into what's there
+    for (int i = 0; i < 500; ++i) {
+        uint32_t size_class = arena.GetClass(1 + random() % 8192);
+        blocks.push_back(std::make_pair(arena.Allocate(size_class), size_class));
+    }
+
+    EXPECT_EQ(capacity, arena.GetCapacityBytes());
+}
@@ -0,0 +1,123 @@
+// This file is part of SWGANH which is released under the MIT license.
+// See file LICENSE or go to http://swganh.com/LICENSE
+
+#include "height_field_cache.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace swganh::tre;
+
+HeightFieldCache::HeightFieldCache(float map_width, float sample_spacing, HeightSampler sampler, uint32_t tile_samples)
+	: origin_(-map_width / 2.0f)
+	, sample_spacing_(sample_spacing)
+	, inverse_spacing_(1.0f / sample_spacing)
+	, tile_samples_(tile_samples)
+	, sampler_(sampler)
+	, filled_tiles_(0)
+{
+	float tile_width = sample_spacing_ * tile_samples_;
+
+	tiles_per_side_ = std::max<uint32_t>(1, static_cast<uint32_t>(std::ceil(map_width / tile_width)));
+	cells_per_side_ = tiles_per_side_ * tile_samples_;
+
+	uint32_t tile_count = tiles_per_side_ * tiles_per_side_;
+
+	tiles_.reset(new boost::atomic<HeightTile*>[tile_count]);
+	for (uint32_t i = 0; i < tile_count; ++i)
+	{
+		tiles_[i].store(nullptr, boost::memory_order_relaxed);
+	}
+}
+
+HeightFieldCache::~HeightFieldCache()
+{
+	uint32_t tile_count = tiles_per_side_ * tiles_per_side_;
+
+	for (uint32_t i = 0; i < tile_count; ++i)
+	{
+		delete tiles_[i].load(boost::memory_order_relaxed);
+	}
+}
+
+float HeightFieldCache::GetHeight(float x, float z)
+{
+	float u = (x - origin_) * inverse_spacing_;
+	float v = (z - origin_) * inverse_spacing_;
+
+	// clamp to the sampled area, the last cell is interpolated up to its far edge
+	u = std::min(std::max(u, 0.0f), static_cast<float>(cells_per_side_));
+	v = std::min(std::max(v, 0.0f), static_cast<float>(cells_per_side_));
+
+	uint32_t cell_x = std::min(static_cast<uint32_t>(u), cells_per_side_ - 1);
+	uint32_t cell_z = std::min(static_cast<uint32_t>(v), cells_per_side_ - 1);
+
+	float fx = u - cell_x;
+	float fz = v - cell_z;
+
+	HeightTile* tile = GetTile_(cell_x / tile_samples_, cell_z / tile_samples_);
+
+	uint32_t row = tile_samples_ + 1;
+	const float* sample = &tile->samples[(cell_z % tile_samples_) * row + (cell_x % tile_samples_)];
+
+	float top = sample[0] + (sample[1] - sample[0]) * fx;
+	float bottom = sample[row] + (sample[row + 1] - sample[row]) * fx;
+
+	return top + (bottom - top) * fz;
+}
+
+void HeightFieldCache::GetHeights(const float* xz, size_t count, float* heights)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		heights[i] = GetHeight(xz[i * 2], xz[i * 2 + 1]);
+	}
+}
+
+HeightFieldCache::HeightTile* HeightFieldCache::GetTile_(uint32_t tile_x, uint32_t tile_z)
+{
+	HeightTile* tile = tiles_[tile_z * tiles_per_side_ + tile_x].load(boost::memory_order_acquire);
+
+	if (!tile)
+	{
+		tile = FillTile_(tile_x, tile_z);
+	}
+
+	return tile;
+}
+
+HeightFieldCache::HeightTile* HeightFieldCache::FillTile_(uint32_t tile_x, uint32_t tile_z)
+{
+	boost::lock_guard<boost::mutex> lock(fill_mutex_);
+
+	boost::atomic<HeightTile*>& slot = tiles_[tile_z * tiles_per_side_ + tile_x];
+
+	// another thread may have filled it while we were waiting
+	HeightTile* tile = slot.load(boost::memory_order_acquire);
+	if (tile)
+	{
+		return tile;
+	}
+
+	uint32_t row = tile_samples_ + 1;
+
+	tile = new HeightTile();
+	tile->samples.resize(row * row);
+
+	float start_x = origin_ + (tile_x * tile_samples_) * sample_spacing_;
+	float start_z = origin_ + (tile_z * tile_samples_) * sample_spacing_;
+
+	for (uint32_t j = 0; j < row; ++j)
+	{
+		for (uint32_t i = 0; i < row; ++i)
+		{
+			tile->samples[j * row + i] = sampler_(start_x + i * sample_spacing_, start_z + j * sample_spacing_);
+		}
+	}
+
+	// publish, the tile is never written again
+	slot.store(tile, boost::memory_order_release);
+	filled_tiles_.fetch_add(1, boost::memory_order_relaxed);
+
+	return tile;
+}
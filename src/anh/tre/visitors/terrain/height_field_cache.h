@@ -0,0 +1,83 @@
+// This file is part of SWGANH which is released under the MIT license.
+// See file LICENSE or go to http://swganh.com/LICENSE
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include <boost/atomic.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/thread/mutex.hpp>
+
+namespace swganh
+{
+namespace tre
+{
+	/**
+		@brief A lazily tiled, sampled copy of a terrain height function.
+
+		The map is divided into square tiles of tile_samples x tile_samples cells. A tile is
+		filled from the sampler the first time any position inside it is queried and is never
+		written again afterwards, so lookups of filled tiles take no lock at all. Filling is
+		serialised on a mutex, as the sampler (layer, filter and fractal evaluation) is not
+		thread safe. Heights between the samples are interpolated bilinearly.
+	*/
+	class HeightFieldCache
+	{
+	public:
+		typedef std::function<float (float x, float z)> HeightSampler;
+
+		/**
+			@param map_width width of the square map, centered on the origin
+			@param sample_spacing distance between two height samples
+			@param sampler evaluates the exact height at a position
+			@param tile_samples number of cells along the edge of a tile
+		*/
+		HeightFieldCache(float map_width, float sample_spacing, HeightSampler sampler, uint32_t tile_samples = 32);
+		~HeightFieldCache();
+
+		/**
+			@brief returns the interpolated height at the given position, positions
+			outside the map are clamped to its border.
+		*/
+		float GetHeight(float x, float z);
+
+		/**
+			@brief looks up count (x, z) pairs from xz and writes the heights into heights.
+		*/
+		void GetHeights(const float* xz, size_t count, float* heights);
+
+		uint32_t GetFilledTileCount() const { return filled_tiles_.load(boost::memory_order_relaxed); }
+		uint32_t GetTileCount() const { return tiles_per_side_ * tiles_per_side_; }
+
+	private:
+		struct HeightTile
+		{
+			// (tile_samples + 1)^2 samples, the last row and column duplicate the
+			// first ones of the neighbouring tiles so interpolation stays inside a tile
+			std::vector<float> samples;
+		};
+
+		HeightFieldCache(const HeightFieldCache&);
+		HeightFieldCache& operator=(const HeightFieldCache&);
+
+		HeightTile* GetTile_(uint32_t tile_x, uint32_t tile_z);
+		HeightTile* FillTile_(uint32_t tile_x, uint32_t tile_z);
+
+		float origin_;
+		float sample_spacing_;
+		float inverse_spacing_;
+		uint32_t tile_samples_;
+		uint32_t tiles_per_side_;
+		uint32_t cells_per_side_;
+
+		HeightSampler sampler_;
+
+		boost::mutex fill_mutex_;
+		boost::atomic<uint32_t> filled_tiles_;
+		std::unique_ptr<boost::atomic<HeightTile*>[]> tiles_;
+	};
+}
+}
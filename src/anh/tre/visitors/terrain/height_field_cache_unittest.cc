@@ -0,0 +1,157 @@
+/*
+ This file is part of MMOServer. For more information, visit http://swganh.com
+
+ Copyright (c) 2006 - 2014 The SWG:ANH Team
+
+ MMOServer is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ MMOServer is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with MMOServer.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/thread.hpp>
+
+#include "anh/tre/visitors/terrain/height_field_cache.h"
+
+using swganh::tre::HeightFieldCache;
+
+namespace {
+
+float PlaneHeight(float x, float z) {
+    return 0.5f * x - 0.25f * z + 10.0f;
+}
+
+// stands in for the layer evaluation, a few octaves of trigonometric noise
+float NoiseHeight(float x, float z) {
+    float height = 0.0f;
+    float amplitude = 64.0f;
+    float frequency = 0.002f;
+
+    for (int octave = 0; octave < 8; ++octave) {
+        height += amplitude * std::sin(x * frequency + octave) * std::cos(z * frequency - octave);
+        amplitude *= 0.5f;
+        frequency *= 2.0f;
+    }
+
+    return height;
+}
+
+/// A linear height function is reproduced exactly by bilinear interpolation.
+TEST(HeightFieldCacheTest, InterpolatesPlanesExactly) {
+    HeightFieldCache cache(1024.0f, 2.0f, &PlaneHeight, 16);
+
+    EXPECT_FLOAT_EQ(PlaneHeight(0.0f, 0.0f), cache.GetHeight(0.0f, 0.0f));
+    EXPECT_FLOAT_EQ(PlaneHeight(13.3f, -101.7f), cache.GetHeight(13.3f, -101.7f));
+    EXPECT_FLOAT_EQ(PlaneHeight(-511.0f, 511.0f), cache.GetHeight(-511.0f, 511.0f));
+}
+
+/// Samples are taken on the grid, so grid positions return the sampler value.
+TEST(HeightFieldCacheTest, ReturnsSampledValuesOnGridPoints) {
+    HeightFieldCache cache(1024.0f, 2.0f, &NoiseHeight, 16);
+
+    EXPECT_FLOAT_EQ(NoiseHeight(-100.0f, 36.0f), cache.GetHeight(-100.0f, 36.0f));
+    EXPECT_FLOAT_EQ(NoiseHeight(32.0f, 32.0f), cache.GetHeight(32.0f, 32.0f));
+}
+
+/// Tiles are only filled when a position inside them is queried.
+TEST(HeightFieldCacheTest, FillsTilesOnFirstTouch) {
+    HeightFieldCache cache(1024.0f, 2.0f, &PlaneHeight, 16);
+
+    EXPECT_EQ(1024u, cache.GetTileCount());
+    EXPECT_EQ(0u, cache.GetFilledTileCount());
+
+    cache.GetHeight(1.0f, 1.0f);
+    cache.GetHeight(2.0f, 3.0f);
+    EXPECT_EQ(1u, cache.GetFilledTileCount());
+
+    cache.GetHeight(-300.0f, 200.0f);
+    EXPECT_EQ(2u, cache.GetFilledTileCount());
+}
+
+/// Positions outside of the map are clamped to the border.
+TEST(HeightFieldCacheTest, ClampsPositionsOutsideTheMap) {
+    HeightFieldCache cache(1024.0f, 2.0f, &PlaneHeight, 16);
+
+    EXPECT_FLOAT_EQ(PlaneHeight(-512.0f, 0.0f), cache.GetHeight(-4000.0f, 0.0f));
+    EXPECT_FLOAT_EQ(PlaneHeight(512.0f, 512.0f), cache.GetHeight(4000.0f, 4000.0f));
+}
+
+TEST(HeightFieldCacheTest, BatchLookupMatchesSingleLookups) {
+    HeightFieldCache cache(1024.0f, 2.0f, &NoiseHeight, 16);
+
+    float xz[] = { 1.5f, 2.5f, -200.25f, 300.75f, 511.0f, -511.0f };
+    float heights[3];
+
+    cache.GetHeights(xz, 3, heights);
+
+    for (int i = 0; i < 3; ++i) {
+        EXPECT_FLOAT_EQ(cache.GetHeight(xz[i * 2], xz[i * 2 + 1]), heights[i]);
+    }
+}
+
+/// Compares queries per second of a mutex guarded evaluation per query (the former
+/// TerrainService::GetHeight) with the cache, from several threads at once.
+/// Run with --gtest_also_run_disabled_tests.
+TEST(HeightFieldCacheTest, DISABLED_BenchmarkAgainstDirectEvaluation) {
+    namespace pt = boost::posix_time;
+
+    const uint32_t thread_count = 4;
+    const uint32_t queries_per_thread = 200000;
+
+    HeightFieldCache cache(16384.0f, 2.0f, &NoiseHeight);
+    boost::mutex evaluation_mutex;
+
+    // npc's and players cluster around a few spots, query a 1km area
+    auto run = [&] (bool cached) -> double {
+        pt::ptime start = pt::microsec_clock::universal_time();
+
+        boost::thread_group threads;
+        for (uint32_t t = 0; t < thread_count; ++t) {
+            threads.create_thread([&, t] () {
+                volatile float sink = 0.0f;
+                for (uint32_t i = 0; i < queries_per_thread; ++i) {
+                    float x = static_cast<float>((i * 7919 + t * 104729) % 1000) - 500.0f + 0.37f;
+                    float z = static_cast<float>((i * 6271 + t * 15485863) % 1000) - 500.0f + 0.61f;
+
+                    if (cached) {
+                        sink = sink + cache.GetHeight(x, z);
+                    } else {
+                        boost::lock_guard<boost::mutex> lock(evaluation_mutex);
+                        sink = sink + NoiseHeight(x, z);
+                    }
+                }
+            });
+        }
+        threads.join_all();
+
+        pt::time_duration elapsed = pt::microsec_clock::universal_time() - start;
+        return (thread_count * queries_per_thread) / (elapsed.total_microseconds() / 1000000.0);
+    };
+
+    double direct = run(false);
+    double cold = run(true);
+    double warm = run(true);
+
+    std::cout << thread_count << " threads x " << queries_per_thread << " queries:" << std::endl
+              << "  direct evaluation " << static_cast<uint64_t>(direct) << " queries/s" << std::endl
+              << "  cache, cold       " << static_cast<uint64_t>(cold) << " queries/s ("
+              << cache.GetFilledTileCount() << " tiles filled)" << std::endl
+              << "  cache, warm       " << static_cast<uint64_t>(warm) << " queries/s" << std::endl;
+}
+
+}  // namespace